@@ -0,0 +1,101 @@
+// ignore_for_file: avoid_print
+
+// Operations per second of `sum` called once per operation from Dart, as a
+// leaf call and as a regular call, against a `Batch` of as many operations
+// run by a single call of `tau_batch_execute`. Unlike `tau_ffi_bench batch`,
+// whose calls are C to C, every call here crosses from Dart to native code,
+// which is the cost batching saves.
+//
+// Build the native library, then run from the package directory:
+//
+//   cmake -S src -B build -DCMAKE_BUILD_TYPE=Release
+//   cmake --build build
+//   LD_LIBRARY_PATH=build dart run benchmark/batch.dart
+
+import 'dart:ffi';
+import 'dart:io';
+
+import 'package:tau_ffi/tau_ffi.dart' as tau;
+
+typedef _SumNative = Int Function(Int, Int);
+typedef _Sum = int Function(int, int);
+
+const int _maxBatchSize = 65536;
+const int _operations = 4194304;
+const int _runs = 5;
+
+/// The best of [_runs] runs of [_operations] operations, done by [run] in
+/// groups of [size], in operations per second.
+double _operationsPerSecond(int size, int Function(int size, int seed) run) {
+  double best = 0;
+  for (int r = 0; r < _runs; r++) {
+    int sink = 0;
+    final Stopwatch watch = Stopwatch()..start();
+    for (int done = 0; done < _operations; done += size) {
+      sink += run(size, done);
+    }
+    watch.stop();
+    if (sink == 0) {
+      throw StateError('sum returned nothing');
+    }
+    final double rate = _operations / (watch.elapsedMicroseconds / 1e6);
+    if (rate > best) {
+      best = rate;
+    }
+  }
+  return best;
+}
+
+/// The library [tau.sum] calls into, opened again for a regular binding.
+DynamicLibrary _openLibrary() {
+  if (Platform.isMacOS || Platform.isIOS) {
+    return DynamicLibrary.open('tau_ffi.framework/tau_ffi');
+  }
+  if (Platform.isWindows) {
+    return DynamicLibrary.open('tau_ffi.dll');
+  }
+  return DynamicLibrary.open('libtau_ffi.so');
+}
+
+void main() {
+  final _Sum regular = _openLibrary()
+      .lookup<NativeFunction<_SumNative>>('sum')
+      .asFunction<_Sum>();
+  final tau.Batch batch = tau.Batch(_maxBatchSize);
+
+  int calls(_Sum function, int size, int seed) {
+    int last = 0;
+    for (int i = 0; i < size; i++) {
+      last = function(i, seed);
+    }
+    return last + 1;
+  }
+
+  int batched(int size, int seed) {
+    batch.clear();
+    for (int i = 0; i < size; i++) {
+      batch.addSum(i, seed);
+    }
+    batch.execute();
+    return batch.result(size - 1) + 1;
+  }
+
+  print('operations of sum per second, in M, best of $_runs runs of '
+      '$_operations:');
+  print('${'batch'.padLeft(8)} ${'regular'.padLeft(10)} '
+      '${'leaf'.padLeft(10)} ${'batched'.padLeft(10)} '
+      '${'vs leaf'.padLeft(8)}');
+  for (int size = 1; size <= _maxBatchSize; size *= 4) {
+    final double regularRate =
+        _operationsPerSecond(size, (int n, int s) => calls(regular, n, s));
+    final double leafRate =
+        _operationsPerSecond(size, (int n, int s) => calls(tau.sum, n, s));
+    final double batchedRate = _operationsPerSecond(size, batched);
+    print('${'$size'.padLeft(8)} '
+        '${(regularRate / 1e6).toStringAsFixed(1).padLeft(10)} '
+        '${(leafRate / 1e6).toStringAsFixed(1).padLeft(10)} '
+        '${(batchedRate / 1e6).toStringAsFixed(1).padLeft(10)} '
+        '${(batchedRate / leafRate).toStringAsFixed(2).padLeft(7)}x');
+  }
+  batch.dispose();
+}
@@ -0,0 +1,100 @@
+// ignore_for_file: avoid_print
+
+// Calls per second of `sum` as a leaf call, as the bindings declare it, and
+// as a regular call, as they did before; and the time to the first call at
+// startup, which opens the library and looks the symbol up.
+//
+// Build the native library, then run from the package directory:
+//
+//   cmake -S src -B build -DCMAKE_BUILD_TYPE=Release
+//   cmake --build build
+//   LD_LIBRARY_PATH=build dart run benchmark/ffi_calls.dart
+//
+// Run it several times for the startup figure: only the first call of a
+// process opens the library.
+
+import 'dart:ffi';
+import 'dart:io';
+
+import 'package:tau_ffi/tau_ffi.dart' as tau;
+
+typedef _SumNative = Int Function(Int, Int);
+typedef _Sum = int Function(int, int);
+
+const int _calls = 10000000;
+const int _runs = 5;
+
+/// The best of [_runs] runs of [_calls] calls of [function], in calls per
+/// second.
+double _callsPerSecond(_Sum function) {
+  double best = 0;
+  for (int run = 0; run < _runs; run++) {
+    int sink = 0;
+    final Stopwatch watch = Stopwatch()..start();
+    for (int i = 0; i < _calls; i++) {
+      sink += function(i, 1);
+    }
+    watch.stop();
+    if (sink == 0) {
+      throw StateError('sum returned nothing');
+    }
+    final double rate = _calls / (watch.elapsedMicroseconds / 1e6);
+    if (rate > best) {
+      best = rate;
+    }
+  }
+  return best;
+}
+
+/// The library [tau.sum] calls into, opened again to bind it both ways.
+DynamicLibrary _openLibrary() {
+  if (Platform.isMacOS || Platform.isIOS) {
+    return DynamicLibrary.open('tau_ffi.framework/tau_ffi');
+  }
+  if (Platform.isWindows) {
+    return DynamicLibrary.open('tau_ffi.dll');
+  }
+  return DynamicLibrary.open('libtau_ffi.so');
+}
+
+/// The microseconds [call] takes.
+int _time(void Function() call) {
+  final Stopwatch watch = Stopwatch()..start();
+  call();
+  return watch.elapsedMicroseconds;
+}
+
+void main() {
+  // Opens the library, looks `sum` up and builds its trampoline.
+  final int startup = _time(() => tau.sum(1, 2));
+
+  // Once the library is open, what remains of a first call: the lookup and
+  // the trampoline of each kind of call.
+  final DynamicLibrary library = _openLibrary();
+  late final _Sum leaf;
+  late final _Sum regular;
+  final int leafLookup = _time(() {
+    leaf = library
+        .lookup<NativeFunction<_SumNative>>('sum')
+        .asFunction<_Sum>(isLeaf: true);
+    leaf(1, 2);
+  });
+  final int regularLookup = _time(() {
+    regular =
+        library.lookup<NativeFunction<_SumNative>>('sum').asFunction<_Sum>();
+    regular(1, 2);
+  });
+
+  print('time to the first call of sum: $startup us '
+      '(lookup and first call: $leafLookup us leaf, '
+      '$regularLookup us regular)');
+
+  final double before = _callsPerSecond(regular);
+  final double after = _callsPerSecond(leaf);
+  final double bindings = _callsPerSecond(tau.sum);
+  print('calls of sum per second, best of $_runs runs of $_calls:');
+  print('  regular call (before): ${(before / 1e6).toStringAsFixed(1)} M');
+  print('  leaf call (after):     ${(after / 1e6).toStringAsFixed(1)} M '
+      '(${(after / before).toStringAsFixed(2)}x)');
+  print('  tau_ffi sum:           ${(bindings / 1e6).toStringAsFixed(1)} M');
+}
@@ -0,0 +1,3 @@
+// Relative import to be able to reuse the C sources.
+// See the comment in ../tau_ffi.podspec for more information.
+#include "../../src/tau_cache.c"
@@ -0,0 +1,72 @@
+part of '../tau_ffi.dart';
+
+/// Planar audio samples in native memory, shared with the render graph
+/// without copies.
+///
+/// [getChannelData] views a channel in place: writes from Dart are seen by
+/// the nodes playing the buffer, and rendered samples appear without being
+/// copied into the Dart heap. Each view keeps the native memory alive on its
+/// own, so a view stays valid after the buffer object is collected.
+class AudioBuffer implements Finalizable {
+  static final Pointer<NativeFinalizerFunction> _release =
+      _dylib.lookup<NativeFinalizerFunction>('tau_audio_buffer_release');
+  static final NativeFinalizer _finalizer = NativeFinalizer(_release);
+
+  final Pointer<tau_audio_buffer> _buffer;
+  final List<Float32List?> _channels;
+
+  AudioBuffer._(this._buffer)
+      : _channels =
+            List<Float32List?>.filled(_buffer.ref.channels, null) {
+    _finalizer.attach(this, _buffer.cast(), detach: this);
+  }
+
+  /// Allocates a silent buffer of [numberOfChannels] channels of [length]
+  /// frames at [sampleRate].
+  factory AudioBuffer({
+    int numberOfChannels = 1,
+    required int length,
+    required double sampleRate,
+  }) {
+    final Pointer<tau_audio_buffer> buffer =
+        _bindings.tau_audio_buffer_create(numberOfChannels, length, sampleRate);
+    if (buffer == nullptr) {
+      throw ArgumentError('Cannot allocate a buffer of $numberOfChannels '
+          'channels of $length frames at $sampleRate Hz');
+    }
+    return AudioBuffer._(buffer);
+  }
+
+  /// The number of channels.
+  int get numberOfChannels => _channels.length;
+
+  /// The number of frames of every channel.
+  int get length => _buffer.ref.frames;
+
+  /// The sample rate, in hertz.
+  double get sampleRate => _buffer.ref.sample_rate;
+
+  /// The duration, in seconds.
+  double get duration => length / sampleRate;
+
+  /// The samples of [channel], viewed in native memory.
+  Float32List getChannelData(int channel) {
+    RangeError.checkValidIndex(channel, _channels, 'channel');
+    return _channels[channel] ??= _view(channel);
+  }
+
+  Float32List _view(int channel) {
+    final tau_audio_buffer buffer = _buffer.ref;
+    // The view holds its own reference, given back when it is collected.
+    _bindings.tau_audio_buffer_retain(_buffer);
+    return (buffer.data + channel * buffer.stride)
+        .asTypedList(buffer.frames, finalizer: _release, token: _buffer.cast());
+  }
+
+  /// Gives back the reference of this object. Views returned by
+  /// [getChannelData] stay valid until they are collected.
+  void dispose() {
+    _finalizer.detach(this);
+    _bindings.tau_audio_buffer_release(_buffer);
+  }
+}
@@ -0,0 +1,108 @@
+part of '../tau_ffi.dart';
+
+/// The counters of an [AudioBufferCache], since it was opened.
+class AudioBufferCacheStats {
+  /// Loads that mapped an existing entry.
+  final int hits;
+
+  /// Loads that decoded the file and added an entry.
+  final int misses;
+
+  /// Entries deleted to stay within the size limit.
+  final int evictions;
+
+  /// The total size of the evicted entries, in bytes.
+  final int evictedBytes;
+
+  /// The entries in the cache directory as of the last eviction pass.
+  final int entries;
+
+  /// The total size of [entries], in bytes.
+  final int bytes;
+
+  const AudioBufferCacheStats._(this.hits, this.misses, this.evictions,
+      this.evictedBytes, this.entries, this.bytes);
+
+  @override
+  String toString() => 'AudioBufferCacheStats(hits: $hits, misses: $misses, '
+      'evictions: $evictions, evictedBytes: $evictedBytes, '
+      'entries: $entries, bytes: $bytes)';
+}
+
+/// Decoded audio files kept in a directory, shared between contexts and
+/// processes.
+///
+/// [load] decodes a file the first time its content is seen, and maps the
+/// decoded samples from the directory afterwards, whatever the name of the
+/// file. Processes loading the same file share the mapped memory; writes to a
+/// loaded buffer stay private to it. The least recently loaded entries are
+/// deleted past [maxBytes].
+class AudioBufferCache implements Finalizable {
+  static final NativeFinalizer _finalizer = NativeFinalizer(
+      _dylib.lookup<NativeFinalizerFunction>('tau_cache_close'));
+
+  final Pointer<tau_cache> _cache;
+  int _maxBytes;
+
+  AudioBufferCache._(this._cache, this._maxBytes) {
+    _finalizer.attach(this, _cache.cast(), detach: this);
+  }
+
+  /// Opens the cache in [directory], creating it if needed but not its
+  /// parents, and limits its size to [maxBytes].
+  factory AudioBufferCache.open(String directory, {required int maxBytes}) {
+    final Pointer<tau_cache> cache = _withNativeString(directory,
+        (Pointer<Char> native) => _bindings.tau_cache_open(native, maxBytes));
+    if (cache == nullptr) {
+      throw ArgumentError.value(directory, 'directory', 'Cannot open');
+    }
+    return AudioBufferCache._(cache, maxBytes);
+  }
+
+  /// The size limit of the entries, in bytes.
+  int get maxBytes => _maxBytes;
+
+  set maxBytes(int maxBytes) {
+    _checkStatus(
+        _bindings.tau_cache_set_limit(_cache, maxBytes), 'set cache limit');
+    _maxBytes = maxBytes;
+  }
+
+  /// Loads the audio file at [path], decoding it only if the cache has no
+  /// entry for its content. The file is read in full to hash its content.
+  AudioBuffer load(String path) {
+    final Pointer<tau_audio_buffer> buffer = _withNativeString(path,
+        (Pointer<Char> native) => _bindings.tau_cache_load(_cache, native));
+    if (buffer == nullptr) {
+      throw ArgumentError.value(path, 'path', 'Cannot decode');
+    }
+    return AudioBuffer._(buffer);
+  }
+
+  /// The counters of this cache.
+  AudioBufferCacheStats get stats {
+    final Pointer<tau_cache_stats> native = _bindings
+        .tau_memory_allocate(sizeOf<tau_cache_stats>())
+        .cast<tau_cache_stats>();
+    if (native == nullptr) {
+      throw StateError('Cannot allocate cache stats');
+    }
+    _bindings.tau_cache_get_stats(_cache, native);
+    final tau_cache_stats stats = native.ref;
+    final AudioBufferCacheStats result = AudioBufferCacheStats._(
+        stats.hits,
+        stats.misses,
+        stats.evictions,
+        stats.evicted_bytes,
+        stats.entries,
+        stats.bytes);
+    _bindings.tau_memory_release(native.cast());
+    return result;
+  }
+
+  /// Closes the cache. Buffers loaded from it stay valid.
+  void dispose() {
+    _finalizer.detach(this);
+    _bindings.tau_cache_close(_cache);
+  }
+}
@@ -0,0 +1,143 @@
+part of '../tau_ffi.dart';
+
+/// Runs [action] with [string] as a NUL-terminated UTF-8 string in native
+/// memory.
+T _withNativeString<T>(String string, T Function(Pointer<Char>) action) {
+  final List<int> bytes = utf8.encode(string);
+  final Pointer<Uint8> native =
+      _bindings.tau_memory_allocate(bytes.length + 1).cast<Uint8>();
+  if (native == nullptr) {
+    throw StateError('Cannot allocate ${bytes.length + 1} bytes');
+  }
+  try {
+    native.asTypedList(bytes.length + 1)
+      ..setAll(0, bytes)
+      ..[bytes.length] = 0;
+    return action(native.cast<Char>());
+  } finally {
+    _bindings.tau_memory_release(native.cast());
+  }
+}
+
+/// Decodes the whole audio file at [path] into a new [AudioBuffer], as the
+/// Web Audio `decodeAudioData`.
+///
+/// The buffer holds every sample of the file: prefer an [AudioStream] for
+/// long files.
+AudioBuffer decodeAudioFile(String path) {
+  final Pointer<tau_audio_buffer> buffer =
+      _withNativeString(path, _bindings.tau_decode_file);
+  if (buffer == nullptr) {
+    throw ArgumentError.value(path, 'path', 'Cannot decode');
+  }
+  return AudioBuffer._(buffer);
+}
+
+/// Decoded audio read incrementally from a file.
+///
+/// The file is decoded on a native thread into a bounded ring of frames,
+/// ahead of its reader, so memory use does not depend on the length of the
+/// file and the first frames are available right away. A stream has a single
+/// reader: either [read] or one [AudioStreamSourceNode].
+class AudioStream implements Finalizable {
+  static final NativeFinalizer _finalizer = NativeFinalizer(
+      _dylib.lookup<NativeFinalizerFunction>('tau_stream_release'));
+
+  final Pointer<tau_stream> _stream;
+
+  AudioStream._(this._stream) {
+    _finalizer.attach(this, _stream.cast(), detach: this);
+  }
+
+  /// Opens the audio file at [path], decoding up to [bufferFrames] frames
+  /// ahead of the reader, or a default amount if 0.
+  factory AudioStream.open(String path, {int bufferFrames = 0}) {
+    final Pointer<tau_stream> stream = _withNativeString(
+        path,
+        (Pointer<Char> native) =>
+            _bindings.tau_stream_open(native, bufferFrames));
+    if (stream == nullptr) {
+      throw ArgumentError.value(path, 'path', 'Cannot decode');
+    }
+    return AudioStream._(stream);
+  }
+
+  /// The number of channels.
+  int get numberOfChannels => _bindings.tau_stream_channels(_stream);
+
+  /// The sample rate, in hertz.
+  double get sampleRate => _bindings.tau_stream_sample_rate(_stream);
+
+  /// The number of frames of the file, or null if the file does not tell.
+  int? get length {
+    final int frames = _bindings.tau_stream_length(_stream);
+    return frames >= 0 ? frames : null;
+  }
+
+  /// Reads the next [frames] frames, waiting for them to be decoded, in
+  /// several turns if they do not fit in the ring.
+  ///
+  /// The buffer is shorter than [frames] at the end of the file, and null
+  /// after it.
+  AudioBuffer? read(int frames) {
+    final AudioBuffer buffer = AudioBuffer(
+        numberOfChannels: numberOfChannels,
+        length: frames,
+        sampleRate: sampleRate);
+    final int read = _checkStatus(
+        _bindings.tau_stream_read(_stream, buffer._buffer), 'read');
+    if (read == 0) {
+      buffer.dispose();
+      return null;
+    }
+    if (read == frames) {
+      return buffer;
+    }
+    final AudioBuffer last = AudioBuffer(
+        numberOfChannels: numberOfChannels,
+        length: read,
+        sampleRate: sampleRate);
+    for (int c = 0; c < numberOfChannels; c++) {
+      last.getChannelData(c).setAll(
+          0, Float32List.sublistView(buffer.getChannelData(c), 0, read));
+    }
+    buffer.dispose();
+    return last;
+  }
+
+  /// Gives back the native stream. Nodes playing it keep it open.
+  void dispose() {
+    _finalizer.detach(this);
+    _bindings.tau_stream_release(_stream);
+  }
+}
+
+/// A source playing an [AudioStream] as it is decoded.
+///
+/// In real time, frames not decoded when they are needed play as silence,
+/// counted by [underruns]. A [blocking] source, for offline rendering, waits
+/// for them instead, so the graph is paced by the decoder rather than
+/// rendering gaps.
+class AudioStreamSourceNode extends AudioScheduledSourceNode {
+  AudioStreamSourceNode._(super.context, super.handle) : super._();
+
+  /// Creates a source playing [stream], converted to the sample rate of
+  /// [context] at [OfflineAudioContext.resamplerQuality].
+  factory AudioStreamSourceNode(
+    OfflineAudioContext context,
+    AudioStream stream, {
+    bool blocking = false,
+  }) {
+    final int handle = _checkStatus(
+        _bindings.tau_stream_source_create(
+            context._context, stream._stream, blocking ? 1 : 0),
+        'create stream source');
+    return AudioStreamSourceNode._(context, handle);
+  }
+
+  /// The quanta played partly or wholly as silence because their frames
+  /// were not decoded in time.
+  int get underruns => _checkStatus(
+      _bindings.tau_stream_source_underruns(context._context, _handle),
+      'underruns');
+}
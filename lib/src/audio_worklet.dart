@@ -0,0 +1,214 @@
+part of '../tau_ffi.dart';
+
+/// Processes the quanta of an [AudioWorkletNode], as the Web Audio
+/// `AudioWorkletProcessor`.
+///
+/// Processors run on the isolate of their [AudioWorklet], which creates one
+/// per node the first time the node has a quantum to process.
+abstract class AudioWorkletProcessor {
+  /// Fills [outputs] from [inputs], one list of
+  /// [OfflineAudioContext.renderQuantumSize] samples per channel, for the
+  /// quantum starting at the context frame [frame].
+  ///
+  /// The lists view native memory shared with the rendering thread, and are
+  /// only valid during the call. The outputs hold what was written to them
+  /// the last time they were used, not silence.
+  void process(List<Float32List> inputs, List<Float32List> outputs, int frame);
+}
+
+/// Creates the processor of a node.
+typedef AudioWorkletProcessorFactory = AudioWorkletProcessor Function();
+
+/// A dedicated isolate running the [AudioWorkletProcessor]s of
+/// [AudioWorkletNode]s, as the Web Audio `AudioWorklet`.
+///
+/// The nodes share their quanta with the isolate through native memory:
+/// every quantum, a node queues its input to the isolate, which processes it
+/// in place, and outputs the block it queued [AudioWorkletNode.latency]
+/// quanta before. No message goes between isolates per quantum, and the
+/// rendering thread never waits for the isolate, which sleeps on a semaphore
+/// when it has nothing to process.
+///
+/// The isolate stops on [dispose], or when the worklet is garbage collected.
+class AudioWorklet implements Finalizable {
+  static final NativeFinalizer _finalizer = NativeFinalizer(
+      _dylib.lookup<NativeFinalizerFunction>('tau_worklet_host_close'));
+
+  /// How long the isolate sleeps at most before it handles its messages, in
+  /// milliseconds.
+  static const int _waitMilliseconds = 10;
+
+  /// The blocks the isolate processes between two looks at its messages
+  /// when it is busy.
+  static const int _blocksPerTurn = 64;
+
+  final Pointer<tau_worklet_host> _host;
+  final SendPort _isolate;
+  final List<String> _names;
+  int _nextInstance = 0;
+
+  AudioWorklet._(this._host, this._isolate, this._names) {
+    _finalizer.attach(this, _host.cast(), detach: this);
+  }
+
+  /// Spawns the isolate of a worklet running the processors [processors]
+  /// creates, by name, for nodes owning up to [capacity] blocks together: a
+  /// node of a latency of `n` quanta owns `n + 2`.
+  ///
+  /// The factories are sent to the isolate, so they must be top-level or
+  /// static functions, or closures over state that can be sent.
+  static Future<AudioWorklet> spawn(
+    Map<String, AudioWorkletProcessorFactory> processors, {
+    int capacity = 1024,
+  }) async {
+    if (processors.isEmpty || processors.length > 0x10000) {
+      throw ArgumentError.value(
+          processors.length, 'processors', 'Expected 1 to 65536 processors');
+    }
+    final Pointer<tau_worklet_host> host =
+        _bindings.tau_worklet_host_create(capacity);
+    if (host == nullptr) {
+      throw ArgumentError.value(
+          capacity, 'capacity', 'Cannot create a worklet host');
+    }
+    final ReceivePort started = ReceivePort();
+    try {
+      await Isolate.spawn(
+          _run,
+          _WorkletStart(host.address, processors.values.toList(),
+              started.sendPort),
+          errorsAreFatal: false,
+          debugName: 'AudioWorklet');
+    } catch (_) {
+      started.close();
+      _bindings.tau_worklet_host_release(host);
+      rethrow;
+    }
+    final SendPort isolate = await started.first as SendPort;
+    return AudioWorklet._(host, isolate, processors.keys.toList());
+  }
+
+  /// Stops the isolate. The nodes of the worklet output silence from then
+  /// on.
+  void dispose() {
+    _finalizer.detach(this);
+    _bindings.tau_worklet_host_close(_host);
+  }
+
+  /// The key of a new node running the processor named [name].
+  int _key(String name) {
+    final int index = _names.indexOf(name);
+    if (index < 0) {
+      throw ArgumentError.value(name, 'name', 'No such processor');
+    }
+    return (_nextInstance++ << 16) | index;
+  }
+
+  /// Drops the processor of the node of [key].
+  void _forget(int key) => _isolate.send(key);
+
+  static Future<void> _run(_WorkletStart start) async {
+    final Pointer<tau_worklet_host> host =
+        Pointer<tau_worklet_host>.fromAddress(start.host);
+    final Map<int, _WorkletInstance> instances = <int, _WorkletInstance>{};
+    final RawReceivePort messages = RawReceivePort();
+    messages.handler = (Object? key) => instances.remove(key);
+    start.started.send(messages.sendPort);
+    int blocks = 0;
+    while (_bindings.tau_worklet_host_closed(host) == 0) {
+      final Pointer<tau_worklet_block> block =
+          _bindings.tau_worklet_host_wait(host, _waitMilliseconds);
+      if (block == nullptr || ++blocks % _blocksPerTurn == 0) {
+        // Lets the messages in.
+        await Future<void>.delayed(Duration.zero);
+      }
+      if (block == nullptr) {
+        continue;
+      }
+      final int key = block.ref.key;
+      final _WorkletInstance instance = instances.putIfAbsent(
+          key, () => _WorkletInstance(start.factories[key & 0xffff]));
+      instance.process(block);
+      _bindings.tau_worklet_host_complete(host, block);
+    }
+    messages.close();
+    _bindings.tau_worklet_host_release(host);
+  }
+}
+
+/// What the isolate of an [AudioWorklet] starts from.
+class _WorkletStart {
+  final int host;
+  final List<AudioWorkletProcessorFactory> factories;
+  final SendPort started;
+
+  _WorkletStart(this.host, this.factories, this.started);
+}
+
+/// The processor of a node, and views of the blocks of the node by address.
+class _WorkletInstance {
+  final AudioWorkletProcessorFactory _factory;
+  late AudioWorkletProcessor _processor = _create();
+  final Map<int, _WorkletViews> _views = <int, _WorkletViews>{};
+
+  _WorkletInstance(this._factory);
+
+  void process(Pointer<tau_worklet_block> block) {
+    final _WorkletViews views =
+        _views.putIfAbsent(block.address, () => _WorkletViews(block.ref));
+    try {
+      _processor.process(views.inputs, views.outputs, block.ref.frame);
+    } catch (error, stack) {
+      // As in Web Audio, a processor that throws is not called again; the
+      // error is reported as uncaught, which does not stop the isolate.
+      _processor = _Failed.processor;
+      views.silence();
+      Zone.current.handleUncaughtError(error, stack);
+    }
+  }
+
+  AudioWorkletProcessor _create() {
+    try {
+      return _factory();
+    } catch (error, stack) {
+      Zone.current.handleUncaughtError(error, stack);
+      return _Failed.processor;
+    }
+  }
+}
+
+/// Stands for a processor that threw.
+class _Failed implements AudioWorkletProcessor {
+  static final AudioWorkletProcessor processor = _Failed();
+
+  @override
+  void process(
+      List<Float32List> inputs, List<Float32List> outputs, int frame) {
+    for (final Float32List output in outputs) {
+      output.fillRange(0, output.length, 0);
+    }
+  }
+}
+
+/// The channels of a block, as lists.
+class _WorkletViews {
+  final List<Float32List> inputs;
+  final List<Float32List> outputs;
+
+  _WorkletViews(tau_worklet_block block)
+      : inputs = _channels(block.input, block.input_channels),
+        outputs = _channels(block.output, block.output_channels);
+
+  static List<Float32List> _channels(Pointer<Float> samples, int count) =>
+      List<Float32List>.generate(
+          count,
+          (int c) => (samples + c * TAU_RENDER_QUANTUM_FRAMES)
+              .asTypedList(TAU_RENDER_QUANTUM_FRAMES),
+          growable: false);
+
+  void silence() {
+    for (final Float32List output in outputs) {
+      output.fillRange(0, output.length, 0);
+    }
+  }
+}
@@ -0,0 +1,87 @@
+part of '../tau_ffi.dart';
+
+/// Head-related impulse responses for the HRTF panning of a [PannerNode],
+/// shared by any number of panners.
+///
+/// The responses are kept in native memory as spectra, ready to be
+/// convolved. Panners look them up by cell of 2 degrees of azimuth and
+/// elevation: the responses of a cell are interpolated from the three
+/// nearest measurements the first time a panner points into it, then cached
+/// for every panner.
+class HrtfDatabase implements Finalizable {
+  static final NativeFinalizer _finalizer = NativeFinalizer(
+      _dylib.lookup<NativeFinalizerFunction>('tau_hrtf_release'));
+
+  final Pointer<tau_hrtf> _hrtf;
+
+  /// The sample rate of the responses, which must be that of the contexts
+  /// of the panners.
+  final double sampleRate;
+
+  HrtfDatabase._(this._hrtf, this.sampleRate) {
+    _finalizer.attach(this, _hrtf.cast(), detach: this);
+  }
+
+  /// Creates a database of the responses of [left] and [right], which hold
+  /// those of every measurement one after the other, all of the same length
+  /// of up to 512 frames, measured from [azimuths] and [elevations].
+  ///
+  /// Azimuths are in degrees clockwise from the front, 90 being on the
+  /// right, as the azimuths of Web Audio; elevations are in degrees up from
+  /// the horizontal plane. The samples are copied.
+  factory HrtfDatabase({
+    required Float32List left,
+    required Float32List right,
+    required List<double> azimuths,
+    required List<double> elevations,
+    required double sampleRate,
+  }) {
+    final int count = azimuths.length;
+    if (count == 0 ||
+        elevations.length != count ||
+        left.length != right.length ||
+        left.length % count != 0) {
+      throw ArgumentError('Expected as many azimuths as elevations, and '
+          '${left.length} samples a multiple of $count');
+    }
+    final Pointer<Float> native = _bindings
+        .tau_memory_allocate((2 * left.length + 2 * count) * 4)
+        .cast<Float>();
+    if (native == nullptr) {
+      throw StateError('Cannot allocate ${2 * left.length} samples');
+    }
+    try {
+      final Float32List values =
+          native.asTypedList(2 * left.length + 2 * count);
+      values
+        ..setAll(0, left)
+        ..setAll(left.length, right)
+        ..setAll(2 * left.length, azimuths)
+        ..setAll(2 * left.length + count, elevations);
+      final Pointer<tau_hrtf> hrtf = _bindings.tau_hrtf_create(
+          native,
+          native + left.length,
+          native + 2 * left.length,
+          native + 2 * left.length + count,
+          count,
+          left.length ~/ count,
+          sampleRate);
+      if (hrtf == nullptr) {
+        throw ArgumentError('Cannot create a database of $count responses '
+            'of ${left.length ~/ count} frames at $sampleRate Hz');
+      }
+      return HrtfDatabase._(hrtf, sampleRate);
+    } finally {
+      _bindings.tau_memory_release(native.cast());
+    }
+  }
+
+  /// The number of cells whose interpolated responses are cached.
+  int get cachedCells => _bindings.tau_hrtf_cached_cells(_hrtf);
+
+  /// Gives back the native database. Panners using it keep it alive.
+  void dispose() {
+    _finalizer.detach(this);
+    _bindings.tau_hrtf_release(_hrtf);
+  }
+}
@@ -0,0 +1,937 @@
+part of '../tau_ffi.dart';
+
+/// A render graph producing audio as fast as the processor allows, rather
+/// than at the pace of a sound device.
+///
+/// Nodes are created with this context and connected to each other, then to
+/// [destination]. [render] processes the graph on the calling isolate, in
+/// quanta of [renderQuantumSize] frames, so long renders are best done on a
+/// background isolate.
+///
+/// The native graph is released by [dispose], or when the context is garbage
+/// collected.
+class OfflineAudioContext implements Finalizable {
+  static final NativeFinalizer _finalizer = NativeFinalizer(
+      _dylib.lookup<NativeFinalizerFunction>('tau_context_destroy'));
+
+  /// The number of frames the graph processes at a time.
+  static const int renderQuantumSize = TAU_RENDER_QUANTUM_FRAMES;
+
+  final Pointer<tau_context> _context;
+
+  /// The number of channels [render] produces.
+  final int numberOfChannels;
+
+  /// The number of frames [startRendering] produces.
+  final int length;
+
+  /// The sample rate of the rendered audio, in hertz.
+  final double sampleRate;
+
+  /// The node whose input is the rendered audio.
+  late final AudioNode destination =
+      AudioNode._(this, _bindings.tau_context_destination(_context));
+
+  OfflineAudioContext._(
+      this._context, this.numberOfChannels, this.length, this.sampleRate) {
+    _finalizer.attach(this, _context.cast(), detach: this);
+  }
+
+  /// Creates a context rendering [length] frames of [numberOfChannels]
+  /// channels at [sampleRate].
+  factory OfflineAudioContext({
+    int numberOfChannels = 2,
+    required int length,
+    required double sampleRate,
+  }) {
+    if (length <= 0) {
+      throw ArgumentError.value(length, 'length', 'Must be positive');
+    }
+    final Pointer<tau_context> context =
+        _bindings.tau_context_create(numberOfChannels, sampleRate);
+    if (context == nullptr) {
+      throw ArgumentError(
+          'Cannot create a context of $numberOfChannels channels at '
+          '$sampleRate Hz');
+    }
+    return OfflineAudioContext._(context, numberOfChannels, length, sampleRate);
+  }
+
+  /// The time of the next frame to render, in seconds.
+  double get currentTime => _bindings.tau_context_current_time(_context);
+
+  /// The number of threads rendering the graph, 1 by default.
+  ///
+  /// Independent branches of the graph, such as separate voices, render in
+  /// parallel when this is more than 1, with the same result. Setting 0 uses
+  /// one thread per processor.
+  int get renderThreads => _renderThreads;
+  int _renderThreads = 1;
+
+  set renderThreads(int threads) {
+    _checkStatus(
+        _bindings.tau_context_set_render_threads(_context, threads),
+        'renderThreads');
+    _renderThreads = threads > 0 ? threads : Platform.numberOfProcessors;
+  }
+
+  /// The quality of the sample-rate conversion of the sources created next,
+  /// [ResamplerQuality.medium] by default.
+  ///
+  /// Buffer and stream sources convert their sample rate to the one of the
+  /// context with polyphase filters of this quality, which buffer sources
+  /// also use at other playback rates. The filters are designed for the
+  /// sample rates alone, so playback rates above 1 may alias.
+  ResamplerQuality get resamplerQuality => _resamplerQuality;
+  ResamplerQuality _resamplerQuality = ResamplerQuality.medium;
+
+  set resamplerQuality(ResamplerQuality quality) {
+    _checkStatus(
+        _bindings.tau_context_set_resampler_quality(_context, quality._native),
+        'resamplerQuality');
+    _resamplerQuality = quality;
+  }
+
+  /// How long the quanta rendered so far took.
+  ///
+  /// Throws an [UnsupportedError] if the native library was built with
+  /// profiling off.
+  RenderProfile get profile => _readProfile(
+      (Pointer<tau_profile> native) =>
+          _bindings.tau_context_get_profile(_context, native),
+      'profile');
+
+  /// Renders [length] frames.
+  Future<AudioBuffer> startRendering() async => render(length);
+
+  /// Renders the next [frames] frames straight into a new [AudioBuffer].
+  AudioBuffer render(int frames) {
+    final AudioBuffer buffer = AudioBuffer(
+        numberOfChannels: numberOfChannels,
+        length: frames,
+        sampleRate: sampleRate);
+    _checkStatus(
+        _bindings.tau_context_render_buffer(_context, buffer._buffer),
+        'render');
+    return buffer;
+  }
+
+  /// Releases the native graph. The context and its nodes must not be used
+  /// afterwards.
+  void dispose() {
+    _finalizer.detach(this);
+    _bindings.tau_context_destroy(_context);
+  }
+}
+
+/// Throws if [status] is a failing [tau_status].
+int _checkStatus(int status, String operation) {
+  if (status < 0) {
+    throw StateError('$operation failed with status $status');
+  }
+  return status;
+}
+
+/// How long the rendering of an [OfflineAudioContext] or of one of its nodes
+/// took, quantum by quantum.
+///
+/// The rendering thread records every quantum without waiting or allocating,
+/// so the profile of a context rendering on another isolate can be read at
+/// any time, to find which node takes the time when the rendering cannot
+/// keep up.
+class RenderProfile {
+  /// The number of quanta rendered.
+  final int count;
+
+  /// The time the quanta took in total.
+  final Duration total;
+
+  /// The time the longest quantum took.
+  final Duration max;
+
+  /// The number of quanta by duration: `buckets[i]` counts those that took
+  /// from 2^i to 2^(i + 1) nanoseconds. The first also counts shorter ones,
+  /// and the last longer ones.
+  final List<int> buckets;
+
+  /// The real-time duration of a quantum at the sample rate of the context.
+  final Duration deadline;
+
+  /// The number of quanta that took longer than [deadline], which a sound
+  /// device playing the context would have heard as a glitch.
+  final int underruns;
+
+  const RenderProfile._(this.count, this.total, this.max, this.buckets,
+      this.deadline, this.underruns);
+
+  /// The mean time a quantum took.
+  Duration get mean =>
+      count > 0 ? Duration(microseconds: total.inMicroseconds ~/ count) : total;
+
+  @override
+  String toString() => 'RenderProfile(count: $count, mean: $mean, max: $max, '
+      'deadline: $deadline, underruns: $underruns)';
+}
+
+/// Reads a [RenderProfile] with [read], a `tau_*_get_profile` call.
+RenderProfile _readProfile(
+    int Function(Pointer<tau_profile> native) read, String operation) {
+  final Pointer<tau_profile> native = _bindings
+      .tau_memory_allocate(sizeOf<tau_profile>())
+      .cast<tau_profile>();
+  if (native == nullptr) {
+    throw StateError('Cannot allocate a profile');
+  }
+  try {
+    final int status = read(native);
+    if (status == tau_status.TAU_ERROR_NOT_SUPPORTED) {
+      throw UnsupportedError('Profiling is compiled out of the library');
+    }
+    _checkStatus(status, operation);
+    final tau_profile profile = native.ref;
+    return RenderProfile._(
+        profile.count,
+        Duration(microseconds: profile.total_ns ~/ 1000),
+        Duration(microseconds: profile.max_ns ~/ 1000),
+        List<int>.unmodifiable(List<int>.generate(
+            TAU_PROFILE_BUCKETS, (int i) => profile.buckets[i])),
+        Duration(microseconds: profile.deadline_ns ~/ 1000),
+        profile.underruns);
+  } finally {
+    _bindings.tau_memory_release(native.cast());
+  }
+}
+
+/// A node of an [OfflineAudioContext].
+class AudioNode {
+  /// The context the node belongs to.
+  final OfflineAudioContext context;
+  final int _handle;
+
+  AudioNode._(this.context, this._handle);
+
+  /// Sends the output of this node to the input of [destination], and returns
+  /// [destination].
+  AudioNode connect(AudioNode destination) {
+    _checkStatus(
+        _bindings.tau_node_connect(
+            context._context, _handle, destination._handle),
+        'connect');
+    return destination;
+  }
+
+  /// Removes the connection to [destination].
+  void disconnect(AudioNode destination) {
+    _checkStatus(
+        _bindings.tau_node_disconnect(
+            context._context, _handle, destination._handle),
+        'disconnect');
+  }
+
+  /// How long this node took to mix its input and process it, over the
+  /// quanta it was part of the graph.
+  ///
+  /// Throws an [UnsupportedError] if the native library was built with
+  /// profiling off.
+  RenderProfile get profile => _readProfile(
+      (Pointer<tau_profile> native) =>
+          _bindings.tau_node_get_profile(context._context, _handle, native),
+      'profile');
+
+  /// Disconnects the node and frees it. The node must not be used afterwards.
+  void release() {
+    _checkStatus(
+        _bindings.tau_node_release(context._context, _handle), 'release');
+  }
+}
+
+/// A value of an [AudioNode] that shapes its processing.
+///
+/// Changes are scheduled on a timeline as with the Web Audio `AudioParam`,
+/// in seconds of context time, and apply from the exact frame they fall on.
+/// The timeline is evaluated natively a render quantum at a time, and costs
+/// nothing over the quanta no event changes. Each method returns the
+/// parameter, so that calls can be chained.
+class AudioParam {
+  final AudioNode _node;
+  final int _id;
+
+  AudioParam._(this._node, this._id);
+
+  Pointer<tau_context> get _context => _node.context._context;
+
+  /// The value at the start of the last quantum rendered.
+  double get value =>
+      _bindings.tau_param_get_value(_context, _node._handle, _id);
+
+  /// Sets the value, at the current time once events were scheduled.
+  set value(double value) {
+    _checkStatus(
+        _bindings.tau_param_set_value(_context, _node._handle, _id, value),
+        'set value');
+  }
+
+  /// Sets the value to [value] at [startTime].
+  AudioParam setValueAtTime(double value, double startTime) {
+    _checkStatus(
+        _bindings.tau_param_set_value_at_time(
+            _context, _node._handle, _id, value, startTime),
+        'setValueAtTime');
+    return this;
+  }
+
+  /// Ramps linearly from the previous event to [value] at [endTime].
+  AudioParam linearRampToValueAtTime(double value, double endTime) {
+    _checkStatus(
+        _bindings.tau_param_linear_ramp_to_value_at_time(
+            _context, _node._handle, _id, value, endTime),
+        'linearRampToValueAtTime');
+    return this;
+  }
+
+  /// Ramps exponentially from the previous event to [value], which must not
+  /// be 0, at [endTime].
+  AudioParam exponentialRampToValueAtTime(double value, double endTime) {
+    _checkStatus(
+        _bindings.tau_param_exponential_ramp_to_value_at_time(
+            _context, _node._handle, _id, value, endTime),
+        'exponentialRampToValueAtTime');
+    return this;
+  }
+
+  /// Approaches [target] exponentially from [startTime], with a time
+  /// constant of [timeConstant] seconds.
+  AudioParam setTargetAtTime(
+      double target, double startTime, double timeConstant) {
+    _checkStatus(
+        _bindings.tau_param_set_target_at_time(
+            _context, _node._handle, _id, target, startTime, timeConstant),
+        'setTargetAtTime');
+    return this;
+  }
+
+  /// Follows [values], interpolated linearly over [duration] seconds from
+  /// [startTime]. The values are copied.
+  AudioParam setValueCurveAtTime(
+      Float32List values, double startTime, double duration) {
+    final Pointer<Float> native =
+        _bindings.tau_memory_allocate(values.length * 4).cast<Float>();
+    if (native == nullptr) {
+      throw StateError('Cannot allocate ${values.length} values');
+    }
+    try {
+      native.asTypedList(values.length).setAll(0, values);
+      _checkStatus(
+          _bindings.tau_param_set_value_curve_at_time(_context, _node._handle,
+              _id, native, values.length, startTime, duration),
+          'setValueCurveAtTime');
+    } finally {
+      _bindings.tau_memory_release(native.cast());
+    }
+    return this;
+  }
+
+  /// Removes the events scheduled at [cancelTime] or later.
+  AudioParam cancelScheduledValues(double cancelTime) {
+    _checkStatus(
+        _bindings.tau_param_cancel_scheduled_values(
+            _context, _node._handle, _id, cancelTime),
+        'cancelScheduledValues');
+    return this;
+  }
+}
+
+/// A node producing sound between [start] and [stop].
+class AudioScheduledSourceNode extends AudioNode {
+  AudioScheduledSourceNode._(super.context, super.handle) : super._();
+
+  /// Starts playing at [when] seconds of context time, or right away.
+  void start([double when = 0]) {
+    _checkStatus(
+        _bindings.tau_node_start(context._context, _handle, when), 'start');
+  }
+
+  /// Stops playing at [when] seconds of context time, or right away.
+  void stop([double when = 0]) {
+    _checkStatus(
+        _bindings.tau_node_stop(context._context, _handle, when), 'stop');
+  }
+}
+
+/// The quality tiers of the sample-rate conversion of sources.
+enum ResamplerQuality {
+  /// Linear interpolation between neighbouring samples, as Web Audio
+  /// implementations do. Aliases audibly.
+  linear(tau_resampler_quality.TAU_RESAMPLER_LINEAR),
+
+  /// Filters attenuating what the output rate cannot represent by 60 dB.
+  low(tau_resampler_quality.TAU_RESAMPLER_LOW),
+
+  /// Filters attenuating what the output rate cannot represent by 90 dB.
+  medium(tau_resampler_quality.TAU_RESAMPLER_MEDIUM),
+
+  /// Filters attenuating what the output rate cannot represent by 120 dB.
+  high(tau_resampler_quality.TAU_RESAMPLER_HIGH);
+
+  final int _native;
+
+  const ResamplerQuality(this._native);
+}
+
+/// The waveforms of an [OscillatorNode].
+enum OscillatorType {
+  sine(tau_oscillator_type.TAU_OSCILLATOR_SINE),
+  square(tau_oscillator_type.TAU_OSCILLATOR_SQUARE),
+  sawtooth(tau_oscillator_type.TAU_OSCILLATOR_SAWTOOTH),
+  triangle(tau_oscillator_type.TAU_OSCILLATOR_TRIANGLE);
+
+  final int _native;
+
+  const OscillatorType(this._native);
+}
+
+/// A periodic waveform.
+class OscillatorNode extends AudioScheduledSourceNode {
+  /// The frequency, in hertz.
+  late final AudioParam frequency =
+      AudioParam._(this, tau_param_id.TAU_PARAM_FREQUENCY);
+
+  /// The detune of [frequency], in cents.
+  late final AudioParam detune =
+      AudioParam._(this, tau_param_id.TAU_PARAM_DETUNE);
+
+  OscillatorNode._(super.context, super.handle) : super._();
+
+  factory OscillatorNode(
+    OfflineAudioContext context, {
+    OscillatorType type = OscillatorType.sine,
+    double frequency = 440,
+  }) {
+    final int handle = _checkStatus(
+        _bindings.tau_oscillator_create(
+            context._context, type._native, frequency),
+        'create oscillator');
+    return OscillatorNode._(context, handle);
+  }
+}
+
+/// A node multiplying its input by [gain].
+class GainNode extends AudioNode {
+  /// The gain.
+  late final AudioParam gain = AudioParam._(this, tau_param_id.TAU_PARAM_GAIN);
+
+  GainNode._(super.context, super.handle) : super._();
+
+  factory GainNode(OfflineAudioContext context, {double gain = 1}) {
+    final int handle = _checkStatus(
+        _bindings.tau_gain_create(context._context, gain), 'create gain');
+    return GainNode._(context, handle);
+  }
+}
+
+/// A source playing recorded samples.
+class AudioBufferSourceNode extends AudioScheduledSourceNode {
+  /// The playback speed, 1 being the recorded speed. Evaluated once per
+  /// render quantum, as in Web Audio.
+  late final AudioParam playbackRate =
+      AudioParam._(this, tau_param_id.TAU_PARAM_PLAYBACK_RATE);
+
+  /// The detune of [playbackRate], in cents, evaluated once per quantum.
+  late final AudioParam detune =
+      AudioParam._(this, tau_param_id.TAU_PARAM_DETUNE);
+
+  AudioBufferSourceNode._(super.context, super.handle) : super._();
+
+  /// Creates a source playing [buffer], which it reads in place.
+  factory AudioBufferSourceNode(
+    OfflineAudioContext context,
+    AudioBuffer buffer, {
+    bool loop = false,
+  }) {
+    final int handle = _checkStatus(
+        _bindings.tau_buffer_source_create(
+            context._context, buffer._buffer, loop ? 1 : 0),
+        'create buffer source');
+    return AudioBufferSourceNode._(context, handle);
+  }
+}
+
+/// The counters of a [VoicePool].
+class VoicePoolStats {
+  /// The voices of the pool.
+  final int voices;
+
+  /// The voices playing a note or scheduled to.
+  final int playing;
+
+  /// The notes played since the pool was created.
+  final int notes;
+
+  /// The notes that cut off the oldest one because every voice was playing.
+  final int steals;
+
+  const VoicePoolStats._(this.voices, this.playing, this.notes, this.steals);
+
+  @override
+  String toString() => 'VoicePoolStats(voices: $voices, playing: $playing, '
+      'notes: $notes, steals: $steals)';
+}
+
+/// A source playing buffers on a fixed number of voices, for instruments and
+/// games playing many short notes.
+///
+/// Every [AudioBufferSourceNode] is a node of its own, created, connected
+/// and released for a single note. A note of the pool takes a free voice
+/// instead, or the one playing the oldest note: it is an integer handle
+/// rather than an object, and playing it neither allocates nor changes the
+/// graph.
+class VoicePool extends AudioNode {
+  /// The number of notes that play at once at most.
+  final int voices;
+
+  VoicePool._(super.context, super.handle, this.voices) : super._();
+
+  /// Creates a pool of [voices] voices, from 1 to 1024, mixed to
+  /// [numberOfChannels] channels.
+  factory VoicePool(
+    OfflineAudioContext context, {
+    int voices = 32,
+    int numberOfChannels = 2,
+  }) {
+    final int handle = _checkStatus(
+        _bindings.tau_voice_pool_create(
+            context._context, voices, numberOfChannels),
+        'create voice pool');
+    return VoicePool._(context, handle, voices);
+  }
+
+  /// Plays [buffer] at [when] seconds of context time, or right away, at
+  /// [playbackRate] times its speed and scaled by [gain].
+  ///
+  /// The voice reads [buffer] in place, and keeps it until it plays another
+  /// note. Returns the handle of the note, for [stop].
+  int play(
+    AudioBuffer buffer, {
+    double when = 0,
+    bool loop = false,
+    double playbackRate = 1,
+    double gain = 1,
+  }) =>
+      _checkStatus(
+          _bindings.tau_voice_pool_play(context._context, _handle,
+              buffer._buffer, when, loop ? 1 : 0, playbackRate, gain),
+          'play');
+
+  /// Stops the note [voice] at [when] seconds of context time, or right
+  /// away. Does nothing once the note is over.
+  void stop(int voice, [double when = 0]) {
+    _checkStatus(
+        _bindings.tau_voice_pool_stop(context._context, _handle, voice, when),
+        'stop');
+  }
+
+  /// The counters of this pool.
+  VoicePoolStats get stats {
+    final Pointer<tau_voice_pool_stats> native = _bindings
+        .tau_memory_allocate(sizeOf<tau_voice_pool_stats>())
+        .cast<tau_voice_pool_stats>();
+    if (native == nullptr) {
+      throw StateError('Cannot allocate voice pool stats');
+    }
+    try {
+      _checkStatus(
+          _bindings.tau_voice_pool_get_stats(
+              context._context, _handle, native),
+          'stats');
+      final tau_voice_pool_stats stats = native.ref;
+      return VoicePoolStats._(
+          stats.voices, stats.playing, stats.notes, stats.steals);
+    } finally {
+      _bindings.tau_memory_release(native.cast());
+    }
+  }
+}
+
+/// A node applying an impulse response, such as the reverb of a room.
+///
+/// The convolution is computed with FFTs, so responses of several seconds
+/// are cheap, and adds no latency. The input is mixed to as many channels as
+/// [buffer], each convolved with the same channel of the response.
+class ConvolverNode extends AudioNode {
+  ConvolverNode._(super.context, super.handle) : super._();
+
+  /// Creates a convolver applying [buffer], at the sample rate of [context].
+  /// With [normalize], the response is scaled to a standard power first.
+  factory ConvolverNode(
+    OfflineAudioContext context,
+    AudioBuffer buffer, {
+    bool normalize = true,
+  }) {
+    final int handle = _checkStatus(
+        _bindings.tau_convolver_create(
+            context._context, buffer._buffer, normalize ? 1 : 0),
+        'create convolver');
+    return ConvolverNode._(context, handle);
+  }
+}
+
+/// The kinds of band of a [BiquadFilterNode], as the Web Audio
+/// `BiquadFilterType`.
+enum BiquadFilterType {
+  lowpass(tau_biquad_type.TAU_BIQUAD_LOWPASS),
+  highpass(tau_biquad_type.TAU_BIQUAD_HIGHPASS),
+  bandpass(tau_biquad_type.TAU_BIQUAD_BANDPASS),
+  lowshelf(tau_biquad_type.TAU_BIQUAD_LOWSHELF),
+  highshelf(tau_biquad_type.TAU_BIQUAD_HIGHSHELF),
+  peaking(tau_biquad_type.TAU_BIQUAD_PEAKING),
+  notch(tau_biquad_type.TAU_BIQUAD_NOTCH),
+  allpass(tau_biquad_type.TAU_BIQUAD_ALLPASS);
+
+  final int _native;
+
+  const BiquadFilterType(this._native);
+}
+
+/// A band of a [BiquadFilterNode]: a second-order filter of its own type
+/// and parameters.
+class BiquadFilterBand {
+  final BiquadFilterNode _node;
+  final int _index;
+
+  /// The frequency, in hertz.
+  late final AudioParam frequency =
+      AudioParam._(_node, _id(tau_param_id.TAU_PARAM_FREQUENCY));
+
+  /// The detune of [frequency], in cents.
+  late final AudioParam detune =
+      AudioParam._(_node, _id(tau_param_id.TAU_PARAM_DETUNE));
+
+  /// The quality factor, in decibels for the lowpass and highpass types,
+  /// and unused by the shelves.
+  late final AudioParam q = AudioParam._(_node, _id(tau_param_id.TAU_PARAM_Q));
+
+  /// The gain, in decibels, of the shelves and the peaking type.
+  late final AudioParam gain =
+      AudioParam._(_node, _id(tau_param_id.TAU_PARAM_GAIN));
+
+  BiquadFilterBand._(this._node, this._index, this._type);
+
+  int _id(int param) => param + _index * TAU_BIQUAD_BAND_STRIDE;
+
+  /// The kind of filter, from the next quantum when set.
+  BiquadFilterType get type => _type;
+  BiquadFilterType _type;
+
+  set type(BiquadFilterType value) {
+    _checkStatus(
+        _bindings.tau_biquad_filter_set_type(
+            _node.context._context, _node._handle, _index, value._native),
+        'type');
+    _type = value;
+  }
+}
+
+/// A second-order filter, as the Web Audio `BiquadFilterNode`, or several
+/// in series, as the [bands] of an equalizer.
+///
+/// Every band of every channel is filtered side by side with the others in
+/// vector registers, and the coefficients of a band are only computed again
+/// when its type or parameters change. The output has as many channels as
+/// the input.
+class BiquadFilterNode extends AudioNode {
+  /// The bands, in the order they filter the input, from 1 to 32.
+  late final List<BiquadFilterBand> bands;
+
+  BiquadFilterNode._(super.context, super.handle) : super._();
+
+  /// Creates a filter of [bands] bands of [type], each at [frequency],
+  /// with [q] and [gain].
+  factory BiquadFilterNode(
+    OfflineAudioContext context, {
+    BiquadFilterType type = BiquadFilterType.lowpass,
+    int bands = 1,
+    double? frequency,
+    double? q,
+    double? gain,
+  }) {
+    final int handle = _checkStatus(
+        _bindings.tau_biquad_filter_create(
+            context._context, type._native, bands),
+        'create biquad filter');
+    final BiquadFilterNode node = BiquadFilterNode._(context, handle);
+    node.bands = List<BiquadFilterBand>.unmodifiable(<BiquadFilterBand>[
+      for (int i = 0; i < bands; i++) BiquadFilterBand._(node, i, type),
+    ]);
+    for (final BiquadFilterBand band in node.bands) {
+      if (frequency != null) {
+        band.frequency.value = frequency;
+      }
+      if (q != null) {
+        band.q.value = q;
+      }
+      if (gain != null) {
+        band.gain.value = gain;
+      }
+    }
+    return node;
+  }
+
+  /// The type of the first band.
+  BiquadFilterType get type => bands[0].type;
+  set type(BiquadFilterType value) => bands[0].type = value;
+
+  /// The frequency of the first band, in hertz.
+  AudioParam get frequency => bands[0].frequency;
+
+  /// The detune of the first band, in cents.
+  AudioParam get detune => bands[0].detune;
+
+  /// The quality factor of the first band.
+  AudioParam get q => bands[0].q;
+
+  /// The gain of the first band, in decibels.
+  AudioParam get gain => bands[0].gain;
+}
+
+/// A compressor, as the Web Audio `DynamicsCompressorNode`, lowering the
+/// gain of its input as its loudest channel rises above [threshold].
+///
+/// The input is delayed by 6 ms of lookahead, so that the gain has come
+/// down by the time a peak comes out. The gain moves every 32 frames and
+/// ramps in between, and the conversions between decibels and amplitudes
+/// run on vectors of frames. Its parameters are evaluated once per render
+/// quantum, as in Web Audio. The output has as many channels as the input.
+class DynamicsCompressorNode extends AudioNode {
+  /// The level above which the input is compressed, in decibels.
+  late final AudioParam threshold =
+      AudioParam._(this, tau_param_id.TAU_PARAM_THRESHOLD);
+
+  /// The width of the soft knee above [threshold], in decibels.
+  late final AudioParam knee = AudioParam._(this, tau_param_id.TAU_PARAM_KNEE);
+
+  /// The decibels of input above the knee for one decibel of output.
+  late final AudioParam ratio =
+      AudioParam._(this, tau_param_id.TAU_PARAM_RATIO);
+
+  /// The seconds the gain takes to come down by about two thirds.
+  late final AudioParam attack =
+      AudioParam._(this, tau_param_id.TAU_PARAM_ATTACK);
+
+  /// The seconds the gain takes to come back up by about two thirds.
+  late final AudioParam release =
+      AudioParam._(this, tau_param_id.TAU_PARAM_RELEASE);
+
+  DynamicsCompressorNode._(super.context, super.handle) : super._();
+
+  factory DynamicsCompressorNode(
+    OfflineAudioContext context, {
+    double? threshold,
+    double? knee,
+    double? ratio,
+    double? attack,
+    double? release,
+  }) {
+    final int handle = _checkStatus(
+        _bindings.tau_compressor_create(context._context),
+        'create compressor');
+    final DynamicsCompressorNode node =
+        DynamicsCompressorNode._(context, handle);
+    if (threshold != null) {
+      node.threshold.value = threshold;
+    }
+    if (knee != null) {
+      node.knee.value = knee;
+    }
+    if (ratio != null) {
+      node.ratio.value = ratio;
+    }
+    if (attack != null) {
+      node.attack.value = attack;
+    }
+    if (release != null) {
+      node.release.value = release;
+    }
+    return node;
+  }
+
+  /// The gain reduction at the end of the last quantum rendered, in
+  /// decibels: 0 or less, without the makeup gain.
+  double get reduction =>
+      _bindings.tau_compressor_reduction(context._context, _handle);
+}
+
+/// A node placing its input, down-mixed to mono, around the listener in
+/// stereo, as the Web Audio `PannerNode`.
+///
+/// The listener stands at the origin, facing -z with +y up. With an [hrtf],
+/// the panning model is `HRTF`: the input is convolved with the responses
+/// of its direction, by FFT in native code, and a source that stays within
+/// 2 degrees costs the convolution alone. Without, the model is
+/// `equalpower`. The source is omnidirectional, and its gain follows the
+/// inverse distance model with the default parameters of Web Audio. The
+/// position is evaluated once per render quantum.
+class PannerNode extends AudioNode {
+  /// The responses of the `HRTF` model, or null for `equalpower`.
+  final HrtfDatabase? hrtf;
+
+  /// The position of the source.
+  late final AudioParam positionX =
+      AudioParam._(this, tau_param_id.TAU_PARAM_POSITION_X);
+  late final AudioParam positionY =
+      AudioParam._(this, tau_param_id.TAU_PARAM_POSITION_Y);
+  late final AudioParam positionZ =
+      AudioParam._(this, tau_param_id.TAU_PARAM_POSITION_Z);
+
+  PannerNode._(super.context, super.handle, this.hrtf) : super._();
+
+  factory PannerNode(
+    OfflineAudioContext context, {
+    HrtfDatabase? hrtf,
+    double positionX = 0,
+    double positionY = 0,
+    double positionZ = 0,
+  }) {
+    final int handle = _checkStatus(
+        _bindings.tau_panner_create(context._context, hrtf?._hrtf ?? nullptr),
+        'create panner');
+    final PannerNode node = PannerNode._(context, handle, hrtf);
+    node.positionX.value = positionX;
+    node.positionY.value = positionY;
+    node.positionZ.value = positionZ;
+    return node;
+  }
+}
+
+/// A node whose quanta an [AudioWorkletProcessor] processes on the isolate
+/// of an [AudioWorklet], as the Web Audio `AudioWorkletNode`.
+///
+/// The output lags the input by [latency] quanta: the time the isolate has
+/// for each quantum. In real time, a quantum the isolate has not processed
+/// in time is output as silence and counted in [underruns]. A node created
+/// with `blocking`, for offline rendering, waits for the isolate instead.
+class AudioWorkletNode extends AudioNode {
+  /// The worklet running the processor of the node.
+  final AudioWorklet worklet;
+
+  /// The quanta the output lags the input by, from 1 to 16.
+  final int latency;
+
+  final int _key;
+
+  AudioWorkletNode._(
+      super.context, super.handle, this.worklet, this.latency, this._key)
+      : super._();
+
+  /// Creates a node running the processor of [worklet] named [name], with
+  /// [numberOfInputChannels] input channels, mixed as an explicit channel
+  /// count, and [numberOfOutputChannels] output channels.
+  factory AudioWorkletNode(
+    OfflineAudioContext context,
+    AudioWorklet worklet,
+    String name, {
+    int numberOfInputChannels = 2,
+    int numberOfOutputChannels = 2,
+    int latency = 1,
+    bool blocking = false,
+  }) {
+    final int key = worklet._key(name);
+    final int handle = _checkStatus(
+        _bindings.tau_worklet_create(
+            context._context,
+            worklet._host,
+            key,
+            numberOfInputChannels,
+            numberOfOutputChannels,
+            latency,
+            blocking ? 1 : 0),
+        'create worklet node');
+    return AudioWorkletNode._(context, handle, worklet, latency, key);
+  }
+
+  /// The quanta output as silence because the isolate had not processed
+  /// them in time.
+  int get underruns => _checkStatus(
+      _bindings.tau_worklet_underruns(context._context, _handle), 'underruns');
+
+  @override
+  void release() {
+    super.release();
+    worklet._forget(_key);
+  }
+}
+
+/// A node passing its input through, which keeps its last [fftSize] frames,
+/// down-mixed to mono, and their spectrum, as the Web Audio `AnalyserNode`.
+///
+/// The rendering thread only copies each quantum into a ring, without
+/// waiting: the spectrum is computed when asked for, and only once per batch
+/// of new frames. The data is written to native memory that the returned
+/// lists view, so polling copies nothing into the Dart heap; the next call
+/// overwrites it. Like every node, the analyser only renders while its
+/// output reaches the destination.
+class AnalyserNode extends AudioNode {
+  /// The number of frames analysed, a power of two from 32 to 32768.
+  final int fftSize;
+
+  late final AudioBuffer _frequencyData = _buffer(
+      _bindings.tau_analyser_frequency_buffer(context._context, _handle));
+  late final AudioBuffer _timeDomainData = _buffer(
+      _bindings.tau_analyser_time_domain_buffer(context._context, _handle));
+
+  AnalyserNode._(super.context, super.handle, this.fftSize) : super._();
+
+  factory AnalyserNode(
+    OfflineAudioContext context, {
+    int fftSize = 2048,
+    double smoothingTimeConstant = 0.8,
+  }) {
+    final int handle = _checkStatus(
+        _bindings.tau_analyser_create(context._context, fftSize),
+        'create analyser');
+    return AnalyserNode._(context, handle, fftSize)
+      ..smoothingTimeConstant = smoothingTimeConstant;
+  }
+
+  /// The number of bins of the spectrum, each `sampleRate / fftSize` hertz
+  /// wide.
+  int get frequencyBinCount => fftSize ~/ 2;
+
+  /// How much of the previous spectrum every new one keeps, from 0 to 1.
+  double get smoothingTimeConstant => _smoothingTimeConstant;
+  double _smoothingTimeConstant = 0.8;
+
+  set smoothingTimeConstant(double value) {
+    _checkStatus(
+        _bindings.tau_analyser_set_smoothing(
+            context._context, _handle, value),
+        'smoothingTimeConstant');
+    _smoothingTimeConstant = value;
+  }
+
+  /// The spectrum of the last [fftSize] frames, in decibels: the smoothed
+  /// magnitudes of the Blackman-windowed frames, [frequencyBinCount] of
+  /// them.
+  Float32List getFloatFrequencyData() {
+    _checkStatus(
+        _bindings.tau_analyser_get_float_frequency_data(
+            context._context, _handle),
+        'getFloatFrequencyData');
+    return _frequencyData.getChannelData(0);
+  }
+
+  /// The last [fftSize] frames.
+  Float32List getFloatTimeDomainData() {
+    _checkStatus(
+        _bindings.tau_analyser_get_float_time_domain_data(
+            context._context, _handle),
+        'getFloatTimeDomainData');
+    return _timeDomainData.getChannelData(0);
+  }
+
+  static AudioBuffer _buffer(Pointer<tau_audio_buffer> buffer) {
+    if (buffer == nullptr) {
+      throw StateError('The analyser was released');
+    }
+    return AudioBuffer._(buffer);
+  }
+}
@@ -1,11 +1,20 @@
-
 import 'dart:async';
+import 'dart:collection';
+import 'dart:convert';
 import 'dart:ffi';
 import 'dart:io';
 import 'dart:isolate';
+import 'dart:typed_data';
 
 import 'tau_ffi_bindings_generated.dart';
 
+part 'src/audio_buffer.dart';
+part 'src/audio_buffer_cache.dart';
+part 'src/audio_stream.dart';
+part 'src/audio_worklet.dart';
+part 'src/hrtf_database.dart';
+part 'src/offline_audio_context.dart';
+
 /// A very short-lived native function.
 ///
 /// For very short-lived functions, it is fine to call them on the main isolate.
@@ -15,22 +24,95 @@ int sum(int a, int b) => _bindings.sum(a, b);
 
 /// A longer lived native function, which occupies the thread calling it.
 ///
-/// Do not call these kind of native functions in the main isolate. They will
-/// block Dart execution. This will cause dropped frames in Flutter applications.
-/// Instead, call these native functions on a separate isolate.
+/// The call is queued on a pool of native worker threads, one per core, so
+/// that the calling isolate is never blocked and concurrent requests do not
+/// wait for each other. Requests and results travel through shared native
+/// memory (see [_RequestRing]) rather than as one message each.
+Future<int> sumAsync(int a, int b) =>
+    _sumRing.request(tau_opcode.TAU_OP_SUM_LONG_RUNNING, a, b);
+
+/// A buffer of arithmetic commands executed by a single native call.
 ///
-/// Modify this to suit your own use case. Example use cases:
+/// [add] only writes into native memory; [execute] then crosses into native
+/// code once for the whole buffer instead of once per command, which is what
+/// dominates when thousands of tiny operations are issued per frame.
 ///
-/// 1. Reuse a single isolate for various different kinds of requests.
-/// 2. Use multiple helper isolates for parallel execution.
-Future<int> sumAsync(int a, int b) async {
-  final SendPort helperIsolateSendPort = await _helperIsolateSendPort;
-  final int requestId = _nextSumRequestId++;
-  final _SumRequest request = _SumRequest(requestId, a, b);
-  final Completer<int> completer = Completer<int>();
-  _sumRequests[requestId] = completer;
-  helperIsolateSendPort.send(request);
-  return completer.future;
+/// The native buffer is released by [dispose], or when the batch is garbage
+/// collected.
+class Batch implements Finalizable {
+  static final NativeFinalizer _finalizer = NativeFinalizer(
+      _dylib.lookup<NativeFinalizerFunction>('tau_batch_destroy'));
+
+  final Pointer<tau_batch> _batch;
+  final Int32List _opcodes;
+  final Int32List _a;
+  final Int32List _b;
+  final Int32List _results;
+  int _length = 0;
+
+  /// The maximum number of commands the batch holds.
+  final int capacity;
+
+  Batch._(this._batch, this.capacity)
+      : _opcodes = _batch.ref.opcodes.asTypedList(capacity),
+        _a = _batch.ref.a.asTypedList(capacity),
+        _b = _batch.ref.b.asTypedList(capacity),
+        _results = _batch.ref.results.asTypedList(capacity) {
+    _finalizer.attach(this, _batch.cast(), detach: this);
+  }
+
+  /// Allocates a native batch of [capacity] commands.
+  factory Batch(int capacity) {
+    final Pointer<tau_batch> batch = _bindings.tau_batch_create(capacity);
+    if (batch == nullptr) {
+      throw ArgumentError.value(capacity, 'capacity', 'Cannot allocate batch');
+    }
+    return Batch._(batch, capacity);
+  }
+
+  /// The number of commands added since the last [clear].
+  int get length => _length;
+
+  /// Appends `opcode(a, b)`, one of the [tau_opcode] values, and returns the
+  /// index at which [result] will find its value after [execute].
+  int add(int opcode, int a, int b) {
+    if (_length == capacity) {
+      throw StateError('Batch is full ($capacity commands)');
+    }
+    final int index = _length++;
+    _opcodes[index] = opcode;
+    _a[index] = a;
+    _b[index] = b;
+    return index;
+  }
+
+  /// Appends `sum(a, b)`.
+  int addSum(int a, int b) => add(tau_opcode.TAU_OP_SUM, a, b);
+
+  /// Runs every added command in one native call.
+  void execute() {
+    _batch.ref.count = _length;
+    final int executed = _bindings.tau_batch_execute(_batch);
+    if (executed != _length) {
+      throw ArgumentError(
+          'Unknown opcode ${_opcodes[executed]} at index $executed');
+    }
+  }
+
+  /// The result of the command at [index] after the last [execute].
+  int result(int index) {
+    RangeError.checkValidIndex(index, this, 'index', _length);
+    return _results[index];
+  }
+
+  /// Forgets every added command, keeping the native buffer.
+  void clear() => _length = 0;
+
+  /// Releases the native buffer. The batch must not be used afterwards.
+  void dispose() {
+    _finalizer.detach(this);
+    _bindings.tau_batch_destroy(_batch);
+  }
 }
 
 const String _libName = 'tau_ffi';
@@ -53,79 +135,124 @@ final DynamicLibrary _dylib = () {
 final TauFfiBindings _bindings = TauFfiBindings(_dylib);
 
 
-/// A request to compute `sum`.
-///
-/// Typically sent from one isolate to another.
-class _SumRequest {
-  final int id;
+/// The ring carrying the requests made by [sumAsync].
+final _RequestRing _sumRing = _RequestRing(1024);
+
+/// A request waiting for a free slot in a [_RequestRing].
+class _WaitingRequest {
+  final int opcode;
   final int a;
   final int b;
+  final Completer<int> completer;
 
-  const _SumRequest(this.id, this.a, this.b);
+  const _WaitingRequest(this.opcode, this.a, this.b, this.completer);
 }
 
-/// A response with the result of `sum`.
+/// The Dart side of a native `tau_ring`.
 ///
-/// Typically sent from one isolate to another.
-class _SumResponse {
-  final int id;
-  final int result;
+/// Requests are written straight into the native request slots, and all the
+/// requests made during one event-loop turn are published with a single
+/// `tau_ring_submit`. The native side posts to its port only when completions
+/// become ready while none are pending, and every ready completion is then
+/// drained at once. Completers are found by slot index, not through a map.
+///
+/// Requests complete out of order, so a slot is only written again once the
+/// request that used it before has completed: a request whose slot is still
+/// taken waits, along with every request after it, in [_waiting].
+class _RequestRing {
+  final Pointer<tau_ring> _ring;
+  final int _mask;
+  // Four 32-bit words per slot: opcode, a, b, reserved.
+  final Int32List _requests;
+  // Four 32-bit words per slot: the low and high words of the sequence, the
+  // result and the status. Every Flutter target is little-endian.
+  final Int32List _completions;
+  final List<Completer<int>?> _completers;
+  final ListQueue<_WaitingRequest> _waiting = ListQueue<_WaitingRequest>();
 
-  const _SumResponse(this.id, this.result);
-}
+  /// Position of the next request to write.
+  int _end = 0;
 
-/// Counter to identify [_SumRequest]s and [_SumResponse]s.
-int _nextSumRequestId = 0;
-
-/// Mapping from [_SumRequest] `id`s to the completers corresponding to the correct future of the pending request.
-final Map<int, Completer<int>> _sumRequests = <int, Completer<int>>{};
-
-/// The SendPort belonging to the helper isolate.
-Future<SendPort> _helperIsolateSendPort = () async {
-  // The helper isolate is going to send us back a SendPort, which we want to
-  // wait for.
-  final Completer<SendPort> completer = Completer<SendPort>();
-
-  // Receive port on the main isolate to receive messages from the helper.
-  // We receive two types of messages:
-  // 1. A port to send messages on.
-  // 2. Responses to requests we sent.
-  final ReceivePort receivePort = ReceivePort()
-    ..listen((dynamic data) {
-      if (data is SendPort) {
-        // The helper isolate sent us the port on which we can sent it requests.
-        completer.complete(data);
-        return;
-      }
-      if (data is _SumResponse) {
-        // The helper isolate sent us a response to a request we sent.
-        final Completer<int> completer = _sumRequests[data.id]!;
-        _sumRequests.remove(data.id);
-        completer.complete(data.result);
-        return;
+  /// Number of completions drained so far.
+  int _released = 0;
+  bool _submitScheduled = false;
+
+  _RequestRing._(this._ring, int capacity)
+      : _mask = capacity - 1,
+        _requests = _bindings
+            .tau_ring_requests(_ring)
+            .cast<Int32>()
+            .asTypedList(capacity * 4),
+        _completions = _bindings
+            .tau_ring_completions(_ring)
+            .cast<Int32>()
+            .asTypedList(capacity * 4),
+        _completers = List<Completer<int>?>.filled(capacity, null);
+
+  factory _RequestRing(int capacity) {
+    _bindings.tau_async_init(NativeApi.postCObject.cast());
+    final RawReceivePort port = RawReceivePort();
+    final Pointer<tau_ring> ring =
+        _bindings.tau_ring_create(capacity, port.sendPort.nativePort);
+    if (ring == nullptr) {
+      port.close();
+      throw StateError('Cannot create a request ring of $capacity slots');
+    }
+    final _RequestRing self =
+        _RequestRing._(ring, _bindings.tau_ring_capacity(ring));
+    port.handler = (dynamic _) => self._drain();
+    return self;
+  }
+
+  /// Queues `opcode(a, b)`, one of the [tau_opcode] values.
+  Future<int> request(int opcode, int a, int b) {
+    final Completer<int> completer = Completer<int>();
+    if (_waiting.isNotEmpty || _completers[_end & _mask] != null) {
+      _waiting.add(_WaitingRequest(opcode, a, b, completer));
+    } else {
+      _write(opcode, a, b, completer);
+    }
+    return completer.future;
+  }
+
+  void _write(int opcode, int a, int b, Completer<int> completer) {
+    final int slot = _end & _mask;
+    _requests[slot * 4] = opcode;
+    _requests[slot * 4 + 1] = a;
+    _requests[slot * 4 + 2] = b;
+    _completers[slot] = completer;
+    _end++;
+    if (!_submitScheduled) {
+      _submitScheduled = true;
+      scheduleMicrotask(_submit);
+    }
+  }
+
+  void _submit() {
+    _submitScheduled = false;
+    final int status = _bindings.tau_ring_submit(_ring, _end);
+    assert(status == tau_status.TAU_OK);
+  }
+
+  void _drain() {
+    final int ready = _bindings.tau_ring_poll(_ring);
+    for (int i = 0; i < ready; i++) {
+      final int base = ((_released + i) & _mask) * 4;
+      final int slot = _completions[base] & _mask;
+      final Completer<int> completer = _completers[slot]!;
+      _completers[slot] = null;
+      if (_completions[base + 3] == tau_status.TAU_OK) {
+        completer.complete(_completions[base + 2]);
+      } else {
+        completer.completeError(
+            ArgumentError('Unknown opcode ${_requests[slot * 4]}'));
       }
-      throw UnsupportedError('Unsupported message type: ${data.runtimeType}');
-    });
-
-  // Start the helper isolate.
-  await Isolate.spawn((SendPort sendPort) async {
-    final ReceivePort helperReceivePort = ReceivePort()
-      ..listen((dynamic data) {
-        // On the helper isolate listen to requests and respond to them.
-        if (data is _SumRequest) {
-          final int result = _bindings.sum_long_running(data.a, data.b);
-          final _SumResponse response = _SumResponse(data.id, result);
-          sendPort.send(response);
-          return;
-        }
-        throw UnsupportedError('Unsupported message type: ${data.runtimeType}');
-      });
-
-    // Send the port to the main isolate on which we can receive requests.
-    sendPort.send(helperReceivePort.sendPort);
-  }, receivePort.sendPort);
-
-  // Wait until the helper isolate has sent us back the SendPort on which we
-  // can start sending requests.
-  return completer.future;
-}();
+    }
+    _released += ready;
+    _bindings.tau_ring_release(_ring, ready);
+    while (_waiting.isNotEmpty && _completers[_end & _mask] == null) {
+      final _WaitingRequest waiting = _waiting.removeFirst();
+      _write(waiting.opcode, waiting.a, waiting.b, waiting.completer);
+    }
+  }
+}
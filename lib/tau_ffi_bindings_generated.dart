@@ -44,7 +44,7 @@ class TauFfiBindings {
 
   late final _sumPtr =
       _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Int, ffi.Int)>>('sum');
-  late final _sum = _sumPtr.asFunction<int Function(int, int)>();
+  late final _sum = _sumPtr.asFunction<int Function(int, int)>(isLeaf: true);
 
   /// A longer lived native function, which occupies the thread calling it.
   ///
@@ -66,4 +66,2540 @@ class TauFfiBindings {
           'sum_long_running');
   late final _sum_long_running =
       _sum_long_runningPtr.asFunction<int Function(int, int)>();
+
+  /// Registers the function native workers use to post results back to Dart.
+  ///
+  /// `post_cobject` is `NativeApi.postCObject`. This must be called before the
+  /// first asynchronous function, such as `sum_async`.
+  void tau_async_init(
+    ffi.Pointer<ffi.Void> post_cobject,
+  ) {
+    return _tau_async_init(
+      post_cobject,
+    );
+  }
+
+  late final _tau_async_initPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'tau_async_init');
+  late final _tau_async_init =
+      _tau_async_initPtr.asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  /// Queues `sum_long_running(a, b)` on the native worker pool.
+  ///
+  /// This returns immediately, so it can be called on the main isolate. Requests
+  /// run concurrently on a pool of native threads sized to the number of cores.
+  /// When a request completes, the list `[request_id, result]` is posted to the
+  /// Dart port `port`.
+  ///
+  /// Returns `TAU_OK`, or a negative `tau_status` if the request was not queued.
+  int sum_async(
+    int port,
+    int request_id,
+    int a,
+    int b,
+  ) {
+    return _sum_async(
+      port,
+      request_id,
+      a,
+      b,
+    );
+  }
+
+  late final _sum_asyncPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Int64, ffi.Int64, ffi.Int, ffi.Int)>>(
+          'sum_async');
+  late final _sum_async =
+      _sum_asyncPtr.asFunction<int Function(int, int, int, int)>();
+
+  /// Allocates a batch able to hold `capacity` commands.
+  ///
+  /// Returns NULL if `capacity` is not positive or memory is exhausted. The batch
+  /// must be released with `tau_batch_destroy`.
+  ffi.Pointer<tau_batch> tau_batch_create(
+    int capacity,
+  ) {
+    return _tau_batch_create(
+      capacity,
+    );
+  }
+
+  late final _tau_batch_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_batch> Function(ffi.Int32)>>(
+          'tau_batch_create');
+  late final _tau_batch_create =
+      _tau_batch_createPtr.asFunction<ffi.Pointer<tau_batch> Function(int)>();
+
+  /// Releases a batch allocated by `tau_batch_create`.
+  void tau_batch_destroy(
+    ffi.Pointer<tau_batch> batch,
+  ) {
+    return _tau_batch_destroy(
+      batch,
+    );
+  }
+
+  late final _tau_batch_destroyPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_batch>)>>(
+          'tau_batch_destroy');
+  late final _tau_batch_destroy =
+      _tau_batch_destroyPtr.asFunction<void Function(ffi.Pointer<tau_batch>)>();
+
+  /// Runs the first `count` commands of `batch` in a single native call.
+  ///
+  /// This is a short-lived function: it only does arithmetic, so it is fine to
+  /// call it on the main isolate. Thousands of small operations then cost one
+  /// Dart to native transition instead of one each.
+  ///
+  /// Returns the number of commands executed. Execution stops at the first
+  /// unknown opcode, so a return value lower than `count` is the index of the
+  /// offending command.
+  int tau_batch_execute(
+    ffi.Pointer<tau_batch> batch,
+  ) {
+    return _tau_batch_execute(
+      batch,
+    );
+  }
+
+  late final _tau_batch_executePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_batch>)>>(
+          'tau_batch_execute');
+  late final _tau_batch_execute =
+      _tau_batch_executePtr.asFunction<int Function(ffi.Pointer<tau_batch>)>(isLeaf: true);
+
+  /// Creates a ring for `capacity` requests in flight, rounded up to a power of
+  /// two.
+  ///
+  /// `port` is notified with an integer message when completions are ready to be
+  /// polled, or 0 to rely on polling alone. Notifications need `tau_async_init`.
+  /// Returns NULL on failure.
+  ffi.Pointer<tau_ring> tau_ring_create(
+    int capacity,
+    int port,
+  ) {
+    return _tau_ring_create(
+      capacity,
+      port,
+    );
+  }
+
+  late final _tau_ring_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_ring> Function(ffi.Int32, ffi.Int64)>>(
+          'tau_ring_create');
+  late final _tau_ring_create =
+      _tau_ring_createPtr.asFunction<ffi.Pointer<tau_ring> Function(int, int)>();
+
+  /// Releases the ring. Requests still running finish in the background, but
+  /// their results are dropped.
+  void tau_ring_destroy(
+    ffi.Pointer<tau_ring> ring,
+  ) {
+    return _tau_ring_destroy(
+      ring,
+    );
+  }
+
+  late final _tau_ring_destroyPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_ring>)>>(
+          'tau_ring_destroy');
+  late final _tau_ring_destroy =
+      _tau_ring_destroyPtr.asFunction<void Function(ffi.Pointer<tau_ring>)>();
+
+  /// The number of slots in each of the rings.
+  int tau_ring_capacity(
+    ffi.Pointer<tau_ring> ring,
+  ) {
+    return _tau_ring_capacity(
+      ring,
+    );
+  }
+
+  late final _tau_ring_capacityPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_ring>)>>(
+          'tau_ring_capacity');
+  late final _tau_ring_capacity =
+      _tau_ring_capacityPtr.asFunction<int Function(ffi.Pointer<tau_ring>)>(isLeaf: true);
+
+  /// The request slots, `tau_ring_capacity` of them.
+  ffi.Pointer<tau_ring_request> tau_ring_requests(
+    ffi.Pointer<tau_ring> ring,
+  ) {
+    return _tau_ring_requests(
+      ring,
+    );
+  }
+
+  late final _tau_ring_requestsPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_ring_request> Function(ffi.Pointer<tau_ring>)>>(
+          'tau_ring_requests');
+  late final _tau_ring_requests =
+      _tau_ring_requestsPtr.asFunction<ffi.Pointer<tau_ring_request> Function(ffi.Pointer<tau_ring>)>(isLeaf: true);
+
+  /// The completion slots, `tau_ring_capacity` of them.
+  ffi.Pointer<tau_ring_completion> tau_ring_completions(
+    ffi.Pointer<tau_ring> ring,
+  ) {
+    return _tau_ring_completions(
+      ring,
+    );
+  }
+
+  late final _tau_ring_completionsPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_ring_completion> Function(ffi.Pointer<tau_ring>)>>(
+          'tau_ring_completions');
+  late final _tau_ring_completions =
+      _tau_ring_completionsPtr.asFunction<ffi.Pointer<tau_ring_completion> Function(ffi.Pointer<tau_ring>)>(isLeaf: true);
+
+  /// Publishes every request written before position `end`.
+  ///
+  /// The request at position `n` goes in slot `n % capacity`, and may only be
+  /// written once the result of the request `capacity` positions older, which
+  /// used the slot before, has been released. Requests complete out of order, so
+  /// having released `capacity` results is not enough. Returns `TAU_OK`, or
+  /// `TAU_ERROR_INVALID_ARGUMENT` if `end` breaks that rule or moves backwards.
+  int tau_ring_submit(
+    ffi.Pointer<tau_ring> ring,
+    int end,
+  ) {
+    return _tau_ring_submit(
+      ring,
+      end,
+    );
+  }
+
+  late final _tau_ring_submitPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_ring>, ffi.Int64)>>(
+          'tau_ring_submit');
+  late final _tau_ring_submit =
+      _tau_ring_submitPtr.asFunction<int Function(ffi.Pointer<tau_ring>, int)>(isLeaf: true);
+
+  /// The number of completions ready to be read, starting at the oldest one not
+  /// yet released.
+  ///
+  /// Completion number `n` is in slot `n % capacity`. Polling also re-arms the
+  /// port notification.
+  int tau_ring_poll(
+    ffi.Pointer<tau_ring> ring,
+  ) {
+    return _tau_ring_poll(
+      ring,
+    );
+  }
+
+  late final _tau_ring_pollPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_ring>)>>(
+          'tau_ring_poll');
+  late final _tau_ring_poll =
+      _tau_ring_pollPtr.asFunction<int Function(ffi.Pointer<tau_ring>)>(isLeaf: true);
+
+  /// Frees the `count` oldest completions after they have been read.
+  void tau_ring_release(
+    ffi.Pointer<tau_ring> ring,
+    int count,
+  ) {
+    return _tau_ring_release(
+      ring,
+      count,
+    );
+  }
+
+  late final _tau_ring_releasePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_ring>, ffi.Int32)>>(
+          'tau_ring_release');
+  late final _tau_ring_release =
+      _tau_ring_releasePtr.asFunction<void Function(ffi.Pointer<tau_ring>, int)>(isLeaf: true);
+
+  /// The number of heap allocations the audio engine made since the library was
+  /// loaded. Once a graph has reached its working size, rendering it makes none:
+  /// nodes and buses come from pools, and per-quantum scratch memory from an
+  /// arena.
+  int tau_memory_allocations() {
+    return _tau_memory_allocations();
+  }
+
+  late final _tau_memory_allocationsPtr =
+      _lookup<ffi.NativeFunction<ffi.Int64 Function()>>(
+          'tau_memory_allocations');
+  late final _tau_memory_allocations =
+      _tau_memory_allocationsPtr.asFunction<int Function()>(isLeaf: true);
+
+  /// The number of heap blocks the audio engine freed since the library was
+  /// loaded.
+  int tau_memory_frees() {
+    return _tau_memory_frees();
+  }
+
+  late final _tau_memory_freesPtr =
+      _lookup<ffi.NativeFunction<ffi.Int64 Function()>>('tau_memory_frees');
+  late final _tau_memory_frees =
+      _tau_memory_freesPtr.asFunction<int Function()>(isLeaf: true);
+
+  /// The bytes the audio engine currently holds on the heap.
+  int tau_memory_bytes_in_use() {
+    return _tau_memory_bytes_in_use();
+  }
+
+  late final _tau_memory_bytes_in_usePtr =
+      _lookup<ffi.NativeFunction<ffi.Int64 Function()>>(
+          'tau_memory_bytes_in_use');
+  late final _tau_memory_bytes_in_use =
+      _tau_memory_bytes_in_usePtr.asFunction<int Function()>(isLeaf: true);
+
+  /// `size` bytes of native memory from the engine allocator, or NULL, for
+  /// arguments that Dart passes by pointer such as file paths. Freed with
+  /// `tau_memory_release`.
+  ffi.Pointer<ffi.Void> tau_memory_allocate(
+    int size,
+  ) {
+    return _tau_memory_allocate(
+      size,
+    );
+  }
+
+  late final _tau_memory_allocatePtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<ffi.Void> Function(ffi.Int64)>>(
+          'tau_memory_allocate');
+  late final _tau_memory_allocate =
+      _tau_memory_allocatePtr.asFunction<ffi.Pointer<ffi.Void> Function(int)>();
+
+  void tau_memory_release(
+    ffi.Pointer<ffi.Void> memory,
+  ) {
+    return _tau_memory_release(
+      memory,
+    );
+  }
+
+  late final _tau_memory_releasePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'tau_memory_release');
+  late final _tau_memory_release =
+      _tau_memory_releasePtr.asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  /// Allocates a silent buffer of `channels` channels of `frames` frames at
+  /// `sample_rate`, holding one reference.
+  ///
+  /// Returns NULL if an argument is out of range or memory is exhausted.
+  ffi.Pointer<tau_audio_buffer> tau_audio_buffer_create(
+    int channels,
+    int frames,
+    double sample_rate,
+  ) {
+    return _tau_audio_buffer_create(
+      channels,
+      frames,
+      sample_rate,
+    );
+  }
+
+  late final _tau_audio_buffer_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_audio_buffer> Function(ffi.Int32, ffi.Int32, ffi.Float)>>(
+          'tau_audio_buffer_create');
+  late final _tau_audio_buffer_create =
+      _tau_audio_buffer_createPtr.asFunction<ffi.Pointer<tau_audio_buffer> Function(int, int, double)>();
+
+  /// Takes a reference to `buffer`, which may be used from any thread.
+  void tau_audio_buffer_retain(
+    ffi.Pointer<tau_audio_buffer> buffer,
+  ) {
+    return _tau_audio_buffer_retain(
+      buffer,
+    );
+  }
+
+  late final _tau_audio_buffer_retainPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_audio_buffer>)>>(
+          'tau_audio_buffer_retain');
+  late final _tau_audio_buffer_retain =
+      _tau_audio_buffer_retainPtr.asFunction<void Function(ffi.Pointer<tau_audio_buffer>)>();
+
+  /// Gives back a reference to `buffer`, freeing it with the last one. Usable as
+  /// a Dart `NativeFinalizer` or `asTypedList` finalizer.
+  void tau_audio_buffer_release(
+    ffi.Pointer<tau_audio_buffer> buffer,
+  ) {
+    return _tau_audio_buffer_release(
+      buffer,
+    );
+  }
+
+  late final _tau_audio_buffer_releasePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_audio_buffer>)>>(
+          'tau_audio_buffer_release');
+  late final _tau_audio_buffer_release =
+      _tau_audio_buffer_releasePtr.asFunction<void Function(ffi.Pointer<tau_audio_buffer>)>();
+
+  /// Creates a context producing `channels` output channels at `sample_rate`.
+  /// Returns NULL on failure.
+  ffi.Pointer<tau_context> tau_context_create(
+    int channels,
+    double sample_rate,
+  ) {
+    return _tau_context_create(
+      channels,
+      sample_rate,
+    );
+  }
+
+  late final _tau_context_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_context> Function(ffi.Int32, ffi.Float)>>(
+          'tau_context_create');
+  late final _tau_context_create =
+      _tau_context_createPtr.asFunction<ffi.Pointer<tau_context> Function(int, double)>();
+
+  /// Releases a context and every node in it.
+  void tau_context_destroy(
+    ffi.Pointer<tau_context> context,
+  ) {
+    return _tau_context_destroy(
+      context,
+    );
+  }
+
+  late final _tau_context_destroyPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_context>)>>(
+          'tau_context_destroy');
+  late final _tau_context_destroy =
+      _tau_context_destroyPtr.asFunction<void Function(ffi.Pointer<tau_context>)>();
+
+  /// The sample rate of the context.
+  double tau_context_sample_rate(
+    ffi.Pointer<tau_context> context,
+  ) {
+    return _tau_context_sample_rate(
+      context,
+    );
+  }
+
+  late final _tau_context_sample_ratePtr =
+      _lookup<ffi.NativeFunction<ffi.Float Function(ffi.Pointer<tau_context>)>>(
+          'tau_context_sample_rate');
+  late final _tau_context_sample_rate =
+      _tau_context_sample_ratePtr.asFunction<double Function(ffi.Pointer<tau_context>)>(isLeaf: true);
+
+  /// The time of the next frame to render, in seconds.
+  double tau_context_current_time(
+    ffi.Pointer<tau_context> context,
+  ) {
+    return _tau_context_current_time(
+      context,
+    );
+  }
+
+  late final _tau_context_current_timePtr =
+      _lookup<ffi.NativeFunction<ffi.Double Function(ffi.Pointer<tau_context>)>>(
+          'tau_context_current_time');
+  late final _tau_context_current_time =
+      _tau_context_current_timePtr.asFunction<double Function(ffi.Pointer<tau_context>)>(isLeaf: true);
+
+  /// The handle of the node whose input is the output of the context.
+  int tau_context_destination(
+    ffi.Pointer<tau_context> context,
+  ) {
+    return _tau_context_destination(
+      context,
+    );
+  }
+
+  late final _tau_context_destinationPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>)>>(
+          'tau_context_destination');
+  late final _tau_context_destination =
+      _tau_context_destinationPtr.asFunction<int Function(ffi.Pointer<tau_context>)>(isLeaf: true);
+
+  /// Renders the graph on `threads` threads, or one per processor if `threads`
+  /// is not positive. The default is 1.
+  ///
+  /// With more than one thread, independent branches of the graph, such as
+  /// separate voices, render in parallel on a worker pool owned by the context,
+  /// and the thread calling `tau_context_render` takes part.
+  int tau_context_set_render_threads(
+    ffi.Pointer<tau_context> context,
+    int threads,
+  ) {
+    return _tau_context_set_render_threads(
+      context,
+      threads,
+    );
+  }
+
+  late final _tau_context_set_render_threadsPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32)>>(
+          'tau_context_set_render_threads');
+  late final _tau_context_set_render_threads =
+      _tau_context_set_render_threadsPtr.asFunction<int Function(ffi.Pointer<tau_context>, int)>();
+
+  /// Renders the next `frames` frames of the graph into `output`, as fast as the
+  /// processor allows.
+  ///
+  /// `output` is planar: channel `c` occupies `output[c * frames]` to
+  /// `output[(c + 1) * frames - 1]`. Any number of frames may be requested; the
+  /// graph itself always advances by `TAU_RENDER_QUANTUM_FRAMES`.
+  ///
+  /// Returns the number of frames rendered, or a negative `tau_status`.
+  int tau_context_render(
+    ffi.Pointer<tau_context> context,
+    ffi.Pointer<ffi.Float> output,
+    int frames,
+  ) {
+    return _tau_context_render(
+      context,
+      output,
+      frames,
+    );
+  }
+
+  late final _tau_context_renderPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Pointer<ffi.Float>, ffi.Int32)>>(
+          'tau_context_render');
+  late final _tau_context_render =
+      _tau_context_renderPtr.asFunction<int Function(ffi.Pointer<tau_context>, ffi.Pointer<ffi.Float>, int)>();
+
+  /// Renders the next `buffer->frames` frames of the graph straight into
+  /// `buffer`, which must have as many channels as the context.
+  ///
+  /// This is the `OfflineAudioContext.startRendering` of the engine. Returns the
+  /// number of frames rendered, or a negative `tau_status`.
+  int tau_context_render_buffer(
+    ffi.Pointer<tau_context> context,
+    ffi.Pointer<tau_audio_buffer> buffer,
+  ) {
+    return _tau_context_render_buffer(
+      context,
+      buffer,
+    );
+  }
+
+  late final _tau_context_render_bufferPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Pointer<tau_audio_buffer>)>>(
+          'tau_context_render_buffer');
+  late final _tau_context_render_buffer =
+      _tau_context_render_bufferPtr.asFunction<int Function(ffi.Pointer<tau_context>, ffi.Pointer<tau_audio_buffer>)>();
+
+  /// Copies the timings of the quanta of `context`, each from applying the
+  /// queued edits to rendering the last node, into `profile`.
+  ///
+  /// Returns a `tau_status`: `TAU_ERROR_NOT_SUPPORTED` if profiling was
+  /// compiled out.
+  int tau_context_get_profile(
+    ffi.Pointer<tau_context> context,
+    ffi.Pointer<tau_profile> profile,
+  ) {
+    return _tau_context_get_profile(
+      context,
+      profile,
+    );
+  }
+
+  late final _tau_context_get_profilePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Pointer<tau_profile>)>>(
+          'tau_context_get_profile');
+  late final _tau_context_get_profile =
+      _tau_context_get_profilePtr.asFunction<int Function(ffi.Pointer<tau_context>, ffi.Pointer<tau_profile>)>();
+
+  /// Sets the quality of the sample-rate conversion of the buffer and stream
+  /// sources created afterwards in `context`, one of `tau_resampler_quality`.
+  /// The default is `TAU_RESAMPLER_MEDIUM`. Returns a `tau_status`.
+  int tau_context_set_resampler_quality(
+    ffi.Pointer<tau_context> context,
+    int quality,
+  ) {
+    return _tau_context_set_resampler_quality(
+      context,
+      quality,
+    );
+  }
+
+  late final _tau_context_set_resampler_qualityPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32)>>(
+          'tau_context_set_resampler_quality');
+  late final _tau_context_set_resampler_quality =
+      _tau_context_set_resampler_qualityPtr.asFunction<int Function(ffi.Pointer<tau_context>, int)>();
+
+  /// Creates an oscillator of `type`, one of `tau_oscillator_type`, at
+  /// `frequency` hertz.
+  ///
+  /// Returns the node handle, or a negative `tau_status`.
+  int tau_oscillator_create(
+    ffi.Pointer<tau_context> context,
+    int type,
+    double frequency,
+  ) {
+    return _tau_oscillator_create(
+      context,
+      type,
+      frequency,
+    );
+  }
+
+  late final _tau_oscillator_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Float)>>(
+          'tau_oscillator_create');
+  late final _tau_oscillator_create =
+      _tau_oscillator_createPtr.asFunction<int Function(ffi.Pointer<tau_context>, int, double)>();
+
+  /// Creates a gain node multiplying its input by `gain`.
+  ///
+  /// Returns the node handle, or a negative `tau_status`.
+  int tau_gain_create(
+    ffi.Pointer<tau_context> context,
+    double gain,
+  ) {
+    return _tau_gain_create(
+      context,
+      gain,
+    );
+  }
+
+  late final _tau_gain_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Float)>>(
+          'tau_gain_create');
+  late final _tau_gain_create =
+      _tau_gain_createPtr.asFunction<int Function(ffi.Pointer<tau_context>, double)>();
+
+  /// Creates a source playing `buffer`, looping over it if `loop` is not 0.
+  ///
+  /// The source takes a reference to `buffer` and reads its samples in place, so
+  /// they may still be written until the source starts.
+  ///
+  /// Returns the node handle, or a negative `tau_status`.
+  int tau_buffer_source_create(
+    ffi.Pointer<tau_context> context,
+    ffi.Pointer<tau_audio_buffer> buffer,
+    int loop,
+  ) {
+    return _tau_buffer_source_create(
+      context,
+      buffer,
+      loop,
+    );
+  }
+
+  late final _tau_buffer_source_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Pointer<tau_audio_buffer>, ffi.Int32)>>(
+          'tau_buffer_source_create');
+  late final _tau_buffer_source_create =
+      _tau_buffer_source_createPtr.asFunction<int Function(ffi.Pointer<tau_context>, ffi.Pointer<tau_audio_buffer>, int)>();
+
+  /// Creates a voice pool: a source of `channels` channels playing buffers on
+  /// `voices` voices, from 1 to `TAU_MAX_VOICES`, and mixing them, for
+  /// instruments and games playing many short notes.
+  ///
+  /// A note takes a free voice of the pool, or the one playing the oldest note,
+  /// rather than a node of its own: playing it neither allocates memory nor
+  /// changes the graph, so the render order is not rebuilt either. Voices play
+  /// buffers as buffer sources do, mixed to `channels` channels.
+  ///
+  /// Returns the node handle, or a negative `tau_status`.
+  int tau_voice_pool_create(
+    ffi.Pointer<tau_context> context,
+    int voices,
+    int channels,
+  ) {
+    return _tau_voice_pool_create(
+      context,
+      voices,
+      channels,
+    );
+  }
+
+  late final _tau_voice_pool_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Int32)>>(
+          'tau_voice_pool_create');
+  late final _tau_voice_pool_create =
+      _tau_voice_pool_createPtr.asFunction<int Function(ffi.Pointer<tau_context>, int, int)>();
+
+  /// Plays `buffer` once, or looping over it if `loop` is not 0, on a voice of
+  /// the pool `node` from `when` seconds, at `playback_rate` times its speed
+  /// and scaled by `gain`.
+  ///
+  /// The voice takes a reference to `buffer`, which it gives back once it plays
+  /// another note. Returns the handle of the voice playing the note, which
+  /// changes with every note, or a negative `tau_status`.
+  int tau_voice_pool_play(
+    ffi.Pointer<tau_context> context,
+    int node,
+    ffi.Pointer<tau_audio_buffer> buffer,
+    double when,
+    int loop,
+    double playback_rate,
+    double gain,
+  ) {
+    return _tau_voice_pool_play(
+      context,
+      node,
+      buffer,
+      when,
+      loop,
+      playback_rate,
+      gain,
+    );
+  }
+
+  late final _tau_voice_pool_playPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Pointer<tau_audio_buffer>, ffi.Double, ffi.Int32, ffi.Float, ffi.Float)>>(
+          'tau_voice_pool_play');
+  late final _tau_voice_pool_play =
+      _tau_voice_pool_playPtr.asFunction<int Function(ffi.Pointer<tau_context>, int, ffi.Pointer<tau_audio_buffer>, double, int, double, double)>();
+
+  /// Stops the note of `voice`, a handle from `tau_voice_pool_play`, at `when`
+  /// seconds. Does nothing once the voice plays another note. Returns a
+  /// `tau_status`.
+  int tau_voice_pool_stop(
+    ffi.Pointer<tau_context> context,
+    int node,
+    int voice,
+    double when,
+  ) {
+    return _tau_voice_pool_stop(
+      context,
+      node,
+      voice,
+      when,
+    );
+  }
+
+  late final _tau_voice_pool_stopPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Int32, ffi.Double)>>(
+          'tau_voice_pool_stop');
+  late final _tau_voice_pool_stop =
+      _tau_voice_pool_stopPtr.asFunction<int Function(ffi.Pointer<tau_context>, int, int, double)>();
+
+  /// Copies the counters of the pool `node` into `stats`. Returns a
+  /// `tau_status`.
+  int tau_voice_pool_get_stats(
+    ffi.Pointer<tau_context> context,
+    int node,
+    ffi.Pointer<tau_voice_pool_stats> stats,
+  ) {
+    return _tau_voice_pool_get_stats(
+      context,
+      node,
+      stats,
+    );
+  }
+
+  late final _tau_voice_pool_get_statsPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Pointer<tau_voice_pool_stats>)>>(
+          'tau_voice_pool_get_stats');
+  late final _tau_voice_pool_get_stats =
+      _tau_voice_pool_get_statsPtr.asFunction<int Function(ffi.Pointer<tau_context>, int, ffi.Pointer<tau_voice_pool_stats>)>();
+
+  /// Creates a convolver applying the impulse response in `impulse`, which must
+  /// have the sample rate of the context, as a reverb does. If `normalize` is
+  /// not 0, the response is scaled to a standard power first, as the Web Audio
+  /// `ConvolverNode` does.
+  ///
+  /// Every channel of the input is convolved with the same channel of
+  /// `impulse`; the input is mixed to as many channels. The convolution is
+  /// computed with FFTs, so impulse responses of several seconds are cheap, and
+  /// adds no latency. The response is copied: `impulse` may be released.
+  ///
+  /// Returns the node handle, or a negative `tau_status`.
+  int tau_convolver_create(
+    ffi.Pointer<tau_context> context,
+    ffi.Pointer<tau_audio_buffer> impulse,
+    int normalize,
+  ) {
+    return _tau_convolver_create(
+      context,
+      impulse,
+      normalize,
+    );
+  }
+
+  late final _tau_convolver_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Pointer<tau_audio_buffer>, ffi.Int32)>>(
+          'tau_convolver_create');
+  late final _tau_convolver_create =
+      _tau_convolver_createPtr.asFunction<int Function(ffi.Pointer<tau_context>, ffi.Pointer<tau_audio_buffer>, int)>();
+
+  /// Creates a filter of `bands` biquad sections of type `type` in series, from
+  /// 1 to `TAU_BIQUAD_MAX_BANDS`, such as the bands of an equalizer. With one
+  /// band, it is the Web Audio `BiquadFilterNode`. Each band has its own type
+  /// and its own `TAU_PARAM_FREQUENCY` (350 Hz), `TAU_PARAM_DETUNE` (0),
+  /// `TAU_PARAM_Q` (1) and `TAU_PARAM_GAIN` (0 dB), all sample-accurate.
+  ///
+  /// Every band of every channel is filtered side by side with the others in
+  /// vector registers, and the coefficients of a band are only computed again
+  /// when its type or parameters change. The output has as many channels as the
+  /// input.
+  ///
+  /// Returns the node handle, or a negative `tau_status`.
+  int tau_biquad_filter_create(
+    ffi.Pointer<tau_context> context,
+    int type,
+    int bands,
+  ) {
+    return _tau_biquad_filter_create(
+      context,
+      type,
+      bands,
+    );
+  }
+
+  late final _tau_biquad_filter_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Int32)>>(
+          'tau_biquad_filter_create');
+  late final _tau_biquad_filter_create =
+      _tau_biquad_filter_createPtr.asFunction<int Function(ffi.Pointer<tau_context>, int, int)>();
+
+  /// Sets the type of band `band` of the biquad filter `node` to `type`, from
+  /// the next quantum. Returns a `tau_status`.
+  int tau_biquad_filter_set_type(
+    ffi.Pointer<tau_context> context,
+    int node,
+    int band,
+    int type,
+  ) {
+    return _tau_biquad_filter_set_type(
+      context,
+      node,
+      band,
+      type,
+    );
+  }
+
+  late final _tau_biquad_filter_set_typePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Int32, ffi.Int32)>>(
+          'tau_biquad_filter_set_type');
+  late final _tau_biquad_filter_set_type =
+      _tau_biquad_filter_set_typePtr.asFunction<int Function(ffi.Pointer<tau_context>, int, int, int)>();
+
+  /// Creates a compressor, as the Web Audio `DynamicsCompressorNode`, with its
+  /// `TAU_PARAM_THRESHOLD` (-24 dB), `TAU_PARAM_KNEE` (30 dB),
+  /// `TAU_PARAM_RATIO` (12), `TAU_PARAM_ATTACK` (0.003 s) and
+  /// `TAU_PARAM_RELEASE` (0.25 s). The output has as many channels as the
+  /// input, and is delayed by a lookahead of 6 ms, so that the gain has come
+  /// down when a peak comes through.
+  ///
+  /// The level of the loudest channel goes through the gain curve with vector
+  /// kernels, and the gain follows it every 32 frames, ramping in between.
+  ///
+  /// Returns the node handle, or a negative `tau_status`.
+  int tau_compressor_create(
+    ffi.Pointer<tau_context> context,
+  ) {
+    return _tau_compressor_create(
+      context,
+    );
+  }
+
+  late final _tau_compressor_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>)>>(
+          'tau_compressor_create');
+  late final _tau_compressor_create =
+      _tau_compressor_createPtr.asFunction<int Function(ffi.Pointer<tau_context>)>();
+
+  /// The gain reduction of the compressor `node` at the end of the last quantum
+  /// rendered, in decibels, as the `reduction` of Web Audio, or NaN if `node`
+  /// is not a compressor.
+  double tau_compressor_reduction(
+    ffi.Pointer<tau_context> context,
+    int node,
+  ) {
+    return _tau_compressor_reduction(
+      context,
+      node,
+    );
+  }
+
+  late final _tau_compressor_reductionPtr =
+      _lookup<ffi.NativeFunction<ffi.Float Function(ffi.Pointer<tau_context>, ffi.Int32)>>(
+          'tau_compressor_reduction');
+  late final _tau_compressor_reduction =
+      _tau_compressor_reductionPtr.asFunction<double Function(ffi.Pointer<tau_context>, int)>();
+
+  /// Creates a set of `count` pairs of responses of `frames` frames at
+  /// `sample_rate`. `left` and `right` hold the responses of each ear one
+  /// after the other, measured from the directions of `azimuths` and
+  /// `elevations`, in degrees. Azimuths go clockwise from the front, 90 being
+  /// on the right, as the azimuth of Web Audio, and elevations up from the
+  /// horizontal plane. The arrays are copied.
+  ///
+  /// Returns the set, holding one reference, or NULL if an argument is out of
+  /// range or memory is exhausted.
+  ffi.Pointer<tau_hrtf> tau_hrtf_create(
+    ffi.Pointer<ffi.Float> left,
+    ffi.Pointer<ffi.Float> right,
+    ffi.Pointer<ffi.Float> azimuths,
+    ffi.Pointer<ffi.Float> elevations,
+    int count,
+    int frames,
+    double sample_rate,
+  ) {
+    return _tau_hrtf_create(
+      left,
+      right,
+      azimuths,
+      elevations,
+      count,
+      frames,
+      sample_rate,
+    );
+  }
+
+  late final _tau_hrtf_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_hrtf> Function(ffi.Pointer<ffi.Float>, ffi.Pointer<ffi.Float>, ffi.Pointer<ffi.Float>, ffi.Pointer<ffi.Float>, ffi.Int32, ffi.Int32, ffi.Float)>>(
+          'tau_hrtf_create');
+  late final _tau_hrtf_create =
+      _tau_hrtf_createPtr.asFunction<ffi.Pointer<tau_hrtf> Function(ffi.Pointer<ffi.Float>, ffi.Pointer<ffi.Float>, ffi.Pointer<ffi.Float>, ffi.Pointer<ffi.Float>, int, int, double)>();
+
+  void tau_hrtf_retain(
+    ffi.Pointer<tau_hrtf> hrtf,
+  ) {
+    return _tau_hrtf_retain(
+      hrtf,
+    );
+  }
+
+  late final _tau_hrtf_retainPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_hrtf>)>>(
+          'tau_hrtf_retain');
+  late final _tau_hrtf_retain =
+      _tau_hrtf_retainPtr.asFunction<void Function(ffi.Pointer<tau_hrtf>)>();
+
+  /// Gives back a reference to `hrtf`, freeing it with the last one.
+  void tau_hrtf_release(
+    ffi.Pointer<tau_hrtf> hrtf,
+  ) {
+    return _tau_hrtf_release(
+      hrtf,
+    );
+  }
+
+  late final _tau_hrtf_releasePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_hrtf>)>>(
+          'tau_hrtf_release');
+  late final _tau_hrtf_release =
+      _tau_hrtf_releasePtr.asFunction<void Function(ffi.Pointer<tau_hrtf>)>();
+
+  /// The number of cells whose interpolated responses are cached.
+  int tau_hrtf_cached_cells(
+    ffi.Pointer<tau_hrtf> hrtf,
+  ) {
+    return _tau_hrtf_cached_cells(
+      hrtf,
+    );
+  }
+
+  late final _tau_hrtf_cached_cellsPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_hrtf>)>>(
+          'tau_hrtf_cached_cells');
+  late final _tau_hrtf_cached_cells =
+      _tau_hrtf_cached_cellsPtr.asFunction<int Function(ffi.Pointer<tau_hrtf>)>(isLeaf: true);
+
+  /// Creates a panner, as the Web Audio `PannerNode`, placing its input,
+  /// down-mixed to mono, at `TAU_PARAM_POSITION_X`, `TAU_PARAM_POSITION_Y` and
+  /// `TAU_PARAM_POSITION_Z` (0) around the listener, in stereo.
+  ///
+  /// With `hrtf`, the panning model is `HRTF`: the input is convolved with the
+  /// responses of its direction by FFT, which adds no latency. A source staying
+  /// in its cell costs the convolution alone; one moving to another cell
+  /// crossfades from the old responses to the new over a quantum. Without, the
+  /// model is `equalpower`. The panner takes a reference to `hrtf`, whose
+  /// sample rate must be that of the context.
+  ///
+  /// The source is omnidirectional, and its gain follows the inverse distance
+  /// model of Web Audio with the default reference distance and rolloff
+  /// factor, of 1.
+  ///
+  /// Returns the node handle, or a negative `tau_status`.
+  int tau_panner_create(
+    ffi.Pointer<tau_context> context,
+    ffi.Pointer<tau_hrtf> hrtf,
+  ) {
+    return _tau_panner_create(
+      context,
+      hrtf,
+    );
+  }
+
+  late final _tau_panner_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Pointer<tau_hrtf>)>>(
+          'tau_panner_create');
+  late final _tau_panner_create =
+      _tau_panner_createPtr.asFunction<int Function(ffi.Pointer<tau_context>, ffi.Pointer<tau_hrtf>)>();
+
+  /// Creates a host queueing up to `capacity` blocks at once, which bounds the
+  /// blocks its worklet nodes can own together: a node of a latency of `n`
+  /// quanta owns `n + 2`. Returns the host, or NULL.
+  ffi.Pointer<tau_worklet_host> tau_worklet_host_create(
+    int capacity,
+  ) {
+    return _tau_worklet_host_create(
+      capacity,
+    );
+  }
+
+  late final _tau_worklet_host_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_worklet_host> Function(ffi.Int32)>>(
+          'tau_worklet_host_create');
+  late final _tau_worklet_host_create =
+      _tau_worklet_host_createPtr.asFunction<ffi.Pointer<tau_worklet_host> Function(int)>();
+
+  /// Waits up to `timeout_ms` milliseconds, or forever if negative, for a block
+  /// to process. Only the processing thread calls it. Returns the block, or
+  /// NULL on timeout or once the host is closed.
+  ffi.Pointer<tau_worklet_block> tau_worklet_host_wait(
+    ffi.Pointer<tau_worklet_host> host,
+    int timeout_ms,
+  ) {
+    return _tau_worklet_host_wait(
+      host,
+      timeout_ms,
+    );
+  }
+
+  late final _tau_worklet_host_waitPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_worklet_block> Function(ffi.Pointer<tau_worklet_host>, ffi.Int32)>>(
+          'tau_worklet_host_wait');
+  late final _tau_worklet_host_wait =
+      _tau_worklet_host_waitPtr.asFunction<ffi.Pointer<tau_worklet_block> Function(ffi.Pointer<tau_worklet_host>, int)>();
+
+  /// Hands back a processed block taken by `tau_worklet_host_wait`.
+  void tau_worklet_host_complete(
+    ffi.Pointer<tau_worklet_host> host,
+    ffi.Pointer<tau_worklet_block> block,
+  ) {
+    return _tau_worklet_host_complete(
+      host,
+      block,
+    );
+  }
+
+  late final _tau_worklet_host_completePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_worklet_host>, ffi.Pointer<tau_worklet_block>)>>(
+          'tau_worklet_host_complete');
+  late final _tau_worklet_host_complete =
+      _tau_worklet_host_completePtr.asFunction<void Function(ffi.Pointer<tau_worklet_host>, ffi.Pointer<tau_worklet_block>)>(isLeaf: true);
+
+  /// Whether `host` is closed.
+  int tau_worklet_host_closed(
+    ffi.Pointer<tau_worklet_host> host,
+  ) {
+    return _tau_worklet_host_closed(
+      host,
+    );
+  }
+
+  late final _tau_worklet_host_closedPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_worklet_host>)>>(
+          'tau_worklet_host_closed');
+  late final _tau_worklet_host_closed =
+      _tau_worklet_host_closedPtr.asFunction<int Function(ffi.Pointer<tau_worklet_host>)>(isLeaf: true);
+
+  /// Closes `host`, from any thread: its worklet nodes output silence from then
+  /// on, and `tau_worklet_host_wait` returns NULL.
+  void tau_worklet_host_close(
+    ffi.Pointer<tau_worklet_host> host,
+  ) {
+    return _tau_worklet_host_close(
+      host,
+    );
+  }
+
+  late final _tau_worklet_host_closePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_worklet_host>)>>(
+          'tau_worklet_host_close');
+  late final _tau_worklet_host_close =
+      _tau_worklet_host_closePtr.asFunction<void Function(ffi.Pointer<tau_worklet_host>)>();
+
+  /// Closes `host`, hands back the blocks still queued with silence, and gives
+  /// back the reference of the owner. Called by the processing thread once it
+  /// stops waiting.
+  void tau_worklet_host_release(
+    ffi.Pointer<tau_worklet_host> host,
+  ) {
+    return _tau_worklet_host_release(
+      host,
+    );
+  }
+
+  late final _tau_worklet_host_releasePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_worklet_host>)>>(
+          'tau_worklet_host_release');
+  late final _tau_worklet_host_release =
+      _tau_worklet_host_releasePtr.asFunction<void Function(ffi.Pointer<tau_worklet_host>)>();
+
+  /// Creates a worklet node, as the Web Audio `AudioWorkletNode`, whose
+  /// quanta `host` processes. The input has `input_channels` channels,
+  /// mixed as an explicit channel count, and the output `output_channels`,
+  /// from 1 to `TAU_MAX_CHANNELS`.
+  ///
+  /// The output lags the input by `latency` quanta, from 1 to
+  /// `TAU_WORKLET_MAX_LATENCY`: the time the processing thread has for each
+  /// block. In real time, a block still out after it outputs silence; with
+  /// `blocking`, for offline rendering, the rendering thread waits for it
+  /// instead.
+  ///
+  /// Returns the node handle, or a negative `tau_status`:
+  /// `TAU_ERROR_INVALID_STATE` if `host` is closed or has no room for the
+  /// blocks of the node.
+  int tau_worklet_create(
+    ffi.Pointer<tau_context> context,
+    ffi.Pointer<tau_worklet_host> host,
+    int key,
+    int input_channels,
+    int output_channels,
+    int latency,
+    int blocking,
+  ) {
+    return _tau_worklet_create(
+      context,
+      host,
+      key,
+      input_channels,
+      output_channels,
+      latency,
+      blocking,
+    );
+  }
+
+  late final _tau_worklet_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Pointer<tau_worklet_host>, ffi.Int64, ffi.Int32, ffi.Int32, ffi.Int32, ffi.Int32)>>(
+          'tau_worklet_create');
+  late final _tau_worklet_create =
+      _tau_worklet_createPtr.asFunction<int Function(ffi.Pointer<tau_context>, ffi.Pointer<tau_worklet_host>, int, int, int, int, int)>();
+
+  /// The quanta the worklet `node` output as silence because their block was
+  /// not back in time, or a negative `tau_status`.
+  int tau_worklet_underruns(
+    ffi.Pointer<tau_context> context,
+    int node,
+  ) {
+    return _tau_worklet_underruns(
+      context,
+      node,
+    );
+  }
+
+  late final _tau_worklet_underrunsPtr =
+      _lookup<ffi.NativeFunction<ffi.Int64 Function(ffi.Pointer<tau_context>, ffi.Int32)>>(
+          'tau_worklet_underruns');
+  late final _tau_worklet_underruns =
+      _tau_worklet_underrunsPtr.asFunction<int Function(ffi.Pointer<tau_context>, int)>();
+
+  /// Creates an analyser, which passes its input through and keeps its last
+  /// `fft_size` frames, down-mixed to mono, for the
+  /// `tau_analyser_get_float_*_data` functions, as the Web Audio `AnalyserNode`
+  /// does. `fft_size` is a power of two from `TAU_ANALYSER_MIN_FFT_SIZE` to
+  /// `TAU_ANALYSER_MAX_FFT_SIZE`. Like every node, the analyser only renders
+  /// while its output reaches the destination.
+  ///
+  /// The rendering thread only copies each quantum into a ring, without
+  /// waiting: the spectrum is computed by the thread asking for it, which
+  /// holds a lock of the analyser meanwhile rather than of the context.
+  ///
+  /// Returns the node handle, or a negative `tau_status`.
+  int tau_analyser_create(
+    ffi.Pointer<tau_context> context,
+    int fft_size,
+  ) {
+    return _tau_analyser_create(
+      context,
+      fft_size,
+    );
+  }
+
+  late final _tau_analyser_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32)>>(
+          'tau_analyser_create');
+  late final _tau_analyser_create =
+      _tau_analyser_createPtr.asFunction<int Function(ffi.Pointer<tau_context>, int)>();
+
+  /// Sets how much of the previous spectrum every new one keeps, from 0 to 1,
+  /// as the `smoothingTimeConstant` of Web Audio. The default is 0.8.
+  int tau_analyser_set_smoothing(
+    ffi.Pointer<tau_context> context,
+    int node,
+    double smoothing,
+  ) {
+    return _tau_analyser_set_smoothing(
+      context,
+      node,
+      smoothing,
+    );
+  }
+
+  late final _tau_analyser_set_smoothingPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Float)>>(
+          'tau_analyser_set_smoothing');
+  late final _tau_analyser_set_smoothing =
+      _tau_analyser_set_smoothingPtr.asFunction<int Function(ffi.Pointer<tau_context>, int, double)>();
+
+  /// The buffers the analyser `node` writes its results to: one channel of
+  /// `fft_size / 2` frames, the spectrum in decibels, and one of `fft_size`
+  /// frames, the last frames of the input.
+  ///
+  /// Returns a new reference to the buffer, to give back with
+  /// `tau_audio_buffer_release`, or NULL if `node` is not an analyser.
+  ffi.Pointer<tau_audio_buffer> tau_analyser_frequency_buffer(
+    ffi.Pointer<tau_context> context,
+    int node,
+  ) {
+    return _tau_analyser_frequency_buffer(
+      context,
+      node,
+    );
+  }
+
+  late final _tau_analyser_frequency_bufferPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_audio_buffer> Function(ffi.Pointer<tau_context>, ffi.Int32)>>(
+          'tau_analyser_frequency_buffer');
+  late final _tau_analyser_frequency_buffer =
+      _tau_analyser_frequency_bufferPtr.asFunction<ffi.Pointer<tau_audio_buffer> Function(ffi.Pointer<tau_context>, int)>();
+
+  ffi.Pointer<tau_audio_buffer> tau_analyser_time_domain_buffer(
+    ffi.Pointer<tau_context> context,
+    int node,
+  ) {
+    return _tau_analyser_time_domain_buffer(
+      context,
+      node,
+    );
+  }
+
+  late final _tau_analyser_time_domain_bufferPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_audio_buffer> Function(ffi.Pointer<tau_context>, ffi.Int32)>>(
+          'tau_analyser_time_domain_buffer');
+  late final _tau_analyser_time_domain_buffer =
+      _tau_analyser_time_domain_bufferPtr.asFunction<ffi.Pointer<tau_audio_buffer> Function(ffi.Pointer<tau_context>, int)>();
+
+  /// Writes the spectrum of the last `fft_size` frames of the analyser `node`
+  /// to its frequency buffer: the magnitudes of the Blackman-windowed frames,
+  /// smoothed with the previous spectrum, in decibels. Frames not rendered yet
+  /// count as silence.
+  ///
+  /// The spectrum is only computed again once frames were rendered since the
+  /// last call, so polling a paused context is free and smooths nothing. Calls
+  /// on the same analyser must not overlap. Returns a `tau_status`.
+  int tau_analyser_get_float_frequency_data(
+    ffi.Pointer<tau_context> context,
+    int node,
+  ) {
+    return _tau_analyser_get_float_frequency_data(
+      context,
+      node,
+    );
+  }
+
+  late final _tau_analyser_get_float_frequency_dataPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32)>>(
+          'tau_analyser_get_float_frequency_data');
+  late final _tau_analyser_get_float_frequency_data =
+      _tau_analyser_get_float_frequency_dataPtr.asFunction<int Function(ffi.Pointer<tau_context>, int)>();
+
+  /// Writes the last `fft_size` frames of the analyser `node` to its time
+  /// domain buffer. Calls on the same analyser must not overlap. Returns a
+  /// `tau_status`.
+  int tau_analyser_get_float_time_domain_data(
+    ffi.Pointer<tau_context> context,
+    int node,
+  ) {
+    return _tau_analyser_get_float_time_domain_data(
+      context,
+      node,
+    );
+  }
+
+  late final _tau_analyser_get_float_time_domain_dataPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32)>>(
+          'tau_analyser_get_float_time_domain_data');
+  late final _tau_analyser_get_float_time_domain_data =
+      _tau_analyser_get_float_time_domain_dataPtr.asFunction<int Function(ffi.Pointer<tau_context>, int)>();
+
+  /// Connects the output of `source` to the input of `destination`.
+  ///
+  /// Returns `TAU_OK`, or `TAU_ERROR_NOT_SUPPORTED` if the connection would
+  /// create a cycle.
+  int tau_node_connect(
+    ffi.Pointer<tau_context> context,
+    int source,
+    int destination,
+  ) {
+    return _tau_node_connect(
+      context,
+      source,
+      destination,
+    );
+  }
+
+  late final _tau_node_connectPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Int32)>>(
+          'tau_node_connect');
+  late final _tau_node_connect =
+      _tau_node_connectPtr.asFunction<int Function(ffi.Pointer<tau_context>, int, int)>();
+
+  /// Removes the connection from `source` to `destination`.
+  int tau_node_disconnect(
+    ffi.Pointer<tau_context> context,
+    int source,
+    int destination,
+  ) {
+    return _tau_node_disconnect(
+      context,
+      source,
+      destination,
+    );
+  }
+
+  late final _tau_node_disconnectPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Int32)>>(
+          'tau_node_disconnect');
+  late final _tau_node_disconnect =
+      _tau_node_disconnectPtr.asFunction<int Function(ffi.Pointer<tau_context>, int, int)>();
+
+  /// Starts a source node at `when` seconds, in context time.
+  int tau_node_start(
+    ffi.Pointer<tau_context> context,
+    int node,
+    double when,
+  ) {
+    return _tau_node_start(
+      context,
+      node,
+      when,
+    );
+  }
+
+  late final _tau_node_startPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Double)>>(
+          'tau_node_start');
+  late final _tau_node_start =
+      _tau_node_startPtr.asFunction<int Function(ffi.Pointer<tau_context>, int, double)>();
+
+  /// Stops a source node at `when` seconds, in context time.
+  int tau_node_stop(
+    ffi.Pointer<tau_context> context,
+    int node,
+    double when,
+  ) {
+    return _tau_node_stop(
+      context,
+      node,
+      when,
+    );
+  }
+
+  late final _tau_node_stopPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Double)>>(
+          'tau_node_stop');
+  late final _tau_node_stop =
+      _tau_node_stopPtr.asFunction<int Function(ffi.Pointer<tau_context>, int, double)>();
+
+  /// Disconnects a node from the graph and frees it. Its handle becomes invalid
+  /// at once; its memory is freed by a later edit, once the rendering thread is
+  /// done with it.
+  int tau_node_release(
+    ffi.Pointer<tau_context> context,
+    int node,
+  ) {
+    return _tau_node_release(
+      context,
+      node,
+    );
+  }
+
+  late final _tau_node_releasePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32)>>(
+          'tau_node_release');
+  late final _tau_node_release =
+      _tau_node_releasePtr.asFunction<int Function(ffi.Pointer<tau_context>, int)>();
+
+  /// Copies the timings of `node`, mixing its input and processing it, into
+  /// `profile`. Only the quanta the node was part of the graph count.
+  ///
+  /// Returns a `tau_status`: `TAU_ERROR_NOT_SUPPORTED` if profiling was
+  /// compiled out.
+  int tau_node_get_profile(
+    ffi.Pointer<tau_context> context,
+    int node,
+    ffi.Pointer<tau_profile> profile,
+  ) {
+    return _tau_node_get_profile(
+      context,
+      node,
+      profile,
+    );
+  }
+
+  late final _tau_node_get_profilePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Pointer<tau_profile>)>>(
+          'tau_node_get_profile');
+  late final _tau_node_get_profile =
+      _tau_node_get_profilePtr.asFunction<int Function(ffi.Pointer<tau_context>, int, ffi.Pointer<tau_profile>)>();
+
+  /// Sets the value of the parameter `param`, one of `tau_param_id`, of `node`,
+  /// from the next quantum. Once events were scheduled on the parameter, the
+  /// value is scheduled at the next quantum instead, as
+  /// `tau_param_set_value_at_time` would.
+  int tau_param_set_value(
+    ffi.Pointer<tau_context> context,
+    int node,
+    int param,
+    double value,
+  ) {
+    return _tau_param_set_value(
+      context,
+      node,
+      param,
+      value,
+    );
+  }
+
+  late final _tau_param_set_valuePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Int32, ffi.Float)>>(
+          'tau_param_set_value');
+  late final _tau_param_set_value =
+      _tau_param_set_valuePtr.asFunction<int Function(ffi.Pointer<tau_context>, int, int, double)>();
+
+  /// The value of the parameter `param` of `node` at the start of the last
+  /// quantum rendered, or NaN if there is no such parameter.
+  double tau_param_get_value(
+    ffi.Pointer<tau_context> context,
+    int node,
+    int param,
+  ) {
+    return _tau_param_get_value(
+      context,
+      node,
+      param,
+    );
+  }
+
+  late final _tau_param_get_valuePtr =
+      _lookup<ffi.NativeFunction<ffi.Float Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Int32)>>(
+          'tau_param_get_value');
+  late final _tau_param_get_value =
+      _tau_param_get_valuePtr.asFunction<double Function(ffi.Pointer<tau_context>, int, int)>();
+
+  /// Sets the value to `value` at `start_time`.
+  int tau_param_set_value_at_time(
+    ffi.Pointer<tau_context> context,
+    int node,
+    int param,
+    double value,
+    double start_time,
+  ) {
+    return _tau_param_set_value_at_time(
+      context,
+      node,
+      param,
+      value,
+      start_time,
+    );
+  }
+
+  late final _tau_param_set_value_at_timePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Int32, ffi.Float, ffi.Double)>>(
+          'tau_param_set_value_at_time');
+  late final _tau_param_set_value_at_time =
+      _tau_param_set_value_at_timePtr.asFunction<int Function(ffi.Pointer<tau_context>, int, int, double, double)>();
+
+  /// Ramps the value linearly from the previous event to `value` at
+  /// `end_time`.
+  int tau_param_linear_ramp_to_value_at_time(
+    ffi.Pointer<tau_context> context,
+    int node,
+    int param,
+    double value,
+    double end_time,
+  ) {
+    return _tau_param_linear_ramp_to_value_at_time(
+      context,
+      node,
+      param,
+      value,
+      end_time,
+    );
+  }
+
+  late final _tau_param_linear_ramp_to_value_at_timePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Int32, ffi.Float, ffi.Double)>>(
+          'tau_param_linear_ramp_to_value_at_time');
+  late final _tau_param_linear_ramp_to_value_at_time =
+      _tau_param_linear_ramp_to_value_at_timePtr.asFunction<int Function(ffi.Pointer<tau_context>, int, int, double, double)>();
+
+  /// Ramps the value exponentially from the previous event to `value`, which
+  /// must not be 0, at `end_time`.
+  int tau_param_exponential_ramp_to_value_at_time(
+    ffi.Pointer<tau_context> context,
+    int node,
+    int param,
+    double value,
+    double end_time,
+  ) {
+    return _tau_param_exponential_ramp_to_value_at_time(
+      context,
+      node,
+      param,
+      value,
+      end_time,
+    );
+  }
+
+  late final _tau_param_exponential_ramp_to_value_at_timePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Int32, ffi.Float, ffi.Double)>>(
+          'tau_param_exponential_ramp_to_value_at_time');
+  late final _tau_param_exponential_ramp_to_value_at_time =
+      _tau_param_exponential_ramp_to_value_at_timePtr.asFunction<int Function(ffi.Pointer<tau_context>, int, int, double, double)>();
+
+  /// Approaches `target` exponentially from `start_time`, with a time constant
+  /// of `time_constant` seconds.
+  int tau_param_set_target_at_time(
+    ffi.Pointer<tau_context> context,
+    int node,
+    int param,
+    double target,
+    double start_time,
+    double time_constant,
+  ) {
+    return _tau_param_set_target_at_time(
+      context,
+      node,
+      param,
+      target,
+      start_time,
+      time_constant,
+    );
+  }
+
+  late final _tau_param_set_target_at_timePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Int32, ffi.Float, ffi.Double, ffi.Double)>>(
+          'tau_param_set_target_at_time');
+  late final _tau_param_set_target_at_time =
+      _tau_param_set_target_at_timePtr.asFunction<int Function(ffi.Pointer<tau_context>, int, int, double, double, double)>();
+
+  /// Follows the `length` values of `values`, at least 2, interpolated linearly
+  /// over `duration` seconds from `start_time`. The values are copied.
+  int tau_param_set_value_curve_at_time(
+    ffi.Pointer<tau_context> context,
+    int node,
+    int param,
+    ffi.Pointer<ffi.Float> values,
+    int length,
+    double start_time,
+    double duration,
+  ) {
+    return _tau_param_set_value_curve_at_time(
+      context,
+      node,
+      param,
+      values,
+      length,
+      start_time,
+      duration,
+    );
+  }
+
+  late final _tau_param_set_value_curve_at_timePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Int32, ffi.Pointer<ffi.Float>, ffi.Int32, ffi.Double, ffi.Double)>>(
+          'tau_param_set_value_curve_at_time');
+  late final _tau_param_set_value_curve_at_time =
+      _tau_param_set_value_curve_at_timePtr.asFunction<int Function(ffi.Pointer<tau_context>, int, int, ffi.Pointer<ffi.Float>, int, double, double)>();
+
+  /// Removes the events scheduled at `cancel_time` or later.
+  int tau_param_cancel_scheduled_values(
+    ffi.Pointer<tau_context> context,
+    int node,
+    int param,
+    double cancel_time,
+  ) {
+    return _tau_param_cancel_scheduled_values(
+      context,
+      node,
+      param,
+      cancel_time,
+    );
+  }
+
+  late final _tau_param_cancel_scheduled_valuesPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Int32, ffi.Int32, ffi.Double)>>(
+          'tau_param_cancel_scheduled_values');
+  late final _tau_param_cancel_scheduled_values =
+      _tau_param_cancel_scheduled_valuesPtr.asFunction<int Function(ffi.Pointer<tau_context>, int, int, double)>();
+
+  /// Adds a codec, which is probed before the built-in ones and those added
+  /// before it. WAV (integer PCM of 8 to 32 bits and float) is built in.
+  ///
+  /// `codec` must outlive the library, and codecs must be registered before
+  /// streams are opened. Returns a `tau_status`.
+  int tau_codec_register(
+    ffi.Pointer<tau_codec> codec,
+  ) {
+    return _tau_codec_register(
+      codec,
+    );
+  }
+
+  late final _tau_codec_registerPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_codec>)>>(
+          'tau_codec_register');
+  late final _tau_codec_register =
+      _tau_codec_registerPtr.asFunction<int Function(ffi.Pointer<tau_codec>)>();
+
+  /// Opens the file at `path`, UTF-8 encoded, with a ring of at least
+  /// `buffer_frames` frames, or a default size if `buffer_frames` is not
+  /// positive. The file is read in chunks. Returns the stream, holding one
+  /// reference, or NULL if the file cannot be read or no codec decodes it.
+  ffi.Pointer<tau_stream> tau_stream_open(
+    ffi.Pointer<ffi.Char> path,
+    int buffer_frames,
+  ) {
+    return _tau_stream_open(
+      path,
+      buffer_frames,
+    );
+  }
+
+  late final _tau_stream_openPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_stream> Function(ffi.Pointer<ffi.Char>, ffi.Int32)>>(
+          'tau_stream_open');
+  late final _tau_stream_open =
+      _tau_stream_openPtr.asFunction<ffi.Pointer<tau_stream> Function(ffi.Pointer<ffi.Char>, int)>();
+
+  void tau_stream_retain(
+    ffi.Pointer<tau_stream> stream,
+  ) {
+    return _tau_stream_retain(
+      stream,
+    );
+  }
+
+  late final _tau_stream_retainPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_stream>)>>(
+          'tau_stream_retain');
+  late final _tau_stream_retain =
+      _tau_stream_retainPtr.asFunction<void Function(ffi.Pointer<tau_stream>)>();
+
+  /// Gives back a reference to `stream`. The last one stops decoding and
+  /// closes the file.
+  void tau_stream_release(
+    ffi.Pointer<tau_stream> stream,
+  ) {
+    return _tau_stream_release(
+      stream,
+    );
+  }
+
+  late final _tau_stream_releasePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_stream>)>>(
+          'tau_stream_release');
+  late final _tau_stream_release =
+      _tau_stream_releasePtr.asFunction<void Function(ffi.Pointer<tau_stream>)>();
+
+  int tau_stream_channels(
+    ffi.Pointer<tau_stream> stream,
+  ) {
+    return _tau_stream_channels(
+      stream,
+    );
+  }
+
+  late final _tau_stream_channelsPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_stream>)>>(
+          'tau_stream_channels');
+  late final _tau_stream_channels =
+      _tau_stream_channelsPtr.asFunction<int Function(ffi.Pointer<tau_stream>)>(isLeaf: true);
+
+  double tau_stream_sample_rate(
+    ffi.Pointer<tau_stream> stream,
+  ) {
+    return _tau_stream_sample_rate(
+      stream,
+    );
+  }
+
+  late final _tau_stream_sample_ratePtr =
+      _lookup<ffi.NativeFunction<ffi.Float Function(ffi.Pointer<tau_stream>)>>(
+          'tau_stream_sample_rate');
+  late final _tau_stream_sample_rate =
+      _tau_stream_sample_ratePtr.asFunction<double Function(ffi.Pointer<tau_stream>)>(isLeaf: true);
+
+  /// The number of frames of the stream, or -1 if unknown.
+  int tau_stream_length(
+    ffi.Pointer<tau_stream> stream,
+  ) {
+    return _tau_stream_length(
+      stream,
+    );
+  }
+
+  late final _tau_stream_lengthPtr =
+      _lookup<ffi.NativeFunction<ffi.Int64 Function(ffi.Pointer<tau_stream>)>>(
+          'tau_stream_length');
+  late final _tau_stream_length =
+      _tau_stream_lengthPtr.asFunction<int Function(ffi.Pointer<tau_stream>)>(isLeaf: true);
+
+  /// Reads the next frames of `stream` into `buffer`, which must have as many
+  /// channels, waiting for them to be decoded. A buffer longer than the ring
+  /// is filled in several turns of decoding.
+  ///
+  /// Returns the number of frames read, fewer than `buffer->frames` only at the
+  /// end of the stream, or a negative `tau_status` if decoding failed.
+  int tau_stream_read(
+    ffi.Pointer<tau_stream> stream,
+    ffi.Pointer<tau_audio_buffer> buffer,
+  ) {
+    return _tau_stream_read(
+      stream,
+      buffer,
+    );
+  }
+
+  late final _tau_stream_readPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_stream>, ffi.Pointer<tau_audio_buffer>)>>(
+          'tau_stream_read');
+  late final _tau_stream_read =
+      _tau_stream_readPtr.asFunction<int Function(ffi.Pointer<tau_stream>, ffi.Pointer<tau_audio_buffer>)>();
+
+  /// Creates a source playing `stream`, converted to the sample rate of the
+  /// context at its resampler quality. The source takes a reference to `stream`.
+  ///
+  /// In real time, frames not decoded yet when they are needed play as
+  /// silence; with `blocking`, for offline rendering, the rendering thread
+  /// waits for them instead, so the graph paces itself on the decoder rather
+  /// than rendering gaps.
+  ///
+  /// Returns the node handle, or a negative `tau_status`.
+  int tau_stream_source_create(
+    ffi.Pointer<tau_context> context,
+    ffi.Pointer<tau_stream> stream,
+    int blocking,
+  ) {
+    return _tau_stream_source_create(
+      context,
+      stream,
+      blocking,
+    );
+  }
+
+  late final _tau_stream_source_createPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_context>, ffi.Pointer<tau_stream>, ffi.Int32)>>(
+          'tau_stream_source_create');
+  late final _tau_stream_source_create =
+      _tau_stream_source_createPtr.asFunction<int Function(ffi.Pointer<tau_context>, ffi.Pointer<tau_stream>, int)>();
+
+  /// The quanta the stream source `node` played partly or wholly as silence
+  /// because their frames were not decoded in time, or a negative
+  /// `tau_status`.
+  int tau_stream_source_underruns(
+    ffi.Pointer<tau_context> context,
+    int node,
+  ) {
+    return _tau_stream_source_underruns(
+      context,
+      node,
+    );
+  }
+
+  late final _tau_stream_source_underrunsPtr =
+      _lookup<ffi.NativeFunction<ffi.Int64 Function(ffi.Pointer<tau_context>, ffi.Int32)>>(
+          'tau_stream_source_underruns');
+  late final _tau_stream_source_underruns =
+      _tau_stream_source_underrunsPtr.asFunction<int Function(ffi.Pointer<tau_context>, int)>();
+
+  /// Decodes the whole file at `path` into a new buffer, as the Web Audio
+  /// `decodeAudioData`. Memory use grows with the length of the file: prefer a
+  /// stream for long files.
+  ///
+  /// Returns the buffer, holding one reference, or NULL on failure.
+  ffi.Pointer<tau_audio_buffer> tau_decode_file(
+    ffi.Pointer<ffi.Char> path,
+  ) {
+    return _tau_decode_file(
+      path,
+    );
+  }
+
+  late final _tau_decode_filePtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_audio_buffer> Function(ffi.Pointer<ffi.Char>)>>(
+          'tau_decode_file');
+  late final _tau_decode_file =
+      _tau_decode_filePtr.asFunction<ffi.Pointer<tau_audio_buffer> Function(ffi.Pointer<ffi.Char>)>();
+
+  /// Opens the cache in `directory`, UTF-8 encoded, creating the directory if
+  /// needed but not its parents, and evicts entries past `max_bytes`.
+  ///
+  /// Returns the cache, or NULL if the directory cannot be created or
+  /// `max_bytes` is negative.
+  ffi.Pointer<tau_cache> tau_cache_open(
+    ffi.Pointer<ffi.Char> directory,
+    int max_bytes,
+  ) {
+    return _tau_cache_open(
+      directory,
+      max_bytes,
+    );
+  }
+
+  late final _tau_cache_openPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_cache> Function(ffi.Pointer<ffi.Char>, ffi.Int64)>>(
+          'tau_cache_open');
+  late final _tau_cache_open =
+      _tau_cache_openPtr.asFunction<ffi.Pointer<tau_cache> Function(ffi.Pointer<ffi.Char>, int)>();
+
+  /// Closes `cache`. Buffers loaded from it stay valid.
+  void tau_cache_close(
+    ffi.Pointer<tau_cache> cache,
+  ) {
+    return _tau_cache_close(
+      cache,
+    );
+  }
+
+  late final _tau_cache_closePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_cache>)>>(
+          'tau_cache_close');
+  late final _tau_cache_close =
+      _tau_cache_closePtr.asFunction<void Function(ffi.Pointer<tau_cache>)>();
+
+  /// Changes the size limit of `cache`, evicting entries past it. Returns a
+  /// `tau_status`.
+  int tau_cache_set_limit(
+    ffi.Pointer<tau_cache> cache,
+    int max_bytes,
+  ) {
+    return _tau_cache_set_limit(
+      cache,
+      max_bytes,
+    );
+  }
+
+  late final _tau_cache_set_limitPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_cache>, ffi.Int64)>>(
+          'tau_cache_set_limit');
+  late final _tau_cache_set_limit =
+      _tau_cache_set_limitPtr.asFunction<int Function(ffi.Pointer<tau_cache>, int)>();
+
+  /// Loads the file at `path` from `cache`, decoding it and adding an entry if
+  /// its content has none. The content of the file is read in full to hash it.
+  ///
+  /// Returns the buffer, holding one reference, or NULL if the file cannot be
+  /// decoded. A buffer is returned even if its entry cannot be written.
+  ffi.Pointer<tau_audio_buffer> tau_cache_load(
+    ffi.Pointer<tau_cache> cache,
+    ffi.Pointer<ffi.Char> path,
+  ) {
+    return _tau_cache_load(
+      cache,
+      path,
+    );
+  }
+
+  late final _tau_cache_loadPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_audio_buffer> Function(ffi.Pointer<tau_cache>, ffi.Pointer<ffi.Char>)>>(
+          'tau_cache_load');
+  late final _tau_cache_load =
+      _tau_cache_loadPtr.asFunction<ffi.Pointer<tau_audio_buffer> Function(ffi.Pointer<tau_cache>, ffi.Pointer<ffi.Char>)>();
+
+  void tau_cache_get_stats(
+    ffi.Pointer<tau_cache> cache,
+    ffi.Pointer<tau_cache_stats> stats,
+  ) {
+    return _tau_cache_get_stats(
+      cache,
+      stats,
+    );
+  }
+
+  late final _tau_cache_get_statsPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_cache>, ffi.Pointer<tau_cache_stats>)>>(
+          'tau_cache_get_stats');
+  late final _tau_cache_get_stats =
+      _tau_cache_get_statsPtr.asFunction<void Function(ffi.Pointer<tau_cache>, ffi.Pointer<tau_cache_stats>)>();
+
+  /// Adds a device backend, found by name before the built-in ones and those
+  /// added before it.
+  ///
+  /// Two backends are built in, for machines without a sound card: "null",
+  /// which discards the audio at the pace of the monotonic clock, and "wav",
+  /// which also writes it to the float WAV file at the path given as options.
+  ///
+  /// `backend` must outlive the library. Returns a `tau_status`.
+  int tau_device_backend_register(
+    ffi.Pointer<tau_device_backend> backend,
+  ) {
+    return _tau_device_backend_register(
+      backend,
+    );
+  }
+
+  late final _tau_device_backend_registerPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_device_backend>)>>(
+          'tau_device_backend_register');
+  late final _tau_device_backend_register =
+      _tau_device_backend_registerPtr.asFunction<int Function(ffi.Pointer<tau_device_backend>)>();
+
+  /// Opens a device of the backend named `backend`, with `options`, playing
+  /// `context` in periods of `period_frames` frames, from 1 to 16384.
+  ///
+  /// Returns the device, stopped, or NULL if there is no such backend or it
+  /// cannot open the device.
+  ffi.Pointer<tau_device> tau_device_open(
+    ffi.Pointer<tau_context> context,
+    ffi.Pointer<ffi.Char> backend,
+    ffi.Pointer<ffi.Char> options,
+    int period_frames,
+  ) {
+    return _tau_device_open(
+      context,
+      backend,
+      options,
+      period_frames,
+    );
+  }
+
+  late final _tau_device_openPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<tau_device> Function(ffi.Pointer<tau_context>, ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>, ffi.Int32)>>(
+          'tau_device_open');
+  late final _tau_device_open =
+      _tau_device_openPtr.asFunction<ffi.Pointer<tau_device> Function(ffi.Pointer<tau_context>, ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>, int)>();
+
+  /// Starts or stops playing. Returns a `tau_status`.
+  int tau_device_start(
+    ffi.Pointer<tau_device> device,
+  ) {
+    return _tau_device_start(
+      device,
+    );
+  }
+
+  late final _tau_device_startPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_device>)>>(
+          'tau_device_start');
+  late final _tau_device_start =
+      _tau_device_startPtr.asFunction<int Function(ffi.Pointer<tau_device>)>();
+
+  int tau_device_stop(
+    ffi.Pointer<tau_device> device,
+  ) {
+    return _tau_device_stop(
+      device,
+    );
+  }
+
+  late final _tau_device_stopPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<tau_device>)>>(
+          'tau_device_stop');
+  late final _tau_device_stop =
+      _tau_device_stopPtr.asFunction<int Function(ffi.Pointer<tau_device>)>();
+
+  /// Stops and closes `device`.
+  void tau_device_close(
+    ffi.Pointer<tau_device> device,
+  ) {
+    return _tau_device_close(
+      device,
+    );
+  }
+
+  late final _tau_device_closePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_device>)>>(
+          'tau_device_close');
+  late final _tau_device_close =
+      _tau_device_closePtr.asFunction<void Function(ffi.Pointer<tau_device>)>();
+
+  /// Copies the counters of `device`, which may be playing, into `stats`.
+  void tau_device_get_stats(
+    ffi.Pointer<tau_device> device,
+    ffi.Pointer<tau_device_stats> stats,
+  ) {
+    return _tau_device_get_stats(
+      device,
+      stats,
+    );
+  }
+
+  late final _tau_device_get_statsPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<tau_device>, ffi.Pointer<tau_device_stats>)>>(
+          'tau_device_get_stats');
+  late final _tau_device_get_stats =
+      _tau_device_get_statsPtr.asFunction<void Function(ffi.Pointer<tau_device>, ffi.Pointer<tau_device_stats>)>();
+}
+
+/// Status codes returned by the functions that can fail.
+abstract class tau_status {
+  static const int TAU_OK = 0;
+  static const int TAU_ERROR_INVALID_ARGUMENT = -1;
+  static const int TAU_ERROR_OUT_OF_MEMORY = -2;
+
+  /// `tau_async_init` has not been called.
+  static const int TAU_ERROR_NOT_INITIALIZED = -3;
+
+  /// The call is not allowed in the current state, such as starting a source
+  /// node twice.
+  static const int TAU_ERROR_INVALID_STATE = -4;
+
+  /// The graph does not support the request, such as a connection that would
+  /// create a cycle.
+  static const int TAU_ERROR_NOT_SUPPORTED = -5;
+
+  /// A file could not be read, or its contents are malformed.
+  static const int TAU_ERROR_IO = -6;
+}
+
+/// Operations understood by `tau_batch_execute`.
+abstract class tau_opcode {
+  /// `results[i] = a[i] + b[i]`, the batched form of `sum`.
+  static const int TAU_OP_SUM = 0;
+
+  /// `results[i] = a[i] - b[i]`.
+  static const int TAU_OP_SUBTRACT = 1;
+
+  /// `results[i] = a[i] * b[i]`.
+  static const int TAU_OP_MULTIPLY = 2;
+
+  /// `results[i] = sum_long_running(a[i], b[i])`. Only accepted in a
+  /// `tau_ring`: `tau_batch_execute` must stay short-lived.
+  static const int TAU_OP_SUM_LONG_RUNNING = 3;
+}
+
+/// A native-owned command buffer executed by `tau_batch_execute`.
+///
+/// Commands are stored as a struct of arrays: command `i` applies `opcodes[i]`
+/// to `a[i]` and `b[i]` and writes its result to `results[i]`. Every array holds
+/// `capacity` elements and keeps its address for the lifetime of the batch, so
+/// Dart can view them once with `asTypedList` and fill them without any further
+/// native call.
+final class tau_batch extends ffi.Struct {
+  external ffi.Pointer<ffi.Int32> opcodes;
+
+  external ffi.Pointer<ffi.Int32> a;
+
+  external ffi.Pointer<ffi.Int32> b;
+
+  external ffi.Pointer<ffi.Int32> results;
+
+  /// The number of elements in each array.
+  @ffi.Int32()
+  external int capacity;
+
+  /// The number of commands to run on the next `tau_batch_execute`.
+  @ffi.Int32()
+  external int count;
+}
+
+/// A fixed-size request record in a `tau_ring`.
+final class tau_ring_request extends ffi.Struct {
+  /// One of `tau_opcode`.
+  @ffi.Int32()
+  external int opcode;
+
+  @ffi.Int32()
+  external int a;
+
+  @ffi.Int32()
+  external int b;
+
+  @ffi.Int32()
+  external int reserved;
+}
+
+/// A completion record in a `tau_ring`.
+final class tau_ring_completion extends ffi.Struct {
+  /// The position at which the request was written, counting from 0.
+  @ffi.Int64()
+  external int sequence;
+
+  @ffi.Int32()
+  external int result;
+
+  /// `TAU_OK`, or `TAU_ERROR_INVALID_ARGUMENT` for an unknown opcode.
+  @ffi.Int32()
+  external int status;
+}
+
+/// A pair of shared-memory rings carrying requests from Dart to the native
+/// worker pool, and their results back.
+///
+/// Requests are written in order directly into `tau_ring_requests`, request
+/// number `n` going to slot `n % capacity`, and published with
+/// `tau_ring_submit`. Workers claim them concurrently and publish each result
+/// into `tau_ring_completions` as soon as it is ready, so completions arrive out
+/// of order. They are consumed with `tau_ring_poll` and `tau_ring_release`.
+///
+/// No memory is allocated and no message is sent per request: the ring only
+/// posts to its Dart port when a completion arrives while the consumer is not
+/// already due to poll.
+final class tau_ring extends ffi.Opaque {}
+
+/// Planar audio samples shared between Dart and native code without copies.
+///
+/// Channel `c` holds `frames` samples starting at `data + c * stride`; each
+/// channel starts on a `TAU_AUDIO_BUFFER_ALIGNMENT` boundary. Dart views the
+/// channels with `asTypedList`, and render nodes read and write the same
+/// memory.
+///
+/// A buffer is reference counted: every owner, such as a Dart view or a buffer
+/// source node, holds a reference taken with `tau_audio_buffer_retain` and
+/// gives it back with `tau_audio_buffer_release`. The fields are read-only.
+final class tau_audio_buffer extends ffi.Struct {
+  external ffi.Pointer<ffi.Float> data;
+
+  @ffi.Int32()
+  external int channels;
+
+  @ffi.Int32()
+  external int frames;
+
+  /// The distance between the starts of two channels, in samples.
+  @ffi.Int32()
+  external int stride;
+
+  @ffi.Float()
+  external double sample_rate;
+
+  /// The number of references. Only changed by retain and release.
+  @ffi.Int32()
+  external int references;
+
+  /// The size of the file mapping holding the samples of a buffer loaded from
+  /// a `tau_cache`, or 0 if they are on the heap.
+  @ffi.Int64()
+  external int mapped_bytes;
+}
+
+/// An audio render graph: the native counterpart of a Web Audio
+/// `BaseAudioContext`.
+///
+/// Nodes are identified by non-negative integer handles returned by the
+/// `tau_*_create` functions. The graph may be edited from any number of
+/// threads, including while another thread runs `tau_context_render`: edits
+/// are queued for the rendering thread, which applies them before the next
+/// quantum without ever waiting for an editing thread. Rendering itself must
+/// stay on one thread at a time.
+final class tau_context extends ffi.Opaque {}
+
+/// How long the rendering of a context or of one of its nodes took, quantum
+/// by quantum, since it was created.
+///
+/// Bucket `i` counts the quanta that took from 2^i to 2^(i + 1) nanoseconds;
+/// the first also counts shorter ones, and the last longer ones. The deadline
+/// is the real-time duration of a quantum: a context missing it underruns a
+/// sound device, and a node missing it is the reason.
+///
+/// The rendering thread records the timings without waiting or allocating,
+/// unless the library is built with `TAU_FFI_PROFILING` off. A snapshot read
+/// while rendering may be a quantum behind in some fields.
+final class tau_profile extends ffi.Struct {
+  /// The quanta rendered, and their total and longest durations.
+  @ffi.Int64()
+  external int count;
+
+  @ffi.Int64()
+  external int total_ns;
+
+  @ffi.Int64()
+  external int max_ns;
+
+  @ffi.Array.multi([32])
+  external ffi.Array<ffi.Int64> buckets;
+
+  /// The duration of a quantum at the sample rate, and the number of quanta
+  /// that took longer.
+  @ffi.Int64()
+  external int deadline_ns;
+
+  @ffi.Int64()
+  external int underruns;
+}
+
+/// Waveforms of `tau_oscillator_create`.
+abstract class tau_oscillator_type {
+  static const int TAU_OSCILLATOR_SINE = 0;
+  static const int TAU_OSCILLATOR_SQUARE = 1;
+  static const int TAU_OSCILLATOR_SAWTOOTH = 2;
+  static const int TAU_OSCILLATOR_TRIANGLE = 3;
+}
+
+/// Automatable parameters of the nodes.
+abstract class tau_param_id {
+  /// Gain of a gain node, or of a biquad filter band in decibels.
+  static const int TAU_PARAM_GAIN = 0;
+
+  /// Frequency of an oscillator or of a biquad filter band, in hertz.
+  static const int TAU_PARAM_FREQUENCY = 1;
+
+  /// Detune of an oscillator, a buffer source or a biquad filter band, in
+  /// cents.
+  static const int TAU_PARAM_DETUNE = 2;
+
+  /// Playback rate of a buffer source.
+  static const int TAU_PARAM_PLAYBACK_RATE = 3;
+
+  /// Quality factor of a biquad filter band.
+  static const int TAU_PARAM_Q = 4;
+
+  /// Parameters of a compressor: the level compression starts from, in
+  /// decibels, the width of the knee centred on it, in decibels, the ratio
+  /// of the input level over the threshold to the output level over it, and
+  /// the attack and release times, in seconds. They are k-rate.
+  static const int TAU_PARAM_THRESHOLD = 5;
+  static const int TAU_PARAM_KNEE = 6;
+  static const int TAU_PARAM_RATIO = 7;
+  static const int TAU_PARAM_ATTACK = 8;
+  static const int TAU_PARAM_RELEASE = 9;
+
+  /// Position of a panner relative to the listener, who stands at the origin
+  /// facing -z with +y up, as in Web Audio. They are k-rate.
+  static const int TAU_PARAM_POSITION_X = 10;
+  static const int TAU_PARAM_POSITION_Y = 11;
+  static const int TAU_PARAM_POSITION_Z = 12;
+}
+
+/// Quality tiers of the sample-rate conversion of sources, from the cheapest.
+abstract class tau_resampler_quality {
+  /// Linear interpolation between neighbouring samples, as Web Audio
+  /// implementations do. Aliases audibly.
+  static const int TAU_RESAMPLER_LINEAR = 0;
+
+  /// Polyphase windowed-sinc filters of 16, 32 and 64 taps when converting
+  /// up, attenuating what the output rate cannot represent by 60, 90 and
+  /// 120 dB.
+  static const int TAU_RESAMPLER_LOW = 1;
+  static const int TAU_RESAMPLER_MEDIUM = 2;
+  static const int TAU_RESAMPLER_HIGH = 3;
+}
+
+/// Counters of a voice pool.
+final class tau_voice_pool_stats extends ffi.Struct {
+  @ffi.Int32()
+  external int voices;
+
+  /// The voices playing or scheduled to.
+  @ffi.Int32()
+  external int playing;
+
+  /// The notes played since the pool was created, and how many of them cut
+  /// off the oldest note because every voice was playing.
+  @ffi.Int64()
+  external int notes;
+
+  @ffi.Int64()
+  external int steals;
+}
+
+/// Filter types of `tau_biquad_filter_create`, as the Web Audio
+/// `BiquadFilterType`.
+abstract class tau_biquad_type {
+  static const int TAU_BIQUAD_LOWPASS = 0;
+  static const int TAU_BIQUAD_HIGHPASS = 1;
+  static const int TAU_BIQUAD_BANDPASS = 2;
+  static const int TAU_BIQUAD_LOWSHELF = 3;
+  static const int TAU_BIQUAD_HIGHSHELF = 4;
+  static const int TAU_BIQUAD_PEAKING = 5;
+  static const int TAU_BIQUAD_NOTCH = 6;
+  static const int TAU_BIQUAD_ALLPASS = 7;
+}
+
+/// Head-related impulse responses for the HRTF panning of
+/// `tau_panner_create`, shared by any number of panners in any contexts of
+/// its sample rate.
+///
+/// The responses are kept as spectra, ready to be convolved. Panners look
+/// them up by cell of 2 degrees of azimuth and elevation: the responses of a
+/// cell are interpolated from the three nearest measurements the first time
+/// a panner points into it, then kept in a cache that every panner reads
+/// without locking. Once the cache is full, a panner entering a cell not in
+/// it interpolates the responses for itself. It is reference counted like
+/// `tau_audio_buffer`.
+final class tau_hrtf extends ffi.Opaque {}
+
+/// The thread processing the blocks of worklet nodes, such as a Dart isolate
+/// running `AudioWorkletProcessor`s, and the queue between it and the
+/// rendering threads.
+///
+/// Each worklet node owns a few blocks of shared memory, which it fills with
+/// its input and queues here one quantum ahead of the output it needs back,
+/// or more. The processing thread takes the blocks with
+/// `tau_worklet_host_wait`, writes their output in place and hands them back
+/// with `tau_worklet_host_complete`. Nothing is copied or allocated on the
+/// way, and the rendering thread never waits for the processing thread,
+/// unless the node was created blocking: it only wakes it through a
+/// semaphore, and a block not back in time is an underrun of the node.
+///
+/// The host has one reference for its owner, and one per worklet node.
+final class tau_worklet_host extends ffi.Opaque {}
+
+/// A quantum of a worklet node for the processing thread: planar channels of
+/// `TAU_RENDER_QUANTUM_FRAMES` samples. `key` is the one the node was created
+/// with, and `frame` the context frame the input starts at.
+final class tau_worklet_block extends ffi.Struct {
+  @ffi.Int64()
+  external int key;
+
+  @ffi.Int64()
+  external int frame;
+
+  external ffi.Pointer<ffi.Float> input;
+
+  external ffi.Pointer<ffi.Float> output;
+
+  @ffi.Int32()
+  external int input_channels;
+
+  @ffi.Int32()
+  external int output_channels;
+}
+
+/// Reads the bytes of an encoded stream for a codec.
+final class tau_reader extends ffi.Struct {
+  /// Reads up to `size` bytes into `buffer`. Returns the number of bytes read,
+  /// 0 at the end of the stream, or a negative `tau_status`.
+  external ffi.Pointer<
+      ffi.NativeFunction<
+          ffi.Int64 Function(
+              ffi.Pointer<ffi.Void> user,
+              ffi.Pointer<ffi.Void> buffer,
+              ffi.Int64 size,
+          )>> read;
+
+  /// Moves to `offset` bytes from the start of the stream. Returns a
+  /// `tau_status`.
+  external ffi.Pointer<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<ffi.Void> user,
+              ffi.Int64 offset,
+          )>> seek;
+
+  external ffi.Pointer<ffi.Void> user;
+}
+
+/// The audio of an encoded stream.
+final class tau_stream_format extends ffi.Struct {
+  @ffi.Int32()
+  external int channels;
+
+  @ffi.Float()
+  external double sample_rate;
+
+  /// The number of frames, or -1 if the stream does not tell.
+  @ffi.Int64()
+  external int frames;
+}
+
+/// A decoder of one encoded format, such as WAV.
+///
+/// Codecs decode incrementally: a stream calls `decode` for a few thousand
+/// frames at a time, so that memory use does not depend on the length of the
+/// stream. Every function is called from one thread at a time, though not
+/// always the same one.
+final class tau_codec extends ffi.Struct {
+  external ffi.Pointer<ffi.Char> name;
+
+  /// Whether the first `size` bytes of a stream, at most
+  /// `TAU_CODEC_PROBE_BYTES`, are in the format of the codec.
+  external ffi.Pointer<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<ffi.Uint8> header,
+              ffi.Int32 size,
+          )>> probe;
+
+  /// Starts decoding from `reader`, positioned at the start of the stream,
+  /// and fills `format`. Returns the decoder, or NULL.
+  external ffi.Pointer<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Void> Function(
+              ffi.Pointer<tau_reader> reader,
+              ffi.Pointer<tau_stream_format> format,
+          )>> open;
+
+  /// Decodes up to `frames` frames into `channels`, one planar pointer per
+  /// channel. Returns the number of frames decoded, 0 at the end of the
+  /// stream, or a negative `tau_status`.
+  external ffi.Pointer<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<ffi.Void> decoder,
+              ffi.Pointer<ffi.Pointer<ffi.Float>> channels,
+              ffi.Int32 frames,
+          )>> decode;
+
+  external ffi.Pointer<
+      ffi.NativeFunction<
+          ffi.Void Function(
+              ffi.Pointer<ffi.Void> decoder,
+          )>> close;
+}
+
+/// Decoded audio read incrementally from a file.
+///
+/// A stream decodes on a thread of its own into a ring of decoded frames,
+/// ahead of its reader: memory use is bounded by the ring, whatever the
+/// length of the file, and the first frames are available as soon as the
+/// first chunk is decoded. When the ring is full, decoding waits for the
+/// reader; when it is empty, the reader waits for decoding.
+///
+/// A stream has a single reader: either `tau_stream_read` or one stream
+/// source node. It is reference counted like `tau_audio_buffer`.
+final class tau_stream extends ffi.Opaque {}
+
+/// A cache of decoded audio files in a directory, shared between contexts and
+/// processes.
+///
+/// An entry holds the decoded samples of one file as aligned planar float32,
+/// and is named after a hash of the content of the file, so copies of a file
+/// share an entry and edited files get a new one. Loading an entry maps its
+/// file into memory instead of decoding: processes loading the same entry
+/// share its pages, and a buffer written to gets private copies of the pages
+/// it writes, which are never seen by other loads.
+///
+/// When the entries grow past the size limit, the least recently loaded ones
+/// are deleted. Entries are native-endian: a cache directory is not portable
+/// between machines.
+final class tau_cache extends ffi.Opaque {}
+
+/// Counters of a `tau_cache`, since it was opened by this process.
+final class tau_cache_stats extends ffi.Struct {
+  /// Loads that mapped an existing entry.
+  @ffi.Int64()
+  external int hits;
+
+  /// Loads that decoded the file and added an entry.
+  @ffi.Int64()
+  external int misses;
+
+  /// Entries deleted to stay within the size limit, and their size.
+  @ffi.Int64()
+  external int evictions;
+
+  @ffi.Int64()
+  external int evicted_bytes;
+
+  /// The entries in the directory and their total size, as of the last
+  /// eviction pass.
+  @ffi.Int64()
+  external int entries;
+
+  @ffi.Int64()
+  external int bytes;
+}
+
+/// Fills `output` with `frames` interleaved frames for a device. The device
+/// needs them within `time_left_ns` nanoseconds, which is negative if it is
+/// already late.
+typedef tau_device_callback =
+    ffi.Pointer<ffi.NativeFunction<tau_device_callbackFunction>>;
+typedef tau_device_callbackFunction = ffi.Void Function(
+    ffi.Pointer<ffi.Void> user,
+    ffi.Pointer<ffi.Float> output,
+    ffi.Int32 frames,
+    ffi.Int64 time_left_ns,
+);
+typedef Darttau_device_callbackFunction = void Function(
+    ffi.Pointer<ffi.Void> user,
+    ffi.Pointer<ffi.Float> output,
+    int frames,
+    int time_left_ns,
+);
+
+/// A kind of audio output that plays a context in real time, such as the
+/// sound system of a platform.
+///
+/// A device pulls the audio: once started, it calls the callback on a thread
+/// of its own, a period of frames at a time, at the pace of its clock. The
+/// functions other than the callback are called from one thread at a time.
+final class tau_device_backend extends ffi.Struct {
+  external ffi.Pointer<ffi.Char> name;
+
+  /// Opens a device of `channels` channels at `sample_rate`, asking
+  /// `callback` for periods of `period_frames` frames. `options` means what
+  /// the backend says, and may be NULL. Returns the device, or NULL.
+  external ffi.Pointer<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Void> Function(
+              ffi.Pointer<ffi.Char> options,
+              ffi.Int32 channels,
+              ffi.Float sample_rate,
+              ffi.Int32 period_frames,
+              tau_device_callback callback,
+              ffi.Pointer<ffi.Void> user,
+          )>> open;
+
+  /// Starts and stops the callbacks. `stop` returns once the last callback
+  /// has returned. Both return a `tau_status`.
+  external ffi.Pointer<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<ffi.Void> device,
+          )>> start;
+
+  external ffi.Pointer<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<ffi.Void> device,
+          )>> stop;
+
+  external ffi.Pointer<
+      ffi.NativeFunction<
+          ffi.Void Function(
+              ffi.Pointer<ffi.Void> device,
+          )>> close;
+}
+
+/// A device playing a context: the real-time counterpart of
+/// `tau_context_render`. While the device is started, its callbacks render
+/// the context, which must not be rendered otherwise, and which must outlive
+/// the device. The graph may still be edited from any thread.
+final class tau_device extends ffi.Opaque {}
+
+/// Counters of a `tau_device`, since it was opened.
+final class tau_device_stats extends ffi.Struct {
+  @ffi.Int64()
+  external int callbacks;
+
+  @ffi.Int64()
+  external int frames;
+
+  /// The callbacks that returned after the device needed their period: what
+  /// a listener hears as a glitch.
+  @ffi.Int64()
+  external int underruns;
+
+  /// The time the callbacks took to render, in total and at most.
+  @ffi.Int64()
+  external int render_ns;
+
+  @ffi.Int64()
+  external int max_render_ns;
+
+  /// How far the time between two callbacks strayed from a period, in total
+  /// and at most.
+  @ffi.Int64()
+  external int jitter_ns;
+
+  @ffi.Int64()
+  external int max_jitter_ns;
 }
+
+const int TAU_AUDIO_BUFFER_ALIGNMENT = 64;
+
+const int TAU_RENDER_QUANTUM_FRAMES = 128;
+
+const int TAU_MAX_CHANNELS = 32;
+
+const int TAU_PROFILE_BUCKETS = 32;
+
+const int TAU_VOICE_INDEX_BITS = 10;
+
+const int TAU_MAX_VOICES = 1024;
+
+const int TAU_BIQUAD_MAX_BANDS = 32;
+
+const int TAU_BIQUAD_BAND_STRIDE = 256;
+
+const int TAU_HRTF_MAX_FRAMES = 512;
+
+const int TAU_WORKLET_MAX_LATENCY = 16;
+
+const int TAU_ANALYSER_MIN_FFT_SIZE = 32;
+
+const int TAU_ANALYSER_MAX_FFT_SIZE = 32768;
+
+const int TAU_CODEC_PROBE_BYTES = 64;
@@ -0,0 +1,78 @@
+#ifndef TAU_FFI_BENCH_H_
+#define TAU_FFI_BENCH_H_
+
+#include "tau_ffi.h"
+
+#if _WIN32
+#else
+#include <time.h>
+#endif
+
+// The minimum wall-clock time spent measuring a single configuration.
+#define BENCH_MIN_SECONDS 0.2
+
+// A monotonic clock, in seconds.
+static inline double bench_now(void) {
+#if _WIN32
+  LARGE_INTEGER frequency;
+  LARGE_INTEGER counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+}
+
+// Keeps the compiler from discarding results that are never read.
+extern volatile int64_t bench_sink;
+
+// The duration given with `--seconds`, for the benchmarks that run for a
+// duration, or 0.
+extern double bench_seconds;
+
+// Records a headline result of the running benchmark, named `format`
+// after the name of the benchmark, for `--json` and `--baseline`.
+void bench_metric(double value, const char* unit, int higher_is_better,
+                  const char* format, ...);
+
+// Names the metrics recorded next after `benchmark`.
+void bench_report_begin(const char* benchmark);
+
+// Writes the metrics recorded so far to `path` as JSON. Returns 0 on
+// success.
+int bench_report_write(const char* path);
+
+// Compares the metrics recorded so far with those of `path`, written by
+// `bench_report_write`, and prints the comparison. Returns 0 unless a metric
+// is worse than in `path` by more than `threshold`, a fraction.
+int bench_report_compare(const char* path, double threshold);
+
+// Each benchmark returns 0 on success.
+int bench_analyser(void);
+int bench_automation(void);
+int bench_batch(void);
+int bench_biquad(void);
+int bench_buffer(void);
+int bench_cache(void);
+int bench_compressor(void);
+int bench_control(void);
+int bench_convolver(void);
+int bench_device(void);
+int bench_graph(void);
+int bench_kernels(void);
+int bench_memory(void);
+int bench_mix(void);
+int bench_panner(void);
+int bench_pool(void);
+int bench_profile(void);
+int bench_ring(void);
+int bench_render(void);
+int bench_resampler(void);
+int bench_stream(void);
+int bench_voices(void);
+int bench_worklet(void);
+
+#endif  // TAU_FFI_BENCH_H_
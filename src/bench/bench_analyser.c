@@ -0,0 +1,253 @@
+// The cost of analysers polled at 60 Hz, per analyser and per video frame,
+// for FFT sizes from 2048 to 32768.
+//
+// A sine goes through 32 analysers into the destination. Every video frame
+// renders 800 frames at 48 kHz, then asks every analyser for its spectrum,
+// or for its last frames. The render time is reported against the same
+// graph with gains in place of the analysers, and the time to ask again
+// without rendering, which computes nothing.
+//
+// The benchmark fails if the decibel kernel strays by more than 0.001 dB
+// from `log10`, if the spectrum of a sine centred on a bin does not peak on
+// that bin at the level of the Blackman window, or if the last frames read
+// while a device renders the graph on its own thread are not a stretch of
+// the sine.
+#include <math.h>
+#include <string.h>
+
+#include "bench.h"
+#include "tau_kernels.h"
+
+#define SAMPLE_RATE 48000
+#define ANALYSERS 32
+#define FRAME_FRAMES 800
+#define BIN 64
+
+typedef struct graph {
+  tau_context* context;
+  int32_t nodes[ANALYSERS];
+  float* output;
+} graph;
+
+static void graph_destroy(graph* self) {
+  tau_context_destroy(self->context);
+  free(self->output);
+}
+
+// A sine at the centre of bin `BIN` of `fft_size`, through `ANALYSERS`
+// analysers, or gains if `fft_size` is 0, into the destination.
+static int graph_create(graph* self, int32_t fft_size) {
+  memset(self, 0, sizeof(*self));
+  self->context = tau_context_create(1, SAMPLE_RATE);
+  self->output = (float*)malloc(FRAME_FRAMES * sizeof(float));
+  if (self->context == NULL || self->output == NULL) {
+    return 0;
+  }
+  float frequency =
+      (float)BIN * SAMPLE_RATE / (fft_size > 0 ? fft_size : 2048);
+  int32_t oscillator = tau_oscillator_create(
+      self->context, TAU_OSCILLATOR_SINE, frequency);
+  if (oscillator < 0 || tau_node_start(self->context, oscillator, 0) != 0) {
+    return 0;
+  }
+  for (int32_t i = 0; i < ANALYSERS; i++) {
+    int32_t node = fft_size > 0 ? tau_analyser_create(self->context, fft_size)
+                                : tau_gain_create(self->context, 1.0f);
+    self->nodes[i] = node;
+    if (node < 0 || tau_node_connect(self->context, oscillator, node) != 0 ||
+        tau_node_connect(self->context, node,
+                         tau_context_destination(self->context)) != 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// The largest difference between the decibel kernel and `log10`, over
+// values from 1e-30 to 1e6.
+static double decibel_error(void) {
+  float values[1024];
+  float decibels[1024];
+  for (int32_t i = 0; i < 1024; i++) {
+    values[i] = (float)pow(10.0, -30.0 + 36.0 * i / 1023.0);
+  }
+  tau_kernel_decibels(decibels, values, 1024);
+  double error = 0.0;
+  for (int32_t i = 0; i < 1024; i++) {
+    double difference = fabs(decibels[i] - 20.0 * log10(values[i]));
+    error = difference > error ? difference : error;
+  }
+  return error;
+}
+
+// Whether the spectrum of the first analyser peaks on bin `BIN`, at the
+// level of a sine of amplitude 1 through a Blackman window.
+static int check_spectrum(graph* self, int32_t fft_size) {
+  tau_context* context = self->context;
+  if (tau_analyser_set_smoothing(context, self->nodes[0], 0.0f) != 0 ||
+      tau_analyser_get_float_frequency_data(context, self->nodes[0]) != 0) {
+    return 0;
+  }
+  tau_audio_buffer* spectrum =
+      tau_analyser_frequency_buffer(context, self->nodes[0]);
+  if (spectrum == NULL || spectrum->frames != fft_size / 2) {
+    tau_audio_buffer_release(spectrum);
+    return 0;
+  }
+  int32_t peak = 0;
+  for (int32_t i = 1; i < spectrum->frames; i++) {
+    peak = spectrum->data[i] > spectrum->data[peak] ? i : peak;
+  }
+  double expected = 20.0 * log10(0.42 * 0.5);
+  int passed = peak == BIN && fabs(spectrum->data[peak] - expected) < 0.1;
+  if (!passed) {
+    printf("peak of %.2f dB at bin %d, expected %.2f dB at bin %d\n",
+           spectrum->data[peak], peak, expected, BIN);
+  }
+  tau_audio_buffer_release(spectrum);
+  tau_analyser_set_smoothing(context, self->nodes[0], 0.8f);
+  return passed;
+}
+
+typedef enum poll_kind {
+  POLL_NONE,
+  POLL_FREQUENCY,
+  POLL_TIME_DOMAIN,
+} poll_kind;
+
+// Renders a video frame, then polls every analyser. Adds the render time
+// and the poll time to `times`, and the time to poll again to `times[2]`.
+static int run_frame(graph* self, poll_kind kind, double times[3]) {
+  double start = bench_now();
+  if (tau_context_render(self->context, self->output, FRAME_FRAMES) !=
+      FRAME_FRAMES) {
+    return 0;
+  }
+  double rendered = bench_now();
+  times[0] += rendered - start;
+  if (kind == POLL_NONE) {
+    return 1;
+  }
+  for (int32_t again = 0; again < 2; again++) {
+    double polled = bench_now();
+    for (int32_t i = 0; i < ANALYSERS; i++) {
+      int32_t status =
+          kind == POLL_FREQUENCY
+              ? tau_analyser_get_float_frequency_data(self->context,
+                                                      self->nodes[i])
+              : tau_analyser_get_float_time_domain_data(self->context,
+                                                        self->nodes[i]);
+      if (status != 0) {
+        return 0;
+      }
+    }
+    times[1 + again] += bench_now() - polled;
+  }
+  return 1;
+}
+
+// Runs video frames for `BENCH_MIN_SECONDS`, and turns `times` into
+// microseconds per analyser and video frame.
+static int measure(graph* self, poll_kind kind, double times[3]) {
+  int64_t frames = 0;
+  double start = bench_now();
+  times[0] = times[1] = times[2] = 0.0;
+  do {
+    if (!run_frame(self, kind, times)) {
+      return 0;
+    }
+    frames++;
+  } while (bench_now() - start < BENCH_MIN_SECONDS);
+  for (int i = 0; i < 3; i++) {
+    times[i] *= 1e6 / ((double)frames * ANALYSERS);
+  }
+  return 1;
+}
+
+// Polls the time domain data of an analyser of `fft_size` while a null
+// device renders its graph on another thread, for half a second. Returns
+// whether every snapshot was a stretch of the sine, without a tear where
+// the rendering thread overwrote frames during the copy.
+static int check_concurrent(int32_t fft_size) {
+  graph self;
+  tau_device* device = NULL;
+  tau_audio_buffer* frames = NULL;
+  int passed = graph_create(&self, fft_size);
+  if (passed) {
+    device = tau_device_open(self.context, "null", NULL,
+                             TAU_RENDER_QUANTUM_FRAMES);
+    frames = tau_analyser_time_domain_buffer(self.context, self.nodes[0]);
+    passed = device != NULL && frames != NULL &&
+             tau_device_start(device) == TAU_OK;
+  }
+  // The largest step between two samples of the sine, and some rounding.
+  double step = 2.0 * 3.14159265358979 * BIN / fft_size * 1.01 + 1e-4;
+  int64_t polls = 0;
+  double start = bench_now();
+  while (passed && bench_now() - start < 0.5) {
+    passed = tau_analyser_get_float_time_domain_data(self.context,
+                                                     self.nodes[0]) == 0;
+    for (int32_t i = 1; passed && i < fft_size; i++) {
+      passed = fabs(frames->data[i] - frames->data[i - 1]) <= step;
+    }
+    polls++;
+  }
+  tau_device_close(device);
+  tau_audio_buffer_release(frames);
+  graph_destroy(&self);
+  printf("%d polls while rendering on a device: %s\n", (int)polls,
+         passed ? "ok" : "FAILED");
+  return passed;
+}
+
+int bench_analyser(void) {
+  int status = 0;
+  double error = decibel_error();
+  printf("decibel kernel (%s): %.2g dB from log10%s\n", tau_kernels()->name,
+         error, error <= 1e-3 ? "" : " FAILED");
+  status |= !(error <= 1e-3);
+  graph gains;
+  double baseline[3];
+  if (!graph_create(&gains, 0) || !measure(&gains, POLL_NONE, baseline)) {
+    printf("FAILED: cannot render the graph of gains\n");
+    graph_destroy(&gains);
+    return 1;
+  }
+  graph_destroy(&gains);
+  printf("%d analysers, a frame of %d samples at %d Hz per video frame; "
+         "us per analyser and video frame\n",
+         ANALYSERS, FRAME_FRAMES, SAMPLE_RATE);
+  printf("%-8s %-11s %10s %12s %10s %10s %7s\n", "fft", "data", "render",
+         "vs gain", "poll", "again", "check");
+  for (int32_t fft_size = 2048; fft_size <= TAU_ANALYSER_MAX_FFT_SIZE;
+       fft_size *= 2) {
+    graph analysers;
+    int created = graph_create(&analysers, fft_size);
+    // Fills the ring before checking.
+    double times[3] = {0.0, 0.0, 0.0};
+    for (int32_t i = 0; created && i * FRAME_FRAMES < fft_size; i++) {
+      created = run_frame(&analysers, POLL_NONE, times);
+    }
+    int passed = created && check_spectrum(&analysers, fft_size);
+    for (int p = POLL_FREQUENCY; created && p <= POLL_TIME_DOMAIN; p++) {
+      if (!measure(&analysers, (poll_kind)p, times)) {
+        passed = 0;
+        break;
+      }
+      printf("%-8d %-11s %10.2f %12.2f %10.2f %10.3f %7s\n", fft_size,
+             p == POLL_FREQUENCY ? "frequency" : "time domain", times[0],
+             times[0] - baseline[0], times[1], times[2],
+             passed ? "ok" : "FAILED");
+      bench_metric(times[1], "us", 0, "%d.%s", fft_size,
+                   p == POLL_FREQUENCY ? "frequency" : "time_domain");
+    }
+    if (!created) {
+      printf("%-8d FAILED: cannot create the graph\n", fft_size);
+    }
+    status |= !passed;
+    graph_destroy(&analysers);
+  }
+  status |= !check_concurrent(2048);
+  bench_sink += (int64_t)error;
+  return status;
+}
@@ -0,0 +1,314 @@
+// Cost of evaluating automated parameters, in nanoseconds per parameter per
+// quantum, for 10000 parameters following each kind of automation over two
+// seconds, against evaluating the same timelines one sample at a time.
+//
+// The parameters are the gains of unconnected gain nodes, evaluated with
+// `tau_param_render` as a node does. The per-sample evaluation walks the
+// events with a branch and a `pow` or `exp` per sample, in double precision:
+// it is also the reference the block evaluation is checked against, on a few
+// parameters, before timing. The benchmark fails if they differ by more than
+// 1e-4 of the value. Event times are staggered across parameters, so events
+// fall at every offset within a quantum.
+#include <math.h>
+#include <string.h>
+
+#include "bench.h"
+#include "tau_engine.h"
+
+#define SAMPLE_RATE 48000.0
+#define PARAMS 10000
+#define REFERENCE_PARAMS 100
+#define CHECKED_PARAMS 8
+#define SECONDS 2
+#define QUANTA ((int32_t)(SECONDS * SAMPLE_RATE) / TAU_QUANTUM)
+#define MAX_EVENTS 48
+#define CURVE_LENGTH 16
+
+enum scenario {
+  SCENARIO_CONSTANT,
+  SCENARIO_STEPS,
+  SCENARIO_LINEAR,
+  SCENARIO_EXPONENTIAL,
+  SCENARIO_TARGET,
+  SCENARIO_CURVE,
+  SCENARIO_COUNT,
+};
+
+static const char* const scenario_names[SCENARIO_COUNT] = {
+    "constant", "steps", "linear", "exponential", "target", "curve"};
+
+static float curve[CURVE_LENGTH];
+
+// The events of parameter `index` in `scenario`. Returns their count.
+static int32_t make_events(int scenario, int32_t index,
+                           tau_automation_event* events) {
+  double offset = (index % 97) * 0.0013;
+  int32_t count = 0;
+  memset(events, 0, MAX_EVENTS * sizeof(tau_automation_event));
+  for (int32_t k = 0; scenario != SCENARIO_CONSTANT; k++) {
+    tau_automation_event* event = &events[count];
+    double time;
+    switch (scenario) {
+      case SCENARIO_STEPS:
+        time = k * 0.05 + offset;
+        event->type = TAU_EVENT_SET_VALUE;
+        event->value = (float)(k % 5) * 0.2f;
+        break;
+      case SCENARIO_LINEAR:
+      case SCENARIO_EXPONENTIAL:
+        time = k * 0.25 + offset;
+        event->type = k == 0 ? TAU_EVENT_SET_VALUE
+                      : scenario == SCENARIO_LINEAR
+                          ? TAU_EVENT_LINEAR_RAMP
+                          : TAU_EVENT_EXPONENTIAL_RAMP;
+        event->value = k % 2 == 0 ? 0.01f : 1.0f;
+        break;
+      case SCENARIO_TARGET:
+        time = k * 0.25 + offset;
+        event->type = TAU_EVENT_SET_TARGET;
+        event->value = k % 2 == 0 ? 0.0f : 1.0f;
+        event->length = 0.05 * SAMPLE_RATE;
+        break;
+      default:
+        time = k * 0.5 + offset;
+        event->type = TAU_EVENT_SET_VALUE_CURVE;
+        event->value = curve[CURVE_LENGTH - 1];
+        event->length = 0.4 * SAMPLE_RATE;
+        event->curve = curve;
+        event->curve_length = CURVE_LENGTH;
+        break;
+    }
+    if (time >= SECONDS || count == MAX_EVENTS) {
+      break;
+    }
+    event->frame = time * SAMPLE_RATE;
+    count++;
+  }
+  return count;
+}
+
+static int32_t post(tau_context* context, int32_t node,
+                    const tau_automation_event* event) {
+  double time = event->frame / SAMPLE_RATE;
+  switch (event->type) {
+    case TAU_EVENT_SET_VALUE:
+      return tau_param_set_value_at_time(context, node, TAU_PARAM_GAIN,
+                                         event->value, time);
+    case TAU_EVENT_LINEAR_RAMP:
+      return tau_param_linear_ramp_to_value_at_time(
+          context, node, TAU_PARAM_GAIN, event->value, time);
+    case TAU_EVENT_EXPONENTIAL_RAMP:
+      return tau_param_exponential_ramp_to_value_at_time(
+          context, node, TAU_PARAM_GAIN, event->value, time);
+    case TAU_EVENT_SET_TARGET:
+      return tau_param_set_target_at_time(context, node, TAU_PARAM_GAIN,
+                                          event->value, time,
+                                          event->length / SAMPLE_RATE);
+    default:
+      return tau_param_set_value_curve_at_time(
+          context, node, TAU_PARAM_GAIN, event->curve, event->curve_length,
+          time, event->length / SAMPLE_RATE);
+  }
+}
+
+// --- Per-sample reference ---
+
+typedef struct reference {
+  const tau_automation_event* events;
+  int32_t count;
+  int32_t next;
+  tau_automation_event current;
+  double current_value;
+} reference;
+
+static void reference_init(reference* reference,
+                           const tau_automation_event* events, int32_t count,
+                           float initial) {
+  memset(reference, 0, sizeof(*reference));
+  reference->events = events;
+  reference->count = count;
+  reference->current.type = TAU_EVENT_SET_VALUE;
+  reference->current.value = initial;
+}
+
+static double reference_segment(const reference* reference, double frame) {
+  const tau_automation_event* current = &reference->current;
+  if (current->type == TAU_EVENT_SET_TARGET) {
+    return current->value + (reference->current_value - current->value) *
+                                exp(-(frame - current->frame) /
+                                    current->length);
+  }
+  if (current->type == TAU_EVENT_SET_VALUE_CURVE) {
+    double position = (frame - current->frame) / current->length *
+                      (current->curve_length - 1);
+    if (position >= current->curve_length - 1) {
+      return current->value;
+    }
+    int32_t index = (int32_t)position;
+    return current->curve[index] +
+           (current->curve[index + 1] - current->curve[index]) *
+               (position - index);
+  }
+  return current->value;
+}
+
+// The value at `frame`, evaluated from the Web Audio formulas. Frames must
+// not decrease from one call to the next.
+static double reference_sample(reference* reference, double frame) {
+  while (reference->next < reference->count &&
+         reference->events[reference->next].frame <= frame) {
+    const tau_automation_event* event = &reference->events[reference->next++];
+    reference->current_value = event->type == TAU_EVENT_SET_TARGET
+                                   ? reference_segment(reference, event->frame)
+                                   : event->value;
+    reference->current = *event;
+  }
+  if (reference->next == reference->count) {
+    return reference_segment(reference, frame);
+  }
+  const tau_automation_event* next = &reference->events[reference->next];
+  const tau_automation_event* current = &reference->current;
+  if (next->type == TAU_EVENT_LINEAR_RAMP) {
+    return current->value + (next->value - current->value) *
+                                (frame - current->frame) /
+                                (next->frame - current->frame);
+  }
+  if (next->type == TAU_EVENT_EXPONENTIAL_RAMP) {
+    return current->value *
+           pow(next->value / current->value,
+               (frame - current->frame) / (next->frame - current->frame));
+  }
+  return reference_segment(reference, frame);
+}
+
+// --- Benchmark ---
+
+typedef struct result {
+  double block_ns;
+  double sample_ns;
+  double post_ns;
+  double insert_ns;
+  double error;
+} result;
+
+static int run(int scenario, result* result) {
+  tau_context* context = tau_context_create(1, (float)SAMPLE_RATE);
+  tau_param** params = (tau_param**)malloc(PARAMS * sizeof(tau_param*));
+  tau_automation_event* events = (tau_automation_event*)malloc(
+      (size_t)PARAMS * MAX_EVENTS * sizeof(tau_automation_event));
+  int32_t* counts = (int32_t*)malloc(PARAMS * sizeof(int32_t));
+  int status = context == NULL || params == NULL || events == NULL ||
+               counts == NULL;
+  int64_t event_count = 0;
+  double post_seconds = 0.0;
+  for (int32_t p = 0; status == 0 && p < PARAMS; p++) {
+    int32_t node = tau_gain_create(context, 1.0f);
+    if (node < 0) {
+      status = 1;
+      break;
+    }
+    params[p] = &tau_context_node(context, node)->params[0];
+    tau_automation_event* own = events + (size_t)p * MAX_EVENTS;
+    counts[p] = make_events(scenario, p, own);
+    double start = bench_now();
+    for (int32_t e = 0; e < counts[p]; e++) {
+      status |= post(context, node, &own[e]) != TAU_OK;
+    }
+    post_seconds += bench_now() - start;
+    event_count += counts[p];
+  }
+  if (status != 0) {
+    free(params);
+    free(events);
+    free(counts);
+    tau_context_destroy(context);
+    return 1;
+  }
+  // Drains the events, then renders every parameter over every quantum. The
+  // first ones are checked against the reference, outside of the timing.
+  reference references[CHECKED_PARAMS];
+  for (int32_t p = 0; p < CHECKED_PARAMS; p++) {
+    reference_init(&references[p], events + (size_t)p * MAX_EVENTS,
+                   counts[p], 1.0f);
+  }
+  double start = bench_now();
+  tau_command_drain(context);
+  double insert_seconds = bench_now() - start;
+  double block_seconds = 0.0;
+  double error = 0.0;
+  for (int32_t q = 0; q < QUANTA; q++) {
+    context->frame = (int64_t)q * TAU_QUANTUM;
+    tau_arena_reset();
+    start = bench_now();
+    for (int32_t p = CHECKED_PARAMS; p < PARAMS; p++) {
+      const float* values = tau_param_render(context, params[p]);
+      bench_sink += values != NULL ? (int64_t)values[TAU_QUANTUM - 1] : 0;
+    }
+    block_seconds += bench_now() - start;
+    for (int32_t p = 0; p < CHECKED_PARAMS; p++) {
+      const float* values = tau_param_render(context, params[p]);
+      for (int32_t i = 0; i < TAU_QUANTUM; i++) {
+        double expected =
+            reference_sample(&references[p], (double)context->frame + i);
+        double actual = values != NULL ? values[i] : params[p]->value;
+        double difference = fabs(actual - expected) / (1.0 + fabs(expected));
+        error = difference > error ? difference : error;
+      }
+    }
+  }
+  // The per-sample evaluation of a subset, timed on its own.
+  start = bench_now();
+  double sum = 0.0;
+  for (int32_t p = 0; p < REFERENCE_PARAMS; p++) {
+    reference timeline;
+    reference_init(&timeline, events + (size_t)p * MAX_EVENTS, counts[p],
+                   1.0f);
+    for (int64_t frame = 0; frame < (int64_t)QUANTA * TAU_QUANTUM; frame++) {
+      sum += reference_sample(&timeline, (double)frame);
+    }
+  }
+  double sample_seconds = bench_now() - start;
+  bench_sink += (int64_t)sum;
+  result->block_ns =
+      block_seconds * 1e9 / ((double)(PARAMS - CHECKED_PARAMS) * QUANTA);
+  result->sample_ns =
+      sample_seconds * 1e9 / ((double)REFERENCE_PARAMS * QUANTA);
+  result->post_ns = event_count > 0 ? post_seconds * 1e9 / event_count : 0;
+  result->insert_ns =
+      event_count > 0 ? insert_seconds * 1e9 / event_count : 0;
+  result->error = error;
+  free(params);
+  free(events);
+  free(counts);
+  tau_context_destroy(context);
+  return 0;
+}
+
+int bench_automation(void) {
+  for (int32_t i = 0; i < CURVE_LENGTH; i++) {
+    curve[i] = (float)(0.5 + 0.5 * sin(i * 0.7));
+  }
+  printf("%d parameters over %d quanta, ns per parameter per quantum\n",
+         PARAMS, QUANTA);
+  printf("%-12s %9s %11s %8s %8s %10s %10s %7s\n", "automation", "block",
+         "per-sample", "speedup", "post", "insert", "error", "check");
+  int status = 0;
+  for (int scenario = 0; scenario < SCENARIO_COUNT; scenario++) {
+    result result;
+    if (run(scenario, &result) != 0) {
+      printf("%-12s FAILED: cannot schedule the events\n",
+             scenario_names[scenario]);
+      status = 1;
+      continue;
+    }
+    int passed = result.error <= 1e-4;
+    status |= !passed;
+    printf("%-12s %9.1f %11.1f %7.1fx %8.0f %10.0f %10.2g %7s\n",
+           scenario_names[scenario], result.block_ns, result.sample_ns,
+           result.sample_ns / result.block_ns, result.post_ns,
+           result.insert_ns, result.error, passed ? "ok" : "FAILED");
+    bench_metric(result.block_ns, "ns", 0, "%s", scenario_names[scenario]);
+  }
+  printf("(post and insert: ns per event, scheduling and draining)\n");
+  return status;
+}
@@ -0,0 +1,68 @@
+// The dispatch overhead of `tau_batch_execute`, against one direct C call per
+// operation.
+//
+// Both sides are plain C calls, so this measures neither the Dart to native
+// transition nor what batching saves on it: a batch only loses to C calls
+// here, by the cost of filling it and switching on its opcodes.
+// `benchmark/batch.dart` compares batches with calls from Dart.
+#include "bench.h"
+
+#define MAX_BATCH_SIZE 65536
+
+static double measure_scalar(int32_t batch_size) {
+  int64_t calls = 0;
+  int64_t accumulator = 0;
+  double start = bench_now();
+  double elapsed;
+  do {
+    for (int32_t i = 0; i < batch_size; i++) {
+      accumulator += sum(i, (int)calls);
+    }
+    calls += batch_size;
+    elapsed = bench_now() - start;
+  } while (elapsed < BENCH_MIN_SECONDS);
+  bench_sink = accumulator;
+  return (double)calls / elapsed;
+}
+
+static double measure_batched(tau_batch* batch, int32_t batch_size) {
+  int64_t calls = 0;
+  int64_t accumulator = 0;
+  double start = bench_now();
+  double elapsed;
+  do {
+    // Filling the buffer is part of the cost a caller pays per batch.
+    for (int32_t i = 0; i < batch_size; i++) {
+      batch->opcodes[i] = TAU_OP_SUM;
+      batch->a[i] = i;
+      batch->b[i] = (int32_t)calls;
+    }
+    batch->count = batch_size;
+    calls += tau_batch_execute(batch);
+    accumulator += batch->results[batch_size - 1];
+    elapsed = bench_now() - start;
+  } while (elapsed < BENCH_MIN_SECONDS);
+  bench_sink = accumulator;
+  return (double)calls / elapsed;
+}
+
+int bench_batch(void) {
+  tau_batch* batch = tau_batch_create(MAX_BATCH_SIZE);
+  if (batch == NULL) {
+    fprintf(stderr, "tau_batch_create failed\n");
+    return 1;
+  }
+  printf("C to C only: no Dart to native transition is measured\n");
+  printf("%10s %16s %16s %8s\n", "batch", "direct ops/s", "batched ops/s",
+         "ratio");
+  for (int32_t batch_size = 1; batch_size <= MAX_BATCH_SIZE; batch_size *= 4) {
+    double scalar = measure_scalar(batch_size);
+    double batched = measure_batched(batch, batch_size);
+    printf("%10d %16.3e %16.3e %7.1fx\n", batch_size, scalar, batched,
+           batched / scalar);
+    bench_metric(scalar, "calls/s", 1, "scalar.%d", batch_size);
+    bench_metric(batched, "calls/s", 1, "batched.%d", batch_size);
+  }
+  tau_batch_destroy(batch);
+  return 0;
+}
@@ -0,0 +1,455 @@
+// Throughput of equalizers of 1 to 31 biquad bands on 1 to 32 channels, in
+// millions of filter samples per second: a sample through a band of a
+// channel.
+//
+// The per-filter loop filters every band of every channel on its own, one
+// sample after the other, as a filter node per band would. The bank lays
+// the bands out as the biquad filter node does, as the lanes of the biquad
+// kernel, and is timed on every instruction set the processor supports.
+//
+// The benchmark fails if a version of the kernel strays from the per-filter
+// loop, if a filter of several bands does not sound as its bands as filters
+// of one band in series, if a peaking band of +12 dB does not give a sine
+// at its frequency 12 dB more, if a lowpass does not cut a sine three
+// octaves above it by more than 30 dB, or if a filter whose frequency ramps
+// does not end up as a filter at the end of the ramp.
+#include <math.h>
+#include <string.h>
+
+#include "bench.h"
+#include "tau_kernels.h"
+
+#define SAMPLE_RATE 48000
+#define QUANTUM TAU_RENDER_QUANTUM_FRAMES
+#define MAX_CHANNELS 32
+#define MAX_BANDS 31
+// The lanes of a run of the kernel, as the node has them.
+#define PASS_LANES 32
+#define TOLERANCE 1e-5f
+
+// The bands of every channel, and their states.
+typedef struct bank {
+  int32_t channels;
+  int32_t bands;
+  int32_t pass_channels;
+  float coefficients[5][PASS_LANES];
+  int32_t delays[PASS_LANES];
+  int32_t links[PASS_LANES];
+  float s1[MAX_CHANNELS * MAX_BANDS];
+  float s2[MAX_CHANNELS * MAX_BANDS];
+  // The rows of a run, after a row and a float of padding.
+  float rows[(QUANTUM + MAX_BANDS + 1) * PASS_LANES + 1];
+} bank;
+
+// A band of a graphic equalizer: a peaking section a third of an octave
+// above the one before, from 20 Hz, of alternately +6 and -6 dB.
+static void band_coefficients(int32_t band, float* k) {
+  double w0 = 2.0 * 3.14159265358979 * 20.0 * pow(2.0, band / 3.0) /
+              SAMPLE_RATE;
+  double a = pow(10.0, (band % 2 == 0 ? 6.0 : -6.0) / 40.0);
+  double alpha = sin(w0) / (2.0 * 4.3);
+  double a0 = 1.0 + alpha / a;
+  k[0] = (float)((1.0 + alpha * a) / a0);
+  k[1] = (float)(-2.0 * cos(w0) / a0);
+  k[2] = (float)((1.0 - alpha * a) / a0);
+  k[3] = k[1];
+  k[4] = (float)((1.0 - alpha / a) / a0);
+}
+
+static void bank_init(bank* self, int32_t channels, int32_t bands) {
+  memset(self, 0, sizeof(*self));
+  self->channels = channels;
+  self->bands = bands;
+  self->pass_channels = PASS_LANES / bands;
+  for (int32_t b = 0; b < bands; b++) {
+    float k[5];
+    band_coefficients(b, k);
+    for (int32_t c = 0; c < self->pass_channels; c++) {
+      for (int32_t i = 0; i < 5; i++) {
+        self->coefficients[i][c * bands + b] = k[i];
+      }
+      self->delays[c * bands + b] = b;
+      self->links[c * bands + b] = b > 0;
+    }
+  }
+}
+
+// Filters a quantum of every channel of `input` into `output`, both planar,
+// every band on its own.
+static void run_filters(bank* self, const float* input, float* output) {
+  int32_t bands = self->bands;
+  memcpy(output, input, (size_t)self->channels * QUANTUM * sizeof(float));
+  for (int32_t c = 0; c < self->channels; c++) {
+    for (int32_t b = 0; b < bands; b++) {
+      float b0 = self->coefficients[0][b];
+      float b1 = self->coefficients[1][b];
+      float b2 = self->coefficients[2][b];
+      float a1 = self->coefficients[3][b];
+      float a2 = self->coefficients[4][b];
+      float s1 = self->s1[c * bands + b];
+      float s2 = self->s2[c * bands + b];
+      float* samples = output + c * QUANTUM;
+      for (int32_t i = 0; i < QUANTUM; i++) {
+        float x = samples[i];
+        float y = b0 * x + s1;
+        s1 = b1 * x - a1 * y + s2;
+        s2 = b2 * x - a2 * y;
+        samples[i] = y;
+      }
+      self->s1[c * bands + b] = s1;
+      self->s2[c * bands + b] = s2;
+    }
+  }
+}
+
+// `run_filters` with the kernel of `kernels`, as the node runs it.
+static void run_bank(bank* self, const tau_kernel_table* kernels,
+                     const float* input, float* output) {
+  int32_t bands = self->bands;
+  int32_t rows = QUANTUM + bands - 1;
+  for (int32_t first = 0; first < self->channels;
+       first += self->pass_channels) {
+    int32_t count = self->channels - first < self->pass_channels
+                        ? self->channels - first
+                        : self->pass_channels;
+    int32_t lanes = count * bands;
+    float* signal = self->rows + lanes + 1;
+    tau_biquad_lanes lanes_of_run = {
+        lanes,
+        self->coefficients[0],
+        self->coefficients[1],
+        self->coefficients[2],
+        self->coefficients[3],
+        self->coefficients[4],
+        self->s1 + first * bands,
+        self->s2 + first * bands,
+        self->delays,
+        self->links,
+    };
+    memset(self->rows, 0, (size_t)(lanes + 1) * sizeof(float));
+    memset(signal + QUANTUM * lanes, 0,
+           (size_t)(rows - QUANTUM) * lanes * sizeof(float));
+    for (int32_t c = 0; c < count; c++) {
+      const float* in = input + (first + c) * QUANTUM;
+      for (int32_t t = 0; t < QUANTUM; t++) {
+        signal[t * lanes + c * bands] = in[t];
+      }
+    }
+    kernels->biquad(&lanes_of_run, signal, QUANTUM, rows);
+    for (int32_t c = 0; c < count; c++) {
+      float* out = output + (first + c) * QUANTUM;
+      const float* lane =
+          signal + (bands - 1) * lanes + c * bands + bands - 1;
+      for (int32_t t = 0; t < QUANTUM; t++) {
+        out[t] = lane[t * lanes];
+      }
+    }
+  }
+}
+
+// Deterministic white noise in [-1, 1).
+static void fill_noise(float* samples, int32_t count, uint32_t seed) {
+  uint32_t state = seed * 2654435761u + 1u;
+  for (int32_t i = 0; i < count; i++) {
+    state = state * 1664525u + 1013904223u;
+    samples[i] = (float)(state >> 8) / 8388608.0f - 1.0f;
+  }
+}
+
+// The largest difference between `a` and `b`, relative to the larger of 1
+// and the magnitude of `b`.
+static float difference(const float* a, const float* b, int32_t count) {
+  float largest = 0.0f;
+  for (int32_t i = 0; i < count; i++) {
+    float scale = fabsf(b[i]) > 1.0f ? fabsf(b[i]) : 1.0f;
+    float d = fabsf(a[i] - b[i]) / scale;
+    largest = d > largest || d != d ? d : largest;
+  }
+  return largest;
+}
+
+static const int32_t check_configs[][2] = {
+    {1, 1}, {3, 5}, {2, 10}, {1, 31}, {5, 6}, {32, 1}, {9, 3}, {4, 31},
+};
+
+// Whether the kernel of `kernels` gives the output of the per-filter loop
+// over several quanta, on channels and bands that leave lanes over. Returns
+// 0 if exactly, 1 if within `TOLERANCE`, and -1 if not.
+static int check_kernel(const tau_kernel_table* kernels, bank* filters,
+                        bank* lanes, float* input, float* expected,
+                        float* actual) {
+  int exact = 1;
+  int32_t configs = (int32_t)(sizeof(check_configs) / sizeof(*check_configs));
+  for (int32_t i = 0; i < configs; i++) {
+    int32_t channels = check_configs[i][0];
+    int32_t bands = check_configs[i][1];
+    bank_init(filters, channels, bands);
+    bank_init(lanes, channels, bands);
+    for (int32_t quantum = 0; quantum < 4; quantum++) {
+      fill_noise(input, channels * QUANTUM, (uint32_t)(i * 4 + quantum));
+      run_filters(filters, input, expected);
+      run_bank(lanes, kernels, input, actual);
+      float d = difference(actual, expected, channels * QUANTUM);
+      if (!(d <= TOLERANCE)) {
+        printf("%s: %d channels of %d bands stray by %g\n", kernels->name,
+               channels, bands, d);
+        return -1;
+      }
+      exact &= d == 0.0f;
+    }
+  }
+  return exact ? 0 : 1;
+}
+
+// Millions of filter samples per second through `self`, with the kernels of
+// `kernels`, or the per-filter loop if NULL.
+static double measure(bank* self, const tau_kernel_table* kernels,
+                      const float* input, float* output) {
+  int64_t quanta = 0;
+  int64_t batch = 1;
+  double start = bench_now();
+  double elapsed;
+  do {
+    for (int64_t i = 0; i < batch; i++) {
+      if (kernels == NULL) {
+        run_filters(self, input, output);
+      } else {
+        run_bank(self, kernels, input, output);
+      }
+    }
+    quanta += batch;
+    batch *= 2;
+    elapsed = bench_now() - start;
+  } while (elapsed < BENCH_MIN_SECONDS);
+  bench_sink += (int64_t)(output[0] * 1000.0f);
+  return (double)quanta * QUANTUM * self->channels * self->bands /
+         elapsed / 1e6;
+}
+
+// Renders `frames` frames of `context`, of `channels` channels, into a new
+// planar buffer, or returns NULL.
+static float* render(tau_context* context, int32_t channels, int32_t frames) {
+  float* output = (float*)malloc((size_t)channels * frames * sizeof(float));
+  if (output != NULL &&
+      tau_context_render(context, output, frames) != frames) {
+    free(output);
+    return NULL;
+  }
+  return output;
+}
+
+// Sets the type and parameters of band `band` of `node` to those of band
+// `index` of the filters of `check_chain`.
+static int set_band(tau_context* context, int32_t node, int32_t band,
+                    int32_t index) {
+  static const int32_t types[] = {
+      TAU_BIQUAD_HIGHPASS, TAU_BIQUAD_LOWSHELF, TAU_BIQUAD_PEAKING,
+      TAU_BIQUAD_NOTCH,    TAU_BIQUAD_HIGHSHELF, TAU_BIQUAD_LOWPASS,
+  };
+  int32_t offset = band * TAU_BIQUAD_BAND_STRIDE;
+  return tau_biquad_filter_set_type(context, node, band, types[index]) ==
+             0 &&
+         tau_param_set_value(context, node, TAU_PARAM_FREQUENCY + offset,
+                             60.0f * powf(3.0f, (float)index)) == 0 &&
+         tau_param_set_value(context, node, TAU_PARAM_Q + offset,
+                             0.5f + index) == 0 &&
+         tau_param_set_value(context, node, TAU_PARAM_GAIN + offset,
+                             index % 2 == 0 ? 9.0f : -9.0f) == 0;
+}
+
+// Stereo noise through `bands` filters of one band in series if `chain`,
+// or one filter of `bands` bands.
+static float* render_chain(tau_audio_buffer* noise, int32_t bands,
+                           int chain, int32_t frames) {
+  tau_context* context = tau_context_create(2, SAMPLE_RATE);
+  int32_t source = tau_buffer_source_create(context, noise, 0);
+  int passed = source >= 0 && tau_node_start(context, source, 0) == 0;
+  int32_t previous = source;
+  for (int32_t b = 0; passed && b < (chain ? bands : 1); b++) {
+    int32_t node = tau_biquad_filter_create(context, TAU_BIQUAD_LOWPASS,
+                                            chain ? 1 : bands);
+    passed = node >= 0 && tau_node_connect(context, previous, node) == 0;
+    for (int32_t i = 0; passed && i < (chain ? 1 : bands); i++) {
+      passed = set_band(context, node, i, chain ? b : i);
+    }
+    previous = node;
+  }
+  passed = passed && tau_node_connect(context, previous,
+                                      tau_context_destination(context)) == 0;
+  float* output = passed ? render(context, 2, frames) : NULL;
+  tau_context_destroy(context);
+  return output;
+}
+
+// Whether a filter of 6 bands of every kind sounds as 6 filters of one
+// band in series.
+static int check_chain(void) {
+  enum { FRAMES = 4096, BANDS = 6 };
+  tau_audio_buffer* noise = tau_audio_buffer_create(2, FRAMES, SAMPLE_RATE);
+  if (noise == NULL) {
+    return 0;
+  }
+  fill_noise(noise->data, FRAMES, 1);
+  fill_noise(noise->data + noise->stride, FRAMES, 2);
+  float* expected = render_chain(noise, BANDS, 1, FRAMES);
+  float* actual = render_chain(noise, BANDS, 0, FRAMES);
+  int passed = expected != NULL && actual != NULL &&
+               difference(actual, expected, 2 * FRAMES) <= TOLERANCE;
+  free(expected);
+  free(actual);
+  tau_audio_buffer_release(noise);
+  return passed;
+}
+
+// The peak of the last 2048 of 8192 frames of a sine at `frequency` through
+// a filter of one band of `type`, at 1 kHz, with `gain` decibels. Returns a
+// negative value on failure.
+static float sine_peak(float frequency, int32_t type, float gain) {
+  enum { FRAMES = 8192 };
+  tau_context* context = tau_context_create(1, SAMPLE_RATE);
+  int32_t oscillator =
+      tau_oscillator_create(context, TAU_OSCILLATOR_SINE, frequency);
+  int32_t node = tau_biquad_filter_create(context, type, 1);
+  float* output =
+      oscillator >= 0 && node >= 0 &&
+              tau_param_set_value(context, node, TAU_PARAM_FREQUENCY,
+                                  1000.0f) == 0 &&
+              tau_param_set_value(context, node, TAU_PARAM_GAIN, gain) == 0 &&
+              tau_node_start(context, oscillator, 0) == 0 &&
+              tau_node_connect(context, oscillator, node) == 0 &&
+              tau_node_connect(context, node,
+                               tau_context_destination(context)) == 0
+          ? render(context, 1, FRAMES)
+          : NULL;
+  float peak = -1.0f;
+  for (int32_t i = FRAMES - 2048; output != NULL && i < FRAMES; i++) {
+    peak = fabsf(output[i]) > peak ? fabsf(output[i]) : peak;
+  }
+  free(output);
+  tau_context_destroy(context);
+  return peak;
+}
+
+// Whether a peaking band of +12 dB at 1 kHz multiplies a sine at 1 kHz by
+// 10^(12 / 20), within 1%, and a lowpass at 1 kHz cuts a sine at 8 kHz by
+// more than 30 dB.
+static int check_response(void) {
+  float peaking = sine_peak(1000.0f, TAU_BIQUAD_PEAKING, 12.0f);
+  float lowpass = sine_peak(8000.0f, TAU_BIQUAD_LOWPASS, 0.0f);
+  float expected = powf(10.0f, 12.0f / 20.0f);
+  int passed = fabsf(peaking - expected) <= expected * 0.01f &&
+               lowpass >= 0.0f && lowpass < powf(10.0f, -30.0f / 20.0f);
+  if (!passed) {
+    printf("peaking: %.4f, expected %.4f; lowpass: %.1f dB\n", peaking,
+           expected, 20.0f * log10f(lowpass));
+  }
+  return passed;
+}
+
+// Noise through a lowpass whose frequency ramps from 350 Hz to 2 kHz over
+// 50 ms if `ramp`, or stays at 2 kHz.
+static float* render_ramp(tau_audio_buffer* noise, int ramp,
+                          int32_t frames) {
+  tau_context* context = tau_context_create(1, SAMPLE_RATE);
+  int32_t source = tau_buffer_source_create(context, noise, 0);
+  int32_t node = tau_biquad_filter_create(context, TAU_BIQUAD_LOWPASS, 1);
+  int passed =
+      source >= 0 && node >= 0 && tau_node_start(context, source, 0) == 0 &&
+      tau_node_connect(context, source, node) == 0 &&
+      tau_node_connect(context, node, tau_context_destination(context)) ==
+          0 &&
+      (ramp ? tau_param_set_value_at_time(context, node, TAU_PARAM_FREQUENCY,
+                                          350.0f, 0.0) == 0 &&
+                  tau_param_linear_ramp_to_value_at_time(
+                      context, node, TAU_PARAM_FREQUENCY, 2000.0f, 0.05) == 0
+            : tau_param_set_value(context, node, TAU_PARAM_FREQUENCY,
+                                  2000.0f) == 0);
+  float* output = passed ? render(context, 1, frames) : NULL;
+  tau_context_destroy(context);
+  return output;
+}
+
+// Whether a lowpass whose frequency ramps stays finite, and a quarter of a
+// second after the ramp sounds as a lowpass at the end of the ramp.
+static int check_ramp(void) {
+  enum { FRAMES = SAMPLE_RATE / 2 };
+  tau_audio_buffer* noise = tau_audio_buffer_create(1, FRAMES, SAMPLE_RATE);
+  if (noise == NULL) {
+    return 0;
+  }
+  fill_noise(noise->data, FRAMES, 3);
+  float* ramped = render_ramp(noise, 1, FRAMES);
+  float* steady = render_ramp(noise, 0, FRAMES);
+  int passed = ramped != NULL && steady != NULL;
+  for (int32_t i = 0; passed && i < FRAMES; i++) {
+    passed = isfinite(ramped[i]) && (i < SAMPLE_RATE * 3 / 10 ||
+                                     fabsf(ramped[i] - steady[i]) < 1e-4f);
+  }
+  free(ramped);
+  free(steady);
+  tau_audio_buffer_release(noise);
+  return passed;
+}
+
+int bench_biquad(void) {
+  bank* filters = (bank*)malloc(sizeof(bank));
+  bank* lanes = (bank*)malloc(sizeof(bank));
+  float* input = (float*)malloc(MAX_CHANNELS * QUANTUM * sizeof(float));
+  float* expected = (float*)malloc(MAX_CHANNELS * QUANTUM * sizeof(float));
+  float* actual = (float*)malloc(MAX_CHANNELS * QUANTUM * sizeof(float));
+  int status = filters == NULL || lanes == NULL || input == NULL ||
+               expected == NULL || actual == NULL;
+  const tau_kernel_table* tables[TAU_ISA_COUNT];
+  for (int isa = 0; !status && isa < TAU_ISA_COUNT; isa++) {
+    tables[isa] = tau_kernels_for((tau_kernel_isa)isa);
+    if (tables[isa] != NULL) {
+      int checked =
+          check_kernel(tables[isa], filters, lanes, input, expected, actual);
+      printf("biquad kernel (%s) against the per-filter loop: %s\n",
+             tables[isa]->name,
+             checked == 0 ? "exact" : checked > 0 ? "close" : "FAILED");
+      status |= checked < 0;
+    }
+  }
+  int chain = !status && check_chain();
+  int response = !status && check_response();
+  int ramp = !status && check_ramp();
+  printf("bands against filters in series: %s\n", chain ? "ok" : "FAILED");
+  printf("peaking and lowpass response: %s\n", response ? "ok" : "FAILED");
+  printf("ramped frequency: %s\n", ramp ? "ok" : "FAILED");
+  status |= !chain || !response || !ramp;
+  static const int32_t channel_counts[] = {1, 2, 8, 32};
+  static const int32_t band_counts[] = {1, 10, 31};
+  printf("millions of filter samples per second\n");
+  printf("%-8s %6s %-8s %12s %10s\n", "channels", "bands", "method",
+         "Msamples/s", "vs loop");
+  for (int32_t i = 0; !status && i < 4; i++) {
+    for (int32_t j = 0; j < 3; j++) {
+      int32_t channels = channel_counts[i];
+      int32_t bands = band_counts[j];
+      fill_noise(input, channels * QUANTUM, 4);
+      bank_init(filters, channels, bands);
+      double loop = measure(filters, NULL, input, expected);
+      printf("%-8d %6d %-8s %12.1f %9.2fx\n", channels, bands, "loop", loop,
+             1.0);
+      bench_metric(loop, "Msamples/s", 1, "%dx%d.loop", channels, bands);
+      for (int isa = 0; isa < TAU_ISA_COUNT; isa++) {
+        if (tables[isa] == NULL) {
+          continue;
+        }
+        bank_init(lanes, channels, bands);
+        double rate = measure(lanes, tables[isa], input, actual);
+        printf("%-8d %6d %-8s %12.1f %9.2fx\n", channels, bands,
+               tables[isa]->name, rate, rate / loop);
+        bench_metric(rate, "Msamples/s", 1, "%dx%d.%s", channels, bands,
+                     tables[isa]->name);
+      }
+    }
+  }
+  free(filters);
+  free(lanes);
+  free(input);
+  free(expected);
+  free(actual);
+  return status;
+}
@@ -0,0 +1,83 @@
+// Cost of handing audio blocks between Dart and native code, with and without
+// copies, for 32 channels at 48 kHz.
+//
+// The copy path models a `Float32List` on the Dart heap: each block is copied
+// into native memory, processed, and copied back. The zero-copy path
+// processes a `tau_audio_buffer` that Dart views in place. Processing is a
+// gain on every channel in both cases, and throughput counts the bytes of
+// audio delivered per second of work.
+#include <string.h>
+
+#include "bench.h"
+#include "tau_kernels.h"
+
+#define CHANNELS 32
+#define SAMPLE_RATE 48000
+
+static void process(tau_audio_buffer* buffer, int32_t frames) {
+  for (int32_t c = 0; c < CHANNELS; c++) {
+    float* channel = buffer->data + (size_t)c * buffer->stride;
+    tau_kernel_scale(channel, channel, 0.999f, frames);
+  }
+}
+
+static double measure(tau_audio_buffer* buffer, float* dart_heap,
+                      int32_t frames, int copy) {
+  int64_t blocks = 0;
+  double start = bench_now();
+  double elapsed;
+  do {
+    for (int i = 0; i < 64; i++) {
+      if (copy) {
+        for (int32_t c = 0; c < CHANNELS; c++) {
+          memcpy(buffer->data + (size_t)c * buffer->stride,
+                 dart_heap + (size_t)c * frames, frames * sizeof(float));
+        }
+      }
+      process(buffer, frames);
+      if (copy) {
+        for (int32_t c = 0; c < CHANNELS; c++) {
+          memcpy(dart_heap + (size_t)c * frames,
+                 buffer->data + (size_t)c * buffer->stride,
+                 frames * sizeof(float));
+        }
+      }
+    }
+    blocks += 64;
+    elapsed = bench_now() - start;
+  } while (elapsed < BENCH_MIN_SECONDS);
+  bench_sink += (int64_t)buffer->data[0];
+  return elapsed / (double)blocks;
+}
+
+static void report(int32_t frames, const char* path, double seconds) {
+  double bytes = (double)CHANNELS * frames * sizeof(float);
+  double budget = (double)frames / SAMPLE_RATE;
+  printf("%8d %10s %12.2f %12.0f %11.2f%%\n", frames, path, seconds * 1e6,
+         bytes / seconds / 1e6, seconds / budget * 100);
+}
+
+int bench_buffer(void) {
+  static const int32_t block_frames[] = {128, 1024, 4800, 48000};
+  int status = 0;
+  printf("%8s %10s %12s %12s %12s\n", "frames", "path", "us/block", "MB/s",
+         "of realtime");
+  for (size_t i = 0; i < sizeof(block_frames) / sizeof(block_frames[0]); i++) {
+    int32_t frames = block_frames[i];
+    tau_audio_buffer* buffer =
+        tau_audio_buffer_create(CHANNELS, frames, SAMPLE_RATE);
+    float* dart_heap =
+        (float*)calloc((size_t)CHANNELS * frames, sizeof(float));
+    if (buffer == NULL || dart_heap == NULL) {
+      tau_audio_buffer_release(buffer);
+      free(dart_heap);
+      status = 1;
+      break;
+    }
+    report(frames, "copy", measure(buffer, dart_heap, frames, 1));
+    report(frames, "zero-copy", measure(buffer, dart_heap, frames, 0));
+    tau_audio_buffer_release(buffer);
+    free(dart_heap);
+  }
+  return status;
+}
@@ -0,0 +1,204 @@
+// Load times of a WAV file decoded with `tau_decode_file` and loaded from a
+// `tau_cache`, cold (decoded and written to the cache) and warm (mapped from
+// it), then a check of the LRU eviction order.
+//
+// A mapped load only touches the pages it reads, so the times are reported
+// both for the load alone and for the load followed by a pass over every
+// sample. The benchmark works in a cache directory of its own under the
+// temporary directory and empties it when done.
+#include <string.h>
+
+#include "bench.h"
+
+#define SAMPLE_RATE 48000
+#define CHANNELS 2
+#define SECONDS 60
+#define SHORT_SECONDS 1
+
+static void put_u16(FILE* file, uint32_t value) {
+  fputc((int)(value & 0xFF), file);
+  fputc((int)(value >> 8 & 0xFF), file);
+}
+
+static void put_u32(FILE* file, uint32_t value) {
+  put_u16(file, value & 0xFFFF);
+  put_u16(file, value >> 16);
+}
+
+// Writes `seconds` of 16-bit stereo noise, different for every `seed`.
+static int write_wav(const char* path, int32_t seconds, uint32_t seed) {
+  FILE* file = fopen(path, "wb");
+  if (file == NULL) {
+    return 1;
+  }
+  uint32_t data_bytes = (uint32_t)seconds * SAMPLE_RATE * CHANNELS * 2;
+  fwrite("RIFF", 1, 4, file);
+  put_u32(file, 36 + data_bytes);
+  fwrite("WAVEfmt ", 1, 8, file);
+  put_u32(file, 16);
+  put_u16(file, 1);
+  put_u16(file, CHANNELS);
+  put_u32(file, SAMPLE_RATE);
+  put_u32(file, SAMPLE_RATE * CHANNELS * 2);
+  put_u16(file, CHANNELS * 2);
+  put_u16(file, 16);
+  fwrite("data", 1, 4, file);
+  put_u32(file, data_bytes);
+  int16_t frames[1024 * CHANNELS];
+  for (int64_t written = 0; written < (int64_t)seconds * SAMPLE_RATE;
+       written += 1024) {
+    for (int32_t i = 0; i < 1024 * CHANNELS; i++) {
+      seed = seed * 1664525u + 1013904223u;
+      frames[i] = (int16_t)(seed >> 16);
+    }
+    fwrite(frames, sizeof(frames), 1, file);
+  }
+  return fclose(file) != 0;
+}
+
+static double checksum(const tau_audio_buffer* buffer) {
+  double sum = 0.0;
+  for (int32_t c = 0; c < buffer->channels; c++) {
+    const float* samples = buffer->data + (size_t)c * buffer->stride;
+    for (int32_t i = 0; i < buffer->frames; i++) {
+      sum += samples[i] * (1.0 + c);
+    }
+  }
+  return sum;
+}
+
+typedef struct timing {
+  double load;
+  double read;
+  double sum;
+} timing;
+
+// Loads `path` once with `cache`, or decodes it if `cache` is NULL.
+static int load_once(tau_cache* cache, const char* path, timing* out) {
+  double start = bench_now();
+  tau_audio_buffer* buffer =
+      cache != NULL ? tau_cache_load(cache, path) : tau_decode_file(path);
+  if (buffer == NULL) {
+    return 1;
+  }
+  out->load = bench_now() - start;
+  out->sum = checksum(buffer);
+  out->read = bench_now() - start;
+  tau_audio_buffer_release(buffer);
+  return 0;
+}
+
+// Averages loads of `path` over `BENCH_MIN_SECONDS`.
+static int load_repeated(tau_cache* cache, const char* path, timing* out) {
+  timing total = {0.0, 0.0, 0.0};
+  int32_t runs = 0;
+  double start = bench_now();
+  do {
+    if (load_once(cache, path, out) != 0) {
+      return 1;
+    }
+    total.load += out->load;
+    total.read += out->read;
+    runs++;
+  } while (bench_now() - start < BENCH_MIN_SECONDS);
+  out->load = total.load / runs;
+  out->read = total.read / runs;
+  return 0;
+}
+
+static void print_timing(const char* name, const timing* timing) {
+  printf("%-8s %12.3f %16.3f\n", name, timing->load * 1e3,
+         timing->read * 1e3);
+}
+
+// Loads three short files into a cache holding two, using the first one
+// again before loading the third: the second one must be evicted.
+static int check_eviction(tau_cache* cache, char paths[3][1024]) {
+  tau_audio_buffer* first = tau_cache_load(cache, paths[0]);
+  if (first == NULL) {
+    return 1;
+  }
+  int64_t entry_bytes = first->mapped_bytes;
+  tau_audio_buffer_release(first);
+  tau_cache_set_limit(cache, entry_bytes * 2);
+  tau_cache_stats before;
+  tau_cache_get_stats(cache, &before);
+  const int order[] = {1, 0, 2, 0, 1};
+  for (int i = 0; i < 5; i++) {
+    tau_audio_buffer_release(tau_cache_load(cache, paths[order[i]]));
+  }
+  tau_cache_stats after;
+  tau_cache_get_stats(cache, &after);
+  printf("eviction: %lld hits, %lld misses, %lld evictions (%.1f MB), "
+         "%lld entries (%.1f MB)\n",
+         (long long)(after.hits - before.hits),
+         (long long)(after.misses - before.misses),
+         (long long)(after.evictions - before.evictions),
+         (after.evicted_bytes - before.evicted_bytes) / 1048576.0,
+         (long long)after.entries, after.bytes / 1048576.0);
+  // The first file is loaded from the entry of the first pass; the second
+  // one is evicted by the third one, then decoded again.
+  if (after.hits - before.hits != 2 || after.misses - before.misses != 3 ||
+      after.entries != 2) {
+    printf("FAILED: the least recently used entry was not evicted\n");
+    return 1;
+  }
+  return 0;
+}
+
+int bench_cache(void) {
+#if _WIN32
+  const char* temporary = getenv("TEMP");
+#else
+  const char* temporary = getenv("TMPDIR");
+  temporary = temporary != NULL ? temporary : "/tmp";
+#endif
+  temporary = temporary != NULL ? temporary : ".";
+  char directory[1024];
+  char path[1024];
+  char short_paths[3][1024];
+  snprintf(directory, sizeof(directory), "%s/tau_ffi_bench_cache", temporary);
+  snprintf(path, sizeof(path), "%s/tau_ffi_bench_cache.wav", temporary);
+  int status = write_wav(path, SECONDS, 1);
+  for (int i = 0; i < 3; i++) {
+    snprintf(short_paths[i], sizeof(short_paths[i]),
+             "%s/tau_ffi_bench_cache_%d.wav", temporary, i);
+    status |= write_wav(short_paths[i], SHORT_SECONDS, 2 + i);
+  }
+  tau_cache* cache = tau_cache_open(directory, 0);
+  if (status != 0 || cache == NULL) {
+    printf("cannot write to %s\n", temporary);
+    tau_cache_close(cache);
+    return 1;
+  }
+  tau_cache_set_limit(cache, INT64_MAX);
+  printf("%d s of 16-bit stereo at %d Hz\n", SECONDS, SAMPLE_RATE);
+  printf("%-8s %12s %16s\n", "path", "load ms", "load + read ms");
+  timing decode;
+  timing cold;
+  timing warm;
+  status = load_repeated(NULL, path, &decode) ||
+           load_once(cache, path, &cold) ||
+           load_repeated(cache, path, &warm);
+  if (status == 0) {
+    print_timing("decode", &decode);
+    print_timing("cold", &cold);
+    print_timing("warm", &warm);
+    printf("warm loads %.1fx faster than decoding, %.1fx with a read\n",
+           decode.load / warm.load, decode.read / warm.read);
+    if (cold.sum != decode.sum || warm.sum != decode.sum) {
+      printf("FAILED: the cache returns different samples\n");
+      status = 1;
+    }
+  }
+  tau_cache_set_limit(cache, 0);
+  status = status || check_eviction(cache, short_paths);
+  tau_cache_set_limit(cache, 0);
+  tau_cache_close(cache);
+  remove(directory);
+  remove(path);
+  for (int i = 0; i < 3; i++) {
+    remove(short_paths[i]);
+  }
+  return status;
+}
@@ -0,0 +1,327 @@
+// The CPU time a compressor takes per channel and second of audio, against
+// a double-precision compressor calling `log10` and `pow` on every frame.
+//
+// The reference follows the same steps as the node: the loudest channel,
+// the gain curve with its soft knee, a gain stepping towards the lowest
+// target of every 32 frames at the attack or release rate and ramping in
+// between, the makeup gain, and a lookahead of 6 ms. The node renders a
+// buffer source of noise of 1 to 8 channels; its time is that of the graph
+// less that of the same graph with a gain in its place.
+//
+// The benchmark fails if a version of the amplitude kernel strays from
+// `pow` by more than 4e-6 of the amplitude, or if the output or the
+// reduction of the node strays from the reference by more than 0.001 dB,
+// for several settings, on a signal moving between -40 and 0 dBFS.
+#include <math.h>
+#include <string.h>
+
+#include "bench.h"
+#include "tau_kernels.h"
+
+#define SAMPLE_RATE 48000
+#define QUANTUM TAU_RENDER_QUANTUM_FRAMES
+#define LOOKAHEAD 288
+#define DIVISION 32
+#define CHECK_FRAMES (2 * SAMPLE_RATE)
+// The largest difference from the reference, in decibels.
+#define TOLERANCE_DB 1e-3
+
+typedef struct settings {
+  float threshold;
+  float knee;
+  float ratio;
+  float attack;
+  float release;
+} settings;
+
+static const settings check_settings[] = {
+    {-24.0f, 30.0f, 12.0f, 0.003f, 0.25f},
+    {-12.0f, 0.0f, 4.0f, 0.0f, 0.1f},
+    {-50.0f, 40.0f, 20.0f, 1.0f, 1.0f},
+    {-6.0f, 6.0f, 2.0f, 0.01f, 0.0f},
+};
+
+// The gain of the curve, in decibels, for a level in decibels.
+static double curve(const settings* s, double level) {
+  double slope = 1.0 / s->ratio - 1.0;
+  double over = level - s->threshold;
+  double inside = fmin(fmax(over + 0.5 * s->knee, 0.0), s->knee);
+  double above = fmax(over - 0.5 * s->knee, 0.0);
+  return slope * (above + (s->knee > 0.0 ? inside * inside / (2.0 * s->knee)
+                                         : 0.0));
+}
+
+static double share(float seconds) {
+  return seconds > 0.0f ? 1.0 - exp(-DIVISION / ((double)seconds *
+                                                 SAMPLE_RATE))
+                        : 1.0;
+}
+
+// Compresses `frames` frames of the `channels` planar channels of `input`
+// into `output`, with `log10` and `pow` on every frame. Returns the gain
+// reduction at the end, in decibels.
+static double reference(const settings* s, const float* input,
+                        int32_t channels, int32_t frames, float* output) {
+  double makeup = -0.6 * curve(s, 0.0);
+  double attack = share(s->attack);
+  double release = share(s->release);
+  double envelope = 0.0;
+  double gains[DIVISION];
+  for (int32_t start = 0; start < frames; start += DIVISION) {
+    double target = 0.0;
+    for (int32_t i = start; i < start + DIVISION; i++) {
+      double level = 0.0;
+      for (int32_t c = 0; c < channels; c++) {
+        level = fmax(level, fabs((double)input[c * frames + i]));
+      }
+      double gain = level > 0.0 ? curve(s, 20.0 * log10(level)) : 0.0;
+      target = fmin(target, gain);
+    }
+    double next =
+        envelope + (target - envelope) * (target < envelope ? attack : release);
+    for (int32_t i = 0; i < DIVISION; i++) {
+      double decibels = envelope + makeup + (next - envelope) * (i + 1) /
+                                                DIVISION;
+      gains[i] = pow(10.0, decibels / 20.0);
+    }
+    envelope = next;
+    for (int32_t c = 0; c < channels; c++) {
+      for (int32_t i = 0; i < DIVISION; i++) {
+        int32_t frame = start + i - LOOKAHEAD;
+        output[c * frames + start + i] =
+            frame >= 0 ? (float)(input[c * frames + frame] * gains[i]) : 0.0f;
+      }
+    }
+  }
+  return envelope;
+}
+
+// A sine at 440 Hz stepping between levels from -40 to 0 dBFS, and noise
+// with bursts, of `frames` frames each.
+static void fill_signal(float* samples, int32_t frames) {
+  static const float levels[] = {-40.0f, -12.0f, -3.0f, 0.0f, -20.0f, -6.0f};
+  uint32_t state = 1;
+  for (int32_t i = 0; i < frames; i++) {
+    float level = levels[(i / (SAMPLE_RATE / 3)) % 6];
+    samples[i] = powf(10.0f, level / 20.0f) *
+                 (float)sin(2.0 * 3.14159265358979 * 440.0 * i / SAMPLE_RATE);
+    state = state * 1664525u + 1013904223u;
+    float noise = (float)(state >> 8) / 8388608.0f - 1.0f;
+    samples[frames + i] =
+        noise * ((i / (SAMPLE_RATE / 5)) % 2 == 0 ? 0.05f : 0.9f);
+  }
+}
+
+// A graph playing `buffer` in a loop through a compressor set to `s`, or a
+// gain if `s` is NULL, in a context of as many channels. Returns the
+// context, and the handle of the node in `*node`.
+static tau_context* create_graph(tau_audio_buffer* buffer, const settings* s,
+                                 int32_t* node) {
+  tau_context* context = tau_context_create(buffer->channels, SAMPLE_RATE);
+  int32_t source = tau_buffer_source_create(context, buffer, 1);
+  *node = s != NULL ? tau_compressor_create(context)
+                    : tau_gain_create(context, 1.0f);
+  int passed =
+      source >= 0 && *node >= 0 && tau_node_start(context, source, 0) == 0 &&
+      tau_node_connect(context, source, *node) == 0 &&
+      tau_node_connect(context, *node, tau_context_destination(context)) ==
+          0;
+  if (passed && s != NULL) {
+    passed =
+        tau_param_set_value(context, *node, TAU_PARAM_THRESHOLD,
+                            s->threshold) == 0 &&
+        tau_param_set_value(context, *node, TAU_PARAM_KNEE, s->knee) == 0 &&
+        tau_param_set_value(context, *node, TAU_PARAM_RATIO, s->ratio) == 0 &&
+        tau_param_set_value(context, *node, TAU_PARAM_ATTACK, s->attack) ==
+            0 &&
+        tau_param_set_value(context, *node, TAU_PARAM_RELEASE, s->release) ==
+            0;
+  }
+  if (!passed) {
+    tau_context_destroy(context);
+    return NULL;
+  }
+  return context;
+}
+
+// The largest relative difference between `a` and `b`, in decibels, over
+// the samples of `b` above -60 dBFS.
+static double difference_db(const float* a, const float* b, int32_t count) {
+  double largest = 0.0;
+  for (int32_t i = 0; i < count; i++) {
+    if (fabsf(b[i]) < 1e-3f) {
+      continue;
+    }
+    double ratio = (double)a[i] / b[i];
+    double d = ratio > 0.0 ? fabs(20.0 * log10(ratio)) : INFINITY;
+    largest = d > largest || d != d ? d : largest;
+  }
+  return largest;
+}
+
+// Whether the compressor set to `s` sounds as the reference on the signal
+// of `fill_signal`, and reports its reduction.
+static int check_settings_of(const settings* s, tau_audio_buffer* buffer,
+                             float* expected, float* actual) {
+  double reduction =
+      reference(s, buffer->data, 2, CHECK_FRAMES, expected);
+  int32_t node;
+  tau_context* context = create_graph(buffer, s, &node);
+  int passed = context != NULL && tau_context_render(context, actual,
+                                                     CHECK_FRAMES) ==
+                                      CHECK_FRAMES;
+  double output_error =
+      passed ? difference_db(actual, expected, 2 * CHECK_FRAMES) : INFINITY;
+  double reduction_error =
+      passed ? fabs(tau_compressor_reduction(context, node) - reduction)
+             : INFINITY;
+  passed = output_error <= TOLERANCE_DB && reduction_error <= TOLERANCE_DB;
+  printf("%6.0f %5.0f %6.0f %7.3f %8.2f %10.2f %12.2g %s\n", s->threshold,
+         s->knee, s->ratio, s->attack, s->release, reduction, output_error,
+         passed ? "ok" : "FAILED");
+  tau_context_destroy(context);
+  return passed;
+}
+
+// The largest difference between the amplitude kernel of `kernels` and
+// `pow`, relative to the amplitude, from -120 to +24 dB.
+static double amplitude_error(const tau_kernel_table* kernels) {
+  enum { COUNT = 1443 };
+  float decibels[COUNT];
+  float amplitudes[COUNT];
+  for (int32_t i = 0; i < COUNT; i++) {
+    decibels[i] = -120.0f + 0.1f * i + 0.0137f;
+  }
+  kernels->amplitudes(amplitudes, decibels, COUNT);
+  double error = 0.0;
+  for (int32_t i = 0; i < COUNT; i++) {
+    double exact = pow(10.0, decibels[i] / 20.0);
+    double d = fabs(amplitudes[i] - exact) / exact;
+    error = d > error || d != d ? d : error;
+  }
+  return error;
+}
+
+// Seconds of rendering `context` per second of audio.
+static double measure_graph(tau_context* context, int32_t channels) {
+  float* output = (float*)malloc((size_t)channels * QUANTUM * sizeof(float));
+  if (output == NULL) {
+    return -1.0;
+  }
+  int64_t frames = 0;
+  double start = bench_now();
+  double elapsed;
+  do {
+    for (int32_t i = 0; i < 100; i++) {
+      if (tau_context_render(context, output, QUANTUM) != QUANTUM) {
+        free(output);
+        return -1.0;
+      }
+    }
+    frames += 100 * QUANTUM;
+    elapsed = bench_now() - start;
+  } while (elapsed < BENCH_MIN_SECONDS);
+  bench_sink += (int64_t)(output[0] * 1000.0f);
+  free(output);
+  return elapsed / ((double)frames / SAMPLE_RATE);
+}
+
+// Seconds the reference takes per second of `buffer`.
+static double measure_reference(tau_audio_buffer* buffer, float* output) {
+  int64_t frames = 0;
+  double start = bench_now();
+  double elapsed;
+  do {
+    bench_sink += (int64_t)reference(&check_settings[0], buffer->data,
+                                     buffer->channels, buffer->frames,
+                                     output);
+    frames += buffer->frames;
+    elapsed = bench_now() - start;
+  } while (elapsed < BENCH_MIN_SECONDS);
+  return elapsed / ((double)frames / SAMPLE_RATE);
+}
+
+int bench_compressor(void) {
+  int status = 0;
+  for (int isa = 0; isa < TAU_ISA_COUNT; isa++) {
+    const tau_kernel_table* kernels = tau_kernels_for((tau_kernel_isa)isa);
+    if (kernels == NULL) {
+      continue;
+    }
+    double error = amplitude_error(kernels);
+    printf("amplitude kernel (%s): %.2g of the amplitude from pow%s\n",
+           kernels->name, error, error <= 4e-6 ? "" : " FAILED");
+    status |= !(error <= 4e-6);
+  }
+
+  tau_audio_buffer* signal =
+      tau_audio_buffer_create(2, CHECK_FRAMES, SAMPLE_RATE);
+  float* expected = (float*)malloc(2 * CHECK_FRAMES * sizeof(float));
+  float* actual = (float*)malloc(2 * CHECK_FRAMES * sizeof(float));
+  if (signal == NULL || expected == NULL || actual == NULL ||
+      signal->stride != CHECK_FRAMES) {
+    tau_audio_buffer_release(signal);
+    free(expected);
+    free(actual);
+    return 1;
+  }
+  fill_signal(signal->data, CHECK_FRAMES);
+  printf("against the double-precision reference, over %d s of stereo\n",
+         CHECK_FRAMES / SAMPLE_RATE);
+  printf("%6s %5s %6s %7s %8s %10s %12s\n", "thresh", "knee", "ratio",
+         "attack", "release", "reduction", "error (dB)");
+  int32_t settings_count =
+      (int32_t)(sizeof(check_settings) / sizeof(*check_settings));
+  for (int32_t i = 0; i < settings_count; i++) {
+    status |= !check_settings_of(&check_settings[i], signal, expected, actual);
+  }
+  tau_audio_buffer_release(signal);
+  free(expected);
+  free(actual);
+
+  printf("CPU time per channel and second of audio, in us\n");
+  printf("%-8s %12s %12s %10s\n", "channels", "node", "reference",
+         "speedup");
+  static const int32_t channel_counts[] = {1, 2, 6, 8};
+  for (int32_t i = 0; i < 4; i++) {
+    int32_t channels = channel_counts[i];
+    tau_audio_buffer* noise =
+        tau_audio_buffer_create(channels, SAMPLE_RATE, SAMPLE_RATE);
+    float* output =
+        (float*)malloc((size_t)channels * SAMPLE_RATE * sizeof(float));
+    int32_t node;
+    tau_context* compressed = NULL;
+    tau_context* gained = NULL;
+    if (noise != NULL && output != NULL) {
+      for (int32_t c = 0; c < channels; c++) {
+        fill_signal(output, SAMPLE_RATE / 2);
+        memcpy(noise->data + (size_t)c * noise->stride, output,
+               SAMPLE_RATE * sizeof(float));
+      }
+      compressed = create_graph(noise, &check_settings[0], &node);
+      gained = create_graph(noise, NULL, &node);
+    }
+    double with = compressed != NULL ? measure_graph(compressed, channels)
+                                     : -1.0;
+    double without = gained != NULL ? measure_graph(gained, channels) : -1.0;
+    double slow = noise != NULL && output != NULL &&
+                          noise->stride == SAMPLE_RATE
+                      ? measure_reference(noise, output)
+                      : -1.0;
+    if (with < 0.0 || without < 0.0 || slow < 0.0) {
+      printf("%-8d FAILED\n", channels);
+      status = 1;
+    } else {
+      double node_us = (with - without) * 1e6 / channels;
+      double reference_us = slow * 1e6 / channels;
+      printf("%-8d %12.1f %12.1f %9.1fx\n", channels, node_us, reference_us,
+             reference_us / node_us);
+      bench_metric(node_us, "us/channel-second", 0, "%d.node", channels);
+    }
+    tau_context_destroy(compressed);
+    tau_context_destroy(gained);
+    tau_audio_buffer_release(noise);
+    free(output);
+  }
+  return status;
+}
@@ -0,0 +1,209 @@
+// Render time per quantum, down to the worst one, while other threads edit
+// the graph.
+//
+// The rendering thread renders a fixed graph of looping voices while 0, 1
+// and 4 editing threads, standing for Dart isolates, churn voices of their
+// own: each creates an oscillator and a gain, connects and starts them,
+// changes and automates their parameters, reconnects and stops them, and
+// releases both. Edits reach the rendering thread through the command queue
+// of the context, so it never waits for an editing thread.
+//
+// Once the editing threads are done, every node they made is released, so
+// the output must match that of the fixed graph rendered alone: the benchmark
+// fails otherwise, or if an edit fails. Built with `-DTAU_FFI_SANITIZE=thread`
+// and run by the `tau_ffi_stress` target, it is the stress test of the queue
+// under ThreadSanitizer.
+#include <math.h>
+#include <string.h>
+
+#include "bench.h"
+#include "tau_platform.h"
+
+#define SAMPLE_RATE 48000
+#define VOICES 32
+#define QUANTA 20000
+#define MAX_EDITORS 4
+
+typedef struct editor {
+  tau_context* context;
+  const volatile int32_t* done;
+  uint32_t seed;
+  int64_t edits;
+  int failed;
+} editor;
+
+static uint32_t next_random(uint32_t* seed) {
+  *seed = *seed * 1664525u + 1013904223u;
+  return *seed >> 8;
+}
+
+// One voice, from creation to release. Returns the number of edits, or -1
+// if one failed.
+static int32_t churn_voice(tau_context* context, uint32_t* seed) {
+  int32_t destination = tau_context_destination(context);
+  float frequency = 200.0f + (float)(next_random(seed) % 800);
+  int32_t oscillator = tau_oscillator_create(context, 0, frequency);
+  int32_t gain = tau_gain_create(context, 0.0f);
+  double now = tau_context_current_time(context);
+  int failed =
+      oscillator < 0 || gain < 0 ||
+      tau_node_connect(context, oscillator, gain) != TAU_OK ||
+      tau_node_connect(context, gain, destination) != TAU_OK ||
+      tau_node_start(context, oscillator, now) != TAU_OK ||
+      tau_param_set_value(context, oscillator, TAU_PARAM_FREQUENCY,
+                          frequency * 1.5f) != TAU_OK ||
+      tau_param_linear_ramp_to_value_at_time(context, gain, TAU_PARAM_GAIN,
+                                             0.01f, now + 0.01) != TAU_OK ||
+      tau_param_set_target_at_time(context, gain, TAU_PARAM_GAIN, 0.0f,
+                                   now + 0.02, 0.005) != TAU_OK ||
+      tau_node_disconnect(context, gain, destination) != TAU_OK ||
+      tau_node_connect(context, gain, destination) != TAU_OK ||
+      tau_node_stop(context, oscillator, now + 0.05) != TAU_OK;
+  // Either end of the connection may go first.
+  if (next_random(seed) % 2 == 0) {
+    failed |= tau_node_release(context, oscillator) != TAU_OK;
+    failed |= tau_node_release(context, gain) != TAU_OK;
+  } else {
+    failed |= tau_node_release(context, gain) != TAU_OK;
+    failed |= tau_node_release(context, oscillator) != TAU_OK;
+  }
+  return failed ? -1 : 13;
+}
+
+static void editor_main(void* arg) {
+  editor* self = (editor*)arg;
+  while (!tau_atomic_load_i32(self->done)) {
+    int32_t edits = churn_voice(self->context, &self->seed);
+    if (edits < 0) {
+      self->failed = 1;
+      return;
+    }
+    self->edits += edits;
+    tau_thread_yield();
+  }
+}
+
+// The fixed graph: looping voices, started at once.
+static tau_context* create_graph(void) {
+  tau_context* context = tau_context_create(2, SAMPLE_RATE);
+  for (int32_t i = 0; context != NULL && i < VOICES; i++) {
+    int32_t oscillator =
+        tau_oscillator_create(context, i % 4, 55.0f * (1 + i % 16));
+    int32_t gain = tau_gain_create(context, 0.5f / VOICES);
+    if (oscillator < 0 || gain < 0 ||
+        tau_node_connect(context, oscillator, gain) != TAU_OK ||
+        tau_node_connect(context, gain, tau_context_destination(context)) !=
+            TAU_OK ||
+        tau_node_start(context, oscillator, 0) != TAU_OK) {
+      tau_context_destroy(context);
+      return NULL;
+    }
+  }
+  return context;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+typedef struct result {
+  double edits_per_quantum;
+  // The largest difference from the fixed graph rendered alone.
+  double error;
+} result;
+
+// Renders `QUANTA` quanta while `editors` threads edit, then one more once
+// they are done. Returns 0 on success.
+static int run(int32_t editors, double* times, result* result) {
+  tau_context* context = create_graph();
+  tau_context* reference = create_graph();
+  tau_audio_buffer* output =
+      tau_audio_buffer_create(2, TAU_RENDER_QUANTUM_FRAMES, SAMPLE_RATE);
+  tau_audio_buffer* expected =
+      tau_audio_buffer_create(2, TAU_RENDER_QUANTUM_FRAMES, SAMPLE_RATE);
+  int status = context == NULL || reference == NULL || output == NULL ||
+               expected == NULL;
+  volatile int32_t done = 0;
+  editor states[MAX_EDITORS];
+  tau_thread threads[MAX_EDITORS];
+  int32_t started = 0;
+  for (; status == 0 && started < editors; started++) {
+    editor* state = &states[started];
+    memset(state, 0, sizeof(*state));
+    state->context = context;
+    state->done = &done;
+    state->seed = 1u + (uint32_t)started;
+    if (tau_thread_start(&threads[started], editor_main, state) != 0) {
+      status = 1;
+      break;
+    }
+  }
+  for (int32_t q = 0; status == 0 && q < QUANTA; q++) {
+    double start = bench_now();
+    tau_context_render_buffer(context, output);
+    times[q] = bench_now() - start;
+  }
+  tau_atomic_store_i32(&done, 1);
+  int64_t edits = 0;
+  for (int32_t i = 0; i < started; i++) {
+    tau_thread_join(threads[i]);
+    status |= states[i].failed;
+    edits += states[i].edits;
+  }
+  double error = 0.0;
+  if (status == 0) {
+    // The last releases apply before the extra quantum.
+    tau_context_render_buffer(context, output);
+    for (int32_t q = 0; q <= QUANTA; q++) {
+      tau_context_render_buffer(reference, expected);
+    }
+    for (int32_t c = 0; c < 2; c++) {
+      for (int32_t i = 0; i < TAU_RENDER_QUANTUM_FRAMES; i++) {
+        double difference =
+            fabs((double)output->data[c * output->stride + i] -
+                 expected->data[c * expected->stride + i]);
+        error = difference > error ? difference : error;
+      }
+    }
+  }
+  result->edits_per_quantum = (double)edits / QUANTA;
+  result->error = error;
+  tau_audio_buffer_release(output);
+  tau_audio_buffer_release(expected);
+  tau_context_destroy(context);
+  tau_context_destroy(reference);
+  return status;
+}
+
+int bench_control(void) {
+  static const int32_t editor_counts[] = {0, 1, MAX_EDITORS};
+  double* times = (double*)malloc(QUANTA * sizeof(double));
+  if (times == NULL) {
+    return 1;
+  }
+  printf("%d voices, %d quanta; a quantum lasts %.0f us in real time\n",
+         VOICES, QUANTA, TAU_RENDER_QUANTUM_FRAMES * 1e6 / SAMPLE_RATE);
+  printf("%-8s %9s %9s %9s %9s %11s %10s %7s\n", "editors", "p50 us",
+         "p99 us", "p99.9 us", "max us", "edits/qtm", "error", "check");
+  int status = 0;
+  for (size_t i = 0; i < sizeof(editor_counts) / sizeof(int32_t); i++) {
+    result result;
+    if (run(editor_counts[i], times, &result) != 0) {
+      printf("%-8d FAILED: an edit failed\n", editor_counts[i]);
+      status = 1;
+      continue;
+    }
+    qsort(times, QUANTA, sizeof(double), compare_doubles);
+    int passed = result.error <= 1e-5;
+    status |= !passed;
+    printf("%-8d %9.2f %9.2f %9.2f %9.2f %11.2f %10.2g %7s\n",
+           editor_counts[i], times[QUANTA / 2] * 1e6,
+           times[QUANTA * 99 / 100] * 1e6, times[QUANTA * 999 / 1000] * 1e6,
+           times[QUANTA - 1] * 1e6, result.edits_per_quantum, result.error,
+           passed ? "ok" : "FAILED");
+  }
+  free(times);
+  return status;
+}
@@ -0,0 +1,183 @@
+// CPU time of convolving one second of mono audio with impulse responses of
+// growing length, with the FFT convolver node and with the direct form.
+//
+// The direct form is one vectorized multiply-add per impulse sample and per
+// output sample. Before timing, the benchmark checks the output of the
+// convolver node against a direct convolution computed in double precision,
+// and fails if they differ by more than float rounding.
+#include <math.h>
+#include <string.h>
+
+#include "bench.h"
+#include "tau_kernels.h"
+
+#define SAMPLE_RATE 48000
+#define CHECK_FRAMES 8192
+#define CHECK_TAPS 3000
+#define TOLERANCE 1e-5
+
+static void fill(float* samples, int32_t count, uint32_t seed, float level) {
+  for (int32_t i = 0; i < count; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    samples[i] = ((float)(seed >> 8) / (float)(1 << 23) - 1.0f) * level;
+  }
+}
+
+// A one-channel context playing `input` through a convolver of `impulse`.
+static tau_context* create_graph(tau_audio_buffer* input,
+                                 tau_audio_buffer* impulse, int loop) {
+  tau_context* context = tau_context_create(1, SAMPLE_RATE);
+  if (context == NULL) {
+    return NULL;
+  }
+  int32_t source = tau_buffer_source_create(context, input, loop);
+  int32_t convolver = tau_convolver_create(context, impulse, 0);
+  if (source < 0 || convolver < 0 ||
+      tau_node_connect(context, source, convolver) != 0 ||
+      tau_node_connect(context, convolver,
+                       tau_context_destination(context)) != 0 ||
+      tau_node_start(context, source, 0) != 0) {
+    tau_context_destroy(context);
+    return NULL;
+  }
+  return context;
+}
+
+// Whether the convolver matches a direct convolution.
+static int check(void) {
+  tau_audio_buffer* input = tau_audio_buffer_create(1, CHECK_FRAMES,
+                                                    SAMPLE_RATE);
+  tau_audio_buffer* impulse = tau_audio_buffer_create(1, CHECK_TAPS,
+                                                      SAMPLE_RATE);
+  tau_audio_buffer* output = tau_audio_buffer_create(1, CHECK_FRAMES,
+                                                     SAMPLE_RATE);
+  if (input == NULL || impulse == NULL || output == NULL) {
+    tau_audio_buffer_release(input);
+    tau_audio_buffer_release(impulse);
+    tau_audio_buffer_release(output);
+    return 0;
+  }
+  fill(input->data, CHECK_FRAMES, 1, 1.0f);
+  fill(impulse->data, CHECK_TAPS, 2, 0.05f);
+  tau_context* context = create_graph(input, impulse, 0);
+  int same = context != NULL &&
+             tau_context_render_buffer(context, output) == CHECK_FRAMES;
+  double error = 0.0;
+  double peak = 0.0;
+  for (int32_t n = 0; same && n < CHECK_FRAMES; n++) {
+    double expected = 0.0;
+    for (int32_t k = 0; k < CHECK_TAPS && k <= n; k++) {
+      expected += (double)impulse->data[k] * input->data[n - k];
+    }
+    error = fmax(error, fabs(expected - output->data[n]));
+    peak = fmax(peak, fabs(expected));
+  }
+  if (same && error > TOLERANCE * peak) {
+    printf("FAILED: error %.3g for a peak of %.3g\n", error, peak);
+    same = 0;
+  }
+  tau_context_destroy(context);
+  tau_audio_buffer_release(input);
+  tau_audio_buffer_release(impulse);
+  tau_audio_buffer_release(output);
+  return same;
+}
+
+// Seconds of CPU per second of audio for the convolver node.
+static double measure_fft(tau_audio_buffer* input, tau_audio_buffer* impulse,
+                          tau_audio_buffer* output) {
+  tau_context* context = create_graph(input, impulse, 1);
+  if (context == NULL) {
+    return -1.0;
+  }
+  int64_t frames = 0;
+  double start = bench_now();
+  double elapsed;
+  do {
+    tau_context_render_buffer(context, output);
+    frames += output->frames;
+    elapsed = bench_now() - start;
+  } while (elapsed < BENCH_MIN_SECONDS);
+  bench_sink += (int64_t)output->data[0];
+  tau_context_destroy(context);
+  return elapsed * SAMPLE_RATE / (double)frames;
+}
+
+// Seconds of CPU per second of audio for the direct form, a quantum at a
+// time from a history of the last `taps - 1` input samples.
+static double measure_direct(const float* samples, int32_t frames,
+                             const float* taps, int32_t tap_count) {
+  int32_t length = tap_count - 1 + TAU_RENDER_QUANTUM_FRAMES;
+  float* history = (float*)calloc((size_t)length, sizeof(float));
+  float output[TAU_RENDER_QUANTUM_FRAMES];
+  if (history == NULL) {
+    return -1.0;
+  }
+  int64_t quanta = 0;
+  int32_t position = 0;
+  double start = bench_now();
+  double elapsed;
+  do {
+    memmove(history, history + TAU_RENDER_QUANTUM_FRAMES,
+            (size_t)(tap_count - 1) * sizeof(float));
+    memcpy(history + tap_count - 1, samples + position,
+           TAU_RENDER_QUANTUM_FRAMES * sizeof(float));
+    position = (position + TAU_RENDER_QUANTUM_FRAMES) % frames;
+    memset(output, 0, sizeof(output));
+    for (int32_t k = 0; k < tap_count; k++) {
+      tau_kernel_scale_add(output, history + tap_count - 1 - k, taps[k],
+                           TAU_RENDER_QUANTUM_FRAMES);
+    }
+    quanta++;
+    elapsed = bench_now() - start;
+  } while (elapsed < BENCH_MIN_SECONDS);
+  bench_sink += (int64_t)output[0];
+  free(history);
+  return elapsed * SAMPLE_RATE / ((double)quanta * TAU_RENDER_QUANTUM_FRAMES);
+}
+
+int bench_convolver(void) {
+  static const double impulse_seconds[] = {0.1, 0.5, 1.0, 2.0, 4.0};
+  if (!check()) {
+    return 1;
+  }
+  printf("convolver matches the direct form\n");
+  tau_audio_buffer* input = tau_audio_buffer_create(1, SAMPLE_RATE,
+                                                    SAMPLE_RATE);
+  tau_audio_buffer* output =
+      tau_audio_buffer_create(1, 16 * TAU_RENDER_QUANTUM_FRAMES, SAMPLE_RATE);
+  if (input == NULL || output == NULL) {
+    tau_audio_buffer_release(input);
+    tau_audio_buffer_release(output);
+    return 1;
+  }
+  fill(input->data, SAMPLE_RATE, 1, 1.0f);
+  int status = 0;
+  printf("%-10s %14s %14s %10s %16s\n", "IR s", "direct ms/s", "fft ms/s",
+         "speedup", "fft ms/s per IR s");
+  for (size_t i = 0;
+       i < sizeof(impulse_seconds) / sizeof(impulse_seconds[0]); i++) {
+    int32_t taps = (int32_t)(impulse_seconds[i] * SAMPLE_RATE);
+    tau_audio_buffer* impulse = tau_audio_buffer_create(1, taps, SAMPLE_RATE);
+    if (impulse == NULL) {
+      status = 1;
+      break;
+    }
+    fill(impulse->data, taps, 2, 0.01f);
+    double fft = measure_fft(input, impulse, output);
+    double direct = measure_direct(input->data, SAMPLE_RATE, impulse->data,
+                                   taps);
+    tau_audio_buffer_release(impulse);
+    if (fft < 0 || direct < 0) {
+      status = 1;
+      break;
+    }
+    printf("%-10.1f %14.2f %14.3f %9.0fx %16.3f\n", impulse_seconds[i],
+           direct * 1e3, fft * 1e3, direct / fft,
+           fft * 1e3 / impulse_seconds[i]);
+    bench_metric(fft * 1e3, "ms/s", 0, "fft.%.1fs", impulse_seconds[i]);
+  }
+  tau_audio_buffer_release(input);
+  tau_audio_buffer_release(output);
+  return status;
+}
@@ -0,0 +1,134 @@
+// Real-time playback through the sinks, which keep the pace of a sound card
+// on machines without one: underruns and callback jitter.
+//
+// A graph of 32 oscillators, each through its own gain, plays for
+// `--seconds` seconds, 2 by default, on the null sink at periods of 128,
+// 512 and 1024 frames, then on the WAV sink at 512. The benchmark fails if
+// a device plays more than 2% faster or slower than its sample rate, or if
+// the WAV file does not hold the frames an offline render of the same graph
+// produces. Underruns depend on the load of the machine, and only show.
+#include <math.h>
+
+#include "bench.h"
+#include "tau_platform.h"
+
+#define SAMPLE_RATE 48000
+#define VOICES 32
+
+static tau_context* create_graph(void) {
+  tau_context* context = tau_context_create(2, SAMPLE_RATE);
+  for (int32_t i = 0; context != NULL && i < VOICES; i++) {
+    int32_t oscillator =
+        tau_oscillator_create(context, i % 4, 110.0f * (1 + i % 12));
+    int32_t gain = tau_gain_create(context, 0.5f / VOICES);
+    if (oscillator < 0 || gain < 0 ||
+        tau_node_connect(context, oscillator, gain) != TAU_OK ||
+        tau_node_connect(context, gain, tau_context_destination(context)) !=
+            TAU_OK ||
+        tau_node_start(context, oscillator, 0) != TAU_OK) {
+      tau_context_destroy(context);
+      return NULL;
+    }
+  }
+  return context;
+}
+
+// The largest difference between the WAV file at `path` and `frames` frames
+// of the graph rendered offline, or a negative value if they differ in
+// length.
+static double compare_file(const char* path, int64_t frames) {
+  tau_audio_buffer* written = tau_decode_file(path);
+  tau_context* context = create_graph();
+  tau_audio_buffer* expected =
+      frames > 0 && frames <= INT32_MAX
+          ? tau_audio_buffer_create(2, (int32_t)frames, SAMPLE_RATE)
+          : NULL;
+  double error = -1.0;
+  if (written != NULL && context != NULL && expected != NULL &&
+      written->channels == 2 && written->frames == frames &&
+      tau_context_render_buffer(context, expected) == frames) {
+    error = 0.0;
+    for (int32_t c = 0; c < 2; c++) {
+      for (int32_t i = 0; i < expected->frames; i++) {
+        double difference =
+            fabs((double)written->data[c * written->stride + i] -
+                 expected->data[c * expected->stride + i]);
+        error = difference > error ? difference : error;
+      }
+    }
+  }
+  tau_audio_buffer_release(written);
+  tau_audio_buffer_release(expected);
+  tau_context_destroy(context);
+  return error;
+}
+
+int bench_device(void) {
+  static const struct {
+    const char* backend;
+    int32_t period_frames;
+  } configurations[] = {{"null", 128}, {"null", 512}, {"null", 1024},
+                        {"wav", 512}};
+  double seconds = bench_seconds > 0 ? bench_seconds : 2.0;
+#if _WIN32
+  const char* directory = getenv("TEMP");
+#else
+  const char* directory = getenv("TMPDIR");
+  directory = directory != NULL ? directory : "/tmp";
+#endif
+  char path[1024];
+  snprintf(path, sizeof(path), "%s/tau_ffi_bench_device.wav",
+           directory != NULL ? directory : ".");
+  printf("%d voices at %d Hz, %.1f s per device\n", VOICES, SAMPLE_RATE,
+         seconds);
+  printf("%-6s %7s %9s %10s %12s %12s %10s %10s %7s\n", "sink", "period",
+         "callbacks", "underruns", "jitter us", "max jitter", "render us",
+         "max render", "pace");
+  int status = 0;
+  for (size_t i = 0; i < sizeof(configurations) / sizeof(configurations[0]);
+       i++) {
+    const char* backend = configurations[i].backend;
+    int is_file = backend[0] == 'w';
+    tau_context* context = create_graph();
+    tau_device* device =
+        context != NULL
+            ? tau_device_open(context, backend, is_file ? path : NULL,
+                              configurations[i].period_frames)
+            : NULL;
+    double start = bench_now();
+    if (device == NULL || tau_device_start(device) != TAU_OK) {
+      printf("%-6s FAILED: cannot open the device\n", backend);
+      tau_device_close(device);
+      tau_context_destroy(context);
+      status = 1;
+      continue;
+    }
+    tau_sleep_until(tau_now_ns() + (int64_t)(seconds * 1e9));
+    int stopped = tau_device_stop(device) == TAU_OK;
+    double elapsed = bench_now() - start;
+    tau_device_stats stats;
+    tau_device_get_stats(device, &stats);
+    tau_device_close(device);
+    tau_context_destroy(context);
+    // The first period is asked for at once, ahead of the clock.
+    double pace = (double)(stats.frames - configurations[i].period_frames) /
+                  SAMPLE_RATE / elapsed;
+    int passed = stopped && fabs(pace - 1.0) <= 0.02;
+    if (is_file) {
+      double error = compare_file(path, stats.frames);
+      passed &= error >= 0.0 && error <= 1e-6;
+      remove(path);
+    }
+    status |= !passed;
+    int64_t callbacks = stats.callbacks > 0 ? stats.callbacks : 1;
+    printf("%-6s %7d %9lld %10lld %12.2f %12.2f %10.2f %10.2f %6.3f%s\n",
+           backend, configurations[i].period_frames,
+           (long long)stats.callbacks, (long long)stats.underruns,
+           stats.jitter_ns * 1e-3 / callbacks, stats.max_jitter_ns * 1e-3,
+           stats.render_ns * 1e-3 / callbacks, stats.max_render_ns * 1e-3,
+           pace, passed ? "" : " FAILED");
+  }
+  printf("(jitter: how far the time between two callbacks strayed from a "
+         "period)\n");
+  return status;
+}
@@ -0,0 +1,125 @@
+// Render time of a voice graph on a growing number of render threads.
+//
+// Each voice is an oscillator through two gains, mixed into one of eight
+// buses, themselves mixed into the destination: the voices are independent
+// chains, so they render in parallel, while the buses wait for their voices.
+// The benchmark first checks that parallel rendering produces exactly the
+// samples of serial rendering, then reports the time per quantum and the
+// number of voices that would render in real time at that rate.
+#include <string.h>
+
+#include "bench.h"
+#include "tau_platform.h"
+
+#define SAMPLE_RATE 48000
+#define VOICES 256
+#define BUSES 8
+#define CHECKED_QUANTA 64
+
+static tau_context* create_graph(int32_t threads) {
+  tau_context* context = tau_context_create(2, SAMPLE_RATE);
+  if (context == NULL ||
+      tau_context_set_render_threads(context, threads) != 0) {
+    tau_context_destroy(context);
+    return NULL;
+  }
+  int32_t buses[BUSES];
+  for (int32_t i = 0; i < BUSES; i++) {
+    buses[i] = tau_gain_create(context, 1.0f / BUSES);
+    if (buses[i] < 0 || tau_node_connect(context, buses[i],
+                                         tau_context_destination(context))) {
+      tau_context_destroy(context);
+      return NULL;
+    }
+  }
+  for (int32_t i = 0; i < VOICES; i++) {
+    int32_t oscillator =
+        tau_oscillator_create(context, i % 4, 55.0f * (1 + i % 32));
+    int32_t gain = tau_gain_create(context, 0.5f);
+    int32_t level = tau_gain_create(context, 8.0f / VOICES);
+    if (oscillator < 0 || gain < 0 || level < 0 ||
+        tau_node_connect(context, oscillator, gain) != 0 ||
+        tau_node_connect(context, gain, level) != 0 ||
+        tau_node_connect(context, level, buses[i % BUSES]) != 0 ||
+        tau_node_start(context, oscillator, 0) != 0) {
+      tau_context_destroy(context);
+      return NULL;
+    }
+  }
+  return context;
+}
+
+// Whether `threads` render threads produce the samples of a single one.
+static int check(int32_t threads) {
+  tau_context* serial = create_graph(1);
+  tau_context* parallel = create_graph(threads);
+  tau_audio_buffer* expected =
+      tau_audio_buffer_create(2, TAU_RENDER_QUANTUM_FRAMES, SAMPLE_RATE);
+  tau_audio_buffer* actual =
+      tau_audio_buffer_create(2, TAU_RENDER_QUANTUM_FRAMES, SAMPLE_RATE);
+  int same = serial != NULL && parallel != NULL && expected != NULL &&
+             actual != NULL;
+  for (int32_t i = 0; same && i < CHECKED_QUANTA; i++) {
+    same = tau_context_render_buffer(serial, expected) >= 0 &&
+           tau_context_render_buffer(parallel, actual) >= 0 &&
+           memcmp(expected->data, actual->data,
+                  2 * expected->stride * sizeof(float)) == 0;
+  }
+  tau_audio_buffer_release(expected);
+  tau_audio_buffer_release(actual);
+  tau_context_destroy(serial);
+  tau_context_destroy(parallel);
+  return same;
+}
+
+int bench_graph(void) {
+  int32_t cores = tau_cpu_count();
+  tau_audio_buffer* output =
+      tau_audio_buffer_create(2, TAU_RENDER_QUANTUM_FRAMES, SAMPLE_RATE);
+  if (output == NULL) {
+    return 1;
+  }
+  int status = 0;
+  printf("%d voices, %d buses, %d processors\n", VOICES, BUSES, cores);
+  printf("%-8s %12s %10s %16s\n", "threads", "us/quantum", "speedup",
+         "realtime voices");
+  double serial = 0.0;
+  for (int32_t threads = 1; threads <= 2 * cores || threads <= 2;
+       threads *= 2) {
+    if (!check(threads)) {
+      printf("FAILED: %d threads differ from serial rendering\n", threads);
+      status = 1;
+      continue;
+    }
+    tau_context* context = create_graph(threads);
+    if (context == NULL) {
+      status = 1;
+      continue;
+    }
+    for (int32_t i = 0; i < 100; i++) {
+      tau_context_render_buffer(context, output);
+    }
+    int64_t quanta = 0;
+    double start = bench_now();
+    double elapsed;
+    do {
+      for (int32_t i = 0; i < 100; i++) {
+        tau_context_render_buffer(context, output);
+      }
+      quanta += 100;
+      elapsed = bench_now() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+    bench_sink += (int64_t)output->data[0];
+    tau_context_destroy(context);
+    double per_quantum = elapsed / (double)quanta;
+    if (threads == 1) {
+      serial = per_quantum;
+    }
+    double quantum_seconds = (double)TAU_RENDER_QUANTUM_FRAMES / SAMPLE_RATE;
+    printf("%-8d %12.2f %9.2fx %16.0f\n", threads, per_quantum * 1e6,
+           serial / per_quantum, VOICES * quantum_seconds / per_quantum);
+    bench_metric(per_quantum * 1e6, "us/quantum", 0, "threads.%d", threads);
+  }
+  tau_audio_buffer_release(output);
+  return status;
+}
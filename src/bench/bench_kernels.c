@@ -0,0 +1,226 @@
+// Throughput of every sample kernel on every instruction set the processor
+// supports, in millions of samples per second.
+//
+// Before timing, each vector version is checked against the scalar one on
+// every length up to a few vectors and at unaligned offsets. Results must
+// match bit for bit, or within a few rounding errors where the compiler fuses
+// the scalar multiply-adds or a dot product sums in another order. The
+// benchmark fails if any version does not.
+//
+// The complex kernels take the real and imaginary parts of their operands
+// from the two halves of each buffer, and the butterfly its twiddle factors
+// from the gains. The blended dot product blends the gains with the source
+// and adds its result to the first sample of the destination; the ramps
+// only write the destination. The smoothed magnitude takes the real parts
+// from the source and the imaginary ones from the gains, and the decibels
+// turn the negative half of the source to -infinity. The compressor gain
+// and the amplitudes take the source as levels in decibels.
+#include <math.h>
+#include <string.h>
+
+#include "bench.h"
+#include "tau_kernels.h"
+
+#define BLOCK 1024
+#define CHECK_LENGTH 67
+#define TOLERANCE 1e-6f
+
+enum kernel {
+  KERNEL_SCALE,
+  KERNEL_ADD,
+  KERNEL_SCALE_ADD,
+  KERNEL_MULTIPLY,
+  KERNEL_MULTIPLY_ADD,
+  KERNEL_CLIP,
+  KERNEL_COMPLEX_MULTIPLY_ADD,
+  KERNEL_BUTTERFLY,
+  KERNEL_BLEND_DOT,
+  KERNEL_RAMP,
+  KERNEL_GEOMETRIC,
+  KERNEL_SMOOTH_MAGNITUDE,
+  KERNEL_DECIBELS,
+  KERNEL_COMPRESSOR_GAIN,
+  KERNEL_AMPLITUDES,
+  KERNEL_COUNT,
+};
+
+static const char* const kernel_names[KERNEL_COUNT] = {
+    "scale",        "add",        "scale_add",       "multiply",
+    "multiply_add", "clip",       "complex_mul_add", "butterfly",
+    "blend_dot",    "ramp",       "geometric",       "smooth_mag",
+    "decibels",     "compressor", "amplitudes",
+};
+
+static void run_kernel(const tau_kernel_table* kernels, int kernel,
+                       float* destination, const float* source,
+                       const float* gains, int32_t count) {
+  switch (kernel) {
+    case KERNEL_SCALE:
+      kernels->scale(destination, source, 0.7f, count);
+      break;
+    case KERNEL_ADD:
+      kernels->add(destination, source, count);
+      break;
+    case KERNEL_SCALE_ADD:
+      kernels->scale_add(destination, source, 0.7f, count);
+      break;
+    case KERNEL_MULTIPLY:
+      kernels->multiply(destination, source, gains, count);
+      break;
+    case KERNEL_MULTIPLY_ADD:
+      kernels->multiply_add(destination, source, gains, count);
+      break;
+    case KERNEL_CLIP:
+      kernels->clip(destination, source, -0.5f, 0.5f, count);
+      break;
+    case KERNEL_COMPLEX_MULTIPLY_ADD:
+      kernels->complex_multiply_add(destination, destination + count / 2,
+                                    source, source + count / 2, gains,
+                                    gains + count / 2, count / 2);
+      break;
+    case KERNEL_BUTTERFLY:
+      kernels->butterfly(destination, destination + count / 2, gains,
+                         gains + count / 4, count / 4);
+      break;
+    case KERNEL_RAMP:
+      kernels->ramp(destination, 0.25f, 1e-3f, count);
+      break;
+    case KERNEL_GEOMETRIC:
+      kernels->geometric(destination, 0.5f, 0.25f, 0.999f, count);
+      break;
+    case KERNEL_SMOOTH_MAGNITUDE:
+      kernels->smooth_magnitude(destination, source, gains, 0.5f, 0.8f,
+                                count);
+      break;
+    case KERNEL_DECIBELS:
+      kernels->decibels(destination, source, count);
+      break;
+    case KERNEL_COMPRESSOR_GAIN:
+      kernels->compressor_gain(destination, source, -0.25f, 0.5f, -0.75f,
+                               count);
+      break;
+    case KERNEL_AMPLITUDES:
+      kernels->amplitudes(destination, source, count);
+      break;
+    default:
+      destination[0] +=
+          kernels->blend_dot(source, gains, source, 0.3f, count);
+      break;
+  }
+}
+
+static void fill(float* samples, int32_t count, uint32_t seed) {
+  for (int32_t i = 0; i < count; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    samples[i] = (float)(seed >> 8) / (float)(1 << 23) - 1.0f;
+  }
+}
+
+// Runs `kernel` on every length and offset with both versions. Returns 0 if
+// they match exactly, 1 if within the tolerance, and -1 otherwise.
+static int check(const tau_kernel_table* kernels, int kernel) {
+  float source[CHECK_LENGTH + 4];
+  float gains[CHECK_LENGTH + 4];
+  float initial[CHECK_LENGTH + 4];
+  float expected[CHECK_LENGTH + 4];
+  float actual[CHECK_LENGTH + 4];
+  int result = 0;
+  // A dot product sums every product in a different order, and a geometric
+  // sequence accumulates its powers in another order.
+  float tolerance = kernel == KERNEL_BLEND_DOT || kernel == KERNEL_GEOMETRIC
+                        ? TOLERANCE * CHECK_LENGTH
+                        : TOLERANCE;
+  fill(source, CHECK_LENGTH + 4, 1);
+  fill(gains, CHECK_LENGTH + 4, 2);
+  fill(initial, CHECK_LENGTH + 4, 3);
+  for (int32_t offset = 0; offset < 4; offset++) {
+    for (int32_t count = 0; count <= CHECK_LENGTH; count++) {
+      memcpy(expected, initial, sizeof(initial));
+      memcpy(actual, initial, sizeof(initial));
+      run_kernel(&tau_kernels_scalar, kernel, expected + offset,
+                 source + offset, gains + offset, count);
+      run_kernel(kernels, kernel, actual + offset, source + offset,
+                 gains + offset, count);
+      for (int32_t i = 0; i < CHECK_LENGTH + 4; i++) {
+        if (memcmp(&expected[i], &actual[i], sizeof(float)) == 0) {
+          continue;
+        }
+        if (fabsf(expected[i] - actual[i]) >
+            tolerance * (1.0f + fabsf(expected[i]))) {
+          printf("%s %s: length %d offset %d sample %d: %.9g != %.9g\n",
+                 kernels->name, kernel_names[kernel], count, offset, i,
+                 expected[i], actual[i]);
+          return -1;
+        }
+        result = 1;
+      }
+    }
+  }
+  return result;
+}
+
+static double measure(const tau_kernel_table* kernels, int kernel,
+                      float* destination, const float* source,
+                      const float* gains) {
+  int64_t iterations = 0;
+  double start = bench_now();
+  double elapsed;
+  do {
+    for (int i = 0; i < 1000; i++) {
+      run_kernel(kernels, kernel, destination, source, gains, BLOCK);
+    }
+    iterations += 1000;
+    elapsed = bench_now() - start;
+  } while (elapsed < BENCH_MIN_SECONDS);
+  bench_sink += (int64_t)destination[BLOCK - 1];
+  return (double)iterations * BLOCK / elapsed / 1e6;
+}
+
+int bench_kernels(void) {
+  float* source = (float*)tau_aligned_alloc(BLOCK * sizeof(float), 64);
+  float* gains = (float*)tau_aligned_alloc(BLOCK * sizeof(float), 64);
+  float* destination = (float*)tau_aligned_alloc(BLOCK * sizeof(float), 64);
+  if (source == NULL || gains == NULL || destination == NULL) {
+    tau_aligned_free(source);
+    tau_aligned_free(gains);
+    tau_aligned_free(destination);
+    return 1;
+  }
+  fill(source, BLOCK, 1);
+  fill(gains, BLOCK, 2);
+  // Keeps the accumulating kernels away from denormals and infinities.
+  for (int32_t i = 0; i < BLOCK; i++) {
+    gains[i] *= 1e-6f;
+  }
+  int status = 0;
+  printf("selected: %s\n", tau_kernels()->name);
+  printf("%-16s %-8s %12s %10s %8s\n", "kernel", "isa", "Msamples/s",
+         "vs scalar", "check");
+  for (int kernel = 0; kernel < KERNEL_COUNT; kernel++) {
+    double scalar = 0;
+    for (int isa = 0; isa < TAU_ISA_COUNT; isa++) {
+      const tau_kernel_table* kernels = tau_kernels_for((tau_kernel_isa)isa);
+      if (kernels == NULL) {
+        continue;
+      }
+      int checked = check(kernels, kernel);
+      if (checked < 0) {
+        status = 1;
+      }
+      memset(destination, 0, BLOCK * sizeof(float));
+      double rate = measure(kernels, kernel, destination, source, gains);
+      if (isa == TAU_ISA_SCALAR) {
+        scalar = rate;
+      }
+      printf("%-16s %-8s %12.0f %9.2fx %8s\n", kernel_names[kernel],
+             kernels->name, rate, rate / scalar,
+             checked == 0 ? "exact" : checked > 0 ? "close" : "FAILED");
+      bench_metric(rate, "Msamples/s", 1, "%s.%s", kernel_names[kernel],
+                   kernels->name);
+    }
+  }
+  tau_aligned_free(source);
+  tau_aligned_free(gains);
+  tau_aligned_free(destination);
+  return status;
+}
@@ -0,0 +1,140 @@
+// Per-quantum render time of a graph whose voices are replaced continuously,
+// with the engine pools and arenas on and off.
+//
+// Every quantum, the oldest voice (an oscillator through a gain) is released
+// and a new one created, while looping buffer sources use arena scratch
+// memory. With pooling off, every node, bus and scratch block is a heap
+// allocation, as before the pools existed. With pooling on, the benchmark
+// also checks that the steady state makes no heap allocation at all, and
+// fails otherwise.
+#include "bench.h"
+#include "tau_memory.h"
+
+#define SAMPLE_RATE 48000
+#define VOICES 64
+#define BUFFER_SOURCES 8
+#define WARMUP_QUANTA 2000
+#define MEASURED_QUANTA 20000
+
+typedef struct voice {
+  int32_t oscillator;
+  int32_t gain;
+} voice;
+
+static int start_voice(tau_context* context, voice* slot, int32_t index) {
+  slot->oscillator =
+      tau_oscillator_create(context, index % 4, 110.0f * (1 + index % 24));
+  slot->gain = tau_gain_create(context, 0.5f / VOICES);
+  if (slot->oscillator < 0 || slot->gain < 0 ||
+      tau_node_connect(context, slot->oscillator, slot->gain) != 0 ||
+      tau_node_connect(context, slot->gain,
+                       tau_context_destination(context)) != 0) {
+    return 1;
+  }
+  return tau_node_start(context, slot->oscillator, 0) != 0;
+}
+
+static void stop_voice(tau_context* context, voice* slot) {
+  tau_node_release(context, slot->oscillator);
+  tau_node_release(context, slot->gain);
+}
+
+static int compare_doubles(const void* a, const void* b) {
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+// Renders with voice churn. Returns the heap allocations made while measuring,
+// or -1 on failure.
+static int64_t run(int pooling, tau_audio_buffer* samples, double* times) {
+  tau_memory_set_pooling(pooling);
+  tau_context* context = tau_context_create(2, SAMPLE_RATE);
+  tau_audio_buffer* output =
+      tau_audio_buffer_create(2, TAU_RENDER_QUANTUM_FRAMES, SAMPLE_RATE);
+  voice voices[VOICES];
+  int failed = context == NULL || output == NULL;
+  for (int32_t i = 0; !failed && i < VOICES; i++) {
+    failed = start_voice(context, &voices[i], i);
+  }
+  for (int32_t i = 0; !failed && i < BUFFER_SOURCES; i++) {
+    int32_t source = tau_buffer_source_create(context, samples, 1);
+    failed = source < 0 ||
+             tau_node_connect(context, source,
+                              tau_context_destination(context)) != 0 ||
+             tau_node_start(context, source, 0) != 0;
+  }
+  int64_t allocations = -1;
+  for (int32_t quantum = 0;
+       !failed && quantum < WARMUP_QUANTA + MEASURED_QUANTA; quantum++) {
+    if (quantum == WARMUP_QUANTA) {
+      allocations = tau_memory_allocations();
+    }
+    double start = bench_now();
+    voice* slot = &voices[quantum % VOICES];
+    stop_voice(context, slot);
+    failed = start_voice(context, slot, quantum);
+    tau_context_render_buffer(context, output);
+    if (quantum >= WARMUP_QUANTA) {
+      times[quantum - WARMUP_QUANTA] = bench_now() - start;
+    }
+  }
+  if (!failed) {
+    allocations = tau_memory_allocations() - allocations;
+    bench_sink += (int64_t)output->data[0];
+  }
+  tau_audio_buffer_release(output);
+  tau_context_destroy(context);
+  tau_memory_set_pooling(1);
+  return failed ? -1 : allocations;
+}
+
+static void report(const char* mode, double* times, int64_t allocations) {
+  qsort(times, MEASURED_QUANTA, sizeof(double), compare_doubles);
+  printf("%-8s %9.2f %9.2f %9.2f %9.2f %12.3f\n", mode,
+         times[MEASURED_QUANTA / 2] * 1e6,
+         times[MEASURED_QUANTA * 99 / 100] * 1e6,
+         times[MEASURED_QUANTA * 999 / 1000] * 1e6,
+         times[MEASURED_QUANTA - 1] * 1e6,
+         (double)allocations / MEASURED_QUANTA);
+  bench_metric(times[MEASURED_QUANTA * 99 / 100] * 1e6, "us", 0, "%s.p99",
+               mode);
+  bench_metric((double)allocations / MEASURED_QUANTA, "allocs/quantum", 0,
+               "%s.allocations", mode);
+}
+
+int bench_memory(void) {
+  double* times = (double*)malloc(MEASURED_QUANTA * sizeof(double));
+  tau_audio_buffer* samples = tau_audio_buffer_create(2, 4096, 44100);
+  if (times == NULL || samples == NULL) {
+    free(times);
+    tau_audio_buffer_release(samples);
+    return 1;
+  }
+  for (int32_t i = 0; i < 2 * samples->stride; i++) {
+    samples->data[i] = (float)(i % 200) / 100.0f - 1.0f;
+  }
+  int status = 0;
+  printf("%-8s %9s %9s %9s %9s %12s\n", "mode", "p50 us", "p99 us",
+         "p99.9 us", "max us", "allocs/qtm");
+  int64_t heap = run(0, samples, times);
+  if (heap < 0) {
+    status = 1;
+  } else {
+    report("heap", times, heap);
+  }
+  int64_t pooled = run(1, samples, times);
+  if (pooled < 0) {
+    status = 1;
+  } else {
+    report("pooled", times, pooled);
+    if (pooled != 0) {
+      printf("FAILED: %lld heap allocations in the steady state\n",
+             (long long)pooled);
+      status = 1;
+    }
+  }
+  tau_audio_buffer_release(samples);
+  free(times);
+  return status;
+}
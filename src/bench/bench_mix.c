@@ -0,0 +1,120 @@
+// The mixes between buses of 1, 2, 4 and 6 channels, in nanoseconds per
+// quantum: the generic version, going through the mixing matrix at run
+// time, against the version specialized for the pair of channel counts.
+//
+// Every pair is timed for both interpretations, accumulating into the
+// destination as `mix_inputs` does for every input after the first. Before
+// timing, both versions mix the same source, replacing and accumulating; the
+// benchmark fails if they differ by more than a rounding error.
+#include <math.h>
+#include <string.h>
+
+#include "bench.h"
+#include "tau_engine.h"
+
+#define TOLERANCE 1e-6f
+
+typedef void (*mix_fn)(float* destination, int32_t destination_channels,
+                       const float* source, int32_t source_channels,
+                       tau_channel_interpretation interpretation,
+                       int accumulate);
+
+static void fill(float* samples, int32_t count, uint32_t seed) {
+  for (int32_t i = 0; i < count; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    samples[i] = (float)(seed >> 8) / (float)(1 << 23) - 1.0f;
+  }
+}
+
+// Whether both versions mix `source` alike, replacing and accumulating.
+static int check(float* expected, float* actual, const float* source,
+                 int32_t source_channels, int32_t destination_channels,
+                 tau_channel_interpretation interpretation) {
+  int32_t samples = destination_channels * TAU_QUANTUM;
+  for (int accumulate = 0; accumulate < 2; accumulate++) {
+    fill(expected, samples, 7);
+    memcpy(actual, expected, samples * sizeof(float));
+    tau_bus_mix_generic(expected, destination_channels, source,
+                        source_channels, interpretation, accumulate);
+    tau_bus_mix(actual, destination_channels, source, source_channels,
+                interpretation, accumulate);
+    for (int32_t i = 0; i < samples; i++) {
+      if (fabsf(expected[i] - actual[i]) >
+          TOLERANCE * (1.0f + fabsf(expected[i]))) {
+        printf("%d -> %d sample %d: %.9g != %.9g\n", source_channels,
+               destination_channels, i, expected[i], actual[i]);
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+static double measure(mix_fn mix, float* destination, const float* source,
+                      int32_t source_channels, int32_t destination_channels,
+                      tau_channel_interpretation interpretation) {
+  memset(destination, 0, destination_channels * TAU_QUANTUM * sizeof(float));
+  int64_t iterations = 0;
+  double start = bench_now();
+  double elapsed;
+  do {
+    for (int i = 0; i < 10000; i++) {
+      mix(destination, destination_channels, source, source_channels,
+          interpretation, 1);
+    }
+    iterations += 10000;
+    elapsed = bench_now() - start;
+  } while (elapsed < BENCH_MIN_SECONDS);
+  bench_sink += (int64_t)destination[TAU_QUANTUM - 1];
+  return elapsed * 1e9 / (double)iterations;
+}
+
+int bench_mix(void) {
+  static const int32_t counts[] = {1, 2, 4, 6};
+  static const char* const names[] = {"speakers", "discrete"};
+  float* source = (float*)tau_aligned_alloc(6 * TAU_QUANTUM * sizeof(float),
+                                            TAU_CACHE_LINE);
+  float* expected = (float*)tau_aligned_alloc(
+      6 * TAU_QUANTUM * sizeof(float), TAU_CACHE_LINE);
+  float* actual = (float*)tau_aligned_alloc(6 * TAU_QUANTUM * sizeof(float),
+                                            TAU_CACHE_LINE);
+  if (source == NULL || expected == NULL || actual == NULL) {
+    tau_aligned_free(source);
+    tau_aligned_free(expected);
+    tau_aligned_free(actual);
+    return 1;
+  }
+  // Small samples keep the accumulated destination away from infinities.
+  fill(source, 6 * TAU_QUANTUM, 1);
+  for (int32_t i = 0; i < 6 * TAU_QUANTUM; i++) {
+    source[i] *= 1e-6f;
+  }
+  int status = 0;
+  printf("%-9s %4s %4s %12s %12s %8s %7s\n", "mix", "from", "to",
+         "generic ns", "special ns", "speedup", "check");
+  for (int interpretation = 0; interpretation < 2; interpretation++) {
+    for (size_t s = 0; s < sizeof(counts) / sizeof(counts[0]); s++) {
+      for (size_t d = 0; d < sizeof(counts) / sizeof(counts[0]); d++) {
+        tau_channel_interpretation mode =
+            interpretation == 0 ? TAU_INTERPRETATION_SPEAKERS
+                                : TAU_INTERPRETATION_DISCRETE;
+        int passed =
+            check(expected, actual, source, counts[s], counts[d], mode);
+        status |= !passed;
+        double generic = measure(tau_bus_mix_generic, actual, source,
+                                 counts[s], counts[d], mode);
+        double special =
+            measure(tau_bus_mix, actual, source, counts[s], counts[d], mode);
+        printf("%-9s %4d %4d %12.1f %12.1f %7.2fx %7s\n",
+               names[interpretation], counts[s], counts[d], generic, special,
+               generic / special, passed ? "ok" : "FAILED");
+        bench_metric(special, "ns", 0, "%s.%dto%d", names[interpretation],
+                     counts[s], counts[d]);
+      }
+    }
+  }
+  tau_aligned_free(source);
+  tau_aligned_free(expected);
+  tau_aligned_free(actual);
+  return status;
+}
@@ -0,0 +1,449 @@
+// How many panned sources one core renders in real time at 48 kHz, with
+// HRTF and equal-power panning.
+//
+// Sources loop over a second of noise, each through its own panner, at 2 to
+// 10 units around the listener, with a set of 1008 synthetic responses of
+// 200 frames, every 5 degrees of azimuth and 10 of elevation. Static sources
+// stay in place; moving ones orbit the listener at 30 to 180 degrees per
+// second, and move every video frame of 800 frames, as a game would move
+// them, which takes them to another cell every 5 to 30 quanta. The sources
+// per core count the whole graph; the panners alone are the graph less the
+// same one with gains in place of the panners.
+//
+// The benchmark fails if a source in the direction of a measurement does
+// not sound as the direct convolution with its responses, if one between
+// measurements does not sound as the direct convolution with the responses
+// interpolated from the three nearest, if the crossfade from one to the
+// other is not linear over a quantum, if the cache does not hold the two
+// cells, or if equal-power panning does not follow Web Audio.
+#include <math.h>
+#include <string.h>
+
+#include "bench.h"
+
+#define SAMPLE_RATE 48000
+#define QUANTUM TAU_RENDER_QUANTUM_FRAMES
+#define PI 3.14159265358979323846
+#define FRAMES 200
+#define AZIMUTH_STEP 5
+#define ELEVATIONS 14
+#define MEASUREMENTS (360 / AZIMUTH_STEP * ELEVATIONS)
+#define CHECK_FRAMES (100 * QUANTUM)
+// The quantum the checked source moves on.
+#define SWITCH_QUANTUM 50
+#define VIDEO_FRAMES 800
+#define SOURCES 128
+// The largest difference from the reference, relative to its peak.
+#define TOLERANCE 1e-5
+
+typedef struct database {
+  float left[MEASUREMENTS * FRAMES];
+  float right[MEASUREMENTS * FRAMES];
+  float azimuths[MEASUREMENTS];
+  float elevations[MEASUREMENTS];
+} database;
+
+static uint32_t next_random(uint32_t* state) {
+  *state = *state * 1664525u + 1013904223u;
+  return *state >> 8;
+}
+
+// Noise from -1 to 1.
+static float white(uint32_t* state) {
+  return (float)next_random(state) / 8388608.0f - 1.0f;
+}
+
+// Noise from 0 to 1.
+static float uniform(uint32_t* state) {
+  return (float)next_random(state) / 16777216.0f;
+}
+
+// Responses of a spherical head of sorts: the far ear hears later, softer
+// and duller, with a decaying tail of noise.
+static void fill_database(database* self) {
+  uint32_t state = 7;
+  for (int32_t i = 0; i < MEASUREMENTS; i++) {
+    float azimuth = (float)(i % (360 / AZIMUTH_STEP) * AZIMUTH_STEP);
+    float elevation = (float)(i / (360 / AZIMUTH_STEP) * 10 - 40);
+    self->azimuths[i] = azimuth;
+    self->elevations[i] = elevation;
+    double lateral =
+        sin(azimuth * PI / 180.0) * cos(elevation * PI / 180.0);
+    for (int32_t ear = 0; ear < 2; ear++) {
+      double side = ear == 0 ? -lateral : lateral;
+      int32_t delay = 20 + (int32_t)lround(14.0 * (1.0 - side));
+      double gain = 0.5 + 0.4 * side;
+      double decay = 6.0 + 8.0 * (1.0 - side);
+      float* response = (ear == 0 ? self->left : self->right) + i * FRAMES;
+      for (int32_t n = 0; n < FRAMES; n++) {
+        float value = white(&state);
+        response[n] =
+            n < delay ? 0.0f
+                      : (float)(gain * exp(-(n - delay) / decay) *
+                                (n == delay ? 1.0 : 0.5 * value));
+      }
+    }
+  }
+}
+
+static void unit(double azimuth, double elevation, double* vector) {
+  double a = azimuth * PI / 180.0;
+  double e = elevation * PI / 180.0;
+  vector[0] = cos(e) * sin(a);
+  vector[1] = sin(e);
+  vector[2] = -cos(e) * cos(a);
+}
+
+// The responses of the direction of `azimuth` and `elevation`, in degrees,
+// interpolated from the three nearest measurements by the inverse of their
+// angle, or the nearest alone if it is in that direction.
+static void interpolate(const database* self, double azimuth,
+                        double elevation, double* left, double* right) {
+  double centre[3];
+  unit(azimuth, elevation, centre);
+  int32_t nearest[3] = {0, 0, 0};
+  double angles[3] = {INFINITY, INFINITY, INFINITY};
+  for (int32_t i = 0; i < MEASUREMENTS; i++) {
+    double d[3];
+    unit(self->azimuths[i], self->elevations[i], d);
+    double dot = d[0] * centre[0] + d[1] * centre[1] + d[2] * centre[2];
+    double angle = acos(dot < 1.0 ? dot : 1.0);
+    int32_t k = 3;
+    for (; k > 0 && angles[k - 1] > angle; k--) {
+      if (k < 3) {
+        nearest[k] = nearest[k - 1];
+        angles[k] = angles[k - 1];
+      }
+    }
+    if (k < 3) {
+      nearest[k] = i;
+      angles[k] = angle;
+    }
+  }
+  double weights[3] = {1.0, 0.0, 0.0};
+  if (angles[0] > 1e-3) {
+    double total = 0.0;
+    for (int32_t k = 0; k < 3; k++) {
+      weights[k] = 1.0 / angles[k];
+      total += weights[k];
+    }
+    for (int32_t k = 0; k < 3; k++) {
+      weights[k] /= total;
+    }
+  }
+  for (int32_t n = 0; n < FRAMES; n++) {
+    left[n] = right[n] = 0.0;
+    for (int32_t k = 0; k < 3; k++) {
+      left[n] += weights[k] * self->left[nearest[k] * FRAMES + n];
+      right[n] += weights[k] * self->right[nearest[k] * FRAMES + n];
+    }
+  }
+}
+
+// `input` convolved with `response`, at frame `n`.
+static double convolve(const float* input, const double* response,
+                       int32_t n) {
+  double sum = 0.0;
+  for (int32_t k = 0; k < FRAMES && k <= n; k++) {
+    sum += response[k] * input[n - k];
+  }
+  return sum;
+}
+
+// Whether a panner of `hrtf` at 30 degrees then, from quantum
+// `SWITCH_QUANTUM`, at 33.4 degrees and 5.4 degrees up, sounds as the
+// direct convolutions, crossfading over the quantum in between.
+static int check_hrtf(const database* self, tau_hrtf* hrtf) {
+  static double before[2][FRAMES];
+  static double after[2][FRAMES];
+  // The panner rounds to the centres of cells of 2 degrees.
+  interpolate(self, 30.0, 0.0, before[0], before[1]);
+  interpolate(self, 34.0, 6.0, after[0], after[1]);
+  tau_context* context = tau_context_create(2, SAMPLE_RATE);
+  tau_audio_buffer* input = tau_audio_buffer_create(1, CHECK_FRAMES,
+                                                    SAMPLE_RATE);
+  float* output = (float*)malloc(2 * CHECK_FRAMES * sizeof(float));
+  int passed = context != NULL && input != NULL && output != NULL;
+  if (passed) {
+    uint32_t state = 3;
+    for (int32_t i = 0; i < CHECK_FRAMES; i++) {
+      input->data[i] = white(&state);
+    }
+    int32_t source = tau_buffer_source_create(context, input, 0);
+    int32_t panner = tau_panner_create(context, hrtf);
+    double a = 30.0 * PI / 180.0;
+    double moved = 33.4 * PI / 180.0;
+    double up = 5.4 * PI / 180.0;
+    double when = (double)SWITCH_QUANTUM * QUANTUM / SAMPLE_RATE;
+    passed =
+        source >= 0 && panner >= 0 &&
+        tau_param_set_value(context, panner, TAU_PARAM_POSITION_X,
+                            (float)sin(a)) == 0 &&
+        tau_param_set_value(context, panner, TAU_PARAM_POSITION_Z,
+                            (float)-cos(a)) == 0 &&
+        tau_param_set_value_at_time(context, panner, TAU_PARAM_POSITION_X,
+                                    (float)(cos(up) * sin(moved)),
+                                    when) == 0 &&
+        tau_param_set_value_at_time(context, panner, TAU_PARAM_POSITION_Y,
+                                    (float)sin(up), when) == 0 &&
+        tau_param_set_value_at_time(context, panner, TAU_PARAM_POSITION_Z,
+                                    (float)(-cos(up) * cos(moved)),
+                                    when) == 0 &&
+        tau_node_start(context, source, 0) == 0 &&
+        tau_node_connect(context, source, panner) == 0 &&
+        tau_node_connect(context, panner,
+                         tau_context_destination(context)) == 0 &&
+        tau_context_render(context, output, CHECK_FRAMES) == CHECK_FRAMES;
+  }
+  double error = 0.0;
+  double peak = 0.0;
+  for (int32_t ear = 0; passed && ear < 2; ear++) {
+    for (int32_t n = 0; n < CHECK_FRAMES; n++) {
+      double old = convolve(input->data, before[ear], n);
+      double t = (double)(n - SWITCH_QUANTUM * QUANTUM + 1) / QUANTUM;
+      t = t < 0.0 ? 0.0 : t > 1.0 ? 1.0 : t;
+      double expected = old + (convolve(input->data, after[ear], n) - old) * t;
+      double difference = fabs(output[ear * CHECK_FRAMES + n] - expected);
+      error = difference > error || difference != difference ? difference
+                                                             : error;
+      peak = fabs(expected) > peak ? fabs(expected) : peak;
+    }
+  }
+  int32_t cached = tau_hrtf_cached_cells(hrtf);
+  passed = passed && error <= TOLERANCE * peak && cached == 2;
+  printf("HRTF against direct convolution: %.2g of the peak, %d cells "
+         "cached%s\n",
+         peak > 0.0 ? error / peak : error, cached, passed ? "" : " FAILED");
+  tau_context_destroy(context);
+  tau_audio_buffer_release(input);
+  free(output);
+  return passed;
+}
+
+// Whether equal-power panning at 2 units to the front, the right and
+// behind on the left gives the gains of Web Audio.
+static int check_equal_power(void) {
+  static const float positions[3][3] = {
+      {0.0f, 0.0f, -2.0f}, {2.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 1.7320508f}};
+  // At azimuths 0, 90 and -150, which pans as -30.
+  double pans[3] = {0.25, 0.5, 1.0 / 6.0};
+  tau_audio_buffer* ones = tau_audio_buffer_create(1, QUANTUM, SAMPLE_RATE);
+  if (ones == NULL) {
+    return 0;
+  }
+  for (int32_t n = 0; n < QUANTUM; n++) {
+    ones->data[n] = 1.0f;
+  }
+  int passed = 1;
+  for (int32_t i = 0; i < 3; i++) {
+    tau_context* context = tau_context_create(2, SAMPLE_RATE);
+    float output[2 * QUANTUM];
+    int32_t constant = tau_buffer_source_create(context, ones, 1);
+    int32_t panner = tau_panner_create(context, NULL);
+    int ok = constant >= 0 && panner >= 0 &&
+             tau_node_start(context, constant, 0) == 0 &&
+             tau_node_connect(context, constant, panner) == 0 &&
+             tau_node_connect(context, panner,
+                              tau_context_destination(context)) == 0;
+    for (int32_t axis = 0; ok && axis < 3; axis++) {
+      ok = tau_param_set_value(context, panner, TAU_PARAM_POSITION_X + axis,
+                               positions[i][axis]) == 0;
+    }
+    ok = ok && tau_context_render(context, output, QUANTUM) == QUANTUM;
+    double expected[2] = {0.5 * cos(pans[i] * PI), 0.5 * sin(pans[i] * PI)};
+    for (int32_t ear = 0; ok && ear < 2; ear++) {
+      for (int32_t n = 0; n < QUANTUM; n++) {
+        ok = ok && fabs(output[ear * QUANTUM + n] - expected[ear]) < 1e-6;
+      }
+    }
+    passed = passed && ok;
+    tau_context_destroy(context);
+  }
+  tau_audio_buffer_release(ones);
+  printf("equal-power gains: %s\n", passed ? "ok" : "FAILED");
+  return passed;
+}
+
+typedef enum scene_kind {
+  SCENE_GAIN,
+  SCENE_EQUAL_POWER,
+  SCENE_HRTF,
+} scene_kind;
+
+typedef struct scene {
+  tau_context* context;
+  int32_t nodes[SOURCES];
+  float radii[SOURCES];
+  float heights[SOURCES];
+  float angles[SOURCES];
+  // Degrees per second, or 0 for static sources.
+  float speeds[SOURCES];
+  float* output;
+} scene;
+
+static void scene_destroy(scene* self) {
+  tau_context_destroy(self->context);
+  free(self->output);
+}
+
+// Moves the sources of `self` by `seconds`.
+static int scene_move(scene* self, double seconds) {
+  for (int32_t i = 0; i < SOURCES; i++) {
+    if (self->speeds[i] == 0.0f) {
+      continue;
+    }
+    self->angles[i] = fmodf(
+        self->angles[i] + self->speeds[i] * (float)seconds, 360.0f);
+    float a = self->angles[i] * (float)(PI / 180.0);
+    if (tau_param_set_value(self->context, self->nodes[i],
+                            TAU_PARAM_POSITION_X,
+                            self->radii[i] * sinf(a)) != 0 ||
+        tau_param_set_value(self->context, self->nodes[i],
+                            TAU_PARAM_POSITION_Z,
+                            -self->radii[i] * cosf(a)) != 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// `SOURCES` sources of `noise`, each through a panner of `kind`, at random
+// places, moving if `moving` is set.
+static int scene_create(scene* self, scene_kind kind, tau_hrtf* hrtf,
+                        tau_audio_buffer* noise, int moving) {
+  memset(self, 0, sizeof(*self));
+  self->context = tau_context_create(2, SAMPLE_RATE);
+  self->output = (float*)malloc(2 * VIDEO_FRAMES * sizeof(float));
+  if (self->context == NULL || self->output == NULL) {
+    return 0;
+  }
+  uint32_t state = 11;
+  for (int32_t i = 0; i < SOURCES; i++) {
+    int32_t source = tau_buffer_source_create(self->context, noise, 1);
+    int32_t node = kind == SCENE_GAIN
+                       ? tau_gain_create(self->context, 0.5f)
+                       : tau_panner_create(self->context,
+                                           kind == SCENE_HRTF ? hrtf : NULL);
+    self->nodes[i] = node;
+    self->radii[i] = 2.0f + 8.0f * uniform(&state);
+    self->heights[i] = 2.0f * white(&state);
+    self->angles[i] = 360.0f * uniform(&state);
+    self->speeds[i] =
+        moving && kind != SCENE_GAIN ? 30.0f + 150.0f * uniform(&state)
+                                     : 0.0f;
+    float a = self->angles[i] * (float)(PI / 180.0);
+    if (source < 0 || node < 0 ||
+        tau_node_start(self->context, source, 0) != 0 ||
+        tau_node_connect(self->context, source, node) != 0 ||
+        tau_node_connect(self->context, node,
+                         tau_context_destination(self->context)) != 0) {
+      return 0;
+    }
+    if (kind != SCENE_GAIN &&
+        (tau_param_set_value(self->context, node, TAU_PARAM_POSITION_X,
+                             self->radii[i] * sinf(a)) != 0 ||
+         tau_param_set_value(self->context, node, TAU_PARAM_POSITION_Y,
+                             self->heights[i]) != 0 ||
+         tau_param_set_value(self->context, node, TAU_PARAM_POSITION_Z,
+                             -self->radii[i] * cosf(a)) != 0)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// Seconds of rendering `self` per second of audio, moving the sources every
+// video frame.
+static double measure_scene(scene* self) {
+  int64_t frames = 0;
+  double start = bench_now();
+  double elapsed;
+  do {
+    if (!scene_move(self, (double)VIDEO_FRAMES / SAMPLE_RATE) ||
+        tau_context_render(self->context, self->output, VIDEO_FRAMES) !=
+            VIDEO_FRAMES) {
+      return -1.0;
+    }
+    frames += VIDEO_FRAMES;
+    elapsed = bench_now() - start;
+  } while (elapsed < BENCH_MIN_SECONDS || frames < SAMPLE_RATE);
+  bench_sink += (int64_t)(self->output[0] * 1000.0f);
+  return elapsed / ((double)frames / SAMPLE_RATE);
+}
+
+// Seconds of rendering per second of audio of the scene of `kind`.
+static double run_scene(scene_kind kind, tau_hrtf* hrtf,
+                        tau_audio_buffer* noise, int moving) {
+  scene self;
+  double seconds = scene_create(&self, kind, hrtf, noise, moving)
+                       ? measure_scene(&self)
+                       : -1.0;
+  scene_destroy(&self);
+  return seconds;
+}
+
+int bench_panner(void) {
+  database* self = (database*)malloc(sizeof(database));
+  if (self == NULL) {
+    return 1;
+  }
+  fill_database(self);
+  tau_hrtf* hrtf =
+      tau_hrtf_create(self->left, self->right, self->azimuths,
+                      self->elevations, MEASUREMENTS, FRAMES, SAMPLE_RATE);
+  tau_hrtf* checked =
+      tau_hrtf_create(self->left, self->right, self->azimuths,
+                      self->elevations, MEASUREMENTS, FRAMES, SAMPLE_RATE);
+  int status = hrtf == NULL || checked == NULL;
+  if (!status) {
+    status |= !check_hrtf(self, checked);
+    status |= !check_equal_power();
+  }
+  tau_hrtf_release(checked);
+  free(self);
+
+  tau_audio_buffer* noise = tau_audio_buffer_create(1, SAMPLE_RATE,
+                                                    SAMPLE_RATE);
+  if (status || noise == NULL) {
+    tau_hrtf_release(hrtf);
+    tau_audio_buffer_release(noise);
+    return 1;
+  }
+  uint32_t state = 5;
+  for (int32_t i = 0; i < SAMPLE_RATE; i++) {
+    noise->data[i] = 0.1f * white(&state);
+  }
+  double gains = run_scene(SCENE_GAIN, NULL, noise, 0);
+  printf("%d sources at 48 kHz, sources per core\n", SOURCES);
+  printf("%-22s %12s %12s %14s\n", "panning", "whole graph", "panners",
+         "us per source");
+  static const struct {
+    const char* name;
+    const char* metric;
+    scene_kind kind;
+    int moving;
+  } scenes[] = {
+      {"equal-power, static", "equalpower", SCENE_EQUAL_POWER, 0},
+      {"HRTF, static", "hrtf.static", SCENE_HRTF, 0},
+      {"HRTF, moving", "hrtf.moving", SCENE_HRTF, 1},
+  };
+  for (int32_t i = 0; i < 3 && gains > 0.0; i++) {
+    double seconds = run_scene(scenes[i].kind, hrtf, noise, scenes[i].moving);
+    if (seconds < 0.0) {
+      printf("%-22s FAILED\n", scenes[i].name);
+      status = 1;
+      continue;
+    }
+    // Per second of audio, hence microseconds per source and second.
+    double panners = seconds - gains;
+    printf("%-22s %12.0f %12.0f %14.1f\n", scenes[i].name,
+           SOURCES / seconds, SOURCES / panners, panners * 1e6 / SOURCES);
+    bench_metric(SOURCES / seconds, "sources/core", 1, "%s",
+                 scenes[i].metric);
+  }
+  printf("cells cached after the moving sources: %d\n",
+         tau_hrtf_cached_cells(hrtf));
+  tau_hrtf_release(hrtf);
+  tau_audio_buffer_release(noise);
+  return gains > 0.0 ? status : 1;
+}
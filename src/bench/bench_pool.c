@@ -0,0 +1,96 @@
+// Throughput of N concurrent long-running jobs on the native worker pool.
+//
+// The baseline runs the jobs one after another on a single thread, which is
+// what the helper isolate behind `sumAsync` used to do. Jobs spin on the CPU
+// rather than sleep so that the scaling reflects the available cores.
+#include "bench.h"
+#include "tau_pool.h"
+
+#define JOB_COUNT 64
+#define JOB_ITERATIONS 2000000
+
+typedef struct bench_job {
+  tau_task task;
+  volatile int64_t* remaining;
+  tau_mutex* mutex;
+  tau_cond* done;
+  int64_t result;
+} bench_job;
+
+static int64_t long_running_work(int64_t seed) {
+  uint64_t x = (uint64_t)seed + 1;
+  for (int i = 0; i < JOB_ITERATIONS; i++) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+  }
+  return (int64_t)x;
+}
+
+static void run_bench_job(tau_task* task) {
+  bench_job* job = (bench_job*)task;
+  job->result = long_running_work(job->result);
+  if (tau_atomic_fetch_add_i64(job->remaining, -1) == 1) {
+    tau_mutex_lock(job->mutex);
+    tau_cond_signal(job->done);
+    tau_mutex_unlock(job->mutex);
+  }
+}
+
+static double measure_serial(void) {
+  double start = bench_now();
+  // Chaining the results keeps the compiler from interleaving the jobs, which
+  // a single isolate making blocking calls cannot do either.
+  int64_t value = 0;
+  for (int i = 0; i < JOB_COUNT; i++) {
+    value = long_running_work(value + i);
+  }
+  bench_sink = value;
+  return JOB_COUNT / (bench_now() - start);
+}
+
+static double measure_pool(tau_pool* pool) {
+  static bench_job jobs[JOB_COUNT];
+  volatile int64_t remaining = JOB_COUNT;
+  tau_mutex mutex;
+  tau_cond done;
+  tau_mutex_init(&mutex);
+  tau_cond_init(&done);
+  double start = bench_now();
+  for (int i = 0; i < JOB_COUNT; i++) {
+    jobs[i].task.run = run_bench_job;
+    jobs[i].remaining = &remaining;
+    jobs[i].mutex = &mutex;
+    jobs[i].done = &done;
+    jobs[i].result = i;
+    tau_pool_submit(pool, &jobs[i].task);
+  }
+  tau_mutex_lock(&mutex);
+  while (tau_atomic_load_i64(&remaining) != 0) {
+    tau_cond_wait(&done, &mutex);
+  }
+  tau_mutex_unlock(&mutex);
+  double elapsed = bench_now() - start;
+  tau_cond_destroy(&done);
+  tau_mutex_destroy(&mutex);
+  return JOB_COUNT / elapsed;
+}
+
+int bench_pool(void) {
+  int cores = tau_cpu_count();
+  double serial = measure_serial();
+  printf("%d jobs, %d cores\n", JOB_COUNT, cores);
+  printf("%10s %12s %8s\n", "threads", "jobs/s", "speedup");
+  printf("%10s %12.1f %7.2fx\n", "serial", serial, 1.0);
+  for (int threads = 1; threads <= cores * 2; threads *= 2) {
+    tau_pool* pool = tau_pool_create(threads);
+    if (pool == NULL) {
+      fprintf(stderr, "tau_pool_create(%d) failed\n", threads);
+      return 1;
+    }
+    double pooled = measure_pool(pool);
+    tau_pool_destroy(pool);
+    printf("%10d %12.1f %7.2fx\n", threads, pooled, pooled / serial);
+  }
+  return 0;
+}
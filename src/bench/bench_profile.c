@@ -0,0 +1,176 @@
+// What the render timings of `tau_profile` report, and what recording them
+// costs.
+//
+// The graph is 64 oscillator voices, each through its own gain, and a
+// convolver with a one-second impulse response on the mix: the node a
+// profile should single out. After rendering it, the benchmark prints the
+// quantum histogram and the heaviest nodes, and checks that every quantum
+// and every node counted each quantum once, and that the nodes took no
+// longer than the quanta they rendered in. It fails otherwise.
+//
+// Recording costs a read of the monotonic clock per node and two per
+// quantum, timed here on their own; comparing a run of `tau_ffi_bench
+// render` against a build with `-DTAU_FFI_PROFILING=OFF` measures the whole
+// of it.
+#include "bench.h"
+#include "tau_platform.h"
+
+#define SAMPLE_RATE 48000
+#define VOICES 64
+#define QUANTA 5000
+#define HEAVIEST 3
+
+// A handle and the timings read for it.
+typedef struct entry {
+  int32_t node;
+  const char* name;
+  tau_profile profile;
+} entry;
+
+// The voices, then the convolver, in `nodes`. Returns the node count, or -1.
+static int32_t create_graph(tau_context* context, tau_audio_buffer* impulse,
+                            entry* nodes) {
+  int32_t count = 0;
+  int32_t convolver = tau_convolver_create(context, impulse, 1);
+  if (convolver < 0 || tau_node_connect(context, convolver,
+                                        tau_context_destination(context)) !=
+                           TAU_OK) {
+    return -1;
+  }
+  for (int32_t i = 0; i < VOICES; i++) {
+    int32_t oscillator =
+        tau_oscillator_create(context, i % 4, 55.0f * (1 + i % 16));
+    int32_t gain = tau_gain_create(context, 0.5f / VOICES);
+    if (oscillator < 0 || gain < 0 ||
+        tau_node_connect(context, oscillator, gain) != TAU_OK ||
+        tau_node_connect(context, gain, convolver) != TAU_OK ||
+        tau_node_start(context, oscillator, 0) != TAU_OK) {
+      return -1;
+    }
+    nodes[count++] = (entry){oscillator, "oscillator", {0}};
+    nodes[count++] = (entry){gain, "gain", {0}};
+  }
+  nodes[count++] = (entry){convolver, "convolver", {0}};
+  nodes[count++] =
+      (entry){tau_context_destination(context), "destination", {0}};
+  return count;
+}
+
+static double mean_us(const tau_profile* profile) {
+  return profile->count > 0
+             ? (double)profile->total_ns / (double)profile->count * 1e-3
+             : 0.0;
+}
+
+// Checks the bookkeeping of `profile`, which must count `quanta` quanta.
+static int consistent(const tau_profile* profile, int64_t quanta) {
+  int64_t counted = 0;
+  for (int32_t i = 0; i < TAU_PROFILE_BUCKETS; i++) {
+    counted += profile->buckets[i];
+  }
+  return profile->count == quanta && counted == quanta &&
+         profile->max_ns * quanta >= profile->total_ns &&
+         profile->underruns <= quanta;
+}
+
+// The cost of a clock read.
+static double clock_read_ns(void) {
+  int64_t iterations = 0;
+  int64_t sum = 0;
+  double start = bench_now();
+  double elapsed;
+  do {
+    for (int32_t i = 0; i < 10000; i++) {
+      sum += tau_now_ns();
+    }
+    iterations += 10000;
+    elapsed = bench_now() - start;
+  } while (elapsed < BENCH_MIN_SECONDS);
+  bench_sink += sum;
+  return elapsed * 1e9 / (double)iterations;
+}
+
+int bench_profile(void) {
+  tau_context* context = tau_context_create(2, SAMPLE_RATE);
+  tau_audio_buffer* impulse = tau_audio_buffer_create(2, SAMPLE_RATE,
+                                                      SAMPLE_RATE);
+  tau_audio_buffer* output =
+      tau_audio_buffer_create(2, TAU_RENDER_QUANTUM_FRAMES, SAMPLE_RATE);
+  entry* nodes = (entry*)calloc(VOICES * 2 + 2, sizeof(entry));
+  int status = context == NULL || impulse == NULL || output == NULL ||
+               nodes == NULL;
+  int32_t node_count = 0;
+  if (status == 0) {
+    uint32_t seed = 1;
+    for (int32_t i = 0; i < impulse->channels * impulse->stride; i++) {
+      seed = seed * 1664525u + 1013904223u;
+      impulse->data[i] = ((float)(seed >> 8) / 16777216.0f - 0.5f) *
+                         (1.0f - (float)(i % impulse->stride) / SAMPLE_RATE);
+    }
+    node_count = create_graph(context, impulse, nodes);
+    status = node_count < 0;
+  }
+  tau_profile quanta;
+  int32_t profiled = status == 0
+                         ? tau_context_get_profile(context, &quanta)
+                         : TAU_ERROR_INVALID_ARGUMENT;
+  if (profiled == TAU_ERROR_NOT_SUPPORTED) {
+    printf("profiling is compiled out (TAU_FFI_PROFILING=OFF)\n");
+  } else if (status == 0) {
+    double start = bench_now();
+    for (int32_t q = 0; q < QUANTA; q++) {
+      tau_context_render_buffer(context, output);
+    }
+    double wall_ns = (bench_now() - start) * 1e9;
+    tau_context_get_profile(context, &quanta);
+    int passed = consistent(&quanta, QUANTA) && quanta.total_ns <= wall_ns;
+    int64_t nodes_ns = 0;
+    for (int32_t i = 0; i < node_count; i++) {
+      passed &= tau_node_get_profile(context, nodes[i].node,
+                                     &nodes[i].profile) == TAU_OK &&
+                consistent(&nodes[i].profile, QUANTA);
+      nodes_ns += nodes[i].profile.total_ns;
+    }
+    passed &= nodes_ns <= quanta.total_ns;
+    status = !passed;
+
+    printf("%d nodes, %d quanta; the deadline is %.1f us\n", node_count,
+           QUANTA, quanta.deadline_ns * 1e-3);
+    printf("quanta: mean %.2f us, max %.2f us, %lld underruns\n",
+           mean_us(&quanta), quanta.max_ns * 1e-3,
+           (long long)quanta.underruns);
+    printf("%-16s %9s\n", "histogram", "quanta");
+    for (int32_t i = 0; i < TAU_PROFILE_BUCKETS; i++) {
+      if (quanta.buckets[i] > 0) {
+        printf("< %-11.2f us %9lld\n", ((int64_t)2 << i) * 1e-3,
+               (long long)quanta.buckets[i]);
+      }
+    }
+    printf("%-12s %9s %9s %9s %7s\n", "node", "mean us", "max us", "share",
+           "over");
+    for (int32_t k = 0; k < HEAVIEST && k < node_count; k++) {
+      // Selection of the next heaviest node.
+      for (int32_t i = k + 1; i < node_count; i++) {
+        if (nodes[i].profile.total_ns > nodes[k].profile.total_ns) {
+          entry heavier = nodes[i];
+          nodes[i] = nodes[k];
+          nodes[k] = heavier;
+        }
+      }
+      const tau_profile* profile = &nodes[k].profile;
+      printf("%-12s %9.2f %9.2f %8.1f%% %7lld\n", nodes[k].name,
+             mean_us(profile), profile->max_ns * 1e-3,
+             100.0 * (double)profile->total_ns / (double)quanta.total_ns,
+             (long long)profile->underruns);
+    }
+    double read_ns = clock_read_ns();
+    printf("recording: %.1f ns per clock read, %.2f%% of a quantum\n",
+           read_ns, 100.0 * read_ns * (node_count + 2) / (wall_ns / QUANTA));
+    printf("check: %s\n", passed ? "ok" : "FAILED");
+  }
+  free(nodes);
+  tau_audio_buffer_release(impulse);
+  tau_audio_buffer_release(output);
+  tau_context_destroy(context);
+  return status;
+}
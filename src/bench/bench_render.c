@@ -0,0 +1,102 @@
+// Offline rendering speed of a reference graph, as a multiple of realtime.
+//
+// The graph is a small synthesizer: oscillators of every waveform and looping
+// buffer sources, each through its own gain, mixed into a stereo destination
+// at 48 kHz. A multiple of 100 means one second of audio renders in 10 ms.
+#include <math.h>
+
+#include "bench.h"
+
+#define SAMPLE_RATE 48000
+#define CHANNELS 2
+#define RENDER_SECONDS 60
+#define CHUNK_FRAMES 4800
+#define BUFFER_FRAMES 4096
+
+static int add_voice(tau_context* context, int32_t source, float gain) {
+  int32_t node = tau_gain_create(context, gain);
+  if (source < 0 || node < 0 || tau_node_connect(context, source, node) != 0 ||
+      tau_node_connect(context, node, tau_context_destination(context)) != 0 ||
+      tau_node_start(context, source, 0) != 0) {
+    return 1;
+  }
+  return 0;
+}
+
+// Builds `oscillators` oscillators and `buffers` stereo buffer sources.
+static tau_context* create_graph(int32_t oscillators, int32_t buffers,
+                                 tau_audio_buffer* samples) {
+  tau_context* context = tau_context_create(CHANNELS, SAMPLE_RATE);
+  if (context == NULL) {
+    return NULL;
+  }
+  int failed = 0;
+  for (int32_t i = 0; i < oscillators; i++) {
+    int32_t oscillator =
+        tau_oscillator_create(context, i % 4, 110.0f * (1 + i % 12));
+    failed |= add_voice(context, oscillator, 0.5f / oscillators);
+  }
+  for (int32_t i = 0; i < buffers; i++) {
+    int32_t source = tau_buffer_source_create(context, samples, 1);
+    failed |= add_voice(context, source, 0.5f / buffers);
+    if (source >= 0) {
+      tau_param_set_value(context, source, TAU_PARAM_PLAYBACK_RATE,
+                          0.5f + 0.1f * i);
+    }
+  }
+  if (failed) {
+    tau_context_destroy(context);
+    return NULL;
+  }
+  return context;
+}
+
+static int run(int32_t oscillators, int32_t buffers, tau_audio_buffer* samples,
+               tau_audio_buffer* output) {
+  tau_context* context = create_graph(oscillators, buffers, samples);
+  if (context == NULL) {
+    return 1;
+  }
+  int64_t frames = (int64_t)RENDER_SECONDS * SAMPLE_RATE;
+  double start = bench_now();
+  for (int64_t done = 0; done < frames; done += CHUNK_FRAMES) {
+    tau_context_render_buffer(context, output);
+  }
+  double elapsed = bench_now() - start;
+  bench_sink += (int64_t)(output->data[CHUNK_FRAMES - 1] * 1000);
+  tau_context_destroy(context);
+  printf("%12d %8d %12.2f %12.1f\n", oscillators, buffers,
+         elapsed * 1e3 / RENDER_SECONDS, RENDER_SECONDS / elapsed);
+  bench_metric(RENDER_SECONDS / elapsed, "x realtime", 1, "%dx%d",
+               oscillators, buffers);
+  return 0;
+}
+
+int bench_render(void) {
+  tau_audio_buffer* samples =
+      tau_audio_buffer_create(CHANNELS, BUFFER_FRAMES, 44100);
+  tau_audio_buffer* output =
+      tau_audio_buffer_create(CHANNELS, CHUNK_FRAMES, SAMPLE_RATE);
+  if (samples == NULL || output == NULL) {
+    tau_audio_buffer_release(samples);
+    tau_audio_buffer_release(output);
+    return 1;
+  }
+  for (int32_t c = 0; c < CHANNELS; c++) {
+    for (int32_t i = 0; i < BUFFER_FRAMES; i++) {
+      samples->data[c * samples->stride + i] =
+          (float)sin((c + 1) * i * 0.01) * (i % 7 == 0 ? 0.5f : 1.0f);
+    }
+  }
+  int status = 0;
+  printf("%12s %8s %12s %12s\n", "oscillators", "buffers", "ms per s",
+         "x realtime");
+  status |= run(1, 0, samples, output);
+  status |= run(8, 0, samples, output);
+  status |= run(0, 8, samples, output);
+  // The reference graph.
+  status |= run(32, 8, samples, output);
+  tau_audio_buffer_release(samples);
+  tau_audio_buffer_release(output);
+  return status;
+}
@@ -0,0 +1,152 @@
+// The results of a run, as JSON, and their comparison with a baseline.
+//
+// Benchmarks record their headline numbers with `bench_metric` as they print
+// them. `--json` writes them to a file, one metric per line:
+//
+//   {"name": "render.32x8", "value": 245.1, "unit": "x realtime",
+//    "better": "higher"},
+//
+// and `--baseline` reads such a file back, so that a run fails when a
+// metric is worse than in the baseline by more than the threshold. Only
+// files written by `--json` need to be read, so the reader looks for the
+// name and value of every line rather than parsing JSON in general.
+#include <math.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "bench.h"
+#include "tau_kernels.h"
+
+#define MAX_METRICS 1024
+#define MAX_NAME 96
+
+typedef struct metric {
+  char name[MAX_NAME];
+  double value;
+  const char* unit;
+  int higher_is_better;
+} metric;
+
+static metric metrics[MAX_METRICS];
+static int32_t metric_count;
+static const char* current_benchmark = "";
+
+void bench_report_begin(const char* benchmark) {
+  current_benchmark = benchmark;
+}
+
+void bench_metric(double value, const char* unit, int higher_is_better,
+                  const char* format, ...) {
+  if (metric_count == MAX_METRICS) {
+    return;
+  }
+  metric* entry = &metrics[metric_count++];
+  int length = snprintf(entry->name, MAX_NAME, "%s.", current_benchmark);
+  va_list arguments;
+  va_start(arguments, format);
+  vsnprintf(entry->name + length, MAX_NAME - length, format, arguments);
+  va_end(arguments);
+  entry->value = value;
+  entry->unit = unit;
+  entry->higher_is_better = higher_is_better;
+}
+
+int bench_report_write(const char* path) {
+  FILE* file = fopen(path, "w");
+  if (file == NULL) {
+    fprintf(stderr, "Cannot write %s\n", path);
+    return 1;
+  }
+  fprintf(file, "{\n  \"kernels\": \"%s\",\n  \"metrics\": [\n",
+          tau_kernels()->name);
+  for (int32_t i = 0; i < metric_count; i++) {
+    fprintf(file,
+            "    {\"name\": \"%s\", \"value\": %.9g, \"unit\": \"%s\", "
+            "\"better\": \"%s\"}%s\n",
+            metrics[i].name, metrics[i].value, metrics[i].unit,
+            metrics[i].higher_is_better ? "higher" : "lower",
+            i + 1 < metric_count ? "," : "");
+  }
+  fprintf(file, "  ]\n}\n");
+  int failed = ferror(file);
+  failed |= fclose(file) != 0;
+  if (failed) {
+    fprintf(stderr, "Cannot write %s\n", path);
+  }
+  return failed;
+}
+
+// Reads the metric of `line`, a line written by `bench_report_write`, into
+// `name` and `*value`. Returns 0 if the line holds none.
+static int parse_line(const char* line, char* name, double* value) {
+  static const char name_key[] = "\"name\": \"";
+  static const char value_key[] = "\"value\": ";
+  const char* start = strstr(line, name_key);
+  if (start == NULL) {
+    return 0;
+  }
+  start += sizeof(name_key) - 1;
+  const char* end = strchr(start, '"');
+  const char* number = strstr(line, value_key);
+  if (end == NULL || end - start >= MAX_NAME || number == NULL) {
+    return 0;
+  }
+  memcpy(name, start, (size_t)(end - start));
+  name[end - start] = '\0';
+  char* parsed;
+  *value = strtod(number + sizeof(value_key) - 1, &parsed);
+  return parsed != number + sizeof(value_key) - 1;
+}
+
+// How much worse `current` is than `baseline`, as a fraction of the
+// baseline: positive for a regression. A metric whose baseline is 0, such
+// as an allocation count, regresses by any amount.
+static double regression(const metric* current, double baseline) {
+  double worse = current->higher_is_better ? baseline - current->value
+                                           : current->value - baseline;
+  if (baseline == 0.0) {
+    return worse > 0.0 ? INFINITY : 0.0;
+  }
+  return worse / fabs(baseline);
+}
+
+int bench_report_compare(const char* path, double threshold) {
+  FILE* file = fopen(path, "r");
+  if (file == NULL) {
+    fprintf(stderr, "Cannot read %s\n", path);
+    return 1;
+  }
+  printf("== baseline %s, threshold %.0f%% ==\n", path, threshold * 100.0);
+  printf("%-40s %14s %14s %9s %10s\n", "metric", "baseline", "current",
+         "change", "status");
+  int32_t compared = 0;
+  int32_t regressions = 0;
+  char line[512];
+  char name[MAX_NAME];
+  double baseline;
+  while (fgets(line, sizeof(line), file) != NULL) {
+    if (!parse_line(line, name, &baseline)) {
+      continue;
+    }
+    for (int32_t i = 0; i < metric_count; i++) {
+      if (strcmp(metrics[i].name, name) != 0) {
+        continue;
+      }
+      double worse = regression(&metrics[i], baseline);
+      int regressed = worse > threshold;
+      double change = baseline != 0.0
+                          ? (metrics[i].value - baseline) / fabs(baseline)
+                          : 0.0;
+      printf("%-40s %14.6g %14.6g %+8.1f%% %10s\n", name, baseline,
+             metrics[i].value, change * 100.0,
+             regressed ? "REGRESSED" : "ok");
+      compared++;
+      regressions += regressed;
+      break;
+    }
+  }
+  fclose(file);
+  printf("%d of %d metrics compared, %d regressed\n", compared,
+         metric_count, regressions);
+  return regressions > 0;
+}
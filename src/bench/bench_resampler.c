@@ -0,0 +1,152 @@
+// Throughput and stopband attenuation of the resampler at every quality.
+//
+// The throughput is measured in millions of output frames per second of a
+// mono signal, for the usual conversions between 44.1, 48 and 96 kHz.
+//
+// The attenuation is measured by converting sines from the stopband: above
+// the output Nyquist frequency when converting down, where they would alias,
+// and reporting the loudest of what comes out, relative to the input. The
+// benchmark fails if a filter quality does not reach the attenuation it
+// documents, or changes the level of a 1 kHz sine by more than 0.01 dB.
+#include <math.h>
+
+#include "bench.h"
+#include "tau_resampler.h"
+
+#define BLOCK 512
+#define MEASURE_FRAMES 16384
+#define SETTLE_FRAMES 4096
+
+typedef struct conversion {
+  double from;
+  double to;
+} conversion;
+
+static const conversion conversions[] = {
+    {44100, 48000}, {48000, 44100}, {96000, 48000}, {48000, 96000}};
+
+#define CONVERSION_COUNT (int)(sizeof(conversions) / sizeof(conversions[0]))
+
+static const char* const quality_names[] = {"linear", "low", "medium",
+                                            "high"};
+
+// The stopband attenuation each filter quality documents, in decibels.
+static const double documented[] = {0.0, 60.0, 90.0, 120.0};
+
+// Converts a sine of `frequency` hertz and returns the level of the output
+// relative to the input, in decibels.
+static double sine_gain(int32_t quality, const conversion* conversion,
+                        double frequency) {
+  tau_resampler resampler;
+  if (tau_resampler_init(&resampler, quality, 1,
+                         conversion->from / conversion->to,
+                         BLOCK) != TAU_OK) {
+    tau_resampler_destroy(&resampler);
+    return 0.0;
+  }
+  const double pi = 3.14159265358979323846;
+  double increment = 2.0 * pi * frequency / conversion->from;
+  double phase = 0.0;
+  double energy = 0.0;
+  float output[BLOCK];
+  for (int32_t done = 0; done < SETTLE_FRAMES + MEASURE_FRAMES;
+       done += BLOCK) {
+    int32_t needed = tau_resampler_needed(&resampler, BLOCK);
+    float* input = tau_resampler_input(&resampler);
+    for (int32_t i = 0; i < needed; i++) {
+      input[i] = (float)sin(phase);
+      phase = fmod(phase + increment, 2.0 * pi);
+    }
+    tau_resampler_commit(&resampler, needed);
+    tau_resampler_process(&resampler, output, BLOCK, BLOCK);
+    for (int32_t i = 0; done >= SETTLE_FRAMES && i < BLOCK; i++) {
+      energy += (double)output[i] * output[i];
+    }
+  }
+  tau_resampler_destroy(&resampler);
+  // A unit sine has a mean power of 1/2.
+  return 10.0 * log10(energy / MEASURE_FRAMES / 0.5 + 1e-30);
+}
+
+// The loudest stopband sine for `conversion`, in decibels.
+static double stopband_gain(int32_t quality, const conversion* conversion) {
+  double nyquist = conversion->to / 2.0;
+  double worst = -1000.0;
+  for (double frequency = nyquist + 100.0;
+       frequency < conversion->from / 2.0; frequency += 211.0) {
+    double gain = sine_gain(quality, conversion, frequency);
+    worst = gain > worst ? gain : worst;
+  }
+  return worst;
+}
+
+// Millions of output frames per second.
+static double throughput(int32_t quality, const conversion* conversion) {
+  tau_resampler resampler;
+  if (tau_resampler_init(&resampler, quality, 1,
+                         conversion->from / conversion->to,
+                         BLOCK) != TAU_OK) {
+    tau_resampler_destroy(&resampler);
+    return 0.0;
+  }
+  float output[BLOCK];
+  uint32_t seed = 1;
+  int64_t frames = 0;
+  double start = bench_now();
+  double elapsed;
+  do {
+    int32_t needed = tau_resampler_needed(&resampler, BLOCK);
+    float* input = tau_resampler_input(&resampler);
+    for (int32_t i = 0; i < needed; i++) {
+      seed = seed * 1664525u + 1013904223u;
+      input[i] = (float)(seed >> 8) / (float)(1 << 23) - 1.0f;
+    }
+    tau_resampler_commit(&resampler, needed);
+    tau_resampler_process(&resampler, output, BLOCK, BLOCK);
+    frames += BLOCK;
+    elapsed = bench_now() - start;
+  } while (elapsed < BENCH_MIN_SECONDS);
+  bench_sink += (int64_t)output[BLOCK - 1];
+  tau_resampler_destroy(&resampler);
+  return (double)frames / elapsed / 1e6;
+}
+
+int bench_resampler(void) {
+  int status = 0;
+  printf("kernels: %s\n", tau_kernels()->name);
+  printf("%-8s", "quality");
+  for (int c = 0; c < CONVERSION_COUNT; c++) {
+    printf("   %3.0fk>%3.0fk", conversions[c].from / 1000,
+           conversions[c].to / 1000);
+  }
+  printf("   Mframes/s\n");
+  for (int32_t quality = TAU_RESAMPLER_LINEAR; quality <= TAU_RESAMPLER_HIGH;
+       quality++) {
+    printf("%-8s", quality_names[quality]);
+    for (int c = 0; c < CONVERSION_COUNT; c++) {
+      double rate = throughput(quality, &conversions[c]);
+      printf(" %11.1f", rate);
+      bench_metric(rate, "Mframes/s", 1, "%s.%.0fkto%.0fk",
+                   quality_names[quality], conversions[c].from / 1000,
+                   conversions[c].to / 1000);
+    }
+    printf("\n");
+  }
+  printf("\n%-8s %16s %16s %12s %8s\n", "quality", "stop 96k>48k dB",
+         "stop 48k>44k dB", "1 kHz dB", "check");
+  for (int32_t quality = TAU_RESAMPLER_LINEAR; quality <= TAU_RESAMPLER_HIGH;
+       quality++) {
+    double halving = stopband_gain(quality, &conversions[2]);
+    double down = stopband_gain(quality, &conversions[1]);
+    double passband = sine_gain(quality, &conversions[0], 1000.0);
+    // Linear interpolation documents no attenuation and dulls the passband.
+    int linear = quality == TAU_RESAMPLER_LINEAR;
+    int passed = linear || (-halving >= documented[quality] &&
+                            -down >= documented[quality] &&
+                            fabs(passband) <= 0.01);
+    status |= !passed;
+    printf("%-8s %16.1f %16.1f %12.4f %8s\n", quality_names[quality], halving,
+           down, passband, linear ? "-" : passed ? "ok" : "FAILED");
+  }
+  return status;
+}
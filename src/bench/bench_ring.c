@@ -0,0 +1,287 @@
+// Round-trip latency of requests through a `tau_ring` at fixed request rates.
+//
+// The baseline models the message path `sumAsync` used before the ring: each
+// request and each response is a separately allocated message, handed over
+// through a locked queue to a helper thread and back. The Dart side of either
+// path cannot run here; the main thread plays its part, submitting requests
+// at the target rate and draining responses in between.
+//
+// Before measuring, a request of `TAU_OP_SUM_LONG_RUNNING` goes into a ring
+// of 4 slots ahead of quick ones, which complete before it when the pool has
+// two threads or more: the benchmark fails if its slot can be submitted
+// again before its result is released, which takes 5 seconds, or if a
+// result past the first lap of the ring does not match its request.
+#include <string.h>
+
+#include "bench.h"
+#include "tau_platform.h"
+#include "tau_pool.h"
+
+#define RING_CAPACITY 4096
+#define MAX_REQUESTS 200000
+#define RUN_SECONDS 0.5
+
+typedef struct message {
+  struct message* next;
+  int64_t id;
+  int32_t a;
+  int32_t b;
+  int32_t result;
+} message;
+
+typedef struct message_queue {
+  tau_mutex mutex;
+  tau_cond ready;
+  message* head;
+  message* tail;
+} message_queue;
+
+static void queue_init(message_queue* queue) {
+  tau_mutex_init(&queue->mutex);
+  tau_cond_init(&queue->ready);
+  queue->head = NULL;
+  queue->tail = NULL;
+}
+
+static void queue_destroy(message_queue* queue) {
+  tau_cond_destroy(&queue->ready);
+  tau_mutex_destroy(&queue->mutex);
+}
+
+static void queue_push(message_queue* queue, message* item) {
+  item->next = NULL;
+  tau_mutex_lock(&queue->mutex);
+  if (queue->tail != NULL) {
+    queue->tail->next = item;
+  } else {
+    queue->head = item;
+  }
+  queue->tail = item;
+  tau_cond_signal(&queue->ready);
+  tau_mutex_unlock(&queue->mutex);
+}
+
+static message* queue_pop(message_queue* queue, int wait) {
+  tau_mutex_lock(&queue->mutex);
+  while (wait && queue->head == NULL) {
+    tau_cond_wait(&queue->ready, &queue->mutex);
+  }
+  message* item = queue->head;
+  if (item != NULL) {
+    queue->head = item->next;
+    if (queue->head == NULL) {
+      queue->tail = NULL;
+    }
+  }
+  tau_mutex_unlock(&queue->mutex);
+  return item;
+}
+
+typedef struct helper {
+  message_queue requests;
+  message_queue responses;
+} helper;
+
+// A request with a negative id stops the helper.
+static void helper_main(void* arg) {
+  helper* self = (helper*)arg;
+  for (;;) {
+    message* request = queue_pop(&self->requests, 1);
+    if (request->id < 0) {
+      free(request);
+      return;
+    }
+    message* response = (message*)malloc(sizeof(message));
+    response->id = request->id;
+    response->result = sum(request->a, request->b);
+    free(request);
+    queue_push(&self->responses, response);
+  }
+}
+
+static int compare_doubles(const void* a, const void* b) {
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+static void report(const char* path, double rate, double* latencies,
+                   int64_t count) {
+  qsort(latencies, (size_t)count, sizeof(double), compare_doubles);
+  printf("%10.0f %8s %10.2f %10.2f\n", rate, path,
+         latencies[count / 2] * 1e6, latencies[count * 99 / 100] * 1e6);
+  bench_metric(latencies[count / 2] * 1e6, "us", 0, "%s.%.0f.p50", path,
+               rate);
+}
+
+static int64_t request_count(double rate) {
+  int64_t count = (int64_t)(rate * RUN_SECONDS);
+  return count > MAX_REQUESTS ? MAX_REQUESTS : count;
+}
+
+static void run_ring(double rate, double* submitted, double* latencies) {
+  int64_t count = request_count(rate);
+  tau_ring* ring = tau_ring_create(RING_CAPACITY, 0);
+  tau_ring_request* requests = tau_ring_requests(ring);
+  tau_ring_completion* completions = tau_ring_completions(ring);
+  int64_t mask = tau_ring_capacity(ring) - 1;
+  // Whether each slot holds a request whose result is not yet released.
+  static char taken[RING_CAPACITY];
+  memset(taken, 0, sizeof(taken));
+  int64_t sent = 0;
+  int64_t received = 0;
+  double start = bench_now();
+  while (received < count) {
+    double now = bench_now();
+    if (sent < count && !taken[sent & mask] &&
+        now >= start + (double)sent / rate) {
+      taken[sent & mask] = 1;
+      tau_ring_request* request = &requests[sent & mask];
+      request->opcode = TAU_OP_SUM;
+      request->a = (int32_t)sent;
+      request->b = 1;
+      submitted[sent] = now;
+      tau_ring_submit(ring, ++sent);
+    }
+    int32_t ready = tau_ring_poll(ring);
+    if (ready == 0) {
+      tau_thread_yield();
+      continue;
+    }
+    now = bench_now();
+    for (int32_t i = 0; i < ready; i++) {
+      const tau_ring_completion* completion =
+          &completions[(received + i) & mask];
+      latencies[received + i] = now - submitted[completion->sequence];
+      taken[completion->sequence & mask] = 0;
+    }
+    received += ready;
+    tau_ring_release(ring, ready);
+  }
+  tau_ring_destroy(ring);
+  report("ring", rate, latencies, count);
+}
+
+static void run_messages(double rate, double* submitted, double* latencies) {
+  int64_t count = request_count(rate);
+  helper self;
+  queue_init(&self.requests);
+  queue_init(&self.responses);
+  tau_thread thread;
+  tau_thread_start(&thread, helper_main, &self);
+  int64_t sent = 0;
+  int64_t received = 0;
+  double start = bench_now();
+  while (received < count) {
+    double now = bench_now();
+    if (sent < count && now >= start + (double)sent / rate) {
+      message* request = (message*)malloc(sizeof(message));
+      request->id = sent;
+      request->a = (int32_t)sent;
+      request->b = 1;
+      submitted[sent++] = now;
+      queue_push(&self.requests, request);
+    }
+    message* response = queue_pop(&self.responses, 0);
+    if (response == NULL) {
+      tau_thread_yield();
+      continue;
+    }
+    latencies[received++] = bench_now() - submitted[response->id];
+    free(response);
+  }
+  message* stop = (message*)malloc(sizeof(message));
+  stop->id = -1;
+  queue_push(&self.requests, stop);
+  tau_thread_join(thread);
+  queue_destroy(&self.responses);
+  queue_destroy(&self.requests);
+  report("messages", rate, latencies, count);
+}
+
+// Waits up to 10 seconds for `count` completions of `ring` past `received`,
+// checks that each is the result of its request, of `a` its position and `b`
+// 1, and releases them. Returns the sequences in `sequences`, or 0 if they
+// did not come or a result is wrong.
+static int receive(tau_ring* ring, int64_t received, int32_t count,
+                   int64_t* sequences) {
+  double deadline = bench_now() + 10.0;
+  while (tau_ring_poll(ring) < count) {
+    if (bench_now() > deadline) {
+      return 0;
+    }
+    tau_sleep_until(tau_now_ns() + 1000000);
+  }
+  const tau_ring_completion* completions = tau_ring_completions(ring);
+  int64_t mask = tau_ring_capacity(ring) - 1;
+  int passed = 1;
+  for (int32_t i = 0; i < count; i++) {
+    const tau_ring_completion* completion =
+        &completions[(received + i) & mask];
+    sequences[i] = completion->sequence;
+    passed &= completion->status == TAU_OK &&
+              completion->result == completion->sequence + 1;
+  }
+  tau_ring_release(ring, count);
+  return passed;
+}
+
+// Returns 0 if a slot is only reused once its result is released, 1 if not,
+// and -1 if the pool has a single thread, which completes in order.
+static int check_out_of_order(void) {
+  tau_pool* pool = tau_pool_shared();
+  if (pool == NULL || tau_pool_thread_count(pool) < 2) {
+    return -1;
+  }
+  tau_ring* ring = tau_ring_create(4, 0);
+  if (ring == NULL) {
+    return 1;
+  }
+  tau_ring_request* requests = tau_ring_requests(ring);
+  for (int32_t i = 0; i < 4; i++) {
+    requests[i].opcode = i == 0 ? TAU_OP_SUM_LONG_RUNNING : TAU_OP_SUM;
+    requests[i].a = i;
+    requests[i].b = 1;
+  }
+  int64_t sequences[4];
+  int passed = tau_ring_submit(ring, 4) == TAU_OK &&
+               receive(ring, 0, 3, sequences) && sequences[0] != 0 &&
+               sequences[1] != 0 && sequences[2] != 0;
+  // Three results are released, but slot 0 still holds the long request.
+  passed = passed &&
+           tau_ring_submit(ring, 5) == TAU_ERROR_INVALID_ARGUMENT &&
+           receive(ring, 3, 1, sequences) && sequences[0] == 0;
+  for (int32_t i = 0; passed && i < 4; i++) {
+    requests[i].opcode = TAU_OP_SUM;
+    requests[i].a = 4 + i;
+  }
+  passed = passed && tau_ring_submit(ring, 8) == TAU_OK &&
+           receive(ring, 4, 4, sequences);
+  tau_ring_destroy(ring);
+  return !passed;
+}
+
+int bench_ring(void) {
+  int out_of_order = check_out_of_order();
+  if (out_of_order < 0) {
+    printf("out-of-order completions: skipped, the pool has one thread\n");
+  } else {
+    printf("out-of-order completions: %s\n",
+           out_of_order ? "FAILED" : "slots reused only once released");
+  }
+  double* submitted = (double*)malloc(MAX_REQUESTS * sizeof(double));
+  double* latencies = (double*)malloc(MAX_REQUESTS * sizeof(double));
+  if (submitted == NULL || latencies == NULL) {
+    free(submitted);
+    free(latencies);
+    return 1;
+  }
+  printf("%10s %8s %10s %10s\n", "req/s", "path", "p50 us", "p99 us");
+  for (double rate = 1e3; rate <= 1e6; rate *= 10) {
+    run_ring(rate, submitted, latencies);
+    run_messages(rate, submitted, latencies);
+  }
+  free(submitted);
+  free(latencies);
+  return out_of_order > 0;
+}
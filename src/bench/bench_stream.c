@@ -0,0 +1,204 @@
+// Time to the first sample, total decoding time and peak memory of a long
+// WAV file read through a stream and decoded whole with `tau_decode_file`.
+//
+// The benchmark writes a file of a few minutes of 16-bit stereo to the
+// temporary directory. Each path runs in a child process, so that its peak
+// resident set size is measured on its own; the report is the growth of the
+// peak over the size of the process when the path starts. It also checks
+// that both paths decode the same samples.
+#include <string.h>
+
+#include "bench.h"
+
+#if !_WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+
+#define SAMPLE_RATE 48000
+#define CHANNELS 2
+#define SECONDS 300
+#define READ_FRAMES 4096
+
+typedef struct result {
+  double first_sample;
+  double total;
+  double peak_megabytes;
+  // A checksum of the decoded samples.
+  double sum;
+} result;
+
+static void put_u16(FILE* file, uint32_t value) {
+  fputc((int)(value & 0xFF), file);
+  fputc((int)(value >> 8 & 0xFF), file);
+}
+
+static void put_u32(FILE* file, uint32_t value) {
+  put_u16(file, value & 0xFFFF);
+  put_u16(file, value >> 16);
+}
+
+static int write_wav(const char* path) {
+  FILE* file = fopen(path, "wb");
+  if (file == NULL) {
+    return 1;
+  }
+  uint32_t data_bytes = (uint32_t)SECONDS * SAMPLE_RATE * CHANNELS * 2;
+  fwrite("RIFF", 1, 4, file);
+  put_u32(file, 36 + data_bytes);
+  fwrite("WAVEfmt ", 1, 8, file);
+  put_u32(file, 16);
+  put_u16(file, 1);
+  put_u16(file, CHANNELS);
+  put_u32(file, SAMPLE_RATE);
+  put_u32(file, SAMPLE_RATE * CHANNELS * 2);
+  put_u16(file, CHANNELS * 2);
+  put_u16(file, 16);
+  fwrite("data", 1, 4, file);
+  put_u32(file, data_bytes);
+  int16_t frames[1024 * CHANNELS];
+  uint32_t seed = 1;
+  for (int64_t written = 0; written < (int64_t)SECONDS * SAMPLE_RATE;
+       written += 1024) {
+    for (int32_t i = 0; i < 1024 * CHANNELS; i++) {
+      seed = seed * 1664525u + 1013904223u;
+      frames[i] = (int16_t)(seed >> 16);
+    }
+    fwrite(frames, sizeof(frames), 1, file);
+  }
+  return fclose(file) != 0;
+}
+
+static double peak_megabytes(void) {
+#if _WIN32
+  return 0.0;
+#else
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+  return usage.ru_maxrss / 1048576.0;
+#else
+  return usage.ru_maxrss / 1024.0;
+#endif
+#endif
+}
+
+static double checksum(const tau_audio_buffer* buffer, int32_t frames) {
+  double sum = 0.0;
+  for (int32_t c = 0; c < buffer->channels; c++) {
+    const float* samples = buffer->data + (size_t)c * buffer->stride;
+    for (int32_t i = 0; i < frames; i++) {
+      sum += samples[i] * (1.0 + c);
+    }
+  }
+  return sum;
+}
+
+static int run_stream(const char* path, result* out) {
+  double start = bench_now();
+  tau_stream* stream = tau_stream_open(path, 0);
+  tau_audio_buffer* buffer =
+      tau_audio_buffer_create(CHANNELS, TAU_RENDER_QUANTUM_FRAMES, SAMPLE_RATE);
+  if (stream == NULL || buffer == NULL) {
+    tau_stream_release(stream);
+    tau_audio_buffer_release(buffer);
+    return 1;
+  }
+  int32_t read = tau_stream_read(stream, buffer);
+  out->first_sample = bench_now() - start;
+  out->sum = checksum(buffer, read > 0 ? read : 0);
+  tau_audio_buffer_release(buffer);
+  buffer = tau_audio_buffer_create(CHANNELS, READ_FRAMES, SAMPLE_RATE);
+  while (buffer != NULL && (read = tau_stream_read(stream, buffer)) > 0) {
+    out->sum += checksum(buffer, read);
+  }
+  out->total = bench_now() - start;
+  tau_audio_buffer_release(buffer);
+  tau_stream_release(stream);
+  return read < 0;
+}
+
+static int run_whole(const char* path, result* out) {
+  double start = bench_now();
+  tau_audio_buffer* buffer = tau_decode_file(path);
+  if (buffer == NULL) {
+    return 1;
+  }
+  out->first_sample = bench_now() - start;
+  out->total = out->first_sample;
+  out->sum = checksum(buffer, buffer->frames);
+  tau_audio_buffer_release(buffer);
+  return 0;
+}
+
+// Runs `path_fn` in a child process where possible.
+static int measure(int (*path_fn)(const char*, result*), const char* path,
+                   result* out) {
+#if _WIN32
+  out->peak_megabytes = 0.0;
+  return path_fn(path, out);
+#else
+  int fds[2];
+  if (pipe(fds) != 0) {
+    return 1;
+  }
+  fflush(stdout);
+  pid_t child = fork();
+  if (child == 0) {
+    close(fds[0]);
+    double before = peak_megabytes();
+    result measured;
+    int status = path_fn(path, &measured);
+    measured.peak_megabytes = peak_megabytes() - before;
+    if (status != 0 ||
+        write(fds[1], &measured, sizeof(measured)) != sizeof(measured)) {
+      _exit(1);
+    }
+    _exit(0);
+  }
+  close(fds[1]);
+  int status = 1;
+  if (child > 0) {
+    status = read(fds[0], out, sizeof(*out)) != sizeof(*out);
+    int exit_status;
+    waitpid(child, &exit_status, 0);
+  }
+  close(fds[0]);
+  return status;
+#endif
+}
+
+int bench_stream(void) {
+#if _WIN32
+  const char* directory = getenv("TEMP");
+#else
+  const char* directory = getenv("TMPDIR");
+  directory = directory != NULL ? directory : "/tmp";
+#endif
+  char path[1024];
+  snprintf(path, sizeof(path), "%s/tau_ffi_bench_stream.wav",
+           directory != NULL ? directory : ".");
+  if (write_wav(path) != 0) {
+    printf("cannot write %s\n", path);
+    return 1;
+  }
+  printf("%d s of 16-bit stereo at %d Hz\n", SECONDS, SAMPLE_RATE);
+  printf("%-8s %16s %12s %14s\n", "path", "first sample ms", "total ms",
+         "peak RSS MB");
+  result stream;
+  result whole;
+  int status = measure(run_stream, path, &stream) ||
+               measure(run_whole, path, &whole);
+  if (status == 0) {
+    printf("%-8s %16.3f %12.1f %14.1f\n", "stream", stream.first_sample * 1e3,
+           stream.total * 1e3, stream.peak_megabytes);
+    printf("%-8s %16.3f %12.1f %14.1f\n", "whole", whole.first_sample * 1e3,
+           whole.total * 1e3, whole.peak_megabytes);
+    if (stream.sum != whole.sum) {
+      printf("FAILED: the paths decode different samples\n");
+      status = 1;
+    }
+  }
+  remove(path);
+  return status;
+}
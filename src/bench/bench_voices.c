@@ -0,0 +1,252 @@
+// How many short notes per second a context sustains in real time, played
+// on a voice pool or on a buffer source node per note.
+//
+// A note is 50 ms of a decaying sine. Every quantum, the notes falling in it
+// are played, and with nodes, the nodes of the notes over are released; then
+// the quantum is rendered. A quantum whose edits and rendering take longer
+// than its real-time duration is a glitch. For note rates doubling from 500
+// per second, one second of audio reports the load, as a share of real
+// time, the glitches, and the heap allocations per note. A rate is
+// sustained when no quantum glitched.
+//
+// The benchmark fails if the pool does not sound as a buffer source through
+// a gain, if it does not steal the oldest notes once every voice plays, or
+// if its notes allocate.
+#include <math.h>
+#include <string.h>
+
+#include "bench.h"
+
+#define SAMPLE_RATE 48000
+#define NOTE_FRAMES 2400
+#define VOICES 1024
+#define QUANTUM TAU_RENDER_QUANTUM_FRAMES
+// The notes a context holds as nodes at most, past the highest rate.
+#define MAX_NODES 16384
+
+typedef enum method {
+  METHOD_POOL,
+  METHOD_NODES,
+} method;
+
+typedef struct result {
+  double load;
+  int32_t glitches;
+  int64_t notes;
+  double allocations;
+} result;
+
+static tau_audio_buffer* note_buffer(void) {
+  tau_audio_buffer* buffer =
+      tau_audio_buffer_create(1, NOTE_FRAMES, SAMPLE_RATE);
+  if (buffer != NULL) {
+    for (int32_t i = 0; i < NOTE_FRAMES; i++) {
+      buffer->data[i] = (float)(sin(2.0 * 3.14159265358979 * 220.0 * i /
+                                    SAMPLE_RATE) *
+                                exp(-8.0 * i / NOTE_FRAMES));
+    }
+  }
+  return buffer;
+}
+
+// Renders `frames` of `context` into `output`.
+static int render(tau_context* context, float* output, int32_t frames) {
+  return tau_context_render(context, output, frames) == frames;
+}
+
+// Renders a second of `rate` notes per second with `kind` into `*result`,
+// after half a second that brings the pools of the context to their working
+// size.
+static int run(method kind, int32_t rate, tau_audio_buffer* buffer,
+               result* out) {
+  tau_context* context = tau_context_create(1, SAMPLE_RATE);
+  float* output = (float*)malloc(QUANTUM * sizeof(float));
+  // With nodes, the handles and end frames of the notes playing, in order.
+  int32_t* handles = (int32_t*)malloc(MAX_NODES * sizeof(int32_t));
+  int64_t* ends = (int64_t*)malloc(MAX_NODES * sizeof(int64_t));
+  int32_t pool = context != NULL ? tau_voice_pool_create(context, VOICES, 1)
+                                 : -1;
+  int passed = output != NULL && handles != NULL && ends != NULL &&
+               pool >= 0 &&
+               tau_node_connect(context, pool,
+                                tau_context_destination(context)) == 0;
+  int32_t head = 0;
+  int32_t tail = 0;
+  double next_note = 0.0;
+  double deadline = (double)QUANTUM / SAMPLE_RATE;
+  // Half a second, in whole quanta.
+  int64_t warm_up = SAMPLE_RATE / 2 / QUANTUM * QUANTUM;
+  int64_t allocations = 0;
+  memset(out, 0, sizeof(*out));
+  for (int64_t frame = 0; passed && frame < warm_up + SAMPLE_RATE;
+       frame += QUANTUM) {
+    if (frame == warm_up) {
+      allocations = tau_memory_allocations();
+      out->notes = 0;
+    }
+    double start = bench_now();
+    for (; passed && next_note < (double)(frame + QUANTUM);
+         next_note += (double)SAMPLE_RATE / rate) {
+      double when = next_note / SAMPLE_RATE;
+      if (kind == METHOD_POOL) {
+        passed = tau_voice_pool_play(context, pool, buffer, when, 0, 1.0f,
+                                     0.5f) >= 0;
+      } else {
+        int32_t node = tau_buffer_source_create(context, buffer, 0);
+        int32_t gain = tau_gain_create(context, 0.5f);
+        passed = node >= 0 && gain >= 0 && tail - head < MAX_NODES / 2 &&
+                 tau_node_connect(context, node, gain) == 0 &&
+                 tau_node_connect(context, gain,
+                                  tau_context_destination(context)) == 0 &&
+                 tau_node_start(context, node, when) == 0;
+        handles[tail % MAX_NODES] = node;
+        ends[tail++ % MAX_NODES] = (int64_t)next_note + NOTE_FRAMES;
+        handles[tail % MAX_NODES] = gain;
+        ends[tail++ % MAX_NODES] = (int64_t)next_note + NOTE_FRAMES;
+      }
+      out->notes++;
+    }
+    while (head < tail && ends[head % MAX_NODES] <= frame) {
+      tau_node_release(context, handles[head++ % MAX_NODES]);
+    }
+    passed = passed && render(context, output, QUANTUM);
+    double elapsed = bench_now() - start;
+    if (frame >= warm_up) {
+      out->load += elapsed;
+      out->glitches += elapsed > deadline;
+    }
+  }
+  out->allocations = out->notes > 0 ? (double)(tau_memory_allocations() -
+                                               allocations) /
+                                          out->notes
+                                    : 0.0;
+  bench_sink += (int64_t)(output != NULL ? output[0] * 1000.0f : 0.0f);
+  tau_context_destroy(context);
+  free(output);
+  free(handles);
+  free(ends);
+  return passed;
+}
+
+// Whether a note of the pool at 1.5 times its speed and half its level
+// sounds as a buffer source through a gain of 0.5.
+static int check_sound(tau_audio_buffer* buffer) {
+  enum { FRAMES = 4096 };
+  float* expected = (float*)malloc(2 * FRAMES * sizeof(float));
+  float* actual = expected != NULL ? expected + FRAMES : NULL;
+  tau_context* sources = tau_context_create(1, SAMPLE_RATE);
+  tau_context* voices = tau_context_create(1, SAMPLE_RATE);
+  int32_t source = tau_buffer_source_create(sources, buffer, 0);
+  int32_t gain = tau_gain_create(sources, 0.5f);
+  int32_t pool = tau_voice_pool_create(voices, 4, 1);
+  int passed =
+      actual != NULL && source >= 0 && gain >= 0 && pool >= 0 &&
+      tau_param_set_value(sources, source, TAU_PARAM_PLAYBACK_RATE, 1.5f) ==
+          0 &&
+      tau_node_connect(sources, source, gain) == 0 &&
+      tau_node_connect(sources, gain, tau_context_destination(sources)) ==
+          0 &&
+      tau_node_start(sources, source, 0.001) == 0 &&
+      tau_node_connect(voices, pool, tau_context_destination(voices)) == 0 &&
+      tau_voice_pool_play(voices, pool, buffer, 0.001, 0, 1.5f, 0.5f) >= 0 &&
+      render(sources, expected, FRAMES) && render(voices, actual, FRAMES);
+  for (int32_t i = 0; passed && i < FRAMES; i++) {
+    passed = fabsf(expected[i] - actual[i]) <= 1e-6f;
+  }
+  tau_context_destroy(sources);
+  tau_context_destroy(voices);
+  free(expected);
+  return passed;
+}
+
+// Whether a pool of 4 voices playing 6 notes at once steals the 2 oldest,
+// whether stopping a looping note frees its voice, and whether every voice
+// is free once the notes are over.
+static int check_steals(tau_audio_buffer* buffer) {
+  float output[QUANTUM];
+  tau_context* context = tau_context_create(1, SAMPLE_RATE);
+  int32_t pool = tau_voice_pool_create(context, 4, 1);
+  int passed = pool >= 0 && tau_node_connect(context, pool,
+                                             tau_context_destination(
+                                                 context)) == 0;
+  int32_t voices[6];
+  for (int32_t i = 0; passed && i < 6; i++) {
+    voices[i] =
+        tau_voice_pool_play(context, pool, buffer, 0.0, i == 5, 1.0f, 1.0f);
+    passed = voices[i] >= 0;
+  }
+  tau_voice_pool_stats stats;
+  passed = passed && tau_voice_pool_get_stats(context, pool, &stats) == 0 &&
+           stats.voices == 4 && stats.playing == 4 && stats.notes == 6 &&
+           stats.steals == 2 &&
+           // The fifth and sixth notes took the voices of the first two.
+           (voices[4] & (TAU_MAX_VOICES - 1)) ==
+               (voices[0] & (TAU_MAX_VOICES - 1)) &&
+           (voices[5] & (TAU_MAX_VOICES - 1)) ==
+               (voices[1] & (TAU_MAX_VOICES - 1));
+  // Once a voice plays another note, its former handle stops nothing.
+  passed = passed &&
+           tau_voice_pool_stop(context, pool, voices[1], 0.0) == 0 &&
+           tau_voice_pool_stop(context, pool, voices[5], 0.01) == 0;
+  for (int32_t frame = 0; passed && frame < NOTE_FRAMES + QUANTUM;
+       frame += QUANTUM) {
+    passed = render(context, output, QUANTUM);
+  }
+  passed = passed && tau_voice_pool_get_stats(context, pool, &stats) == 0 &&
+           stats.playing == 0;
+  tau_context_destroy(context);
+  return passed;
+}
+
+static void print_result(const char* name, int32_t rate,
+                         const result* out) {
+  printf("%-6s %8d %8.1f %9d %12.2f\n", name, rate, out->load * 100.0,
+         out->glitches, out->allocations);
+}
+
+int bench_voices(void) {
+  tau_audio_buffer* buffer = note_buffer();
+  if (buffer == NULL) {
+    return 1;
+  }
+  int status = 0;
+  int sound = check_sound(buffer);
+  int steals = check_steals(buffer);
+  printf("pool against a buffer source: %s\n", sound ? "ok" : "FAILED");
+  printf("stealing and stopping voices: %s\n", steals ? "ok" : "FAILED");
+  status |= !sound || !steals;
+  printf("notes of %d ms, %d voices; load in %% of real time over a second\n",
+         NOTE_FRAMES * 1000 / SAMPLE_RATE, VOICES);
+  printf("%-6s %8s %8s %9s %12s\n", "method", "notes/s", "load", "glitches",
+         "allocs/note");
+  int32_t sustained[2] = {0, 0};
+  for (int kind = METHOD_POOL; kind <= METHOD_NODES; kind++) {
+    for (int32_t rate = 500; rate <= 128000; rate *= 2) {
+      result out;
+      if (!run((method)kind, rate, buffer, &out)) {
+        printf("%-6s %8d FAILED\n", kind == METHOD_POOL ? "pool" : "nodes",
+               rate);
+        status = 1;
+        break;
+      }
+      print_result(kind == METHOD_POOL ? "pool" : "nodes", rate, &out);
+      bench_metric(out.allocations, "allocs/note", 0, "%s.%d.allocations",
+                   kind == METHOD_POOL ? "pool" : "nodes", rate);
+      if (kind == METHOD_POOL && out.allocations > 0.0) {
+        printf("FAILED: notes of the pool allocate\n");
+        status = 1;
+      }
+      if (out.glitches > 0) {
+        break;
+      }
+      sustained[kind] = rate;
+    }
+  }
+  printf("sustained without glitches: %d notes/s on the pool, %d with "
+         "nodes\n",
+         sustained[METHOD_POOL], sustained[METHOD_NODES]);
+  bench_metric(sustained[METHOD_POOL], "notes/s", 1, "pool.sustained");
+  bench_metric(sustained[METHOD_NODES], "notes/s", 1, "nodes.sustained");
+  tau_audio_buffer_release(buffer);
+  return status;
+}
@@ -0,0 +1,267 @@
+// Worklet nodes processed on another thread: the latency they add, and how
+// many of them play in real time before their blocks come back late.
+//
+// A native thread stands in for the Dart isolate of `AudioWorklet`: it
+// waits on the host, multiplies the input of each block by a gain into the
+// output, spinning for a set time per block to stand for the work of a
+// processor, and hands the block back.
+//
+// Offline, with blocking worklets, an impulse goes through chains of 4
+// worklets of each latency: it must come out exactly 4 latencies later,
+// and otherwise unchanged. The time per block is then the round trip of a
+// handoff, with the threads waking each other. In real time, N worklets of
+// each latency process an oscillator in parallel on the null sink, with
+// 10 us of work per block, for `--seconds` seconds, 0.5 by default, N
+// doubling from 1 until 1% of the blocks come back late, or the device
+// falls 5% behind its clock, then refined by bisection. Sporadic late
+// blocks follow the stalls of the machine, which the device benchmark shows
+// as jitter; a processing thread short of time leaves a large share late.
+// The benchmark fails if the impulse is late, early or altered.
+#include <math.h>
+#include <string.h>
+
+#include "bench.h"
+#include "tau_platform.h"
+
+#define SAMPLE_RATE 48000
+#define QUANTUM TAU_RENDER_QUANTUM_FRAMES
+#define CHAIN 4
+#define CHECK_QUANTA 512
+#define WORK_NS 10000
+#define MAX_WORKLETS 1024
+// The share of late blocks past which the worklets are too many.
+#define MAX_LATE 0.01
+// How far behind its clock the device may fall, which a stall of the
+// machine near the end of a run can put it, before rendering is too slow.
+#define MAX_BEHIND 0.05
+
+typedef struct processor {
+  tau_worklet_host* host;
+  tau_thread thread;
+  float gain;
+  int64_t work_ns;
+} processor;
+
+static void run_processor(void* arg) {
+  processor* p = (processor*)arg;
+  for (;;) {
+    tau_worklet_block* block = tau_worklet_host_wait(p->host, 10);
+    if (block == NULL) {
+      if (tau_worklet_host_closed(p->host)) {
+        break;
+      }
+      continue;
+    }
+    int64_t end = tau_now_ns() + p->work_ns;
+    for (int32_t c = 0; c < block->output_channels; c++) {
+      const float* input =
+          block->input + (c % block->input_channels) * QUANTUM;
+      float* output = block->output + c * QUANTUM;
+      for (int32_t i = 0; i < QUANTUM; i++) {
+        output[i] = input[i] * p->gain;
+      }
+    }
+    while (p->work_ns > 0 && tau_now_ns() < end) {
+      tau_cpu_relax();
+    }
+    tau_worklet_host_complete(p->host, block);
+  }
+  tau_worklet_host_release(p->host);
+}
+
+// Starts a processor of a host of `capacity` blocks. Returns 0 on success.
+static int processor_start(processor* p, int32_t capacity, float gain,
+                           int64_t work_ns) {
+  memset(p, 0, sizeof(*p));
+  p->gain = gain;
+  p->work_ns = work_ns;
+  p->host = tau_worklet_host_create(capacity);
+  if (p->host == NULL) {
+    return -1;
+  }
+  if (tau_thread_start(&p->thread, run_processor, p) != 0) {
+    tau_worklet_host_release(p->host);
+    return -1;
+  }
+  return 0;
+}
+
+static void processor_stop(processor* p) {
+  tau_worklet_host_close(p->host);
+  tau_thread_join(p->thread);
+}
+
+// Renders an impulse through `CHAIN` blocking worklets of `latency` quanta,
+// and checks that it comes out `CHAIN * latency` quanta later. Returns the
+// time per block in seconds, or a negative value if the check fails.
+static double check_chain(int32_t latency) {
+  processor p;
+  if (processor_start(&p, CHAIN * (latency + 2), 1.0f, 0) != 0) {
+    return -1.0;
+  }
+  tau_context* context = tau_context_create(1, SAMPLE_RATE);
+  tau_audio_buffer* impulse = tau_audio_buffer_create(1, 1, SAMPLE_RATE);
+  float* output = (float*)malloc(CHECK_QUANTA * QUANTUM * sizeof(float));
+  int passed = context != NULL && impulse != NULL && output != NULL;
+  int32_t previous = -1;
+  if (passed) {
+    impulse->data[0] = 1.0f;
+    previous = tau_buffer_source_create(context, impulse, 0);
+    passed = previous >= 0 && tau_node_start(context, previous, 0) == 0;
+  }
+  int32_t nodes[CHAIN];
+  for (int32_t i = 0; passed && i < CHAIN; i++) {
+    nodes[i] = tau_worklet_create(context, p.host, i, 1, 1, latency, 1);
+    passed = nodes[i] >= 0 &&
+             tau_node_connect(context, previous, nodes[i]) == TAU_OK;
+    previous = nodes[i];
+  }
+  passed = passed && tau_node_connect(context, previous,
+                                      tau_context_destination(context)) ==
+                         TAU_OK;
+  double start = bench_now();
+  passed = passed && tau_context_render(context, output,
+                                        CHECK_QUANTA * QUANTUM) ==
+                         CHECK_QUANTA * QUANTUM;
+  double elapsed = bench_now() - start;
+  int64_t expected = (int64_t)CHAIN * latency * QUANTUM;
+  for (int32_t i = 0; passed && i < CHECK_QUANTA * QUANTUM; i++) {
+    passed = output[i] == (i == expected ? 1.0f : 0.0f);
+  }
+  for (int32_t i = 0; passed && i < CHAIN; i++) {
+    passed = tau_worklet_underruns(context, nodes[i]) == 0;
+  }
+  free(output);
+  tau_audio_buffer_release(impulse);
+  tau_context_destroy(context);
+  processor_stop(&p);
+  return passed ? elapsed / ((double)CHECK_QUANTA * CHAIN) : -1.0;
+}
+
+// Plays `count` worklets of `latency` quanta on the null sink for `seconds`.
+// Returns the share of their blocks that came back late, 1 if the device
+// fell behind its clock, or a negative value if the graph cannot play.
+static double play(int32_t count, int32_t latency, double seconds) {
+  processor p;
+  if (processor_start(&p, count * (latency + 2), 1.0f / count, WORK_NS) !=
+      0) {
+    return -1.0;
+  }
+  tau_context* context = tau_context_create(2, SAMPLE_RATE);
+  int32_t* nodes = (int32_t*)malloc((size_t)count * sizeof(int32_t));
+  int32_t oscillator =
+      context != NULL ? tau_oscillator_create(context, 0, 440.0f) : -1;
+  int passed = nodes != NULL && oscillator >= 0 &&
+               tau_node_start(context, oscillator, 0) == TAU_OK;
+  for (int32_t i = 0; passed && i < count; i++) {
+    nodes[i] = tau_worklet_create(context, p.host, i, 1, 2, latency, 0);
+    passed = nodes[i] >= 0 &&
+             tau_node_connect(context, oscillator, nodes[i]) == TAU_OK &&
+             tau_node_connect(context, nodes[i],
+                              tau_context_destination(context)) == TAU_OK;
+  }
+  tau_device* device =
+      passed ? tau_device_open(context, "null", NULL, QUANTUM) : NULL;
+  double late = -1.0;
+  double start = bench_now();
+  if (device != NULL && tau_device_start(device) == TAU_OK) {
+    tau_sleep_until(tau_now_ns() + (int64_t)(seconds * 1e9));
+    tau_device_stop(device);
+    double elapsed = bench_now() - start;
+    tau_device_stats stats;
+    tau_device_get_stats(device, &stats);
+    int64_t underruns = 0;
+    for (int32_t i = 0; i < count; i++) {
+      underruns += tau_worklet_underruns(context, nodes[i]);
+    }
+    late = (double)underruns * QUANTUM / ((double)stats.frames * count);
+    // The first period is asked for at once, ahead of the clock.
+    double behind =
+        1.0 - (double)(stats.frames - QUANTUM) / SAMPLE_RATE / elapsed;
+    late = behind > MAX_BEHIND ? 1.0 : late;
+  }
+  tau_device_close(device);
+  free(nodes);
+  tau_context_destroy(context);
+  processor_stop(&p);
+  return late;
+}
+
+// The most worklets of `latency` quanta that play with fewer than
+// `MAX_LATE` of their blocks late, up to `MAX_WORKLETS`, or a negative value
+// if a graph cannot play. Stores the share of late blocks at that count in
+// `*late`.
+static int32_t max_worklets(int32_t latency, double seconds, double* late) {
+  int32_t good = 0;
+  int32_t bad = 0;
+  *late = 0.0;
+  for (int32_t count = 1; count <= MAX_WORKLETS; count *= 2) {
+    double share = play(count, latency, seconds);
+    if (share < 0.0) {
+      return -1;
+    }
+    if (share >= MAX_LATE) {
+      bad = count;
+      break;
+    }
+    good = count;
+    *late = share;
+  }
+  // Refines to an eighth of the last good count.
+  while (bad > 0 && bad - good > (good > 8 ? good / 8 : 1)) {
+    int32_t count = good + (bad - good) / 2;
+    double share = play(count, latency, seconds);
+    if (share < 0.0) {
+      return -1;
+    }
+    if (share >= MAX_LATE) {
+      bad = count;
+    } else {
+      good = count;
+      *late = share;
+    }
+  }
+  return good;
+}
+
+int bench_worklet(void) {
+  static const int32_t latencies[] = {1, 2, 4};
+  double seconds = bench_seconds > 0 ? bench_seconds : 0.5;
+  int status = 0;
+  printf("offline, %d blocking worklets in a chain\n", CHAIN);
+  printf("%-8s %12s %14s %14s\n", "latency", "added ms", "impulse at",
+         "us per block");
+  for (size_t i = 0; i < sizeof(latencies) / sizeof(latencies[0]); i++) {
+    int32_t latency = latencies[i];
+    double block = check_chain(latency);
+    int passed = block >= 0.0;
+    status |= !passed;
+    printf("%-8d %12.2f %14d %14.2f%s\n", latency,
+           latency * QUANTUM * 1e3 / SAMPLE_RATE, CHAIN * latency * QUANTUM,
+           passed ? block * 1e6 : 0.0, passed ? "" : " FAILED");
+    if (passed) {
+      bench_metric(block * 1e6, "us", 0, "handoff.latency%d", latency);
+    }
+  }
+  printf("real time on the null sink, %.0f us of work per block, %.1f s "
+         "per count\n",
+         WORK_NS * 1e-3, seconds);
+  printf("%-8s %12s %14s %10s\n", "latency", "added ms", "max worklets",
+         "late");
+  for (size_t i = 0; i < sizeof(latencies) / sizeof(latencies[0]); i++) {
+    int32_t latency = latencies[i];
+    double late;
+    int32_t count = max_worklets(latency, seconds, &late);
+    status |= count < 0;
+    printf("%-8d %12.2f %14d %9.2f%%%s\n", latency,
+           latency * QUANTUM * 1e3 / SAMPLE_RATE, count, late * 100.0,
+           count < 0 ? " FAILED" : "");
+    if (count >= 0) {
+      bench_metric(count, "worklets", 1, "realtime.latency%d", latency);
+    }
+  }
+  printf("(max worklets: the most playing with fewer than %.0f%% of their "
+         "blocks late, up to %d)\n",
+         MAX_LATE * 100.0, MAX_WORKLETS);
+  return status;
+}
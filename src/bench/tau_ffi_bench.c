@@ -0,0 +1,102 @@
+#include <string.h>
+
+#include "bench.h"
+
+volatile int64_t bench_sink;
+double bench_seconds;
+
+typedef struct bench_entry {
+  const char* name;
+  int (*run)(void);
+} bench_entry;
+
+static const bench_entry benchmarks[] = {
+    {"analyser", bench_analyser},
+    {"automation", bench_automation},
+    {"batch", bench_batch},
+    {"biquad", bench_biquad},
+    {"buffer", bench_buffer},
+    {"cache", bench_cache},
+    {"compressor", bench_compressor},
+    {"control", bench_control},
+    {"convolver", bench_convolver},
+    {"device", bench_device},
+    {"graph", bench_graph},
+    {"kernels", bench_kernels},
+    {"memory", bench_memory},
+    {"mix", bench_mix},
+    {"panner", bench_panner},
+    {"pool", bench_pool},
+    {"profile", bench_profile},
+    {"ring", bench_ring},
+    {"render", bench_render},
+    {"resampler", bench_resampler},
+    {"stream", bench_stream},
+    {"voices", bench_voices},
+    {"worklet", bench_worklet},
+};
+
+#define BENCHMARK_COUNT (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+static int run_benchmark(const bench_entry* entry) {
+  printf("== %s ==\n", entry->name);
+  bench_report_begin(entry->name);
+  int status = entry->run();
+  printf("\n");
+  return status;
+}
+
+static void usage(void) {
+  fprintf(stderr,
+          "Usage: tau_ffi_bench [--seconds S] [--json FILE] "
+          "[--baseline FILE] [--threshold PERCENT] [benchmark...]\n");
+}
+
+int main(int argc, char** argv) {
+  int status = 0;
+  const char* json = NULL;
+  const char* baseline = NULL;
+  double threshold = 10.0;
+  int arg = 1;
+  for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; arg += 2) {
+    if (arg + 1 == argc) {
+      usage();
+      return 2;
+    }
+    if (strcmp(argv[arg], "--seconds") == 0) {
+      bench_seconds = atof(argv[arg + 1]);
+    } else if (strcmp(argv[arg], "--json") == 0) {
+      json = argv[arg + 1];
+    } else if (strcmp(argv[arg], "--baseline") == 0) {
+      baseline = argv[arg + 1];
+    } else if (strcmp(argv[arg], "--threshold") == 0) {
+      threshold = atof(argv[arg + 1]);
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (arg == argc) {
+    for (size_t i = 0; i < BENCHMARK_COUNT; i++) {
+      status |= run_benchmark(&benchmarks[i]);
+    }
+  }
+  for (; arg < argc; arg++) {
+    size_t i = 0;
+    while (i < BENCHMARK_COUNT && strcmp(benchmarks[i].name, argv[arg]) != 0) {
+      i++;
+    }
+    if (i == BENCHMARK_COUNT) {
+      fprintf(stderr, "Unknown benchmark: %s\n", argv[arg]);
+      return 2;
+    }
+    status |= run_benchmark(&benchmarks[i]);
+  }
+  if (json != NULL) {
+    status |= bench_report_write(json);
+  }
+  if (baseline != NULL) {
+    status |= bench_report_compare(baseline, threshold / 100.0);
+  }
+  return status;
+}
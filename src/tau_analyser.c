@@ -0,0 +1,324 @@
+// The analyser node: the last frames of a signal and their spectrum, as the
+// Web Audio `AnalyserNode`.
+//
+// The rendering thread passes the input through and appends it, down-mixed
+// to mono, to a ring of frames, publishing the count of frames written. It
+// neither waits nor transforms anything: a thread asking for data copies the
+// last `fft_size` frames out of the ring, then checks that the rendering
+// thread did not overwrite them meanwhile, and copies them again if it did.
+// The spectrum is only computed when asked for, and only once per batch of
+// new frames, so analysers nobody reads cost a copy per quantum. Readers
+// take the control lock only to find the analyser and take a reference to
+// it: they transform under a lock of the analyser, so polling many
+// analysers does not hold up edits of the graph.
+#include <math.h>
+#include <string.h>
+
+#include "tau_engine.h"
+#include "tau_fft.h"
+
+#define TAU_PI 3.14159265358979323846
+
+#define DEFAULT_SMOOTHING 0.8f
+
+typedef struct analyser {
+  int32_t fft_size;
+  // The frames of the ring, a power of two of at least `fft_size` and a
+  // quantum more.
+  int32_t capacity;
+  float* ring;
+  // The frames written to the ring since the creation of the node.
+  TAU_ALIGNAS(TAU_CACHE_LINE) volatile int64_t written;
+
+  // Held by the node and by each thread reading the analyser.
+  volatile int32_t references;
+  // What follows belongs to the threads reading the analyser, under `lock`.
+  tau_mutex lock;
+
+  float smoothing;
+  // The frames written when the spectrum was last computed, or -1.
+  int64_t spectrum_written;
+  tau_fft fft;
+  // The Blackman window.
+  float* window;
+  float* frame;
+  float* re;
+  float* im;
+  // The smoothed magnitudes of the `fft_size / 2` bins.
+  float* smoothed;
+  // The results, shared with the callers: the spectrum in decibels and the
+  // last frames.
+  tau_audio_buffer* frequency_data;
+  tau_audio_buffer* time_domain_data;
+} analyser;
+
+typedef struct analyser_state {
+  analyser* self;
+} analyser_state;
+
+static void analyser_free(analyser* self) {
+  tau_fft_destroy(&self->fft);
+  tau_memory_free(self->ring);
+  tau_memory_free(self->window);
+  tau_memory_free(self->frame);
+  tau_memory_free(self->re);
+  tau_memory_free(self->im);
+  tau_memory_free(self->smoothed);
+  tau_audio_buffer_release(self->frequency_data);
+  tau_audio_buffer_release(self->time_domain_data);
+  tau_mutex_destroy(&self->lock);
+  tau_memory_free(self);
+}
+
+static void analyser_unref(analyser* self) {
+  if (tau_atomic_fetch_add_i32(&self->references, -1) == 1) {
+    analyser_free(self);
+  }
+}
+
+static analyser* analyser_new(int32_t fft_size, float sample_rate) {
+  analyser* self =
+      (analyser*)tau_memory_calloc(sizeof(analyser), TAU_CACHE_LINE);
+  if (self == NULL) {
+    return NULL;
+  }
+  tau_mutex_init(&self->lock);
+  self->references = 1;
+  int32_t bins = fft_size / 2;
+  self->fft_size = fft_size;
+  self->capacity = 2 * (fft_size > TAU_QUANTUM ? fft_size : TAU_QUANTUM);
+  self->smoothing = DEFAULT_SMOOTHING;
+  self->spectrum_written = -1;
+  self->ring = (float*)tau_memory_calloc(
+      (size_t)self->capacity * sizeof(float), TAU_CACHE_LINE);
+  self->window = (float*)tau_memory_alloc((size_t)fft_size * sizeof(float),
+                                          TAU_CACHE_LINE);
+  self->frame = (float*)tau_memory_alloc((size_t)fft_size * sizeof(float),
+                                         TAU_CACHE_LINE);
+  self->re = (float*)tau_memory_alloc((size_t)(bins + 1) * sizeof(float),
+                                      TAU_CACHE_LINE);
+  self->im = (float*)tau_memory_alloc((size_t)(bins + 1) * sizeof(float),
+                                      TAU_CACHE_LINE);
+  self->smoothed = (float*)tau_memory_calloc((size_t)bins * sizeof(float),
+                                             TAU_CACHE_LINE);
+  self->frequency_data = tau_audio_buffer_create(1, bins, sample_rate);
+  self->time_domain_data = tau_audio_buffer_create(1, fft_size, sample_rate);
+  if (tau_fft_init(&self->fft, fft_size) != TAU_OK || self->ring == NULL ||
+      self->window == NULL || self->frame == NULL || self->re == NULL ||
+      self->im == NULL || self->smoothed == NULL ||
+      self->frequency_data == NULL || self->time_domain_data == NULL) {
+    analyser_free(self);
+    return NULL;
+  }
+  for (int32_t i = 0; i < fft_size; i++) {
+    double phase = 2.0 * TAU_PI * i / fft_size;
+    self->window[i] =
+        (float)(0.42 - 0.5 * cos(phase) + 0.08 * cos(2.0 * phase));
+  }
+  // Nothing was heard yet.
+  for (int32_t i = 0; i < bins; i++) {
+    self->frequency_data->data[i] = -INFINITY;
+  }
+  return self;
+}
+
+static void process_analyser(tau_context* context, tau_node* node) {
+  (void)context;
+  analyser* self = ((analyser_state*)node->state)->self;
+  int32_t channels = node->input_channels;
+  int64_t written = tau_atomic_load_relaxed_i64(&self->written);
+  // The ring holds whole quanta, so a quantum never wraps around it.
+  float* quantum = self->ring + (written & (self->capacity - 1));
+  if (node->input_silent) {
+    memset(quantum, 0, TAU_QUANTUM * sizeof(float));
+    tau_node_output_silence(node, channels);
+  } else {
+    tau_bus_mix(quantum, 1, node->input, channels,
+                node->channel_interpretation, 0);
+    memcpy(node->output, node->input,
+           (size_t)channels * TAU_QUANTUM * sizeof(float));
+    node->output_channels = channels;
+    node->output_silent = 0;
+  }
+  tau_atomic_store_i64(&self->written, written + TAU_QUANTUM);
+}
+
+static void destroy_analyser(tau_node* node) {
+  analyser_unref(((analyser_state*)node->state)->self);
+}
+
+static const tau_node_ops analyser_ops = {process_analyser,
+                                          destroy_analyser};
+
+// The copy out of the ring races with the rendering thread by design, and
+// is checked afterwards, so ThreadSanitizer is told not to watch it.
+#if defined(__GNUC__) || defined(__clang__)
+#define NO_SANITIZE_THREAD __attribute__((no_sanitize("thread")))
+#else
+#define NO_SANITIZE_THREAD
+#endif
+
+// Copies `count` frames of the ring from `start`, wrapping around it, into
+// `frame`.
+NO_SANITIZE_THREAD static void copy_ring(const analyser* self, int32_t start,
+                                         int32_t count, float* frame) {
+  int32_t first =
+      self->capacity - start < count ? self->capacity - start : count;
+  const float* ring = self->ring + start;
+  for (int32_t i = 0; i < first; i++) {
+    frame[i] = ring[i];
+  }
+  for (int32_t i = first; i < count; i++) {
+    frame[i] = self->ring[i - first];
+  }
+}
+
+// Copies the last `fft_size` frames of the ring into `frame`. Returns the
+// frames written up to them.
+static int64_t snapshot(analyser* self, float* frame) {
+  int32_t size = self->fft_size;
+  for (;;) {
+    int64_t written = tau_atomic_load_i64(&self->written);
+    copy_ring(self, (int32_t)((written - size) & (self->capacity - 1)), size,
+              frame);
+    tau_atomic_fence();
+    // The rendering thread may be writing the quantum after the last one
+    // published; the copy holds if that quantum ends before the copied
+    // frames come around again.
+    int64_t after = tau_atomic_load_i64(&self->written);
+    if (after - written <= self->capacity - size - TAU_QUANTUM) {
+      return written;
+    }
+  }
+}
+
+// The analyser behind `handle`, or NULL. Called with the control lock held.
+static analyser* find_analyser(tau_context* context, int32_t handle) {
+  tau_node* node = tau_context_node(context, handle);
+  return node != NULL && node->ops == &analyser_ops
+             ? ((analyser_state*)node->state)->self
+             : NULL;
+}
+
+// The analyser behind `handle` with a reference, which the caller gives back
+// with `analyser_unref`, or NULL.
+static analyser* acquire(tau_context* context, int32_t handle) {
+  tau_control_lock(context);
+  analyser* self = find_analyser(context, handle);
+  if (self != NULL) {
+    tau_atomic_fetch_add_i32(&self->references, 1);
+  }
+  tau_control_unlock(context);
+  return self;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_analyser_create(tau_context* context,
+                                              int32_t fft_size) {
+  if (context == NULL || fft_size < TAU_ANALYSER_MIN_FFT_SIZE ||
+      fft_size > TAU_ANALYSER_MAX_FFT_SIZE ||
+      (fft_size & (fft_size - 1)) != 0) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  analyser* self = analyser_new(fft_size, context->sample_rate);
+  if (self == NULL) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  tau_node* node =
+      tau_node_create(context, &analyser_ops, sizeof(analyser_state), 0);
+  if (node == NULL) {
+    analyser_free(self);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  ((analyser_state*)node->state)->self = self;
+  return node->id;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_analyser_set_smoothing(tau_context* context,
+                                                     int32_t node,
+                                                     float smoothing) {
+  if (context == NULL || !(smoothing >= 0.0f && smoothing <= 1.0f)) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  analyser* self = acquire(context, node);
+  if (self == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_mutex_lock(&self->lock);
+  self->smoothing = smoothing;
+  tau_mutex_unlock(&self->lock);
+  analyser_unref(self);
+  return TAU_OK;
+}
+
+FFI_PLUGIN_EXPORT tau_audio_buffer* tau_analyser_frequency_buffer(
+    tau_context* context, int32_t node) {
+  if (context == NULL) {
+    return NULL;
+  }
+  tau_control_lock(context);
+  analyser* self = find_analyser(context, node);
+  tau_audio_buffer* buffer = self != NULL ? self->frequency_data : NULL;
+  if (buffer != NULL) {
+    tau_audio_buffer_retain(buffer);
+  }
+  tau_control_unlock(context);
+  return buffer;
+}
+
+FFI_PLUGIN_EXPORT tau_audio_buffer* tau_analyser_time_domain_buffer(
+    tau_context* context, int32_t node) {
+  if (context == NULL) {
+    return NULL;
+  }
+  tau_control_lock(context);
+  analyser* self = find_analyser(context, node);
+  tau_audio_buffer* buffer = self != NULL ? self->time_domain_data : NULL;
+  if (buffer != NULL) {
+    tau_audio_buffer_retain(buffer);
+  }
+  tau_control_unlock(context);
+  return buffer;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_analyser_get_float_frequency_data(
+    tau_context* context, int32_t node) {
+  if (context == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  analyser* self = acquire(context, node);
+  if (self == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_mutex_lock(&self->lock);
+  // Spectra are smoothed once per batch of new frames, however often they
+  // are asked for.
+  if (tau_atomic_load_i64(&self->written) != self->spectrum_written) {
+    const tau_kernel_table* kernels = tau_kernels();
+    int32_t size = self->fft_size;
+    self->spectrum_written = snapshot(self, self->frame);
+    kernels->multiply(self->frame, self->frame, self->window, size);
+    tau_fft_forward(&self->fft, self->frame, self->re, self->im);
+    kernels->smooth_magnitude(self->smoothed, self->re, self->im,
+                              1.0f / size, self->smoothing, size / 2);
+    kernels->decibels(self->frequency_data->data, self->smoothed, size / 2);
+  }
+  tau_mutex_unlock(&self->lock);
+  analyser_unref(self);
+  return TAU_OK;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_analyser_get_float_time_domain_data(
+    tau_context* context, int32_t node) {
+  if (context == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  analyser* self = acquire(context, node);
+  if (self == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_mutex_lock(&self->lock);
+  snapshot(self, self->time_domain_data->data);
+  tau_mutex_unlock(&self->lock);
+  analyser_unref(self);
+  return TAU_OK;
+}
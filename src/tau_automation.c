@@ -0,0 +1,526 @@
+// Automation timelines of parameters.
+//
+// Scheduling an event queues a command for the rendering thread, which
+// inserts the event into the sorted timeline of its parameter before the
+// next quantum. Nodes then evaluate their parameters a quantum at a time:
+// between two events the value follows a closed form, so each run of
+// samples is filled by one vector kernel rather than by a branch per sample,
+// and a parameter no event changes during the quantum is not filled at all.
+//
+// The rendering thread never frees memory: a command scheduling a curve
+// stays with its event until the event is gone, and a timeline outgrown
+// goes back with the command that outgrew it.
+//
+// Scheduling takes the control lock, as every graph edit does: the lock
+// keeps the node of a handle alive while the command is made, and orders
+// the events of concurrent schedulers. The rendering thread never takes it,
+// so insertion never waits on rendering and rendering never waits on it;
+// only scheduling threads wait for one another.
+#include <math.h>
+#include <string.h>
+
+#include "tau_engine.h"
+
+// The first capacity of a timeline.
+#define TAU_MIN_EVENTS 16
+
+// --- Scheduling ---
+
+// Queues `event` for the parameter `param` of `node`, with the `length`
+// values of `curve` if it has any.
+static int32_t post(tau_context* context, int32_t node, int32_t param,
+                    const tau_automation_event* event, const float* curve,
+                    int32_t length) {
+  if (event->value != event->value || !(event->frame >= 0)) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_control_lock(context);
+  tau_node* target = tau_context_node(context, node);
+  tau_param* target_param =
+      target != NULL ? tau_node_param(target, param) : NULL;
+  tau_command* command =
+      target_param != NULL
+          ? tau_command_create(context, TAU_COMMAND_AUTOMATION, target, length)
+          : NULL;
+  if (command != NULL) {
+    command->param = target_param;
+    command->event = *event;
+    if (length > 0) {
+      memcpy(command->curve, curve, (size_t)length * sizeof(float));
+      command->event.curve = command->curve;
+      command->event.curve_length = length;
+    }
+    tau_command_post(context, command);
+  }
+  tau_control_unlock(context);
+  if (target_param == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  return command != NULL ? TAU_OK : TAU_ERROR_OUT_OF_MEMORY;
+}
+
+static int32_t schedule(tau_context* context, int32_t node, int32_t param,
+                        int32_t type, float value, double time,
+                        double length) {
+  if (context == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_automation_event event;
+  memset(&event, 0, sizeof(event));
+  event.type = type;
+  event.value = value;
+  event.frame = time * context->sample_rate;
+  event.length = length * context->sample_rate;
+  return post(context, node, param, &event, NULL, 0);
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_param_set_value_at_time(tau_context* context,
+                                                      int32_t node,
+                                                      int32_t param,
+                                                      float value,
+                                                      double start_time) {
+  return schedule(context, node, param, TAU_EVENT_SET_VALUE, value,
+                  start_time, 0.0);
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_param_linear_ramp_to_value_at_time(
+    tau_context* context, int32_t node, int32_t param, float value,
+    double end_time) {
+  return schedule(context, node, param, TAU_EVENT_LINEAR_RAMP, value,
+                  end_time, 0.0);
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_param_exponential_ramp_to_value_at_time(
+    tau_context* context, int32_t node, int32_t param, float value,
+    double end_time) {
+  if (value == 0.0f) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  return schedule(context, node, param, TAU_EVENT_EXPONENTIAL_RAMP, value,
+                  end_time, 0.0);
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_param_set_target_at_time(tau_context* context,
+                                                       int32_t node,
+                                                       int32_t param,
+                                                       float target,
+                                                       double start_time,
+                                                       double time_constant) {
+  if (!(time_constant >= 0)) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  return schedule(context, node, param, TAU_EVENT_SET_TARGET, target,
+                  start_time, time_constant);
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_param_set_value_curve_at_time(
+    tau_context* context, int32_t node, int32_t param, const float* values,
+    int32_t length, double start_time, double duration) {
+  if (context == NULL || values == NULL || length < 2 || !(duration > 0)) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  for (int32_t i = 0; i < length; i++) {
+    if (values[i] != values[i]) {
+      return TAU_ERROR_INVALID_ARGUMENT;
+    }
+  }
+  tau_automation_event event;
+  memset(&event, 0, sizeof(event));
+  event.type = TAU_EVENT_SET_VALUE_CURVE;
+  event.value = values[length - 1];
+  event.frame = start_time * context->sample_rate;
+  event.length = duration * context->sample_rate;
+  return post(context, node, param, &event, values, length);
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_param_cancel_scheduled_values(
+    tau_context* context, int32_t node, int32_t param, double cancel_time) {
+  return schedule(context, node, param, TAU_EVENT_CANCEL, 0.0f, cancel_time,
+                  0.0);
+}
+
+FFI_PLUGIN_EXPORT float tau_param_get_value(tau_context* context, int32_t node,
+                                            int32_t param) {
+  if (context == NULL) {
+    return NAN;
+  }
+  float value = NAN;
+  tau_control_lock(context);
+  tau_node* target = tau_context_node(context, node);
+  tau_param* target_param =
+      target != NULL ? tau_node_param(target, param) : NULL;
+  if (target_param != NULL) {
+    // Written by the rendering thread every quantum.
+    int32_t bits = tau_atomic_load_relaxed_i32(&target_param->published);
+    memcpy(&value, &bits, sizeof(value));
+  }
+  tau_control_unlock(context);
+  return value;
+}
+
+// --- Timelines ---
+
+static int is_ramp(const tau_automation_event* event) {
+  return event->type == TAU_EVENT_LINEAR_RAMP ||
+         event->type == TAU_EVENT_EXPONENTIAL_RAMP;
+}
+
+// The first event of the timeline at or after `frame`, or `param->count`.
+// With `after`, the first one after `frame`.
+static int32_t search(const tau_param* param, double frame, int after) {
+  int32_t low = param->first;
+  int32_t high = param->count;
+  while (low < high) {
+    int32_t middle = low + (high - low) / 2;
+    double middle_frame = param->events[middle].frame;
+    if (middle_frame < frame || (after && middle_frame == frame)) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+// Makes room for one more event, for `command`, which takes the outgrown
+// timeline back. Returns 0 if memory is exhausted.
+static int reserve(tau_param* param, tau_command* command) {
+  if (param->first > 0) {
+    memmove(param->events, param->events + param->first,
+            (size_t)(param->count - param->first) *
+                sizeof(tau_automation_event));
+    param->count -= param->first;
+    param->first = 0;
+  }
+  if (param->count < param->capacity) {
+    return 1;
+  }
+  int32_t capacity =
+      param->capacity > 0 ? param->capacity * 2 : TAU_MIN_EVENTS;
+  tau_automation_event* events = (tau_automation_event*)tau_memory_alloc(
+      (size_t)capacity * sizeof(tau_automation_event), sizeof(double));
+  if (events == NULL) {
+    return 0;
+  }
+  if (param->count > 0) {
+    memcpy(events, param->events,
+           (size_t)param->count * sizeof(tau_automation_event));
+  }
+  command->memory[0] = param->events;
+  param->events = events;
+  param->capacity = capacity;
+  return 1;
+}
+
+static void cancel(tau_context* context, tau_param* param, double frame) {
+  int32_t from = search(param, frame, 0);
+  for (int32_t i = from; i < param->count; i++) {
+    tau_command_retire(context, param->events[i].command);
+  }
+  param->count = from;
+}
+
+// Inserts `event`, scheduled by `command`, after the events of the same
+// frame unless one has the same type, which it replaces as in Web Audio.
+// Returns whether the timeline keeps the command.
+static int insert(tau_context* context, tau_param* param,
+                  tau_automation_event event, tau_command* command) {
+  if (event.curve != NULL) {
+    event.command = command;
+  }
+  // Before any event, a ramp starts when it is scheduled.
+  if (param->first == param->count && param->current.frame < 0) {
+    param->current.frame = (double)context->frame;
+  }
+  param->automated = 1;
+  for (int32_t i = search(param, event.frame, 0);
+       i < param->count && param->events[i].frame == event.frame; i++) {
+    if (param->events[i].type == event.type) {
+      tau_command_retire(context, param->events[i].command);
+      param->events[i] = event;
+      return event.command != NULL;
+    }
+  }
+  if (!reserve(param, command)) {
+    return 0;
+  }
+  int32_t at = search(param, event.frame, 1);
+  memmove(param->events + at + 1, param->events + at,
+          (size_t)(param->count - at) * sizeof(tau_automation_event));
+  param->events[at] = event;
+  param->count++;
+  return event.command != NULL;
+}
+
+// Sets the value of `param`, and publishes it for `tau_param_get_value`.
+static void set_value(tau_param* param, float value) {
+  int32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  param->value = value;
+  tau_atomic_store_relaxed_i32(&param->published, bits);
+}
+
+int tau_automation_apply(tau_context* context, tau_command* command) {
+  tau_param* param = command->param;
+  tau_automation_event event = command->event;
+  if (command->type == TAU_COMMAND_PARAM_VALUE) {
+    if (param->automated) {
+      // Scheduled at the current time.
+      event.type = TAU_EVENT_SET_VALUE;
+      event.frame = (double)context->frame;
+      return insert(context, param, event, command);
+    }
+    float value = event.value;
+    if (value < param->min_value) {
+      value = param->min_value;
+    } else if (value > param->max_value) {
+      value = param->max_value;
+    }
+    set_value(param, value);
+    param->current.value = value;
+    return 0;
+  }
+  if (event.type == TAU_EVENT_CANCEL) {
+    cancel(context, param, event.frame);
+    return 0;
+  }
+  return insert(context, param, event, command);
+}
+
+void tau_param_destroy(tau_context* context, tau_param* param) {
+  for (int32_t i = param->first; i < param->count; i++) {
+    tau_command_free(context, param->events[i].command);
+  }
+  tau_command_free(context, param->current.command);
+  tau_memory_free(param->events);
+  param->events = NULL;
+  param->current.command = NULL;
+}
+
+// --- Evaluation ---
+
+// The value at `frame`, at or after the last event reached and before the
+// next one, ignoring a ramp towards the next one.
+static double segment_value(const tau_param* param, double frame) {
+  const tau_automation_event* current = &param->current;
+  switch (current->type) {
+    case TAU_EVENT_SET_TARGET: {
+      if (current->length == 0.0) {
+        return current->value;
+      }
+      double decay = exp(-(frame - current->frame) / current->length);
+      return current->value + (param->current_value - current->value) * decay;
+    }
+    case TAU_EVENT_SET_VALUE_CURVE: {
+      double position = (frame - current->frame) / current->length *
+                        (current->curve_length - 1);
+      if (!(position < current->curve_length - 1)) {
+        return current->value;
+      }
+      position = position > 0.0 ? position : 0.0;
+      int32_t index = (int32_t)position;
+      double low = current->curve[index];
+      return low + (current->curve[index + 1] - low) * (position - index);
+    }
+    default:
+      return current->value;
+  }
+}
+
+// Where a ramp towards the next event starts: the frame and value of the
+// last event reached.
+static void ramp_start(const tau_param* param, double* frame,
+                       double* value) {
+  const tau_automation_event* current = &param->current;
+  *frame = current->frame;
+  *value = current->value;
+  if (current->type == TAU_EVENT_SET_TARGET) {
+    *value = param->current_value;
+  } else if (current->type == TAU_EVENT_SET_VALUE_CURVE) {
+    *frame += current->length;
+  }
+}
+
+// The value at `frame` on the ramp towards `next`.
+static double ramp_value(const tau_param* param,
+                         const tau_automation_event* next, double frame) {
+  double start_frame;
+  double start;
+  ramp_start(param, &start_frame, &start);
+  double span = next->frame - start_frame;
+  if (!(span > 0.0)) {
+    return start;
+  }
+  double progress = (frame - start_frame) / span;
+  if (next->type == TAU_EVENT_LINEAR_RAMP) {
+    return start + (next->value - start) * progress;
+  }
+  // An exponential ramp from 0 or across 0 holds its start.
+  if (!(start * next->value > 0.0)) {
+    return start;
+  }
+  return start * pow(next->value / start, progress);
+}
+
+// Makes every event at or before `frame` the current one, in order.
+static void advance(tau_context* context, tau_param* param, double frame) {
+  while (param->first < param->count &&
+         param->events[param->first].frame <= frame) {
+    tau_automation_event* event = &param->events[param->first++];
+    // A target approach starts from the value it interrupts.
+    param->current_value = event->type == TAU_EVENT_SET_TARGET
+                               ? (float)segment_value(param, event->frame)
+                               : event->value;
+    tau_command_retire(context, param->current.command);
+    param->current = *event;
+  }
+  if (param->first == param->count) {
+    param->first = 0;
+    param->count = 0;
+  }
+}
+
+// Whether the value stays at `*value` over the quantum starting at `frame`.
+static int constant_over(const tau_param* param, double frame,
+                         double* value) {
+  if (param->first < param->count) {
+    const tau_automation_event* next = &param->events[param->first];
+    if (is_ramp(next) || next->frame <= frame + (TAU_QUANTUM - 1)) {
+      return 0;
+    }
+  }
+  const tau_automation_event* current = &param->current;
+  switch (current->type) {
+    case TAU_EVENT_SET_TARGET: {
+      // Close enough to its target, an approach is over.
+      double distance = segment_value(param, frame) - current->value;
+      if (fabs(distance) > 1e-7 * fabs(current->value) + 1e-10) {
+        return 0;
+      }
+      *value = current->value;
+      return 1;
+    }
+    case TAU_EVENT_SET_VALUE_CURVE:
+      if (frame < current->frame + current->length) {
+        return 0;
+      }
+      *value = current->value;
+      return 1;
+    default:
+      *value = current->value;
+      return 1;
+  }
+}
+
+// Fills `values[start, end)`, the samples of the quantum at `frame` before
+// the next event.
+static void fill(const tau_kernel_table* kernels, const tau_param* param,
+                 float* values, double frame, int32_t start, int32_t end) {
+  const tau_automation_event* next =
+      param->first < param->count ? &param->events[param->first] : NULL;
+  const tau_automation_event* current = &param->current;
+  double first = frame + start;
+  int32_t count = end - start;
+  float* out = values + start;
+  if (next != NULL && is_ramp(next)) {
+    double start_frame;
+    double start_value;
+    ramp_start(param, &start_frame, &start_value);
+    double span = next->frame - start_frame;
+    double value = ramp_value(param, next, first);
+    if (!(span > 0.0) ||
+        (next->type == TAU_EVENT_EXPONENTIAL_RAMP &&
+         !(start_value * next->value > 0.0))) {
+      kernels->ramp(out, (float)value, 0.0f, count);
+    } else if (next->type == TAU_EVENT_LINEAR_RAMP) {
+      kernels->ramp(out, (float)value,
+                    (float)((next->value - start_value) / span), count);
+    } else {
+      kernels->geometric(out, 0.0f, (float)value,
+                         (float)pow(next->value / start_value, 1.0 / span),
+                         count);
+    }
+    return;
+  }
+  switch (current->type) {
+    case TAU_EVENT_SET_TARGET:
+      if (current->length > 0.0) {
+        kernels->geometric(out, current->value,
+                           (float)(segment_value(param, first) -
+                                   current->value),
+                           (float)exp(-1.0 / current->length), count);
+        return;
+      }
+      break;
+    case TAU_EVENT_SET_VALUE_CURVE: {
+      // The positions in the curve are a ramp, computed in place.
+      double scale = (current->curve_length - 1) / current->length;
+      float last = (float)(current->curve_length - 1);
+      kernels->ramp(out, (float)((first - current->frame) * scale),
+                    (float)scale, count);
+      for (int32_t i = 0; i < count; i++) {
+        float position = out[i] > 0.0f ? out[i] : 0.0f;
+        if (position >= last) {
+          out[i] = current->value;
+          continue;
+        }
+        int32_t index = (int32_t)position;
+        float low = current->curve[index];
+        out[i] = low + (current->curve[index + 1] - low) * (position - index);
+      }
+      return;
+    }
+    default:
+      break;
+  }
+  kernels->ramp(out, current->value, 0.0f, count);
+}
+
+static float clamp(const tau_param* param, double value) {
+  return value < param->min_value   ? param->min_value
+         : value > param->max_value ? param->max_value
+                                    : (float)value;
+}
+
+const float* tau_param_render(tau_context* context, tau_param* param) {
+  double frame = (double)context->frame;
+  advance(context, param, frame);
+  double value;
+  if (constant_over(param, frame, &value)) {
+    set_value(param, clamp(param, value));
+    return NULL;
+  }
+  float* values = (float*)tau_arena_alloc(TAU_QUANTUM * sizeof(float));
+  if (values == NULL) {
+    set_value(param, clamp(param, segment_value(param, frame)));
+    return NULL;
+  }
+  const tau_kernel_table* kernels = tau_kernels();
+  int32_t start = 0;
+  while (start < TAU_QUANTUM) {
+    advance(context, param, frame + start);
+    int32_t end = TAU_QUANTUM;
+    if (param->first < param->count) {
+      double until = ceil(param->events[param->first].frame - frame);
+      end = until < end ? (int32_t)until : end;
+    }
+    fill(kernels, param, values, frame, start, end);
+    start = end;
+  }
+  kernels->clip(values, values, param->min_value, param->max_value,
+                TAU_QUANTUM);
+  set_value(param, values[0]);
+  return values;
+}
+
+float tau_param_render_k(tau_context* context, tau_param* param) {
+  double frame = (double)context->frame;
+  advance(context, param, frame);
+  const tau_automation_event* next =
+      param->first < param->count ? &param->events[param->first] : NULL;
+  double value = next != NULL && is_ramp(next)
+                     ? ramp_value(param, next, frame)
+                     : segment_value(param, frame);
+  set_value(param, clamp(param, value));
+  return param->value;
+}
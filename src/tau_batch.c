@@ -0,0 +1,69 @@
+#include "tau_ffi.h"
+
+FFI_PLUGIN_EXPORT tau_batch* tau_batch_create(int32_t capacity) {
+  if (capacity <= 0) {
+    return NULL;
+  }
+  // The header and the four arrays share a single allocation.
+  size_t array_size = (size_t)capacity * sizeof(int32_t);
+  tau_batch* batch = (tau_batch*)malloc(sizeof(tau_batch) + 4 * array_size);
+  if (batch == NULL) {
+    return NULL;
+  }
+  int32_t* arrays = (int32_t*)(batch + 1);
+  batch->opcodes = arrays;
+  batch->a = arrays + capacity;
+  batch->b = arrays + 2 * (size_t)capacity;
+  batch->results = arrays + 3 * (size_t)capacity;
+  batch->capacity = capacity;
+  batch->count = 0;
+  return batch;
+}
+
+FFI_PLUGIN_EXPORT void tau_batch_destroy(tau_batch* batch) { free(batch); }
+
+FFI_PLUGIN_EXPORT int32_t tau_batch_execute(tau_batch* batch) {
+  if (batch == NULL) {
+    return 0;
+  }
+  int32_t count = batch->count;
+  if (count > batch->capacity) {
+    count = batch->capacity;
+  }
+  const int32_t* opcodes = batch->opcodes;
+  const int32_t* a = batch->a;
+  const int32_t* b = batch->b;
+  int32_t* results = batch->results;
+
+  // Commands are dispatched per run of identical opcodes rather than one by
+  // one, so each run is a plain loop the compiler can vectorize.
+  int32_t start = 0;
+  while (start < count) {
+    int32_t opcode = opcodes[start];
+    int32_t end = start + 1;
+    while (end < count && opcodes[end] == opcode) {
+      end++;
+    }
+    switch (opcode) {
+      case TAU_OP_SUM:
+        for (int32_t i = start; i < end; i++) {
+          results[i] = a[i] + b[i];
+        }
+        break;
+      case TAU_OP_SUBTRACT:
+        for (int32_t i = start; i < end; i++) {
+          results[i] = a[i] - b[i];
+        }
+        break;
+      case TAU_OP_MULTIPLY:
+        for (int32_t i = start; i < end; i++) {
+          results[i] = a[i] * b[i];
+        }
+        break;
+      default:
+        return start;
+    }
+    start = end;
+  }
+  return count;
+}
@@ -0,0 +1,529 @@
+// The biquad filter node, as the Web Audio `BiquadFilterNode`, with several
+// bands in series for equalizers.
+//
+// Each band of each channel is a biquad section in transposed direct form
+// II, and the `biquad` kernel runs the sections as the lanes of vector
+// registers rather than one after the other. The lanes of a run are the
+// bands of as many channels as fit: band `b` runs `b` frames behind band 0,
+// on what band `b - 1` output the frame before, so that sections in series
+// still run side by side. A quantum then takes a row more per band after
+// the first, during which the lanes not started yet or already done hold
+// their state.
+//
+// The coefficients of a band are only computed again when its type or the
+// values of its parameters change. While a parameter changes within a
+// quantum, the bands are filtered one after the other for that quantum, the
+// automated ones with coefficients computed for every frame, as the Web
+// Audio specification has them.
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "tau_engine.h"
+
+#define TAU_PI 3.14159265358979323846
+
+// The lanes of a run of the kernel. Its rows take at most
+// `(TAU_QUANTUM + TAU_BIQUAD_MAX_BANDS) * PASS_LANES` floats, which stay in
+// the first level cache.
+#define PASS_LANES 32
+
+// Filters of fewer sections than this over all of their channels run them
+// one after the other: the kernel would leave its vectors mostly empty.
+#define MIN_LANES 4
+
+// States below this magnitude are flushed to 0 after every quantum, so that
+// a filter ringing out never computes on subnormal numbers.
+#define TINY_STATE 1e-15f
+
+// The parameters of a band, in this order in `node->params`, with the ids
+// `TAU_PARAM_FREQUENCY`, `TAU_PARAM_DETUNE`, `TAU_PARAM_Q` and
+// `TAU_PARAM_GAIN` offset by the band.
+enum {
+  BAND_FREQUENCY,
+  BAND_DETUNE,
+  BAND_Q,
+  BAND_GAIN,
+  BAND_PARAMS,
+};
+
+// `b0, b1, b2, a1, a2`, normalized by `a0`.
+enum { COEFFICIENTS = 5 };
+
+typedef struct band {
+  // The type and parameter values the coefficients were computed for. The
+  // type is -1 until they are.
+  int32_t type;
+  float values[BAND_PARAMS];
+  float coefficients[COEFFICIENTS];
+} band;
+
+typedef struct biquad {
+  int32_t bands;
+  // The type of each band, set by the control threads.
+  volatile int32_t types[TAU_BIQUAD_MAX_BANDS];
+  band band[TAU_BIQUAD_MAX_BANDS];
+  // The lanes of a run: band `b` of channel `c` is lane `c * bands + b`,
+  // for `pass_channels` channels. The coefficients are those of the bands,
+  // repeated for every channel.
+  int32_t pass_channels;
+  float coefficients[COEFFICIENTS][PASS_LANES];
+  int32_t delays[PASS_LANES];
+  int32_t links[PASS_LANES];
+  // The state of band `b` of channel `c`, at `c * bands + b`, for every
+  // channel the input can have.
+  float* s1;
+  float* s2;
+  // Whether every state is 0, so that a silent input gives a silent output.
+  int32_t quiet;
+} biquad;
+
+typedef struct biquad_state {
+  biquad* self;
+} biquad_state;
+
+static void biquad_free(biquad* self) {
+  tau_memory_free(self->s1);
+  tau_memory_free(self->s2);
+  tau_memory_free(self);
+}
+
+// The gain a band of `type` reduces to at the ends of the range of
+// `frequency`, relative to the Nyquist frequency, or for a `q` that is not
+// positive, or NAN if it does not. `a` is the amplitude of the gain.
+static double reduced_gain(int32_t type, double frequency, double q,
+                           double a) {
+  int outside = frequency <= 0.0 || frequency >= 1.0;
+  switch (type) {
+    case TAU_BIQUAD_LOWPASS:
+      return outside ? (frequency >= 1.0 ? 1.0 : 0.0) : NAN;
+    case TAU_BIQUAD_HIGHPASS:
+      return outside ? (frequency >= 1.0 ? 0.0 : 1.0) : NAN;
+    case TAU_BIQUAD_BANDPASS:
+      return outside ? 0.0 : q <= 0.0 ? 1.0 : NAN;
+    case TAU_BIQUAD_LOWSHELF:
+      return outside ? (frequency >= 1.0 ? a * a : 1.0) : NAN;
+    case TAU_BIQUAD_HIGHSHELF:
+      return outside ? (frequency >= 1.0 ? 1.0 : a * a) : NAN;
+    case TAU_BIQUAD_PEAKING:
+      return outside ? 1.0 : q <= 0.0 ? a * a : NAN;
+    case TAU_BIQUAD_NOTCH:
+      return outside ? 1.0 : q <= 0.0 ? 0.0 : NAN;
+    default:
+      return outside ? 1.0 : q <= 0.0 ? -1.0 : NAN;
+  }
+}
+
+// Computes the coefficients of a band of `type` into `k`, with the formulas
+// of the Web Audio specification. `frequency` is relative to the Nyquist
+// frequency.
+static void compute_coefficients(int32_t type, double frequency, double q,
+                                 double gain, float* k) {
+  double a = pow(10.0, gain / 40.0);
+  double flat = reduced_gain(type, frequency, q, a);
+  if (!isnan(flat)) {
+    k[0] = (float)flat;
+    k[1] = k[2] = k[3] = k[4] = 0.0f;
+    return;
+  }
+  double w0 = TAU_PI * frequency;
+  double cosine = cos(w0);
+  double sine = sin(w0);
+  double alpha_q = sine / (2.0 * q);
+  double alpha_db = sine / (2.0 * pow(10.0, q / 20.0));
+  // The shelves have a slope of 1.
+  double alpha_s = sine / 2.0 * sqrt(2.0);
+  double two_sqrt_a_alpha = 2.0 * sqrt(a) * alpha_s;
+  double b0, b1, b2, a0, a1, a2;
+  switch (type) {
+    case TAU_BIQUAD_LOWPASS:
+      b0 = (1.0 - cosine) / 2.0;
+      b1 = 1.0 - cosine;
+      b2 = b0;
+      a0 = 1.0 + alpha_db;
+      a1 = -2.0 * cosine;
+      a2 = 1.0 - alpha_db;
+      break;
+    case TAU_BIQUAD_HIGHPASS:
+      b0 = (1.0 + cosine) / 2.0;
+      b1 = -(1.0 + cosine);
+      b2 = b0;
+      a0 = 1.0 + alpha_db;
+      a1 = -2.0 * cosine;
+      a2 = 1.0 - alpha_db;
+      break;
+    case TAU_BIQUAD_BANDPASS:
+      b0 = alpha_q;
+      b1 = 0.0;
+      b2 = -alpha_q;
+      a0 = 1.0 + alpha_q;
+      a1 = -2.0 * cosine;
+      a2 = 1.0 - alpha_q;
+      break;
+    case TAU_BIQUAD_LOWSHELF:
+      b0 = a * ((a + 1.0) - (a - 1.0) * cosine + two_sqrt_a_alpha);
+      b1 = 2.0 * a * ((a - 1.0) - (a + 1.0) * cosine);
+      b2 = a * ((a + 1.0) - (a - 1.0) * cosine - two_sqrt_a_alpha);
+      a0 = (a + 1.0) + (a - 1.0) * cosine + two_sqrt_a_alpha;
+      a1 = -2.0 * ((a - 1.0) + (a + 1.0) * cosine);
+      a2 = (a + 1.0) + (a - 1.0) * cosine - two_sqrt_a_alpha;
+      break;
+    case TAU_BIQUAD_HIGHSHELF:
+      b0 = a * ((a + 1.0) + (a - 1.0) * cosine + two_sqrt_a_alpha);
+      b1 = -2.0 * a * ((a - 1.0) + (a + 1.0) * cosine);
+      b2 = a * ((a + 1.0) + (a - 1.0) * cosine - two_sqrt_a_alpha);
+      a0 = (a + 1.0) - (a - 1.0) * cosine + two_sqrt_a_alpha;
+      a1 = 2.0 * ((a - 1.0) - (a + 1.0) * cosine);
+      a2 = (a + 1.0) - (a - 1.0) * cosine - two_sqrt_a_alpha;
+      break;
+    case TAU_BIQUAD_PEAKING:
+      b0 = 1.0 + alpha_q * a;
+      b1 = -2.0 * cosine;
+      b2 = 1.0 - alpha_q * a;
+      a0 = 1.0 + alpha_q / a;
+      a1 = -2.0 * cosine;
+      a2 = 1.0 - alpha_q / a;
+      break;
+    case TAU_BIQUAD_NOTCH:
+      b0 = 1.0;
+      b1 = -2.0 * cosine;
+      b2 = 1.0;
+      a0 = 1.0 + alpha_q;
+      a1 = -2.0 * cosine;
+      a2 = 1.0 - alpha_q;
+      break;
+    default:
+      b0 = 1.0 - alpha_q;
+      b1 = -2.0 * cosine;
+      b2 = 1.0 + alpha_q;
+      a0 = 1.0 + alpha_q;
+      a1 = -2.0 * cosine;
+      a2 = 1.0 - alpha_q;
+      break;
+  }
+  k[0] = (float)(b0 / a0);
+  k[1] = (float)(b1 / a0);
+  k[2] = (float)(b2 / a0);
+  k[3] = (float)(a1 / a0);
+  k[4] = (float)(a2 / a0);
+}
+
+// Computes the coefficients of `section` again if `type` or `values`
+// changed. Returns whether they did.
+static int refresh_band(band* section, int32_t type, const float* values,
+                        float nyquist) {
+  if (section->type == type &&
+      memcmp(section->values, values, sizeof(section->values)) == 0) {
+    return 0;
+  }
+  section->type = type;
+  memcpy(section->values, values, sizeof(section->values));
+  double frequency = values[BAND_FREQUENCY] *
+                     pow(2.0, values[BAND_DETUNE] / 1200.0) / nyquist;
+  compute_coefficients(type, frequency, values[BAND_Q], values[BAND_GAIN],
+                       section->coefficients);
+  return 1;
+}
+
+// Copies the coefficients of band `b` to its lanes.
+static void tile_band(biquad* self, int32_t b) {
+  for (int32_t c = 0; c < self->pass_channels; c++) {
+    for (int32_t i = 0; i < COEFFICIENTS; i++) {
+      self->coefficients[i][c * self->bands + b] =
+          self->band[b].coefficients[i];
+    }
+  }
+}
+
+// Filters the `TAU_QUANTUM` `samples` in place through a section of
+// coefficients `k`, from the state `*s1` and `*s2`.
+static void filter(float* samples, const float* k, float* s1, float* s2) {
+  float b0 = k[0];
+  float b1 = k[1];
+  float b2 = k[2];
+  float a1 = k[3];
+  float a2 = k[4];
+  float z1 = *s1;
+  float z2 = *s2;
+  for (int32_t i = 0; i < TAU_QUANTUM; i++) {
+    float x = samples[i];
+    float y = b0 * x + z1;
+    z1 = b1 * x - a1 * y + z2;
+    z2 = b2 * x - a2 * y;
+    samples[i] = y;
+  }
+  *s1 = z1;
+  *s2 = z2;
+}
+
+// `filter` with coefficients changing every frame: `k[i * TAU_QUANTUM + f]`
+// is coefficient `i` at frame `f`.
+static void filter_varying(float* samples, const float* k, float* s1,
+                           float* s2) {
+  float z1 = *s1;
+  float z2 = *s2;
+  for (int32_t f = 0; f < TAU_QUANTUM; f++) {
+    float x = samples[f];
+    float y = k[f] * x + z1;
+    z1 = k[TAU_QUANTUM + f] * x - k[3 * TAU_QUANTUM + f] * y + z2;
+    z2 = k[2 * TAU_QUANTUM + f] * x - k[4 * TAU_QUANTUM + f] * y;
+    samples[f] = y;
+  }
+  *s1 = z1;
+  *s2 = z2;
+}
+
+// Computes the coefficients of band `b` for every frame of the quantum into
+// `k`, laid out for `filter_varying`, from `values`, the values of its
+// parameters per frame, or NULL where constant. Frames whose parameters did
+// not change reuse the coefficients of the frame before. The band keeps the
+// coefficients of the last frame.
+static void refresh_band_varying(biquad* self, tau_node* node, int32_t b,
+                                 int32_t type, const float* const* values,
+                                 float nyquist, float* k) {
+  band* section = &self->band[b];
+  tau_param* params = node->params + b * BAND_PARAMS;
+  float frame_values[BAND_PARAMS];
+  for (int32_t f = 0; f < TAU_QUANTUM; f++) {
+    for (int32_t p = 0; p < BAND_PARAMS; p++) {
+      frame_values[p] = values[p] != NULL ? values[p][f] : params[p].value;
+    }
+    refresh_band(section, type, frame_values, nyquist);
+    for (int32_t i = 0; i < COEFFICIENTS; i++) {
+      k[i * TAU_QUANTUM + f] = section->coefficients[i];
+    }
+  }
+  tile_band(self, b);
+}
+
+// Filters `channels` channels of `node->output` in place, one band after the
+// other, with the coefficients per frame in `varying[b]` for the bands that
+// have them.
+static void filter_bands(biquad* self, tau_node* node, int32_t channels,
+                         float* const* varying) {
+  int32_t bands = self->bands;
+  for (int32_t c = 0; c < channels; c++) {
+    float* samples = node->output + c * TAU_QUANTUM;
+    for (int32_t b = 0; b < bands; b++) {
+      float* s1 = &self->s1[c * bands + b];
+      float* s2 = &self->s2[c * bands + b];
+      if (varying[b] != NULL) {
+        filter_varying(samples, varying[b], s1, s2);
+      } else {
+        filter(samples, self->band[b].coefficients, s1, s2);
+      }
+    }
+  }
+}
+
+// Filters `channels` channels from `node->input` into `node->output` with
+// the kernel, `pass_channels` at a time.
+static void filter_lanes(biquad* self, tau_node* node, int32_t channels) {
+  int32_t bands = self->bands;
+  int32_t rows = TAU_QUANTUM + bands - 1;
+  int32_t capacity = self->pass_channels * bands;
+  // A row before the first, and a float before that, for the linked lanes.
+  float* rows_memory = (float*)tau_arena_alloc(
+      (size_t)((rows + 1) * capacity + 1) * sizeof(float));
+  for (int32_t first = 0; first < channels; first += self->pass_channels) {
+    int32_t count = channels - first < self->pass_channels
+                        ? channels - first
+                        : self->pass_channels;
+    int32_t lanes = count * bands;
+    float* signal = rows_memory + lanes + 1;
+    tau_biquad_lanes bank = {
+        lanes,
+        self->coefficients[0],
+        self->coefficients[1],
+        self->coefficients[2],
+        self->coefficients[3],
+        self->coefficients[4],
+        self->s1 + first * bands,
+        self->s2 + first * bands,
+        self->delays,
+        self->links,
+    };
+    // Rows past the quantum are not read but by lanes holding still, which
+    // still compute on them.
+    memset(rows_memory, 0, (size_t)(lanes + 1) * sizeof(float));
+    memset(signal + TAU_QUANTUM * lanes, 0,
+           (size_t)(rows - TAU_QUANTUM) * lanes * sizeof(float));
+    for (int32_t c = 0; c < count; c++) {
+      const float* in = node->input + (first + c) * TAU_QUANTUM;
+      float* lane = signal + c * bands;
+      for (int32_t t = 0; t < TAU_QUANTUM; t++) {
+        lane[t * lanes] = in[t];
+      }
+    }
+    tau_kernel_biquad(&bank, signal, TAU_QUANTUM, rows);
+    for (int32_t c = 0; c < count; c++) {
+      float* out = node->output + (first + c) * TAU_QUANTUM;
+      // The last band of the channel, as many rows late.
+      const float* lane =
+          signal + (bands - 1) * lanes + c * bands + bands - 1;
+      for (int32_t t = 0; t < TAU_QUANTUM; t++) {
+        out[t] = lane[t * lanes];
+      }
+    }
+  }
+}
+
+// Flushes the states of `channels` channels that are nearly 0 to 0. Returns
+// whether every state is 0.
+static int flush_states(biquad* self, int32_t channels) {
+  int quiet = 1;
+  for (int32_t i = 0; i < channels * self->bands; i++) {
+    if (fabsf(self->s1[i]) < TINY_STATE && fabsf(self->s2[i]) < TINY_STATE) {
+      self->s1[i] = 0.0f;
+      self->s2[i] = 0.0f;
+    } else {
+      quiet = 0;
+    }
+  }
+  return quiet;
+}
+
+static void process_biquad(tau_context* context, tau_node* node) {
+  biquad* self = ((biquad_state*)node->state)->self;
+  int32_t channels = node->input_channels;
+  int32_t bands = self->bands;
+  float nyquist = context->sample_rate / 2;
+  // The coefficients per frame of the bands automated over the quantum.
+  float* varying[TAU_BIQUAD_MAX_BANDS];
+  int automated = 0;
+  for (int32_t b = 0; b < bands; b++) {
+    int32_t type = tau_atomic_load_relaxed_i32(&self->types[b]);
+    tau_param* params = node->params + b * BAND_PARAMS;
+    const float* values[BAND_PARAMS];
+    float constant[BAND_PARAMS];
+    int changing = 0;
+    for (int32_t p = 0; p < BAND_PARAMS; p++) {
+      values[p] = tau_param_render(context, &params[p]);
+      constant[p] = params[p].value;
+      changing |= values[p] != NULL;
+    }
+    varying[b] = NULL;
+    if (changing) {
+      varying[b] = (float*)tau_arena_alloc(COEFFICIENTS * TAU_QUANTUM *
+                                           sizeof(float));
+      refresh_band_varying(self, node, b, type, values, nyquist,
+                           varying[b]);
+      automated = 1;
+    } else if (refresh_band(&self->band[b], type, constant, nyquist)) {
+      tile_band(self, b);
+    }
+  }
+  if (node->input_silent && self->quiet) {
+    tau_node_output_silence(node, channels);
+    return;
+  }
+  if (automated || channels * bands < MIN_LANES) {
+    memcpy(node->output, node->input,
+           (size_t)channels * TAU_QUANTUM * sizeof(float));
+    filter_bands(self, node, channels, varying);
+  } else {
+    filter_lanes(self, node, channels);
+  }
+  node->output_channels = channels;
+  node->output_silent = 0;
+  // Channels the input dropped keep their state until it comes back with
+  // them, as a filter per channel would.
+  self->quiet = flush_states(self, TAU_MAX_CHANNELS);
+}
+
+static void destroy_biquad(tau_node* node) {
+  biquad_free(((biquad_state*)node->state)->self);
+}
+
+static const tau_node_ops biquad_ops = {process_biquad, destroy_biquad};
+
+static int valid_type(int32_t type) {
+  return type >= TAU_BIQUAD_LOWPASS && type <= TAU_BIQUAD_ALLPASS;
+}
+
+static biquad* biquad_new(int32_t type, int32_t bands) {
+  biquad* self = (biquad*)tau_memory_calloc(sizeof(biquad), TAU_CACHE_LINE);
+  if (self == NULL) {
+    return NULL;
+  }
+  size_t states = (size_t)TAU_MAX_CHANNELS * bands * sizeof(float);
+  self->bands = bands;
+  self->quiet = 1;
+  self->s1 = (float*)tau_memory_calloc(states, TAU_CACHE_LINE);
+  self->s2 = (float*)tau_memory_calloc(states, TAU_CACHE_LINE);
+  if (self->s1 == NULL || self->s2 == NULL) {
+    biquad_free(self);
+    return NULL;
+  }
+  self->pass_channels = PASS_LANES / bands;
+  for (int32_t b = 0; b < bands; b++) {
+    self->types[b] = type;
+    self->band[b].type = -1;
+  }
+  for (int32_t c = 0; c < self->pass_channels; c++) {
+    for (int32_t b = 0; b < bands; b++) {
+      self->delays[c * bands + b] = b;
+      self->links[c * bands + b] = b > 0;
+    }
+  }
+  return self;
+}
+
+// The biquad filter behind `handle`, or NULL. Called with the control lock
+// held.
+static biquad* find_biquad(tau_context* context, int32_t handle) {
+  tau_node* node = tau_context_node(context, handle);
+  return node != NULL && node->ops == &biquad_ops
+             ? ((biquad_state*)node->state)->self
+             : NULL;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_biquad_filter_create(tau_context* context,
+                                                   int32_t type,
+                                                   int32_t bands) {
+  if (context == NULL || !valid_type(type) || bands < 1 ||
+      bands > TAU_BIQUAD_MAX_BANDS) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  biquad* self = biquad_new(type, bands);
+  if (self == NULL) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  tau_node* node =
+      tau_node_create(context, &biquad_ops, sizeof(biquad_state), 0);
+  if (node == NULL) {
+    biquad_free(self);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  ((biquad_state*)node->state)->self = self;
+  if (!tau_node_reserve_params(node, bands * BAND_PARAMS)) {
+    tau_node_release(context, node->id);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  float nyquist = context->sample_rate / 2;
+  for (int32_t b = 0; b < bands; b++) {
+    int32_t offset = b * TAU_BIQUAD_BAND_STRIDE;
+    tau_node_add_param(node, TAU_PARAM_FREQUENCY + offset, 350, 0, nyquist);
+    tau_node_add_param(node, TAU_PARAM_DETUNE + offset, 0, -153600, 153600);
+    tau_node_add_param(node, TAU_PARAM_Q + offset, 1, -FLT_MAX, FLT_MAX);
+    tau_node_add_param(node, TAU_PARAM_GAIN + offset, 0, -FLT_MAX, 1541);
+  }
+  return node->id;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_biquad_filter_set_type(tau_context* context,
+                                                     int32_t node,
+                                                     int32_t band,
+                                                     int32_t type) {
+  if (context == NULL || !valid_type(type)) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_control_lock(context);
+  biquad* self = find_biquad(context, node);
+  int valid = self != NULL && band >= 0 && band < self->bands;
+  if (valid) {
+    tau_atomic_store_relaxed_i32(&self->types[band], type);
+  }
+  tau_control_unlock(context);
+  return valid ? TAU_OK : TAU_ERROR_INVALID_ARGUMENT;
+}
@@ -0,0 +1,59 @@
+#include <string.h>
+
+#include "tau_ffi.h"
+#include "tau_memory.h"
+#include "tau_platform.h"
+
+FFI_PLUGIN_EXPORT tau_audio_buffer* tau_audio_buffer_create(int32_t channels,
+                                                            int32_t frames,
+                                                            float sample_rate) {
+  if (channels <= 0 || channels > TAU_MAX_CHANNELS || frames <= 0 ||
+      !(sample_rate > 0)) {
+    return NULL;
+  }
+  // Rounding every channel up to a whole number of alignment blocks keeps
+  // each of them aligned.
+  const int32_t block = TAU_AUDIO_BUFFER_ALIGNMENT / sizeof(float);
+  if (frames > INT32_MAX - block) {
+    return NULL;
+  }
+  int32_t stride = (frames + block - 1) / block * block;
+  size_t size = (size_t)channels * stride * sizeof(float);
+  tau_audio_buffer* buffer = (tau_audio_buffer*)tau_memory_alloc(
+      sizeof(tau_audio_buffer), sizeof(void*));
+  float* data = NULL;
+  if (buffer != NULL) {
+    data = (float*)tau_memory_calloc(size, TAU_AUDIO_BUFFER_ALIGNMENT);
+  }
+  if (data == NULL) {
+    tau_memory_free(buffer);
+    return NULL;
+  }
+  buffer->data = data;
+  buffer->channels = channels;
+  buffer->frames = frames;
+  buffer->stride = stride;
+  buffer->sample_rate = sample_rate;
+  buffer->references = 1;
+  buffer->mapped_bytes = 0;
+  return buffer;
+}
+
+FFI_PLUGIN_EXPORT void tau_audio_buffer_retain(tau_audio_buffer* buffer) {
+  tau_atomic_fetch_add_i32(&buffer->references, 1);
+}
+
+FFI_PLUGIN_EXPORT void tau_audio_buffer_release(tau_audio_buffer* buffer) {
+  if (buffer == NULL ||
+      tau_atomic_fetch_add_i32(&buffer->references, -1) != 1) {
+    return;
+  }
+  if (buffer->mapped_bytes > 0) {
+    // Cache entries hold their samples after a header of one alignment block.
+    tau_unmap_file((char*)buffer->data - TAU_AUDIO_BUFFER_ALIGNMENT,
+                   buffer->mapped_bytes);
+  } else {
+    tau_memory_free(buffer->data);
+  }
+  tau_memory_free(buffer);
+}
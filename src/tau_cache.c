@@ -0,0 +1,542 @@
+// Decoded audio cache: decoded files stored as mapped planar float32 entries.
+#include <inttypes.h>
+#include <string.h>
+
+#include "tau_memory.h"
+#include "tau_platform.h"
+
+#if _WIN32
+#include <direct.h>
+#include <sys/utime.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+// --- Content hash ---
+
+// XXH64 with a zero seed, fed in chunks whose sizes are multiples of the
+// 32-byte stripe but for the last one.
+#define PRIME1 0x9E3779B185EBCA87ULL
+#define PRIME2 0xC2B2AE3D27D4EB4FULL
+#define PRIME3 0x165667B19E3779F9ULL
+#define PRIME4 0x85EBCA77C2B2AE63ULL
+#define PRIME5 0x27D4EB2F165667C5ULL
+
+typedef struct hash_state {
+  uint64_t lanes[4];
+  uint64_t length;
+} hash_state;
+
+static uint64_t rotate(uint64_t value, int bits) {
+  return value << bits | value >> (64 - bits);
+}
+
+static uint64_t read_u64(const uint8_t* bytes) {
+  uint64_t value;
+  memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+static uint64_t hash_round(uint64_t lane, uint64_t input) {
+  return rotate(lane + input * PRIME2, 31) * PRIME1;
+}
+
+static uint64_t hash_merge(uint64_t hash, uint64_t lane) {
+  return (hash ^ hash_round(0, lane)) * PRIME1 + PRIME4;
+}
+
+static void hash_init(hash_state* state) {
+  state->lanes[0] = PRIME1 + PRIME2;
+  state->lanes[1] = PRIME2;
+  state->lanes[2] = 0;
+  state->lanes[3] = 0 - PRIME1;
+  state->length = 0;
+}
+
+// Hashes the whole stripes of `bytes`, and returns how many bytes are left.
+static size_t hash_update(hash_state* state, const uint8_t* bytes,
+                          size_t size) {
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    for (int lane = 0; lane < 4; lane++) {
+      state->lanes[lane] =
+          hash_round(state->lanes[lane], read_u64(bytes + i + lane * 8));
+    }
+  }
+  state->length += i;
+  return size - i;
+}
+
+static uint64_t hash_finish(const hash_state* state, const uint8_t* tail,
+                            size_t size) {
+  uint64_t length = state->length + size;
+  uint64_t hash;
+  if (state->length > 0) {
+    hash = rotate(state->lanes[0], 1) + rotate(state->lanes[1], 7) +
+           rotate(state->lanes[2], 12) + rotate(state->lanes[3], 18);
+    for (int lane = 0; lane < 4; lane++) {
+      hash = hash_merge(hash, state->lanes[lane]);
+    }
+  } else {
+    hash = PRIME5;
+  }
+  hash += length;
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    hash ^= hash_round(0, read_u64(tail + i));
+    hash = rotate(hash, 27) * PRIME1 + PRIME4;
+  }
+  if (i + 4 <= size) {
+    uint32_t word;
+    memcpy(&word, tail + i, sizeof(word));
+    hash ^= (uint64_t)word * PRIME1;
+    hash = rotate(hash, 23) * PRIME2 + PRIME3;
+    i += 4;
+  }
+  for (; i < size; i++) {
+    hash ^= tail[i] * PRIME5;
+    hash = rotate(hash, 11) * PRIME1;
+  }
+  hash ^= hash >> 33;
+  hash *= PRIME2;
+  hash ^= hash >> 29;
+  hash *= PRIME3;
+  return hash ^ hash >> 32;
+}
+
+// The size of the chunks files are hashed in, a multiple of the stripe.
+#define HASH_CHUNK_BYTES 65536
+
+// Hashes the content of the file at `path`. Returns 0 on success.
+static int hash_file(const char* path, uint64_t* hash, int64_t* size) {
+  FILE* file = fopen(path, "rb");
+  uint8_t* chunk = (uint8_t*)tau_memory_alloc(HASH_CHUNK_BYTES, 64);
+  if (file == NULL || chunk == NULL) {
+    if (file != NULL) {
+      fclose(file);
+    }
+    tau_memory_free(chunk);
+    return 1;
+  }
+  hash_state state;
+  hash_init(&state);
+  size_t count;
+  size_t left = 0;
+  while ((count = fread(chunk, 1, HASH_CHUNK_BYTES, file)) > 0) {
+    left = hash_update(&state, chunk, count);
+    if (left > 0) {
+      // Only the last chunk is short.
+      memmove(chunk, chunk + count - left, left);
+      break;
+    }
+  }
+  int failed = ferror(file);
+  fclose(file);
+  *hash = hash_finish(&state, chunk, left);
+  *size = (int64_t)(state.length + left);
+  tau_memory_free(chunk);
+  return failed;
+}
+
+// --- Entries ---
+
+#define ENTRY_MAGIC "TAUCACHE"
+#define ENTRY_VERSION 1
+#define ENTRY_SUFFIX ".tau"
+
+// The header of an entry file, one alignment block long, followed by the
+// channels, each `stride` samples long.
+typedef struct entry_header {
+  char magic[8];
+  uint32_t version;
+  int32_t channels;
+  int32_t frames;
+  int32_t stride;
+  float sample_rate;
+  uint32_t reserved;
+  uint64_t source_hash;
+  int64_t source_bytes;
+  uint8_t padding[16];
+} entry_header;
+
+typedef char entry_header_size_check
+    [sizeof(entry_header) == TAU_AUDIO_BUFFER_ALIGNMENT ? 1 : -1];
+
+// Room for the directory, a separator and an entry or temporary file name.
+#define PATH_BYTES 1024
+
+struct tau_cache {
+  char directory[PATH_BYTES - 64];
+  int64_t max_bytes;
+  tau_mutex mutex;
+  tau_cache_stats stats;
+  // The last time stamped on an entry, in nanoseconds since the epoch.
+  int64_t last_used_ns;
+};
+
+static void entry_path(const tau_cache* cache, char* path, uint64_t hash,
+                       int64_t size) {
+  snprintf(path, PATH_BYTES, "%s/%016" PRIx64 "-%" PRIx64 ENTRY_SUFFIX,
+           cache->directory, hash, (uint64_t)size);
+}
+
+// Maps the entry at `path` into a new buffer, or returns NULL if there is no
+// valid entry for `hash` and `size`.
+static tau_audio_buffer* entry_map(const char* path, uint64_t hash,
+                                   int64_t size) {
+  int64_t mapped_bytes;
+  entry_header* header = (entry_header*)tau_map_file(path, &mapped_bytes);
+  if (header == NULL) {
+    return NULL;
+  }
+  const int32_t block = TAU_AUDIO_BUFFER_ALIGNMENT / sizeof(float);
+  int valid =
+      mapped_bytes >= (int64_t)sizeof(entry_header) &&
+      memcmp(header->magic, ENTRY_MAGIC, sizeof(header->magic)) == 0 &&
+      header->version == ENTRY_VERSION && header->source_hash == hash &&
+      header->source_bytes == size && header->channels > 0 &&
+      header->channels <= TAU_MAX_CHANNELS && header->frames > 0 &&
+      header->stride >= header->frames && header->stride % block == 0 &&
+      mapped_bytes == (int64_t)sizeof(entry_header) +
+                          (int64_t)header->channels * header->stride *
+                              (int64_t)sizeof(float);
+  tau_audio_buffer* buffer =
+      valid ? (tau_audio_buffer*)tau_memory_alloc(sizeof(tau_audio_buffer),
+                                                  sizeof(void*))
+            : NULL;
+  if (buffer == NULL) {
+    tau_unmap_file(header, mapped_bytes);
+    return NULL;
+  }
+  buffer->data = (float*)(header + 1);
+  buffer->channels = header->channels;
+  buffer->frames = header->frames;
+  buffer->stride = header->stride;
+  buffer->sample_rate = header->sample_rate;
+  buffer->references = 1;
+  buffer->mapped_bytes = mapped_bytes;
+  return buffer;
+}
+
+// Writes `buffer` as the entry at `path`. The entry is written to a
+// temporary file first and renamed, so other processes never map a partial
+// entry. Returns 0 on success.
+static int entry_write(const char* path, const tau_audio_buffer* buffer,
+                       uint64_t hash, int64_t size) {
+  // Temporary files are unique to a process and a write.
+  static volatile int32_t writes;
+  int32_t write = tau_atomic_fetch_add_i32(&writes, 1);
+  char temporary[PATH_BYTES + 32];
+#if _WIN32
+  snprintf(temporary, sizeof(temporary), "%s.%lu.%d.tmp", path,
+           (unsigned long)GetCurrentProcessId(), write);
+#else
+  snprintf(temporary, sizeof(temporary), "%s.%ld.%d.tmp", path,
+           (long)getpid(), write);
+#endif
+  FILE* file = fopen(temporary, "wb");
+  if (file == NULL) {
+    return 1;
+  }
+  const int32_t block = TAU_AUDIO_BUFFER_ALIGNMENT / sizeof(float);
+  entry_header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, ENTRY_MAGIC, sizeof(header.magic));
+  header.version = ENTRY_VERSION;
+  header.channels = buffer->channels;
+  header.frames = buffer->frames;
+  header.stride = (buffer->frames + block - 1) / block * block;
+  header.sample_rate = buffer->sample_rate;
+  header.source_hash = hash;
+  header.source_bytes = size;
+  static const float zeros[TAU_AUDIO_BUFFER_ALIGNMENT / sizeof(float)];
+  size_t padding = (size_t)(header.stride - header.frames);
+  int failed = fwrite(&header, sizeof(header), 1, file) != 1;
+  for (int32_t c = 0; !failed && c < buffer->channels; c++) {
+    const float* samples = buffer->data + (size_t)c * buffer->stride;
+    failed = fwrite(samples, sizeof(float), (size_t)buffer->frames, file) !=
+                 (size_t)buffer->frames ||
+             fwrite(zeros, sizeof(float), padding, file) != padding;
+  }
+  failed |= fclose(file) != 0;
+#if _WIN32
+  failed = failed ||
+           !MoveFileExA(temporary, path, MOVEFILE_REPLACE_EXISTING);
+#else
+  failed = failed || rename(temporary, path) != 0;
+#endif
+  if (failed) {
+    remove(temporary);
+  }
+  return failed;
+}
+
+// Marks the entry at `path` as just used. Called with the mutex held.
+//
+// File times can be coarser than the time between two loads, so stamps are
+// kept increasing within the process.
+static void entry_touch(tau_cache* cache, const char* path) {
+#if _WIN32
+  (void)cache;
+  _utime(path, NULL);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  int64_t stamp = (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+  if (stamp <= cache->last_used_ns) {
+    stamp = cache->last_used_ns + 1000;
+  }
+  cache->last_used_ns = stamp;
+  struct timespec times[2];
+  times[0].tv_sec = (time_t)(stamp / 1000000000);
+  times[0].tv_nsec = (long)(stamp % 1000000000);
+  times[1] = times[0];
+  utimensat(AT_FDCWD, path, times, 0);
+#endif
+}
+
+// --- Eviction ---
+
+typedef struct entry_info {
+  char name[64];
+  int64_t bytes;
+  int64_t used_ns;
+} entry_info;
+
+static int entry_compare(const void* a, const void* b) {
+  int64_t x = ((const entry_info*)a)->used_ns;
+  int64_t y = ((const entry_info*)b)->used_ns;
+  return x < y ? -1 : x > y;
+}
+
+static int is_entry_name(const char* name) {
+  size_t length = strlen(name);
+  size_t suffix = sizeof(ENTRY_SUFFIX) - 1;
+  return length > suffix && length < sizeof(((entry_info*)0)->name) &&
+         strcmp(name + length - suffix, ENTRY_SUFFIX) == 0;
+}
+
+// Appends an entry to `*entries`, growing it as needed. Returns 0 on success.
+static int entry_append(entry_info** entries, int32_t* count,
+                        int32_t* capacity, const char* name, int64_t bytes,
+                        int64_t used_ns) {
+  if (*count == *capacity) {
+    int32_t grown = *capacity > 0 ? *capacity * 2 : 64;
+    entry_info* larger = (entry_info*)tau_memory_alloc(
+        (size_t)grown * sizeof(entry_info), sizeof(int64_t));
+    if (larger == NULL) {
+      return 1;
+    }
+    if (*count > 0) {
+      memcpy(larger, *entries, (size_t)*count * sizeof(entry_info));
+    }
+    tau_memory_free(*entries);
+    *entries = larger;
+    *capacity = grown;
+  }
+  entry_info* entry = &(*entries)[(*count)++];
+  snprintf(entry->name, sizeof(entry->name), "%s", name);
+  entry->bytes = bytes;
+  entry->used_ns = used_ns;
+  return 0;
+}
+
+// Lists the entries of the cache directory. Returns their number, or -1.
+static int32_t list_entries(const tau_cache* cache, entry_info** entries) {
+  int32_t count = 0;
+  int32_t capacity = 0;
+  int failed = 0;
+  *entries = NULL;
+#if _WIN32
+  char pattern[PATH_BYTES];
+  snprintf(pattern, sizeof(pattern), "%s/*" ENTRY_SUFFIX, cache->directory);
+  WIN32_FIND_DATAA found;
+  HANDLE search = FindFirstFileA(pattern, &found);
+  if (search == INVALID_HANDLE_VALUE) {
+    return 0;
+  }
+  do {
+    if (!is_entry_name(found.cFileName)) {
+      continue;
+    }
+    int64_t bytes =
+        (int64_t)found.nFileSizeHigh << 32 | (int64_t)found.nFileSizeLow;
+    int64_t used = (int64_t)found.ftLastWriteTime.dwHighDateTime << 32 |
+                   (int64_t)found.ftLastWriteTime.dwLowDateTime;
+    failed = entry_append(entries, &count, &capacity, found.cFileName, bytes,
+                          used * 100);
+  } while (!failed && FindNextFileA(search, &found));
+  FindClose(search);
+#else
+  DIR* directory = opendir(cache->directory);
+  if (directory == NULL) {
+    return -1;
+  }
+  struct dirent* item;
+  while (!failed && (item = readdir(directory)) != NULL) {
+    char path[PATH_BYTES];
+    struct stat status;
+    if (!is_entry_name(item->d_name)) {
+      continue;
+    }
+    snprintf(path, sizeof(path), "%s/%.63s", cache->directory, item->d_name);
+    if (stat(path, &status) != 0) {
+      continue;
+    }
+#if defined(__APPLE__)
+    const struct timespec* used = &status.st_mtimespec;
+#else
+    const struct timespec* used = &status.st_mtim;
+#endif
+    failed = entry_append(entries, &count, &capacity, item->d_name,
+                          (int64_t)status.st_size,
+                          (int64_t)used->tv_sec * 1000000000 + used->tv_nsec);
+  }
+  closedir(directory);
+#endif
+  if (failed) {
+    tau_memory_free(*entries);
+    *entries = NULL;
+    return -1;
+  }
+  return count;
+}
+
+// Deletes the least recently used entries past the size limit, but the one
+// named `keep`, if any. Called with the mutex held.
+static void evict(tau_cache* cache, const char* keep) {
+  entry_info* entries;
+  int32_t count = list_entries(cache, &entries);
+  if (count < 0) {
+    return;
+  }
+  if (count > 1) {
+    qsort(entries, (size_t)count, sizeof(entry_info), entry_compare);
+  }
+  int64_t bytes = 0;
+  int32_t remaining = count;
+  for (int32_t i = 0; i < count; i++) {
+    bytes += entries[i].bytes;
+  }
+  for (int32_t i = 0; i < count && bytes > cache->max_bytes; i++) {
+    char path[PATH_BYTES];
+    if (keep != NULL && strcmp(entries[i].name, keep) == 0) {
+      continue;
+    }
+    // Deleting an entry leaves the mappings of loaded buffers intact, where
+    // the platform allows deleting it at all.
+    snprintf(path, sizeof(path), "%s/%s", cache->directory, entries[i].name);
+    if (remove(path) == 0) {
+      bytes -= entries[i].bytes;
+      remaining--;
+      cache->stats.evictions++;
+      cache->stats.evicted_bytes += entries[i].bytes;
+    }
+  }
+  cache->stats.entries = remaining;
+  cache->stats.bytes = bytes;
+  tau_memory_free(entries);
+}
+
+// --- API ---
+
+FFI_PLUGIN_EXPORT tau_cache* tau_cache_open(const char* directory,
+                                            int64_t max_bytes) {
+  if (directory == NULL || max_bytes < 0 ||
+      strlen(directory) >= sizeof(((tau_cache*)0)->directory)) {
+    return NULL;
+  }
+#if _WIN32
+  _mkdir(directory);
+  DWORD attributes = GetFileAttributesA(directory);
+  int is_directory = attributes != INVALID_FILE_ATTRIBUTES &&
+                     (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+  struct stat status;
+  mkdir(directory, 0777);
+  int is_directory = stat(directory, &status) == 0 && S_ISDIR(status.st_mode);
+#endif
+  tau_cache* cache =
+      is_directory ? (tau_cache*)tau_memory_calloc(sizeof(tau_cache),
+                                                   sizeof(int64_t))
+                   : NULL;
+  if (cache == NULL) {
+    return NULL;
+  }
+  snprintf(cache->directory, sizeof(cache->directory), "%s", directory);
+  cache->max_bytes = max_bytes;
+  tau_mutex_init(&cache->mutex);
+  tau_mutex_lock(&cache->mutex);
+  evict(cache, NULL);
+  tau_mutex_unlock(&cache->mutex);
+  return cache;
+}
+
+FFI_PLUGIN_EXPORT void tau_cache_close(tau_cache* cache) {
+  if (cache == NULL) {
+    return;
+  }
+  tau_mutex_destroy(&cache->mutex);
+  tau_memory_free(cache);
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_cache_set_limit(tau_cache* cache,
+                                              int64_t max_bytes) {
+  if (cache == NULL || max_bytes < 0) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_mutex_lock(&cache->mutex);
+  cache->max_bytes = max_bytes;
+  evict(cache, NULL);
+  tau_mutex_unlock(&cache->mutex);
+  return TAU_OK;
+}
+
+FFI_PLUGIN_EXPORT tau_audio_buffer* tau_cache_load(tau_cache* cache,
+                                                   const char* path) {
+  uint64_t hash;
+  int64_t size;
+  if (cache == NULL || path == NULL || hash_file(path, &hash, &size) != 0) {
+    return NULL;
+  }
+  char entry[PATH_BYTES];
+  entry_path(cache, entry, hash, size);
+  tau_audio_buffer* buffer = entry_map(entry, hash, size);
+  if (buffer != NULL) {
+    tau_mutex_lock(&cache->mutex);
+    entry_touch(cache, entry);
+    cache->stats.hits++;
+    tau_mutex_unlock(&cache->mutex);
+    return buffer;
+  }
+  tau_audio_buffer* decoded = tau_decode_file(path);
+  if (decoded == NULL) {
+    return NULL;
+  }
+  // Loads racing on the same content write the same entry; the last rename
+  // wins and every one of them maps a complete file.
+  if (entry_write(entry, decoded, hash, size) == 0) {
+    buffer = entry_map(entry, hash, size);
+  }
+  tau_mutex_lock(&cache->mutex);
+  cache->stats.misses++;
+  if (buffer != NULL) {
+    entry_touch(cache, entry);
+    evict(cache, strrchr(entry, '/') + 1);
+  }
+  tau_mutex_unlock(&cache->mutex);
+  if (buffer == NULL) {
+    return decoded;
+  }
+  tau_audio_buffer_release(decoded);
+  return buffer;
+}
+
+FFI_PLUGIN_EXPORT void tau_cache_get_stats(tau_cache* cache,
+                                           tau_cache_stats* stats) {
+  tau_mutex_lock(&cache->mutex);
+  *stats = cache->stats;
+  tau_mutex_unlock(&cache->mutex);
+}
@@ -0,0 +1,9 @@
+// The codecs built into the library, probed after the registered ones.
+#ifndef TAU_CODEC_H_
+#define TAU_CODEC_H_
+
+#include "tau_platform.h"
+
+extern const tau_codec tau_wav_codec;
+
+#endif  // TAU_CODEC_H_
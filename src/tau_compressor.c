@@ -0,0 +1,263 @@
+// The compressor node, as the Web Audio `DynamicsCompressorNode`.
+//
+// Every quantum, the level of the loudest channel goes to decibels and
+// through the gain curve with vector kernels. The gain, in decibels, then
+// moves once per division of `DIVISION` frames towards the lowest gain the
+// curve asked for within the division, at the attack rate going down and
+// the release rate coming back up, and ramps linearly across the division.
+// The ramps go back to amplitudes with a vector kernel, and multiply the
+// input as it leaves a ring delaying it by the lookahead, so that the gain
+// has come down by the time a peak the detector saw comes out. Nothing
+// calls `log` or `exp` per frame.
+#include <math.h>
+#include <string.h>
+
+#include "tau_engine.h"
+#include "tau_kernels.h"
+
+// The delay between the detector and the output.
+#define LOOKAHEAD_SECONDS 0.006
+
+// The frames the gain takes a step over. A quantum is a whole number of
+// divisions.
+#define DIVISION 32
+
+// The share of the reduction of a full-scale input that the makeup gain
+// gives back, as in Web Audio.
+#define MAKEUP_SHARE 0.6f
+
+typedef struct compressor {
+  // The delay ring of every channel the input can have, of `capacity`
+  // frames each, a power of two of at least the lookahead and a quantum.
+  float* rings;
+  int32_t capacity;
+  int32_t lookahead;
+  // The frames written to the rings, and the channels they hold.
+  int64_t written;
+  int32_t ring_channels;
+  // The silent input frames since the last sound.
+  int64_t silent_frames;
+  // The gain, in decibels, without the makeup gain.
+  float envelope;
+  // The gain at the end of the last quantum, as the bits of a float, for
+  // the control threads.
+  volatile int32_t reduction;
+} compressor;
+
+typedef struct compressor_state {
+  compressor* self;
+} compressor_state;
+
+static void compressor_free(compressor* self) {
+  tau_memory_free(self->rings);
+  tau_memory_free(self);
+}
+
+// The share of the distance to its target the gain covers in a division,
+// for a time constant of `seconds`.
+static float step_share(float seconds, float sample_rate) {
+  if (!(seconds > 0.0f)) {
+    return 1.0f;
+  }
+  return (float)(1.0 - exp(-DIVISION / ((double)seconds * sample_rate)));
+}
+
+// The loudest magnitude of the `channels` channels of `input` at every
+// frame.
+static void detect(const float* input, int32_t channels, float* levels) {
+  for (int32_t i = 0; i < TAU_QUANTUM; i++) {
+    levels[i] = fabsf(input[i]);
+  }
+  for (int32_t c = 1; c < channels; c++) {
+    const float* samples = input + c * TAU_QUANTUM;
+    for (int32_t i = 0; i < TAU_QUANTUM; i++) {
+      float magnitude = fabsf(samples[i]);
+      levels[i] = magnitude > levels[i] ? magnitude : levels[i];
+    }
+  }
+}
+
+// Writes a quantum of `samples`, or of silence if NULL, into `ring` at
+// `position`.
+static void ring_write(float* ring, int32_t capacity, int64_t position,
+                       const float* samples) {
+  int32_t start = (int32_t)(position & (capacity - 1));
+  int32_t first =
+      capacity - start < TAU_QUANTUM ? capacity - start : TAU_QUANTUM;
+  if (samples == NULL) {
+    memset(ring + start, 0, (size_t)first * sizeof(float));
+    memset(ring, 0, (size_t)(TAU_QUANTUM - first) * sizeof(float));
+  } else {
+    memcpy(ring + start, samples, (size_t)first * sizeof(float));
+    memcpy(ring, samples + first,
+           (size_t)(TAU_QUANTUM - first) * sizeof(float));
+  }
+}
+
+// Reads a quantum of `ring` from `position` into `samples`.
+static void ring_read(const float* ring, int32_t capacity, int64_t position,
+                      float* samples) {
+  int32_t start = (int32_t)(position & (capacity - 1));
+  int32_t first =
+      capacity - start < TAU_QUANTUM ? capacity - start : TAU_QUANTUM;
+  memcpy(samples, ring + start, (size_t)first * sizeof(float));
+  memcpy(samples + first, ring,
+         (size_t)(TAU_QUANTUM - first) * sizeof(float));
+}
+
+static void process_compressor(tau_context* context, tau_node* node) {
+  compressor* self = ((compressor_state*)node->state)->self;
+  int32_t channels = node->input_channels;
+  float threshold = tau_param_render_k(
+      context, tau_node_param(node, TAU_PARAM_THRESHOLD));
+  float knee =
+      tau_param_render_k(context, tau_node_param(node, TAU_PARAM_KNEE));
+  float ratio =
+      tau_param_render_k(context, tau_node_param(node, TAU_PARAM_RATIO));
+  float attack = step_share(
+      tau_param_render_k(context, tau_node_param(node, TAU_PARAM_ATTACK)),
+      context->sample_rate);
+  float release = step_share(
+      tau_param_render_k(context, tau_node_param(node, TAU_PARAM_RELEASE)),
+      context->sample_rate);
+  float slope = 1.0f / ratio - 1.0f;
+  float makeup =
+      -MAKEUP_SHARE * tau_compressor_gain(0.0f, threshold, knee, slope);
+
+  // The gain the curve asks for at every frame, in decibels.
+  float* gains = (float*)tau_arena_alloc(TAU_QUANTUM * sizeof(float));
+  int silent = node->input_silent;
+  if (!silent) {
+    detect(node->input, channels, gains);
+    tau_kernel_decibels(gains, gains, TAU_QUANTUM);
+    tau_kernel_compressor_gain(gains, gains, threshold, knee, slope,
+                               TAU_QUANTUM);
+  }
+  // Turns them into the ramps of the gain applied, division by division.
+  float envelope = self->envelope;
+  for (int32_t start = 0; start < TAU_QUANTUM; start += DIVISION) {
+    float target = 0.0f;
+    for (int32_t i = 0; !silent && i < DIVISION; i++) {
+      target = gains[start + i] < target ? gains[start + i] : target;
+    }
+    float share = target < envelope ? attack : release;
+    float next = envelope + (target - envelope) * share;
+    float step = (next - envelope) / DIVISION;
+    tau_kernel_ramp(gains + start, envelope + makeup + step, step, DIVISION);
+    envelope = next;
+  }
+  self->envelope = envelope;
+  int32_t bits;
+  memcpy(&bits, &envelope, sizeof(bits));
+  tau_atomic_store_relaxed_i32(&self->reduction, bits);
+
+  // Channels the input did not have hold silence.
+  if (channels > self->ring_channels) {
+    memset(self->rings + (size_t)self->ring_channels * self->capacity, 0,
+           (size_t)(channels - self->ring_channels) * self->capacity *
+               sizeof(float));
+  }
+  self->ring_channels = channels;
+  for (int32_t c = 0; c < channels; c++) {
+    ring_write(self->rings + (size_t)c * self->capacity, self->capacity,
+               self->written, silent ? NULL : node->input + c * TAU_QUANTUM);
+  }
+  // Before the first quantum, the rings read as silence.
+  int64_t read = self->written - self->lookahead;
+  self->written += TAU_QUANTUM;
+  self->silent_frames = silent ? self->silent_frames + TAU_QUANTUM : 0;
+  if (self->silent_frames >= self->lookahead + TAU_QUANTUM) {
+    // The rings only hold silence.
+    tau_node_output_silence(node, channels);
+    return;
+  }
+  tau_kernel_amplitudes(gains, gains, TAU_QUANTUM);
+  for (int32_t c = 0; c < channels; c++) {
+    float* output = node->output + c * TAU_QUANTUM;
+    ring_read(self->rings + (size_t)c * self->capacity, self->capacity, read,
+              output);
+    tau_kernel_multiply(output, output, gains, TAU_QUANTUM);
+  }
+  node->output_channels = channels;
+  node->output_silent = 0;
+}
+
+static void destroy_compressor(tau_node* node) {
+  compressor_free(((compressor_state*)node->state)->self);
+}
+
+static const tau_node_ops compressor_ops = {process_compressor,
+                                            destroy_compressor};
+
+static compressor* compressor_new(float sample_rate) {
+  compressor* self =
+      (compressor*)tau_memory_calloc(sizeof(compressor), TAU_CACHE_LINE);
+  if (self == NULL) {
+    return NULL;
+  }
+  self->lookahead = (int32_t)lround(LOOKAHEAD_SECONDS * sample_rate);
+  self->capacity = TAU_QUANTUM;
+  while (self->capacity < self->lookahead + TAU_QUANTUM) {
+    self->capacity *= 2;
+  }
+  self->rings = (float*)tau_memory_calloc(
+      (size_t)TAU_MAX_CHANNELS * self->capacity * sizeof(float),
+      TAU_CACHE_LINE);
+  if (self->rings == NULL) {
+    compressor_free(self);
+    return NULL;
+  }
+  return self;
+}
+
+// The compressor behind `handle`, or NULL. Called with the control lock
+// held.
+static compressor* find_compressor(tau_context* context, int32_t handle) {
+  tau_node* node = tau_context_node(context, handle);
+  return node != NULL && node->ops == &compressor_ops
+             ? ((compressor_state*)node->state)->self
+             : NULL;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_compressor_create(tau_context* context) {
+  if (context == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  compressor* self = compressor_new(context->sample_rate);
+  if (self == NULL) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  tau_node* node =
+      tau_node_create(context, &compressor_ops, sizeof(compressor_state), 0);
+  if (node == NULL) {
+    compressor_free(self);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  ((compressor_state*)node->state)->self = self;
+  if (!tau_node_reserve_params(node, 5)) {
+    tau_node_release(context, node->id);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  tau_node_add_param(node, TAU_PARAM_THRESHOLD, -24, -100, 0);
+  tau_node_add_param(node, TAU_PARAM_KNEE, 30, 0, 40);
+  tau_node_add_param(node, TAU_PARAM_RATIO, 12, 1, 20);
+  tau_node_add_param(node, TAU_PARAM_ATTACK, 0.003f, 0, 1);
+  tau_node_add_param(node, TAU_PARAM_RELEASE, 0.25f, 0, 1);
+  return node->id;
+}
+
+FFI_PLUGIN_EXPORT float tau_compressor_reduction(tau_context* context,
+                                                 int32_t node) {
+  if (context == NULL) {
+    return NAN;
+  }
+  float reduction = NAN;
+  tau_control_lock(context);
+  compressor* self = find_compressor(context, node);
+  if (self != NULL) {
+    int32_t bits = tau_atomic_load_relaxed_i32(&self->reduction);
+    memcpy(&reduction, &bits, sizeof(reduction));
+  }
+  tau_control_unlock(context);
+  return reduction;
+}
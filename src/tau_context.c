@@ -0,0 +1,898 @@
+#include <string.h>
+
+#include "tau_engine.h"
+
+#define TAU_BUS_ALIGNMENT 64
+
+static const tau_node_ops destination_ops;
+
+// The bus pool for `channels`, rounded up to a power of two in `*capacity`.
+static tau_fixed_pool* bus_pool(tau_context* context, int32_t channels,
+                                int32_t* capacity) {
+  int32_t index = 0;
+  while ((1 << index) < channels) {
+    index++;
+  }
+  *capacity = 1 << index;
+  return &context->bus_pools[index];
+}
+
+static float* bus_alloc(tau_context* context, int32_t channels,
+                        int32_t* capacity) {
+  float* bus = (float*)tau_fixed_pool_alloc(
+      bus_pool(context, channels, capacity));
+  if (bus != NULL) {
+    memset(bus, 0, (size_t)*capacity * TAU_QUANTUM * sizeof(float));
+  }
+  return bus;
+}
+
+void tau_bus_free(tau_context* context, float* bus, int32_t capacity) {
+  int32_t unused;
+  tau_fixed_pool_free(bus_pool(context, capacity, &unused), bus);
+}
+
+void tau_node_free(tau_context* context, tau_node* node) {
+  if (node->ops->destroy != NULL && node->state != NULL) {
+    node->ops->destroy(node);
+  }
+  for (int32_t i = 0; i < node->param_count; i++) {
+    tau_param_destroy(context, &node->params[i]);
+  }
+  if (node->params != node->inline_params) {
+    tau_memory_free(node->params);
+  }
+  if (node->sources != node->inline_sources) {
+    tau_memory_free(node->sources);
+  }
+  if (node->control.sources != node->control.inline_sources) {
+    tau_memory_free(node->control.sources);
+  }
+  tau_bus_free(context, node->input, node->input_capacity);
+  tau_bus_free(context, node->output, node->output_capacity);
+  tau_fixed_pool_free(&context->state_pool, node->state);
+  tau_fixed_pool_free(&context->node_pool, node);
+}
+
+FFI_PLUGIN_EXPORT tau_context* tau_context_create(int32_t channels,
+                                                  float sample_rate) {
+  if (channels <= 0 || channels > TAU_MAX_CHANNELS || !(sample_rate > 0)) {
+    return NULL;
+  }
+  tau_context* context =
+      (tau_context*)tau_memory_calloc(sizeof(tau_context), TAU_CACHE_LINE);
+  if (context == NULL) {
+    return NULL;
+  }
+  context->sample_rate = sample_rate;
+  context->channel_count = channels;
+  context->deadline_ns = (int64_t)(TAU_QUANTUM * 1e9 / sample_rate);
+  context->pending_offset = TAU_QUANTUM;
+  context->render_threads = 1;
+  context->resampler_quality = TAU_RESAMPLER_MEDIUM;
+  tau_mutex_init(&context->control_lock);
+  tau_fixed_pool_init(&context->node_pool, sizeof(tau_node), TAU_CACHE_LINE);
+  tau_fixed_pool_init(&context->state_pool, TAU_MAX_NODE_STATE,
+                      TAU_CACHE_LINE);
+  for (int32_t i = 0; i < TAU_BUS_CLASSES; i++) {
+    tau_fixed_pool_init(&context->bus_pools[i],
+                        ((size_t)1 << i) * TAU_QUANTUM * sizeof(float),
+                        TAU_BUS_ALIGNMENT);
+  }
+  tau_fixed_pool_init(&context->command_pool, sizeof(tau_command),
+                      sizeof(double));
+  tau_node* destination =
+      tau_node_create(context, &destination_ops, 0, channels);
+  if (destination == NULL ||
+      tau_node_set_channels(context, destination, channels,
+                            TAU_CHANNELS_EXPLICIT,
+                            TAU_INTERPRETATION_SPEAKERS) != TAU_OK) {
+    tau_context_destroy(context);
+    return NULL;
+  }
+  context->destination = destination->id;
+  context->destination_node = destination;
+  return context;
+}
+
+FFI_PLUGIN_EXPORT void tau_context_destroy(tau_context* context) {
+  if (context == NULL) {
+    return;
+  }
+  // Nothing renders anymore: the pending commands apply at once, and
+  // everything is freed.
+  tau_command_drain(context);
+  tau_control_lock(context);
+  for (int32_t i = 0; i < context->node_count; i++) {
+    if (context->nodes[i] != NULL) {
+      tau_node_free(context, context->nodes[i]);
+    }
+  }
+  tau_control_unlock(context);
+  tau_mutex_destroy(&context->control_lock);
+  tau_memory_free(context->nodes);
+  tau_memory_free(context->generations);
+  tau_memory_free(context->free_slots);
+  tau_memory_free(context->order);
+  tau_memory_free(context->chains);
+  tau_memory_free(context->chain_dependents);
+  if (context->pool != NULL) {
+    tau_pool_destroy(context->pool);
+  }
+  tau_fixed_pool_destroy(&context->node_pool);
+  tau_fixed_pool_destroy(&context->state_pool);
+  for (int32_t i = 0; i < TAU_BUS_CLASSES; i++) {
+    tau_fixed_pool_destroy(&context->bus_pools[i]);
+  }
+  tau_fixed_pool_destroy(&context->command_pool);
+  tau_memory_free(context);
+}
+
+FFI_PLUGIN_EXPORT float tau_context_sample_rate(tau_context* context) {
+  return context->sample_rate;
+}
+
+FFI_PLUGIN_EXPORT double tau_context_current_time(tau_context* context) {
+  return (double)tau_atomic_load_i64(&context->current_frame) /
+         context->sample_rate;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_context_destination(tau_context* context) {
+  return context->destination;
+}
+
+tau_node* tau_context_node(tau_context* context, int32_t handle) {
+  if (context == NULL || handle < 0) {
+    return NULL;
+  }
+  int32_t slot = handle & (TAU_MAX_NODES - 1);
+  if (slot >= context->node_count || context->nodes[slot] == NULL ||
+      context->nodes[slot]->id != handle) {
+    return NULL;
+  }
+  return context->nodes[slot];
+}
+
+// Grows the slot arrays, and sends the rendering thread an order and chains
+// with room for as many nodes. Returns 0 on failure.
+static int grow_slots(tau_context* context) {
+  if (context->node_capacity == TAU_MAX_NODES) {
+    return 0;
+  }
+  int32_t capacity =
+      context->node_capacity > 0 ? context->node_capacity * 2 : 16;
+  size_t size = (size_t)capacity * sizeof(void*);
+  tau_command* command =
+      tau_command_create(context, TAU_COMMAND_SLOTS, NULL, 0);
+  tau_node** nodes = (tau_node**)tau_memory_alloc(size, TAU_CACHE_LINE);
+  tau_node** order = (tau_node**)tau_memory_alloc(size, TAU_CACHE_LINE);
+  int32_t* generations = (int32_t*)tau_memory_alloc(
+      (size_t)capacity * sizeof(int32_t), TAU_CACHE_LINE);
+  int32_t* free_slots = (int32_t*)tau_memory_alloc(
+      (size_t)capacity * sizeof(int32_t), TAU_CACHE_LINE);
+  tau_chain* chains = (tau_chain*)tau_memory_alloc(
+      (size_t)capacity * sizeof(tau_chain), TAU_CACHE_LINE);
+  if (command == NULL || nodes == NULL || order == NULL ||
+      generations == NULL || free_slots == NULL || chains == NULL) {
+    tau_command_free(context, command);
+    tau_memory_free(nodes);
+    tau_memory_free(order);
+    tau_memory_free(generations);
+    tau_memory_free(free_slots);
+    tau_memory_free(chains);
+    return 0;
+  }
+  if (context->node_count > 0) {
+    memcpy(nodes, context->nodes, context->node_count * sizeof(tau_node*));
+    memcpy(generations, context->generations,
+           context->node_count * sizeof(int32_t));
+    memcpy(free_slots, context->free_slots,
+           context->free_count * sizeof(int32_t));
+  }
+  tau_memory_free(context->nodes);
+  tau_memory_free(context->generations);
+  tau_memory_free(context->free_slots);
+  context->nodes = nodes;
+  context->generations = generations;
+  context->free_slots = free_slots;
+  context->node_capacity = capacity;
+  command->memory[0] = order;
+  command->memory[1] = chains;
+  tau_command_post(context, command);
+  return 1;
+}
+
+tau_node* tau_node_create(tau_context* context, const tau_node_ops* ops,
+                          size_t state_size, int32_t output_channels) {
+  if (state_size > TAU_MAX_NODE_STATE) {
+    return NULL;
+  }
+  tau_control_lock(context);
+  if (context->free_count == 0 &&
+      context->node_count == context->node_capacity && !grow_slots(context)) {
+    tau_control_unlock(context);
+    return NULL;
+  }
+  tau_node* node = (tau_node*)tau_fixed_pool_alloc(&context->node_pool);
+  if (node == NULL) {
+    tau_control_unlock(context);
+    return NULL;
+  }
+  memset(node, 0, sizeof(tau_node));
+  node->ops = ops;
+  node->state = tau_fixed_pool_alloc(&context->state_pool);
+  node->sources = node->inline_sources;
+  node->params = node->inline_params;
+  node->channel_count = 2;
+  node->channel_count_mode = TAU_CHANNELS_MAX;
+  node->channel_interpretation = TAU_INTERPRETATION_SPEAKERS;
+  node->input_channels = 1;
+  node->input_silent = 1;
+  node->output_follows_input = output_channels == 0;
+  node->output_channels = output_channels > 0 ? output_channels : 1;
+  node->output_silent = 1;
+  node->start_frame = -1;
+  node->stop_frame = INT64_MAX;
+  node->input = bus_alloc(context, 1, &node->input_capacity);
+  node->output =
+      bus_alloc(context, node->output_channels, &node->output_capacity);
+  tau_node_control* control = &node->control;
+  control->sources = control->inline_sources;
+  control->source_capacity = TAU_INLINE_SOURCES;
+  control->input_capacity = node->input_capacity;
+  control->output_capacity = node->output_capacity;
+  control->channel_count_mode = node->channel_count_mode;
+  control->channel_count = node->channel_count;
+  control->output_channels = node->output_channels;
+  if (node->state != NULL) {
+    memset(node->state, 0, TAU_MAX_NODE_STATE);
+  }
+  if (node->state == NULL || node->input == NULL || node->output == NULL) {
+    tau_node_free(context, node);
+    tau_control_unlock(context);
+    return NULL;
+  }
+  int32_t slot;
+  if (context->free_count > 0) {
+    slot = context->free_slots[--context->free_count];
+  } else {
+    slot = context->node_count++;
+    context->generations[slot] = 0;
+  }
+  node->id = (context->generations[slot] << TAU_NODE_SLOT_BITS) | slot;
+  context->nodes[slot] = node;
+  tau_control_unlock(context);
+  return node;
+}
+
+int tau_node_reserve_params(tau_node* node, int32_t count) {
+  if (count <= TAU_MAX_NODE_PARAMS) {
+    return 1;
+  }
+  tau_param* params = (tau_param*)tau_memory_calloc(
+      (size_t)count * sizeof(tau_param), sizeof(double));
+  if (params == NULL) {
+    return 0;
+  }
+  node->params = params;
+  return 1;
+}
+
+void tau_node_add_param(tau_node* node, int32_t id, float value,
+                        float min_value, float max_value) {
+  tau_param* param = &node->params[node->param_count++];
+  int32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  param->id = id;
+  param->value = value;
+  param->published = bits;
+  param->min_value = min_value;
+  param->max_value = max_value;
+  // No event was reached yet.
+  param->current.type = TAU_EVENT_SET_VALUE;
+  param->current.value = value;
+  param->current.frame = -1.0;
+}
+
+tau_param* tau_node_param(tau_node* node, int32_t id) {
+  for (int32_t i = 0; i < node->param_count; i++) {
+    if (node->params[i].id == id) {
+      return &node->params[i];
+    }
+  }
+  return NULL;
+}
+
+// The input channels `node` can receive from its current connections.
+static int32_t needed_input_channels(tau_node* node) {
+  const tau_node_control* control = &node->control;
+  int32_t channels = 1;
+  for (int32_t i = 0; i < control->source_count; i++) {
+    tau_node* source = control->sources[i];
+    int32_t source_channels = source->output_follows_input
+                                  ? source->control.output_capacity
+                                  : source->control.output_channels;
+    if (source_channels > channels) {
+      channels = source_channels;
+    }
+  }
+  if (control->channel_count_mode == TAU_CHANNELS_EXPLICIT) {
+    channels = control->channel_count;
+  } else if (control->channel_count_mode == TAU_CHANNELS_CLAMPED_MAX &&
+             channels > control->channel_count) {
+    channels = control->channel_count;
+  }
+  return channels;
+}
+
+static int contains(const tau_node_control* control, tau_node* source) {
+  for (int32_t i = 0; i < control->source_count; i++) {
+    if (control->sources[i] == source) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Grows the buses of `node`, and of the nodes it feeds, to fit its inputs.
+static int32_t update_capacity(tau_context* context, tau_node* node) {
+  tau_node_control* control = &node->control;
+  int32_t channels = needed_input_channels(node);
+  int grow_input = channels > control->input_capacity;
+  int grow_output =
+      node->output_follows_input && channels > control->output_capacity;
+  if (!grow_input && !grow_output) {
+    return TAU_OK;
+  }
+  tau_command* command =
+      tau_command_create(context, TAU_COMMAND_BUSES, node, 0);
+  if (command == NULL) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  for (int32_t i = 0; i < 2; i++) {
+    if (i == 0 ? grow_input : grow_output) {
+      command->memory[i] =
+          bus_alloc(context, channels, &command->capacities[i]);
+      if (command->memory[i] == NULL) {
+        tau_command_free(context, command);
+        return TAU_ERROR_OUT_OF_MEMORY;
+      }
+    }
+  }
+  if (grow_input) {
+    control->input_capacity = command->capacities[0];
+  }
+  tau_command_post(context, command);
+  if (!grow_output) {
+    return TAU_OK;
+  }
+  control->output_capacity = command->capacities[1];
+  for (int32_t i = 0; i < context->node_count; i++) {
+    tau_node* next = context->nodes[i];
+    if (next != NULL && contains(&next->control, node)) {
+      int32_t status = update_capacity(context, next);
+      if (status != TAU_OK) {
+        return status;
+      }
+    }
+  }
+  return TAU_OK;
+}
+
+int32_t tau_node_set_channels(tau_context* context, tau_node* node,
+                              int32_t channel_count,
+                              tau_channel_count_mode mode,
+                              tau_channel_interpretation interpretation) {
+  if (channel_count <= 0 || channel_count > TAU_MAX_CHANNELS) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_control_lock(context);
+  tau_command* command =
+      tau_command_create(context, TAU_COMMAND_CHANNELS, node, 0);
+  if (command == NULL) {
+    tau_control_unlock(context);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  command->count = channel_count;
+  command->mode = mode;
+  command->interpretation = interpretation;
+  node->control.channel_count = channel_count;
+  node->control.channel_count_mode = mode;
+  tau_command_post(context, command);
+  int32_t status = update_capacity(context, node);
+  tau_control_unlock(context);
+  return status;
+}
+
+// Whether `target` feeds, directly or not, the input of `node`.
+static int feeds(tau_context* context, tau_node* node, tau_node* target) {
+  if (node == target) {
+    return 1;
+  }
+  if (node->control.mark == context->control_epoch) {
+    return 0;
+  }
+  node->control.mark = context->control_epoch;
+  for (int32_t i = 0; i < node->control.source_count; i++) {
+    if (feeds(context, node->control.sources[i], target)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static int32_t connect(tau_context* context, int32_t source,
+                       int32_t destination) {
+  tau_node* from = tau_context_node(context, source);
+  tau_node* to = tau_context_node(context, destination);
+  if (from == NULL || to == NULL || from->ops == &destination_ops) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_node_control* control = &to->control;
+  if (contains(control, from)) {
+    return TAU_OK;
+  }
+  context->control_epoch++;
+  if (feeds(context, from, to)) {
+    return TAU_ERROR_NOT_SUPPORTED;
+  }
+  // A full array of sources is replaced on both sides, and the schedule
+  // keeps one entry per connection.
+  tau_command* connection =
+      tau_command_create(context, TAU_COMMAND_CONNECT, to, 0);
+  tau_command* edges = NULL;
+  tau_node** sources = NULL;
+  int32_t source_capacity = control->source_capacity * 2;
+  int32_t edge_capacity =
+      context->edge_capacity > 0 ? context->edge_capacity * 2 : 64;
+  int failed = connection == NULL;
+  if (!failed && control->source_count == control->source_capacity) {
+    size_t size = (size_t)source_capacity * sizeof(tau_node*);
+    sources = (tau_node**)tau_memory_alloc(size, sizeof(tau_node*));
+    connection->memory[0] = tau_memory_alloc(size, sizeof(tau_node*));
+    failed = sources == NULL || connection->memory[0] == NULL;
+  }
+  if (!failed && context->edge_count == context->edge_capacity) {
+    edges = tau_command_create(context, TAU_COMMAND_EDGES, NULL, 0);
+    failed = edges == NULL;
+    if (!failed) {
+      edges->memory[0] = tau_memory_alloc(
+          (size_t)edge_capacity * sizeof(int32_t), TAU_CACHE_LINE);
+      failed = edges->memory[0] == NULL;
+    }
+  }
+  if (failed) {
+    tau_memory_free(sources);
+    tau_command_free(context, connection);
+    tau_command_free(context, edges);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  if (edges != NULL) {
+    context->edge_capacity = edge_capacity;
+    tau_command_post(context, edges);
+  }
+  if (sources != NULL) {
+    memcpy(sources, control->sources,
+           (size_t)control->source_count * sizeof(tau_node*));
+    if (control->sources != control->inline_sources) {
+      tau_memory_free(control->sources);
+    }
+    control->sources = sources;
+    control->source_capacity = source_capacity;
+  }
+  control->sources[control->source_count++] = from;
+  int32_t status = update_capacity(context, to);
+  if (status != TAU_OK) {
+    // The command still hands the new array over, so that both sides keep
+    // the same capacity.
+    control->source_count--;
+    from = NULL;
+  } else {
+    context->edge_count++;
+  }
+  connection->source = from;
+  tau_command_post(context, connection);
+  return status;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_node_connect(tau_context* context,
+                                           int32_t source,
+                                           int32_t destination) {
+  if (context == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_control_lock(context);
+  int32_t status = connect(context, source, destination);
+  tau_control_unlock(context);
+  return status;
+}
+
+static int remove_source(tau_node_control* control, tau_node* source) {
+  for (int32_t i = 0; i < control->source_count; i++) {
+    if (control->sources[i] == source) {
+      control->sources[i] = control->sources[--control->source_count];
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static int32_t disconnect(tau_context* context, int32_t source,
+                          int32_t destination) {
+  tau_node* from = tau_context_node(context, source);
+  tau_node* to = tau_context_node(context, destination);
+  if (from == NULL || to == NULL || !contains(&to->control, from)) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_command* command =
+      tau_command_create(context, TAU_COMMAND_DISCONNECT, to, 0);
+  if (command == NULL) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  command->source = from;
+  remove_source(&to->control, from);
+  context->edge_count--;
+  tau_command_post(context, command);
+  return TAU_OK;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_node_disconnect(tau_context* context,
+                                              int32_t source,
+                                              int32_t destination) {
+  if (context == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_control_lock(context);
+  int32_t status = disconnect(context, source, destination);
+  tau_control_unlock(context);
+  return status;
+}
+
+// Queues the start or stop of a source node at `when` seconds.
+static int32_t schedule(tau_context* context, int32_t node, int32_t type,
+                        double when) {
+  tau_node* target = tau_context_node(context, node);
+  if (target == NULL || !target->is_source) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  if (type == TAU_COMMAND_START ? target->control.started
+                                : !target->control.started) {
+    return TAU_ERROR_INVALID_STATE;
+  }
+  tau_command* command = tau_command_create(context, type, target, 0);
+  if (command == NULL) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  command->frame = when * context->sample_rate + 0.5;
+  target->control.started = 1;
+  tau_command_post(context, command);
+  return TAU_OK;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_node_start(tau_context* context, int32_t node,
+                                         double when) {
+  if (context == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_control_lock(context);
+  int32_t status = schedule(context, node, TAU_COMMAND_START, when);
+  tau_control_unlock(context);
+  return status;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_node_stop(tau_context* context, int32_t node,
+                                        double when) {
+  if (context == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_control_lock(context);
+  int32_t status = schedule(context, node, TAU_COMMAND_STOP, when);
+  tau_control_unlock(context);
+  return status;
+}
+
+// Frees commands linked through `next`, none of them queued.
+static void free_commands(tau_context* context, tau_command* commands) {
+  while (commands != NULL) {
+    tau_command* next = commands->next;
+    tau_command_free(context, commands);
+    commands = next;
+  }
+}
+
+static int32_t release(tau_context* context, int32_t node) {
+  tau_node* target = tau_context_node(context, node);
+  if (target == NULL || node == context->destination) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  // The node is disconnected from every node it feeds, then released: all
+  // the commands are made before any is queued.
+  tau_command* disconnects = NULL;
+  for (int32_t i = 0; i < context->node_count; i++) {
+    tau_node* next = context->nodes[i];
+    if (next == NULL || !contains(&next->control, target)) {
+      continue;
+    }
+    tau_command* command =
+        tau_command_create(context, TAU_COMMAND_DISCONNECT, next, 0);
+    if (command == NULL) {
+      free_commands(context, disconnects);
+      return TAU_ERROR_OUT_OF_MEMORY;
+    }
+    command->source = target;
+    command->next = disconnects;
+    disconnects = command;
+  }
+  tau_command* command =
+      tau_command_create(context, TAU_COMMAND_RELEASE, target, 0);
+  if (command == NULL) {
+    free_commands(context, disconnects);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  while (disconnects != NULL) {
+    tau_command* next = disconnects->next;
+    remove_source(&disconnects->node->control, target);
+    context->edge_count--;
+    tau_command_post(context, disconnects);
+    disconnects = next;
+  }
+  context->edge_count -= target->control.source_count;
+  int32_t slot = node & (TAU_MAX_NODES - 1);
+  context->nodes[slot] = NULL;
+  context->generations[slot] =
+      (context->generations[slot] + 1) & (INT32_MAX >> TAU_NODE_SLOT_BITS);
+  context->free_slots[context->free_count++] = slot;
+  tau_command_post(context, command);
+  return TAU_OK;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_node_release(tau_context* context, int32_t node) {
+  if (context == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_control_lock(context);
+  int32_t status = release(context, node);
+  tau_control_unlock(context);
+  return status;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_param_set_value(tau_context* context,
+                                              int32_t node, int32_t param,
+                                              float value) {
+  if (context == NULL || value != value) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_control_lock(context);
+  tau_node* target = tau_context_node(context, node);
+  tau_param* target_param = target != NULL ? tau_node_param(target, param)
+                                           : NULL;
+  tau_command* command =
+      target_param != NULL
+          ? tau_command_create(context, TAU_COMMAND_PARAM_VALUE, target, 0)
+          : NULL;
+  if (command != NULL) {
+    command->param = target_param;
+    command->event.value = value;
+    tau_command_post(context, command);
+  }
+  tau_control_unlock(context);
+  if (target_param == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  return command != NULL ? TAU_OK : TAU_ERROR_OUT_OF_MEMORY;
+}
+
+int tau_node_active_range(tau_context* context, tau_node* node,
+                          int32_t* start, int32_t* end) {
+  int64_t first = context->frame;
+  int64_t last = first + TAU_QUANTUM;
+  if (node->start_frame < 0 || node->start_frame >= last ||
+      node->stop_frame <= first || node->stop_frame <= node->start_frame) {
+    return 0;
+  }
+  *start = node->start_frame > first ? (int32_t)(node->start_frame - first)
+                                     : 0;
+  *end = node->stop_frame < last ? (int32_t)(node->stop_frame - first)
+                                 : TAU_QUANTUM;
+  return 1;
+}
+
+void tau_node_output_silence(tau_node* node, int32_t channels) {
+  node->output_channels = channels;
+  if (!node->output_silent) {
+    memset(node->output, 0,
+           (size_t)channels * TAU_QUANTUM * sizeof(float));
+    node->output_silent = 1;
+  }
+}
+
+// Appends the nodes feeding `node`, then `node`, to the render order.
+static void visit(tau_context* context, tau_node* node) {
+  if (node->mark == context->epoch) {
+    return;
+  }
+  node->mark = context->epoch;
+  for (int32_t i = 0; i < node->source_count; i++) {
+    visit(context, node->sources[i]);
+  }
+  context->order[context->order_count++] = node;
+}
+
+static void update_order(tau_context* context) {
+  context->epoch++;
+  context->order_count = 0;
+  visit(context, context->destination_node);
+  if (context->pool != NULL) {
+    tau_schedule_update(context);
+  }
+  context->order_dirty = 0;
+}
+
+static void mix_inputs(tau_node* node) {
+  int32_t channels = 1;
+  for (int32_t i = 0; i < node->source_count; i++) {
+    int32_t source_channels = node->sources[i]->output_channels;
+    if (source_channels > channels) {
+      channels = source_channels;
+    }
+  }
+  if (node->channel_count_mode == TAU_CHANNELS_EXPLICIT ||
+      (node->channel_count_mode == TAU_CHANNELS_CLAMPED_MAX &&
+       channels > node->channel_count)) {
+    channels = node->channel_count;
+  }
+  if (channels > node->input_capacity) {
+    channels = node->input_capacity;
+  }
+  int was_silent = node->input_silent || node->input_channels != channels;
+  node->input_channels = channels;
+  node->input_silent = 1;
+  for (int32_t i = 0; i < node->source_count; i++) {
+    tau_node* source = node->sources[i];
+    if (source->output_silent) {
+      continue;
+    }
+    tau_bus_mix(node->input, channels, source->output, source->output_channels,
+                node->channel_interpretation, !node->input_silent);
+    node->input_silent = 0;
+  }
+  if (node->input_silent && !was_silent) {
+    memset(node->input, 0, (size_t)channels * TAU_QUANTUM * sizeof(float));
+  }
+}
+
+int64_t tau_node_render(tau_context* context, tau_node* node, int64_t start) {
+  mix_inputs(node);
+  node->ops->process(context, node);
+  int64_t end = tau_profile_now();
+#if TAU_PROFILING
+  tau_timings_record(&node->timings, end - start, context->deadline_ns);
+#endif
+  return end;
+}
+
+static void render_quantum(tau_context* context) {
+  int64_t start = tau_profile_now();
+  tau_arena_reset();
+  tau_command_drain(context);
+  if (context->order_dirty) {
+    update_order(context);
+  }
+  int64_t now = tau_profile_now();
+  if (context->pool != NULL) {
+    tau_schedule_run(context);
+    now = tau_profile_now();
+  } else {
+    for (int32_t i = 0; i < context->order_count; i++) {
+      now = tau_node_render(context, context->order[i], now);
+    }
+  }
+  context->frame += TAU_QUANTUM;
+#if TAU_PROFILING
+  tau_timings_record(&context->timings, now - start, context->deadline_ns);
+#else
+  (void)start;
+  (void)now;
+#endif
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_context_set_render_threads(tau_context* context,
+                                                         int32_t threads) {
+  if (context == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  if (threads <= 0) {
+    threads = tau_cpu_count();
+  }
+  tau_control_lock(context);
+  int32_t status = TAU_OK;
+  if (threads != context->render_threads) {
+    // The rendering thread is one of the render threads.
+    tau_command* command =
+        tau_command_create(context, TAU_COMMAND_THREADS, NULL, 0);
+    tau_pool* pool = threads > 1 ? tau_pool_create(threads - 1) : NULL;
+    if (command == NULL || (threads > 1 && pool == NULL)) {
+      tau_command_free(context, command);
+      if (pool != NULL) {
+        tau_pool_destroy(pool);
+      }
+      status = TAU_ERROR_OUT_OF_MEMORY;
+    } else {
+      command->memory[0] = pool;
+      tau_command_post(context, command);
+      context->render_threads = threads;
+    }
+  }
+  tau_control_unlock(context);
+  return status;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_context_set_resampler_quality(
+    tau_context* context, int32_t quality) {
+  if (context == NULL || quality < TAU_RESAMPLER_LINEAR ||
+      quality > TAU_RESAMPLER_HIGH) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_atomic_store_i32(&context->resampler_quality, quality);
+  return TAU_OK;
+}
+
+// Renders `frames` frames into planar channels `stride` samples apart.
+static void render_planar(tau_context* context, float* output, size_t stride,
+                          int32_t frames) {
+  tau_node* destination = context->destination_node;
+  int32_t done = 0;
+  while (done < frames) {
+    if (context->pending_offset == TAU_QUANTUM) {
+      render_quantum(context);
+      context->pending_offset = 0;
+    }
+    int32_t count = TAU_QUANTUM - context->pending_offset;
+    if (count > frames - done) {
+      count = frames - done;
+    }
+    for (int32_t c = 0; c < context->channel_count; c++) {
+      memcpy(output + c * stride + done,
+             destination->output + c * TAU_QUANTUM + context->pending_offset,
+             (size_t)count * sizeof(float));
+    }
+    context->pending_offset += count;
+    done += count;
+  }
+  int64_t delivered = context->frame - (TAU_QUANTUM - context->pending_offset);
+  tau_atomic_store_i64(&context->current_frame, delivered);
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_context_render(tau_context* context,
+                                             float* output, int32_t frames) {
+  if (context == NULL || frames < 0 || (output == NULL && frames > 0)) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  render_planar(context, output, (size_t)frames, frames);
+  return frames;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_context_render_buffer(tau_context* context,
+                                                    tau_audio_buffer* buffer) {
+  if (context == NULL || buffer == NULL ||
+      buffer->channels != context->channel_count) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  render_planar(context, buffer->data, (size_t)buffer->stride, buffer->frames);
+  return buffer->frames;
+}
+
+// The destination passes its input, mixed to the context channels, through.
+static void process_destination(tau_context* context, tau_node* node) {
+  (void)context;
+  node->output_channels = node->input_channels;
+  if (node->input_silent) {
+    tau_node_output_silence(node, node->input_channels);
+    return;
+  }
+  memcpy(node->output, node->input,
+         (size_t)node->input_channels * TAU_QUANTUM * sizeof(float));
+  node->output_silent = 0;
+}
+
+static const tau_node_ops destination_ops = {process_destination, NULL};
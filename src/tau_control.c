@@ -0,0 +1,237 @@
+// Edits of the graph, queued by the control threads for the rendering
+// thread.
+//
+// A control thread edits the graph under the control lock: it checks the
+// edit against the control part of the nodes, which it updates at once,
+// allocates whatever the rendering thread will need, and pushes a command
+// onto the queue of the context. The rendering thread never takes the lock:
+// before every quantum it takes the whole queue with one exchange, and
+// applies the commands in the order they were queued. Commands come back
+// through the retired list with the memory they replaced, and the next
+// control thread taking the lock frees them, so the rendering thread
+// neither allocates for an edit nor frees anything.
+#include <string.h>
+
+#include "tau_engine.h"
+
+// Pushes `command` onto `list`.
+static void push(void* volatile* list, tau_command* command) {
+  void* head = tau_atomic_load_ptr((void* const volatile*)list);
+  do {
+    command->next = (tau_command*)head;
+  } while (!tau_atomic_cas_ptr(list, &head, command));
+}
+
+void tau_control_lock(tau_context* context) {
+  tau_mutex_lock(&context->control_lock);
+  tau_command* command =
+      (tau_command*)tau_atomic_exchange_ptr(&context->retired, NULL);
+  while (command != NULL) {
+    tau_command* next = command->next;
+    tau_command_free(context, command);
+    command = next;
+  }
+}
+
+void tau_control_unlock(tau_context* context) {
+  tau_mutex_unlock(&context->control_lock);
+}
+
+// Whether `command` comes from the command pool, as all but curves do.
+static int pooled(const tau_command* command) {
+  return command->type != TAU_COMMAND_AUTOMATION ||
+         command->event.curve_length == 0;
+}
+
+tau_command* tau_command_create(tau_context* context, int32_t type,
+                                tau_node* node, int32_t curve_length) {
+  tau_command* command;
+  if (curve_length == 0) {
+    command = (tau_command*)tau_fixed_pool_alloc(&context->command_pool);
+    if (command != NULL) {
+      memset(command, 0, sizeof(tau_command));
+    }
+  } else {
+    command = (tau_command*)tau_memory_calloc(
+        sizeof(tau_command) + (size_t)curve_length * sizeof(float),
+        sizeof(double));
+  }
+  if (command != NULL) {
+    command->type = type;
+    command->node = node;
+  }
+  return command;
+}
+
+void tau_command_post(tau_context* context, tau_command* command) {
+  push(&context->commands, command);
+}
+
+void tau_command_retire(tau_context* context, tau_command* command) {
+  if (command != NULL) {
+    push(&context->retired, command);
+  }
+}
+
+void tau_command_free(tau_context* context, tau_command* command) {
+  if (command == NULL) {
+    return;
+  }
+  switch (command->type) {
+    case TAU_COMMAND_RELEASE:
+      tau_node_free(context, command->node);
+      break;
+    case TAU_COMMAND_BUSES:
+      for (int32_t i = 0; i < 2; i++) {
+        if (command->memory[i] != NULL) {
+          tau_bus_free(context, (float*)command->memory[i],
+                       command->capacities[i]);
+        }
+      }
+      break;
+    case TAU_COMMAND_THREADS:
+      if (command->memory[0] != NULL) {
+        tau_pool_destroy((tau_pool*)command->memory[0]);
+      }
+      break;
+    case TAU_COMMAND_VOICE_PLAY:
+      // The filter is shared, and the buffer counted.
+      tau_audio_buffer_release((tau_audio_buffer*)command->memory[0]);
+      break;
+    case TAU_COMMAND_VOICE_STOP:
+      break;
+    default:
+      tau_memory_free(command->memory[0]);
+      tau_memory_free(command->memory[1]);
+      break;
+  }
+  if (pooled(command)) {
+    tau_fixed_pool_free(&context->command_pool, command);
+  } else {
+    tau_memory_free(command);
+  }
+}
+
+// --- Rendering thread ---
+
+static void remove_source(tau_node* node, tau_node* source) {
+  for (int32_t i = 0; i < node->source_count; i++) {
+    if (node->sources[i] == source) {
+      node->sources[i] = node->sources[--node->source_count];
+      return;
+    }
+  }
+}
+
+// `frame`, rounded, and not earlier than the next quantum.
+static int64_t clamp_frame(tau_context* context, double frame) {
+  if (!(frame > (double)context->frame)) {
+    return context->frame;
+  }
+  return frame >= (double)INT64_MAX ? INT64_MAX : (int64_t)frame;
+}
+
+// Swaps `*field` for `command->memory[index]`, which then holds the
+// replaced memory.
+static void swap(tau_command* command, int32_t index, void** field) {
+  void* replaced = *field;
+  *field = command->memory[index];
+  command->memory[index] = replaced;
+}
+
+// Applies `command`. Returns whether it is kept past the quantum.
+static int apply(tau_context* context, tau_command* command) {
+  tau_node* node = command->node;
+  switch (command->type) {
+    case TAU_COMMAND_CONNECT:
+      if (command->memory[0] != NULL) {
+        memcpy(command->memory[0], node->sources,
+               (size_t)node->source_count * sizeof(tau_node*));
+        swap(command, 0, (void**)&node->sources);
+        if (command->memory[0] == node->inline_sources) {
+          command->memory[0] = NULL;
+        }
+      }
+      // A failed connection only hands its array over.
+      if (command->source != NULL) {
+        node->sources[node->source_count++] = command->source;
+        context->order_dirty = 1;
+      }
+      return 0;
+    case TAU_COMMAND_DISCONNECT:
+      remove_source(node, command->source);
+      context->order_dirty = 1;
+      return 0;
+    case TAU_COMMAND_START:
+      node->start_frame = clamp_frame(context, command->frame);
+      return 0;
+    case TAU_COMMAND_STOP:
+      node->stop_frame = clamp_frame(context, command->frame);
+      return 0;
+    case TAU_COMMAND_RELEASE:
+      context->order_dirty = 1;
+      return 0;
+    case TAU_COMMAND_CHANNELS:
+      node->channel_count = command->count;
+      node->channel_count_mode = (tau_channel_count_mode)command->mode;
+      node->channel_interpretation =
+          (tau_channel_interpretation)command->interpretation;
+      return 0;
+    case TAU_COMMAND_BUSES:
+      if (command->memory[0] != NULL) {
+        int32_t capacity = node->input_capacity;
+        swap(command, 0, (void**)&node->input);
+        node->input_capacity = command->capacities[0];
+        command->capacities[0] = capacity;
+        // The new bus holds no input yet.
+        node->input_silent = 1;
+      }
+      if (command->memory[1] != NULL) {
+        int32_t capacity = node->output_capacity;
+        swap(command, 1, (void**)&node->output);
+        node->output_capacity = command->capacities[1];
+        command->capacities[1] = capacity;
+        node->output_silent = 1;
+      }
+      return 0;
+    case TAU_COMMAND_SLOTS:
+      swap(command, 0, (void**)&context->order);
+      swap(command, 1, (void**)&context->chains);
+      context->order_dirty = 1;
+      return 0;
+    case TAU_COMMAND_EDGES:
+      swap(command, 0, (void**)&context->chain_dependents);
+      context->order_dirty = 1;
+      return 0;
+    case TAU_COMMAND_THREADS:
+      swap(command, 0, (void**)&context->pool);
+      context->order_dirty = 1;
+      return 0;
+    case TAU_COMMAND_VOICE_PLAY:
+    case TAU_COMMAND_VOICE_STOP:
+      tau_voice_pool_apply(context, command);
+      return 0;
+    default:
+      return tau_automation_apply(context, command);
+  }
+}
+
+void tau_command_drain(tau_context* context) {
+  tau_command* command =
+      (tau_command*)tau_atomic_exchange_ptr(&context->commands, NULL);
+  // The queue is a stack: reversed, it lists the commands as queued.
+  tau_command* ordered = NULL;
+  while (command != NULL) {
+    tau_command* next = command->next;
+    command->next = ordered;
+    ordered = command;
+    command = next;
+  }
+  while (ordered != NULL) {
+    command = ordered;
+    ordered = ordered->next;
+    if (!apply(context, command)) {
+      tau_command_retire(context, command);
+    }
+  }
+}
@@ -0,0 +1,228 @@
+// The convolver node: uniformly partitioned FFT convolution.
+//
+// The impulse response is cut into partitions of one quantum, each
+// transformed once, zero-padded to two quanta. Every quantum, the last two
+// quanta of input are transformed into a frequency-domain delay line holding
+// the spectra of the last `partitions` quanta; the output is the inverse
+// transform of the sum of their products with the partition spectra, of which
+// the second half is the convolution (overlap-save). The cost per quantum is
+// one forward and one inverse transform per channel, plus one spectrum
+// multiply-add per partition, against one multiply-add per impulse sample and
+// output sample for the direct form.
+#include <math.h>
+#include <string.h>
+
+#include "tau_engine.h"
+#include "tau_fft.h"
+
+#define FFT_SIZE (2 * TAU_QUANTUM)
+#define BINS (TAU_QUANTUM + 1)
+// The floats between consecutive spectra, a multiple of the cache line.
+#define BIN_STRIDE 144
+
+// The normalization of the Web Audio convolver: the impulse response is
+// scaled to a fixed power.
+#define GAIN_CALIBRATION 0.00125
+#define GAIN_CALIBRATION_SAMPLE_RATE 44100.0
+#define MIN_POWER 0.000125
+
+typedef struct convolver {
+  int32_t channels;
+  int32_t partitions;
+  // The delay line slot of the current quantum.
+  int32_t head;
+  // Quanta of silent input since the last sound, to stop rendering once the
+  // tail has rung out.
+  int32_t silent_quanta;
+  tau_fft fft;
+  // The spectra of every partition of every channel, partition by partition,
+  // scaled by 1 / `FFT_SIZE` to undo the inverse transform.
+  float* filter_re;
+  float* filter_im;
+  // The spectra of the input of the last `partitions` quanta, per channel.
+  float* delay_re;
+  float* delay_im;
+  // The last two quanta of input of every channel.
+  float* history;
+  float* sum_re;
+  float* sum_im;
+  float* time;
+} convolver;
+
+typedef struct convolver_state {
+  convolver* self;
+} convolver_state;
+
+static float* spectrum(float* spectra, const convolver* self, int32_t channel,
+                       int32_t partition) {
+  return spectra +
+         ((size_t)channel * self->partitions + partition) * BIN_STRIDE;
+}
+
+static void convolver_free(convolver* self) {
+  tau_fft_destroy(&self->fft);
+  tau_memory_free(self->filter_re);
+  tau_memory_free(self->filter_im);
+  tau_memory_free(self->delay_re);
+  tau_memory_free(self->delay_im);
+  tau_memory_free(self->history);
+  tau_memory_free(self->sum_re);
+  tau_memory_free(self->sum_im);
+  tau_memory_free(self->time);
+  tau_memory_free(self);
+}
+
+static double normalization(const tau_audio_buffer* impulse) {
+  double power = 0.0;
+  for (int32_t c = 0; c < impulse->channels; c++) {
+    const float* samples = impulse->data + (size_t)c * impulse->stride;
+    for (int32_t i = 0; i < impulse->frames; i++) {
+      power += (double)samples[i] * samples[i];
+    }
+  }
+  power = sqrt(power / ((double)impulse->channels * impulse->frames));
+  if (!isfinite(power) || power < MIN_POWER) {
+    power = MIN_POWER;
+  }
+  double scale = GAIN_CALIBRATION / power;
+  scale *= GAIN_CALIBRATION_SAMPLE_RATE / impulse->sample_rate;
+  // True-stereo responses sum two paths into every output channel.
+  return impulse->channels == 4 ? scale * 0.5 : scale;
+}
+
+static convolver* convolver_new(const tau_audio_buffer* impulse,
+                                int normalize) {
+  convolver* self = (convolver*)tau_memory_calloc(sizeof(convolver),
+                                                  TAU_CACHE_LINE);
+  if (self == NULL) {
+    return NULL;
+  }
+  self->channels = impulse->channels;
+  self->partitions = (impulse->frames + TAU_QUANTUM - 1) / TAU_QUANTUM;
+  size_t spectra =
+      (size_t)self->channels * self->partitions * BIN_STRIDE * sizeof(float);
+  self->filter_re = (float*)tau_memory_alloc(spectra, TAU_CACHE_LINE);
+  self->filter_im = (float*)tau_memory_alloc(spectra, TAU_CACHE_LINE);
+  self->delay_re = (float*)tau_memory_calloc(spectra, TAU_CACHE_LINE);
+  self->delay_im = (float*)tau_memory_calloc(spectra, TAU_CACHE_LINE);
+  self->history = (float*)tau_memory_calloc(
+      (size_t)self->channels * FFT_SIZE * sizeof(float), TAU_CACHE_LINE);
+  self->sum_re =
+      (float*)tau_memory_alloc(BIN_STRIDE * sizeof(float), TAU_CACHE_LINE);
+  self->sum_im =
+      (float*)tau_memory_alloc(BIN_STRIDE * sizeof(float), TAU_CACHE_LINE);
+  self->time =
+      (float*)tau_memory_alloc(FFT_SIZE * sizeof(float), TAU_CACHE_LINE);
+  if (tau_fft_init(&self->fft, FFT_SIZE) != TAU_OK ||
+      self->filter_re == NULL || self->filter_im == NULL ||
+      self->delay_re == NULL || self->delay_im == NULL ||
+      self->history == NULL || self->sum_re == NULL || self->sum_im == NULL ||
+      self->time == NULL) {
+    convolver_free(self);
+    return NULL;
+  }
+  float scale = (float)((normalize ? normalization(impulse) : 1.0) / FFT_SIZE);
+  for (int32_t c = 0; c < self->channels; c++) {
+    const float* samples = impulse->data + (size_t)c * impulse->stride;
+    for (int32_t p = 0; p < self->partitions; p++) {
+      int32_t offset = p * TAU_QUANTUM;
+      int32_t count = impulse->frames - offset < TAU_QUANTUM
+                          ? impulse->frames - offset
+                          : TAU_QUANTUM;
+      memset(self->time, 0, FFT_SIZE * sizeof(float));
+      for (int32_t i = 0; i < count; i++) {
+        self->time[i] = samples[offset + i] * scale;
+      }
+      tau_fft_forward(&self->fft, self->time,
+                      spectrum(self->filter_re, self, c, p),
+                      spectrum(self->filter_im, self, c, p));
+    }
+  }
+  // Starts as if the input had always been silent.
+  self->silent_quanta = self->partitions + 1;
+  return self;
+}
+
+static void process_convolver(tau_context* context, tau_node* node) {
+  (void)context;
+  convolver* self = ((convolver_state*)node->state)->self;
+  int32_t channels = self->channels;
+  self->silent_quanta = node->input_silent ? self->silent_quanta + 1 : 0;
+  if (self->silent_quanta > self->partitions + 1) {
+    // The history and every spectrum of the delay line are zeros: the first
+    // silent quantum still held the last sound, but the delay line has been
+    // overwritten since.
+    tau_node_output_silence(node, channels);
+    return;
+  }
+  const tau_kernel_table* kernels = tau_kernels();
+  int32_t head = self->head;
+  for (int32_t c = 0; c < channels; c++) {
+    float* history = self->history + (size_t)c * FFT_SIZE;
+    memcpy(history, history + TAU_QUANTUM, TAU_QUANTUM * sizeof(float));
+    if (node->input_silent) {
+      memset(history + TAU_QUANTUM, 0, TAU_QUANTUM * sizeof(float));
+    } else {
+      memcpy(history + TAU_QUANTUM, node->input + c * TAU_QUANTUM,
+             TAU_QUANTUM * sizeof(float));
+    }
+    tau_fft_forward(&self->fft, history,
+                    spectrum(self->delay_re, self, c, head),
+                    spectrum(self->delay_im, self, c, head));
+    memset(self->sum_re, 0, BINS * sizeof(float));
+    memset(self->sum_im, 0, BINS * sizeof(float));
+    // Partition p of the response meets the input of p quanta ago.
+    int32_t slot = head;
+    for (int32_t p = 0; p < self->partitions; p++) {
+      kernels->complex_multiply_add(
+          self->sum_re, self->sum_im, spectrum(self->delay_re, self, c, slot),
+          spectrum(self->delay_im, self, c, slot),
+          spectrum(self->filter_re, self, c, p),
+          spectrum(self->filter_im, self, c, p), BINS);
+      slot = slot > 0 ? slot - 1 : self->partitions - 1;
+    }
+    tau_fft_inverse(&self->fft, self->sum_re, self->sum_im, self->time);
+    memcpy(node->output + c * TAU_QUANTUM, self->time + TAU_QUANTUM,
+           TAU_QUANTUM * sizeof(float));
+  }
+  self->head = head + 1 < self->partitions ? head + 1 : 0;
+  node->output_channels = channels;
+  node->output_silent = 0;
+}
+
+static void destroy_convolver(tau_node* node) {
+  convolver_free(((convolver_state*)node->state)->self);
+}
+
+static const tau_node_ops convolver_ops = {process_convolver,
+                                           destroy_convolver};
+
+FFI_PLUGIN_EXPORT int32_t tau_convolver_create(tau_context* context,
+                                               tau_audio_buffer* impulse,
+                                               int32_t normalize) {
+  if (context == NULL || impulse == NULL || impulse->frames <= 0) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  if (impulse->sample_rate != context->sample_rate) {
+    return TAU_ERROR_NOT_SUPPORTED;
+  }
+  convolver* self = convolver_new(impulse, normalize != 0);
+  if (self == NULL) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  tau_node* node = tau_node_create(context, &convolver_ops,
+                                   sizeof(convolver_state), impulse->channels);
+  if (node == NULL) {
+    convolver_free(self);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  ((convolver_state*)node->state)->self = self;
+  int32_t status =
+      tau_node_set_channels(context, node, impulse->channels,
+                            TAU_CHANNELS_EXPLICIT, TAU_INTERPRETATION_SPEAKERS);
+  if (status != TAU_OK) {
+    tau_node_release(context, node->id);
+    return status;
+  }
+  return node->id;
+}
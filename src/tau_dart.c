@@ -0,0 +1,63 @@
+#include "tau_dart.h"
+
+// The subset of `Dart_CObject`, from the Dart SDK's `dart_native_api.h`, used
+// to post results. Only the members read for the types used here are
+// declared, at the same offsets as in the SDK.
+enum {
+  kTauCObjectInt64 = 3,
+  kTauCObjectArray = 6,
+};
+
+typedef struct tau_cobject {
+  int32_t type;
+  union {
+    int64_t as_int64;
+    struct {
+      intptr_t length;
+      struct tau_cobject** values;
+    } as_array;
+  } value;
+} tau_cobject;
+
+typedef int8_t (*tau_post_cobject_fn)(int64_t port, tau_cobject* message);
+
+static void* volatile post_cobject;
+
+FFI_PLUGIN_EXPORT void tau_async_init(void* post_cobject_fn) {
+  tau_atomic_store_ptr(&post_cobject, post_cobject_fn);
+}
+
+int tau_dart_can_post(void) { return tau_atomic_load_ptr(&post_cobject) != NULL; }
+
+// Messages are copied by Dart before the post returns, so they can live on
+// the stack.
+static int post(int64_t port, tau_cobject* message) {
+  tau_post_cobject_fn post_fn =
+      (tau_post_cobject_fn)tau_atomic_load_ptr(&post_cobject);
+  if (post_fn == NULL) {
+    return 0;
+  }
+  return post_fn(port, message) != 0;
+}
+
+int tau_dart_post_int64(int64_t port, int64_t value) {
+  tau_cobject message;
+  message.type = kTauCObjectInt64;
+  message.value.as_int64 = value;
+  return post(port, &message);
+}
+
+int tau_dart_post_pair(int64_t port, int64_t first, int64_t second) {
+  tau_cobject first_object;
+  first_object.type = kTauCObjectInt64;
+  first_object.value.as_int64 = first;
+  tau_cobject second_object;
+  second_object.type = kTauCObjectInt64;
+  second_object.value.as_int64 = second;
+  tau_cobject* values[2] = {&first_object, &second_object};
+  tau_cobject message;
+  message.type = kTauCObjectArray;
+  message.value.as_array.length = 2;
+  message.value.as_array.values = values;
+  return post(port, &message);
+}
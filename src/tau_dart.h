@@ -0,0 +1,17 @@
+// Posting messages from native threads to Dart ports.
+#ifndef TAU_DART_H_
+#define TAU_DART_H_
+
+#include "tau_platform.h"
+
+// Whether `tau_async_init` registered a way to post to Dart.
+int tau_dart_can_post(void);
+
+// Posts `value` to `port`. Returns 0 if the message was not delivered.
+int tau_dart_post_int64(int64_t port, int64_t value);
+
+// Posts the list `[first, second]` to `port`. Returns 0 if the message was not
+// delivered.
+int tau_dart_post_pair(int64_t port, int64_t first, int64_t second);
+
+#endif  // TAU_DART_H_
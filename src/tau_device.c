@@ -0,0 +1,200 @@
+// Devices: contexts played in real time through a device backend.
+//
+// The callback of a device is the rendering thread of its context: it
+// renders the period, interleaves it for the backend, and accounts for it.
+// The counters have that one writer, so relaxed loads and stores suffice,
+// and any thread reads them.
+#include <string.h>
+
+#include "tau_device.h"
+#include "tau_engine.h"
+
+// The most backends `tau_device_backend_register` accepts.
+#define MAX_BACKENDS 16
+
+#define MAX_PERIOD_FRAMES 16384
+
+static const tau_device_backend* backends[MAX_BACKENDS];
+static volatile int32_t backend_count;
+
+FFI_PLUGIN_EXPORT int32_t tau_device_backend_register(
+    const tau_device_backend* backend) {
+  if (backend == NULL || backend->name == NULL || backend->open == NULL ||
+      backend->start == NULL || backend->stop == NULL ||
+      backend->close == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  int32_t count = tau_atomic_load_i32(&backend_count);
+  if (count == MAX_BACKENDS) {
+    return TAU_ERROR_NOT_SUPPORTED;
+  }
+  backends[count] = backend;
+  tau_atomic_store_i32(&backend_count, count + 1);
+  return TAU_OK;
+}
+
+// The backend named `name`, the most recently registered first, or NULL.
+static const tau_device_backend* find_backend(const char* name) {
+  static const tau_device_backend* const built_in[] = {&tau_null_backend,
+                                                       &tau_wav_backend};
+  for (int32_t i = tau_atomic_load_i32(&backend_count); i > 0; i--) {
+    if (strcmp(backends[i - 1]->name, name) == 0) {
+      return backends[i - 1];
+    }
+  }
+  for (size_t i = 0; i < sizeof(built_in) / sizeof(built_in[0]); i++) {
+    if (strcmp(built_in[i]->name, name) == 0) {
+      return built_in[i];
+    }
+  }
+  return NULL;
+}
+
+struct tau_device {
+  const tau_device_backend* backend;
+  void* handle;
+  tau_context* context;
+  int32_t channels;
+  int32_t started;
+  // A period, planar, as the context renders it.
+  float* planar;
+
+  // What follows belongs to the callback.
+
+  // When the last callback started, or 0 after a start, and the duration
+  // of its period.
+  int64_t last_start;
+  int64_t last_period_ns;
+
+  volatile int64_t callbacks;
+  volatile int64_t frames;
+  volatile int64_t underruns;
+  volatile int64_t render_ns;
+  volatile int64_t max_render_ns;
+  volatile int64_t jitter_ns;
+  volatile int64_t max_jitter_ns;
+};
+
+// Adds `value` to a counter only the callback writes.
+static void add(volatile int64_t* counter, int64_t value) {
+  tau_atomic_store_relaxed_i64(counter,
+                               tau_atomic_load_relaxed_i64(counter) + value);
+}
+
+static void raise_max(volatile int64_t* counter, int64_t value) {
+  if (value > tau_atomic_load_relaxed_i64(counter)) {
+    tau_atomic_store_relaxed_i64(counter, value);
+  }
+}
+
+static void render(void* user, float* output, int32_t frames,
+                   int64_t time_left_ns) {
+  tau_device* device = (tau_device*)user;
+  int64_t start = tau_now_ns();
+  int32_t channels = device->channels;
+  tau_context_render(device->context, device->planar, frames);
+  for (int32_t i = 0; i < frames; i++) {
+    for (int32_t c = 0; c < channels; c++) {
+      output[i * channels + c] = device->planar[c * frames + i];
+    }
+  }
+  int64_t end = tau_now_ns();
+  add(&device->callbacks, 1);
+  add(&device->frames, frames);
+  add(&device->render_ns, end - start);
+  raise_max(&device->max_render_ns, end - start);
+  if (end - start > time_left_ns) {
+    add(&device->underruns, 1);
+  }
+  if (device->last_start != 0) {
+    int64_t jitter = start - device->last_start - device->last_period_ns;
+    jitter = jitter < 0 ? -jitter : jitter;
+    add(&device->jitter_ns, jitter);
+    raise_max(&device->max_jitter_ns, jitter);
+  }
+  device->last_start = start;
+  device->last_period_ns =
+      (int64_t)(frames * 1e9 / tau_context_sample_rate(device->context));
+}
+
+FFI_PLUGIN_EXPORT tau_device* tau_device_open(tau_context* context,
+                                              const char* backend,
+                                              const char* options,
+                                              int32_t period_frames) {
+  if (context == NULL || backend == NULL || period_frames <= 0 ||
+      period_frames > MAX_PERIOD_FRAMES) {
+    return NULL;
+  }
+  const tau_device_backend* found = find_backend(backend);
+  if (found == NULL) {
+    return NULL;
+  }
+  tau_device* device =
+      (tau_device*)tau_memory_calloc(sizeof(tau_device), TAU_CACHE_LINE);
+  if (device == NULL) {
+    return NULL;
+  }
+  device->backend = found;
+  device->context = context;
+  device->channels = context->channel_count;
+  device->planar = (float*)tau_memory_alloc(
+      (size_t)period_frames * device->channels * sizeof(float),
+      TAU_CACHE_LINE);
+  if (device->planar != NULL) {
+    device->handle =
+        found->open(options, device->channels, context->sample_rate,
+                    period_frames, render, device);
+  }
+  if (device->handle == NULL) {
+    tau_memory_free(device->planar);
+    tau_memory_free(device);
+    return NULL;
+  }
+  return device;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_device_start(tau_device* device) {
+  if (device == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  if (device->started) {
+    return TAU_OK;
+  }
+  // The pause is no jitter.
+  device->last_start = 0;
+  int32_t status = device->backend->start(device->handle);
+  device->started = status == TAU_OK;
+  return status;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_device_stop(tau_device* device) {
+  if (device == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  if (!device->started) {
+    return TAU_OK;
+  }
+  device->started = 0;
+  return device->backend->stop(device->handle);
+}
+
+FFI_PLUGIN_EXPORT void tau_device_close(tau_device* device) {
+  if (device == NULL) {
+    return;
+  }
+  tau_device_stop(device);
+  device->backend->close(device->handle);
+  tau_memory_free(device->planar);
+  tau_memory_free(device);
+}
+
+FFI_PLUGIN_EXPORT void tau_device_get_stats(tau_device* device,
+                                            tau_device_stats* stats) {
+  stats->callbacks = tau_atomic_load_relaxed_i64(&device->callbacks);
+  stats->frames = tau_atomic_load_relaxed_i64(&device->frames);
+  stats->underruns = tau_atomic_load_relaxed_i64(&device->underruns);
+  stats->render_ns = tau_atomic_load_relaxed_i64(&device->render_ns);
+  stats->max_render_ns = tau_atomic_load_relaxed_i64(&device->max_render_ns);
+  stats->jitter_ns = tau_atomic_load_relaxed_i64(&device->jitter_ns);
+  stats->max_jitter_ns = tau_atomic_load_relaxed_i64(&device->max_jitter_ns);
+}
@@ -0,0 +1,11 @@
+// The device backends built into the library, found after the registered
+// ones.
+#ifndef TAU_DEVICE_H_
+#define TAU_DEVICE_H_
+
+#include "tau_platform.h"
+
+extern const tau_device_backend tau_null_backend;
+extern const tau_device_backend tau_wav_backend;
+
+#endif  // TAU_DEVICE_H_
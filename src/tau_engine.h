@@ -0,0 +1,533 @@
+// The render graph behind `tau_context`.
+//
+// A node renders one quantum at a time: the context first mixes the outputs of
+// every node connected to its input into `input`, then calls the `process`
+// function of the node, which fills `output`. Nodes are processed in an order
+// where every node comes after its inputs, recomputed whenever connections
+// change.
+#ifndef TAU_ENGINE_H_
+#define TAU_ENGINE_H_
+
+#include "tau_kernels.h"
+#include "tau_memory.h"
+#include "tau_pool.h"
+
+#define TAU_QUANTUM TAU_RENDER_QUANTUM_FRAMES
+
+// The parameters a node holds without allocating.
+#define TAU_MAX_NODE_PARAMS 4
+
+// The largest node state, which comes from a pool of the context.
+#define TAU_MAX_NODE_STATE 128
+
+// The connections a node holds without allocating.
+#define TAU_INLINE_SOURCES 4
+
+// Node handles are a slot index in the low bits, and in the high bits a
+// generation that changes whenever the slot is reused, so that the handle of
+// a released node never reaches its successor.
+#define TAU_NODE_SLOT_BITS 16
+#define TAU_MAX_NODES (1 << TAU_NODE_SLOT_BITS)
+
+// Buses come from one pool per power-of-two channel count, up to
+// `TAU_MAX_CHANNELS`.
+#define TAU_BUS_CLASSES 6
+
+// Whether the rendering thread records the timings of `tau_profile`. Set by
+// the CMake option `TAU_FFI_PROFILING`; on in other builds.
+#ifndef TAU_PROFILING
+#define TAU_PROFILING 1
+#endif
+
+typedef struct tau_node tau_node;
+
+// How the channel count of an input bus is computed from its connections,
+// as the Web Audio `channelCountMode`.
+typedef enum tau_channel_count_mode {
+  TAU_CHANNELS_MAX,
+  TAU_CHANNELS_CLAMPED_MAX,
+  TAU_CHANNELS_EXPLICIT,
+} tau_channel_count_mode;
+
+// How channels are mapped when mixing buses of different channel counts, as
+// the Web Audio `channelInterpretation`.
+typedef enum tau_channel_interpretation {
+  TAU_INTERPRETATION_SPEAKERS,
+  TAU_INTERPRETATION_DISCRETE,
+} tau_channel_interpretation;
+
+// Kinds of `tau_automation_event`, after the `AudioParam` methods scheduling
+// them.
+typedef enum tau_automation_type {
+  TAU_EVENT_SET_VALUE,
+  TAU_EVENT_LINEAR_RAMP,
+  TAU_EVENT_EXPONENTIAL_RAMP,
+  TAU_EVENT_SET_TARGET,
+  TAU_EVENT_SET_VALUE_CURVE,
+  // Removes the events at `frame` and later. Never stored in a timeline.
+  TAU_EVENT_CANCEL,
+} tau_automation_type;
+
+typedef struct tau_command tau_command;
+
+// A scheduled change of a parameter. Frames are context frames, and may
+// fall between two samples: an event applies from the first sample at or
+// after its frame.
+typedef struct tau_automation_event {
+  int32_t type;
+  // The value reached at `frame`, or the target of a target approach.
+  float value;
+  double frame;
+  // The time constant of a target approach, or the duration of a curve, in
+  // frames.
+  double length;
+  // The values of a curve, held by the command that scheduled it, which is
+  // retired once the event is gone.
+  const float* curve;
+  int32_t curve_length;
+  tau_command* command;
+} tau_automation_event;
+
+// An automatable parameter, and its timeline of scheduled events.
+//
+// The timeline belongs to the rendering thread: events scheduled from other
+// threads reach it as commands. It is evaluated one quantum at a time by
+// `tau_param_render`.
+typedef struct tau_param {
+  int32_t id;
+  // The value at the start of the last quantum rendered, which holds while
+  // no event was ever scheduled.
+  float value;
+  // The bits of `value`, for control threads.
+  volatile int32_t published;
+  float min_value;
+  float max_value;
+  // Set by the first scheduled event: from then on, setting the value
+  // schedules it.
+  int32_t automated;
+  // The events not reached yet, sorted by frame, in `events[first, count)`
+  // out of `capacity`.
+  tau_automation_event* events;
+  int32_t first;
+  int32_t count;
+  int32_t capacity;
+  // The last event reached, which shapes the value until the next one, and
+  // the value when a target approach started.
+  tau_automation_event current;
+  float current_value;
+} tau_param;
+
+// The timings of a `tau_profile`, written by the thread rendering what they
+// time and read from any thread. There is one writer at a time, as a node
+// renders on one thread per quantum, so relaxed loads and stores suffice.
+typedef struct tau_timings {
+  volatile int64_t count;
+  volatile int64_t total_ns;
+  volatile int64_t max_ns;
+  volatile int64_t underruns;
+  volatile int64_t buckets[TAU_PROFILE_BUCKETS];
+} tau_timings;
+
+// Records a quantum of `ns` nanoseconds in `timings`, which underruns past
+// `deadline_ns`.
+void tau_timings_record(tau_timings* timings, int64_t ns, int64_t deadline_ns);
+
+// Copies `timings` into `profile`.
+void tau_timings_read(const tau_timings* timings, int64_t deadline_ns,
+                      tau_profile* profile);
+
+// The time to pass to `tau_node_render`: the monotonic clock, or 0 when
+// profiling is compiled out.
+static inline int64_t tau_profile_now(void) {
+#if TAU_PROFILING
+  return tau_now_ns();
+#else
+  return 0;
+#endif
+}
+
+typedef struct tau_node_ops {
+  // Fills `node->output` and sets `node->output_channels` for the quantum
+  // starting at `context->frame`.
+  void (*process)(tau_context* context, tau_node* node);
+  // Releases what `node->state` refers to; the state itself belongs to the
+  // context. May be NULL.
+  void (*destroy)(tau_node* node);
+} tau_node_ops;
+
+// The part of a node the threads editing the graph own, under the control
+// lock of the context. Edits change it at once, and reach the fields the
+// rendering thread reads as commands, so it is ahead of them by the commands
+// not drained yet.
+typedef struct tau_node_control {
+  // The nodes connected to the input. `source_capacity` is also the capacity
+  // of the sources of the rendering thread once the commands are drained,
+  // and so are the bus capacities.
+  tau_node** sources;
+  int32_t source_count;
+  int32_t source_capacity;
+  tau_node* inline_sources[TAU_INLINE_SOURCES];
+  int32_t input_capacity;
+  int32_t output_capacity;
+  tau_channel_count_mode channel_count_mode;
+  int32_t channel_count;
+  // The channel count of the output, unless it follows the input.
+  int32_t output_channels;
+  // Whether the source node was started.
+  int32_t started;
+  // Scratch mark for graph traversals, compared with
+  // `context->control_epoch`.
+  int64_t mark;
+} tau_node_control;
+
+struct tau_node {
+  const tau_node_ops* ops;
+  // `TAU_MAX_NODE_STATE` zeroed bytes for the node kind.
+  void* state;
+  // The handle of the node.
+  int32_t id;
+
+  // The nodes connected to the input, in `inline_sources` until there are
+  // more than `TAU_INLINE_SOURCES`.
+  tau_node** sources;
+  int32_t source_count;
+  tau_node* inline_sources[TAU_INLINE_SOURCES];
+
+  // The input bus, mixed by the context before `process`. `input_silent` is
+  // set when every connected output was silent. Bus capacities are powers of
+  // two.
+  float* input;
+  int32_t input_channels;
+  int32_t input_silent;
+  int32_t input_capacity;
+  tau_channel_count_mode channel_count_mode;
+  tau_channel_interpretation channel_interpretation;
+  // The `channelCount` used by the clamped-max and explicit modes.
+  int32_t channel_count;
+
+  // The output bus. `output_silent` lets consumers skip a silent output.
+  float* output;
+  int32_t output_channels;
+  int32_t output_silent;
+  int32_t output_capacity;
+  // Whether the output has as many channels as the input, as for a gain,
+  // rather than a fixed count.
+  int32_t output_follows_input;
+
+  // Scheduling of source nodes, in frames. `start_frame` is -1 until started.
+  int32_t is_source;
+  int64_t start_frame;
+  int64_t stop_frame;
+
+  // The parameters, in `inline_params` unless the node reserved more than
+  // `TAU_MAX_NODE_PARAMS`.
+  tau_param* params;
+  int32_t param_count;
+  tau_param inline_params[TAU_MAX_NODE_PARAMS];
+
+  // Scratch mark for graph traversals, compared with `context->epoch`.
+  int64_t mark;
+
+  // The place of the node in the parallel schedule: its chain, the next node
+  // of the chain, and how many nodes of the render order it feeds.
+  int32_t chain;
+  int32_t consumer_count;
+  tau_node* chain_next;
+
+#if TAU_PROFILING
+  // Written by the thread rendering the node.
+  tau_timings timings;
+#endif
+
+  tau_node_control control;
+};
+
+// A run of nodes that one task renders in order. Every node after the head
+// has the previous node as its only input, and the previous node feeds
+// nothing else, so only the head waits on other chains.
+typedef struct tau_chain {
+  tau_task task;
+  tau_context* context;
+  tau_node* head;
+  tau_node* tail;
+  // The chains whose heads the tail feeds: `dependent_count` indices from
+  // `context->chain_dependents[dependents]`.
+  int32_t dependents;
+  int32_t dependent_count;
+  // The number of chains feeding the head, and how many of them have not
+  // rendered the current quantum yet.
+  int32_t dependencies;
+  volatile int32_t pending;
+} tau_chain;
+
+// Kinds of `tau_command`.
+typedef enum tau_command_type {
+  // Connects `source` to the input of `node`, in a new array of sources if
+  // `memory[0]` is set.
+  TAU_COMMAND_CONNECT,
+  TAU_COMMAND_DISCONNECT,
+  // Sets the start or stop frame of `node` to `frame`, or to the next
+  // quantum if it is already past.
+  TAU_COMMAND_START,
+  TAU_COMMAND_STOP,
+  // Removes `node`, disconnected from the nodes it fed, from the graph. The
+  // node is freed once the command is retired.
+  TAU_COMMAND_RELEASE,
+  // Sets the `channel_count` of `node` to `count`, its mode to `mode` and its
+  // interpretation to `interpretation`.
+  TAU_COMMAND_CHANNELS,
+  // Replaces the input bus of `node` with `memory[0]` and its output bus
+  // with `memory[1]`, if set, of `capacities` channels.
+  TAU_COMMAND_BUSES,
+  // Replaces the render order and the chains with `memory[0]` and
+  // `memory[1]`, sized for more node slots.
+  TAU_COMMAND_SLOTS,
+  // Replaces the chain dependents with `memory[0]`, sized for more
+  // connections.
+  TAU_COMMAND_EDGES,
+  // Replaces the pool of render threads with `memory[0]`, of `count`
+  // workers, or with none.
+  TAU_COMMAND_THREADS,
+  // Sets `param` to `event.value`, or schedules it at the next quantum once
+  // the parameter is automated.
+  TAU_COMMAND_PARAM_VALUE,
+  // Inserts `event` into the timeline of `param`, or cancels events.
+  TAU_COMMAND_AUTOMATION,
+  // Plays the buffer in `memory[0]` on the voice `count`, a voice handle, of
+  // the voice pool `node`, from `frame`, looping if `mode` is set, with the
+  // interpolation filter in `memory[1]`, the playback rate in
+  // `event.length` and the gain in `event.value`. Once applied,
+  // `memory[0]` holds the buffer the voice played before, released once the
+  // command is retired.
+  TAU_COMMAND_VOICE_PLAY,
+  // Stops the note of the voice `count` of the voice pool `node` at
+  // `frame`, unless the voice plays another note.
+  TAU_COMMAND_VOICE_STOP,
+} tau_command_type;
+
+// An edit of the graph, made by a control thread and applied by the
+// rendering thread between two quanta.
+//
+// The memory a command hands over is swapped for what it replaces, so once
+// applied and retired, the command holds what the control threads free.
+struct tau_command {
+  // Links the command in the queue, then in the retired list.
+  tau_command* next;
+  int32_t type;
+  tau_node* node;
+  tau_node* source;
+  tau_param* param;
+  double frame;
+  int32_t count;
+  int32_t mode;
+  int32_t interpretation;
+  void* memory[2];
+  int32_t capacities[2];
+  tau_automation_event event;
+  // The values of a curve.
+  float curve[];
+};
+
+struct tau_context {
+  float sample_rate;
+  int32_t channel_count;
+  int32_t destination;
+  tau_node* destination_node;
+  // The real-time duration of a quantum.
+  int64_t deadline_ns;
+
+  // Threads editing the graph hold `control_lock`, which the rendering
+  // thread never takes, and queue their edits on `commands`: the rendering
+  // thread takes the whole queue at once before every quantum. Commands it
+  // is done with go to `retired`, and what they hold is freed by the next
+  // edit, so nodes are freed off the rendering thread. Both are lists linked
+  // through their first word, so the rendering thread never waits.
+  tau_mutex control_lock;
+  void* volatile commands;
+  void* volatile retired;
+
+  // The frames delivered so far, read from any thread.
+  volatile int64_t current_frame;
+
+  // What follows, up to `frame`, belongs to the control threads.
+
+  // Nodes by slot. Released nodes leave a NULL slot, listed in `free_slots`
+  // for reuse; `generations` holds the current generation of every slot.
+  tau_node** nodes;
+  int32_t* generations;
+  int32_t* free_slots;
+  int32_t free_count;
+  int32_t node_count;
+  int32_t node_capacity;
+
+  tau_fixed_pool node_pool;
+  tau_fixed_pool state_pool;
+  tau_fixed_pool bus_pools[TAU_BUS_CLASSES];
+  // Commands, but for those carrying a curve.
+  tau_fixed_pool command_pool;
+
+  // Bumped by every traversal of the control graph.
+  int64_t control_epoch;
+
+  // The number of connections in the graph, and how many
+  // `chain_dependents` holds once the commands are drained.
+  int32_t edge_count;
+  int32_t edge_capacity;
+
+  // The number of render threads once the commands are drained.
+  int32_t render_threads;
+
+  // The `tau_resampler_quality` of the sources created next, read without
+  // the lock.
+  volatile int32_t resampler_quality;
+
+  // What follows belongs to the rendering thread.
+
+  // The first frame of the next quantum.
+  int64_t frame;
+
+  // The nodes feeding the destination, inputs first. Rebuilt before the next
+  // quantum when `order_dirty` is set.
+  tau_node** order;
+  int32_t order_count;
+  int32_t order_dirty;
+  // Bumped by every graph traversal so that marks need no reset.
+  int64_t epoch;
+
+  // With more than one render thread, the render order is partitioned into
+  // `chains` run on `pool` as their inputs become ready; the rendering thread
+  // helps until `chains_remaining` drops to 0. `chains` has room for one
+  // chain per node slot.
+  tau_pool* pool;
+  tau_chain* chains;
+  int32_t chain_count;
+  int32_t* chain_dependents;
+  volatile int32_t chains_remaining;
+
+  // How many frames of the last quantum, still in the destination output,
+  // were already delivered.
+  int32_t pending_offset;
+
+#if TAU_PROFILING
+  tau_timings timings;
+#endif
+};
+
+// Takes the control lock of `context`, and frees what the rendering thread
+// retired since the last edit.
+void tau_control_lock(tau_context* context);
+
+void tau_control_unlock(tau_context* context);
+
+// A zeroed command of `type` on `node`, with room for a curve of
+// `curve_length` values. Called with the control lock held. Returns NULL if
+// memory is exhausted.
+tau_command* tau_command_create(tau_context* context, int32_t type,
+                                tau_node* node, int32_t curve_length);
+
+// Queues `command` for the next quantum. Called with the control lock held,
+// so that commands apply in the order of the edits.
+void tau_command_post(tau_context* context, tau_command* command);
+
+// Applies the commands queued since the last quantum. Called by the
+// rendering thread before every quantum.
+void tau_command_drain(tau_context* context);
+
+// Hands `command` back to the control threads, which free it and what it
+// holds.
+void tau_command_retire(tau_context* context, tau_command* command);
+
+// Frees `command` and what it holds. Called with the control lock held.
+void tau_command_free(tau_context* context, tau_command* command);
+
+// Applies a `TAU_COMMAND_PARAM_VALUE` or `TAU_COMMAND_AUTOMATION`. Returns
+// whether the timeline keeps the command, for the curve it holds.
+int tau_automation_apply(tau_context* context, tau_command* command);
+
+// Applies a `TAU_COMMAND_VOICE_PLAY` or `TAU_COMMAND_VOICE_STOP`.
+void tau_voice_pool_apply(tau_context* context, tau_command* command);
+
+// Adds a node to the graph, with `state_size` zeroed bytes of state.
+//
+// The output has `output_channels` channels, or as many as the input if
+// `output_channels` is 0. The node stays out of the rendering until it is
+// connected, so the caller may set its state without the lock. Returns the
+// node, or NULL on failure.
+tau_node* tau_node_create(tau_context* context, const tau_node_ops* ops,
+                          size_t state_size, int32_t output_channels);
+
+// Sets how the input channel count of `node` is computed, reallocating the
+// buses of the node and of the nodes downstream as needed. Takes the control
+// lock. Returns a `tau_status`.
+int32_t tau_node_set_channels(tau_context* context, tau_node* node,
+                              int32_t channel_count,
+                              tau_channel_count_mode mode,
+                              tau_channel_interpretation interpretation);
+
+// The live node for `handle`, or NULL. Called with the control lock held.
+tau_node* tau_context_node(tau_context* context, int32_t handle);
+
+// Frees a node released from the graph, and a bus of `capacity` channels.
+// Called with the control lock held.
+void tau_node_free(tau_context* context, tau_node* node);
+void tau_bus_free(tau_context* context, float* bus, int32_t capacity);
+
+// Makes room for `count` parameters in `node`, which has none yet, when
+// that is more than `TAU_MAX_NODE_PARAMS`. Returns 0 if out of memory.
+int tau_node_reserve_params(tau_node* node, int32_t count);
+
+// Declares a parameter of `node` with its default value and range.
+void tau_node_add_param(tau_node* node, int32_t id, float value,
+                        float min_value, float max_value);
+
+// The parameter `id` of `node`, or NULL.
+tau_param* tau_node_param(tau_node* node, int32_t id);
+
+// Evaluates `param`, an a-rate parameter, over the current quantum. Returns
+// NULL if its value is constant over the quantum, with the value in
+// `param->value`, and otherwise `TAU_QUANTUM` values in scratch memory of the
+// quantum.
+const float* tau_param_render(tau_context* context, tau_param* param);
+
+// Evaluates `param`, a k-rate parameter, at the start of the current quantum.
+float tau_param_render_k(tau_context* context, tau_param* param);
+
+// Frees the timeline of `param`, of a node being freed.
+void tau_param_destroy(tau_context* context, tau_param* param);
+
+// The frames of the current quantum during which a source node plays, as
+// offsets into the quantum. Returns 0 if it is silent for the whole quantum.
+int tau_node_active_range(tau_context* context, tau_node* node,
+                          int32_t* start, int32_t* end);
+
+// Mixes the input of `node` and processes it, from `start`, a time of
+// `tau_profile_now`. Returns the time it ended, so that nodes rendered one
+// after the other read the clock once each.
+int64_t tau_node_render(tau_context* context, tau_node* node, int64_t start);
+
+// Partitions `context->order` into chains.
+void tau_schedule_update(tau_context* context);
+
+// Renders one quantum of `context->order` on the pool of the context.
+void tau_schedule_run(tau_context* context);
+
+// Zeroes the output of `node` and marks it silent.
+void tau_node_output_silence(tau_node* node, int32_t channels);
+
+// Mixes `source`, of `source_channels` planar channels of one quantum, into
+// `destination` of `destination_channels`, following `interpretation`. The
+// result replaces `destination` unless `accumulate` is set. Speakers mix by
+// the Web Audio rules between 1, 2, 4 and 6 channels, and discretely between
+// other counts.
+void tau_bus_mix(float* destination, int32_t destination_channels,
+                 const float* source, int32_t source_channels,
+                 tau_channel_interpretation interpretation, int accumulate);
+
+// `tau_bus_mix` without the versions specialized for the usual channel
+// counts, for comparison.
+void tau_bus_mix_generic(float* destination, int32_t destination_channels,
+                         const float* source, int32_t source_channels,
+                         tau_channel_interpretation interpretation,
+                         int accumulate);
+
+#endif  // TAU_ENGINE_H_
@@ -1,4 +1,6 @@
 #include "tau_ffi.h"
+#include "tau_dart.h"
+#include "tau_pool.h"
 
 // A very short-lived native function.
 //
@@ -21,3 +23,38 @@ FFI_PLUGIN_EXPORT int sum_long_running(int a, int b) {
 #endif
   return a + b;
 }
+
+typedef struct sum_job {
+  tau_task task;
+  int64_t port;
+  int64_t request_id;
+  int a;
+  int b;
+} sum_job;
+
+static void run_sum_job(tau_task* task) {
+  sum_job* job = (sum_job*)task;
+  tau_dart_post_pair(job->port, job->request_id,
+                     sum_long_running(job->a, job->b));
+  free(job);
+}
+
+FFI_PLUGIN_EXPORT int sum_async(int64_t port, int64_t request_id, int a,
+                                int b) {
+  if (!tau_dart_can_post()) {
+    return TAU_ERROR_NOT_INITIALIZED;
+  }
+  tau_pool* pool = tau_pool_shared();
+  sum_job* job = (sum_job*)malloc(sizeof(sum_job));
+  if (pool == NULL || job == NULL) {
+    free(job);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  job->task.run = run_sum_job;
+  job->port = port;
+  job->request_id = request_id;
+  job->a = a;
+  job->b = b;
+  tau_pool_submit(pool, &job->task);
+  return TAU_OK;
+}
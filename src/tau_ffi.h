@@ -1,3 +1,6 @@
+#ifndef TAU_FFI_H_
+#define TAU_FFI_H_
+
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -28,3 +31,1082 @@ FFI_PLUGIN_EXPORT int sum(int a, int b);
 // block Dart execution. This will cause dropped frames in Flutter applications.
 // Instead, call these native functions on a separate isolate.
 FFI_PLUGIN_EXPORT int sum_long_running(int a, int b);
+
+// Status codes returned by the functions that can fail.
+enum tau_status {
+  TAU_OK = 0,
+  TAU_ERROR_INVALID_ARGUMENT = -1,
+  TAU_ERROR_OUT_OF_MEMORY = -2,
+  // `tau_async_init` has not been called.
+  TAU_ERROR_NOT_INITIALIZED = -3,
+  // The call is not allowed in the current state, such as starting a source
+  // node twice.
+  TAU_ERROR_INVALID_STATE = -4,
+  // The graph does not support the request, such as a connection that would
+  // create a cycle.
+  TAU_ERROR_NOT_SUPPORTED = -5,
+  // A file could not be read, or its contents are malformed.
+  TAU_ERROR_IO = -6,
+};
+
+// Registers the function native workers use to post results back to Dart.
+//
+// `post_cobject` is `NativeApi.postCObject`. This must be called before the
+// first asynchronous function, such as `sum_async`.
+FFI_PLUGIN_EXPORT void tau_async_init(void* post_cobject);
+
+// Queues `sum_long_running(a, b)` on the native worker pool.
+//
+// This returns immediately, so it can be called on the main isolate. Requests
+// run concurrently on a pool of native threads sized to the number of cores.
+// When a request completes, the list `[request_id, result]` is posted to the
+// Dart port `port`.
+//
+// Returns `TAU_OK`, or a negative `tau_status` if the request was not queued.
+FFI_PLUGIN_EXPORT int sum_async(int64_t port, int64_t request_id, int a, int b);
+
+// Operations understood by `tau_batch_execute`.
+enum tau_opcode {
+  // `results[i] = a[i] + b[i]`, the batched form of `sum`.
+  TAU_OP_SUM = 0,
+  // `results[i] = a[i] - b[i]`.
+  TAU_OP_SUBTRACT = 1,
+  // `results[i] = a[i] * b[i]`.
+  TAU_OP_MULTIPLY = 2,
+  // `results[i] = sum_long_running(a[i], b[i])`. Only accepted in a
+  // `tau_ring`: `tau_batch_execute` must stay short-lived.
+  TAU_OP_SUM_LONG_RUNNING = 3,
+};
+
+// A native-owned command buffer executed by `tau_batch_execute`.
+//
+// Commands are stored as a struct of arrays: command `i` applies `opcodes[i]`
+// to `a[i]` and `b[i]` and writes its result to `results[i]`. Every array holds
+// `capacity` elements and keeps its address for the lifetime of the batch, so
+// Dart can view them once with `asTypedList` and fill them without any further
+// native call.
+typedef struct tau_batch {
+  int32_t* opcodes;
+  int32_t* a;
+  int32_t* b;
+  int32_t* results;
+  // The number of elements in each array.
+  int32_t capacity;
+  // The number of commands to run on the next `tau_batch_execute`.
+  int32_t count;
+} tau_batch;
+
+// Allocates a batch able to hold `capacity` commands.
+//
+// Returns NULL if `capacity` is not positive or memory is exhausted. The batch
+// must be released with `tau_batch_destroy`.
+FFI_PLUGIN_EXPORT tau_batch* tau_batch_create(int32_t capacity);
+
+// Releases a batch allocated by `tau_batch_create`.
+FFI_PLUGIN_EXPORT void tau_batch_destroy(tau_batch* batch);
+
+// Runs the first `count` commands of `batch` in a single native call.
+//
+// This is a short-lived function: it only does arithmetic, so it is fine to
+// call it on the main isolate. Thousands of small operations then cost one
+// Dart to native transition instead of one each.
+//
+// Returns the number of commands executed. Execution stops at the first
+// unknown opcode, so a return value lower than `count` is the index of the
+// offending command.
+FFI_PLUGIN_EXPORT int32_t tau_batch_execute(tau_batch* batch);
+
+// A fixed-size request record in a `tau_ring`.
+typedef struct tau_ring_request {
+  // One of `tau_opcode`.
+  int32_t opcode;
+  int32_t a;
+  int32_t b;
+  int32_t reserved;
+} tau_ring_request;
+
+// A completion record in a `tau_ring`.
+typedef struct tau_ring_completion {
+  // The position at which the request was written, counting from 0.
+  int64_t sequence;
+  int32_t result;
+  // `TAU_OK`, or `TAU_ERROR_INVALID_ARGUMENT` for an unknown opcode.
+  int32_t status;
+} tau_ring_completion;
+
+// A pair of shared-memory rings carrying requests from Dart to the native
+// worker pool, and their results back.
+//
+// Requests are written in order directly into `tau_ring_requests`, request
+// number `n` going to slot `n % capacity`, and published with
+// `tau_ring_submit`. Workers claim them concurrently and publish each result
+// into `tau_ring_completions` as soon as it is ready, so completions arrive out
+// of order. They are consumed with `tau_ring_poll` and `tau_ring_release`.
+//
+// No memory is allocated and no message is sent per request: the ring only
+// posts to its Dart port when a completion arrives while the consumer is not
+// already due to poll.
+typedef struct tau_ring tau_ring;
+
+// Creates a ring for `capacity` requests in flight, rounded up to a power of
+// two.
+//
+// `port` is notified with an integer message when completions are ready to be
+// polled, or 0 to rely on polling alone. Notifications need `tau_async_init`.
+// Returns NULL on failure.
+FFI_PLUGIN_EXPORT tau_ring* tau_ring_create(int32_t capacity, int64_t port);
+
+// Releases the ring. Requests still running finish in the background, but
+// their results are dropped.
+FFI_PLUGIN_EXPORT void tau_ring_destroy(tau_ring* ring);
+
+// The number of slots in each of the rings.
+FFI_PLUGIN_EXPORT int32_t tau_ring_capacity(tau_ring* ring);
+
+// The request slots, `tau_ring_capacity` of them.
+FFI_PLUGIN_EXPORT tau_ring_request* tau_ring_requests(tau_ring* ring);
+
+// The completion slots, `tau_ring_capacity` of them.
+FFI_PLUGIN_EXPORT tau_ring_completion* tau_ring_completions(tau_ring* ring);
+
+// Publishes every request written before position `end`.
+//
+// The request at position `n` goes in slot `n % capacity`, and may only be
+// written once the result of the request `capacity` positions older, which
+// used the slot before, has been released. Requests complete out of order, so
+// having released `capacity` results is not enough. Returns `TAU_OK`, or
+// `TAU_ERROR_INVALID_ARGUMENT` if `end` breaks that rule or moves backwards.
+FFI_PLUGIN_EXPORT int32_t tau_ring_submit(tau_ring* ring, int64_t end);
+
+// The number of completions ready to be read, starting at the oldest one not
+// yet released.
+//
+// Completion number `n` is in slot `n % capacity`. Polling also re-arms the
+// port notification.
+FFI_PLUGIN_EXPORT int32_t tau_ring_poll(tau_ring* ring);
+
+// Frees the `count` oldest completions after they have been read.
+FFI_PLUGIN_EXPORT void tau_ring_release(tau_ring* ring, int32_t count);
+
+// The number of heap allocations the audio engine made since the library was
+// loaded. Once a graph has reached its working size, rendering it makes none:
+// nodes and buses come from pools, and per-quantum scratch memory from an
+// arena.
+FFI_PLUGIN_EXPORT int64_t tau_memory_allocations(void);
+
+// The number of heap blocks the audio engine freed since the library was
+// loaded.
+FFI_PLUGIN_EXPORT int64_t tau_memory_frees(void);
+
+// The bytes the audio engine currently holds on the heap.
+FFI_PLUGIN_EXPORT int64_t tau_memory_bytes_in_use(void);
+
+// `size` bytes of native memory from the engine allocator, or NULL, for
+// arguments that Dart passes by pointer such as file paths. Freed with
+// `tau_memory_release`.
+FFI_PLUGIN_EXPORT void* tau_memory_allocate(int64_t size);
+
+FFI_PLUGIN_EXPORT void tau_memory_release(void* memory);
+
+// The alignment of every channel of a `tau_audio_buffer`, in bytes.
+#define TAU_AUDIO_BUFFER_ALIGNMENT 64
+
+// Planar audio samples shared between Dart and native code without copies.
+//
+// Channel `c` holds `frames` samples starting at `data + c * stride`; each
+// channel starts on a `TAU_AUDIO_BUFFER_ALIGNMENT` boundary. Dart views the
+// channels with `asTypedList`, and render nodes read and write the same
+// memory.
+//
+// A buffer is reference counted: every owner, such as a Dart view or a buffer
+// source node, holds a reference taken with `tau_audio_buffer_retain` and
+// gives it back with `tau_audio_buffer_release`. The fields are read-only.
+typedef struct tau_audio_buffer {
+  float* data;
+  int32_t channels;
+  int32_t frames;
+  // The distance between the starts of two channels, in samples.
+  int32_t stride;
+  float sample_rate;
+  // The number of references. Only changed by retain and release.
+  int32_t references;
+  // The size of the file mapping holding the samples of a buffer loaded from
+  // a `tau_cache`, or 0 if they are on the heap.
+  int64_t mapped_bytes;
+} tau_audio_buffer;
+
+// Allocates a silent buffer of `channels` channels of `frames` frames at
+// `sample_rate`, holding one reference.
+//
+// Returns NULL if an argument is out of range or memory is exhausted.
+FFI_PLUGIN_EXPORT tau_audio_buffer* tau_audio_buffer_create(int32_t channels,
+                                                            int32_t frames,
+                                                            float sample_rate);
+
+// Takes a reference to `buffer`, which may be used from any thread.
+FFI_PLUGIN_EXPORT void tau_audio_buffer_retain(tau_audio_buffer* buffer);
+
+// Gives back a reference to `buffer`, freeing it with the last one. Usable as
+// a Dart `NativeFinalizer` or `asTypedList` finalizer.
+FFI_PLUGIN_EXPORT void tau_audio_buffer_release(tau_audio_buffer* buffer);
+
+// The number of frames the render graph processes at a time.
+#define TAU_RENDER_QUANTUM_FRAMES 128
+
+// The maximum number of channels of a node input or output.
+#define TAU_MAX_CHANNELS 32
+
+// An audio render graph: the native counterpart of a Web Audio
+// `BaseAudioContext`.
+//
+// Nodes are identified by non-negative integer handles returned by the
+// `tau_*_create` functions. The graph may be edited from any number of
+// threads, including while another thread runs `tau_context_render`: edits
+// are queued for the rendering thread, which applies them before the next
+// quantum without ever waiting for an editing thread. Rendering itself must
+// stay on one thread at a time.
+typedef struct tau_context tau_context;
+
+// Creates a context producing `channels` output channels at `sample_rate`.
+// Returns NULL on failure.
+FFI_PLUGIN_EXPORT tau_context* tau_context_create(int32_t channels,
+                                                  float sample_rate);
+
+// Releases a context and every node in it.
+FFI_PLUGIN_EXPORT void tau_context_destroy(tau_context* context);
+
+// The sample rate of the context.
+FFI_PLUGIN_EXPORT float tau_context_sample_rate(tau_context* context);
+
+// The time of the next frame to render, in seconds.
+FFI_PLUGIN_EXPORT double tau_context_current_time(tau_context* context);
+
+// The handle of the node whose input is the output of the context.
+FFI_PLUGIN_EXPORT int32_t tau_context_destination(tau_context* context);
+
+// Renders the graph on `threads` threads, or one per processor if `threads`
+// is not positive. The default is 1.
+//
+// With more than one thread, independent branches of the graph, such as
+// separate voices, render in parallel on a worker pool owned by the context,
+// and the thread calling `tau_context_render` takes part.
+FFI_PLUGIN_EXPORT int32_t tau_context_set_render_threads(tau_context* context,
+                                                         int32_t threads);
+
+// Renders the next `frames` frames of the graph into `output`, as fast as the
+// processor allows.
+//
+// `output` is planar: channel `c` occupies `output[c * frames]` to
+// `output[(c + 1) * frames - 1]`. Any number of frames may be requested; the
+// graph itself always advances by `TAU_RENDER_QUANTUM_FRAMES`.
+//
+// Returns the number of frames rendered, or a negative `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_context_render(tau_context* context,
+                                             float* output, int32_t frames);
+
+// Renders the next `buffer->frames` frames of the graph straight into
+// `buffer`, which must have as many channels as the context.
+//
+// This is the `OfflineAudioContext.startRendering` of the engine. Returns the
+// number of frames rendered, or a negative `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_context_render_buffer(tau_context* context,
+                                                    tau_audio_buffer* buffer);
+
+// The number of buckets of a `tau_profile` histogram.
+#define TAU_PROFILE_BUCKETS 32
+
+// How long the rendering of a context or of one of its nodes took, quantum
+// by quantum, since it was created.
+//
+// Bucket `i` counts the quanta that took from 2^i to 2^(i + 1) nanoseconds;
+// the first also counts shorter ones, and the last longer ones. The deadline
+// is the real-time duration of a quantum: a context missing it underruns a
+// sound device, and a node missing it is the reason.
+//
+// The rendering thread records the timings without waiting or allocating,
+// unless the library is built with `TAU_FFI_PROFILING` off. A snapshot read
+// while rendering may be a quantum behind in some fields.
+typedef struct tau_profile {
+  // The quanta rendered, and their total and longest durations.
+  int64_t count;
+  int64_t total_ns;
+  int64_t max_ns;
+  int64_t buckets[TAU_PROFILE_BUCKETS];
+  // The duration of a quantum at the sample rate, and the number of quanta
+  // that took longer.
+  int64_t deadline_ns;
+  int64_t underruns;
+} tau_profile;
+
+// Copies the timings of the quanta of `context`, each from applying the
+// queued edits to rendering the last node, into `profile`.
+//
+// Returns a `tau_status`: `TAU_ERROR_NOT_SUPPORTED` if profiling was
+// compiled out.
+FFI_PLUGIN_EXPORT int32_t tau_context_get_profile(tau_context* context,
+                                                  tau_profile* profile);
+
+// Waveforms of `tau_oscillator_create`.
+enum tau_oscillator_type {
+  TAU_OSCILLATOR_SINE = 0,
+  TAU_OSCILLATOR_SQUARE = 1,
+  TAU_OSCILLATOR_SAWTOOTH = 2,
+  TAU_OSCILLATOR_TRIANGLE = 3,
+};
+
+// Automatable parameters of the nodes.
+enum tau_param_id {
+  // Gain of a gain node, or of a biquad filter band in decibels.
+  TAU_PARAM_GAIN = 0,
+  // Frequency of an oscillator or of a biquad filter band, in hertz.
+  TAU_PARAM_FREQUENCY = 1,
+  // Detune of an oscillator, a buffer source or a biquad filter band, in
+  // cents.
+  TAU_PARAM_DETUNE = 2,
+  // Playback rate of a buffer source.
+  TAU_PARAM_PLAYBACK_RATE = 3,
+  // Quality factor of a biquad filter band.
+  TAU_PARAM_Q = 4,
+  // Parameters of a compressor: the level compression starts from, in
+  // decibels, the width of the knee centred on it, in decibels, the ratio
+  // of the input level over the threshold to the output level over it, and
+  // the attack and release times, in seconds. They are k-rate.
+  TAU_PARAM_THRESHOLD = 5,
+  TAU_PARAM_KNEE = 6,
+  TAU_PARAM_RATIO = 7,
+  TAU_PARAM_ATTACK = 8,
+  TAU_PARAM_RELEASE = 9,
+  // Position of a panner relative to the listener, who stands at the origin
+  // facing -z with +y up, as in Web Audio. They are k-rate.
+  TAU_PARAM_POSITION_X = 10,
+  TAU_PARAM_POSITION_Y = 11,
+  TAU_PARAM_POSITION_Z = 12,
+};
+
+// Quality tiers of the sample-rate conversion of sources, from the cheapest.
+enum tau_resampler_quality {
+  // Linear interpolation between neighbouring samples, as Web Audio
+  // implementations do. Aliases audibly.
+  TAU_RESAMPLER_LINEAR = 0,
+  // Polyphase windowed-sinc filters of 16, 32 and 64 taps when converting
+  // up, attenuating what the output rate cannot represent by 60, 90 and
+  // 120 dB.
+  TAU_RESAMPLER_LOW = 1,
+  TAU_RESAMPLER_MEDIUM = 2,
+  TAU_RESAMPLER_HIGH = 3,
+};
+
+// Sets the quality of the sample-rate conversion of the buffer and stream
+// sources created afterwards in `context`, one of `tau_resampler_quality`.
+// The default is `TAU_RESAMPLER_MEDIUM`. Returns a `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_context_set_resampler_quality(
+    tau_context* context, int32_t quality);
+
+// Creates an oscillator of `type`, one of `tau_oscillator_type`, at
+// `frequency` hertz.
+//
+// Returns the node handle, or a negative `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_oscillator_create(tau_context* context,
+                                                int32_t type, float frequency);
+
+// Creates a gain node multiplying its input by `gain`.
+//
+// Returns the node handle, or a negative `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_gain_create(tau_context* context, float gain);
+
+// Creates a source playing `buffer`, looping over it if `loop` is not 0.
+//
+// The source takes a reference to `buffer` and reads its samples in place, so
+// they may still be written until the source starts.
+//
+// Returns the node handle, or a negative `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_buffer_source_create(tau_context* context,
+                                                   tau_audio_buffer* buffer,
+                                                   int32_t loop);
+
+// The most voices of a voice pool, `1 << TAU_VOICE_INDEX_BITS`: voice
+// handles keep the voice in their low `TAU_VOICE_INDEX_BITS` bits.
+#define TAU_VOICE_INDEX_BITS 10
+#define TAU_MAX_VOICES 1024
+
+// Counters of a voice pool.
+typedef struct tau_voice_pool_stats {
+  int32_t voices;
+  // The voices playing or scheduled to.
+  int32_t playing;
+  // The notes played since the pool was created, and how many of them cut
+  // off the oldest note because every voice was playing.
+  int64_t notes;
+  int64_t steals;
+} tau_voice_pool_stats;
+
+// Creates a voice pool: a source of `channels` channels playing buffers on
+// `voices` voices, from 1 to `TAU_MAX_VOICES`, and mixing them, for
+// instruments and games playing many short notes.
+//
+// A note takes a free voice of the pool, or the one playing the oldest note,
+// rather than a node of its own: playing it neither allocates memory nor
+// changes the graph, so the render order is not rebuilt either. Voices play
+// buffers as buffer sources do, mixed to `channels` channels.
+//
+// Returns the node handle, or a negative `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_voice_pool_create(tau_context* context,
+                                                int32_t voices,
+                                                int32_t channels);
+
+// Plays `buffer` once, or looping over it if `loop` is not 0, on a voice of
+// the pool `node` from `when` seconds, at `playback_rate` times its speed
+// and scaled by `gain`.
+//
+// The voice takes a reference to `buffer`, which it gives back once it plays
+// another note. Returns the handle of the voice playing the note, which
+// changes with every note, or a negative `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_voice_pool_play(tau_context* context,
+                                              int32_t node,
+                                              tau_audio_buffer* buffer,
+                                              double when, int32_t loop,
+                                              float playback_rate,
+                                              float gain);
+
+// Stops the note of `voice`, a handle from `tau_voice_pool_play`, at `when`
+// seconds. Does nothing once the voice plays another note. Returns a
+// `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_voice_pool_stop(tau_context* context,
+                                              int32_t node, int32_t voice,
+                                              double when);
+
+// Copies the counters of the pool `node` into `stats`. Returns a
+// `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_voice_pool_get_stats(
+    tau_context* context, int32_t node, tau_voice_pool_stats* stats);
+
+// Creates a convolver applying the impulse response in `impulse`, which must
+// have the sample rate of the context, as a reverb does. If `normalize` is
+// not 0, the response is scaled to a standard power first, as the Web Audio
+// `ConvolverNode` does.
+//
+// Every channel of the input is convolved with the same channel of
+// `impulse`; the input is mixed to as many channels. The convolution is
+// computed with FFTs, so impulse responses of several seconds are cheap, and
+// adds no latency. The response is copied: `impulse` may be released.
+//
+// Returns the node handle, or a negative `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_convolver_create(tau_context* context,
+                                               tau_audio_buffer* impulse,
+                                               int32_t normalize);
+
+// Filter types of `tau_biquad_filter_create`, as the Web Audio
+// `BiquadFilterType`.
+enum tau_biquad_type {
+  TAU_BIQUAD_LOWPASS = 0,
+  TAU_BIQUAD_HIGHPASS = 1,
+  TAU_BIQUAD_BANDPASS = 2,
+  TAU_BIQUAD_LOWSHELF = 3,
+  TAU_BIQUAD_HIGHSHELF = 4,
+  TAU_BIQUAD_PEAKING = 5,
+  TAU_BIQUAD_NOTCH = 6,
+  TAU_BIQUAD_ALLPASS = 7,
+};
+
+// The most bands of a biquad filter.
+#define TAU_BIQUAD_MAX_BANDS 32
+
+// The parameter `id` of band `band` of a biquad filter is
+// `id + band * TAU_BIQUAD_BAND_STRIDE`, so band 0 has the plain ids.
+#define TAU_BIQUAD_BAND_STRIDE 256
+
+// Creates a filter of `bands` biquad sections of type `type` in series, from
+// 1 to `TAU_BIQUAD_MAX_BANDS`, such as the bands of an equalizer. With one
+// band, it is the Web Audio `BiquadFilterNode`. Each band has its own type
+// and its own `TAU_PARAM_FREQUENCY` (350 Hz), `TAU_PARAM_DETUNE` (0),
+// `TAU_PARAM_Q` (1) and `TAU_PARAM_GAIN` (0 dB), all sample-accurate.
+//
+// Every band of every channel is filtered side by side with the others in
+// vector registers, and the coefficients of a band are only computed again
+// when its type or parameters change. The output has as many channels as the
+// input.
+//
+// Returns the node handle, or a negative `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_biquad_filter_create(tau_context* context,
+                                                   int32_t type,
+                                                   int32_t bands);
+
+// Sets the type of band `band` of the biquad filter `node` to `type`, from
+// the next quantum. Returns a `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_biquad_filter_set_type(tau_context* context,
+                                                     int32_t node,
+                                                     int32_t band,
+                                                     int32_t type);
+
+// Creates a compressor, as the Web Audio `DynamicsCompressorNode`, with its
+// `TAU_PARAM_THRESHOLD` (-24 dB), `TAU_PARAM_KNEE` (30 dB),
+// `TAU_PARAM_RATIO` (12), `TAU_PARAM_ATTACK` (0.003 s) and
+// `TAU_PARAM_RELEASE` (0.25 s). The output has as many channels as the
+// input, and is delayed by a lookahead of 6 ms, so that the gain has come
+// down when a peak comes through.
+//
+// The level of the loudest channel goes through the gain curve with vector
+// kernels, and the gain follows it every 32 frames, ramping in between.
+//
+// Returns the node handle, or a negative `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_compressor_create(tau_context* context);
+
+// The gain reduction of the compressor `node` at the end of the last quantum
+// rendered, in decibels, as the `reduction` of Web Audio, or NaN if `node`
+// is not a compressor.
+FFI_PLUGIN_EXPORT float tau_compressor_reduction(tau_context* context,
+                                                 int32_t node);
+
+// The longest head-related impulse response of a `tau_hrtf`, in frames.
+#define TAU_HRTF_MAX_FRAMES 512
+
+// Head-related impulse responses for the HRTF panning of
+// `tau_panner_create`, shared by any number of panners in any contexts of
+// its sample rate.
+//
+// The responses are kept as spectra, ready to be convolved. Panners look
+// them up by cell of 2 degrees of azimuth and elevation: the responses of a
+// cell are interpolated from the three nearest measurements the first time
+// a panner points into it, then kept in a cache that every panner reads
+// without locking. Once the cache is full, a panner entering a cell not in
+// it interpolates the responses for itself. It is reference counted like
+// `tau_audio_buffer`.
+typedef struct tau_hrtf tau_hrtf;
+
+// Creates a set of `count` pairs of responses of `frames` frames at
+// `sample_rate`. `left` and `right` hold the responses of each ear one
+// after the other, measured from the directions of `azimuths` and
+// `elevations`, in degrees. Azimuths go clockwise from the front, 90 being
+// on the right, as the azimuth of Web Audio, and elevations up from the
+// horizontal plane. The arrays are copied.
+//
+// Returns the set, holding one reference, or NULL if an argument is out of
+// range or memory is exhausted.
+FFI_PLUGIN_EXPORT tau_hrtf* tau_hrtf_create(const float* left,
+                                            const float* right,
+                                            const float* azimuths,
+                                            const float* elevations,
+                                            int32_t count, int32_t frames,
+                                            float sample_rate);
+
+FFI_PLUGIN_EXPORT void tau_hrtf_retain(tau_hrtf* hrtf);
+
+// Gives back a reference to `hrtf`, freeing it with the last one.
+FFI_PLUGIN_EXPORT void tau_hrtf_release(tau_hrtf* hrtf);
+
+// The number of cells whose interpolated responses are cached.
+FFI_PLUGIN_EXPORT int32_t tau_hrtf_cached_cells(tau_hrtf* hrtf);
+
+// Creates a panner, as the Web Audio `PannerNode`, placing its input,
+// down-mixed to mono, at `TAU_PARAM_POSITION_X`, `TAU_PARAM_POSITION_Y` and
+// `TAU_PARAM_POSITION_Z` (0) around the listener, in stereo.
+//
+// With `hrtf`, the panning model is `HRTF`: the input is convolved with the
+// responses of its direction by FFT, which adds no latency. A source staying
+// in its cell costs the convolution alone; one moving to another cell
+// crossfades from the old responses to the new over a quantum. Without, the
+// model is `equalpower`. The panner takes a reference to `hrtf`, whose
+// sample rate must be that of the context.
+//
+// The source is omnidirectional, and its gain follows the inverse distance
+// model of Web Audio with the default reference distance and rolloff
+// factor, of 1.
+//
+// Returns the node handle, or a negative `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_panner_create(tau_context* context,
+                                            tau_hrtf* hrtf);
+
+// The thread processing the blocks of worklet nodes, such as a Dart isolate
+// running `AudioWorkletProcessor`s, and the queue between it and the
+// rendering threads.
+//
+// Each worklet node owns a few blocks of shared memory, which it fills with
+// its input and queues here one quantum ahead of the output it needs back,
+// or more. The processing thread takes the blocks with
+// `tau_worklet_host_wait`, writes their output in place and hands them back
+// with `tau_worklet_host_complete`. Nothing is copied or allocated on the
+// way, and the rendering thread never waits for the processing thread,
+// unless the node was created blocking: it only wakes it through a
+// semaphore, and a block not back in time is an underrun of the node.
+//
+// The host has one reference for its owner, and one per worklet node.
+typedef struct tau_worklet_host tau_worklet_host;
+
+// A quantum of a worklet node for the processing thread: planar channels of
+// `TAU_RENDER_QUANTUM_FRAMES` samples. `key` is the one the node was created
+// with, and `frame` the context frame the input starts at.
+typedef struct tau_worklet_block {
+  int64_t key;
+  int64_t frame;
+  float* input;
+  float* output;
+  int32_t input_channels;
+  int32_t output_channels;
+} tau_worklet_block;
+
+// The longest latency of a worklet node, in quanta.
+#define TAU_WORKLET_MAX_LATENCY 16
+
+// Creates a host queueing up to `capacity` blocks at once, which bounds the
+// blocks its worklet nodes can own together: a node of a latency of `n`
+// quanta owns `n + 2`. Returns the host, or NULL.
+FFI_PLUGIN_EXPORT tau_worklet_host* tau_worklet_host_create(int32_t capacity);
+
+// Waits up to `timeout_ms` milliseconds, or forever if negative, for a block
+// to process. Only the processing thread calls it. Returns the block, or
+// NULL on timeout or once the host is closed.
+FFI_PLUGIN_EXPORT tau_worklet_block* tau_worklet_host_wait(
+    tau_worklet_host* host, int32_t timeout_ms);
+
+// Hands back a processed block taken by `tau_worklet_host_wait`.
+FFI_PLUGIN_EXPORT void tau_worklet_host_complete(tau_worklet_host* host,
+                                                 tau_worklet_block* block);
+
+// Whether `host` is closed.
+FFI_PLUGIN_EXPORT int32_t tau_worklet_host_closed(tau_worklet_host* host);
+
+// Closes `host`, from any thread: its worklet nodes output silence from then
+// on, and `tau_worklet_host_wait` returns NULL.
+FFI_PLUGIN_EXPORT void tau_worklet_host_close(tau_worklet_host* host);
+
+// Closes `host`, hands back the blocks still queued with silence, and gives
+// back the reference of the owner. Called by the processing thread once it
+// stops waiting.
+FFI_PLUGIN_EXPORT void tau_worklet_host_release(tau_worklet_host* host);
+
+// Creates a worklet node, as the Web Audio `AudioWorkletNode`, whose
+// quanta `host` processes. The input has `input_channels` channels,
+// mixed as an explicit channel count, and the output `output_channels`,
+// from 1 to `TAU_MAX_CHANNELS`.
+//
+// The output lags the input by `latency` quanta, from 1 to
+// `TAU_WORKLET_MAX_LATENCY`: the time the processing thread has for each
+// block. In real time, a block still out after it outputs silence; with
+// `blocking`, for offline rendering, the rendering thread waits for it
+// instead.
+//
+// Returns the node handle, or a negative `tau_status`:
+// `TAU_ERROR_INVALID_STATE` if `host` is closed or has no room for the
+// blocks of the node.
+FFI_PLUGIN_EXPORT int32_t tau_worklet_create(tau_context* context,
+                                             tau_worklet_host* host,
+                                             int64_t key,
+                                             int32_t input_channels,
+                                             int32_t output_channels,
+                                             int32_t latency,
+                                             int32_t blocking);
+
+// The quanta the worklet `node` output as silence because their block was
+// not back in time, or a negative `tau_status`.
+FFI_PLUGIN_EXPORT int64_t tau_worklet_underruns(tau_context* context,
+                                                int32_t node);
+
+// The range of the `fft_size` of `tau_analyser_create`.
+#define TAU_ANALYSER_MIN_FFT_SIZE 32
+#define TAU_ANALYSER_MAX_FFT_SIZE 32768
+
+// Creates an analyser, which passes its input through and keeps its last
+// `fft_size` frames, down-mixed to mono, for the
+// `tau_analyser_get_float_*_data` functions, as the Web Audio `AnalyserNode`
+// does. `fft_size` is a power of two from `TAU_ANALYSER_MIN_FFT_SIZE` to
+// `TAU_ANALYSER_MAX_FFT_SIZE`. Like every node, the analyser only renders
+// while its output reaches the destination.
+//
+// The rendering thread only copies each quantum into a ring, without
+// waiting: the spectrum is computed by the thread asking for it, which
+// holds a lock of the analyser meanwhile rather than of the context.
+//
+// Returns the node handle, or a negative `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_analyser_create(tau_context* context,
+                                              int32_t fft_size);
+
+// Sets how much of the previous spectrum every new one keeps, from 0 to 1,
+// as the `smoothingTimeConstant` of Web Audio. The default is 0.8.
+FFI_PLUGIN_EXPORT int32_t tau_analyser_set_smoothing(tau_context* context,
+                                                     int32_t node,
+                                                     float smoothing);
+
+// The buffers the analyser `node` writes its results to: one channel of
+// `fft_size / 2` frames, the spectrum in decibels, and one of `fft_size`
+// frames, the last frames of the input.
+//
+// Returns a new reference to the buffer, to give back with
+// `tau_audio_buffer_release`, or NULL if `node` is not an analyser.
+FFI_PLUGIN_EXPORT tau_audio_buffer* tau_analyser_frequency_buffer(
+    tau_context* context, int32_t node);
+FFI_PLUGIN_EXPORT tau_audio_buffer* tau_analyser_time_domain_buffer(
+    tau_context* context, int32_t node);
+
+// Writes the spectrum of the last `fft_size` frames of the analyser `node`
+// to its frequency buffer: the magnitudes of the Blackman-windowed frames,
+// smoothed with the previous spectrum, in decibels. Frames not rendered yet
+// count as silence.
+//
+// The spectrum is only computed again once frames were rendered since the
+// last call, so polling a paused context is free and smooths nothing. Calls
+// on the same analyser must not overlap. Returns a `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_analyser_get_float_frequency_data(
+    tau_context* context, int32_t node);
+
+// Writes the last `fft_size` frames of the analyser `node` to its time
+// domain buffer. Calls on the same analyser must not overlap. Returns a
+// `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_analyser_get_float_time_domain_data(
+    tau_context* context, int32_t node);
+
+// Connects the output of `source` to the input of `destination`.
+//
+// Returns `TAU_OK`, or `TAU_ERROR_NOT_SUPPORTED` if the connection would
+// create a cycle.
+FFI_PLUGIN_EXPORT int32_t tau_node_connect(tau_context* context,
+                                           int32_t source,
+                                           int32_t destination);
+
+// Removes the connection from `source` to `destination`.
+FFI_PLUGIN_EXPORT int32_t tau_node_disconnect(tau_context* context,
+                                              int32_t source,
+                                              int32_t destination);
+
+// Starts a source node at `when` seconds, in context time.
+FFI_PLUGIN_EXPORT int32_t tau_node_start(tau_context* context, int32_t node,
+                                         double when);
+
+// Stops a source node at `when` seconds, in context time.
+FFI_PLUGIN_EXPORT int32_t tau_node_stop(tau_context* context, int32_t node,
+                                        double when);
+
+// Disconnects a node from the graph and frees it. Its handle becomes invalid
+// at once; its memory is freed by a later edit, once the rendering thread is
+// done with it.
+FFI_PLUGIN_EXPORT int32_t tau_node_release(tau_context* context, int32_t node);
+
+// Copies the timings of `node`, mixing its input and processing it, into
+// `profile`. Only the quanta the node was part of the graph count.
+//
+// Returns a `tau_status`: `TAU_ERROR_NOT_SUPPORTED` if profiling was
+// compiled out.
+FFI_PLUGIN_EXPORT int32_t tau_node_get_profile(tau_context* context,
+                                               int32_t node,
+                                               tau_profile* profile);
+
+// Sets the value of the parameter `param`, one of `tau_param_id`, of `node`,
+// from the next quantum. Once events were scheduled on the parameter, the
+// value is scheduled at the next quantum instead, as
+// `tau_param_set_value_at_time` would.
+FFI_PLUGIN_EXPORT int32_t tau_param_set_value(tau_context* context,
+                                              int32_t node, int32_t param,
+                                              float value);
+
+// The value of the parameter `param` of `node` at the start of the last
+// quantum rendered, or NaN if there is no such parameter.
+FFI_PLUGIN_EXPORT float tau_param_get_value(tau_context* context, int32_t node,
+                                            int32_t param);
+
+// Automation of parameters, as the methods of the Web Audio `AudioParam`.
+//
+// Times are in seconds of context time. An event applies from the first
+// frame at or after its time, so automation is sample-accurate, and a
+// parameter that no event changes during a quantum costs nothing to render.
+// Events may be scheduled from any thread while the context renders: they
+// are queued with the other edits, under the control lock of the context,
+// and apply from the next quantum. The rendering thread never waits for
+// them.
+//
+// Each function returns a `tau_status`: `TAU_ERROR_INVALID_ARGUMENT` for an
+// unknown node or parameter, and for the arguments the `AudioParam` methods
+// reject.
+
+// Sets the value to `value` at `start_time`.
+FFI_PLUGIN_EXPORT int32_t tau_param_set_value_at_time(tau_context* context,
+                                                      int32_t node,
+                                                      int32_t param,
+                                                      float value,
+                                                      double start_time);
+
+// Ramps the value linearly from the previous event to `value` at
+// `end_time`.
+FFI_PLUGIN_EXPORT int32_t tau_param_linear_ramp_to_value_at_time(
+    tau_context* context, int32_t node, int32_t param, float value,
+    double end_time);
+
+// Ramps the value exponentially from the previous event to `value`, which
+// must not be 0, at `end_time`.
+FFI_PLUGIN_EXPORT int32_t tau_param_exponential_ramp_to_value_at_time(
+    tau_context* context, int32_t node, int32_t param, float value,
+    double end_time);
+
+// Approaches `target` exponentially from `start_time`, with a time constant
+// of `time_constant` seconds.
+FFI_PLUGIN_EXPORT int32_t tau_param_set_target_at_time(tau_context* context,
+                                                       int32_t node,
+                                                       int32_t param,
+                                                       float target,
+                                                       double start_time,
+                                                       double time_constant);
+
+// Follows the `length` values of `values`, at least 2, interpolated linearly
+// over `duration` seconds from `start_time`. The values are copied.
+FFI_PLUGIN_EXPORT int32_t tau_param_set_value_curve_at_time(
+    tau_context* context, int32_t node, int32_t param, const float* values,
+    int32_t length, double start_time, double duration);
+
+// Removes the events scheduled at `cancel_time` or later.
+FFI_PLUGIN_EXPORT int32_t tau_param_cancel_scheduled_values(
+    tau_context* context, int32_t node, int32_t param, double cancel_time);
+
+// Reads the bytes of an encoded stream for a codec.
+typedef struct tau_reader {
+  // Reads up to `size` bytes into `buffer`. Returns the number of bytes read,
+  // 0 at the end of the stream, or a negative `tau_status`.
+  int64_t (*read)(void* user, void* buffer, int64_t size);
+  // Moves to `offset` bytes from the start of the stream. Returns a
+  // `tau_status`.
+  int32_t (*seek)(void* user, int64_t offset);
+  void* user;
+} tau_reader;
+
+// The audio of an encoded stream.
+typedef struct tau_stream_format {
+  int32_t channels;
+  float sample_rate;
+  // The number of frames, or -1 if the stream does not tell.
+  int64_t frames;
+} tau_stream_format;
+
+// The number of bytes at the start of a stream that codecs probe.
+#define TAU_CODEC_PROBE_BYTES 64
+
+// A decoder of one encoded format, such as WAV.
+//
+// Codecs decode incrementally: a stream calls `decode` for a few thousand
+// frames at a time, so that memory use does not depend on the length of the
+// stream. Every function is called from one thread at a time, though not
+// always the same one.
+typedef struct tau_codec {
+  const char* name;
+  // Whether the first `size` bytes of a stream, at most
+  // `TAU_CODEC_PROBE_BYTES`, are in the format of the codec.
+  int32_t (*probe)(const uint8_t* header, int32_t size);
+  // Starts decoding from `reader`, positioned at the start of the stream,
+  // and fills `format`. Returns the decoder, or NULL.
+  void* (*open)(const tau_reader* reader, tau_stream_format* format);
+  // Decodes up to `frames` frames into `channels`, one planar pointer per
+  // channel. Returns the number of frames decoded, 0 at the end of the
+  // stream, or a negative `tau_status`.
+  int32_t (*decode)(void* decoder, float* const* channels, int32_t frames);
+  void (*close)(void* decoder);
+} tau_codec;
+
+// Adds a codec, which is probed before the built-in ones and those added
+// before it. WAV (integer PCM of 8 to 32 bits and float) is built in.
+//
+// `codec` must outlive the library, and codecs must be registered before
+// streams are opened. Returns a `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_codec_register(const tau_codec* codec);
+
+// Decoded audio read incrementally from a file.
+//
+// A stream decodes on a thread of its own into a ring of decoded frames,
+// ahead of its reader: memory use is bounded by the ring, whatever the
+// length of the file, and the first frames are available as soon as the
+// first chunk is decoded. When the ring is full, decoding waits for the
+// reader; when it is empty, the reader waits for decoding.
+//
+// A stream has a single reader: either `tau_stream_read` or one stream
+// source node. It is reference counted like `tau_audio_buffer`.
+typedef struct tau_stream tau_stream;
+
+// Opens the file at `path`, UTF-8 encoded, with a ring of at least
+// `buffer_frames` frames, or a default size if `buffer_frames` is not
+// positive. The file is read in chunks. Returns the stream, holding one
+// reference, or NULL if the file cannot be read or no codec decodes it.
+FFI_PLUGIN_EXPORT tau_stream* tau_stream_open(const char* path,
+                                              int32_t buffer_frames);
+
+FFI_PLUGIN_EXPORT void tau_stream_retain(tau_stream* stream);
+
+// Gives back a reference to `stream`. The last one stops decoding and
+// closes the file.
+FFI_PLUGIN_EXPORT void tau_stream_release(tau_stream* stream);
+
+FFI_PLUGIN_EXPORT int32_t tau_stream_channels(tau_stream* stream);
+
+FFI_PLUGIN_EXPORT float tau_stream_sample_rate(tau_stream* stream);
+
+// The number of frames of the stream, or -1 if unknown.
+FFI_PLUGIN_EXPORT int64_t tau_stream_length(tau_stream* stream);
+
+// Reads the next frames of `stream` into `buffer`, which must have as many
+// channels, waiting for them to be decoded. A buffer longer than the ring
+// is filled in several turns of decoding.
+//
+// Returns the number of frames read, fewer than `buffer->frames` only at the
+// end of the stream, or a negative `tau_status` if decoding failed.
+FFI_PLUGIN_EXPORT int32_t tau_stream_read(tau_stream* stream,
+                                          tau_audio_buffer* buffer);
+
+// Creates a source playing `stream`, converted to the sample rate of the
+// context at its resampler quality. The source takes a reference to `stream`.
+//
+// In real time, frames not decoded yet when they are needed play as
+// silence; with `blocking`, for offline rendering, the rendering thread
+// waits for them instead, so the graph paces itself on the decoder rather
+// than rendering gaps.
+//
+// Returns the node handle, or a negative `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_stream_source_create(tau_context* context,
+                                                   tau_stream* stream,
+                                                   int32_t blocking);
+
+// The quanta the stream source `node` played partly or wholly as silence
+// because their frames were not decoded in time, or a negative
+// `tau_status`.
+FFI_PLUGIN_EXPORT int64_t tau_stream_source_underruns(tau_context* context,
+                                                      int32_t node);
+
+// Decodes the whole file at `path` into a new buffer, as the Web Audio
+// `decodeAudioData`. Memory use grows with the length of the file: prefer a
+// stream for long files.
+//
+// Returns the buffer, holding one reference, or NULL on failure.
+FFI_PLUGIN_EXPORT tau_audio_buffer* tau_decode_file(const char* path);
+
+// A cache of decoded audio files in a directory, shared between contexts and
+// processes.
+//
+// An entry holds the decoded samples of one file as aligned planar float32,
+// and is named after a hash of the content of the file, so copies of a file
+// share an entry and edited files get a new one. Loading an entry maps its
+// file into memory instead of decoding: processes loading the same entry
+// share its pages, and a buffer written to gets private copies of the pages
+// it writes, which are never seen by other loads.
+//
+// When the entries grow past the size limit, the least recently loaded ones
+// are deleted. Entries are native-endian: a cache directory is not portable
+// between machines.
+typedef struct tau_cache tau_cache;
+
+// Counters of a `tau_cache`, since it was opened by this process.
+typedef struct tau_cache_stats {
+  // Loads that mapped an existing entry.
+  int64_t hits;
+  // Loads that decoded the file and added an entry.
+  int64_t misses;
+  // Entries deleted to stay within the size limit, and their size.
+  int64_t evictions;
+  int64_t evicted_bytes;
+  // The entries in the directory and their total size, as of the last
+  // eviction pass.
+  int64_t entries;
+  int64_t bytes;
+} tau_cache_stats;
+
+// Opens the cache in `directory`, UTF-8 encoded, creating the directory if
+// needed but not its parents, and evicts entries past `max_bytes`.
+//
+// Returns the cache, or NULL if the directory cannot be created or
+// `max_bytes` is negative.
+FFI_PLUGIN_EXPORT tau_cache* tau_cache_open(const char* directory,
+                                            int64_t max_bytes);
+
+// Closes `cache`. Buffers loaded from it stay valid.
+FFI_PLUGIN_EXPORT void tau_cache_close(tau_cache* cache);
+
+// Changes the size limit of `cache`, evicting entries past it. Returns a
+// `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_cache_set_limit(tau_cache* cache,
+                                              int64_t max_bytes);
+
+// Loads the file at `path` from `cache`, decoding it and adding an entry if
+// its content has none. The content of the file is read in full to hash it.
+//
+// Returns the buffer, holding one reference, or NULL if the file cannot be
+// decoded. A buffer is returned even if its entry cannot be written.
+FFI_PLUGIN_EXPORT tau_audio_buffer* tau_cache_load(tau_cache* cache,
+                                                   const char* path);
+
+FFI_PLUGIN_EXPORT void tau_cache_get_stats(tau_cache* cache,
+                                           tau_cache_stats* stats);
+
+// Fills `output` with `frames` interleaved frames for a device. The device
+// needs them within `time_left_ns` nanoseconds, which is negative if it is
+// already late.
+typedef void (*tau_device_callback)(void* user, float* output, int32_t frames,
+                                    int64_t time_left_ns);
+
+// A kind of audio output that plays a context in real time, such as the
+// sound system of a platform.
+//
+// A device pulls the audio: once started, it calls the callback on a thread
+// of its own, a period of frames at a time, at the pace of its clock. The
+// functions other than the callback are called from one thread at a time.
+typedef struct tau_device_backend {
+  const char* name;
+  // Opens a device of `channels` channels at `sample_rate`, asking
+  // `callback` for periods of `period_frames` frames. `options` means what
+  // the backend says, and may be NULL. Returns the device, or NULL.
+  void* (*open)(const char* options, int32_t channels, float sample_rate,
+                int32_t period_frames, tau_device_callback callback,
+                void* user);
+  // Starts and stops the callbacks. `stop` returns once the last callback
+  // has returned. Both return a `tau_status`.
+  int32_t (*start)(void* device);
+  int32_t (*stop)(void* device);
+  void (*close)(void* device);
+} tau_device_backend;
+
+// Adds a device backend, found by name before the built-in ones and those
+// added before it.
+//
+// Two backends are built in, for machines without a sound card: "null",
+// which discards the audio at the pace of the monotonic clock, and "wav",
+// which also writes it to the float WAV file at the path given as options.
+//
+// `backend` must outlive the library. Returns a `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_device_backend_register(
+    const tau_device_backend* backend);
+
+// A device playing a context: the real-time counterpart of
+// `tau_context_render`. While the device is started, its callbacks render
+// the context, which must not be rendered otherwise, and which must outlive
+// the device. The graph may still be edited from any thread.
+typedef struct tau_device tau_device;
+
+// Counters of a `tau_device`, since it was opened.
+typedef struct tau_device_stats {
+  int64_t callbacks;
+  int64_t frames;
+  // The callbacks that returned after the device needed their period: what
+  // a listener hears as a glitch.
+  int64_t underruns;
+  // The time the callbacks took to render, in total and at most.
+  int64_t render_ns;
+  int64_t max_render_ns;
+  // How far the time between two callbacks strayed from a period, in total
+  // and at most.
+  int64_t jitter_ns;
+  int64_t max_jitter_ns;
+} tau_device_stats;
+
+// Opens a device of the backend named `backend`, with `options`, playing
+// `context` in periods of `period_frames` frames, from 1 to 16384.
+//
+// Returns the device, stopped, or NULL if there is no such backend or it
+// cannot open the device.
+FFI_PLUGIN_EXPORT tau_device* tau_device_open(tau_context* context,
+                                              const char* backend,
+                                              const char* options,
+                                              int32_t period_frames);
+
+// Starts or stops playing. Returns a `tau_status`.
+FFI_PLUGIN_EXPORT int32_t tau_device_start(tau_device* device);
+FFI_PLUGIN_EXPORT int32_t tau_device_stop(tau_device* device);
+
+// Stops and closes `device`.
+FFI_PLUGIN_EXPORT void tau_device_close(tau_device* device);
+
+// Copies the counters of `device`, which may be playing, into `stats`.
+FFI_PLUGIN_EXPORT void tau_device_get_stats(tau_device* device,
+                                            tau_device_stats* stats);
+
+#endif  // TAU_FFI_H_
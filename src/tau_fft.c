@@ -0,0 +1,187 @@
+#include <math.h>
+
+#include "tau_fft.h"
+#include "tau_ffi.h"
+#include "tau_kernels.h"
+#include "tau_memory.h"
+
+#define TAU_PI 3.14159265358979323846
+
+int32_t tau_fft_init(tau_fft* fft, int32_t size) {
+  if (size < TAU_FFT_MIN_SIZE || (size & (size - 1)) != 0) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  int32_t half = size / 2;
+  int32_t quarter = size / 4;
+  fft->size = size;
+  fft->half = half;
+  fft->reverse = (int32_t*)tau_memory_alloc((size_t)half * sizeof(int32_t),
+                                            TAU_CACHE_LINE);
+  fft->twiddle_re =
+      (float*)tau_memory_alloc((size_t)half * sizeof(float), TAU_CACHE_LINE);
+  fft->twiddle_im =
+      (float*)tau_memory_alloc((size_t)half * sizeof(float), TAU_CACHE_LINE);
+  fft->rotation_re = (float*)tau_memory_alloc(
+      (size_t)(quarter + 1) * sizeof(float), TAU_CACHE_LINE);
+  fft->rotation_im = (float*)tau_memory_alloc(
+      (size_t)(quarter + 1) * sizeof(float), TAU_CACHE_LINE);
+  if (fft->reverse == NULL || fft->twiddle_re == NULL ||
+      fft->twiddle_im == NULL || fft->rotation_re == NULL ||
+      fft->rotation_im == NULL) {
+    tau_fft_destroy(fft);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  int32_t bits = 0;
+  while ((1 << bits) < half) {
+    bits++;
+  }
+  for (int32_t i = 0; i < half; i++) {
+    int32_t reversed = 0;
+    for (int32_t b = 0; b < bits; b++) {
+      reversed |= ((i >> b) & 1) << (bits - 1 - b);
+    }
+    fft->reverse[i] = reversed;
+  }
+  for (int32_t h = 1; h < half; h *= 2) {
+    for (int32_t j = 0; j < h; j++) {
+      double angle = -TAU_PI * j / h;
+      fft->twiddle_re[h - 1 + j] = (float)cos(angle);
+      fft->twiddle_im[h - 1 + j] = (float)sin(angle);
+    }
+  }
+  for (int32_t k = 0; k <= quarter; k++) {
+    double angle = -2.0 * TAU_PI * k / size;
+    fft->rotation_re[k] = (float)cos(angle);
+    fft->rotation_im[k] = (float)sin(angle);
+  }
+  return TAU_OK;
+}
+
+void tau_fft_destroy(tau_fft* fft) {
+  tau_memory_free(fft->reverse);
+  tau_memory_free(fft->twiddle_re);
+  tau_memory_free(fft->twiddle_im);
+  tau_memory_free(fft->rotation_re);
+  tau_memory_free(fft->rotation_im);
+  fft->reverse = NULL;
+  fft->twiddle_re = NULL;
+  fft->twiddle_im = NULL;
+  fft->rotation_re = NULL;
+  fft->rotation_im = NULL;
+}
+
+// The complex transform of `half` values in bit-reversed order, in place.
+// The first two stages have trivial twiddle factors and are done here; the
+// others go through the butterfly kernel.
+static void transform(const tau_fft* fft, float* re, float* im) {
+  int32_t half = fft->half;
+  for (int32_t i = 0; i < half; i += 2) {
+    float even_re = re[i];
+    float even_im = im[i];
+    re[i] = even_re + re[i + 1];
+    im[i] = even_im + im[i + 1];
+    re[i + 1] = even_re - re[i + 1];
+    im[i + 1] = even_im - im[i + 1];
+  }
+  for (int32_t i = 0; i < half; i += 4) {
+    float even_re = re[i];
+    float even_im = im[i];
+    re[i] = even_re + re[i + 2];
+    im[i] = even_im + im[i + 2];
+    re[i + 2] = even_re - re[i + 2];
+    im[i + 2] = even_im - im[i + 2];
+    // Multiplying by the twiddle factor -i.
+    float x_re = im[i + 3];
+    float x_im = -re[i + 3];
+    even_re = re[i + 1];
+    even_im = im[i + 1];
+    re[i + 1] = even_re + x_re;
+    im[i + 1] = even_im + x_im;
+    re[i + 3] = even_re - x_re;
+    im[i + 3] = even_im - x_im;
+  }
+  const tau_kernel_table* kernels = tau_kernels();
+  for (int32_t h = 4; h < half; h *= 2) {
+    for (int32_t group = 0; group < half; group += 2 * h) {
+      kernels->butterfly(re + group, im + group, fft->twiddle_re + h - 1,
+                         fft->twiddle_im + h - 1, h);
+    }
+  }
+}
+
+void tau_fft_forward(const tau_fft* fft, const float* input, float* re,
+                     float* im) {
+  int32_t half = fft->half;
+  for (int32_t n = 0; n < half; n++) {
+    re[fft->reverse[n]] = input[2 * n];
+    im[fft->reverse[n]] = input[2 * n + 1];
+  }
+  transform(fft, re, im);
+  // The even samples are the real part of the packed transform Z and the
+  // odd samples its imaginary part: bin k of the signal is E + W^k O, with
+  // E = (Z[k] + conj(Z[half - k])) / 2 and O = -i (Z[k] - conj(Z[half - k]))
+  // / 2. Bins k and half - k are computed together, in place.
+  float dc = re[0];
+  re[0] = dc + im[0];
+  re[half] = dc - im[0];
+  im[0] = 0.0f;
+  im[half] = 0.0f;
+  for (int32_t k = 1; k <= half / 2; k++) {
+    int32_t j = half - k;
+    float e_re = 0.5f * (re[k] + re[j]);
+    float e_im = 0.5f * (im[k] - im[j]);
+    float o_re = 0.5f * (im[k] + im[j]);
+    float o_im = -0.5f * (re[k] - re[j]);
+    float w_re = fft->rotation_re[k];
+    float w_im = fft->rotation_im[k];
+    float wo_re = w_re * o_re - w_im * o_im;
+    float wo_im = w_re * o_im + w_im * o_re;
+    re[k] = e_re + wo_re;
+    im[k] = e_im + wo_im;
+    re[j] = e_re - wo_re;
+    im[j] = wo_im - e_im;
+  }
+}
+
+void tau_fft_inverse(const tau_fft* fft, float* re, float* im, float* output) {
+  int32_t half = fft->half;
+  // Packs the bins back into the complex transform, Z[k] = E + i O with
+  // E = X[k] + conj(X[half - k]) and O = (X[k] - conj(X[half - k])) W^-k:
+  // twice Z, since neither is halved.
+  float dc = re[0];
+  re[0] = dc + re[half];
+  im[0] = dc - re[half];
+  for (int32_t k = 1; k <= half / 2; k++) {
+    int32_t j = half - k;
+    float e_re = re[k] + re[j];
+    float e_im = im[k] - im[j];
+    float d_re = re[k] - re[j];
+    float d_im = im[k] + im[j];
+    float w_re = fft->rotation_re[k];
+    float w_im = fft->rotation_im[k];
+    float o_re = d_re * w_re + d_im * w_im;
+    float o_im = d_im * w_re - d_re * w_im;
+    re[k] = e_re - o_im;
+    im[k] = e_im + o_re;
+    re[j] = e_re + o_im;
+    im[j] = o_re - e_im;
+  }
+  for (int32_t i = 0; i < half; i++) {
+    int32_t r = fft->reverse[i];
+    if (i < r) {
+      float t = re[i];
+      re[i] = re[r];
+      re[r] = t;
+      t = im[i];
+      im[i] = im[r];
+      im[r] = t;
+    }
+  }
+  // The inverse transform is the forward one with the real and imaginary
+  // parts swapped on the way in and out.
+  transform(fft, im, re);
+  for (int32_t n = 0; n < half; n++) {
+    output[2 * n] = re[n];
+    output[2 * n + 1] = im[n];
+  }
+}
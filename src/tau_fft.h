@@ -0,0 +1,47 @@
+// Fast Fourier transforms of real signals.
+//
+// A real signal of `size` samples, a power of two, has `size / 2 + 1`
+// distinct complex bins, stored as separate real and imaginary parts so that
+// spectra can be processed with the vector kernels. The transform packs the
+// signal into a complex one of half the size, whose butterflies run on
+// `tau_kernel_butterfly`.
+#ifndef TAU_FFT_H_
+#define TAU_FFT_H_
+
+#include "tau_platform.h"
+
+// The smallest transform.
+#define TAU_FFT_MIN_SIZE 8
+
+typedef struct tau_fft {
+  int32_t size;
+  // `size / 2`, the size of the complex transform.
+  int32_t half;
+  // The bit-reversed index of every complex input.
+  int32_t* reverse;
+  // The twiddle factors of the butterfly stage of half size `h`, at offset
+  // `h - 1`.
+  float* twiddle_re;
+  float* twiddle_im;
+  // `exp(-2 pi i k / size)` for `k <= size / 4`, which unpacks the complex
+  // transform into the bins of the real one.
+  float* rotation_re;
+  float* rotation_im;
+} tau_fft;
+
+// Prepares transforms of `size` samples, a power of two of at least
+// `TAU_FFT_MIN_SIZE`. Returns a `tau_status`.
+int32_t tau_fft_init(tau_fft* fft, int32_t size);
+
+void tau_fft_destroy(tau_fft* fft);
+
+// The spectrum of `input`, of `size` samples, into `re` and `im`, of
+// `size / 2 + 1` bins.
+void tau_fft_forward(const tau_fft* fft, const float* input, float* re,
+                     float* im);
+
+// The signal of the spectrum in `re` and `im`, multiplied by `size`, into
+// `output`. Overwrites `re` and `im`.
+void tau_fft_inverse(const tau_fft* fft, float* re, float* im, float* output);
+
+#endif  // TAU_FFT_H_
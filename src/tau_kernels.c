@@ -0,0 +1,333 @@
+#include "tau_kernels.h"
+
+#if TAU_KERNELS_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// Scalar kernels: the fallback, and the reference of the vector versions.
+
+static void scale_scalar(float* destination, const float* source, float gain,
+                         int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    destination[i] = source[i] * gain;
+  }
+}
+
+static void add_scalar(float* destination, const float* source,
+                       int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    destination[i] += source[i];
+  }
+}
+
+static void scale_add_scalar(float* destination, const float* source,
+                             float gain, int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    destination[i] += source[i] * gain;
+  }
+}
+
+static void multiply_scalar(float* destination, const float* source,
+                            const float* gains, int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    destination[i] = source[i] * gains[i];
+  }
+}
+
+static void multiply_add_scalar(float* destination, const float* source,
+                                const float* gains, int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    destination[i] += source[i] * gains[i];
+  }
+}
+
+static void clip_scalar(float* destination, const float* source, float low,
+                        float high, int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    float sample = source[i];
+    sample = sample < low ? low : sample;
+    destination[i] = sample > high ? high : sample;
+  }
+}
+
+static void complex_multiply_add_scalar(float* re, float* im,
+                                       const float* a_re, const float* a_im,
+                                       const float* b_re, const float* b_im,
+                                       int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    re[i] += a_re[i] * b_re[i] - a_im[i] * b_im[i];
+    im[i] += a_re[i] * b_im[i] + a_im[i] * b_re[i];
+  }
+}
+
+static void butterfly_scalar(float* re, float* im, const float* twiddle_re,
+                             const float* twiddle_im, int32_t half) {
+  for (int32_t j = 0; j < half; j++) {
+    float x_re = re[j + half] * twiddle_re[j] - im[j + half] * twiddle_im[j];
+    float x_im = re[j + half] * twiddle_im[j] + im[j + half] * twiddle_re[j];
+    re[j + half] = re[j] - x_re;
+    im[j + half] = im[j] - x_im;
+    re[j] += x_re;
+    im[j] += x_im;
+  }
+}
+
+static float blend_dot_scalar(const float* x, const float* a, const float* b,
+                              float blend, int32_t count) {
+  float sum = 0.0f;
+  for (int32_t i = 0; i < count; i++) {
+    sum += x[i] * (a[i] + (b[i] - a[i]) * blend);
+  }
+  return sum;
+}
+
+static void ramp_scalar(float* destination, float start, float step,
+                        int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    destination[i] = start + step * (float)i;
+  }
+}
+
+static void geometric_scalar(float* destination, float offset, float scale,
+                             float ratio, int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    destination[i] = offset + scale;
+    scale *= ratio;
+  }
+}
+
+static void smooth_magnitude_scalar(float* smoothed, const float* re,
+                                    const float* im, float scale,
+                                    float smoothing, int32_t count) {
+  float weight = (1.0f - smoothing) * scale;
+  for (int32_t i = 0; i < count; i++) {
+    smoothed[i] = smoothing * smoothed[i] +
+                  weight * sqrtf(re[i] * re[i] + im[i] * im[i]);
+  }
+}
+
+static void decibels_scalar(float* destination, const float* source,
+                            int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    destination[i] = tau_to_decibels(source[i]);
+  }
+}
+
+static void biquad_scalar(const tau_biquad_lanes* bank, float* signal,
+                          int32_t frames, int32_t rows) {
+  for (int32_t lane = 0; lane < bank->lanes; lane++) {
+    tau_biquad_lane(bank, lane, signal, frames, rows);
+  }
+}
+
+static void compressor_gain_scalar(float* destination, const float* levels,
+                                   float threshold, float knee, float slope,
+                                   int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    destination[i] = tau_compressor_gain(levels[i], threshold, knee, slope);
+  }
+}
+
+static void amplitudes_scalar(float* destination, const float* decibels,
+                              int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    destination[i] = tau_to_amplitude(decibels[i]);
+  }
+}
+
+const tau_kernel_table tau_kernels_scalar = {
+    "scalar",
+    scale_scalar,
+    add_scalar,
+    scale_add_scalar,
+    multiply_scalar,
+    multiply_add_scalar,
+    clip_scalar,
+    complex_multiply_add_scalar,
+    butterfly_scalar,
+    blend_dot_scalar,
+    ramp_scalar,
+    geometric_scalar,
+    smooth_magnitude_scalar,
+    decibels_scalar,
+    biquad_scalar,
+    compressor_gain_scalar,
+    amplitudes_scalar,
+};
+
+#if TAU_KERNELS_X86
+static void cpuid(uint32_t leaf, uint32_t registers[4]) {
+#if defined(_MSC_VER)
+  __cpuidex((int*)registers, (int)leaf, 0);
+#else
+  __cpuid_count(leaf, 0, registers[0], registers[1], registers[2],
+                registers[3]);
+#endif
+}
+
+// Whether the OS saves the AVX registers on context switches.
+static int os_saves_avx(void) {
+#if defined(_MSC_VER)
+  return (_xgetbv(0) & 6) == 6;
+#else
+  uint32_t low;
+  uint32_t high;
+  __asm__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+  return (low & 6) == 6;
+#endif
+}
+#endif
+
+static int supported(tau_kernel_isa isa) {
+#if TAU_KERNELS_X86
+  uint32_t registers[4];
+  cpuid(0, registers);
+  uint32_t max_leaf = registers[0];
+  cpuid(1, registers);
+  int sse2 = (registers[3] >> 26) & 1;
+  int osxsave = (registers[2] >> 27) & 1;
+  int avx = (registers[2] >> 28) & 1;
+  if (isa == TAU_ISA_SSE2) {
+    return sse2;
+  }
+  if (isa == TAU_ISA_AVX2) {
+    if (max_leaf < 7 || !avx || !osxsave || !os_saves_avx()) {
+      return 0;
+    }
+    cpuid(7, registers);
+    return (registers[1] >> 5) & 1;
+  }
+#endif
+#if TAU_KERNELS_NEON
+  // NEON is part of every ARM target the library is built for.
+  if (isa == TAU_ISA_NEON) {
+    return 1;
+  }
+#endif
+  return isa == TAU_ISA_SCALAR;
+}
+
+const tau_kernel_table* tau_kernels_for(tau_kernel_isa isa) {
+  if (!supported(isa)) {
+    return NULL;
+  }
+  switch (isa) {
+#if TAU_KERNELS_X86
+    case TAU_ISA_SSE2:
+      return &tau_kernels_sse2;
+    case TAU_ISA_AVX2:
+      return &tau_kernels_avx2;
+#endif
+#if TAU_KERNELS_NEON
+    case TAU_ISA_NEON:
+      return &tau_kernels_neon;
+#endif
+    case TAU_ISA_SCALAR:
+      return &tau_kernels_scalar;
+    default:
+      return NULL;
+  }
+}
+
+static const tau_kernel_table* active_kernels;
+
+const tau_kernel_table* tau_kernels(void) {
+  const tau_kernel_table* kernels = (const tau_kernel_table*)
+      tau_atomic_load_ptr((void* const volatile*)&active_kernels);
+  if (kernels != NULL) {
+    return kernels;
+  }
+  // Threads racing here detect the same kernels.
+  for (int isa = TAU_ISA_COUNT - 1; kernels == NULL; isa--) {
+    kernels = tau_kernels_for((tau_kernel_isa)isa);
+  }
+  tau_atomic_store_ptr((void* volatile*)&active_kernels, (void*)kernels);
+  return kernels;
+}
+
+void tau_kernel_scale(float* destination, const float* source, float gain,
+                      int32_t count) {
+  tau_kernels()->scale(destination, source, gain, count);
+}
+
+void tau_kernel_add(float* destination, const float* source, int32_t count) {
+  tau_kernels()->add(destination, source, count);
+}
+
+void tau_kernel_scale_add(float* destination, const float* source, float gain,
+                          int32_t count) {
+  tau_kernels()->scale_add(destination, source, gain, count);
+}
+
+void tau_kernel_multiply(float* destination, const float* source,
+                         const float* gains, int32_t count) {
+  tau_kernels()->multiply(destination, source, gains, count);
+}
+
+void tau_kernel_multiply_add(float* destination, const float* source,
+                             const float* gains, int32_t count) {
+  tau_kernels()->multiply_add(destination, source, gains, count);
+}
+
+void tau_kernel_clip(float* destination, const float* source, float low,
+                     float high, int32_t count) {
+  tau_kernels()->clip(destination, source, low, high, count);
+}
+
+void tau_kernel_complex_multiply_add(float* re, float* im, const float* a_re,
+                                     const float* a_im, const float* b_re,
+                                     const float* b_im, int32_t count) {
+  tau_kernels()->complex_multiply_add(re, im, a_re, a_im, b_re, b_im, count);
+}
+
+void tau_kernel_butterfly(float* re, float* im, const float* twiddle_re,
+                          const float* twiddle_im, int32_t half) {
+  tau_kernels()->butterfly(re, im, twiddle_re, twiddle_im, half);
+}
+
+float tau_kernel_blend_dot(const float* x, const float* a, const float* b,
+                           float blend, int32_t count) {
+  return tau_kernels()->blend_dot(x, a, b, blend, count);
+}
+
+void tau_kernel_ramp(float* destination, float start, float step,
+                     int32_t count) {
+  tau_kernels()->ramp(destination, start, step, count);
+}
+
+void tau_kernel_geometric(float* destination, float offset, float scale,
+                          float ratio, int32_t count) {
+  tau_kernels()->geometric(destination, offset, scale, ratio, count);
+}
+
+void tau_kernel_smooth_magnitude(float* smoothed, const float* re,
+                                 const float* im, float scale,
+                                 float smoothing, int32_t count) {
+  tau_kernels()->smooth_magnitude(smoothed, re, im, scale, smoothing, count);
+}
+
+void tau_kernel_decibels(float* destination, const float* source,
+                         int32_t count) {
+  tau_kernels()->decibels(destination, source, count);
+}
+
+void tau_kernel_biquad(const tau_biquad_lanes* bank, float* signal,
+                       int32_t frames, int32_t rows) {
+  tau_kernels()->biquad(bank, signal, frames, rows);
+}
+
+void tau_kernel_compressor_gain(float* destination, const float* levels,
+                                float threshold, float knee, float slope,
+                                int32_t count) {
+  tau_kernels()->compressor_gain(destination, levels, threshold, knee, slope,
+                                 count);
+}
+
+void tau_kernel_amplitudes(float* destination, const float* decibels,
+                           int32_t count) {
+  tau_kernels()->amplitudes(destination, decibels, count);
+}
@@ -0,0 +1,318 @@
+// Sample-processing kernels shared by the render graph nodes.
+//
+// Every kernel works on `count` contiguous float samples. Buffers may alias
+// only where noted.
+//
+// Each kernel has a scalar version and vector versions for SSE2, AVX2 and
+// NEON, each in its own translation unit. The `tau_kernel_*` functions call
+// the best version the processor supports, detected on first use.
+#ifndef TAU_KERNELS_H_
+#define TAU_KERNELS_H_
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "tau_platform.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#define TAU_KERNELS_X86 1
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define TAU_KERNELS_NEON 1
+#endif
+
+// The vector units are compiled with the instruction set enabled per
+// function, so that the library needs no ISA options from its build systems.
+#if defined(__GNUC__) || defined(__clang__)
+#define TAU_TARGET(isa) __attribute__((target(isa)))
+#else
+#define TAU_TARGET(isa)
+#endif
+
+// A bank of biquad sections in transposed direct form II, one per lane, for
+// the `biquad` kernel. Every array holds a value per lane.
+typedef struct tau_biquad_lanes {
+  int32_t lanes;
+  // The coefficients, normalized by `a0`.
+  const float* b0;
+  const float* b1;
+  const float* b2;
+  const float* a1;
+  const float* a2;
+  // The state, carried from one call to the next.
+  float* s1;
+  float* s2;
+  // The first row each lane filters, and whether it filters the output of
+  // the previous lane rather than its own input.
+  const int32_t* delays;
+  const int32_t* links;
+} tau_biquad_lanes;
+
+typedef enum tau_kernel_isa {
+  TAU_ISA_SCALAR,
+  TAU_ISA_SSE2,
+  TAU_ISA_AVX2,
+  TAU_ISA_NEON,
+  TAU_ISA_COUNT,
+} tau_kernel_isa;
+
+// One version of every kernel.
+typedef struct tau_kernel_table {
+  const char* name;
+  void (*scale)(float* destination, const float* source, float gain,
+                int32_t count);
+  void (*add)(float* destination, const float* source, int32_t count);
+  void (*scale_add)(float* destination, const float* source, float gain,
+                    int32_t count);
+  void (*multiply)(float* destination, const float* source,
+                   const float* gains, int32_t count);
+  void (*multiply_add)(float* destination, const float* source,
+                       const float* gains, int32_t count);
+  void (*clip)(float* destination, const float* source, float low, float high,
+               int32_t count);
+  void (*complex_multiply_add)(float* re, float* im, const float* a_re,
+                               const float* a_im, const float* b_re,
+                               const float* b_im, int32_t count);
+  void (*butterfly)(float* re, float* im, const float* twiddle_re,
+                    const float* twiddle_im, int32_t half);
+  float (*blend_dot)(const float* x, const float* a, const float* b,
+                     float blend, int32_t count);
+  void (*ramp)(float* destination, float start, float step, int32_t count);
+  void (*geometric)(float* destination, float offset, float scale,
+                    float ratio, int32_t count);
+  void (*smooth_magnitude)(float* smoothed, const float* re, const float* im,
+                           float scale, float smoothing, int32_t count);
+  void (*decibels)(float* destination, const float* source, int32_t count);
+  void (*biquad)(const tau_biquad_lanes* bank, float* signal, int32_t frames,
+                 int32_t rows);
+  void (*compressor_gain)(float* destination, const float* levels,
+                          float threshold, float knee, float slope,
+                          int32_t count);
+  void (*amplitudes)(float* destination, const float* decibels,
+                     int32_t count);
+} tau_kernel_table;
+
+extern const tau_kernel_table tau_kernels_scalar;
+#if TAU_KERNELS_X86
+extern const tau_kernel_table tau_kernels_sse2;
+extern const tau_kernel_table tau_kernels_avx2;
+#endif
+#if TAU_KERNELS_NEON
+extern const tau_kernel_table tau_kernels_neon;
+#endif
+
+// The kernels for `isa`, or NULL if they are not built for this target or
+// not supported by the processor.
+const tau_kernel_table* tau_kernels_for(tau_kernel_isa isa);
+
+// The kernels the `tau_kernel_*` functions use.
+const tau_kernel_table* tau_kernels(void);
+
+// `destination[i] = source[i] * gain`. `destination` may be `source`.
+void tau_kernel_scale(float* destination, const float* source, float gain,
+                      int32_t count);
+
+// `destination[i] += source[i]`, the summing mix of two signals.
+void tau_kernel_add(float* destination, const float* source, int32_t count);
+
+// `destination[i] += source[i] * gain`.
+void tau_kernel_scale_add(float* destination, const float* source, float gain,
+                          int32_t count);
+
+// `destination[i] = source[i] * gains[i]`, a sample-accurate gain.
+// `destination` may be `source`.
+void tau_kernel_multiply(float* destination, const float* source,
+                         const float* gains, int32_t count);
+
+// `destination[i] += source[i] * gains[i]`, a sample-accurate gain mixed into
+// `destination`.
+void tau_kernel_multiply_add(float* destination, const float* source,
+                             const float* gains, int32_t count);
+
+// `destination[i] = clamp(source[i], low, high)`. `destination` may be
+// `source`.
+void tau_kernel_clip(float* destination, const float* source, float low,
+                     float high, int32_t count);
+
+// `(re + i im)[i] += (a_re + i a_im)[i] * (b_re + i b_im)[i]`, on complex
+// vectors stored as separate real and imaginary parts.
+void tau_kernel_complex_multiply_add(float* re, float* im, const float* a_re,
+                                     const float* a_im, const float* b_re,
+                                     const float* b_im, int32_t count);
+
+// One radix-2 decimation-in-time FFT butterfly group on `2 * half` complex
+// values: with `x = (re + i im)[j + half] * twiddle[j]`, element `j` becomes
+// `x[j] + x` and element `j + half` becomes `x[j] - x`, for `j < half`.
+void tau_kernel_butterfly(float* re, float* im, const float* twiddle_re,
+                          const float* twiddle_im, int32_t half);
+
+// The sum of `x[i] * (a[i] + (b[i] - a[i]) * blend)`: an FIR filter tap loop
+// on coefficients blended between two rows of a table. The vector versions
+// sum in a different order, so results differ by a few rounding errors.
+float tau_kernel_blend_dot(const float* x, const float* a, const float* b,
+                           float blend, int32_t count);
+
+// `destination[i] = start + step * i`, a linear parameter ramp.
+void tau_kernel_ramp(float* destination, float start, float step,
+                     int32_t count);
+
+// `destination[i] = offset + scale * ratio^i`: exponential ramps and
+// approaches to a target. The vector versions raise `ratio` to the power
+// of the lane count, so results differ by a few rounding errors.
+void tau_kernel_geometric(float* destination, float offset, float scale,
+                          float ratio, int32_t count);
+
+// `smoothed[i] = smoothing * smoothed[i] + (1 - smoothing) * scale * |x|`
+// with `x = re[i] + i im[i]`: the smoothed magnitude spectrum of an
+// analyser.
+void tau_kernel_smooth_magnitude(float* smoothed, const float* re,
+                                 const float* im, float scale,
+                                 float smoothing, int32_t count);
+
+// `destination[i] = 20 log10(source[i])`, or -infinity below `FLT_MIN`, for
+// finite `source[i]`. `destination` may be `source`.
+void tau_kernel_decibels(float* destination, const float* source,
+                         int32_t count);
+
+// Runs the sections of `bank` over `rows` rows of `signal`, in place. Row
+// `t` holds a sample per lane, at `signal[t * lanes + lane]`: lane `l`
+// filters `frames` rows from `delays[l]`, taking as input its own sample,
+// or with `links[l]` set, the output of lane `l - 1` on the row before.
+// Outside of its rows, a lane holds its state and outputs 0. With delays
+// growing by 1 along linked lanes, each lane filters frame after frame what
+// the previous one output, so lanes can be sections in series and still run
+// side by side. The `lanes + 1` floats before `signal` are read, as the row
+// before the first.
+void tau_kernel_biquad(const tau_biquad_lanes* bank, float* signal,
+                       int32_t frames, int32_t rows);
+
+// `destination[i]` = the gain of a compressor, in decibels, for a level of
+// `levels[i]` decibels: 0 below the knee, the `knee` decibels centred on
+// `threshold`, `slope` times the level over `threshold` above it, and a
+// quadratic joining both within it. `slope` is `1 / ratio - 1`.
+// `destination` may be `levels`.
+void tau_kernel_compressor_gain(float* destination, const float* levels,
+                                float threshold, float knee, float slope,
+                                int32_t count);
+
+// `destination[i] = 10^(decibels[i] / 20)`, the inverse of the decibel
+// kernel, or 0 below -758 dB. `destination` may be `decibels`.
+void tau_kernel_amplitudes(float* destination, const float* decibels,
+                           int32_t count);
+
+// The biquad kernel on lane `lane` of `bank`, for the lanes left over by the
+// vector versions. Lanes run one after the other, each over every row.
+static inline void tau_biquad_lane(const tau_biquad_lanes* bank,
+                                   int32_t lane, float* signal,
+                                   int32_t frames, int32_t rows) {
+  int32_t lanes = bank->lanes;
+  float b0 = bank->b0[lane];
+  float b1 = bank->b1[lane];
+  float b2 = bank->b2[lane];
+  float a1 = bank->a1[lane];
+  float a2 = bank->a2[lane];
+  float s1 = bank->s1[lane];
+  float s2 = bank->s2[lane];
+  int32_t first = bank->delays[lane];
+  int32_t end = first + frames < rows ? first + frames : rows;
+  const float* input =
+      bank->links[lane] ? signal - lanes - 1 + lane : signal + lane;
+  float* output = signal + lane;
+  for (int32_t t = 0; t < first && t < rows; t++) {
+    output[t * lanes] = 0.0f;
+  }
+  for (int32_t t = first; t < end; t++) {
+    float x = input[t * lanes];
+    float y = b0 * x + s1;
+    s1 = b1 * x - a1 * y + s2;
+    s2 = b2 * x - a2 * y;
+    output[t * lanes] = y;
+  }
+  for (int32_t t = end > 0 ? end : 0; t < rows; t++) {
+    output[t * lanes] = 0.0f;
+  }
+  bank->s1[lane] = s1;
+  bank->s2[lane] = s2;
+}
+
+// The decibel kernels take `20 log10(x)` as `(e ln 2 + ln(m)) 20 / ln 10` for
+// `x = m 2^e` with `m` within [sqrt(1/2), sqrt(2)], and `ln(m)` as the
+// series of `2 atanh(t)`, with `t = (m - 1) / (m + 1)` below 0.18, up to its
+// t^9 term. Every version takes these steps, within float rounding of the
+// exact logarithm.
+#define TAU_SQRT2 1.41421356f
+#define TAU_LN2 0.693147181f
+#define TAU_DB_PER_NEPER 8.68588964f
+
+// The decibel kernel on one sample, for the tails of the vector versions.
+static inline float tau_to_decibels(float x) {
+  if (x < FLT_MIN) {
+    return -INFINITY;
+  }
+  uint32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  float exponent = (float)((int32_t)(bits >> 23) - 127);
+  bits = (bits & 0x7FFFFF) | 0x3F800000;
+  float mantissa;
+  memcpy(&mantissa, &bits, sizeof(mantissa));
+  if (mantissa > TAU_SQRT2) {
+    mantissa *= 0.5f;
+    exponent += 1.0f;
+  }
+  float t = (mantissa - 1.0f) / (mantissa + 1.0f);
+  float t2 = t * t;
+  float series =
+      1.0f +
+      t2 * (1.0f / 3 + t2 * (1.0f / 5 + t2 * (1.0f / 7 + t2 * (1.0f / 9))));
+  return (2.0f * t * series + exponent * TAU_LN2) * TAU_DB_PER_NEPER;
+}
+
+// The compressor gain kernel on one level, for the tails of the vector
+// versions.
+static inline float tau_compressor_gain(float level, float threshold,
+                                        float knee, float slope) {
+  float over = level - threshold;
+  float inside = over + 0.5f * knee;
+  inside = inside < 0.0f ? 0.0f : inside > knee ? knee : inside;
+  float above = over - 0.5f * knee;
+  above = above > 0.0f ? above : 0.0f;
+  float curve = inside * inside * (knee > 0.0f ? 0.5f / knee : 0.0f);
+  return slope * (curve + above);
+}
+
+// The amplitude kernels take `10^(x / 20)` as `2^n 2^f` for
+// `x log2(10) / 20 = n + f` with `n` an integer and `f` within [-0.5, 0.5],
+// and `2^f` as a polynomial of degree 6, within float rounding.
+#define TAU_LOG2_10_PER_20 0.166096405f
+#define TAU_EXP2_C1 6.931472028550421e-1f
+#define TAU_EXP2_C2 2.402264791363012e-1f
+#define TAU_EXP2_C3 5.550332471162809e-2f
+#define TAU_EXP2_C4 9.618437357674640e-3f
+#define TAU_EXP2_C5 1.339887440266574e-3f
+#define TAU_EXP2_C6 1.535336188319500e-4f
+
+// The amplitude kernel on one sample, for the tails of the vector versions.
+static inline float tau_to_amplitude(float decibels) {
+  float x = decibels * TAU_LOG2_10_PER_20;
+  if (!(x >= -126.0f)) {
+    return 0.0f;
+  }
+  x = x < 127.0f ? x : 127.0f;
+  float n = floorf(x + 0.5f);
+  float f = x - n;
+  float p = TAU_EXP2_C6;
+  p = p * f + TAU_EXP2_C5;
+  p = p * f + TAU_EXP2_C4;
+  p = p * f + TAU_EXP2_C3;
+  p = p * f + TAU_EXP2_C2;
+  p = p * f + TAU_EXP2_C1;
+  uint32_t bits = (uint32_t)((int32_t)n + 127) << 23;
+  float scale;
+  memcpy(&scale, &bits, sizeof(scale));
+  return (1.0f + f * p) * scale;
+}
+
+#endif  // TAU_KERNELS_H_
@@ -0,0 +1,451 @@
+#include "tau_kernels.h"
+
+#if TAU_KERNELS_X86
+#include <immintrin.h>
+
+#define AVX2 TAU_TARGET("avx2")
+
+AVX2 static void scale_avx2(float* destination, const float* source,
+                            float gain, int32_t count) {
+  __m256 factor = _mm256_set1_ps(gain);
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(destination + i,
+                     _mm256_mul_ps(_mm256_loadu_ps(source + i), factor));
+  }
+  for (; i < count; i++) {
+    destination[i] = source[i] * gain;
+  }
+}
+
+AVX2 static void add_avx2(float* destination, const float* source,
+                          int32_t count) {
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(destination + i,
+                     _mm256_add_ps(_mm256_loadu_ps(destination + i),
+                                   _mm256_loadu_ps(source + i)));
+  }
+  for (; i < count; i++) {
+    destination[i] += source[i];
+  }
+}
+
+AVX2 static void scale_add_avx2(float* destination, const float* source,
+                                float gain, int32_t count) {
+  __m256 factor = _mm256_set1_ps(gain);
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 product = _mm256_mul_ps(_mm256_loadu_ps(source + i), factor);
+    _mm256_storeu_ps(destination + i,
+                     _mm256_add_ps(_mm256_loadu_ps(destination + i), product));
+  }
+  for (; i < count; i++) {
+    destination[i] += source[i] * gain;
+  }
+}
+
+AVX2 static void multiply_avx2(float* destination, const float* source,
+                               const float* gains, int32_t count) {
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(destination + i,
+                     _mm256_mul_ps(_mm256_loadu_ps(source + i),
+                                   _mm256_loadu_ps(gains + i)));
+  }
+  for (; i < count; i++) {
+    destination[i] = source[i] * gains[i];
+  }
+}
+
+AVX2 static void multiply_add_avx2(float* destination, const float* source,
+                                   const float* gains, int32_t count) {
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 product = _mm256_mul_ps(_mm256_loadu_ps(source + i),
+                                   _mm256_loadu_ps(gains + i));
+    _mm256_storeu_ps(destination + i,
+                     _mm256_add_ps(_mm256_loadu_ps(destination + i), product));
+  }
+  for (; i < count; i++) {
+    destination[i] += source[i] * gains[i];
+  }
+}
+
+// `max(low, x)` and `min(high, x)` return `x` when it is NaN, as the scalar
+// comparisons do.
+AVX2 static void clip_avx2(float* destination, const float* source, float low,
+                           float high, int32_t count) {
+  __m256 lows = _mm256_set1_ps(low);
+  __m256 highs = _mm256_set1_ps(high);
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 sample = _mm256_max_ps(lows, _mm256_loadu_ps(source + i));
+    _mm256_storeu_ps(destination + i, _mm256_min_ps(highs, sample));
+  }
+  for (; i < count; i++) {
+    float sample = source[i];
+    sample = sample < low ? low : sample;
+    destination[i] = sample > high ? high : sample;
+  }
+}
+
+AVX2 static void complex_multiply_add_avx2(float* re, float* im,
+                                           const float* a_re, const float* a_im,
+                                           const float* b_re, const float* b_im,
+                                           int32_t count) {
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 ar = _mm256_loadu_ps(a_re + i);
+    __m256 ai = _mm256_loadu_ps(a_im + i);
+    __m256 br = _mm256_loadu_ps(b_re + i);
+    __m256 bi = _mm256_loadu_ps(b_im + i);
+    __m256 product_re =
+        _mm256_sub_ps(_mm256_mul_ps(ar, br), _mm256_mul_ps(ai, bi));
+    __m256 product_im =
+        _mm256_add_ps(_mm256_mul_ps(ar, bi), _mm256_mul_ps(ai, br));
+    _mm256_storeu_ps(re + i,
+                     _mm256_add_ps(_mm256_loadu_ps(re + i), product_re));
+    _mm256_storeu_ps(im + i,
+                     _mm256_add_ps(_mm256_loadu_ps(im + i), product_im));
+  }
+  for (; i < count; i++) {
+    re[i] += a_re[i] * b_re[i] - a_im[i] * b_im[i];
+    im[i] += a_re[i] * b_im[i] + a_im[i] * b_re[i];
+  }
+}
+
+AVX2 static void butterfly_avx2(float* re, float* im,
+                                const float* twiddle_re,
+                                const float* twiddle_im, int32_t half) {
+  int32_t j = 0;
+  for (; j + 8 <= half; j += 8) {
+    __m256 wr = _mm256_loadu_ps(twiddle_re + j);
+    __m256 wi = _mm256_loadu_ps(twiddle_im + j);
+    __m256 odd_re = _mm256_loadu_ps(re + j + half);
+    __m256 odd_im = _mm256_loadu_ps(im + j + half);
+    __m256 x_re =
+        _mm256_sub_ps(_mm256_mul_ps(odd_re, wr), _mm256_mul_ps(odd_im, wi));
+    __m256 x_im =
+        _mm256_add_ps(_mm256_mul_ps(odd_re, wi), _mm256_mul_ps(odd_im, wr));
+    __m256 even_re = _mm256_loadu_ps(re + j);
+    __m256 even_im = _mm256_loadu_ps(im + j);
+    _mm256_storeu_ps(re + j + half, _mm256_sub_ps(even_re, x_re));
+    _mm256_storeu_ps(im + j + half, _mm256_sub_ps(even_im, x_im));
+    _mm256_storeu_ps(re + j, _mm256_add_ps(even_re, x_re));
+    _mm256_storeu_ps(im + j, _mm256_add_ps(even_im, x_im));
+  }
+  for (; j < half; j++) {
+    float x_re = re[j + half] * twiddle_re[j] - im[j + half] * twiddle_im[j];
+    float x_im = re[j + half] * twiddle_im[j] + im[j + half] * twiddle_re[j];
+    re[j + half] = re[j] - x_re;
+    im[j + half] = im[j] - x_im;
+    re[j] += x_re;
+    im[j] += x_im;
+  }
+}
+
+// Two sums hide the latency of the additions.
+AVX2 static float blend_dot_avx2(const float* x, const float* a,
+                                 const float* b, float blend, int32_t count) {
+  __m256 factor = _mm256_set1_ps(blend);
+  __m256 sums[2] = {_mm256_setzero_ps(), _mm256_setzero_ps()};
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 low = _mm256_loadu_ps(a + i);
+    __m256 high = _mm256_loadu_ps(b + i);
+    __m256 coefficient =
+        _mm256_add_ps(low, _mm256_mul_ps(_mm256_sub_ps(high, low), factor));
+    sums[(i >> 3) & 1] =
+        _mm256_add_ps(sums[(i >> 3) & 1],
+                      _mm256_mul_ps(_mm256_loadu_ps(x + i), coefficient));
+  }
+  __m256 both = _mm256_add_ps(sums[0], sums[1]);
+  __m128 total = _mm_add_ps(_mm256_castps256_ps128(both),
+                            _mm256_extractf128_ps(both, 1));
+  total = _mm_add_ps(total, _mm_movehl_ps(total, total));
+  total = _mm_add_ss(total, _mm_shuffle_ps(total, total, 1));
+  float sum = _mm_cvtss_f32(total);
+  for (; i < count; i++) {
+    sum += x[i] * (a[i] + (b[i] - a[i]) * blend);
+  }
+  return sum;
+}
+
+AVX2 static void ramp_avx2(float* destination, float start, float step,
+                           int32_t count) {
+  __m256 starts = _mm256_set1_ps(start);
+  __m256 steps = _mm256_set1_ps(step);
+  __m256 index =
+      _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+  __m256 eight = _mm256_set1_ps(8.0f);
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(destination + i,
+                     _mm256_add_ps(starts, _mm256_mul_ps(steps, index)));
+    index = _mm256_add_ps(index, eight);
+  }
+  for (; i < count; i++) {
+    destination[i] = start + step * (float)i;
+  }
+}
+
+// Each lane steps by `ratio^8`.
+AVX2 static void geometric_avx2(float* destination, float offset, float scale,
+                                float ratio, int32_t count) {
+  float powers_of[8];
+  powers_of[0] = scale;
+  for (int k = 1; k < 8; k++) {
+    powers_of[k] = powers_of[k - 1] * ratio;
+  }
+  float square = ratio * ratio;
+  float fourth = square * square;
+  __m256 offsets = _mm256_set1_ps(offset);
+  __m256 powers = _mm256_loadu_ps(powers_of);
+  __m256 stride = _mm256_set1_ps(fourth * fourth);
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(destination + i, _mm256_add_ps(offsets, powers));
+    powers = _mm256_mul_ps(powers, stride);
+  }
+  scale = _mm_cvtss_f32(_mm256_castps256_ps128(powers));
+  for (; i < count; i++) {
+    destination[i] = offset + scale;
+    scale *= ratio;
+  }
+}
+
+AVX2 static void smooth_magnitude_avx2(float* smoothed, const float* re,
+                                       const float* im, float scale,
+                                       float smoothing, int32_t count) {
+  float weight = (1.0f - smoothing) * scale;
+  __m256 smoothings = _mm256_set1_ps(smoothing);
+  __m256 weights = _mm256_set1_ps(weight);
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 x_re = _mm256_loadu_ps(re + i);
+    __m256 x_im = _mm256_loadu_ps(im + i);
+    __m256 magnitude = _mm256_sqrt_ps(
+        _mm256_add_ps(_mm256_mul_ps(x_re, x_re), _mm256_mul_ps(x_im, x_im)));
+    _mm256_storeu_ps(
+        smoothed + i,
+        _mm256_add_ps(_mm256_mul_ps(smoothings, _mm256_loadu_ps(smoothed + i)),
+                      _mm256_mul_ps(weights, magnitude)));
+  }
+  for (; i < count; i++) {
+    smoothed[i] = smoothing * smoothed[i] +
+                  weight * sqrtf(re[i] * re[i] + im[i] * im[i]);
+  }
+}
+
+AVX2 static void decibels_avx2(float* destination, const float* source,
+                               int32_t count) {
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256 mantissa_bits =
+      _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFF));
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 x = _mm256_loadu_ps(source + i);
+    __m256 exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(
+        _mm256_srli_epi32(_mm256_castps_si256(x), 23),
+        _mm256_set1_epi32(127)));
+    __m256 mantissa = _mm256_or_ps(_mm256_and_ps(x, mantissa_bits), one);
+    __m256 large =
+        _mm256_cmp_ps(mantissa, _mm256_set1_ps(TAU_SQRT2), _CMP_GT_OQ);
+    mantissa = _mm256_mul_ps(mantissa,
+                             _mm256_sub_ps(one, _mm256_and_ps(large, half)));
+    exponent = _mm256_add_ps(exponent, _mm256_and_ps(large, one));
+    __m256 t = _mm256_div_ps(_mm256_sub_ps(mantissa, one),
+                             _mm256_add_ps(mantissa, one));
+    __m256 t2 = _mm256_mul_ps(t, t);
+    __m256 series = _mm256_add_ps(_mm256_set1_ps(1.0f / 7),
+                                  _mm256_mul_ps(t2, _mm256_set1_ps(1.0f / 9)));
+    series = _mm256_add_ps(_mm256_set1_ps(1.0f / 5), _mm256_mul_ps(t2, series));
+    series = _mm256_add_ps(_mm256_set1_ps(1.0f / 3), _mm256_mul_ps(t2, series));
+    series = _mm256_add_ps(one, _mm256_mul_ps(t2, series));
+    __m256 decibels = _mm256_mul_ps(
+        _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(t, t), series),
+                      _mm256_mul_ps(exponent, _mm256_set1_ps(TAU_LN2))),
+        _mm256_set1_ps(TAU_DB_PER_NEPER));
+    __m256 tiny = _mm256_cmp_ps(x, _mm256_set1_ps(FLT_MIN), _CMP_LT_OQ);
+    _mm256_storeu_ps(destination + i,
+                     _mm256_blendv_ps(decibels, _mm256_set1_ps(-INFINITY),
+                                      tiny));
+  }
+  for (; i < count; i++) {
+    destination[i] = tau_to_decibels(source[i]);
+  }
+}
+
+// The sections of 8 lanes of a biquad bank, held in registers over every
+// row.
+typedef struct biquad_group_avx2 {
+  __m256 b0;
+  __m256 b1;
+  __m256 b2;
+  __m256 a1;
+  __m256 a2;
+  __m256 s1;
+  __m256 s2;
+  __m256 links;
+  __m256i delays;
+} biquad_group_avx2;
+
+AVX2 static inline void biquad_load_avx2(biquad_group_avx2* v,
+                                         const tau_biquad_lanes* bank,
+                                         int32_t lane) {
+  v->b0 = _mm256_loadu_ps(bank->b0 + lane);
+  v->b1 = _mm256_loadu_ps(bank->b1 + lane);
+  v->b2 = _mm256_loadu_ps(bank->b2 + lane);
+  v->a1 = _mm256_loadu_ps(bank->a1 + lane);
+  v->a2 = _mm256_loadu_ps(bank->a2 + lane);
+  v->s1 = _mm256_loadu_ps(bank->s1 + lane);
+  v->s2 = _mm256_loadu_ps(bank->s2 + lane);
+  v->links = _mm256_castsi256_ps(_mm256_cmpgt_epi32(
+      _mm256_loadu_si256((const __m256i*)(bank->links + lane)),
+      _mm256_setzero_si256()));
+  v->delays = _mm256_loadu_si256((const __m256i*)(bank->delays + lane));
+}
+
+AVX2 static inline void biquad_store_avx2(const biquad_group_avx2* v,
+                                          const tau_biquad_lanes* bank,
+                                          int32_t lane) {
+  _mm256_storeu_ps(bank->s1 + lane, v->s1);
+  _mm256_storeu_ps(bank->s2 + lane, v->s2);
+}
+
+// Filters row `t` of the 8 lanes of `v`, at `row`.
+AVX2 static inline void biquad_row_avx2(biquad_group_avx2* v, float* row,
+                                        int32_t lanes, __m256i t,
+                                        __m256i frames) {
+  __m256i k = _mm256_sub_epi32(t, v->delays);
+  __m256 active = _mm256_castsi256_ps(
+      _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), k),
+                          _mm256_cmpgt_epi32(frames, k)));
+  __m256 x = _mm256_blendv_ps(_mm256_loadu_ps(row),
+                              _mm256_loadu_ps(row - lanes - 1), v->links);
+  __m256 y = _mm256_add_ps(_mm256_mul_ps(v->b0, x), v->s1);
+  __m256 s1 = _mm256_add_ps(
+      _mm256_sub_ps(_mm256_mul_ps(v->b1, x), _mm256_mul_ps(v->a1, y)), v->s2);
+  __m256 s2 = _mm256_sub_ps(_mm256_mul_ps(v->b2, x), _mm256_mul_ps(v->a2, y));
+  v->s1 = _mm256_blendv_ps(v->s1, s1, active);
+  v->s2 = _mm256_blendv_ps(v->s2, s2, active);
+  _mm256_storeu_ps(row, _mm256_and_ps(active, y));
+}
+
+// Lanes run 16 at a time over every row, in two independent groups that
+// hide the latency of the recursion; a group reads what the one before
+// output on the previous row.
+AVX2 static void biquad_avx2(const tau_biquad_lanes* bank, float* signal,
+                             int32_t frames, int32_t rows) {
+  int32_t lanes = bank->lanes;
+  __m256i frame_count = _mm256_set1_epi32(frames);
+  int32_t lane = 0;
+  for (; lane + 16 <= lanes; lane += 16) {
+    biquad_group_avx2 low;
+    biquad_group_avx2 high;
+    biquad_load_avx2(&low, bank, lane);
+    biquad_load_avx2(&high, bank, lane + 8);
+    float* row = signal + lane;
+    for (int32_t t = 0; t < rows; t++, row += lanes) {
+      __m256i index = _mm256_set1_epi32(t);
+      biquad_row_avx2(&low, row, lanes, index, frame_count);
+      biquad_row_avx2(&high, row + 8, lanes, index, frame_count);
+    }
+    biquad_store_avx2(&low, bank, lane);
+    biquad_store_avx2(&high, bank, lane + 8);
+  }
+  for (; lane + 8 <= lanes; lane += 8) {
+    biquad_group_avx2 group;
+    biquad_load_avx2(&group, bank, lane);
+    float* row = signal + lane;
+    for (int32_t t = 0; t < rows; t++, row += lanes) {
+      biquad_row_avx2(&group, row, lanes, _mm256_set1_epi32(t), frame_count);
+    }
+    biquad_store_avx2(&group, bank, lane);
+  }
+  for (; lane < lanes; lane++) {
+    tau_biquad_lane(bank, lane, signal, frames, rows);
+  }
+}
+
+AVX2 static void compressor_gain_avx2(float* destination, const float* levels,
+                                      float threshold, float knee,
+                                      float slope, int32_t count) {
+  __m256 threshold_v = _mm256_set1_ps(threshold);
+  __m256 knee_v = _mm256_set1_ps(knee);
+  __m256 half_knee = _mm256_set1_ps(0.5f * knee);
+  __m256 factor = _mm256_set1_ps(knee > 0.0f ? 0.5f / knee : 0.0f);
+  __m256 slope_v = _mm256_set1_ps(slope);
+  __m256 zero = _mm256_setzero_ps();
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 over = _mm256_sub_ps(_mm256_loadu_ps(levels + i), threshold_v);
+    __m256 inside = _mm256_max_ps(
+        _mm256_min_ps(_mm256_add_ps(over, half_knee), knee_v), zero);
+    __m256 above = _mm256_max_ps(_mm256_sub_ps(over, half_knee), zero);
+    __m256 curve = _mm256_mul_ps(_mm256_mul_ps(inside, inside), factor);
+    _mm256_storeu_ps(destination + i,
+                     _mm256_mul_ps(slope_v, _mm256_add_ps(curve, above)));
+  }
+  for (; i < count; i++) {
+    destination[i] = tau_compressor_gain(levels[i], threshold, knee, slope);
+  }
+}
+
+AVX2 static void amplitudes_avx2(float* destination, const float* decibels,
+                                 int32_t count) {
+  __m256 low = _mm256_set1_ps(-126.0f);
+  __m256 high = _mm256_set1_ps(127.0f);
+  __m256 one = _mm256_set1_ps(1.0f);
+  int32_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 x = _mm256_mul_ps(_mm256_loadu_ps(decibels + i),
+                             _mm256_set1_ps(TAU_LOG2_10_PER_20));
+    __m256 audible = _mm256_cmp_ps(x, low, _CMP_GE_OQ);
+    x = _mm256_min_ps(_mm256_max_ps(x, low), high);
+    // `floor(x + 0.5)`, from the truncation, one less where it rounded up.
+    __m256 half = _mm256_add_ps(x, _mm256_set1_ps(0.5f));
+    __m256i n = _mm256_cvttps_epi32(half);
+    __m256 rounded_up =
+        _mm256_cmp_ps(_mm256_cvtepi32_ps(n), half, _CMP_GT_OQ);
+    n = _mm256_add_epi32(n, _mm256_castps_si256(rounded_up));
+    __m256 f = _mm256_sub_ps(x, _mm256_cvtepi32_ps(n));
+    __m256 p = _mm256_set1_ps(TAU_EXP2_C6);
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(TAU_EXP2_C5));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(TAU_EXP2_C4));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(TAU_EXP2_C3));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(TAU_EXP2_C2));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(TAU_EXP2_C1));
+    __m256 scale = _mm256_castsi256_ps(
+        _mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127)), 23));
+    __m256 y =
+        _mm256_mul_ps(_mm256_add_ps(one, _mm256_mul_ps(f, p)), scale);
+    _mm256_storeu_ps(destination + i, _mm256_and_ps(audible, y));
+  }
+  for (; i < count; i++) {
+    destination[i] = tau_to_amplitude(decibels[i]);
+  }
+}
+
+const tau_kernel_table tau_kernels_avx2 = {
+    "avx2",
+    scale_avx2,
+    add_avx2,
+    scale_add_avx2,
+    multiply_avx2,
+    multiply_add_avx2,
+    clip_avx2,
+    complex_multiply_add_avx2,
+    butterfly_avx2,
+    blend_dot_avx2,
+    ramp_avx2,
+    geometric_avx2,
+    smooth_magnitude_avx2,
+    decibels_avx2,
+    biquad_avx2,
+    compressor_gain_avx2,
+    amplitudes_avx2,
+};
+#endif  // TAU_KERNELS_X86
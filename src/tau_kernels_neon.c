@@ -0,0 +1,427 @@
+#include "tau_kernels.h"
+
+#if TAU_KERNELS_NEON
+#if defined(_M_ARM64)
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+
+static void scale_neon(float* destination, const float* source, float gain,
+                       int32_t count) {
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(destination + i, vmulq_n_f32(vld1q_f32(source + i), gain));
+  }
+  for (; i < count; i++) {
+    destination[i] = source[i] * gain;
+  }
+}
+
+static void add_neon(float* destination, const float* source, int32_t count) {
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(destination + i,
+              vaddq_f32(vld1q_f32(destination + i), vld1q_f32(source + i)));
+  }
+  for (; i < count; i++) {
+    destination[i] += source[i];
+  }
+}
+
+// Multiplications and additions stay separate instructions: a fused
+// multiply-add would round differently from the other versions.
+static void scale_add_neon(float* destination, const float* source,
+                           float gain, int32_t count) {
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t product = vmulq_n_f32(vld1q_f32(source + i), gain);
+    vst1q_f32(destination + i, vaddq_f32(vld1q_f32(destination + i), product));
+  }
+  for (; i < count; i++) {
+    destination[i] += source[i] * gain;
+  }
+}
+
+static void multiply_neon(float* destination, const float* source,
+                          const float* gains, int32_t count) {
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(destination + i,
+              vmulq_f32(vld1q_f32(source + i), vld1q_f32(gains + i)));
+  }
+  for (; i < count; i++) {
+    destination[i] = source[i] * gains[i];
+  }
+}
+
+static void multiply_add_neon(float* destination, const float* source,
+                              const float* gains, int32_t count) {
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t product =
+        vmulq_f32(vld1q_f32(source + i), vld1q_f32(gains + i));
+    vst1q_f32(destination + i, vaddq_f32(vld1q_f32(destination + i), product));
+  }
+  for (; i < count; i++) {
+    destination[i] += source[i] * gains[i];
+  }
+}
+
+static void clip_neon(float* destination, const float* source, float low,
+                      float high, int32_t count) {
+  float32x4_t lows = vdupq_n_f32(low);
+  float32x4_t highs = vdupq_n_f32(high);
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t sample = vmaxq_f32(lows, vld1q_f32(source + i));
+    vst1q_f32(destination + i, vminq_f32(highs, sample));
+  }
+  for (; i < count; i++) {
+    float sample = source[i];
+    sample = sample < low ? low : sample;
+    destination[i] = sample > high ? high : sample;
+  }
+}
+
+static void complex_multiply_add_neon(float* re, float* im,
+                                      const float* a_re, const float* a_im,
+                                      const float* b_re, const float* b_im,
+                                      int32_t count) {
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t ar = vld1q_f32(a_re + i);
+    float32x4_t ai = vld1q_f32(a_im + i);
+    float32x4_t br = vld1q_f32(b_re + i);
+    float32x4_t bi = vld1q_f32(b_im + i);
+    float32x4_t product_re = vsubq_f32(vmulq_f32(ar, br), vmulq_f32(ai, bi));
+    float32x4_t product_im = vaddq_f32(vmulq_f32(ar, bi), vmulq_f32(ai, br));
+    vst1q_f32(re + i, vaddq_f32(vld1q_f32(re + i), product_re));
+    vst1q_f32(im + i, vaddq_f32(vld1q_f32(im + i), product_im));
+  }
+  for (; i < count; i++) {
+    re[i] += a_re[i] * b_re[i] - a_im[i] * b_im[i];
+    im[i] += a_re[i] * b_im[i] + a_im[i] * b_re[i];
+  }
+}
+
+static void butterfly_neon(float* re, float* im,
+                           const float* twiddle_re,
+                           const float* twiddle_im, int32_t half) {
+  int32_t j = 0;
+  for (; j + 4 <= half; j += 4) {
+    float32x4_t wr = vld1q_f32(twiddle_re + j);
+    float32x4_t wi = vld1q_f32(twiddle_im + j);
+    float32x4_t odd_re = vld1q_f32(re + j + half);
+    float32x4_t odd_im = vld1q_f32(im + j + half);
+    float32x4_t x_re = vsubq_f32(vmulq_f32(odd_re, wr), vmulq_f32(odd_im, wi));
+    float32x4_t x_im = vaddq_f32(vmulq_f32(odd_re, wi), vmulq_f32(odd_im, wr));
+    float32x4_t even_re = vld1q_f32(re + j);
+    float32x4_t even_im = vld1q_f32(im + j);
+    vst1q_f32(re + j + half, vsubq_f32(even_re, x_re));
+    vst1q_f32(im + j + half, vsubq_f32(even_im, x_im));
+    vst1q_f32(re + j, vaddq_f32(even_re, x_re));
+    vst1q_f32(im + j, vaddq_f32(even_im, x_im));
+  }
+  for (; j < half; j++) {
+    float x_re = re[j + half] * twiddle_re[j] - im[j + half] * twiddle_im[j];
+    float x_im = re[j + half] * twiddle_im[j] + im[j + half] * twiddle_re[j];
+    re[j + half] = re[j] - x_re;
+    im[j + half] = im[j] - x_im;
+    re[j] += x_re;
+    im[j] += x_im;
+  }
+}
+
+// Two sums hide the latency of the additions.
+static float blend_dot_neon(const float* x, const float* a, const float* b,
+                            float blend, int32_t count) {
+  float32x4_t sums[2] = {vdupq_n_f32(0.0f), vdupq_n_f32(0.0f)};
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t low = vld1q_f32(a + i);
+    float32x4_t high = vld1q_f32(b + i);
+    float32x4_t coefficient =
+        vaddq_f32(low, vmulq_n_f32(vsubq_f32(high, low), blend));
+    sums[(i >> 2) & 1] = vaddq_f32(sums[(i >> 2) & 1],
+                                   vmulq_f32(vld1q_f32(x + i), coefficient));
+  }
+  float32x4_t both = vaddq_f32(sums[0], sums[1]);
+  float32x2_t pair = vadd_f32(vget_low_f32(both), vget_high_f32(both));
+  float sum = vget_lane_f32(vpadd_f32(pair, pair), 0);
+  for (; i < count; i++) {
+    sum += x[i] * (a[i] + (b[i] - a[i]) * blend);
+  }
+  return sum;
+}
+
+static void ramp_neon(float* destination, float start, float step,
+                      int32_t count) {
+  static const float first[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+  float32x4_t starts = vdupq_n_f32(start);
+  float32x4_t index = vld1q_f32(first);
+  float32x4_t four = vdupq_n_f32(4.0f);
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(destination + i, vaddq_f32(starts, vmulq_n_f32(index, step)));
+    index = vaddq_f32(index, four);
+  }
+  for (; i < count; i++) {
+    destination[i] = start + step * (float)i;
+  }
+}
+
+// Each lane steps by `ratio^4`.
+static void geometric_neon(float* destination, float offset, float scale,
+                           float ratio, int32_t count) {
+  float square = ratio * ratio;
+  float first[4] = {scale, scale * ratio, scale * square,
+                    scale * (square * ratio)};
+  float32x4_t offsets = vdupq_n_f32(offset);
+  float32x4_t powers = vld1q_f32(first);
+  float stride = square * square;
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(destination + i, vaddq_f32(offsets, powers));
+    powers = vmulq_n_f32(powers, stride);
+  }
+  scale = vgetq_lane_f32(powers, 0);
+  for (; i < count; i++) {
+    destination[i] = offset + scale;
+    scale *= ratio;
+  }
+}
+
+static void smooth_magnitude_neon(float* smoothed, const float* re,
+                                  const float* im, float scale,
+                                  float smoothing, int32_t count) {
+  float weight = (1.0f - smoothing) * scale;
+  int32_t i = 0;
+#if defined(__aarch64__) || defined(_M_ARM64)
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t x_re = vld1q_f32(re + i);
+    float32x4_t x_im = vld1q_f32(im + i);
+    float32x4_t magnitude = vsqrtq_f32(
+        vaddq_f32(vmulq_f32(x_re, x_re), vmulq_f32(x_im, x_im)));
+    vst1q_f32(smoothed + i,
+              vaddq_f32(vmulq_n_f32(vld1q_f32(smoothed + i), smoothing),
+                        vmulq_n_f32(magnitude, weight)));
+  }
+#endif
+  // 32-bit ARM has no vector square root.
+  for (; i < count; i++) {
+    smoothed[i] = smoothing * smoothed[i] +
+                  weight * sqrtf(re[i] * re[i] + im[i] * im[i]);
+  }
+}
+
+static void decibels_neon(float* destination, const float* source,
+                          int32_t count) {
+  float32x4_t one = vdupq_n_f32(1.0f);
+  uint32x4_t mantissa_bits = vdupq_n_u32(0x7FFFFF);
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t x = vld1q_f32(source + i);
+    uint32x4_t bits = vreinterpretq_u32_f32(x);
+    float32x4_t exponent = vcvtq_f32_s32(vsubq_s32(
+        vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(127)));
+    float32x4_t mantissa = vreinterpretq_f32_u32(
+        vorrq_u32(vandq_u32(bits, mantissa_bits), vreinterpretq_u32_f32(one)));
+    uint32x4_t large = vcgtq_f32(mantissa, vdupq_n_f32(TAU_SQRT2));
+    mantissa = vbslq_f32(large, vmulq_n_f32(mantissa, 0.5f), mantissa);
+    exponent = vbslq_f32(large, vaddq_f32(exponent, one), exponent);
+    float32x4_t numerator = vsubq_f32(mantissa, one);
+    float32x4_t denominator = vaddq_f32(mantissa, one);
+#if defined(__aarch64__) || defined(_M_ARM64)
+    float32x4_t t = vdivq_f32(numerator, denominator);
+#else
+    // Two Newton steps refine the reciprocal estimate to float precision.
+    float32x4_t reciprocal = vrecpeq_f32(denominator);
+    reciprocal = vmulq_f32(vrecpsq_f32(denominator, reciprocal), reciprocal);
+    reciprocal = vmulq_f32(vrecpsq_f32(denominator, reciprocal), reciprocal);
+    float32x4_t t = vmulq_f32(numerator, reciprocal);
+#endif
+    float32x4_t t2 = vmulq_f32(t, t);
+    float32x4_t series =
+        vaddq_f32(vdupq_n_f32(1.0f / 7), vmulq_n_f32(t2, 1.0f / 9));
+    series = vaddq_f32(vdupq_n_f32(1.0f / 5), vmulq_f32(t2, series));
+    series = vaddq_f32(vdupq_n_f32(1.0f / 3), vmulq_f32(t2, series));
+    series = vaddq_f32(one, vmulq_f32(t2, series));
+    float32x4_t decibels = vmulq_n_f32(
+        vaddq_f32(vmulq_f32(vaddq_f32(t, t), series),
+                  vmulq_n_f32(exponent, TAU_LN2)),
+        TAU_DB_PER_NEPER);
+    uint32x4_t tiny = vcltq_f32(x, vdupq_n_f32(FLT_MIN));
+    vst1q_f32(destination + i,
+              vbslq_f32(tiny, vdupq_n_f32(-INFINITY), decibels));
+  }
+  for (; i < count; i++) {
+    destination[i] = tau_to_decibels(source[i]);
+  }
+}
+
+// The sections of 4 lanes of a biquad bank, held in registers over every
+// row.
+typedef struct biquad_group_neon {
+  float32x4_t b0;
+  float32x4_t b1;
+  float32x4_t b2;
+  float32x4_t a1;
+  float32x4_t a2;
+  float32x4_t s1;
+  float32x4_t s2;
+  uint32x4_t links;
+  int32x4_t delays;
+} biquad_group_neon;
+
+static inline void biquad_load_neon(biquad_group_neon* v,
+                                    const tau_biquad_lanes* bank,
+                                    int32_t lane) {
+  v->b0 = vld1q_f32(bank->b0 + lane);
+  v->b1 = vld1q_f32(bank->b1 + lane);
+  v->b2 = vld1q_f32(bank->b2 + lane);
+  v->a1 = vld1q_f32(bank->a1 + lane);
+  v->a2 = vld1q_f32(bank->a2 + lane);
+  v->s1 = vld1q_f32(bank->s1 + lane);
+  v->s2 = vld1q_f32(bank->s2 + lane);
+  v->links = vcgtq_s32(vld1q_s32(bank->links + lane), vdupq_n_s32(0));
+  v->delays = vld1q_s32(bank->delays + lane);
+}
+
+static inline void biquad_store_neon(const biquad_group_neon* v,
+                                     const tau_biquad_lanes* bank,
+                                     int32_t lane) {
+  vst1q_f32(bank->s1 + lane, v->s1);
+  vst1q_f32(bank->s2 + lane, v->s2);
+}
+
+// Filters row `t` of the 4 lanes of `v`, at `row`.
+static inline void biquad_row_neon(biquad_group_neon* v, float* row,
+                                   int32_t lanes, int32x4_t t,
+                                   uint32x4_t frames) {
+  uint32x4_t active =
+      vcltq_u32(vreinterpretq_u32_s32(vsubq_s32(t, v->delays)), frames);
+  float32x4_t x =
+      vbslq_f32(v->links, vld1q_f32(row - lanes - 1), vld1q_f32(row));
+  float32x4_t y = vaddq_f32(vmulq_f32(v->b0, x), v->s1);
+  float32x4_t s1 = vaddq_f32(
+      vsubq_f32(vmulq_f32(v->b1, x), vmulq_f32(v->a1, y)), v->s2);
+  float32x4_t s2 = vsubq_f32(vmulq_f32(v->b2, x), vmulq_f32(v->a2, y));
+  v->s1 = vbslq_f32(active, s1, v->s1);
+  v->s2 = vbslq_f32(active, s2, v->s2);
+  vst1q_f32(row, vreinterpretq_f32_u32(
+                     vandq_u32(active, vreinterpretq_u32_f32(y))));
+}
+
+// Lanes run 8 at a time over every row, in two independent groups that hide
+// the latency of the recursion; a group reads what the one before output
+// on the previous row.
+static void biquad_neon(const tau_biquad_lanes* bank, float* signal,
+                        int32_t frames, int32_t rows) {
+  int32_t lanes = bank->lanes;
+  uint32x4_t frame_count = vdupq_n_u32((uint32_t)frames);
+  int32_t lane = 0;
+  for (; lane + 8 <= lanes; lane += 8) {
+    biquad_group_neon low;
+    biquad_group_neon high;
+    biquad_load_neon(&low, bank, lane);
+    biquad_load_neon(&high, bank, lane + 4);
+    float* row = signal + lane;
+    for (int32_t t = 0; t < rows; t++, row += lanes) {
+      int32x4_t index = vdupq_n_s32(t);
+      biquad_row_neon(&low, row, lanes, index, frame_count);
+      biquad_row_neon(&high, row + 4, lanes, index, frame_count);
+    }
+    biquad_store_neon(&low, bank, lane);
+    biquad_store_neon(&high, bank, lane + 4);
+  }
+  for (; lane + 4 <= lanes; lane += 4) {
+    biquad_group_neon group;
+    biquad_load_neon(&group, bank, lane);
+    float* row = signal + lane;
+    for (int32_t t = 0; t < rows; t++, row += lanes) {
+      biquad_row_neon(&group, row, lanes, vdupq_n_s32(t), frame_count);
+    }
+    biquad_store_neon(&group, bank, lane);
+  }
+  for (; lane < lanes; lane++) {
+    tau_biquad_lane(bank, lane, signal, frames, rows);
+  }
+}
+
+static void compressor_gain_neon(float* destination, const float* levels,
+                                 float threshold, float knee, float slope,
+                                 int32_t count) {
+  float32x4_t threshold_v = vdupq_n_f32(threshold);
+  float32x4_t knee_v = vdupq_n_f32(knee);
+  float32x4_t half_knee = vdupq_n_f32(0.5f * knee);
+  float32x4_t zero = vdupq_n_f32(0.0f);
+  float factor = knee > 0.0f ? 0.5f / knee : 0.0f;
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t over = vsubq_f32(vld1q_f32(levels + i), threshold_v);
+    float32x4_t inside =
+        vmaxq_f32(vminq_f32(vaddq_f32(over, half_knee), knee_v), zero);
+    float32x4_t above = vmaxq_f32(vsubq_f32(over, half_knee), zero);
+    float32x4_t curve = vmulq_n_f32(vmulq_f32(inside, inside), factor);
+    vst1q_f32(destination + i, vmulq_n_f32(vaddq_f32(curve, above), slope));
+  }
+  for (; i < count; i++) {
+    destination[i] = tau_compressor_gain(levels[i], threshold, knee, slope);
+  }
+}
+
+static void amplitudes_neon(float* destination, const float* decibels,
+                            int32_t count) {
+  float32x4_t low = vdupq_n_f32(-126.0f);
+  float32x4_t high = vdupq_n_f32(127.0f);
+  float32x4_t one = vdupq_n_f32(1.0f);
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t x = vmulq_n_f32(vld1q_f32(decibels + i), TAU_LOG2_10_PER_20);
+    uint32x4_t audible = vcgeq_f32(x, low);
+    x = vminq_f32(vmaxq_f32(x, low), high);
+    // `floor(x + 0.5)`, from the truncation, one less where it rounded up.
+    float32x4_t half = vaddq_f32(x, vdupq_n_f32(0.5f));
+    int32x4_t n = vcvtq_s32_f32(half);
+    uint32x4_t rounded_up = vcgtq_f32(vcvtq_f32_s32(n), half);
+    n = vaddq_s32(n, vreinterpretq_s32_u32(rounded_up));
+    float32x4_t f = vsubq_f32(x, vcvtq_f32_s32(n));
+    float32x4_t p = vdupq_n_f32(TAU_EXP2_C6);
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(TAU_EXP2_C5));
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(TAU_EXP2_C4));
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(TAU_EXP2_C3));
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(TAU_EXP2_C2));
+    p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(TAU_EXP2_C1));
+    float32x4_t scale = vreinterpretq_f32_s32(
+        vshlq_n_s32(vaddq_s32(n, vdupq_n_s32(127)), 23));
+    float32x4_t y = vmulq_f32(vaddq_f32(one, vmulq_f32(f, p)), scale);
+    vst1q_f32(destination + i,
+              vreinterpretq_f32_u32(
+                  vandq_u32(audible, vreinterpretq_u32_f32(y))));
+  }
+  for (; i < count; i++) {
+    destination[i] = tau_to_amplitude(decibels[i]);
+  }
+}
+
+const tau_kernel_table tau_kernels_neon = {
+    "neon",
+    scale_neon,
+    add_neon,
+    scale_add_neon,
+    multiply_neon,
+    multiply_add_neon,
+    clip_neon,
+    complex_multiply_add_neon,
+    butterfly_neon,
+    blend_dot_neon,
+    ramp_neon,
+    geometric_neon,
+    smooth_magnitude_neon,
+    decibels_neon,
+    biquad_neon,
+    compressor_gain_neon,
+    amplitudes_neon,
+};
+#endif  // TAU_KERNELS_NEON
@@ -0,0 +1,432 @@
+#include "tau_kernels.h"
+
+#if TAU_KERNELS_X86
+#include <emmintrin.h>
+
+#define SSE2 TAU_TARGET("sse2")
+
+SSE2 static void scale_sse2(float* destination, const float* source,
+                            float gain, int32_t count) {
+  __m128 factor = _mm_set1_ps(gain);
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_ps(destination + i,
+                  _mm_mul_ps(_mm_loadu_ps(source + i), factor));
+  }
+  for (; i < count; i++) {
+    destination[i] = source[i] * gain;
+  }
+}
+
+SSE2 static void add_sse2(float* destination, const float* source,
+                          int32_t count) {
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i),
+                                              _mm_loadu_ps(source + i)));
+  }
+  for (; i < count; i++) {
+    destination[i] += source[i];
+  }
+}
+
+SSE2 static void scale_add_sse2(float* destination, const float* source,
+                                float gain, int32_t count) {
+  __m128 factor = _mm_set1_ps(gain);
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 product = _mm_mul_ps(_mm_loadu_ps(source + i), factor);
+    _mm_storeu_ps(destination + i,
+                  _mm_add_ps(_mm_loadu_ps(destination + i), product));
+  }
+  for (; i < count; i++) {
+    destination[i] += source[i] * gain;
+  }
+}
+
+SSE2 static void multiply_sse2(float* destination, const float* source,
+                               const float* gains, int32_t count) {
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_ps(destination + i, _mm_mul_ps(_mm_loadu_ps(source + i),
+                                              _mm_loadu_ps(gains + i)));
+  }
+  for (; i < count; i++) {
+    destination[i] = source[i] * gains[i];
+  }
+}
+
+SSE2 static void multiply_add_sse2(float* destination, const float* source,
+                                   const float* gains, int32_t count) {
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 product =
+        _mm_mul_ps(_mm_loadu_ps(source + i), _mm_loadu_ps(gains + i));
+    _mm_storeu_ps(destination + i,
+                  _mm_add_ps(_mm_loadu_ps(destination + i), product));
+  }
+  for (; i < count; i++) {
+    destination[i] += source[i] * gains[i];
+  }
+}
+
+// `max(low, x)` and `min(high, x)` return `x` when it is NaN, as the scalar
+// comparisons do.
+SSE2 static void clip_sse2(float* destination, const float* source, float low,
+                           float high, int32_t count) {
+  __m128 lows = _mm_set1_ps(low);
+  __m128 highs = _mm_set1_ps(high);
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 sample = _mm_max_ps(lows, _mm_loadu_ps(source + i));
+    _mm_storeu_ps(destination + i, _mm_min_ps(highs, sample));
+  }
+  for (; i < count; i++) {
+    float sample = source[i];
+    sample = sample < low ? low : sample;
+    destination[i] = sample > high ? high : sample;
+  }
+}
+
+SSE2 static void complex_multiply_add_sse2(float* re, float* im,
+                                           const float* a_re, const float* a_im,
+                                           const float* b_re, const float* b_im,
+                                           int32_t count) {
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 ar = _mm_loadu_ps(a_re + i);
+    __m128 ai = _mm_loadu_ps(a_im + i);
+    __m128 br = _mm_loadu_ps(b_re + i);
+    __m128 bi = _mm_loadu_ps(b_im + i);
+    __m128 product_re = _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi));
+    __m128 product_im = _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br));
+    _mm_storeu_ps(re + i, _mm_add_ps(_mm_loadu_ps(re + i), product_re));
+    _mm_storeu_ps(im + i, _mm_add_ps(_mm_loadu_ps(im + i), product_im));
+  }
+  for (; i < count; i++) {
+    re[i] += a_re[i] * b_re[i] - a_im[i] * b_im[i];
+    im[i] += a_re[i] * b_im[i] + a_im[i] * b_re[i];
+  }
+}
+
+SSE2 static void butterfly_sse2(float* re, float* im,
+                                const float* twiddle_re,
+                                const float* twiddle_im, int32_t half) {
+  int32_t j = 0;
+  for (; j + 4 <= half; j += 4) {
+    __m128 wr = _mm_loadu_ps(twiddle_re + j);
+    __m128 wi = _mm_loadu_ps(twiddle_im + j);
+    __m128 odd_re = _mm_loadu_ps(re + j + half);
+    __m128 odd_im = _mm_loadu_ps(im + j + half);
+    __m128 x_re = _mm_sub_ps(_mm_mul_ps(odd_re, wr), _mm_mul_ps(odd_im, wi));
+    __m128 x_im = _mm_add_ps(_mm_mul_ps(odd_re, wi), _mm_mul_ps(odd_im, wr));
+    __m128 even_re = _mm_loadu_ps(re + j);
+    __m128 even_im = _mm_loadu_ps(im + j);
+    _mm_storeu_ps(re + j + half, _mm_sub_ps(even_re, x_re));
+    _mm_storeu_ps(im + j + half, _mm_sub_ps(even_im, x_im));
+    _mm_storeu_ps(re + j, _mm_add_ps(even_re, x_re));
+    _mm_storeu_ps(im + j, _mm_add_ps(even_im, x_im));
+  }
+  for (; j < half; j++) {
+    float x_re = re[j + half] * twiddle_re[j] - im[j + half] * twiddle_im[j];
+    float x_im = re[j + half] * twiddle_im[j] + im[j + half] * twiddle_re[j];
+    re[j + half] = re[j] - x_re;
+    im[j + half] = im[j] - x_im;
+    re[j] += x_re;
+    im[j] += x_im;
+  }
+}
+
+// Two sums hide the latency of the additions.
+SSE2 static float blend_dot_sse2(const float* x, const float* a,
+                                 const float* b, float blend, int32_t count) {
+  __m128 factor = _mm_set1_ps(blend);
+  __m128 sums[2] = {_mm_setzero_ps(), _mm_setzero_ps()};
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 low = _mm_loadu_ps(a + i);
+    __m128 high = _mm_loadu_ps(b + i);
+    __m128 coefficient =
+        _mm_add_ps(low, _mm_mul_ps(_mm_sub_ps(high, low), factor));
+    sums[(i >> 2) & 1] = _mm_add_ps(
+        sums[(i >> 2) & 1], _mm_mul_ps(_mm_loadu_ps(x + i), coefficient));
+  }
+  __m128 total = _mm_add_ps(sums[0], sums[1]);
+  total = _mm_add_ps(total, _mm_movehl_ps(total, total));
+  total = _mm_add_ss(total, _mm_shuffle_ps(total, total, 1));
+  float sum = _mm_cvtss_f32(total);
+  for (; i < count; i++) {
+    sum += x[i] * (a[i] + (b[i] - a[i]) * blend);
+  }
+  return sum;
+}
+
+SSE2 static void ramp_sse2(float* destination, float start, float step,
+                           int32_t count) {
+  __m128 starts = _mm_set1_ps(start);
+  __m128 steps = _mm_set1_ps(step);
+  __m128 index = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+  __m128 four = _mm_set1_ps(4.0f);
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_ps(destination + i,
+                  _mm_add_ps(starts, _mm_mul_ps(steps, index)));
+    index = _mm_add_ps(index, four);
+  }
+  for (; i < count; i++) {
+    destination[i] = start + step * (float)i;
+  }
+}
+
+// Each lane steps by `ratio^4`.
+SSE2 static void geometric_sse2(float* destination, float offset, float scale,
+                                float ratio, int32_t count) {
+  float square = ratio * ratio;
+  __m128 offsets = _mm_set1_ps(offset);
+  __m128 powers =
+      _mm_mul_ps(_mm_set1_ps(scale),
+                 _mm_setr_ps(1.0f, ratio, square, square * ratio));
+  __m128 stride = _mm_set1_ps(square * square);
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_ps(destination + i, _mm_add_ps(offsets, powers));
+    powers = _mm_mul_ps(powers, stride);
+  }
+  scale = _mm_cvtss_f32(powers);
+  for (; i < count; i++) {
+    destination[i] = offset + scale;
+    scale *= ratio;
+  }
+}
+
+SSE2 static void smooth_magnitude_sse2(float* smoothed, const float* re,
+                                       const float* im, float scale,
+                                       float smoothing, int32_t count) {
+  float weight = (1.0f - smoothing) * scale;
+  __m128 smoothings = _mm_set1_ps(smoothing);
+  __m128 weights = _mm_set1_ps(weight);
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 x_re = _mm_loadu_ps(re + i);
+    __m128 x_im = _mm_loadu_ps(im + i);
+    __m128 magnitude = _mm_sqrt_ps(
+        _mm_add_ps(_mm_mul_ps(x_re, x_re), _mm_mul_ps(x_im, x_im)));
+    _mm_storeu_ps(smoothed + i,
+                  _mm_add_ps(_mm_mul_ps(smoothings, _mm_loadu_ps(smoothed + i)),
+                             _mm_mul_ps(weights, magnitude)));
+  }
+  for (; i < count; i++) {
+    smoothed[i] = smoothing * smoothed[i] +
+                  weight * sqrtf(re[i] * re[i] + im[i] * im[i]);
+  }
+}
+
+SSE2 static void decibels_sse2(float* destination, const float* source,
+                               int32_t count) {
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 mantissa_bits = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFF));
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 x = _mm_loadu_ps(source + i);
+    __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(
+        _mm_srli_epi32(_mm_castps_si128(x), 23), _mm_set1_epi32(127)));
+    __m128 mantissa = _mm_or_ps(_mm_and_ps(x, mantissa_bits), one);
+    __m128 large = _mm_cmpgt_ps(mantissa, _mm_set1_ps(TAU_SQRT2));
+    mantissa = _mm_mul_ps(mantissa, _mm_sub_ps(one, _mm_and_ps(large, half)));
+    exponent = _mm_add_ps(exponent, _mm_and_ps(large, one));
+    __m128 t = _mm_div_ps(_mm_sub_ps(mantissa, one), _mm_add_ps(mantissa, one));
+    __m128 t2 = _mm_mul_ps(t, t);
+    __m128 series = _mm_add_ps(_mm_set1_ps(1.0f / 7),
+                               _mm_mul_ps(t2, _mm_set1_ps(1.0f / 9)));
+    series = _mm_add_ps(_mm_set1_ps(1.0f / 5), _mm_mul_ps(t2, series));
+    series = _mm_add_ps(_mm_set1_ps(1.0f / 3), _mm_mul_ps(t2, series));
+    series = _mm_add_ps(one, _mm_mul_ps(t2, series));
+    __m128 decibels = _mm_mul_ps(
+        _mm_add_ps(_mm_mul_ps(_mm_add_ps(t, t), series),
+                   _mm_mul_ps(exponent, _mm_set1_ps(TAU_LN2))),
+        _mm_set1_ps(TAU_DB_PER_NEPER));
+    __m128 tiny = _mm_cmplt_ps(x, _mm_set1_ps(FLT_MIN));
+    _mm_storeu_ps(destination + i,
+                  _mm_or_ps(_mm_and_ps(tiny, _mm_set1_ps(-INFINITY)),
+                            _mm_andnot_ps(tiny, decibels)));
+  }
+  for (; i < count; i++) {
+    destination[i] = tau_to_decibels(source[i]);
+  }
+}
+
+// The sections of 4 lanes of a biquad bank, held in registers over every
+// row.
+typedef struct biquad_group_sse2 {
+  __m128 b0;
+  __m128 b1;
+  __m128 b2;
+  __m128 a1;
+  __m128 a2;
+  __m128 s1;
+  __m128 s2;
+  __m128 links;
+  __m128i delays;
+} biquad_group_sse2;
+
+SSE2 static inline void biquad_load_sse2(biquad_group_sse2* v,
+                                         const tau_biquad_lanes* bank,
+                                         int32_t lane) {
+  v->b0 = _mm_loadu_ps(bank->b0 + lane);
+  v->b1 = _mm_loadu_ps(bank->b1 + lane);
+  v->b2 = _mm_loadu_ps(bank->b2 + lane);
+  v->a1 = _mm_loadu_ps(bank->a1 + lane);
+  v->a2 = _mm_loadu_ps(bank->a2 + lane);
+  v->s1 = _mm_loadu_ps(bank->s1 + lane);
+  v->s2 = _mm_loadu_ps(bank->s2 + lane);
+  v->links = _mm_castsi128_ps(_mm_cmpgt_epi32(
+      _mm_loadu_si128((const __m128i*)(bank->links + lane)),
+      _mm_setzero_si128()));
+  v->delays = _mm_loadu_si128((const __m128i*)(bank->delays + lane));
+}
+
+SSE2 static inline void biquad_store_sse2(const biquad_group_sse2* v,
+                                          const tau_biquad_lanes* bank,
+                                          int32_t lane) {
+  _mm_storeu_ps(bank->s1 + lane, v->s1);
+  _mm_storeu_ps(bank->s2 + lane, v->s2);
+}
+
+// `a` where `mask` is set, and `b` elsewhere.
+SSE2 static inline __m128 select_sse2(__m128 mask, __m128 a, __m128 b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Filters row `t` of the 4 lanes of `v`, at `row`.
+SSE2 static inline void biquad_row_sse2(biquad_group_sse2* v, float* row,
+                                        int32_t lanes, __m128i t,
+                                        __m128i frames) {
+  __m128i k = _mm_sub_epi32(t, v->delays);
+  __m128 active = _mm_castsi128_ps(
+      _mm_andnot_si128(_mm_cmplt_epi32(k, _mm_setzero_si128()),
+                       _mm_cmplt_epi32(k, frames)));
+  __m128 x = select_sse2(v->links, _mm_loadu_ps(row - lanes - 1),
+                         _mm_loadu_ps(row));
+  __m128 y = _mm_add_ps(_mm_mul_ps(v->b0, x), v->s1);
+  __m128 s1 = _mm_add_ps(
+      _mm_sub_ps(_mm_mul_ps(v->b1, x), _mm_mul_ps(v->a1, y)), v->s2);
+  __m128 s2 = _mm_sub_ps(_mm_mul_ps(v->b2, x), _mm_mul_ps(v->a2, y));
+  v->s1 = select_sse2(active, s1, v->s1);
+  v->s2 = select_sse2(active, s2, v->s2);
+  _mm_storeu_ps(row, _mm_and_ps(active, y));
+}
+
+// Lanes run 8 at a time over every row, in two independent groups that hide
+// the latency of the recursion; a group reads what the one before output
+// on the previous row.
+SSE2 static void biquad_sse2(const tau_biquad_lanes* bank, float* signal,
+                             int32_t frames, int32_t rows) {
+  int32_t lanes = bank->lanes;
+  __m128i frame_count = _mm_set1_epi32(frames);
+  int32_t lane = 0;
+  for (; lane + 8 <= lanes; lane += 8) {
+    biquad_group_sse2 low;
+    biquad_group_sse2 high;
+    biquad_load_sse2(&low, bank, lane);
+    biquad_load_sse2(&high, bank, lane + 4);
+    float* row = signal + lane;
+    for (int32_t t = 0; t < rows; t++, row += lanes) {
+      __m128i index = _mm_set1_epi32(t);
+      biquad_row_sse2(&low, row, lanes, index, frame_count);
+      biquad_row_sse2(&high, row + 4, lanes, index, frame_count);
+    }
+    biquad_store_sse2(&low, bank, lane);
+    biquad_store_sse2(&high, bank, lane + 4);
+  }
+  for (; lane + 4 <= lanes; lane += 4) {
+    biquad_group_sse2 group;
+    biquad_load_sse2(&group, bank, lane);
+    float* row = signal + lane;
+    for (int32_t t = 0; t < rows; t++, row += lanes) {
+      biquad_row_sse2(&group, row, lanes, _mm_set1_epi32(t), frame_count);
+    }
+    biquad_store_sse2(&group, bank, lane);
+  }
+  for (; lane < lanes; lane++) {
+    tau_biquad_lane(bank, lane, signal, frames, rows);
+  }
+}
+
+SSE2 static void compressor_gain_sse2(float* destination, const float* levels,
+                                      float threshold, float knee,
+                                      float slope, int32_t count) {
+  __m128 threshold_v = _mm_set1_ps(threshold);
+  __m128 knee_v = _mm_set1_ps(knee);
+  __m128 half_knee = _mm_set1_ps(0.5f * knee);
+  __m128 factor = _mm_set1_ps(knee > 0.0f ? 0.5f / knee : 0.0f);
+  __m128 slope_v = _mm_set1_ps(slope);
+  __m128 zero = _mm_setzero_ps();
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 over = _mm_sub_ps(_mm_loadu_ps(levels + i), threshold_v);
+    __m128 inside = _mm_max_ps(
+        _mm_min_ps(_mm_add_ps(over, half_knee), knee_v), zero);
+    __m128 above = _mm_max_ps(_mm_sub_ps(over, half_knee), zero);
+    __m128 curve = _mm_mul_ps(_mm_mul_ps(inside, inside), factor);
+    _mm_storeu_ps(destination + i,
+                  _mm_mul_ps(slope_v, _mm_add_ps(curve, above)));
+  }
+  for (; i < count; i++) {
+    destination[i] = tau_compressor_gain(levels[i], threshold, knee, slope);
+  }
+}
+
+SSE2 static void amplitudes_sse2(float* destination, const float* decibels,
+                                 int32_t count) {
+  __m128 low = _mm_set1_ps(-126.0f);
+  __m128 high = _mm_set1_ps(127.0f);
+  __m128 one = _mm_set1_ps(1.0f);
+  int32_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 x = _mm_mul_ps(_mm_loadu_ps(decibels + i),
+                          _mm_set1_ps(TAU_LOG2_10_PER_20));
+    __m128 audible = _mm_cmpge_ps(x, low);
+    x = _mm_min_ps(_mm_max_ps(x, low), high);
+    // `floor(x + 0.5)`, from the truncation, one less where it rounded up.
+    __m128 half = _mm_add_ps(x, _mm_set1_ps(0.5f));
+    __m128i n = _mm_cvttps_epi32(half);
+    __m128 rounded_up = _mm_cmpgt_ps(_mm_cvtepi32_ps(n), half);
+    n = _mm_add_epi32(n, _mm_castps_si128(rounded_up));
+    __m128 f = _mm_sub_ps(x, _mm_cvtepi32_ps(n));
+    __m128 p = _mm_set1_ps(TAU_EXP2_C6);
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(TAU_EXP2_C5));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(TAU_EXP2_C4));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(TAU_EXP2_C3));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(TAU_EXP2_C2));
+    p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(TAU_EXP2_C1));
+    __m128 scale = _mm_castsi128_ps(
+        _mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23));
+    __m128 y = _mm_mul_ps(_mm_add_ps(one, _mm_mul_ps(f, p)), scale);
+    _mm_storeu_ps(destination + i, _mm_and_ps(audible, y));
+  }
+  for (; i < count; i++) {
+    destination[i] = tau_to_amplitude(decibels[i]);
+  }
+}
+
+const tau_kernel_table tau_kernels_sse2 = {
+    "sse2",
+    scale_sse2,
+    add_sse2,
+    scale_add_sse2,
+    multiply_sse2,
+    multiply_add_sse2,
+    clip_sse2,
+    complex_multiply_add_sse2,
+    butterfly_sse2,
+    blend_dot_sse2,
+    ramp_sse2,
+    geometric_sse2,
+    smooth_magnitude_sse2,
+    decibels_sse2,
+    biquad_sse2,
+    compressor_gain_sse2,
+    amplitudes_sse2,
+};
+#endif  // TAU_KERNELS_X86
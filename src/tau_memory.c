@@ -0,0 +1,233 @@
+#include <string.h>
+
+#include "tau_ffi.h"
+#include "tau_memory.h"
+
+// Stored right before every block returned by `tau_memory_alloc`.
+typedef struct allocation_header {
+  void* memory;
+  size_t size;
+} allocation_header;
+
+static void* default_allocate(size_t size, void* user) {
+  (void)user;
+  return malloc(size);
+}
+
+static void default_release(void* memory, void* user) {
+  (void)user;
+  free(memory);
+}
+
+static tau_allocator allocator = {default_allocate, default_release, NULL};
+static volatile int64_t allocations;
+static volatile int64_t frees;
+static volatile int64_t bytes_in_use;
+static volatile int32_t pooling = 1;
+
+void tau_memory_set_allocator(const tau_allocator* replacement) {
+  if (replacement != NULL) {
+    allocator = *replacement;
+  } else {
+    allocator.allocate = default_allocate;
+    allocator.release = default_release;
+    allocator.user = NULL;
+  }
+}
+
+void* tau_memory_alloc(size_t size, size_t alignment) {
+  if (alignment < sizeof(allocation_header)) {
+    alignment = sizeof(allocation_header);
+  }
+  size_t total = size + alignment + sizeof(allocation_header);
+  if (total < size) {
+    return NULL;
+  }
+  char* memory = (char*)allocator.allocate(total, allocator.user);
+  if (memory == NULL) {
+    return NULL;
+  }
+  uintptr_t start = (uintptr_t)(memory + sizeof(allocation_header));
+  char* block =
+      (char*)((start + alignment - 1) & ~(uintptr_t)(alignment - 1));
+  allocation_header* header = (allocation_header*)block - 1;
+  header->memory = memory;
+  header->size = size;
+  tau_atomic_fetch_add_i64(&allocations, 1);
+  tau_atomic_fetch_add_i64(&bytes_in_use, (int64_t)size);
+  return block;
+}
+
+void* tau_memory_calloc(size_t size, size_t alignment) {
+  void* block = tau_memory_alloc(size, alignment);
+  if (block != NULL) {
+    memset(block, 0, size);
+  }
+  return block;
+}
+
+void tau_memory_free(void* memory) {
+  if (memory == NULL) {
+    return;
+  }
+  allocation_header* header = (allocation_header*)memory - 1;
+  tau_atomic_fetch_add_i64(&frees, 1);
+  tau_atomic_fetch_add_i64(&bytes_in_use, -(int64_t)header->size);
+  allocator.release(header->memory, allocator.user);
+}
+
+FFI_PLUGIN_EXPORT int64_t tau_memory_allocations(void) {
+  return tau_atomic_load_i64(&allocations);
+}
+
+FFI_PLUGIN_EXPORT int64_t tau_memory_frees(void) {
+  return tau_atomic_load_i64(&frees);
+}
+
+FFI_PLUGIN_EXPORT int64_t tau_memory_bytes_in_use(void) {
+  return tau_atomic_load_i64(&bytes_in_use);
+}
+
+FFI_PLUGIN_EXPORT void* tau_memory_allocate(int64_t size) {
+  if (size < 0 || (uint64_t)size > SIZE_MAX) {
+    return NULL;
+  }
+  return tau_memory_alloc((size_t)size, sizeof(void*));
+}
+
+FFI_PLUGIN_EXPORT void tau_memory_release(void* memory) {
+  tau_memory_free(memory);
+}
+
+void tau_memory_set_pooling(int enabled) {
+  tau_atomic_store_i32(&pooling, enabled != 0);
+}
+
+int tau_memory_pooling(void) { return tau_atomic_load_i32(&pooling); }
+
+// --- Fixed pools ---
+
+// The size of the chunks pools carve blocks from, unless a block is larger.
+#define POOL_CHUNK_BYTES 65536
+
+void tau_fixed_pool_init(tau_fixed_pool* pool, size_t block_size,
+                         size_t alignment) {
+  if (alignment < sizeof(void*)) {
+    alignment = sizeof(void*);
+  }
+  block_size = (block_size + alignment - 1) & ~(alignment - 1);
+  pool->block_size = block_size;
+  pool->alignment = alignment;
+  pool->chunk_blocks =
+      block_size < POOL_CHUNK_BYTES ? (int32_t)(POOL_CHUNK_BYTES / block_size)
+                                    : 1;
+  pool->pooled = tau_memory_pooling();
+  pool->free_list = NULL;
+  pool->chunks = NULL;
+}
+
+void tau_fixed_pool_destroy(tau_fixed_pool* pool) {
+  while (pool->chunks != NULL) {
+    void* next = *(void**)pool->chunks;
+    tau_memory_free(pool->chunks);
+    pool->chunks = next;
+  }
+  pool->free_list = NULL;
+}
+
+void* tau_fixed_pool_alloc(tau_fixed_pool* pool) {
+  if (!pool->pooled) {
+    return tau_memory_alloc(pool->block_size, pool->alignment);
+  }
+  if (pool->free_list == NULL) {
+    // The first `alignment` bytes of a chunk link it to the next one.
+    char* chunk = (char*)tau_memory_alloc(
+        pool->alignment + pool->chunk_blocks * pool->block_size,
+        pool->alignment);
+    if (chunk == NULL) {
+      return NULL;
+    }
+    *(void**)chunk = pool->chunks;
+    pool->chunks = chunk;
+    for (int32_t i = pool->chunk_blocks - 1; i >= 0; i--) {
+      void* block = chunk + pool->alignment + i * pool->block_size;
+      *(void**)block = pool->free_list;
+      pool->free_list = block;
+    }
+  }
+  void* block = pool->free_list;
+  pool->free_list = *(void**)block;
+  return block;
+}
+
+void tau_fixed_pool_free(tau_fixed_pool* pool, void* block) {
+  if (block == NULL) {
+    return;
+  }
+  if (!pool->pooled) {
+    tau_memory_free(block);
+    return;
+  }
+  *(void**)block = pool->free_list;
+  pool->free_list = block;
+}
+
+// --- Arenas ---
+
+typedef struct tau_arena {
+  char* base;
+  size_t capacity;
+  size_t used;
+  // The bytes requested since the last reset, including fallbacks.
+  size_t requested;
+  // Fallback blocks, linked through their first word.
+  void* overflow;
+} tau_arena;
+
+static TAU_THREAD_LOCAL tau_arena arena;
+
+void* tau_arena_alloc(size_t size) {
+  size = (size + TAU_CACHE_LINE - 1) & ~(size_t)(TAU_CACHE_LINE - 1);
+  arena.requested += size;
+  if (arena.used + size <= arena.capacity) {
+    void* block = arena.base + arena.used;
+    arena.used += size;
+    return block;
+  }
+  char* block = (char*)tau_memory_alloc(TAU_CACHE_LINE + size, TAU_CACHE_LINE);
+  if (block == NULL) {
+    return NULL;
+  }
+  *(void**)block = arena.overflow;
+  arena.overflow = block;
+  return block + TAU_CACHE_LINE;
+}
+
+void tau_arena_reset(void) {
+  while (arena.overflow != NULL) {
+    void* next = *(void**)arena.overflow;
+    tau_memory_free(arena.overflow);
+    arena.overflow = next;
+  }
+  int pooled = tau_memory_pooling();
+  if (!pooled || arena.requested > arena.capacity) {
+    tau_memory_free(arena.base);
+    arena.base = NULL;
+    arena.capacity = 0;
+    // Leaves room for quanta a little busier than the last one.
+    size_t capacity = arena.requested + arena.requested / 2;
+    if (pooled && capacity > 0) {
+      arena.base = (char*)tau_memory_alloc(capacity, TAU_CACHE_LINE);
+      arena.capacity = arena.base != NULL ? capacity : 0;
+    }
+  }
+  arena.used = 0;
+  arena.requested = 0;
+}
+
+void tau_arena_release(void) {
+  tau_arena_reset();
+  tau_memory_free(arena.base);
+  arena.base = NULL;
+  arena.capacity = 0;
+}
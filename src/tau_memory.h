@@ -0,0 +1,83 @@
+// Memory of the render engine.
+//
+// Every allocation of the engine goes through `tau_memory_alloc`, which
+// counts it and forwards it to a replaceable allocator. On top of it, nodes
+// and buses come from fixed-size pools owned by their context, and the
+// scratch memory a node needs during one render quantum comes from a bump
+// arena of the rendering thread. Once a graph has reached its working size,
+// rendering it allocates nothing.
+#ifndef TAU_MEMORY_H_
+#define TAU_MEMORY_H_
+
+#include "tau_platform.h"
+
+// The allocator behind `tau_memory_alloc`. Both functions may be called from
+// any thread.
+typedef struct tau_allocator {
+  void* (*allocate)(size_t size, void* user);
+  void (*release)(void* memory, void* user);
+  void* user;
+} tau_allocator;
+
+// Replaces the allocator, or restores `malloc` and `free` if `allocator` is
+// NULL. Must be called while nothing allocated by the engine is alive.
+void tau_memory_set_allocator(const tau_allocator* allocator);
+
+// `size` bytes aligned to `alignment`, a power of two, or NULL.
+void* tau_memory_alloc(size_t size, size_t alignment);
+
+// As `tau_memory_alloc`, zeroed.
+void* tau_memory_calloc(size_t size, size_t alignment);
+
+// Frees memory from `tau_memory_alloc`. `memory` may be NULL.
+void tau_memory_free(void* memory);
+
+// Whether pools and arenas keep memory for reuse, which is the default.
+// Turning pooling off makes every pool and arena allocation a call to
+// `tau_memory_alloc`: benchmarks use it as the baseline. Pools keep the mode
+// they were created with; arenas switch at their next reset.
+void tau_memory_set_pooling(int enabled);
+int tau_memory_pooling(void);
+
+// A pool of blocks of one size, carved from chunks that are only freed with
+// the pool. Not thread-safe.
+typedef struct tau_fixed_pool {
+  size_t block_size;
+  size_t alignment;
+  int32_t chunk_blocks;
+  int32_t pooled;
+  // Free blocks, linked through their first word.
+  void* free_list;
+  // Chunks, linked through their first word.
+  void* chunks;
+} tau_fixed_pool;
+
+void tau_fixed_pool_init(tau_fixed_pool* pool, size_t block_size,
+                         size_t alignment);
+
+// Frees every chunk. Blocks still in use become invalid.
+void tau_fixed_pool_destroy(tau_fixed_pool* pool);
+
+// An uninitialized block, or NULL.
+void* tau_fixed_pool_alloc(tau_fixed_pool* pool);
+
+void tau_fixed_pool_free(tau_fixed_pool* pool, void* block);
+
+// `size` bytes aligned on a cache line from the arena of the calling thread,
+// valid until the next `tau_arena_reset` on this thread.
+//
+// Requests that do not fit fall back to `tau_memory_alloc`; the arena then
+// grows at its next reset so that the same requests fit afterwards.
+void* tau_arena_alloc(size_t size);
+
+// Frees everything allocated from the arena of the calling thread. The render
+// loop calls it before every quantum, and parallel rendering before every
+// chain of nodes a thread renders, so scratch memory never outlives a
+// `process` call.
+void tau_arena_reset(void);
+
+// Frees the arena of the calling thread. Threads that render call it before
+// they exit, since thread-local memory is not freed with the thread.
+void tau_arena_release(void);
+
+#endif  // TAU_MEMORY_H_
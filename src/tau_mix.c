@@ -0,0 +1,282 @@
+// Mixing of buses between channel counts, following the Web Audio up-mix
+// and down-mix rules.
+//
+// A mix between the usual layouts, 1, 2, 4 or 6 channels, is a matrix of
+// weights: destination channel `d` is the sum over source channels `s` of
+// `matrix[d][s]` times channel `s`. `tau_bus_mix` uses a version of the mix
+// specialized for each pair of these counts and for accumulating or not:
+// the counts and the weights are constants, so that every destination
+// channel is one pass over its sources, with the zero weights dropped. The
+// generic version goes through the matrix at run time, adding one source
+// channel at a time with the vector kernels, and mixes every other count.
+#include <string.h>
+
+#include "tau_engine.h"
+
+#if defined(_MSC_VER)
+#define TAU_RESTRICT __restrict
+#define TAU_ALWAYS_INLINE __forceinline
+#else
+#define TAU_RESTRICT restrict
+#define TAU_ALWAYS_INLINE inline __attribute__((always_inline))
+#endif
+
+// The channel counts with a layout, and the index of each in the tables.
+#define LAYOUTS 4
+static const int8_t layout_index[7] = {-1, 0, 1, -1, 2, -1, 3};
+
+#define SQRT_HALF 0.70710678f
+
+// Mixing matrices by interpretation, source layout and destination layout,
+// rows of destination channels and columns of source channels. Speakers are
+// ordered L R for stereo, L R SL SR for quad, and L R C LFE SL SR for 5.1.
+static const float matrices[2][LAYOUTS][LAYOUTS][6][6] = {
+    // Speakers.
+    {
+        // From mono.
+        {{{1}},
+         {{1}, {1}},
+         {{1}, {1}, {0}, {0}},
+         {{0}, {0}, {1}, {0}, {0}, {0}}},
+        // From stereo.
+        {{{0.5f, 0.5f}},
+         {{1, 0}, {0, 1}},
+         {{1, 0}, {0, 1}, {0, 0}, {0, 0}},
+         {{1, 0}, {0, 1}, {0, 0}, {0, 0}, {0, 0}, {0, 0}}},
+        // From quad.
+        {{{0.25f, 0.25f, 0.25f, 0.25f}},
+         {{0.5f, 0, 0.5f, 0}, {0, 0.5f, 0, 0.5f}},
+         {{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}},
+         {{1, 0, 0, 0},
+          {0, 1, 0, 0},
+          {0, 0, 0, 0},
+          {0, 0, 0, 0},
+          {0, 0, 1, 0},
+          {0, 0, 0, 1}}},
+        // From 5.1; the LFE channel is dropped.
+        {{{SQRT_HALF, SQRT_HALF, 1, 0, 0.5f, 0.5f}},
+         {{1, 0, SQRT_HALF, 0, SQRT_HALF, 0},
+          {0, 1, SQRT_HALF, 0, 0, SQRT_HALF}},
+         {{1, 0, SQRT_HALF, 0, 0, 0},
+          {0, 1, SQRT_HALF, 0, 0, 0},
+          {0, 0, 0, 0, 1, 0},
+          {0, 0, 0, 0, 0, 1}},
+         {{1, 0, 0, 0, 0, 0},
+          {0, 1, 0, 0, 0, 0},
+          {0, 0, 1, 0, 0, 0},
+          {0, 0, 0, 1, 0, 0},
+          {0, 0, 0, 0, 1, 0},
+          {0, 0, 0, 0, 0, 1}}},
+    },
+    // Discrete: channels matched by index, extra ones dropped or silent.
+    {
+        {{{1}},
+         {{1}, {0}},
+         {{1}, {0}, {0}, {0}},
+         {{1}, {0}, {0}, {0}, {0}, {0}}},
+        {{{1, 0}},
+         {{1, 0}, {0, 1}},
+         {{1, 0}, {0, 1}, {0, 0}, {0, 0}},
+         {{1, 0}, {0, 1}, {0, 0}, {0, 0}, {0, 0}, {0, 0}}},
+        {{{1, 0, 0, 0}},
+         {{1, 0, 0, 0}, {0, 1, 0, 0}},
+         {{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}},
+         {{1, 0, 0, 0},
+          {0, 1, 0, 0},
+          {0, 0, 1, 0},
+          {0, 0, 0, 1},
+          {0, 0, 0, 0},
+          {0, 0, 0, 0}}},
+        {{{1, 0, 0, 0, 0, 0}},
+         {{1, 0, 0, 0, 0, 0}, {0, 1, 0, 0, 0, 0}},
+         {{1, 0, 0, 0, 0, 0},
+          {0, 1, 0, 0, 0, 0},
+          {0, 0, 1, 0, 0, 0},
+          {0, 0, 0, 1, 0, 0}},
+         {{1, 0, 0, 0, 0, 0},
+          {0, 1, 0, 0, 0, 0},
+          {0, 0, 1, 0, 0, 0},
+          {0, 0, 0, 1, 0, 0},
+          {0, 0, 0, 0, 1, 0},
+          {0, 0, 0, 0, 0, 1}}},
+    },
+};
+
+// The matrix of a mix, or NULL if the counts have no layout.
+static const float (*find_matrix(
+    int32_t destination_channels, int32_t source_channels,
+    tau_channel_interpretation interpretation))[6] {
+  if (destination_channels > 6 || source_channels > 6 ||
+      layout_index[destination_channels] < 0 ||
+      layout_index[source_channels] < 0) {
+    return NULL;
+  }
+  return matrices[interpretation == TAU_INTERPRETATION_DISCRETE]
+                 [layout_index[source_channels]]
+                 [layout_index[destination_channels]];
+}
+
+// --- Specialized ---
+
+// Destination channel `out` of a mix of `S` source channels with the
+// weights `row`. The terms are written out rather than looped over so that,
+// once inlined with constant weights, the zero ones vanish without relying
+// on the compiler to unroll.
+static TAU_ALWAYS_INLINE void mix_row(float* TAU_RESTRICT out,
+                                      const float* TAU_RESTRICT source,
+                                      int32_t S, const float* row,
+                                      int accumulate) {
+  for (int32_t i = 0; i < TAU_QUANTUM; i++) {
+    float sum = accumulate ? out[i] : 0.0f;
+    if (S > 0 && row[0] != 0.0f) sum += row[0] * source[i];
+    if (S > 1 && row[1] != 0.0f) sum += row[1] * source[TAU_QUANTUM + i];
+    if (S > 2 && row[2] != 0.0f) sum += row[2] * source[2 * TAU_QUANTUM + i];
+    if (S > 3 && row[3] != 0.0f) sum += row[3] * source[3 * TAU_QUANTUM + i];
+    if (S > 4 && row[4] != 0.0f) sum += row[4] * source[4 * TAU_QUANTUM + i];
+    if (S > 5 && row[5] != 0.0f) sum += row[5] * source[5 * TAU_QUANTUM + i];
+    out[i] = sum;
+  }
+}
+
+// The mix of `S` source channels into `D` destination channels with the
+// weights `matrix`, all constants once inlined.
+static TAU_ALWAYS_INLINE void mix_matrix(float* destination, int32_t D,
+                                         const float* source, int32_t S,
+                                         const float (*matrix)[6],
+                                         int accumulate) {
+  float* out = destination;
+  if (D > 0) mix_row(out, source, S, matrix[0], accumulate);
+  if (D > 1) mix_row(out + TAU_QUANTUM, source, S, matrix[1], accumulate);
+  if (D > 2) mix_row(out + 2 * TAU_QUANTUM, source, S, matrix[2], accumulate);
+  if (D > 3) mix_row(out + 3 * TAU_QUANTUM, source, S, matrix[3], accumulate);
+  if (D > 4) mix_row(out + 4 * TAU_QUANTUM, source, S, matrix[4], accumulate);
+  if (D > 5) mix_row(out + 5 * TAU_QUANTUM, source, S, matrix[5], accumulate);
+}
+
+typedef void (*mix_fn)(float* destination, const float* source);
+
+// Defines the mixes from `S` to `D` channels for interpretation `I`,
+// replacing and accumulating, compiled for `TARGET` and named with `ISA`.
+#define DEFINE_MIX(ISA, TARGET, I, S, D)                                   \
+  TARGET static void mix_##I##_##S##_##D##ISA(float* destination,          \
+                                              const float* source) {       \
+    mix_matrix(destination, D, source, S,                                  \
+               matrices[I][layout_index[S]][layout_index[D]], 0);          \
+  }                                                                        \
+  TARGET static void mix_add_##I##_##S##_##D##ISA(float* destination,      \
+                                                  const float* source) {   \
+    mix_matrix(destination, D, source, S,                                  \
+               matrices[I][layout_index[S]][layout_index[D]], 1);          \
+  }
+
+#define DEFINE_MIXES_FROM(ISA, TARGET, I, S) \
+  DEFINE_MIX(ISA, TARGET, I, S, 1)           \
+  DEFINE_MIX(ISA, TARGET, I, S, 2)           \
+  DEFINE_MIX(ISA, TARGET, I, S, 4)           \
+  DEFINE_MIX(ISA, TARGET, I, S, 6)
+
+#define DEFINE_MIXES(ISA, TARGET)            \
+  DEFINE_MIXES_FROM(ISA, TARGET, 0, 1)       \
+  DEFINE_MIXES_FROM(ISA, TARGET, 0, 2)       \
+  DEFINE_MIXES_FROM(ISA, TARGET, 0, 4)       \
+  DEFINE_MIXES_FROM(ISA, TARGET, 0, 6)       \
+  DEFINE_MIXES_FROM(ISA, TARGET, 1, 1)       \
+  DEFINE_MIXES_FROM(ISA, TARGET, 1, 2)       \
+  DEFINE_MIXES_FROM(ISA, TARGET, 1, 4)       \
+  DEFINE_MIXES_FROM(ISA, TARGET, 1, 6)
+
+#define MIXES_FROM(PREFIX, ISA, I, S)                                   \
+  {                                                                     \
+    PREFIX##I##_##S##_1##ISA, PREFIX##I##_##S##_2##ISA,                 \
+        PREFIX##I##_##S##_4##ISA, PREFIX##I##_##S##_6##ISA              \
+  }
+
+#define MIXES_OF(PREFIX, ISA, I)                                          \
+  {                                                                       \
+    MIXES_FROM(PREFIX, ISA, I, 1), MIXES_FROM(PREFIX, ISA, I, 2),         \
+        MIXES_FROM(PREFIX, ISA, I, 4), MIXES_FROM(PREFIX, ISA, I, 6)      \
+  }
+
+// The specialized mixes by accumulation, interpretation, source layout and
+// destination layout.
+#define MIXES(ISA)                                                      \
+  {                                                                     \
+    {MIXES_OF(mix_, ISA, 0), MIXES_OF(mix_, ISA, 1)},                   \
+        {MIXES_OF(mix_add_, ISA, 0), MIXES_OF(mix_add_, ISA, 1)},       \
+  }
+
+DEFINE_MIXES(, )
+static const mix_fn mixes[2][2][LAYOUTS][LAYOUTS] = MIXES();
+
+// On x86 the mixes are also compiled for AVX2, which doubles the width of
+// the vectors the compiler makes of their loops.
+#if TAU_KERNELS_X86
+DEFINE_MIXES(_avx2, TAU_TARGET("avx2"))
+static const mix_fn mixes_avx2[2][2][LAYOUTS][LAYOUTS] = MIXES(_avx2);
+#endif
+
+// --- Generic ---
+
+void tau_bus_mix_generic(float* destination, int32_t destination_channels,
+                         const float* source, int32_t source_channels,
+                         tau_channel_interpretation interpretation,
+                         int accumulate) {
+  const float(*matrix)[6] =
+      find_matrix(destination_channels, source_channels, interpretation);
+  if (matrix != NULL) {
+    for (int32_t d = 0; d < destination_channels; d++) {
+      float* out = destination + d * TAU_QUANTUM;
+      if (!accumulate) {
+        memset(out, 0, TAU_QUANTUM * sizeof(float));
+      }
+      for (int32_t s = 0; s < source_channels; s++) {
+        float weight = matrix[d][s];
+        if (weight == 1.0f) {
+          tau_kernel_add(out, source + s * TAU_QUANTUM, TAU_QUANTUM);
+        } else if (weight != 0.0f) {
+          tau_kernel_scale_add(out, source + s * TAU_QUANTUM, weight,
+                               TAU_QUANTUM);
+        }
+      }
+    }
+    return;
+  }
+  // Counts without a layout mix discretely, whatever the interpretation.
+  int32_t shared = source_channels < destination_channels ? source_channels
+                                                         : destination_channels;
+  for (int32_t c = 0; c < shared; c++) {
+    float* out = destination + c * TAU_QUANTUM;
+    if (accumulate) {
+      tau_kernel_add(out, source + c * TAU_QUANTUM, TAU_QUANTUM);
+    } else {
+      memcpy(out, source + c * TAU_QUANTUM, TAU_QUANTUM * sizeof(float));
+    }
+  }
+  if (!accumulate && shared < destination_channels) {
+    memset(destination + shared * TAU_QUANTUM, 0,
+           (size_t)(destination_channels - shared) * TAU_QUANTUM *
+               sizeof(float));
+  }
+}
+
+void tau_bus_mix(float* destination, int32_t destination_channels,
+                 const float* source, int32_t source_channels,
+                 tau_channel_interpretation interpretation, int accumulate) {
+  if (destination_channels <= 6 && source_channels <= 6 &&
+      layout_index[destination_channels] >= 0 &&
+      layout_index[source_channels] >= 0) {
+    const mix_fn(*table)[2][LAYOUTS][LAYOUTS] = mixes;
+#if TAU_KERNELS_X86
+    // The mixes follow the kernels, which use AVX2 where it runs.
+    if (tau_kernels() == &tau_kernels_avx2) {
+      table = mixes_avx2;
+    }
+#endif
+    table[accumulate != 0][interpretation == TAU_INTERPRETATION_DISCRETE]
+         [layout_index[source_channels]][layout_index[destination_channels]](
+             destination, source);
+    return;
+  }
+  tau_bus_mix_generic(destination, destination_channels, source,
+                      source_channels, interpretation, accumulate);
+}
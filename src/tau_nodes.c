@@ -0,0 +1,717 @@
+// The source and processing nodes of the render graph.
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "tau_engine.h"
+#include "tau_resampler.h"
+
+#define TAU_PI 3.14159265358979323846
+
+// The rate factor of a detune in cents.
+static double detune_ratio(float cents) {
+  return cents == 0.0f ? 1.0 : pow(2.0, cents / 1200.0);
+}
+
+// --- Oscillator ---
+
+typedef struct oscillator {
+  int32_t type;
+  // The phase in cycles, in [0, 1).
+  double phase;
+} oscillator;
+
+// sin(2 * pi * phase) for `phase` in [0, 1), from a polynomial on the first
+// quarter of the cycle.
+static float sine_cycle(double phase) {
+  double x = phase < 0.5 ? phase : phase - 0.5;
+  double sign = phase < 0.5 ? 1.0 : -1.0;
+  if (x > 0.25) {
+    x = 0.5 - x;
+  }
+  double t = 2.0 * TAU_PI * x;
+  double t2 = t * t;
+  double y =
+      t * (1.0 + t2 * (-1.0 / 6 + t2 * (1.0 / 120 + t2 * (-1.0 / 5040 +
+                                                           t2 / 362880))));
+  return (float)(sign * y);
+}
+
+// The polynomial correction smoothing a unit step at phase 0, spread over one
+// sample of `increment` cycles on either side.
+static double poly_blep(double phase, double increment) {
+  if (phase < increment) {
+    double t = phase / increment;
+    return t + t - t * t - 1.0;
+  }
+  if (phase > 1.0 - increment) {
+    double t = (phase - 1.0) / increment;
+    return t * t + t + t + 1.0;
+  }
+  return 0.0;
+}
+
+static float oscillator_sample(int32_t type, double phase, double increment) {
+  switch (type) {
+    case TAU_OSCILLATOR_SQUARE: {
+      double half = phase + 0.5;
+      half -= half >= 1.0 ? 1.0 : 0.0;
+      double value = phase < 0.5 ? 1.0 : -1.0;
+      value += poly_blep(phase, increment) - poly_blep(half, increment);
+      return (float)value;
+    }
+    case TAU_OSCILLATOR_SAWTOOTH:
+      return (float)(2.0 * phase - 1.0 - poly_blep(phase, increment));
+    case TAU_OSCILLATOR_TRIANGLE: {
+      double shifted = phase + 0.25;
+      shifted -= shifted >= 1.0 ? 1.0 : 0.0;
+      return (float)(1.0 - 4.0 * fabs(shifted - 0.5));
+    }
+    default:
+      return sine_cycle(phase);
+  }
+}
+
+// Renders `out[start, end)` with a frequency that changes during the
+// quantum: `frequencies` and `detunes` hold one value per frame, or are NULL
+// where the parameter is constant.
+static void oscillator_automated(tau_context* context, tau_node* node,
+                                 const float* frequencies,
+                                 const float* detunes, int32_t start,
+                                 int32_t end) {
+  oscillator* self = (oscillator*)node->state;
+  float* out = node->output;
+  float frequency = tau_node_param(node, TAU_PARAM_FREQUENCY)->value;
+  double ratio = detune_ratio(tau_node_param(node, TAU_PARAM_DETUNE)->value);
+  double phase = self->phase;
+  for (int32_t i = start; i < end; i++) {
+    double hertz = (frequencies != NULL ? frequencies[i] : frequency) *
+                   (detunes != NULL ? detune_ratio(detunes[i]) : ratio);
+    double increment = fabs(hertz) / context->sample_rate;
+    out[i] = increment < 0.5 ? oscillator_sample(self->type, phase, increment)
+                             : 0.0f;
+    phase += increment < 0.5 ? increment : 0.0;
+    phase -= phase >= 1.0 ? 1.0 : 0.0;
+  }
+  self->phase = phase;
+  if (end < TAU_QUANTUM) {
+    memset(out + end, 0, (TAU_QUANTUM - end) * sizeof(float));
+  }
+  node->output_channels = 1;
+  node->output_silent = 0;
+}
+
+static void process_oscillator(tau_context* context, tau_node* node) {
+  oscillator* self = (oscillator*)node->state;
+  int32_t start;
+  int32_t end;
+  if (!tau_node_active_range(context, node, &start, &end)) {
+    tau_node_output_silence(node, 1);
+    return;
+  }
+  float* out = node->output;
+  if (start > 0) {
+    memset(out, 0, start * sizeof(float));
+  }
+  tau_param* frequency_param = tau_node_param(node, TAU_PARAM_FREQUENCY);
+  tau_param* detune_param = tau_node_param(node, TAU_PARAM_DETUNE);
+  const float* frequencies = tau_param_render(context, frequency_param);
+  const float* detunes = tau_param_render(context, detune_param);
+  if (frequencies != NULL || detunes != NULL) {
+    oscillator_automated(context, node, frequencies, detunes, start, end);
+    return;
+  }
+  double frequency =
+      frequency_param->value * detune_ratio(detune_param->value);
+  double increment = fabs(frequency) / context->sample_rate;
+  if (increment >= 0.5) {
+    // Above Nyquist, an oscillator is silent.
+    memset(out + start, 0, (end - start) * sizeof(float));
+  } else {
+    double phase = self->phase;
+    for (int32_t i = start; i < end; i++) {
+      out[i] = oscillator_sample(self->type, phase, increment);
+      phase += increment;
+      phase -= phase >= 1.0 ? 1.0 : 0.0;
+    }
+    self->phase = phase;
+  }
+  if (end < TAU_QUANTUM) {
+    memset(out + end, 0, (TAU_QUANTUM - end) * sizeof(float));
+  }
+  node->output_channels = 1;
+  node->output_silent = 0;
+}
+
+static const tau_node_ops oscillator_ops = {process_oscillator, NULL};
+
+FFI_PLUGIN_EXPORT int32_t tau_oscillator_create(tau_context* context,
+                                                int32_t type, float frequency) {
+  if (context == NULL || type < TAU_OSCILLATOR_SINE ||
+      type > TAU_OSCILLATOR_TRIANGLE) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_node* node =
+      tau_node_create(context, &oscillator_ops, sizeof(oscillator), 1);
+  if (node == NULL) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  ((oscillator*)node->state)->type = type;
+  float nyquist = context->sample_rate / 2;
+  node->is_source = 1;
+  tau_node_add_param(node, TAU_PARAM_FREQUENCY, 440, -nyquist, nyquist);
+  tau_node_add_param(node, TAU_PARAM_DETUNE, 0, -153600, 153600);
+  tau_param_set_value(context, node->id, TAU_PARAM_FREQUENCY, frequency);
+  return node->id;
+}
+
+// --- Gain ---
+
+static void process_gain(tau_context* context, tau_node* node) {
+  int32_t channels = node->input_channels;
+  const float* gains = tau_param_render(context, &node->params[0]);
+  float gain = node->params[0].value;
+  if (node->input_silent || (gains == NULL && gain == 0.0f)) {
+    tau_node_output_silence(node, channels);
+    return;
+  }
+  if (gains != NULL) {
+    for (int32_t c = 0; c < channels; c++) {
+      tau_kernel_multiply(node->output + c * TAU_QUANTUM,
+                          node->input + c * TAU_QUANTUM, gains, TAU_QUANTUM);
+    }
+  } else {
+    tau_kernel_scale(node->output, node->input, gain,
+                     channels * TAU_QUANTUM);
+  }
+  node->output_channels = channels;
+  node->output_silent = 0;
+}
+
+static const tau_node_ops gain_ops = {process_gain, NULL};
+
+FFI_PLUGIN_EXPORT int32_t tau_gain_create(tau_context* context, float gain) {
+  if (context == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_node* node = tau_node_create(context, &gain_ops, 0, 0);
+  if (node == NULL) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  tau_node_add_param(node, TAU_PARAM_GAIN, 1, -FLT_MAX, FLT_MAX);
+  tau_param_set_value(context, node->id, TAU_PARAM_GAIN, gain);
+  return node->id;
+}
+
+// --- Buffer source ---
+
+typedef struct buffer_source {
+  tau_audio_buffer* buffer;
+  int32_t loop;
+  // The read position in frames of the buffer.
+  double position;
+  // The interpolation filter, or NULL to interpolate linearly.
+  const tau_resampler_filter* filter;
+} buffer_source;
+
+// Fills `out[start, done)` with `in` interpolated by `filter` at the read
+// positions `indices + fractions`. Windows reaching past the ends of the
+// buffer are gathered into `window`, wrapping around if `loop`.
+static void interpolate_buffer(const tau_resampler_filter* filter,
+                               const float* in, int32_t frames, int32_t loop,
+                               const int32_t* indices, const float* fractions,
+                               float* window, float* out, int32_t start,
+                               int32_t done) {
+  const tau_kernel_table* kernels = tau_kernels();
+  int32_t taps = filter->taps;
+  for (int32_t i = start; i < done; i++) {
+    int32_t first = indices[i] - (taps / 2 - 1);
+    const float* taps_in = in + first;
+    if (first < 0 || first + taps > frames) {
+      for (int32_t k = 0; k < taps; k++) {
+        int32_t index = first + k;
+        if (loop) {
+          index %= frames;
+          index += index < 0 ? frames : 0;
+        } else if (index < 0 || index >= frames) {
+          window[k] = 0.0f;
+          continue;
+        }
+        window[k] = in[index];
+      }
+      taps_in = window;
+    }
+    out[i] = tau_resampler_filter_apply(filter, kernels, taps_in,
+                                        fractions[i]);
+  }
+}
+
+// Renders the frames `[start, end)` of the current quantum of `self` into
+// `output`, one channel per channel of the buffer, reading `speed` frames of
+// the buffer per frame at its own sample rate. The other frames are zeroed.
+// Returns the frame a one-shot buffer ended at, or `end`.
+static int32_t render_buffer(tau_context* context, buffer_source* self,
+                             double speed, int32_t start, int32_t end,
+                             float* output) {
+  const tau_audio_buffer* buffer = self->buffer;
+  double rate = buffer->sample_rate / context->sample_rate * speed;
+  // The read positions are the same for every channel: they are computed
+  // once, in scratch memory of the quantum.
+  int32_t* indices =
+      (int32_t*)tau_arena_alloc(2 * TAU_QUANTUM * sizeof(int32_t));
+  float* fractions = (float*)tau_arena_alloc(TAU_QUANTUM * sizeof(float));
+  // Reading every sample in place needs no filter.
+  const tau_resampler_filter* filter =
+      rate == 1.0 && self->position == floor(self->position) ? NULL
+                                                             : self->filter;
+  float* window =
+      filter != NULL ? (float*)tau_arena_alloc(filter->taps * sizeof(float))
+                     : NULL;
+  if (indices == NULL || fractions == NULL ||
+      (filter != NULL && window == NULL)) {
+    memset(output, 0,
+           (size_t)buffer->channels * TAU_QUANTUM * sizeof(float));
+    return end;
+  }
+  int32_t* next_indices = indices + TAU_QUANTUM;
+  double length = buffer->frames;
+  double position = self->position;
+  int32_t done = end;
+  for (int32_t i = start; i < end; i++) {
+    if (position >= length || position < 0) {
+      if (!self->loop) {
+        done = i;
+        break;
+      }
+      position = fmod(position, length);
+      position += position < 0 ? length : 0;
+    }
+    int32_t index = (int32_t)position;
+    indices[i] = index;
+    next_indices[i] = index + 1 < buffer->frames ? index + 1
+                                                 : (self->loop ? 0 : index);
+    // A fraction just below 1 must not round up to it, which would read
+    // past the last row of the filter.
+    float fraction = (float)(position - index);
+    fractions[i] = fraction < 1.0f ? fraction : 1.0f - FLT_EPSILON / 2;
+    position += rate;
+  }
+  for (int32_t c = 0; c < buffer->channels; c++) {
+    const float* in = buffer->data + (size_t)c * buffer->stride;
+    float* out = output + c * TAU_QUANTUM;
+    if (start > 0) {
+      memset(out, 0, start * sizeof(float));
+    }
+    if (filter != NULL) {
+      interpolate_buffer(filter, in, buffer->frames, self->loop, indices,
+                         fractions, window, out, start, done);
+    } else {
+      for (int32_t i = start; i < done; i++) {
+        float sample = in[indices[i]];
+        out[i] = sample + (in[next_indices[i]] - sample) * fractions[i];
+      }
+    }
+    if (done < TAU_QUANTUM) {
+      memset(out + done, 0, (TAU_QUANTUM - done) * sizeof(float));
+    }
+  }
+  // A finished one-shot buffer stays silent from then on.
+  self->position = done < end ? length : position;
+  return done;
+}
+
+static void process_buffer_source(tau_context* context, tau_node* node) {
+  buffer_source* self = (buffer_source*)node->state;
+  const tau_audio_buffer* buffer = self->buffer;
+  int32_t start;
+  int32_t end;
+  if ((!self->loop && self->position >= buffer->frames) ||
+      !tau_node_active_range(context, node, &start, &end)) {
+    tau_node_output_silence(node, buffer->channels);
+    return;
+  }
+  // The playback rate and detune are k-rate, as in Web Audio.
+  double speed =
+      tau_param_render_k(context,
+                         tau_node_param(node, TAU_PARAM_PLAYBACK_RATE)) *
+      detune_ratio(
+          tau_param_render_k(context, tau_node_param(node, TAU_PARAM_DETUNE)));
+  render_buffer(context, self, speed, start, end, node->output);
+  node->output_channels = buffer->channels;
+  node->output_silent = 0;
+}
+
+static void destroy_buffer_source(tau_node* node) {
+  tau_audio_buffer_release(((buffer_source*)node->state)->buffer);
+}
+
+static const tau_node_ops buffer_source_ops = {process_buffer_source,
+                                               destroy_buffer_source};
+
+FFI_PLUGIN_EXPORT int32_t tau_buffer_source_create(tau_context* context,
+                                                   tau_audio_buffer* buffer,
+                                                   int32_t loop) {
+  if (context == NULL || buffer == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  // The filter is designed for the conversion at the normal playback rate.
+  int32_t quality = tau_atomic_load_i32(&context->resampler_quality);
+  const tau_resampler_filter* filter = tau_resampler_filter_get(
+      quality, buffer->sample_rate / context->sample_rate);
+  if (filter == NULL && quality != TAU_RESAMPLER_LINEAR) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  tau_node* node = tau_node_create(context, &buffer_source_ops,
+                                   sizeof(buffer_source), buffer->channels);
+  if (node == NULL) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  buffer_source* self = (buffer_source*)node->state;
+  tau_audio_buffer_retain(buffer);
+  self->buffer = buffer;
+  self->loop = loop != 0;
+  self->filter = filter;
+  node->is_source = 1;
+  tau_node_add_param(node, TAU_PARAM_PLAYBACK_RATE, 1, -FLT_MAX, FLT_MAX);
+  tau_node_add_param(node, TAU_PARAM_DETUNE, 0, -FLT_MAX, FLT_MAX);
+  return node->id;
+}
+
+// --- Voice pool ---
+
+// A voice of a pool, which belongs to the rendering thread.
+typedef struct voice {
+  // The buffer is NULL until the first note, and kept once the note ends,
+  // until the next one.
+  buffer_source source;
+  // The handle of the note, and whether it is playing or scheduled.
+  int32_t handle;
+  int32_t playing;
+  double playback_rate;
+  float gain;
+  int64_t start_frame;
+  int64_t stop_frame;
+} voice;
+
+typedef struct voice_pool {
+  int32_t count;
+  voice* voices;
+  // The handle of the last note each voice finished, published by the
+  // rendering thread.
+  volatile int32_t* finished;
+
+  // What follows belongs to the control threads, under the control lock.
+
+  // The handle of the last note played on each voice, and the number of
+  // notes played before it, which orders them by age.
+  int32_t* handles;
+  int64_t* ages;
+  // The voice to look at first for the next note.
+  int32_t next;
+  int64_t notes;
+  int64_t steals;
+} voice_pool;
+
+typedef struct voice_pool_state {
+  voice_pool* self;
+} voice_pool_state;
+
+static void voice_pool_free(voice_pool* self) {
+  if (self->voices != NULL) {
+    for (int32_t i = 0; i < self->count; i++) {
+      tau_audio_buffer_release(self->voices[i].source.buffer);
+    }
+  }
+  tau_memory_free(self->voices);
+  tau_memory_free((void*)self->finished);
+  tau_memory_free(self->handles);
+  tau_memory_free(self->ages);
+  tau_memory_free(self);
+}
+
+static voice_pool* voice_pool_new(int32_t count) {
+  voice_pool* self =
+      (voice_pool*)tau_memory_calloc(sizeof(voice_pool), TAU_CACHE_LINE);
+  if (self == NULL) {
+    return NULL;
+  }
+  self->count = count;
+  self->voices = (voice*)tau_memory_calloc((size_t)count * sizeof(voice),
+                                           TAU_CACHE_LINE);
+  self->finished = (volatile int32_t*)tau_memory_calloc(
+      (size_t)count * sizeof(int32_t), TAU_CACHE_LINE);
+  self->handles = (int32_t*)tau_memory_calloc(
+      (size_t)count * sizeof(int32_t), sizeof(int32_t));
+  self->ages = (int64_t*)tau_memory_calloc((size_t)count * sizeof(int64_t),
+                                           sizeof(int64_t));
+  if (self->voices == NULL || self->finished == NULL ||
+      self->handles == NULL || self->ages == NULL) {
+    voice_pool_free(self);
+    return NULL;
+  }
+  // Every voice starts free, having finished note 0.
+  for (int32_t i = 0; i < count; i++) {
+    self->voices[i].handle = i;
+    self->finished[i] = i;
+    self->handles[i] = i;
+  }
+  return self;
+}
+
+// Ends the note of `self->voices[index]`, freeing the voice.
+static void finish_voice(voice_pool* self, int32_t index) {
+  voice* current = &self->voices[index];
+  current->playing = 0;
+  tau_atomic_store_i32(&self->finished[index], current->handle);
+}
+
+static void process_voice_pool(tau_context* context, tau_node* node) {
+  voice_pool* self = ((voice_pool_state*)node->state)->self;
+  const tau_kernel_table* kernels = tau_kernels();
+  int32_t channels = node->output_channels;
+  int64_t first = context->frame;
+  int64_t last = first + TAU_QUANTUM;
+  int silent = 1;
+  for (int32_t i = 0; i < self->count; i++) {
+    voice* current = &self->voices[i];
+    if (!current->playing) {
+      continue;
+    }
+    buffer_source* source = &current->source;
+    const tau_audio_buffer* buffer = source->buffer;
+    if ((!source->loop && source->position >= buffer->frames) ||
+        current->stop_frame <= first ||
+        current->stop_frame <= current->start_frame) {
+      finish_voice(self, i);
+      continue;
+    }
+    if (current->start_frame >= last) {
+      continue;
+    }
+    int32_t start = current->start_frame > first
+                        ? (int32_t)(current->start_frame - first)
+                        : 0;
+    int32_t end = current->stop_frame < last
+                      ? (int32_t)(current->stop_frame - first)
+                      : TAU_QUANTUM;
+    int32_t samples = buffer->channels * TAU_QUANTUM;
+    float* scratch = (float*)tau_arena_alloc(samples * sizeof(float));
+    if (scratch == NULL) {
+      continue;
+    }
+    int32_t done = render_buffer(context, source, current->playback_rate,
+                                 start, end, scratch);
+    // Voices of the channels of the pool are scaled straight into the
+    // output; the others are mixed to them first.
+    if (buffer->channels == channels) {
+      if (silent) {
+        kernels->scale(node->output, scratch, current->gain, samples);
+      } else {
+        kernels->scale_add(node->output, scratch, current->gain, samples);
+      }
+    } else {
+      if (current->gain != 1.0f) {
+        kernels->scale(scratch, scratch, current->gain, samples);
+      }
+      tau_bus_mix(node->output, channels, scratch, buffer->channels,
+                  node->channel_interpretation, !silent);
+    }
+    silent = 0;
+    if (done < end || current->stop_frame <= last) {
+      finish_voice(self, i);
+    }
+  }
+  if (silent) {
+    tau_node_output_silence(node, channels);
+  } else {
+    node->output_silent = 0;
+  }
+}
+
+static void destroy_voice_pool(tau_node* node) {
+  voice_pool_free(((voice_pool_state*)node->state)->self);
+}
+
+static const tau_node_ops voice_pool_ops = {process_voice_pool,
+                                            destroy_voice_pool};
+
+void tau_voice_pool_apply(tau_context* context, tau_command* command) {
+  voice_pool* self = ((voice_pool_state*)command->node->state)->self;
+  voice* target = &self->voices[command->count & (TAU_MAX_VOICES - 1)];
+  int64_t frame = context->frame;
+  if (command->frame > (double)frame) {
+    frame = command->frame >= (double)INT64_MAX ? INT64_MAX
+                                                : (int64_t)command->frame;
+  }
+  if (command->type == TAU_COMMAND_VOICE_STOP) {
+    if (target->handle == command->count) {
+      target->stop_frame = frame;
+    }
+    return;
+  }
+  // A voice cut off needs no notice: the control threads count it as free
+  // once the new note ends.
+  void* replaced = target->source.buffer;
+  target->source.buffer = (tau_audio_buffer*)command->memory[0];
+  target->source.filter = (const tau_resampler_filter*)command->memory[1];
+  target->source.loop = command->mode;
+  target->source.position = 0.0;
+  command->memory[0] = replaced;
+  command->memory[1] = NULL;
+  target->handle = command->count;
+  target->playing = 1;
+  target->playback_rate = command->event.length;
+  target->gain = command->event.value;
+  target->start_frame = frame;
+  target->stop_frame = INT64_MAX;
+}
+
+// The voice pool behind `handle`, or NULL. Called with the control lock
+// held.
+static tau_node* find_voice_pool(tau_context* context, int32_t handle) {
+  tau_node* node = tau_context_node(context, handle);
+  return node != NULL && node->ops == &voice_pool_ops ? node : NULL;
+}
+
+// The voice for the next note: the first free one from `self->next`, or the
+// one playing the oldest note. Called with the control lock held.
+static int32_t take_voice(voice_pool* self) {
+  int32_t oldest = self->next;
+  for (int32_t n = 0; n < self->count; n++) {
+    int32_t i = self->next + n;
+    i -= i >= self->count ? self->count : 0;
+    if (tau_atomic_load_i32(&self->finished[i]) == self->handles[i]) {
+      return i;
+    }
+    if (self->ages[i] < self->ages[oldest]) {
+      oldest = i;
+    }
+  }
+  self->steals++;
+  return oldest;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_voice_pool_create(tau_context* context,
+                                                int32_t voices,
+                                                int32_t channels) {
+  if (context == NULL || voices <= 0 || voices > TAU_MAX_VOICES ||
+      channels <= 0 || channels > TAU_MAX_CHANNELS) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  voice_pool* self = voice_pool_new(voices);
+  if (self == NULL) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  tau_node* node = tau_node_create(context, &voice_pool_ops,
+                                   sizeof(voice_pool_state), channels);
+  if (node == NULL) {
+    voice_pool_free(self);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  ((voice_pool_state*)node->state)->self = self;
+  return node->id;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_voice_pool_play(tau_context* context,
+                                              int32_t node,
+                                              tau_audio_buffer* buffer,
+                                              double when, int32_t loop,
+                                              float playback_rate,
+                                              float gain) {
+  if (context == NULL || buffer == NULL || !(when >= 0) ||
+      playback_rate != playback_rate || gain != gain) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  int32_t quality = tau_atomic_load_i32(&context->resampler_quality);
+  const tau_resampler_filter* filter = tau_resampler_filter_get(
+      quality, buffer->sample_rate / context->sample_rate);
+  if (filter == NULL && quality != TAU_RESAMPLER_LINEAR) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  tau_control_lock(context);
+  tau_node* target = find_voice_pool(context, node);
+  if (target == NULL) {
+    tau_control_unlock(context);
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_command* command =
+      tau_command_create(context, TAU_COMMAND_VOICE_PLAY, target, 0);
+  if (command == NULL) {
+    tau_control_unlock(context);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  voice_pool* self = ((voice_pool_state*)target->state)->self;
+  int32_t index = take_voice(self);
+  // The generation in the high bits tells the notes of a voice apart.
+  int32_t generation = ((self->handles[index] >> TAU_VOICE_INDEX_BITS) + 1) &
+                       (INT32_MAX >> TAU_VOICE_INDEX_BITS);
+  int32_t voice = (generation << TAU_VOICE_INDEX_BITS) | index;
+  self->handles[index] = voice;
+  self->ages[index] = ++self->notes;
+  self->next = index + 1 < self->count ? index + 1 : 0;
+  tau_audio_buffer_retain(buffer);
+  command->count = voice;
+  command->frame = when * context->sample_rate + 0.5;
+  command->mode = loop != 0;
+  command->memory[0] = buffer;
+  command->memory[1] = (void*)filter;
+  command->event.length = playback_rate;
+  command->event.value = gain;
+  tau_command_post(context, command);
+  tau_control_unlock(context);
+  return voice;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_voice_pool_stop(tau_context* context,
+                                              int32_t node, int32_t voice,
+                                              double when) {
+  if (context == NULL || voice < 0 || !(when >= 0)) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_control_lock(context);
+  tau_node* target = find_voice_pool(context, node);
+  voice_pool* self =
+      target != NULL ? ((voice_pool_state*)target->state)->self : NULL;
+  int32_t index = voice & (TAU_MAX_VOICES - 1);
+  int32_t status = TAU_OK;
+  if (self == NULL || index >= self->count) {
+    status = TAU_ERROR_INVALID_ARGUMENT;
+  } else if (self->handles[index] == voice &&
+             tau_atomic_load_i32(&self->finished[index]) != voice) {
+    tau_command* command =
+        tau_command_create(context, TAU_COMMAND_VOICE_STOP, target, 0);
+    if (command == NULL) {
+      status = TAU_ERROR_OUT_OF_MEMORY;
+    } else {
+      command->count = voice;
+      command->frame = when * context->sample_rate + 0.5;
+      tau_command_post(context, command);
+    }
+  }
+  tau_control_unlock(context);
+  return status;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_voice_pool_get_stats(
+    tau_context* context, int32_t node, tau_voice_pool_stats* stats) {
+  if (context == NULL || stats == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_control_lock(context);
+  tau_node* target = find_voice_pool(context, node);
+  if (target == NULL) {
+    tau_control_unlock(context);
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  voice_pool* self = ((voice_pool_state*)target->state)->self;
+  stats->voices = self->count;
+  stats->playing = 0;
+  for (int32_t i = 0; i < self->count; i++) {
+    stats->playing +=
+        tau_atomic_load_i32(&self->finished[i]) != self->handles[i];
+  }
+  stats->notes = self->notes;
+  stats->steals = self->steals;
+  tau_control_unlock(context);
+  return TAU_OK;
+}
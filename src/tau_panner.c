@@ -0,0 +1,512 @@
+// The panner node, as the Web Audio `PannerNode`, and the head-related
+// impulse responses of its HRTF model.
+//
+// A `tau_hrtf` holds the spectra of its responses, cut into partitions of a
+// quantum as the convolver does, and a cache of the responses of cells of
+// `CELL_DEGREES` of azimuth and elevation, each interpolated from the
+// nearest measurements. Cache entries are claimed from a pool with an atomic
+// counter, written once and published in the table of cells with a compare
+// and swap. They are never evicted, so the rendering threads of any context
+// read them without locking; when two threads interpolate the same cell at
+// once, the first entry published wins and the other is lost.
+//
+// Every quantum, an HRTF panner transforms the last two quanta of its input
+// into a frequency-domain delay line, whose products with the partitions of
+// the responses of its cell give each ear by overlap-save: one forward and
+// two inverse transforms. A panner that stays in its cell looks nothing up;
+// one that moves to another renders both and crossfades over the quantum.
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "tau_engine.h"
+#include "tau_fft.h"
+#include "tau_kernels.h"
+
+#define TAU_PI 3.14159265358979323846
+
+#define FFT_SIZE (2 * TAU_QUANTUM)
+#define BINS (TAU_QUANTUM + 1)
+// The floats between consecutive spectra, a multiple of the cache line.
+#define BIN_STRIDE 144
+
+// The cells of the cache, on a grid of azimuths from 0 and elevations from
+// -90 to 90 degrees.
+#define CELL_DEGREES 2
+#define AZIMUTH_CELLS (360 / CELL_DEGREES)
+#define ELEVATION_CELLS (180 / CELL_DEGREES + 1)
+#define CELLS (AZIMUTH_CELLS * ELEVATION_CELLS)
+
+// The memory of the cache of a `tau_hrtf`, in bytes.
+#define CACHE_BYTES (8 << 20)
+
+// The measurements the responses of a cell are interpolated from, and the
+// angle, in radians, within which the nearest one is used alone.
+#define NEIGHBOURS 3
+#define COINCIDENT 1e-3
+
+// The inverse distance model of Web Audio, with its default parameters.
+#define REF_DISTANCE 1.0f
+#define ROLLOFF_FACTOR 1.0f
+
+struct tau_hrtf {
+  volatile int32_t references;
+  float sample_rate;
+  int32_t count;
+  int32_t partitions;
+  // The floats of the responses of one direction: for each ear and each
+  // partition, the real parts then the imaginary parts, of `BIN_STRIDE`
+  // floats each.
+  int32_t entry_floats;
+  // The unit vector of every measured direction.
+  float* directions;
+  // The responses of every measurement, scaled by 1 / `FFT_SIZE` to undo
+  // the inverse transform.
+  float* measured;
+  tau_fft fft;
+  // The cache entry of every cell, or -1.
+  volatile int32_t* cells;
+  // The entries claimed, which may pass `capacity` while threads race for
+  // the last ones.
+  volatile int32_t used;
+  int32_t capacity;
+  float* cache;
+};
+
+typedef struct panner {
+  tau_hrtf* hrtf;
+  // The delay line slot of the current quantum.
+  int32_t head;
+  // Quanta of silent input since the last sound.
+  int32_t silent_quanta;
+  // The cell and the responses of the last quantum, NULL before the first.
+  int32_t cell;
+  const float* responses;
+  // Two entries for the responses the panner interpolates itself once the
+  // cache is full, so that the last ones outlive a crossfade.
+  float* own;
+  // The gain of each ear at the end of the last quantum, once `rendered`.
+  float gains[2];
+  int32_t rendered;
+  // The last two quanta of input, and the spectra of the input of the last
+  // `partitions` quanta, real parts then imaginary parts.
+  float* history;
+  float* delay;
+} panner;
+
+typedef struct panner_state {
+  panner* self;
+} panner_state;
+
+static void hrtf_free(tau_hrtf* hrtf) {
+  tau_fft_destroy(&hrtf->fft);
+  tau_memory_free(hrtf->directions);
+  tau_memory_free(hrtf->measured);
+  tau_memory_free((void*)hrtf->cells);
+  tau_memory_free(hrtf->cache);
+  tau_memory_free(hrtf);
+}
+
+// The unit vector of a direction in degrees, in the axes of the listener.
+static void direction(double azimuth, double elevation, float* vector) {
+  double a = azimuth * (TAU_PI / 180.0);
+  double e = elevation * (TAU_PI / 180.0);
+  vector[0] = (float)(cos(e) * sin(a));
+  vector[1] = (float)sin(e);
+  vector[2] = (float)(-cos(e) * cos(a));
+}
+
+// The offset of the spectrum of partition `partition` of `ear` in the
+// responses of one direction. The imaginary parts follow, `BIN_STRIDE`
+// floats further.
+static size_t spectrum(int32_t partitions, int32_t ear, int32_t partition) {
+  return (size_t)(ear * partitions + partition) * 2 * BIN_STRIDE;
+}
+
+// Interpolates the responses of `cell` into `entry`, weighting the nearest
+// measurements by the inverse of their angle to the centre of the cell.
+static void interpolate(const tau_hrtf* hrtf, int32_t cell, float* entry) {
+  float centre[3];
+  direction((double)(cell % AZIMUTH_CELLS) * CELL_DEGREES,
+            (double)(cell / AZIMUTH_CELLS) * CELL_DEGREES - 90.0, centre);
+  // A set has a measurement at least, so `found` ends positive; the arrays
+  // are zeroed for the compiler, which cannot tell.
+  int32_t nearest[NEIGHBOURS] = {0};
+  float dots[NEIGHBOURS];
+  int32_t found = 0;
+  for (int32_t i = 0; i < hrtf->count; i++) {
+    const float* d = hrtf->directions + 3 * i;
+    float dot = d[0] * centre[0] + d[1] * centre[1] + d[2] * centre[2];
+    int32_t k = found < NEIGHBOURS ? found++ : NEIGHBOURS;
+    for (; k > 0 && dots[k - 1] < dot; k--) {
+      if (k < NEIGHBOURS) {
+        nearest[k] = nearest[k - 1];
+        dots[k] = dots[k - 1];
+      }
+    }
+    if (k < NEIGHBOURS) {
+      nearest[k] = i;
+      dots[k] = dot;
+    }
+  }
+  double weights[NEIGHBOURS] = {0.0};
+  double total = 0.0;
+  for (int32_t k = 0; k < found; k++) {
+    double angle = acos(dots[k] < 1.0f ? dots[k] : 1.0f);
+    if (angle < COINCIDENT) {
+      found = 1;
+      nearest[0] = nearest[k];
+      weights[0] = total = 1.0;
+      break;
+    }
+    weights[k] = 1.0 / angle;
+    total += weights[k];
+  }
+  int32_t floats = hrtf->entry_floats;
+  tau_kernel_scale(entry, hrtf->measured + (size_t)nearest[0] * floats,
+                   (float)(weights[0] / total), floats);
+  for (int32_t k = 1; k < found; k++) {
+    tau_kernel_scale_add(entry, hrtf->measured + (size_t)nearest[k] * floats,
+                         (float)(weights[k] / total), floats);
+  }
+}
+
+// The cell of a direction in degrees.
+static int32_t cell_of(float azimuth, float elevation) {
+  int32_t a = (int32_t)lroundf(azimuth / CELL_DEGREES) % AZIMUTH_CELLS;
+  int32_t e = (int32_t)lroundf((elevation + 90.0f) / CELL_DEGREES);
+  a = a < 0 ? a + AZIMUTH_CELLS : a;
+  e = e < 0 ? 0 : e >= ELEVATION_CELLS ? ELEVATION_CELLS - 1 : e;
+  return e * AZIMUTH_CELLS + a;
+}
+
+// The responses of `cell`, from the cache of the set, or interpolated into
+// an entry of the panner once the cache is full.
+static const float* lookup(panner* self, int32_t cell) {
+  tau_hrtf* hrtf = self->hrtf;
+  int32_t slot = tau_atomic_load_i32(&hrtf->cells[cell]);
+  if (slot < 0 && tau_atomic_load_relaxed_i32(&hrtf->used) < hrtf->capacity) {
+    slot = tau_atomic_fetch_add_i32(&hrtf->used, 1);
+    if (slot < hrtf->capacity) {
+      interpolate(hrtf, cell, hrtf->cache + (size_t)slot * hrtf->entry_floats);
+      int32_t published = -1;
+      if (!tau_atomic_cas_i32(&hrtf->cells[cell], &published, slot)) {
+        slot = published;
+      }
+    } else {
+      slot = -1;
+    }
+  }
+  if (slot >= 0) {
+    return hrtf->cache + (size_t)slot * hrtf->entry_floats;
+  }
+  float* own = self->responses == self->own ? self->own + hrtf->entry_floats
+                                            : self->own;
+  interpolate(hrtf, cell, own);
+  return own;
+}
+
+static void panner_free(panner* self) {
+  tau_hrtf_release(self->hrtf);
+  tau_memory_free(self->own);
+  tau_memory_free(self->history);
+  tau_memory_free(self->delay);
+  tau_memory_free(self);
+}
+
+// Scales `input` into `output`, with a gain ramping from `from` to `to`
+// over the quantum.
+static void apply_gain(float* output, const float* input, float from,
+                       float to) {
+  if (from == to) {
+    tau_kernel_scale(output, input, to, TAU_QUANTUM);
+    return;
+  }
+  float* ramp = (float*)tau_arena_alloc(TAU_QUANTUM * sizeof(float));
+  float step = (to - from) / TAU_QUANTUM;
+  tau_kernel_ramp(ramp, from + step, step, TAU_QUANTUM);
+  tau_kernel_multiply(output, input, ramp, TAU_QUANTUM);
+}
+
+// The quantum of `ear` of the input convolved with `responses`, into the
+// second half of `time`.
+static void convolve(const panner* self, const float* responses, int32_t ear,
+                     float* sum, float* time) {
+  const tau_hrtf* hrtf = self->hrtf;
+  int32_t partitions = hrtf->partitions;
+  memset(sum, 0, 2 * BIN_STRIDE * sizeof(float));
+  // Partition p of the responses meets the input of p quanta ago.
+  int32_t slot = self->head;
+  for (int32_t p = 0; p < partitions; p++) {
+    const float* input = self->delay + (size_t)slot * 2 * BIN_STRIDE;
+    const float* filter = responses + spectrum(partitions, ear, p);
+    tau_kernel_complex_multiply_add(sum, sum + BIN_STRIDE, input,
+                                    input + BIN_STRIDE, filter,
+                                    filter + BIN_STRIDE, BINS);
+    slot = slot > 0 ? slot - 1 : partitions - 1;
+  }
+  tau_fft_inverse(&hrtf->fft, sum, sum + BIN_STRIDE, time);
+}
+
+static void process_hrtf(tau_node* node, panner* self, int32_t cell,
+                         float gain) {
+  int32_t partitions = self->hrtf->partitions;
+  self->silent_quanta = node->input_silent ? self->silent_quanta + 1 : 0;
+  if (self->silent_quanta > partitions + 1) {
+    // The history and the delay line only hold zeros.
+    self->gains[0] = self->gains[1] = gain;
+    tau_node_output_silence(node, 2);
+    return;
+  }
+  memcpy(self->history, self->history + TAU_QUANTUM,
+         TAU_QUANTUM * sizeof(float));
+  if (node->input_silent) {
+    memset(self->history + TAU_QUANTUM, 0, TAU_QUANTUM * sizeof(float));
+  } else {
+    memcpy(self->history + TAU_QUANTUM, node->input,
+           TAU_QUANTUM * sizeof(float));
+  }
+  float* slot = self->delay + (size_t)self->head * 2 * BIN_STRIDE;
+  tau_fft_forward(&self->hrtf->fft, self->history, slot, slot + BIN_STRIDE);
+
+  const float* previous = self->responses;
+  if (previous == NULL || cell != self->cell) {
+    self->responses = lookup(self, cell);
+    self->cell = cell;
+  }
+  float* sum = (float*)tau_arena_alloc(2 * BIN_STRIDE * sizeof(float));
+  float* time = (float*)tau_arena_alloc(FFT_SIZE * sizeof(float));
+  float* fade = NULL;
+  if (previous != NULL && previous != self->responses) {
+    fade = (float*)tau_arena_alloc(TAU_QUANTUM * sizeof(float));
+    tau_kernel_ramp(fade, 1.0f / TAU_QUANTUM, 1.0f / TAU_QUANTUM,
+                    TAU_QUANTUM);
+  }
+  for (int32_t ear = 0; ear < 2; ear++) {
+    float* output = node->output + ear * TAU_QUANTUM;
+    convolve(self, self->responses, ear, sum, time);
+    memcpy(output, time + TAU_QUANTUM, TAU_QUANTUM * sizeof(float));
+    if (fade != NULL) {
+      // From the old responses to the new: old + (new - old) * fade.
+      convolve(self, previous, ear, sum, time);
+      const float* old = time + TAU_QUANTUM;
+      tau_kernel_scale_add(output, old, -1.0f, TAU_QUANTUM);
+      tau_kernel_multiply(output, output, fade, TAU_QUANTUM);
+      tau_kernel_add(output, old, TAU_QUANTUM);
+    }
+    apply_gain(output, output, self->rendered ? self->gains[ear] : gain,
+               gain);
+    self->gains[ear] = gain;
+  }
+  self->head = self->head + 1 < partitions ? self->head + 1 : 0;
+  node->output_channels = 2;
+  node->output_silent = 0;
+}
+
+// The equal-power panning of Web Audio for a mono input.
+static void process_equal_power(tau_node* node, panner* self, float azimuth,
+                                float gain) {
+  // Sources behind the listener pan as their mirror image in front.
+  if (azimuth < -90.0f) {
+    azimuth = -180.0f - azimuth;
+  } else if (azimuth > 90.0f) {
+    azimuth = 180.0f - azimuth;
+  }
+  float x = (azimuth + 90.0f) / 180.0f * (float)(TAU_PI / 2.0);
+  float gains[2] = {cosf(x) * gain, sinf(x) * gain};
+  if (node->input_silent) {
+    self->gains[0] = gains[0];
+    self->gains[1] = gains[1];
+    tau_node_output_silence(node, 2);
+    return;
+  }
+  for (int32_t ear = 0; ear < 2; ear++) {
+    apply_gain(node->output + ear * TAU_QUANTUM, node->input,
+               self->rendered ? self->gains[ear] : gains[ear], gains[ear]);
+    self->gains[ear] = gains[ear];
+  }
+  node->output_channels = 2;
+  node->output_silent = 0;
+}
+
+static void process_panner(tau_context* context, tau_node* node) {
+  panner* self = ((panner_state*)node->state)->self;
+  float x =
+      tau_param_render_k(context, tau_node_param(node, TAU_PARAM_POSITION_X));
+  float y =
+      tau_param_render_k(context, tau_node_param(node, TAU_PARAM_POSITION_Y));
+  float z =
+      tau_param_render_k(context, tau_node_param(node, TAU_PARAM_POSITION_Z));
+  float distance = sqrtf(x * x + y * y + z * z);
+  // A source at the listener is straight ahead.
+  float azimuth = 0.0f;
+  float elevation = 0.0f;
+  if (distance > 0.0f) {
+    azimuth = atan2f(x, -z) * (float)(180.0 / TAU_PI);
+    elevation = asinf(fminf(fmaxf(y / distance, -1.0f), 1.0f)) *
+                (float)(180.0 / TAU_PI);
+  }
+  float gain =
+      REF_DISTANCE /
+      (REF_DISTANCE +
+       ROLLOFF_FACTOR * (fmaxf(distance, REF_DISTANCE) - REF_DISTANCE));
+  if (self->hrtf != NULL) {
+    process_hrtf(node, self, cell_of(azimuth, elevation), gain);
+  } else {
+    process_equal_power(node, self, azimuth, gain);
+  }
+  self->rendered = 1;
+}
+
+static void destroy_panner(tau_node* node) {
+  panner_free(((panner_state*)node->state)->self);
+}
+
+static const tau_node_ops panner_ops = {process_panner, destroy_panner};
+
+static panner* panner_new(tau_hrtf* hrtf) {
+  panner* self = (panner*)tau_memory_calloc(sizeof(panner), TAU_CACHE_LINE);
+  if (self == NULL) {
+    return NULL;
+  }
+  if (hrtf == NULL) {
+    return self;
+  }
+  tau_hrtf_retain(hrtf);
+  self->hrtf = hrtf;
+  self->own = (float*)tau_memory_alloc(
+      2 * (size_t)hrtf->entry_floats * sizeof(float), TAU_CACHE_LINE);
+  self->history = (float*)tau_memory_calloc(FFT_SIZE * sizeof(float),
+                                            TAU_CACHE_LINE);
+  self->delay = (float*)tau_memory_calloc(
+      (size_t)hrtf->partitions * 2 * BIN_STRIDE * sizeof(float),
+      TAU_CACHE_LINE);
+  if (self->own == NULL || self->history == NULL || self->delay == NULL) {
+    panner_free(self);
+    return NULL;
+  }
+  // Starts as if the input had always been silent.
+  self->silent_quanta = hrtf->partitions + 1;
+  return self;
+}
+
+FFI_PLUGIN_EXPORT tau_hrtf* tau_hrtf_create(const float* left,
+                                            const float* right,
+                                            const float* azimuths,
+                                            const float* elevations,
+                                            int32_t count, int32_t frames,
+                                            float sample_rate) {
+  if (left == NULL || right == NULL || azimuths == NULL ||
+      elevations == NULL || count <= 0 || frames <= 0 ||
+      frames > TAU_HRTF_MAX_FRAMES || !(sample_rate > 0.0f)) {
+    return NULL;
+  }
+  for (int32_t i = 0; i < count; i++) {
+    if (!isfinite(azimuths[i]) || !isfinite(elevations[i])) {
+      return NULL;
+    }
+  }
+  tau_hrtf* hrtf =
+      (tau_hrtf*)tau_memory_calloc(sizeof(tau_hrtf), TAU_CACHE_LINE);
+  if (hrtf == NULL) {
+    return NULL;
+  }
+  hrtf->references = 1;
+  hrtf->sample_rate = sample_rate;
+  hrtf->count = count;
+  hrtf->partitions = (frames + TAU_QUANTUM - 1) / TAU_QUANTUM;
+  hrtf->entry_floats = 2 * hrtf->partitions * 2 * BIN_STRIDE;
+  size_t entry_bytes = (size_t)hrtf->entry_floats * sizeof(float);
+  hrtf->capacity = (int32_t)(CACHE_BYTES / entry_bytes);
+  hrtf->capacity = hrtf->capacity < CELLS ? hrtf->capacity : CELLS;
+  hrtf->directions = (float*)tau_memory_alloc(
+      (size_t)count * 3 * sizeof(float), TAU_CACHE_LINE);
+  // Zeroed, for the padding between spectra.
+  hrtf->measured =
+      (float*)tau_memory_calloc((size_t)count * entry_bytes, TAU_CACHE_LINE);
+  hrtf->cells = (volatile int32_t*)tau_memory_alloc(
+      CELLS * sizeof(int32_t), TAU_CACHE_LINE);
+  hrtf->cache = (float*)tau_memory_alloc(
+      (size_t)hrtf->capacity * entry_bytes, TAU_CACHE_LINE);
+  float* time =
+      (float*)tau_memory_alloc(FFT_SIZE * sizeof(float), TAU_CACHE_LINE);
+  if (tau_fft_init(&hrtf->fft, FFT_SIZE) != TAU_OK ||
+      hrtf->directions == NULL || hrtf->measured == NULL ||
+      hrtf->cells == NULL || hrtf->cache == NULL || time == NULL) {
+    tau_memory_free(time);
+    hrtf_free(hrtf);
+    return NULL;
+  }
+  memset((void*)hrtf->cells, 0xff, CELLS * sizeof(int32_t));
+  for (int32_t i = 0; i < count; i++) {
+    direction(azimuths[i], elevations[i], hrtf->directions + 3 * i);
+    float* entry = hrtf->measured + (size_t)i * hrtf->entry_floats;
+    for (int32_t ear = 0; ear < 2; ear++) {
+      const float* samples = (ear == 0 ? left : right) + (size_t)i * frames;
+      for (int32_t p = 0; p < hrtf->partitions; p++) {
+        int32_t offset = p * TAU_QUANTUM;
+        int32_t length = frames - offset < TAU_QUANTUM ? frames - offset
+                                                       : TAU_QUANTUM;
+        memset(time, 0, FFT_SIZE * sizeof(float));
+        tau_kernel_scale(time, samples + offset, 1.0f / FFT_SIZE, length);
+        float* bins = entry + spectrum(hrtf->partitions, ear, p);
+        tau_fft_forward(&hrtf->fft, time, bins, bins + BIN_STRIDE);
+      }
+    }
+  }
+  tau_memory_free(time);
+  return hrtf;
+}
+
+FFI_PLUGIN_EXPORT void tau_hrtf_retain(tau_hrtf* hrtf) {
+  if (hrtf != NULL) {
+    tau_atomic_fetch_add_i32(&hrtf->references, 1);
+  }
+}
+
+FFI_PLUGIN_EXPORT void tau_hrtf_release(tau_hrtf* hrtf) {
+  if (hrtf == NULL ||
+      tau_atomic_fetch_add_i32(&hrtf->references, -1) != 1) {
+    return;
+  }
+  hrtf_free(hrtf);
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_hrtf_cached_cells(tau_hrtf* hrtf) {
+  if (hrtf == NULL) {
+    return 0;
+  }
+  int32_t used = tau_atomic_load_relaxed_i32(&hrtf->used);
+  return used < hrtf->capacity ? used : hrtf->capacity;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_panner_create(tau_context* context,
+                                            tau_hrtf* hrtf) {
+  if (context == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  if (hrtf != NULL && hrtf->sample_rate != context->sample_rate) {
+    return TAU_ERROR_NOT_SUPPORTED;
+  }
+  panner* self = panner_new(hrtf);
+  if (self == NULL) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  tau_node* node =
+      tau_node_create(context, &panner_ops, sizeof(panner_state), 2);
+  if (node == NULL) {
+    panner_free(self);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  ((panner_state*)node->state)->self = self;
+  int32_t status = tau_node_set_channels(
+      context, node, 1, TAU_CHANNELS_EXPLICIT, TAU_INTERPRETATION_SPEAKERS);
+  if (status != TAU_OK) {
+    tau_node_release(context, node->id);
+    return status;
+  }
+  tau_node_add_param(node, TAU_PARAM_POSITION_X, 0, -FLT_MAX, FLT_MAX);
+  tau_node_add_param(node, TAU_PARAM_POSITION_Y, 0, -FLT_MAX, FLT_MAX);
+  tau_node_add_param(node, TAU_PARAM_POSITION_Z, 0, -FLT_MAX, FLT_MAX);
+  return node->id;
+}
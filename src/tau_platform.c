@@ -0,0 +1,217 @@
+#include "tau_platform.h"
+
+#if !_WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+typedef struct tau_thread_start_args {
+  tau_thread_fn fn;
+  void* arg;
+} tau_thread_start_args;
+
+#if _WIN32
+static DWORD WINAPI tau_thread_main(LPVOID param) {
+#else
+static void* tau_thread_main(void* param) {
+#endif
+  tau_thread_start_args args = *(tau_thread_start_args*)param;
+  free(param);
+  args.fn(args.arg);
+#if _WIN32
+  return 0;
+#else
+  return NULL;
+#endif
+}
+
+int tau_thread_start(tau_thread* thread, tau_thread_fn fn, void* arg) {
+  tau_thread_start_args* args =
+      (tau_thread_start_args*)malloc(sizeof(tau_thread_start_args));
+  if (args == NULL) {
+    return -1;
+  }
+  args->fn = fn;
+  args->arg = arg;
+#if _WIN32
+  *thread = CreateThread(NULL, 0, tau_thread_main, args, 0, NULL);
+  if (*thread == NULL) {
+    free(args);
+    return -1;
+  }
+#else
+  if (pthread_create(thread, NULL, tau_thread_main, args) != 0) {
+    free(args);
+    return -1;
+  }
+#endif
+  return 0;
+}
+
+void tau_thread_join(tau_thread thread) {
+#if _WIN32
+  WaitForSingleObject(thread, INFINITE);
+  CloseHandle(thread);
+#else
+  pthread_join(thread, NULL);
+#endif
+}
+
+void tau_sleep_until(int64_t time_ns) {
+#if _WIN32
+  int64_t left;
+  while ((left = time_ns - tau_now_ns()) > 0) {
+    if (left >= 2000000) {
+      Sleep((DWORD)(left / 1000000 - 1));
+    } else {
+      SwitchToThread();
+    }
+  }
+#elif defined(__APPLE__)
+  // Darwin has no absolute sleep on the monotonic clock.
+  int64_t left = time_ns - tau_now_ns();
+  if (left > 0) {
+    struct timespec duration = {(time_t)(left / 1000000000),
+                                (long)(left % 1000000000)};
+    while (nanosleep(&duration, &duration) != 0 && errno == EINTR) {
+    }
+  }
+#else
+  struct timespec time = {(time_t)(time_ns / 1000000000),
+                          (long)(time_ns % 1000000000)};
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, NULL) ==
+         EINTR) {
+  }
+#endif
+}
+
+int tau_semaphore_init(tau_semaphore* semaphore) {
+#if _WIN32
+  *semaphore = CreateSemaphoreA(NULL, 0, 0x7fffffff, NULL);
+  return *semaphore != NULL ? 0 : -1;
+#elif defined(__APPLE__)
+  *semaphore = dispatch_semaphore_create(0);
+  return *semaphore != NULL ? 0 : -1;
+#else
+  return sem_init(semaphore, 0, 0) == 0 ? 0 : -1;
+#endif
+}
+
+void tau_semaphore_destroy(tau_semaphore* semaphore) {
+#if _WIN32
+  CloseHandle(*semaphore);
+#elif defined(__APPLE__)
+  dispatch_release(*semaphore);
+#else
+  sem_destroy(semaphore);
+#endif
+}
+
+void tau_semaphore_post(tau_semaphore* semaphore) {
+#if _WIN32
+  ReleaseSemaphore(*semaphore, 1, NULL);
+#elif defined(__APPLE__)
+  dispatch_semaphore_signal(*semaphore);
+#else
+  sem_post(semaphore);
+#endif
+}
+
+int tau_semaphore_wait(tau_semaphore* semaphore, int32_t timeout_ms) {
+#if _WIN32
+  return WaitForSingleObject(*semaphore, timeout_ms < 0 ? INFINITE
+                                                        : (DWORD)timeout_ms) ==
+         WAIT_OBJECT_0;
+#elif defined(__APPLE__)
+  dispatch_time_t deadline =
+      timeout_ms < 0
+          ? DISPATCH_TIME_FOREVER
+          : dispatch_time(DISPATCH_TIME_NOW, (int64_t)timeout_ms * 1000000);
+  return dispatch_semaphore_wait(*semaphore, deadline) == 0;
+#else
+  if (timeout_ms < 0) {
+    while (sem_wait(semaphore) != 0) {
+      if (errno != EINTR) {
+        return 0;
+      }
+    }
+    return 1;
+  }
+  // `sem_timedwait` only takes a deadline on the realtime clock.
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  int64_t nanoseconds =
+      deadline.tv_nsec + (int64_t)(timeout_ms % 1000) * 1000000;
+  deadline.tv_sec += timeout_ms / 1000 + (time_t)(nanoseconds / 1000000000);
+  deadline.tv_nsec = (long)(nanoseconds % 1000000000);
+  while (sem_timedwait(semaphore, &deadline) != 0) {
+    if (errno != EINTR) {
+      return 0;
+    }
+  }
+  return 1;
+#endif
+}
+
+int tau_cpu_count(void) {
+#if _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return (int)info.dwNumberOfProcessors;
+#else
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (int)count : 1;
+#endif
+}
+
+void* tau_map_file(const char* path, int64_t* size) {
+#if _WIN32
+  HANDLE file = CreateFileA(path, GENERIC_READ,
+                            FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return NULL;
+  }
+  LARGE_INTEGER length;
+  HANDLE mapping = NULL;
+  if (GetFileSizeEx(file, &length) && length.QuadPart > 0) {
+    mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+  }
+  CloseHandle(file);
+  if (mapping == NULL) {
+    return NULL;
+  }
+  void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+  CloseHandle(mapping);
+  *size = length.QuadPart;
+  return view;
+#else
+  int file = open(path, O_RDONLY);
+  if (file < 0) {
+    return NULL;
+  }
+  struct stat status;
+  void* view = MAP_FAILED;
+  if (fstat(file, &status) == 0 && status.st_size > 0) {
+    view = mmap(NULL, (size_t)status.st_size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE, file, 0);
+  }
+  close(file);
+  if (view == MAP_FAILED) {
+    return NULL;
+  }
+  *size = (int64_t)status.st_size;
+  return view;
+#endif
+}
+
+void tau_unmap_file(void* mapping, int64_t size) {
+#if _WIN32
+  (void)size;
+  UnmapViewOfFile(mapping);
+#else
+  munmap(mapping, (size_t)size);
+#endif
+}
@@ -0,0 +1,339 @@
+// Threads, synchronization and atomics shared by the native sources.
+//
+// This header is internal: it is not an entry point for ffigen and nothing in
+// it is exported from the library.
+#ifndef TAU_PLATFORM_H_
+#define TAU_PLATFORM_H_
+
+#include "tau_ffi.h"
+
+#if _WIN32
+#elif defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#include <sched.h>
+#include <time.h>
+#else
+#include <sched.h>
+#include <semaphore.h>
+#include <time.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TAU_THREAD_LOCAL __declspec(thread)
+#define TAU_ALIGNAS(n) __declspec(align(n))
+#else
+#define TAU_THREAD_LOCAL __thread
+#define TAU_ALIGNAS(n) __attribute__((aligned(n)))
+#endif
+
+// The size that separates data written by different threads.
+#define TAU_CACHE_LINE 64
+
+// Atomics.
+//
+// `load` has acquire, `store` release, and read-modify-write operations
+// sequentially consistent semantics. The `_relaxed` variants impose no
+// ordering.
+#if defined(_MSC_VER)
+static inline int32_t tau_atomic_load_i32(const volatile int32_t* p) {
+  return (int32_t)_InterlockedCompareExchange((volatile long*)p, 0, 0);
+}
+static inline void tau_atomic_store_i32(volatile int32_t* p, int32_t v) {
+  _InterlockedExchange((volatile long*)p, (long)v);
+}
+static inline int32_t tau_atomic_fetch_add_i32(volatile int32_t* p, int32_t v) {
+  return (int32_t)_InterlockedExchangeAdd((volatile long*)p, (long)v);
+}
+static inline int32_t tau_atomic_exchange_i32(volatile int32_t* p, int32_t v) {
+  return (int32_t)_InterlockedExchange((volatile long*)p, (long)v);
+}
+static inline int tau_atomic_cas_i32(volatile int32_t* p, int32_t* expected,
+                                     int32_t desired) {
+  int32_t seen = (int32_t)_InterlockedCompareExchange(
+      (volatile long*)p, (long)desired, (long)*expected);
+  if (seen == *expected) return 1;
+  *expected = seen;
+  return 0;
+}
+static inline int64_t tau_atomic_load_i64(const volatile int64_t* p) {
+  return _InterlockedCompareExchange64((volatile __int64*)p, 0, 0);
+}
+static inline void tau_atomic_store_i64(volatile int64_t* p, int64_t v) {
+  _InterlockedExchange64((volatile __int64*)p, v);
+}
+static inline int64_t tau_atomic_fetch_add_i64(volatile int64_t* p, int64_t v) {
+  return _InterlockedExchangeAdd64((volatile __int64*)p, v);
+}
+static inline int64_t tau_atomic_exchange_i64(volatile int64_t* p, int64_t v) {
+  return _InterlockedExchange64((volatile __int64*)p, v);
+}
+static inline int tau_atomic_cas_i64(volatile int64_t* p, int64_t* expected,
+                                     int64_t desired) {
+  int64_t seen =
+      _InterlockedCompareExchange64((volatile __int64*)p, desired, *expected);
+  if (seen == *expected) return 1;
+  *expected = seen;
+  return 0;
+}
+static inline void* tau_atomic_load_ptr(void* const volatile* p) {
+  return _InterlockedCompareExchangePointer((void* volatile*)p, NULL, NULL);
+}
+static inline void tau_atomic_store_ptr(void* volatile* p, void* v) {
+  _InterlockedExchangePointer(p, v);
+}
+static inline void* tau_atomic_exchange_ptr(void* volatile* p, void* v) {
+  return _InterlockedExchangePointer(p, v);
+}
+static inline int tau_atomic_cas_ptr(void* volatile* p, void** expected,
+                                     void* desired) {
+  void* seen = _InterlockedCompareExchangePointer(p, desired, *expected);
+  if (seen == *expected) return 1;
+  *expected = seen;
+  return 0;
+}
+// Interlocked operations are full barriers, so the relaxed variants simply
+// reuse them.
+#define tau_atomic_load_relaxed_i32 tau_atomic_load_i32
+#define tau_atomic_store_relaxed_i32 tau_atomic_store_i32
+#define tau_atomic_load_relaxed_i64 tau_atomic_load_i64
+#define tau_atomic_store_relaxed_i64 tau_atomic_store_i64
+#define tau_atomic_load_relaxed_ptr tau_atomic_load_ptr
+#define tau_atomic_store_relaxed_ptr tau_atomic_store_ptr
+static inline void tau_atomic_fence(void) { MemoryBarrier(); }
+static inline void tau_cpu_relax(void) { YieldProcessor(); }
+#else
+#define TAU_DEFINE_ATOMICS(suffix, type)                                      \
+  static inline type tau_atomic_load_##suffix(type const volatile* p) {       \
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);                              \
+  }                                                                           \
+  static inline type tau_atomic_load_relaxed_##suffix(type const volatile* p) { \
+    return __atomic_load_n(p, __ATOMIC_RELAXED);                              \
+  }                                                                           \
+  static inline void tau_atomic_store_##suffix(type volatile* p, type v) {    \
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);                                 \
+  }                                                                           \
+  static inline void tau_atomic_store_relaxed_##suffix(type volatile* p,      \
+                                                       type v) {              \
+    __atomic_store_n(p, v, __ATOMIC_RELAXED);                                 \
+  }                                                                           \
+  static inline type tau_atomic_exchange_##suffix(type volatile* p, type v) { \
+    return __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST);                       \
+  }                                                                           \
+  static inline int tau_atomic_cas_##suffix(type volatile* p, type* expected, \
+                                            type desired) {                   \
+    return __atomic_compare_exchange_n(p, expected, desired, 0,               \
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);   \
+  }
+TAU_DEFINE_ATOMICS(i32, int32_t)
+TAU_DEFINE_ATOMICS(i64, int64_t)
+TAU_DEFINE_ATOMICS(ptr, void*)
+#undef TAU_DEFINE_ATOMICS
+static inline int32_t tau_atomic_fetch_add_i32(volatile int32_t* p, int32_t v) {
+  return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+}
+static inline int64_t tau_atomic_fetch_add_i64(volatile int64_t* p, int64_t v) {
+  return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+}
+static inline void tau_atomic_fence(void) {
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+static inline void tau_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield");
+#endif
+}
+#endif
+
+// The index of the highest bit set in `v`, which must not be 0.
+static inline int32_t tau_highest_bit(uint64_t v) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanReverse64(&index, v);
+  return (int32_t)index;
+#else
+  return 63 - __builtin_clzll(v);
+#endif
+}
+
+// Memory aligned to `alignment`, a power of two no smaller than a pointer,
+// released with `tau_aligned_free`.
+static inline void* tau_aligned_alloc(size_t size, size_t alignment) {
+#if _WIN32
+  return _aligned_malloc(size, alignment);
+#else
+  void* memory = NULL;
+  if (posix_memalign(&memory, alignment, size) != 0) {
+    return NULL;
+  }
+  return memory;
+#endif
+}
+
+static inline void tau_aligned_free(void* memory) {
+#if _WIN32
+  _aligned_free(memory);
+#else
+  free(memory);
+#endif
+}
+
+// Threads.
+#if _WIN32
+typedef HANDLE tau_thread;
+typedef SRWLOCK tau_mutex;
+typedef CONDITION_VARIABLE tau_cond;
+#else
+typedef pthread_t tau_thread;
+typedef pthread_mutex_t tau_mutex;
+typedef pthread_cond_t tau_cond;
+#endif
+
+// A counting semaphore. Darwin has no unnamed POSIX semaphores, so it uses
+// a dispatch semaphore; elsewhere `sem_t`, which is a futex on Linux and
+// Android. Posting only enters the kernel when a thread is waiting, so the
+// rendering thread may post.
+#if _WIN32
+typedef HANDLE tau_semaphore;
+#elif defined(__APPLE__)
+typedef dispatch_semaphore_t tau_semaphore;
+#else
+typedef sem_t tau_semaphore;
+#endif
+
+typedef void (*tau_thread_fn)(void* arg);
+
+// Starts `fn(arg)` on a new thread. Returns 0 on success.
+int tau_thread_start(tau_thread* thread, tau_thread_fn fn, void* arg);
+
+// Waits for a thread started by `tau_thread_start` to finish.
+void tau_thread_join(tau_thread thread);
+
+// Sleeps until `tau_now_ns` reaches `time_ns`, to the precision of the
+// system timer.
+void tau_sleep_until(int64_t time_ns);
+
+static inline void tau_mutex_init(tau_mutex* mutex) {
+#if _WIN32
+  InitializeSRWLock(mutex);
+#else
+  pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+static inline void tau_mutex_destroy(tau_mutex* mutex) {
+#if _WIN32
+  (void)mutex;
+#else
+  pthread_mutex_destroy(mutex);
+#endif
+}
+
+static inline void tau_mutex_lock(tau_mutex* mutex) {
+#if _WIN32
+  AcquireSRWLockExclusive(mutex);
+#else
+  pthread_mutex_lock(mutex);
+#endif
+}
+
+static inline void tau_mutex_unlock(tau_mutex* mutex) {
+#if _WIN32
+  ReleaseSRWLockExclusive(mutex);
+#else
+  pthread_mutex_unlock(mutex);
+#endif
+}
+
+static inline void tau_cond_init(tau_cond* cond) {
+#if _WIN32
+  InitializeConditionVariable(cond);
+#else
+  pthread_cond_init(cond, NULL);
+#endif
+}
+
+static inline void tau_cond_destroy(tau_cond* cond) {
+#if _WIN32
+  (void)cond;
+#else
+  pthread_cond_destroy(cond);
+#endif
+}
+
+static inline void tau_cond_wait(tau_cond* cond, tau_mutex* mutex) {
+#if _WIN32
+  SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+#else
+  pthread_cond_wait(cond, mutex);
+#endif
+}
+
+static inline void tau_cond_signal(tau_cond* cond) {
+#if _WIN32
+  WakeConditionVariable(cond);
+#else
+  pthread_cond_signal(cond);
+#endif
+}
+
+static inline void tau_cond_broadcast(tau_cond* cond) {
+#if _WIN32
+  WakeAllConditionVariable(cond);
+#else
+  pthread_cond_broadcast(cond);
+#endif
+}
+
+// Creates a semaphore with a count of 0. Returns 0 on success.
+int tau_semaphore_init(tau_semaphore* semaphore);
+
+void tau_semaphore_destroy(tau_semaphore* semaphore);
+
+// Adds one to the count, waking a waiting thread.
+void tau_semaphore_post(tau_semaphore* semaphore);
+
+// Waits up to `timeout_ms` milliseconds, or forever if negative, for the
+// count to be positive, and takes one from it. Returns 1 if it did, and 0 on
+// timeout.
+int tau_semaphore_wait(tau_semaphore* semaphore, int32_t timeout_ms);
+
+// Gives up the rest of the time slice of the calling thread.
+static inline void tau_thread_yield(void) {
+#if _WIN32
+  SwitchToThread();
+#else
+  sched_yield();
+#endif
+}
+
+// The number of processors available to this process.
+int tau_cpu_count(void);
+
+// Maps the whole file at `path` into memory, copy-on-write: pages written to
+// become private to the mapping, and the file is never modified. Returns the
+// mapping and stores its size in `size`, or returns NULL.
+void* tau_map_file(const char* path, int64_t* size);
+
+// Unmaps a mapping made by `tau_map_file`. The file may have been deleted.
+void tau_unmap_file(void* mapping, int64_t size);
+
+// A monotonic clock, in nanoseconds.
+static inline int64_t tau_now_ns(void) {
+#if _WIN32
+  LARGE_INTEGER frequency;
+  LARGE_INTEGER counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (int64_t)((double)counter.QuadPart * 1e9 /
+                   (double)frequency.QuadPart);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+}
+
+#endif  // TAU_PLATFORM_H_
@@ -0,0 +1,284 @@
+#include "tau_pool.h"
+
+#include <string.h>
+
+#include "tau_memory.h"
+
+// Deque capacity. A worker whose deque is full falls back to the injection
+// queue, so this only bounds the fast path.
+#define TAU_DEQUE_CAPACITY 1024
+#define TAU_DEQUE_MASK (TAU_DEQUE_CAPACITY - 1)
+
+// How many rounds of stealing an idle worker tries before it sleeps.
+#define TAU_IDLE_SPINS 64
+
+typedef struct tau_worker {
+  // Written by thieves; kept on its own cache line away from `bottom`.
+  TAU_ALIGNAS(TAU_CACHE_LINE) volatile int64_t top;
+  TAU_ALIGNAS(TAU_CACHE_LINE) volatile int64_t bottom;
+  void* volatile tasks[TAU_DEQUE_CAPACITY];
+  tau_pool* pool;
+  tau_thread thread;
+  int index;
+} tau_worker;
+
+struct tau_pool {
+  tau_worker* workers;
+  int thread_count;
+
+  // The injection queue, for tasks submitted from outside the pool.
+  tau_mutex queue_mutex;
+  tau_task* queue_head;
+  tau_task* queue_tail;
+  volatile int32_t queue_length;
+
+  // Idle workers sleep on `wake` once `epoch`, bumped by every submission, has
+  // not moved during a full scan for work.
+  tau_mutex sleep_mutex;
+  tau_cond wake;
+  volatile int64_t epoch;
+  volatile int32_t sleepers;
+  volatile int32_t stopping;
+};
+
+// The worker running on the current thread, if any.
+static TAU_THREAD_LOCAL tau_worker* current_worker;
+
+// Pushes to the bottom of the deque of the calling worker.
+static int deque_push(tau_worker* worker, tau_task* task) {
+  int64_t bottom = tau_atomic_load_relaxed_i64(&worker->bottom);
+  int64_t top = tau_atomic_load_i64(&worker->top);
+  if (bottom - top >= TAU_DEQUE_CAPACITY) {
+    return 0;
+  }
+  tau_atomic_store_relaxed_ptr(&worker->tasks[bottom & TAU_DEQUE_MASK], task);
+  tau_atomic_store_i64(&worker->bottom, bottom + 1);
+  return 1;
+}
+
+// Pops from the bottom of the deque of the calling worker.
+static tau_task* deque_pop(tau_worker* worker) {
+  int64_t bottom = tau_atomic_load_relaxed_i64(&worker->bottom) - 1;
+  tau_atomic_store_relaxed_i64(&worker->bottom, bottom);
+  tau_atomic_fence();
+  int64_t top = tau_atomic_load_relaxed_i64(&worker->top);
+  if (top > bottom) {
+    tau_atomic_store_relaxed_i64(&worker->bottom, bottom + 1);
+    return NULL;
+  }
+  tau_task* task = (tau_task*)tau_atomic_load_relaxed_ptr(
+      &worker->tasks[bottom & TAU_DEQUE_MASK]);
+  if (top == bottom) {
+    // Last task: race the thieves for it.
+    if (!tau_atomic_cas_i64(&worker->top, &top, top + 1)) {
+      task = NULL;
+    }
+    tau_atomic_store_relaxed_i64(&worker->bottom, bottom + 1);
+  }
+  return task;
+}
+
+// Takes from the top of the deque of another worker.
+static tau_task* deque_steal(tau_worker* victim) {
+  int64_t top = tau_atomic_load_i64(&victim->top);
+  tau_atomic_fence();
+  int64_t bottom = tau_atomic_load_i64(&victim->bottom);
+  if (top >= bottom) {
+    return NULL;
+  }
+  tau_task* task = (tau_task*)tau_atomic_load_relaxed_ptr(
+      &victim->tasks[top & TAU_DEQUE_MASK]);
+  if (!tau_atomic_cas_i64(&victim->top, &top, top + 1)) {
+    return NULL;
+  }
+  return task;
+}
+
+static void queue_push(tau_pool* pool, tau_task* task) {
+  task->next = NULL;
+  tau_mutex_lock(&pool->queue_mutex);
+  if (pool->queue_tail != NULL) {
+    pool->queue_tail->next = task;
+  } else {
+    pool->queue_head = task;
+  }
+  pool->queue_tail = task;
+  tau_atomic_fetch_add_i32(&pool->queue_length, 1);
+  tau_mutex_unlock(&pool->queue_mutex);
+}
+
+static tau_task* queue_pop(tau_pool* pool) {
+  if (tau_atomic_load_i32(&pool->queue_length) == 0) {
+    return NULL;
+  }
+  tau_mutex_lock(&pool->queue_mutex);
+  tau_task* task = pool->queue_head;
+  if (task != NULL) {
+    pool->queue_head = task->next;
+    if (pool->queue_head == NULL) {
+      pool->queue_tail = NULL;
+    }
+    tau_atomic_fetch_add_i32(&pool->queue_length, -1);
+  }
+  tau_mutex_unlock(&pool->queue_mutex);
+  return task;
+}
+
+// Finds work for `self`, which is NULL on threads outside the pool.
+static tau_task* find_task(tau_pool* pool, tau_worker* self) {
+  tau_task* task = self != NULL ? deque_pop(self) : NULL;
+  if (task == NULL) {
+    task = queue_pop(pool);
+  }
+  if (task == NULL) {
+    int start = self != NULL ? self->index + 1 : 0;
+    for (int i = 0; i < pool->thread_count && task == NULL; i++) {
+      tau_worker* victim = &pool->workers[(start + i) % pool->thread_count];
+      if (victim != self) {
+        task = deque_steal(victim);
+      }
+    }
+  }
+  return task;
+}
+
+static void wake_one(tau_pool* pool) {
+  tau_atomic_fetch_add_i64(&pool->epoch, 1);
+  if (tau_atomic_load_i32(&pool->sleepers) > 0) {
+    tau_mutex_lock(&pool->sleep_mutex);
+    tau_cond_signal(&pool->wake);
+    tau_mutex_unlock(&pool->sleep_mutex);
+  }
+}
+
+static void worker_main(void* arg) {
+  tau_worker* self = (tau_worker*)arg;
+  tau_pool* pool = self->pool;
+  current_worker = self;
+  for (;;) {
+    int64_t epoch = tau_atomic_load_i64(&pool->epoch);
+    tau_task* task = NULL;
+    for (int spin = 0; spin < TAU_IDLE_SPINS && task == NULL; spin++) {
+      task = find_task(pool, self);
+      if (task == NULL) {
+        tau_cpu_relax();
+      }
+    }
+    if (task != NULL) {
+      task->run(task);
+      continue;
+    }
+    tau_mutex_lock(&pool->sleep_mutex);
+    tau_atomic_fetch_add_i32(&pool->sleepers, 1);
+    int stopping = tau_atomic_load_i32(&pool->stopping);
+    if (!stopping && tau_atomic_load_i64(&pool->epoch) == epoch) {
+      tau_cond_wait(&pool->wake, &pool->sleep_mutex);
+    }
+    tau_atomic_fetch_add_i32(&pool->sleepers, -1);
+    tau_mutex_unlock(&pool->sleep_mutex);
+    if (stopping && tau_atomic_load_i64(&pool->epoch) == epoch) {
+      // Nothing was submitted since the last empty scan.
+      break;
+    }
+  }
+  current_worker = NULL;
+  // Render tasks allocate scratch memory from the arena of the worker.
+  tau_arena_release();
+}
+
+// Stops and joins the first `started` workers, then frees the pool.
+static void pool_stop(tau_pool* pool, int started) {
+  tau_mutex_lock(&pool->sleep_mutex);
+  tau_atomic_store_i32(&pool->stopping, 1);
+  tau_atomic_fetch_add_i64(&pool->epoch, 1);
+  tau_cond_broadcast(&pool->wake);
+  tau_mutex_unlock(&pool->sleep_mutex);
+  for (int i = 0; i < started; i++) {
+    tau_thread_join(pool->workers[i].thread);
+  }
+  tau_cond_destroy(&pool->wake);
+  tau_mutex_destroy(&pool->sleep_mutex);
+  tau_mutex_destroy(&pool->queue_mutex);
+  tau_aligned_free(pool->workers);
+  free(pool);
+}
+
+tau_pool* tau_pool_create(int threads) {
+  if (threads <= 0) {
+    threads = tau_cpu_count();
+  }
+  tau_pool* pool = (tau_pool*)calloc(1, sizeof(tau_pool));
+  if (pool == NULL) {
+    return NULL;
+  }
+  size_t workers_size = (size_t)threads * sizeof(tau_worker);
+  pool->workers = (tau_worker*)tau_aligned_alloc(workers_size, TAU_CACHE_LINE);
+  if (pool->workers == NULL) {
+    free(pool);
+    return NULL;
+  }
+  memset(pool->workers, 0, workers_size);
+  pool->thread_count = threads;
+  tau_mutex_init(&pool->queue_mutex);
+  tau_mutex_init(&pool->sleep_mutex);
+  tau_cond_init(&pool->wake);
+  for (int i = 0; i < threads; i++) {
+    pool->workers[i].pool = pool;
+    pool->workers[i].index = i;
+  }
+  for (int i = 0; i < threads; i++) {
+    if (tau_thread_start(&pool->workers[i].thread, worker_main,
+                         &pool->workers[i]) != 0) {
+      pool_stop(pool, i);
+      return NULL;
+    }
+  }
+  return pool;
+}
+
+void tau_pool_destroy(tau_pool* pool) {
+  if (pool != NULL) {
+    pool_stop(pool, pool->thread_count);
+  }
+}
+
+int tau_pool_thread_count(const tau_pool* pool) { return pool->thread_count; }
+
+void tau_pool_submit(tau_pool* pool, tau_task* task) {
+  tau_worker* self = current_worker;
+  if (self == NULL || self->pool != pool || !deque_push(self, task)) {
+    queue_push(pool, task);
+  }
+  wake_one(pool);
+}
+
+int tau_pool_run_one(tau_pool* pool) {
+  tau_worker* self = current_worker;
+  tau_task* task = find_task(pool, self != NULL && self->pool == pool ? self
+                                                                      : NULL);
+  if (task == NULL) {
+    return 0;
+  }
+  task->run(task);
+  return 1;
+}
+
+static tau_pool* volatile shared_pool;
+
+tau_pool* tau_pool_shared(void) {
+  tau_pool* pool = (tau_pool*)tau_atomic_load_ptr((void* volatile*)&shared_pool);
+  if (pool != NULL) {
+    return pool;
+  }
+  tau_pool* created = tau_pool_create(0);
+  if (created == NULL) {
+    return NULL;
+  }
+  void* expected = NULL;
+  if (!tau_atomic_cas_ptr((void* volatile*)&shared_pool, &expected, created)) {
+    // Another thread won the race.
+    tau_pool_destroy(created);
+    return (tau_pool*)expected;
+  }
+  return created;
+}
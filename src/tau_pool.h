@@ -0,0 +1,45 @@
+// A work-stealing pool of native worker threads.
+//
+// Every worker owns a Chase-Lev deque: tasks submitted from a worker are
+// pushed to, and popped from, the bottom of its own deque, while idle workers
+// steal from the top of the others. Tasks submitted from any other thread,
+// such as a Dart isolate, go through a shared injection queue.
+#ifndef TAU_POOL_H_
+#define TAU_POOL_H_
+
+#include "tau_platform.h"
+
+// A unit of work. The memory is owned by the submitter and must stay valid
+// until `run` is called; `run` may free it.
+typedef struct tau_task {
+  void (*run)(struct tau_task* task);
+  struct tau_task* next;
+} tau_task;
+
+typedef struct tau_pool tau_pool;
+
+// Starts a pool of `threads` workers, or one per processor if `threads` is
+// not positive. Returns NULL on failure.
+tau_pool* tau_pool_create(int threads);
+
+// Runs every task already submitted, then stops and frees the pool.
+void tau_pool_destroy(tau_pool* pool);
+
+// The number of workers in `pool`.
+int tau_pool_thread_count(const tau_pool* pool);
+
+// Queues `task` on `pool`. Never blocks on a running task; may be called from
+// any thread, including from a task.
+void tau_pool_submit(tau_pool* pool, tau_task* task);
+
+// Runs one queued task on the calling thread, if there is one.
+//
+// Threads waiting on work they submitted call this to help instead of
+// sleeping. Returns 1 if a task was run.
+int tau_pool_run_one(tau_pool* pool);
+
+// The pool shared by the whole library, sized to the processor count and
+// started on first use. Returns NULL if it cannot be started.
+tau_pool* tau_pool_shared(void);
+
+#endif  // TAU_POOL_H_
@@ -0,0 +1,80 @@
+// Timings of the rendering thread, for `tau_profile`.
+//
+// The thread rendering a quantum times it, and every node it renders, with
+// the monotonic clock, and adds each duration to a histogram of power-of-two
+// buckets: a few relaxed loads and stores, with nothing to wait for or
+// allocate. Snapshots read the same fields from any thread.
+#include <string.h>
+
+#include "tau_engine.h"
+
+// Adds `value` to a field only this thread writes.
+static void add(volatile int64_t* field, int64_t value) {
+  tau_atomic_store_relaxed_i64(field,
+                               tau_atomic_load_relaxed_i64(field) + value);
+}
+
+void tau_timings_record(tau_timings* timings, int64_t ns,
+                        int64_t deadline_ns) {
+  int32_t bucket = ns > 1 ? tau_highest_bit((uint64_t)ns) : 0;
+  if (bucket >= TAU_PROFILE_BUCKETS) {
+    bucket = TAU_PROFILE_BUCKETS - 1;
+  }
+  add(&timings->buckets[bucket], 1);
+  add(&timings->count, 1);
+  add(&timings->total_ns, ns);
+  if (ns > tau_atomic_load_relaxed_i64(&timings->max_ns)) {
+    tau_atomic_store_relaxed_i64(&timings->max_ns, ns);
+  }
+  if (ns > deadline_ns) {
+    add(&timings->underruns, 1);
+  }
+}
+
+void tau_timings_read(const tau_timings* timings, int64_t deadline_ns,
+                      tau_profile* profile) {
+  profile->count = tau_atomic_load_relaxed_i64(&timings->count);
+  profile->total_ns = tau_atomic_load_relaxed_i64(&timings->total_ns);
+  profile->max_ns = tau_atomic_load_relaxed_i64(&timings->max_ns);
+  for (int32_t i = 0; i < TAU_PROFILE_BUCKETS; i++) {
+    profile->buckets[i] = tau_atomic_load_relaxed_i64(&timings->buckets[i]);
+  }
+  profile->deadline_ns = deadline_ns;
+  profile->underruns = tau_atomic_load_relaxed_i64(&timings->underruns);
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_context_get_profile(tau_context* context,
+                                                  tau_profile* profile) {
+  if (context == NULL || profile == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+#if TAU_PROFILING
+  tau_timings_read(&context->timings, context->deadline_ns, profile);
+  return TAU_OK;
+#else
+  memset(profile, 0, sizeof(tau_profile));
+  return TAU_ERROR_NOT_SUPPORTED;
+#endif
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_node_get_profile(tau_context* context,
+                                               int32_t node,
+                                               tau_profile* profile) {
+  if (context == NULL || profile == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  memset(profile, 0, sizeof(tau_profile));
+#if TAU_PROFILING
+  // The lock keeps the node from being freed while it is read.
+  tau_control_lock(context);
+  tau_node* target = tau_context_node(context, node);
+  if (target != NULL) {
+    tau_timings_read(&target->timings, context->deadline_ns, profile);
+  }
+  tau_control_unlock(context);
+  return target != NULL ? TAU_OK : TAU_ERROR_INVALID_ARGUMENT;
+#else
+  (void)node;
+  return TAU_ERROR_NOT_SUPPORTED;
+#endif
+}
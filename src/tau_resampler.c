@@ -0,0 +1,210 @@
+#include "tau_resampler.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "tau_memory.h"
+
+// The filter of each `tau_resampler_quality`: taps per output sample when
+// converting up, tabulated fractions, and the stopband attenuation designed
+// for, in decibels, 2 dB over the one documented to absorb rounding.
+typedef struct tier {
+  int32_t taps;
+  int32_t phases;
+  double attenuation;
+} tier;
+
+static const tier tiers[] = {
+    {0, 0, 0.0},
+    {16, 64, 62.0},
+    {32, 256, 92.0},
+    {64, 1024, 122.0},
+};
+
+// The zeroth-order modified Bessel function of the first kind.
+static double bessel_i0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; term > sum * 1e-12; k++) {
+    double factor = x / (2.0 * k);
+    term *= factor * factor;
+    sum += term;
+  }
+  return sum;
+}
+
+// Kaiser-windowed sinc filters. The transition band ends at the Nyquist
+// frequency of the lower rate, so everything the output cannot represent is
+// attenuated by the full stopband attenuation of the tier.
+static tau_resampler_filter* build(int32_t quality, double stretch) {
+  const tier* tier = &tiers[quality];
+  int32_t taps = tier->taps * (int32_t)ceil(stretch);
+  size_t rows = (size_t)tier->phases + 1;
+  tau_resampler_filter* filter = (tau_resampler_filter*)tau_memory_alloc(
+      sizeof(tau_resampler_filter), sizeof(void*));
+  float* coefficients = NULL;
+  if (filter != NULL) {
+    coefficients = (float*)tau_memory_alloc(rows * taps * sizeof(float),
+                                            TAU_AUDIO_BUFFER_ALIGNMENT);
+  }
+  if (coefficients == NULL) {
+    tau_memory_free(filter);
+    return NULL;
+  }
+  const double pi = 3.14159265358979323846;
+  double attenuation = tier->attenuation;
+  double transition = (attenuation - 8.0) / (2.285 * (tier->taps - 1));
+  double cutoff = 1.0 - transition / (2.0 * pi);
+  double beta = 0.1102 * (attenuation - 8.7);
+  double half_width = tier->taps * stretch / 2.0;
+  double window_scale = 1.0 / bessel_i0(beta);
+  for (size_t row = 0; row < rows; row++) {
+    float* coefficient = coefficients + row * taps;
+    double fraction = (double)row / tier->phases;
+    double sum = 0.0;
+    for (int32_t k = 0; k < taps; k++) {
+      // The distance from the interpolated position to tap `k`, in input
+      // samples.
+      double distance = fraction + taps / 2 - 1 - k;
+      double value = 0.0;
+      if (fabs(distance) < half_width) {
+        double x = cutoff * distance / stretch;
+        double sinc = x == 0.0 ? 1.0 : sin(pi * x) / (pi * x);
+        double edge = distance / half_width;
+        value = cutoff * sinc * bessel_i0(beta * sqrt(1.0 - edge * edge)) *
+                window_scale;
+      }
+      coefficient[k] = (float)value;
+      sum += value;
+    }
+    // Every row passes a constant signal unchanged.
+    for (int32_t k = 0; k < taps; k++) {
+      coefficient[k] = (float)(coefficient[k] / sum);
+    }
+  }
+  filter->quality = quality;
+  filter->stretch = stretch;
+  filter->taps = taps;
+  filter->phases = tier->phases;
+  filter->coefficients = coefficients;
+  filter->next = NULL;
+  return filter;
+}
+
+static tau_resampler_filter* filters;
+static volatile int32_t filters_lock;
+
+const tau_resampler_filter* tau_resampler_filter_get(int32_t quality,
+                                                     double step) {
+  if (quality <= TAU_RESAMPLER_LINEAR || quality > TAU_RESAMPLER_HIGH) {
+    return NULL;
+  }
+  double stretch = fabs(step);
+  stretch = stretch > 1.0 ? stretch : 1.0;
+  stretch = stretch < TAU_RESAMPLER_MAX_STRETCH ? stretch
+                                                : TAU_RESAMPLER_MAX_STRETCH;
+  int32_t unlocked = 0;
+  while (!tau_atomic_cas_i32(&filters_lock, &unlocked, 1)) {
+    unlocked = 0;
+    tau_thread_yield();
+  }
+  tau_resampler_filter* filter = filters;
+  while (filter != NULL &&
+         (filter->quality != quality || filter->stretch != stretch)) {
+    filter = filter->next;
+  }
+  if (filter == NULL) {
+    filter = build(quality, stretch);
+    if (filter != NULL) {
+      filter->next = filters;
+      filters = filter;
+    }
+  }
+  tau_atomic_store_i32(&filters_lock, 0);
+  return filter;
+}
+
+// --- Streaming ---
+
+static int32_t taps_of(const tau_resampler* resampler) {
+  return resampler->filter != NULL ? resampler->filter->taps : 2;
+}
+
+int32_t tau_resampler_init(tau_resampler* resampler, int32_t quality,
+                           int32_t channels, double step,
+                           int32_t max_frames) {
+  memset(resampler, 0, sizeof(*resampler));
+  if (channels <= 0 || channels > TAU_MAX_CHANNELS || !(step > 0) ||
+      step > TAU_RESAMPLER_MAX_STRETCH * 16.0 || max_frames <= 0 ||
+      quality < TAU_RESAMPLER_LINEAR || quality > TAU_RESAMPLER_HIGH) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  resampler->filter = tau_resampler_filter_get(quality, step);
+  if (quality != TAU_RESAMPLER_LINEAR && resampler->filter == NULL) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  int32_t taps = taps_of(resampler);
+  resampler->channels = channels;
+  resampler->step = step;
+  resampler->capacity = taps + (int32_t)ceil(max_frames * step) + 2;
+  resampler->history = (float*)tau_memory_calloc(
+      (size_t)channels * resampler->capacity * sizeof(float),
+      TAU_AUDIO_BUFFER_ALIGNMENT);
+  if (resampler->history == NULL) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  // The frames before the first one are silent.
+  resampler->count = taps / 2 - 1;
+  resampler->position = taps / 2 - 1;
+  return TAU_OK;
+}
+
+void tau_resampler_destroy(tau_resampler* resampler) {
+  tau_memory_free(resampler->history);
+  resampler->history = NULL;
+}
+
+int32_t tau_resampler_needed(const tau_resampler* resampler, int32_t frames) {
+  if (frames <= 0) {
+    return 0;
+  }
+  double last = resampler->position + (frames - 1) * resampler->step;
+  int32_t needed = (int32_t)last + taps_of(resampler) / 2 + 1;
+  return needed > resampler->count ? needed - resampler->count : 0;
+}
+
+void tau_resampler_process(tau_resampler* resampler, float* output,
+                           size_t stride, int32_t frames) {
+  const tau_kernel_table* kernels = tau_kernels();
+  const tau_resampler_filter* filter = resampler->filter;
+  int32_t taps = taps_of(resampler);
+  for (int32_t c = 0; c < resampler->channels; c++) {
+    const float* history =
+        resampler->history + (size_t)c * resampler->capacity;
+    float* out = output + c * stride;
+    for (int32_t i = 0; i < frames; i++) {
+      double position = resampler->position + i * resampler->step;
+      int32_t index = (int32_t)position;
+      double fraction = position - index;
+      const float* window = history + index - (taps / 2 - 1);
+      out[i] = filter != NULL
+                   ? tau_resampler_filter_apply(filter, kernels, window,
+                                                fraction)
+                   : window[0] + (window[1] - window[0]) * (float)fraction;
+    }
+  }
+  resampler->position += frames * resampler->step;
+  // Frames no window reaches again are dropped.
+  int32_t drop = (int32_t)resampler->position - (taps / 2 - 1);
+  if (drop <= 0) {
+    return;
+  }
+  drop = drop < resampler->count ? drop : resampler->count;
+  for (int32_t c = 0; c < resampler->channels; c++) {
+    float* history = resampler->history + (size_t)c * resampler->capacity;
+    memmove(history, history + drop,
+            (size_t)(resampler->count - drop) * sizeof(float));
+  }
+  resampler->count -= drop;
+  resampler->position -= drop;
+}
@@ -0,0 +1,102 @@
+// Sample-rate conversion with polyphase windowed-sinc filters.
+//
+// A filter interpolates a signal between its samples: the sample at
+// `position` is the dot product of the `taps` input samples around it with
+// a row of coefficients picked by the fraction of `position`. Rows are
+// tabulated for `phases` fractions, and the two rows around a fraction are
+// blended, so any conversion ratio, including one varying over time, uses
+// the same table. The taps loops run on the vector kernels.
+//
+// When converting down, the filter is stretched by the ratio so that it
+// also removes what the output rate cannot represent.
+#ifndef TAU_RESAMPLER_H_
+#define TAU_RESAMPLER_H_
+
+#include "tau_kernels.h"
+
+// The largest ratio a filter is stretched for. Faster playback aliases.
+#define TAU_RESAMPLER_MAX_STRETCH 8
+
+typedef struct tau_resampler_filter {
+  int32_t quality;
+  double stretch;
+  // Input samples per output sample, a multiple of 16.
+  int32_t taps;
+  int32_t phases;
+  // `phases + 1` rows of `taps` coefficients, one for each fraction
+  // `row / phases`.
+  float* coefficients;
+  struct tau_resampler_filter* next;
+} tau_resampler_filter;
+
+// The filter of `quality`, one of `tau_resampler_quality`, for reading
+// `step` input frames per output frame. Filters are built on first use and
+// shared for the life of the process: the call may allocate, but the filter
+// is safe to use from any thread. Returns NULL for linear interpolation or if
+// memory is exhausted.
+const tau_resampler_filter* tau_resampler_filter_get(int32_t quality,
+                                                     double step);
+
+// The sample `fraction` past `window[filter->taps / 2 - 1]`, with `fraction`
+// in [0, 1).
+static inline float tau_resampler_filter_apply(
+    const tau_resampler_filter* filter, const tau_kernel_table* kernels,
+    const float* window, double fraction) {
+  double scaled = fraction * filter->phases;
+  int32_t row = (int32_t)scaled;
+  const float* below = filter->coefficients + (size_t)row * filter->taps;
+  return kernels->blend_dot(window, below, below + filter->taps,
+                            (float)(scaled - row), filter->taps);
+}
+
+// A resampler of planar audio streamed through it at a fixed ratio.
+//
+// Input is appended to a history of the recent frames, and every output
+// frame is interpolated from the frames around its position: the output is
+// not delayed, and the first frames are read as if preceded by silence.
+typedef struct tau_resampler {
+  const tau_resampler_filter* filter;
+  int32_t channels;
+  // Input frames per output frame.
+  double step;
+  // The position of the next output frame in `history`.
+  double position;
+  // `channels` rows of `capacity` frames, of which the first `count` are
+  // filled.
+  float* history;
+  int32_t capacity;
+  int32_t count;
+} tau_resampler;
+
+// Prepares `resampler` to convert `channels` channels at `step` input
+// frames per output frame, `max_frames` output frames at a time. Returns a
+// `tau_status`.
+int32_t tau_resampler_init(tau_resampler* resampler, int32_t quality,
+                           int32_t channels, double step,
+                           int32_t max_frames);
+
+void tau_resampler_destroy(tau_resampler* resampler);
+
+// The input frames to append before `frames` output frames can be
+// produced.
+int32_t tau_resampler_needed(const tau_resampler* resampler, int32_t frames);
+
+// Where to write the next input frames: channel `c` of them starts at
+// `tau_resampler_input(resampler) + c * resampler->capacity`.
+static inline float* tau_resampler_input(tau_resampler* resampler) {
+  return resampler->history + resampler->count;
+}
+
+// Appends the `frames` frames written at `tau_resampler_input`.
+static inline void tau_resampler_commit(tau_resampler* resampler,
+                                        int32_t frames) {
+  resampler->count += frames;
+}
+
+// Produces `frames` output frames, at most `max_frames`, once
+// `tau_resampler_needed` input frames have been appended. Channel `c` of
+// the output starts at `output + c * stride`.
+void tau_resampler_process(tau_resampler* resampler, float* output,
+                           size_t stride, int32_t frames);
+
+#endif  // TAU_RESAMPLER_H_
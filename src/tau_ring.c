@@ -0,0 +1,254 @@
+#include <string.h>
+
+#include "tau_dart.h"
+#include "tau_pool.h"
+
+// A pool task draining requests. A ring has one per pool thread, started on
+// demand by `tau_ring_submit` and stopping once no request is left.
+typedef struct tau_ring_worker {
+  tau_task task;
+  tau_ring* ring;
+  volatile int32_t active;
+} tau_ring_worker;
+
+struct tau_ring {
+  tau_ring_request* requests;
+  tau_ring_completion* completions;
+  // Completion slot `i` holds completion number `n` once `turns[i]` is `n + 1`.
+  volatile int64_t* turns;
+  // Request slot `i` may take position `n` once `frees[i]` is `n`: the
+  // result of the request that used it before has been released. Written by
+  // `tau_ring_release` and read by `tau_ring_submit`, both called by the
+  // thread owning the ring.
+  int64_t* frees;
+  tau_ring_worker* workers;
+  int worker_count;
+  int32_t capacity;
+  int64_t mask;
+  int64_t port;
+  tau_pool* pool;
+
+  // Positions are only ever incremented. Each is written by a different side,
+  // so they do not share cache lines.
+  TAU_ALIGNAS(TAU_CACHE_LINE) volatile int64_t request_end;
+  TAU_ALIGNAS(TAU_CACHE_LINE) volatile int64_t request_next;
+  TAU_ALIGNAS(TAU_CACHE_LINE) volatile int64_t completion_end;
+  TAU_ALIGNAS(TAU_CACHE_LINE) volatile int64_t completion_start;
+
+  // Whether the next completion should notify `port`.
+  volatile int32_t notify_armed;
+  volatile int32_t closing;
+  // One for the owner, plus one per active worker.
+  volatile int32_t references;
+};
+
+static void ring_unref(tau_ring* ring) {
+  if (tau_atomic_fetch_add_i32(&ring->references, -1) == 1) {
+    tau_aligned_free(ring);
+  }
+}
+
+static void execute(const tau_ring_request* request,
+                    tau_ring_completion* completion) {
+  completion->status = TAU_OK;
+  switch (request->opcode) {
+    case TAU_OP_SUM:
+      completion->result = sum(request->a, request->b);
+      break;
+    case TAU_OP_SUBTRACT:
+      completion->result = request->a - request->b;
+      break;
+    case TAU_OP_MULTIPLY:
+      completion->result = request->a * request->b;
+      break;
+    case TAU_OP_SUM_LONG_RUNNING:
+      completion->result = sum_long_running(request->a, request->b);
+      break;
+    default:
+      completion->result = 0;
+      completion->status = TAU_ERROR_INVALID_ARGUMENT;
+      break;
+  }
+}
+
+static void publish(tau_ring* ring, const tau_ring_completion* completion) {
+  // Slots are never overwritten before they are released: no more requests
+  // are in flight than there are slots.
+  int64_t position = tau_atomic_fetch_add_i64(&ring->completion_end, 1);
+  ring->completions[position & ring->mask] = *completion;
+  tau_atomic_store_i64(&ring->turns[position & ring->mask], position + 1);
+  if (ring->port != 0 && tau_atomic_exchange_i32(&ring->notify_armed, 0)) {
+    tau_dart_post_int64(ring->port, 0);
+  }
+}
+
+// Claims the next published request, or returns 0 if there is none.
+static int claim(tau_ring* ring, int64_t* position) {
+  int64_t next = tau_atomic_load_i64(&ring->request_next);
+  while (next < tau_atomic_load_i64(&ring->request_end)) {
+    if (tau_atomic_cas_i64(&ring->request_next, &next, next + 1)) {
+      *position = next;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void run_worker(tau_task* task) {
+  tau_ring_worker* worker = (tau_ring_worker*)task;
+  tau_ring* ring = worker->ring;
+  for (;;) {
+    int64_t position;
+    while (!tau_atomic_load_i32(&ring->closing) && claim(ring, &position)) {
+      tau_ring_request request = ring->requests[position & ring->mask];
+      tau_ring_completion completion;
+      completion.sequence = position;
+      execute(&request, &completion);
+      publish(ring, &completion);
+    }
+    tau_atomic_exchange_i32(&worker->active, 0);
+    // A submission that happened before the store above saw this worker
+    // active and did not restart it, so look again.
+    if (tau_atomic_load_i32(&ring->closing) ||
+        tau_atomic_load_i64(&ring->request_next) >=
+            tau_atomic_load_i64(&ring->request_end)) {
+      break;
+    }
+    int32_t inactive = 0;
+    if (!tau_atomic_cas_i32(&worker->active, &inactive, 1)) {
+      // A submission restarted this worker, and that run owns a reference.
+      break;
+    }
+  }
+  ring_unref(ring);
+}
+
+FFI_PLUGIN_EXPORT tau_ring* tau_ring_create(int32_t capacity, int64_t port) {
+  if (capacity <= 0 || capacity > (1 << 30)) {
+    return NULL;
+  }
+  int32_t slots = 1;
+  while (slots < capacity) {
+    slots <<= 1;
+  }
+  tau_pool* pool = tau_pool_shared();
+  if (pool == NULL) {
+    return NULL;
+  }
+  int worker_count = tau_pool_thread_count(pool);
+  // The ring and its arrays share a single allocation.
+  size_t ring_size = (sizeof(tau_ring) + TAU_CACHE_LINE - 1) &
+                     ~(size_t)(TAU_CACHE_LINE - 1);
+  size_t requests_size = (size_t)slots * sizeof(tau_ring_request);
+  size_t completions_size = (size_t)slots * sizeof(tau_ring_completion);
+  size_t turns_size = (size_t)slots * sizeof(int64_t);
+  size_t frees_size = (size_t)slots * sizeof(int64_t);
+  size_t workers_size = (size_t)worker_count * sizeof(tau_ring_worker);
+  char* memory = (char*)tau_aligned_alloc(
+      ring_size + requests_size + completions_size + turns_size + frees_size +
+          workers_size,
+      TAU_CACHE_LINE);
+  if (memory == NULL) {
+    return NULL;
+  }
+  memset(memory, 0, ring_size + requests_size + completions_size +
+                        turns_size + frees_size + workers_size);
+  tau_ring* ring = (tau_ring*)memory;
+  memory += ring_size;
+  ring->requests = (tau_ring_request*)memory;
+  memory += requests_size;
+  ring->completions = (tau_ring_completion*)memory;
+  memory += completions_size;
+  ring->turns = (volatile int64_t*)memory;
+  memory += turns_size;
+  ring->frees = (int64_t*)memory;
+  memory += frees_size;
+  ring->workers = (tau_ring_worker*)memory;
+  ring->worker_count = worker_count;
+  ring->capacity = slots;
+  ring->mask = slots - 1;
+  ring->port = port;
+  ring->pool = pool;
+  ring->notify_armed = 1;
+  ring->references = 1;
+  for (int32_t i = 0; i < slots; i++) {
+    ring->frees[i] = i;
+  }
+  for (int i = 0; i < worker_count; i++) {
+    ring->workers[i].task.run = run_worker;
+    ring->workers[i].ring = ring;
+  }
+  return ring;
+}
+
+FFI_PLUGIN_EXPORT void tau_ring_destroy(tau_ring* ring) {
+  if (ring != NULL) {
+    tau_atomic_store_i32(&ring->closing, 1);
+    ring_unref(ring);
+  }
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_ring_capacity(tau_ring* ring) {
+  return ring->capacity;
+}
+
+FFI_PLUGIN_EXPORT tau_ring_request* tau_ring_requests(tau_ring* ring) {
+  return ring->requests;
+}
+
+FFI_PLUGIN_EXPORT tau_ring_completion* tau_ring_completions(tau_ring* ring) {
+  return ring->completions;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_ring_submit(tau_ring* ring, int64_t end) {
+  int64_t previous_end = tau_atomic_load_relaxed_i64(&ring->request_end);
+  if (end < previous_end || end - previous_end > ring->capacity) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  // Completions come out of order, so the count released says nothing of
+  // which slots are free.
+  for (int64_t position = previous_end; position < end; position++) {
+    if (ring->frees[position & ring->mask] != position) {
+      return TAU_ERROR_INVALID_ARGUMENT;
+    }
+  }
+  if (end == previous_end) {
+    return TAU_OK;
+  }
+  tau_atomic_exchange_i64(&ring->request_end, end);
+  // Start one worker per pending request, counting the ones already running.
+  int64_t pending = end - tau_atomic_load_i64(&ring->request_next);
+  for (int i = 0; i < ring->worker_count && pending > 0; i++) {
+    tau_ring_worker* worker = &ring->workers[i];
+    int32_t inactive = 0;
+    if (tau_atomic_cas_i32(&worker->active, &inactive, 1)) {
+      tau_atomic_fetch_add_i32(&ring->references, 1);
+      tau_pool_submit(ring->pool, &worker->task);
+    }
+    pending--;
+  }
+  return TAU_OK;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_ring_poll(tau_ring* ring) {
+  // Re-arm before looking, so a completion published after the scan below
+  // notifies the port again.
+  tau_atomic_exchange_i32(&ring->notify_armed, 1);
+  int64_t start = tau_atomic_load_relaxed_i64(&ring->completion_start);
+  int32_t ready = 0;
+  while (ready < ring->capacity &&
+         tau_atomic_load_i64(&ring->turns[(start + ready) & ring->mask]) ==
+             start + ready + 1) {
+    ready++;
+  }
+  return ready;
+}
+
+FFI_PLUGIN_EXPORT void tau_ring_release(tau_ring* ring, int32_t count) {
+  int64_t start = tau_atomic_load_relaxed_i64(&ring->completion_start);
+  for (int32_t i = 0; i < count; i++) {
+    int64_t sequence = ring->completions[(start + i) & ring->mask].sequence;
+    ring->frees[sequence & ring->mask] = sequence + ring->capacity;
+  }
+  tau_atomic_store_i64(&ring->completion_start, start + count);
+}
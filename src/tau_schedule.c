@@ -0,0 +1,110 @@
+#include "tau_engine.h"
+
+void tau_schedule_update(tau_context* context) {
+  tau_node** order = context->order;
+  int32_t count = context->order_count;
+  for (int32_t i = 0; i < count; i++) {
+    order[i]->consumer_count = 0;
+  }
+  for (int32_t i = 0; i < count; i++) {
+    for (int32_t j = 0; j < order[i]->source_count; j++) {
+      order[i]->sources[j]->consumer_count++;
+    }
+  }
+  // The order lists inputs first, so the only input of a node extending a
+  // chain is always the current tail of that chain.
+  context->chain_count = 0;
+  for (int32_t i = 0; i < count; i++) {
+    tau_node* node = order[i];
+    node->chain_next = NULL;
+    if (node->source_count == 1 && node->sources[0]->consumer_count == 1) {
+      tau_chain* chain = &context->chains[node->sources[0]->chain];
+      chain->tail->chain_next = node;
+      chain->tail = node;
+      node->chain = node->sources[0]->chain;
+      continue;
+    }
+    tau_chain* chain = &context->chains[context->chain_count];
+    chain->context = context;
+    chain->head = node;
+    chain->tail = node;
+    chain->dependencies = node->source_count;
+    chain->dependent_count = 0;
+    node->chain = context->chain_count++;
+  }
+  // Every input of a head is the tail of another chain.
+  for (int32_t c = 0; c < context->chain_count; c++) {
+    tau_node* head = context->chains[c].head;
+    for (int32_t j = 0; j < head->source_count; j++) {
+      context->chains[head->sources[j]->chain].dependent_count++;
+    }
+  }
+  int32_t offset = 0;
+  for (int32_t c = 0; c < context->chain_count; c++) {
+    context->chains[c].dependents = offset;
+    offset += context->chains[c].dependent_count;
+    context->chains[c].pending = 0;
+  }
+  for (int32_t c = 0; c < context->chain_count; c++) {
+    tau_node* head = context->chains[c].head;
+    for (int32_t j = 0; j < head->source_count; j++) {
+      tau_chain* source = &context->chains[head->sources[j]->chain];
+      context->chain_dependents[source->dependents + source->pending++] = c;
+    }
+  }
+}
+
+static void run_chain(tau_task* task) {
+  tau_chain* chain = (tau_chain*)task;
+  tau_context* context = chain->context;
+  while (chain != NULL) {
+    tau_arena_reset();
+    int64_t now = tau_profile_now();
+    for (tau_node* node = chain->head; node != NULL; node = node->chain_next) {
+      now = tau_node_render(context, node, now);
+    }
+    // The first chain made ready continues on this thread; the others go
+    // back to the pool.
+    tau_chain* next = NULL;
+    const int32_t* dependents = context->chain_dependents + chain->dependents;
+    for (int32_t i = 0; i < chain->dependent_count; i++) {
+      tau_chain* dependent = &context->chains[dependents[i]];
+      if (tau_atomic_fetch_add_i32(&dependent->pending, -1) != 1) {
+        continue;
+      }
+      if (next == NULL) {
+        next = dependent;
+      } else {
+        tau_pool_submit(context->pool, &dependent->task);
+      }
+    }
+    tau_atomic_fetch_add_i32(&context->chains_remaining, -1);
+    chain = next;
+  }
+}
+
+void tau_schedule_run(tau_context* context) {
+  for (int32_t c = 0; c < context->chain_count; c++) {
+    tau_chain* chain = &context->chains[c];
+    chain->task.run = run_chain;
+    tau_atomic_store_relaxed_i32(&chain->pending, chain->dependencies);
+  }
+  tau_atomic_store_i32(&context->chains_remaining, context->chain_count);
+  for (int32_t c = 0; c < context->chain_count; c++) {
+    if (context->chains[c].dependencies == 0) {
+      tau_pool_submit(context->pool, &context->chains[c].task);
+    }
+  }
+  // Helps the workers, and gives the processor away when a worker holding
+  // the last chains is not running.
+  int32_t idle = 0;
+  while (tau_atomic_load_i32(&context->chains_remaining) > 0) {
+    if (tau_pool_run_one(context->pool)) {
+      idle = 0;
+    } else if (++idle < 64) {
+      tau_cpu_relax();
+    } else {
+      tau_thread_yield();
+    }
+  }
+}
@@ -0,0 +1,190 @@
+// The sinks: devices paced by the monotonic clock instead of a sound card,
+// which discard the audio or write it to a WAV file, so that the real-time
+// path runs on machines without one.
+//
+// A sink thread asks for period `n` at `start + n` periods, and needs it one
+// period later, as a double-buffered sound card would. When a callback
+// misses that, the sink starts over from the current time, as a sound card
+// recovering from an underrun, rather than asking for the missed periods in
+// a burst.
+#include <string.h>
+
+#include "tau_device.h"
+#include "tau_memory.h"
+
+#define WAVE_FORMAT_IEEE_FLOAT 3
+
+// The size of the header `write_header` writes.
+#define WAV_HEADER_BYTES 44
+
+typedef struct sink {
+  tau_device_callback callback;
+  void* user;
+  int32_t channels;
+  float sample_rate;
+  int32_t period_frames;
+  // A period of interleaved frames.
+  float* buffer;
+  // The WAV file written, and the bytes of audio written to it.
+  FILE* file;
+  int64_t data_bytes;
+  int32_t failed;
+  tau_thread thread;
+  int32_t started;
+  volatile int32_t running;
+} sink;
+
+static void put_u16(uint8_t* p, uint32_t value) {
+  p[0] = (uint8_t)value;
+  p[1] = (uint8_t)(value >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t value) {
+  put_u16(p, value);
+  put_u16(p + 2, value >> 16);
+}
+
+// Writes the header of a float WAV file with `data_bytes` of audio, or of a
+// file still being written if it is -1.
+static int write_header(sink* self, int64_t data_bytes) {
+  uint32_t size = data_bytes < 0 || data_bytes > 0xFFFFFFFFll - 36
+                      ? 0xFFFFFFFFu
+                      : (uint32_t)data_bytes;
+  uint32_t frame_bytes = (uint32_t)self->channels * sizeof(float);
+  uint8_t header[WAV_HEADER_BYTES];
+  memcpy(header, "RIFF", 4);
+  put_u32(header + 4, size == 0xFFFFFFFFu ? size : size + 36);
+  memcpy(header + 8, "WAVEfmt ", 8);
+  put_u32(header + 16, 16);
+  put_u16(header + 20, WAVE_FORMAT_IEEE_FLOAT);
+  put_u16(header + 22, (uint32_t)self->channels);
+  put_u32(header + 24, (uint32_t)self->sample_rate);
+  put_u32(header + 28, (uint32_t)self->sample_rate * frame_bytes);
+  put_u16(header + 32, frame_bytes);
+  put_u16(header + 34, 32);
+  memcpy(header + 36, "data", 4);
+  put_u32(header + 40, size);
+  return fseek(self->file, 0, SEEK_SET) == 0 &&
+         fwrite(header, sizeof(header), 1, self->file) == 1;
+}
+
+static void sink_main(void* arg) {
+  sink* self = (sink*)arg;
+  double period_ns = self->period_frames * 1e9 / self->sample_rate;
+  int64_t start = tau_now_ns();
+  int64_t period = 0;
+  while (tau_atomic_load_i32(&self->running)) {
+    int64_t due = start + (int64_t)(period * period_ns);
+    int64_t deadline = start + (int64_t)((period + 1) * period_ns);
+    tau_sleep_until(due);
+    self->callback(self->user, self->buffer, self->period_frames,
+                   deadline - tau_now_ns());
+    period++;
+    if (tau_now_ns() > deadline) {
+      start = tau_now_ns();
+      period = 0;
+    }
+    // Samples are written in the byte order of the processor, which is
+    // little-endian on every supported platform, as WAV is.
+    size_t samples = (size_t)self->period_frames * self->channels;
+    if (self->file != NULL && !self->failed) {
+      self->failed =
+          fwrite(self->buffer, sizeof(float), samples, self->file) != samples;
+      self->data_bytes += (int64_t)(samples * sizeof(float));
+    }
+  }
+  // The callback renders with the arena of this thread.
+  tau_arena_release();
+}
+
+static void* sink_open(FILE* file, int32_t channels, float sample_rate,
+                       int32_t period_frames, tau_device_callback callback,
+                       void* user) {
+  sink* self = (sink*)tau_memory_calloc(sizeof(sink), sizeof(void*));
+  float* buffer = (float*)tau_memory_calloc(
+      (size_t)period_frames * channels * sizeof(float), TAU_CACHE_LINE);
+  if (self == NULL || buffer == NULL) {
+    tau_memory_free(self);
+    tau_memory_free(buffer);
+    return NULL;
+  }
+  self->callback = callback;
+  self->user = user;
+  self->channels = channels;
+  self->sample_rate = sample_rate;
+  self->period_frames = period_frames;
+  self->buffer = buffer;
+  self->file = file;
+  return self;
+}
+
+static void* null_open(const char* options, int32_t channels,
+                       float sample_rate, int32_t period_frames,
+                       tau_device_callback callback, void* user) {
+  (void)options;
+  return sink_open(NULL, channels, sample_rate, period_frames, callback,
+                   user);
+}
+
+static void* wav_open(const char* options, int32_t channels,
+                      float sample_rate, int32_t period_frames,
+                      tau_device_callback callback, void* user) {
+  FILE* file = options != NULL ? fopen(options, "wb") : NULL;
+  if (file == NULL) {
+    return NULL;
+  }
+  sink* self = (sink*)sink_open(file, channels, sample_rate, period_frames,
+                                callback, user);
+  if (self == NULL || !write_header(self, -1)) {
+    tau_memory_free(self != NULL ? self->buffer : NULL);
+    tau_memory_free(self);
+    fclose(file);
+    return NULL;
+  }
+  return self;
+}
+
+static int32_t sink_start(void* device) {
+  sink* self = (sink*)device;
+  if (self->started) {
+    return TAU_OK;
+  }
+  tau_atomic_store_i32(&self->running, 1);
+  if (tau_thread_start(&self->thread, sink_main, self) != 0) {
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  self->started = 1;
+  return TAU_OK;
+}
+
+static int32_t sink_stop(void* device) {
+  sink* self = (sink*)device;
+  if (self->started) {
+    tau_atomic_store_i32(&self->running, 0);
+    tau_thread_join(self->thread);
+    self->started = 0;
+  }
+  if (self->file != NULL && !self->failed) {
+    // The file is complete as of now, and later periods append to it.
+    self->failed = !write_header(self, self->data_bytes) ||
+                   fseek(self->file, 0, SEEK_END) != 0 ||
+                   fflush(self->file) != 0;
+  }
+  return self->failed ? TAU_ERROR_IO : TAU_OK;
+}
+
+static void sink_close(void* device) {
+  sink* self = (sink*)device;
+  sink_stop(self);
+  if (self->file != NULL) {
+    fclose(self->file);
+  }
+  tau_memory_free(self->buffer);
+  tau_memory_free(self);
+}
+
+const tau_device_backend tau_null_backend = {"null", null_open, sink_start,
+                                             sink_stop, sink_close};
+
+const tau_device_backend tau_wav_backend = {"wav", wav_open, sink_start,
+                                            sink_stop, sink_close};
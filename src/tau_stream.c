@@ -0,0 +1,574 @@
+// Streaming decoding: files decoded incrementally into a bounded ring.
+#include <math.h>
+#include <string.h>
+
+#include "tau_codec.h"
+#include "tau_engine.h"
+#include "tau_resampler.h"
+
+// The most frames decoded at a time.
+#define DECODE_FRAMES 4096
+
+#define DEFAULT_BUFFER_FRAMES 65536
+
+// The most codecs `tau_codec_register` accepts.
+#define MAX_CODECS 16
+
+static const tau_codec* codecs[MAX_CODECS];
+static volatile int32_t codec_count;
+
+FFI_PLUGIN_EXPORT int32_t tau_codec_register(const tau_codec* codec) {
+  if (codec == NULL || codec->probe == NULL || codec->open == NULL ||
+      codec->decode == NULL || codec->close == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  int32_t count = tau_atomic_load_i32(&codec_count);
+  if (count == MAX_CODECS) {
+    return TAU_ERROR_NOT_SUPPORTED;
+  }
+  codecs[count] = codec;
+  tau_atomic_store_i32(&codec_count, count + 1);
+  return TAU_OK;
+}
+
+// --- Files ---
+
+static int64_t file_read(void* user, void* buffer, int64_t size) {
+  size_t count = fread(buffer, 1, (size_t)size, (FILE*)user);
+  if (count == 0 && ferror((FILE*)user)) {
+    return TAU_ERROR_IO;
+  }
+  return (int64_t)count;
+}
+
+static int32_t file_seek(void* user, int64_t offset) {
+#if _WIN32
+  int failed = _fseeki64((FILE*)user, offset, SEEK_SET);
+#else
+  int failed = fseeko((FILE*)user, (off_t)offset, SEEK_SET);
+#endif
+  return failed ? TAU_ERROR_IO : TAU_OK;
+}
+
+// The chunk size of file reads.
+#define FILE_BUFFER_BYTES 65536
+
+static FILE* file_open(const char* path, tau_reader* reader) {
+  if (path == NULL) {
+    return NULL;
+  }
+  FILE* file = fopen(path, "rb");
+  if (file == NULL) {
+    return NULL;
+  }
+  setvbuf(file, NULL, _IOFBF, FILE_BUFFER_BYTES);
+  reader->read = file_read;
+  reader->seek = file_seek;
+  reader->user = file;
+  return file;
+}
+
+// Starts decoding `reader` with the first codec that recognizes it, most
+// recently registered first. Returns the decoder, or NULL.
+static void* codec_open(const tau_reader* reader, const tau_codec** codec,
+                        tau_stream_format* format) {
+  uint8_t header[TAU_CODEC_PROBE_BYTES];
+  int64_t size = reader->read(reader->user, header, sizeof(header));
+  if (size <= 0 || reader->seek(reader->user, 0) != TAU_OK) {
+    return NULL;
+  }
+  for (int32_t i = tau_atomic_load_i32(&codec_count); i >= 0; i--) {
+    const tau_codec* candidate = i > 0 ? codecs[i - 1] : &tau_wav_codec;
+    if (!candidate->probe(header, (int32_t)size)) {
+      continue;
+    }
+    void* decoder = candidate->open(reader, format);
+    if (decoder != NULL && format->channels > 0 &&
+        format->channels <= TAU_MAX_CHANNELS && format->sample_rate > 0) {
+      *codec = candidate;
+      return decoder;
+    }
+    if (decoder != NULL) {
+      candidate->close(decoder);
+    }
+    if (reader->seek(reader->user, 0) != TAU_OK) {
+      return NULL;
+    }
+  }
+  return NULL;
+}
+
+// --- Streams ---
+
+struct tau_stream {
+  volatile int32_t references;
+  FILE* file;
+  tau_reader reader;
+  const tau_codec* codec;
+  void* decoder;
+  tau_stream_format format;
+
+  // Decoded frames, planar: channel `c` of frame `i` is at
+  // `ring[c * capacity + (i & (capacity - 1))]`. Frames from `read_index`
+  // to `write_index` are decoded and not read yet.
+  float* ring;
+  int32_t capacity;
+  TAU_ALIGNAS(TAU_CACHE_LINE) volatile int64_t write_index;
+  TAU_ALIGNAS(TAU_CACHE_LINE) volatile int64_t read_index;
+
+  // Set once decoding has stopped, with its `tau_status`.
+  volatile int32_t finished;
+  int32_t status;
+  volatile int32_t closing;
+
+  // A side about to sleep sets its flag, then looks again: the other side
+  // advances its index, then clears the flag and posts if it was set. No
+  // side takes a lock, so the rendering thread may read.
+  volatile int32_t decoder_waiting;
+  volatile int32_t reader_waiting;
+  tau_semaphore room;
+  tau_semaphore decoded;
+  tau_thread thread;
+};
+
+static void wake(volatile int32_t* waiting, tau_semaphore* semaphore) {
+  if (tau_atomic_exchange_i32(waiting, 0)) {
+    tau_semaphore_post(semaphore);
+  }
+}
+
+static int64_t free_frames(tau_stream* stream) {
+  return stream->capacity - (tau_atomic_load_relaxed_i64(&stream->write_index) -
+                             tau_atomic_load_i64(&stream->read_index));
+}
+
+static void decode_loop(void* arg) {
+  tau_stream* stream = (tau_stream*)arg;
+  int32_t channels = stream->format.channels;
+  int32_t mask = stream->capacity - 1;
+  float* pointers[TAU_MAX_CHANNELS];
+  int32_t status = TAU_OK;
+  for (;;) {
+    // Waits for room for a whole chunk rather than waking for every quantum
+    // read. The ring holds at least two chunks.
+    while (free_frames(stream) < DECODE_FRAMES &&
+           !tau_atomic_load_i32(&stream->closing)) {
+      // A read after this posts the semaphore, so look again before sleeping.
+      tau_atomic_exchange_i32(&stream->decoder_waiting, 1);
+      if (free_frames(stream) >= DECODE_FRAMES ||
+          tau_atomic_load_i32(&stream->closing)) {
+        break;
+      }
+      tau_semaphore_wait(&stream->room, -1);
+    }
+    if (tau_atomic_load_i32(&stream->closing)) {
+      break;
+    }
+    int64_t write_index = tau_atomic_load_relaxed_i64(&stream->write_index);
+    int32_t offset = (int32_t)(write_index & mask);
+    int64_t frames = free_frames(stream);
+    if (frames > stream->capacity - offset) {
+      frames = stream->capacity - offset;
+    }
+    if (frames > DECODE_FRAMES) {
+      frames = DECODE_FRAMES;
+    }
+    // Decodes straight into the ring.
+    for (int32_t c = 0; c < channels; c++) {
+      pointers[c] = stream->ring + (size_t)c * stream->capacity + offset;
+    }
+    int32_t decoded =
+        stream->codec->decode(stream->decoder, pointers, (int32_t)frames);
+    if (decoded <= 0) {
+      status = decoded;
+      break;
+    }
+    tau_atomic_store_i64(&stream->write_index, write_index + decoded);
+    wake(&stream->reader_waiting, &stream->decoded);
+  }
+  stream->status = status;
+  tau_atomic_store_i32(&stream->finished, 1);
+  wake(&stream->reader_waiting, &stream->decoded);
+}
+
+static void stream_free(tau_stream* stream) {
+  if (stream->decoder != NULL) {
+    stream->codec->close(stream->decoder);
+  }
+  if (stream->file != NULL) {
+    fclose(stream->file);
+  }
+  tau_memory_free(stream->ring);
+  tau_semaphore_destroy(&stream->room);
+  tau_semaphore_destroy(&stream->decoded);
+  tau_memory_free(stream);
+}
+
+FFI_PLUGIN_EXPORT tau_stream* tau_stream_open(const char* path,
+                                              int32_t buffer_frames) {
+  tau_stream* stream =
+      (tau_stream*)tau_memory_calloc(sizeof(tau_stream), TAU_CACHE_LINE);
+  if (stream == NULL) {
+    return NULL;
+  }
+  if (tau_semaphore_init(&stream->room) != 0) {
+    tau_memory_free(stream);
+    return NULL;
+  }
+  if (tau_semaphore_init(&stream->decoded) != 0) {
+    tau_semaphore_destroy(&stream->room);
+    tau_memory_free(stream);
+    return NULL;
+  }
+  stream->references = 1;
+  stream->file = file_open(path, &stream->reader);
+  if (stream->file != NULL) {
+    stream->decoder =
+        codec_open(&stream->reader, &stream->codec, &stream->format);
+  }
+  if (stream->decoder == NULL) {
+    stream_free(stream);
+    return NULL;
+  }
+  if (buffer_frames <= 0) {
+    buffer_frames = DEFAULT_BUFFER_FRAMES;
+  }
+  int32_t capacity = 2 * DECODE_FRAMES;
+  while (capacity < buffer_frames && capacity <= INT32_MAX / 2) {
+    capacity *= 2;
+  }
+  stream->capacity = capacity;
+  stream->ring = (float*)tau_memory_alloc(
+      (size_t)stream->format.channels * capacity * sizeof(float),
+      TAU_CACHE_LINE);
+  if (stream->ring == NULL ||
+      tau_thread_start(&stream->thread, decode_loop, stream) != 0) {
+    stream_free(stream);
+    return NULL;
+  }
+  return stream;
+}
+
+FFI_PLUGIN_EXPORT void tau_stream_retain(tau_stream* stream) {
+  if (stream != NULL) {
+    tau_atomic_fetch_add_i32(&stream->references, 1);
+  }
+}
+
+FFI_PLUGIN_EXPORT void tau_stream_release(tau_stream* stream) {
+  if (stream == NULL ||
+      tau_atomic_fetch_add_i32(&stream->references, -1) != 1) {
+    return;
+  }
+  tau_atomic_store_i32(&stream->closing, 1);
+  tau_semaphore_post(&stream->room);
+  tau_thread_join(stream->thread);
+  stream_free(stream);
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_stream_channels(tau_stream* stream) {
+  return stream != NULL ? stream->format.channels : 0;
+}
+
+FFI_PLUGIN_EXPORT float tau_stream_sample_rate(tau_stream* stream) {
+  return stream != NULL ? stream->format.sample_rate : 0.0f;
+}
+
+FFI_PLUGIN_EXPORT int64_t tau_stream_length(tau_stream* stream) {
+  return stream != NULL ? stream->format.frames : -1;
+}
+
+// Reads up to `frames` frames into `output`, planar with `stride` floats
+// between channels. Without `underruns`, waits for them to be decoded; with
+// it, never waits, but copies the frames decoded, fills the rest with
+// silence and counts an underrun. Returns the number of frames read, fewer
+// only at the end of the stream, or a negative `tau_status`. `frames` must
+// leave room in the ring for a chunk to be decoded.
+static int32_t stream_pull(tau_stream* stream, float* output, size_t stride,
+                           int32_t frames, volatile int64_t* underruns) {
+  int64_t read_index = tau_atomic_load_relaxed_i64(&stream->read_index);
+  // `finished` is read first: every frame was written before it was set.
+  int finished = tau_atomic_load_i32(&stream->finished);
+  int64_t available = tau_atomic_load_i64(&stream->write_index) - read_index;
+  while (available < frames && !finished && underruns == NULL) {
+    tau_atomic_exchange_i32(&stream->reader_waiting, 1);
+    finished = tau_atomic_load_i32(&stream->finished);
+    available = tau_atomic_load_i64(&stream->write_index) - read_index;
+    if (available >= frames || finished) {
+      break;
+    }
+    tau_semaphore_wait(&stream->decoded, -1);
+  }
+  int32_t count = available < frames ? (int32_t)available : frames;
+  if (count == 0 && finished && stream->status < 0) {
+    return stream->status;
+  }
+  int32_t offset = (int32_t)(read_index & (stream->capacity - 1));
+  int32_t first = stream->capacity - offset < count ? stream->capacity - offset
+                                                    : count;
+  int32_t silent = count < frames && !finished ? frames - count : 0;
+  for (int32_t c = 0; c < stream->format.channels; c++) {
+    const float* ring = stream->ring + (size_t)c * stream->capacity;
+    float* out = output + c * stride;
+    memcpy(out, ring + offset, first * sizeof(float));
+    memcpy(out + first, ring, (count - first) * sizeof(float));
+    memset(out + count, 0, silent * sizeof(float));
+  }
+  if (silent > 0) {
+    tau_atomic_fetch_add_i64(underruns, 1);
+  }
+  tau_atomic_store_i64(&stream->read_index, read_index + count);
+  wake(&stream->decoder_waiting, &stream->room);
+  return count + silent;
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_stream_read(tau_stream* stream,
+                                          tau_audio_buffer* buffer) {
+  if (stream == NULL || buffer == NULL ||
+      buffer->channels != stream->format.channels) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  // Reads in chunks the ring holds with room for decoding: a read waiting
+  // for more frames than that would wait for a decoder waiting for room.
+  int32_t most = stream->capacity - DECODE_FRAMES;
+  int32_t read = 0;
+  while (read < buffer->frames) {
+    int32_t frames =
+        buffer->frames - read < most ? buffer->frames - read : most;
+    int32_t count = stream_pull(stream, buffer->data + read,
+                                (size_t)buffer->stride, frames, NULL);
+    if (count < 0) {
+      // A failure after some frames is returned by the next read.
+      return read > 0 ? read : count;
+    }
+    read += count;
+    if (count < frames) {
+      break;
+    }
+  }
+  return read;
+}
+
+// --- Stream source ---
+
+typedef struct stream_source {
+  tau_stream* stream;
+  int32_t ended;
+  // Whether rendering waits for frames not decoded yet, for offline
+  // rendering, rather than playing silence in their place.
+  int32_t blocking;
+  volatile int64_t underruns;
+  // Whether the stream is at another rate than the context, and converted by
+  // `resampler`.
+  int32_t converting;
+  // Whether the conversion has read the whole stream.
+  int32_t input_ended;
+  tau_resampler resampler;
+  // The frames read from the stream and played, to stop playing the
+  // conversion at the end of the stream.
+  int64_t frames_in;
+  int64_t frames_out;
+} stream_source;
+
+// Converts the next `frames` frames of the stream into `output`, and returns
+// how many of them come before the end of the stream.
+static int32_t pull_converted(stream_source* self, float* output,
+                              int32_t frames) {
+  tau_resampler* resampler = &self->resampler;
+  int32_t needed = tau_resampler_needed(resampler, frames);
+  float* input = tau_resampler_input(resampler);
+  int32_t pulled = 0;
+  if (needed > 0 && !self->input_ended) {
+    pulled = stream_pull(self->stream, input, (size_t)resampler->capacity,
+                         needed, self->blocking ? NULL : &self->underruns);
+    pulled = pulled > 0 ? pulled : 0;
+    self->frames_in += pulled;
+    self->input_ended = pulled < needed;
+  }
+  // Past the end, the filter reads silence.
+  for (int32_t c = 0; pulled < needed && c < resampler->channels; c++) {
+    memset(input + (size_t)c * resampler->capacity + pulled, 0,
+           (size_t)(needed - pulled) * sizeof(float));
+  }
+  tau_resampler_commit(resampler, needed);
+  tau_resampler_process(resampler, output, TAU_QUANTUM, frames);
+  int64_t left = frames;
+  if (self->input_ended) {
+    left = (int64_t)ceil(self->frames_in / resampler->step) -
+           self->frames_out;
+  }
+  int32_t count = left < frames ? (int32_t)(left > 0 ? left : 0) : frames;
+  self->frames_out += count;
+  return count;
+}
+
+static void process_stream_source(tau_context* context, tau_node* node) {
+  stream_source* self = (stream_source*)node->state;
+  int32_t channels = self->stream->format.channels;
+  int32_t start;
+  int32_t end;
+  if (self->ended || !tau_node_active_range(context, node, &start, &end)) {
+    tau_node_output_silence(node, channels);
+    return;
+  }
+  int32_t count =
+      self->converting
+          ? pull_converted(self, node->output + start, end - start)
+          : stream_pull(self->stream, node->output + start, TAU_QUANTUM,
+                        end - start,
+                        self->blocking ? NULL : &self->underruns);
+  if (count < end - start) {
+    // The end of the stream, or a decoding error: silent from then on.
+    self->ended = 1;
+    count = count > 0 ? count : 0;
+  }
+  for (int32_t c = 0; c < channels; c++) {
+    float* out = node->output + c * TAU_QUANTUM;
+    memset(out, 0, start * sizeof(float));
+    memset(out + start + count, 0,
+           (TAU_QUANTUM - start - count) * sizeof(float));
+  }
+  node->output_channels = channels;
+  node->output_silent = 0;
+}
+
+static void destroy_stream_source(tau_node* node) {
+  stream_source* self = (stream_source*)node->state;
+  tau_resampler_destroy(&self->resampler);
+  tau_stream_release(self->stream);
+}
+
+static const tau_node_ops stream_source_ops = {process_stream_source,
+                                               destroy_stream_source};
+
+FFI_PLUGIN_EXPORT int32_t tau_stream_source_create(tau_context* context,
+                                                   tau_stream* stream,
+                                                   int32_t blocking) {
+  if (context == NULL || stream == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  tau_resampler resampler;
+  memset(&resampler, 0, sizeof(resampler));
+  int converting = stream->format.sample_rate != context->sample_rate;
+  if (converting) {
+    int32_t status = tau_resampler_init(
+        &resampler, tau_atomic_load_i32(&context->resampler_quality),
+        stream->format.channels,
+        (double)stream->format.sample_rate / context->sample_rate,
+        TAU_QUANTUM);
+    if (status != TAU_OK) {
+      tau_resampler_destroy(&resampler);
+      return status == TAU_ERROR_INVALID_ARGUMENT ? TAU_ERROR_NOT_SUPPORTED
+                                                  : status;
+    }
+  }
+  tau_node* node = tau_node_create(context, &stream_source_ops,
+                                   sizeof(stream_source),
+                                   stream->format.channels);
+  if (node == NULL) {
+    tau_resampler_destroy(&resampler);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  stream_source* self = (stream_source*)node->state;
+  tau_stream_retain(stream);
+  self->stream = stream;
+  self->blocking = blocking != 0;
+  self->converting = converting;
+  self->resampler = resampler;
+  node->is_source = 1;
+  return node->id;
+}
+
+static stream_source* find_stream_source(tau_context* context,
+                                         int32_t handle) {
+  tau_node* node = tau_context_node(context, handle);
+  return node != NULL && node->ops == &stream_source_ops
+             ? (stream_source*)node->state
+             : NULL;
+}
+
+FFI_PLUGIN_EXPORT int64_t tau_stream_source_underruns(tau_context* context,
+                                                      int32_t node) {
+  if (context == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  int64_t underruns = TAU_ERROR_INVALID_ARGUMENT;
+  tau_control_lock(context);
+  stream_source* self = find_stream_source(context, node);
+  if (self != NULL) {
+    underruns = tau_atomic_load_i64(&self->underruns);
+  }
+  tau_control_unlock(context);
+  return underruns;
+}
+
+// --- Whole files ---
+
+FFI_PLUGIN_EXPORT tau_audio_buffer* tau_decode_file(const char* path) {
+  tau_reader reader;
+  FILE* file = file_open(path, &reader);
+  if (file == NULL) {
+    return NULL;
+  }
+  const tau_codec* codec = NULL;
+  tau_stream_format format;
+  void* decoder = codec_open(&reader, &codec, &format);
+  tau_audio_buffer* buffer = NULL;
+  int64_t frames = 0;
+  int failed = decoder == NULL;
+  while (!failed) {
+    if (buffer != NULL && frames == buffer->frames && format.frames >= 0) {
+      break;
+    }
+    if (buffer == NULL || frames == buffer->frames) {
+      // Unknown lengths grow the buffer by half each time.
+      int64_t length = format.frames >= 0 && buffer == NULL
+                           ? format.frames
+                           : frames + frames / 2 + DECODE_FRAMES;
+      tau_audio_buffer* grown =
+          length <= INT32_MAX
+              ? tau_audio_buffer_create(format.channels, (int32_t)length,
+                                        format.sample_rate)
+              : NULL;
+      if (grown == NULL) {
+        failed = 1;
+        break;
+      }
+      for (int32_t c = 0; buffer != NULL && c < format.channels; c++) {
+        memcpy(grown->data + (size_t)c * grown->stride,
+               buffer->data + (size_t)c * buffer->stride,
+               (size_t)frames * sizeof(float));
+      }
+      tau_audio_buffer_release(buffer);
+      buffer = grown;
+    }
+    float* pointers[TAU_MAX_CHANNELS];
+    for (int32_t c = 0; c < format.channels; c++) {
+      pointers[c] = buffer->data + (size_t)c * buffer->stride + frames;
+    }
+    int64_t room = buffer->frames - frames;
+    int32_t decoded =
+        codec->decode(decoder, pointers,
+                      room < DECODE_FRAMES ? (int32_t)room : DECODE_FRAMES);
+    if (decoded < 0) {
+      failed = 1;
+    } else if (decoded == 0) {
+      break;
+    }
+    frames += decoded > 0 ? decoded : 0;
+  }
+  if (decoder != NULL) {
+    codec->close(decoder);
+  }
+  fclose(file);
+  if (!failed && frames == 0) {
+    failed = 1;
+  }
+  if (failed) {
+    tau_audio_buffer_release(buffer);
+    return NULL;
+  }
+  // A file shorter than announced keeps its decoded length.
+  buffer->frames = (int32_t)frames;
+  return buffer;
+}
@@ -0,0 +1,215 @@
+// The WAV codec: RIFF WAVE files of integer PCM of 8 to 32 bits, or of 32 or
+// 64-bit floats, including the extensible format.
+#include <string.h>
+
+#include "tau_codec.h"
+#include "tau_memory.h"
+
+#define WAVE_FORMAT_PCM 1
+#define WAVE_FORMAT_IEEE_FLOAT 3
+#define WAVE_FORMAT_EXTENSIBLE 0xFFFE
+
+typedef struct wav_decoder {
+  tau_reader reader;
+  int32_t channels;
+  int32_t format;
+  int32_t bytes_per_sample;
+  // The bytes of audio left in the data chunk, or -1 up to the end of the
+  // file.
+  int64_t remaining;
+  // The encoded bytes of the current call to `decode`.
+  uint8_t* bytes;
+  int64_t byte_capacity;
+} wav_decoder;
+
+static uint32_t read_u16(const uint8_t* p) {
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8;
+}
+
+static uint32_t read_u32(const uint8_t* p) {
+  return read_u16(p) | read_u16(p + 2) << 16;
+}
+
+static int32_t wav_probe(const uint8_t* header, int32_t size) {
+  return size >= 12 && memcmp(header, "RIFF", 4) == 0 &&
+         memcmp(header + 8, "WAVE", 4) == 0;
+}
+
+// Reads exactly `size` bytes. Returns 0 on success.
+static int read_exactly(const tau_reader* reader, void* buffer, int64_t size) {
+  uint8_t* bytes = (uint8_t*)buffer;
+  while (size > 0) {
+    int64_t count = reader->read(reader->user, bytes, size);
+    if (count <= 0) {
+      return 1;
+    }
+    bytes += count;
+    size -= count;
+  }
+  return 0;
+}
+
+static int skip(const tau_reader* reader, int64_t size) {
+  uint8_t scratch[256];
+  while (size > 0) {
+    int64_t count =
+        size < (int64_t)sizeof(scratch) ? size : (int64_t)sizeof(scratch);
+    if (read_exactly(reader, scratch, count) != 0) {
+      return 1;
+    }
+    size -= count;
+  }
+  return 0;
+}
+
+static void* wav_open(const tau_reader* reader, tau_stream_format* format) {
+  uint8_t header[12];
+  if (read_exactly(reader, header, sizeof(header)) != 0 ||
+      !wav_probe(header, sizeof(header))) {
+    return NULL;
+  }
+  wav_decoder decoder;
+  memset(&decoder, 0, sizeof(decoder));
+  decoder.reader = *reader;
+  float sample_rate = 0.0f;
+  int have_format = 0;
+  // Chunks up to the audio data, which comes after the format.
+  for (;;) {
+    uint8_t chunk[8];
+    if (read_exactly(reader, chunk, sizeof(chunk)) != 0) {
+      return NULL;
+    }
+    uint32_t size = read_u32(chunk + 4);
+    if (memcmp(chunk, "fmt ", 4) == 0) {
+      uint8_t fmt[40];
+      if (size < 16 || size > sizeof(fmt) ||
+          read_exactly(reader, fmt, size + (size & 1)) != 0) {
+        return NULL;
+      }
+      decoder.format = (int32_t)read_u16(fmt);
+      decoder.channels = (int32_t)read_u16(fmt + 2);
+      sample_rate = (float)read_u32(fmt + 4);
+      int32_t bits = (int32_t)read_u16(fmt + 14);
+      if (decoder.format == WAVE_FORMAT_EXTENSIBLE && size >= 26) {
+        // The format is the start of the subformat GUID.
+        decoder.format = (int32_t)read_u16(fmt + 24);
+      }
+      decoder.bytes_per_sample = bits / 8;
+      have_format = 1;
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      // Files written while streaming leave the size at 0 or the maximum.
+      decoder.remaining =
+          size == 0 || size == 0xFFFFFFFFu ? -1 : (int64_t)size;
+      break;
+    } else if (skip(reader, (int64_t)size + (size & 1)) != 0) {
+      return NULL;
+    }
+  }
+  int32_t bytes = decoder.bytes_per_sample;
+  int supported =
+      (decoder.format == WAVE_FORMAT_PCM && bytes >= 1 && bytes <= 4) ||
+      (decoder.format == WAVE_FORMAT_IEEE_FLOAT && (bytes == 4 || bytes == 8));
+  if (!have_format || !supported || decoder.channels <= 0 ||
+      decoder.channels > TAU_MAX_CHANNELS || !(sample_rate > 0)) {
+    return NULL;
+  }
+  wav_decoder* self =
+      (wav_decoder*)tau_memory_alloc(sizeof(wav_decoder), sizeof(void*));
+  if (self == NULL) {
+    return NULL;
+  }
+  *self = decoder;
+  int64_t frame_bytes = (int64_t)bytes * decoder.channels;
+  format->channels = decoder.channels;
+  format->sample_rate = sample_rate;
+  format->frames =
+      decoder.remaining >= 0 ? decoder.remaining / frame_bytes : -1;
+  return self;
+}
+
+static float decode_sample(const wav_decoder* self, const uint8_t* p) {
+  if (self->format == WAVE_FORMAT_IEEE_FLOAT) {
+    if (self->bytes_per_sample == 4) {
+      uint32_t bits = read_u32(p);
+      float value;
+      memcpy(&value, &bits, sizeof(value));
+      return value;
+    }
+    uint64_t bits = (uint64_t)read_u32(p) | (uint64_t)read_u32(p + 4) << 32;
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return (float)value;
+  }
+  switch (self->bytes_per_sample) {
+    case 1:
+      // 8-bit samples are unsigned.
+      return ((int32_t)p[0] - 128) * (1.0f / 128);
+    case 2:
+      return (int16_t)read_u16(p) * (1.0f / 32768);
+    case 3:
+      return (int32_t)(read_u32(p - 1) & 0xFFFFFF00u) * (1.0f / 2147483648.0f);
+    default:
+      return (int32_t)read_u32(p) * (1.0f / 2147483648.0f);
+  }
+}
+
+static int32_t wav_decode(void* decoder, float* const* channels,
+                          int32_t frames) {
+  wav_decoder* self = (wav_decoder*)decoder;
+  int64_t frame_bytes = (int64_t)self->bytes_per_sample * self->channels;
+  int64_t size = frames * frame_bytes;
+  if (self->remaining >= 0 && size > self->remaining) {
+    size = self->remaining / frame_bytes * frame_bytes;
+  }
+  if (size > self->byte_capacity) {
+    tau_memory_free(self->bytes);
+    // Room for a padding byte before the samples, read by 24-bit decoding.
+    self->bytes = (uint8_t*)tau_memory_alloc((size_t)size + 1, TAU_CACHE_LINE);
+    self->byte_capacity = self->bytes != NULL ? size : 0;
+    if (self->bytes == NULL) {
+      return TAU_ERROR_OUT_OF_MEMORY;
+    }
+  }
+  uint8_t* bytes = self->bytes + 1;
+  int64_t filled = 0;
+  while (filled < size) {
+    int64_t count =
+        self->reader.read(self->reader.user, bytes + filled, size - filled);
+    if (count < 0) {
+      return (int32_t)count;
+    }
+    if (count == 0) {
+      break;
+    }
+    filled += count;
+  }
+  int32_t decoded = (int32_t)(filled / frame_bytes);
+  if (self->remaining >= 0) {
+    self->remaining -= decoded * frame_bytes;
+  }
+  int pcm16 = self->format == WAVE_FORMAT_PCM && self->bytes_per_sample == 2;
+  for (int32_t c = 0; c < self->channels; c++) {
+    const uint8_t* p = bytes + (int64_t)c * self->bytes_per_sample;
+    float* out = channels[c];
+    if (pcm16) {
+      // The most common format gets a loop of its own.
+      for (int32_t i = 0; i < decoded; i++, p += frame_bytes) {
+        out[i] = (int16_t)read_u16(p) * (1.0f / 32768);
+      }
+      continue;
+    }
+    for (int32_t i = 0; i < decoded; i++, p += frame_bytes) {
+      out[i] = decode_sample(self, p);
+    }
+  }
+  return decoded;
+}
+
+static void wav_close(void* decoder) {
+  wav_decoder* self = (wav_decoder*)decoder;
+  tau_memory_free(self->bytes);
+  tau_memory_free(self);
+}
+
+const tau_codec tau_wav_codec = {"wav", wav_probe, wav_open, wav_decode,
+                                 wav_close};
@@ -0,0 +1,453 @@
+// Worklet nodes, whose quanta a thread outside the graph processes, such as
+// a Dart isolate, and the host queueing their blocks to it.
+//
+// A worklet owns `latency + 2` slots of shared memory, three at the lowest
+// latency. Every quantum, the rendering thread takes back the output of the
+// block queued `latency` quanta before, then fills the slot of the current
+// quantum with the input and queues it. A slot goes from free to queued
+// when the rendering thread queues it, then to done when the processing
+// thread hands it back, and to free again once its output is read. A block
+// still queued when its output is due is abandoned with a compare and swap,
+// and freed by the processing thread when it is done with it: the two sides
+// never wait for each other, and the two spare slots leave room for a late
+// block to come back while the next ones are queued.
+//
+// The queue of the host is bounded, with a turn per cell: any rendering
+// thread pushes, the processing thread alone pops. The processing thread
+// sleeps on a semaphore, which a push posts only when it says it is about
+// to sleep.
+#include <string.h>
+
+#include "tau_engine.h"
+
+// States of a slot.
+#define SLOT_FREE 0
+#define SLOT_QUEUED 1
+#define SLOT_DONE 2
+#define SLOT_ABANDONED 3
+
+typedef struct worklet worklet;
+
+typedef struct worklet_slot {
+  // First, so that the block the processing thread gets is the slot.
+  tau_worklet_block block;
+  worklet* self;
+  // The quantum the block belongs to, written by the rendering thread.
+  int64_t quantum;
+  volatile int32_t state;
+} worklet_slot;
+
+struct worklet {
+  tau_worklet_host* host;
+  worklet_slot* slots;
+  float* samples;
+  int32_t slot_count;
+  int32_t latency;
+  int32_t blocking;
+  // The quanta rendered.
+  int64_t quanta;
+  volatile int64_t underruns;
+  // Set by a blocking rendering thread before it sleeps on `done`.
+  volatile int32_t waiting;
+  tau_semaphore done;
+  // One for the node, plus one per queued slot.
+  volatile int32_t references;
+};
+
+typedef struct worklet_state {
+  worklet* self;
+} worklet_state;
+
+struct tau_worklet_host {
+  // Cell `i` holds the block pushed at position `n` once `turns[i]` is
+  // `n + 1`, and is free for position `n` once it is `n`.
+  worklet_slot** cells;
+  volatile int64_t* turns;
+  int32_t capacity;
+  int64_t mask;
+  tau_semaphore ready;
+
+  TAU_ALIGNAS(TAU_CACHE_LINE) volatile int64_t tail;
+  TAU_ALIGNAS(TAU_CACHE_LINE) volatile int64_t head;
+
+  // The slots the worklets own together, at most `capacity`.
+  volatile int32_t reserved;
+  // The rendering threads pushing right now, which closing waits out.
+  volatile int32_t pushing;
+  volatile int32_t waiting;
+  volatile int32_t closing;
+  // One for the owner, plus one per worklet.
+  volatile int32_t references;
+};
+
+static void host_unref(tau_worklet_host* host) {
+  if (tau_atomic_fetch_add_i32(&host->references, -1) != 1) {
+    return;
+  }
+  tau_semaphore_destroy(&host->ready);
+  tau_memory_free(host->cells);
+  tau_memory_free((void*)host->turns);
+  tau_memory_free(host);
+}
+
+static int host_push(tau_worklet_host* host, worklet_slot* slot) {
+  tau_atomic_fetch_add_i32(&host->pushing, 1);
+  int pushed = 0;
+  int64_t position = tau_atomic_load_i64(&host->tail);
+  while (!tau_atomic_load_i32(&host->closing)) {
+    int64_t turn = tau_atomic_load_i64(&host->turns[position & host->mask]);
+    if (turn < position) {
+      // Full, which the reservations rule out.
+      break;
+    }
+    if (turn > position) {
+      position = tau_atomic_load_i64(&host->tail);
+      continue;
+    }
+    if (tau_atomic_cas_i64(&host->tail, &position, position + 1)) {
+      host->cells[position & host->mask] = slot;
+      tau_atomic_store_i64(&host->turns[position & host->mask], position + 1);
+      pushed = 1;
+      break;
+    }
+  }
+  tau_atomic_fetch_add_i32(&host->pushing, -1);
+  if (pushed && tau_atomic_exchange_i32(&host->waiting, 0)) {
+    tau_semaphore_post(&host->ready);
+  }
+  return pushed;
+}
+
+static worklet_slot* host_pop(tau_worklet_host* host) {
+  int64_t position = tau_atomic_load_relaxed_i64(&host->head);
+  int64_t cell = position & host->mask;
+  if (tau_atomic_load_i64(&host->turns[cell]) != position + 1) {
+    return NULL;
+  }
+  worklet_slot* slot = host->cells[cell];
+  tau_atomic_store_i64(&host->turns[cell], position + host->capacity);
+  tau_atomic_store_relaxed_i64(&host->head, position + 1);
+  return slot;
+}
+
+static void worklet_unref(worklet* self) {
+  if (tau_atomic_fetch_add_i32(&self->references, -1) != 1) {
+    return;
+  }
+  // A worklet has a host once its creation succeeded.
+  if (self->host != NULL) {
+    tau_atomic_fetch_add_i32(&self->host->reserved, -self->slot_count);
+    host_unref(self->host);
+    tau_semaphore_destroy(&self->done);
+  }
+  tau_memory_free(self->samples);
+  tau_memory_free(self->slots);
+  tau_memory_free(self);
+}
+
+// Copies the output of `slot` to the node and frees the slot.
+static void take_output(tau_node* node, worklet_slot* slot) {
+  int32_t channels = slot->block.output_channels;
+  memcpy(node->output, slot->block.output,
+         (size_t)channels * TAU_QUANTUM * sizeof(float));
+  tau_atomic_store_i32(&slot->state, SLOT_FREE);
+  node->output_channels = channels;
+  node->output_silent = 0;
+}
+
+// Waits for the processing thread to hand `slot` back, unless the host
+// closes. Returns the state of the slot.
+static int32_t wait_for(worklet* self, worklet_slot* slot) {
+  int32_t state;
+  while ((state = tau_atomic_load_i32(&slot->state)) == SLOT_QUEUED &&
+         !tau_atomic_load_i32(&self->host->closing)) {
+    tau_atomic_exchange_i32(&self->waiting, 1);
+    if (tau_atomic_load_i32(&slot->state) != SLOT_QUEUED) {
+      continue;
+    }
+    // The timeout only bounds how late a close is noticed.
+    tau_semaphore_wait(&self->done, 100);
+  }
+  return state;
+}
+
+// Outputs the block queued `latency` quanta ago.
+static void read_block(tau_node* node, worklet* self) {
+  int64_t quantum = self->quanta - self->latency;
+  int32_t channels = self->slots[0].block.output_channels;
+  if (quantum < 0) {
+    tau_node_output_silence(node, channels);
+    return;
+  }
+  worklet_slot* slot = &self->slots[quantum % self->slot_count];
+  if (slot->quantum == quantum) {
+    int32_t state = self->blocking ? wait_for(self, slot)
+                                   : tau_atomic_load_i32(&slot->state);
+    if (state == SLOT_QUEUED) {
+      // Leaves `state` done if the block was handed back in the meantime.
+      tau_atomic_cas_i32(&slot->state, &state, SLOT_ABANDONED);
+    }
+    if (state == SLOT_DONE) {
+      take_output(node, slot);
+      return;
+    }
+  }
+  // The block is late, or was never queued because its slot was still out.
+  if (!tau_atomic_load_i32(&self->host->closing)) {
+    tau_atomic_fetch_add_i64(&self->underruns, 1);
+  }
+  tau_node_output_silence(node, channels);
+}
+
+// Queues the input of the current quantum.
+static void write_block(tau_context* context, tau_node* node, worklet* self) {
+  worklet_slot* slot = &self->slots[self->quanta % self->slot_count];
+  if (tau_atomic_load_i32(&slot->state) != SLOT_FREE) {
+    return;
+  }
+  int32_t channels = slot->block.input_channels;
+  size_t bytes = (size_t)channels * TAU_QUANTUM * sizeof(float);
+  if (node->input_silent) {
+    memset(slot->block.input, 0, bytes);
+  } else {
+    memcpy(slot->block.input, node->input, bytes);
+  }
+  slot->block.frame = context->frame;
+  slot->quantum = self->quanta;
+  tau_atomic_store_i32(&slot->state, SLOT_QUEUED);
+  tau_atomic_fetch_add_i32(&self->references, 1);
+  if (!host_push(self->host, slot)) {
+    tau_atomic_store_i32(&slot->state, SLOT_FREE);
+    tau_atomic_fetch_add_i32(&self->references, -1);
+  }
+}
+
+static void process_worklet(tau_context* context, tau_node* node) {
+  worklet* self = ((worklet_state*)node->state)->self;
+  read_block(node, self);
+  write_block(context, node, self);
+  self->quanta++;
+}
+
+static void destroy_worklet(tau_node* node) {
+  worklet_unref(((worklet_state*)node->state)->self);
+}
+
+static const tau_node_ops worklet_ops = {process_worklet, destroy_worklet};
+
+// The worklet behind `handle`, or NULL. Called with the control lock held.
+static worklet* find_worklet(tau_context* context, int32_t handle) {
+  tau_node* node = tau_context_node(context, handle);
+  return node != NULL && node->ops == &worklet_ops
+             ? ((worklet_state*)node->state)->self
+             : NULL;
+}
+
+// A worklet of `slot_count` slots, whose share of the host the caller
+// reserved.
+static worklet* worklet_new(tau_worklet_host* host, int64_t key,
+                            int32_t input_channels, int32_t output_channels,
+                            int32_t slot_count) {
+  worklet* self = (worklet*)tau_memory_calloc(sizeof(worklet), TAU_CACHE_LINE);
+  if (self == NULL) {
+    return NULL;
+  }
+  self->references = 1;
+  self->slot_count = slot_count;
+  self->slots = (worklet_slot*)tau_memory_calloc(
+      (size_t)slot_count * sizeof(worklet_slot), TAU_CACHE_LINE);
+  size_t slot_floats = (size_t)(input_channels + output_channels) * TAU_QUANTUM;
+  self->samples = (float*)tau_memory_calloc(
+      (size_t)slot_count * slot_floats * sizeof(float), TAU_CACHE_LINE);
+  if (self->slots == NULL || self->samples == NULL ||
+      tau_semaphore_init(&self->done) != 0) {
+    worklet_unref(self);
+    return NULL;
+  }
+  // From here on, freeing the worklet gives the reservation back.
+  tau_atomic_fetch_add_i32(&host->references, 1);
+  self->host = host;
+  for (int32_t i = 0; i < slot_count; i++) {
+    worklet_slot* slot = &self->slots[i];
+    slot->block.key = key;
+    slot->block.input = self->samples + (size_t)i * slot_floats;
+    slot->block.output =
+        slot->block.input + (size_t)input_channels * TAU_QUANTUM;
+    slot->block.input_channels = input_channels;
+    slot->block.output_channels = output_channels;
+    slot->self = self;
+    slot->quantum = -1;
+  }
+  return self;
+}
+
+FFI_PLUGIN_EXPORT tau_worklet_host* tau_worklet_host_create(int32_t capacity) {
+  if (capacity <= 0 || capacity > (1 << 20)) {
+    return NULL;
+  }
+  int32_t cells = 1;
+  while (cells < capacity) {
+    cells <<= 1;
+  }
+  tau_worklet_host* host = (tau_worklet_host*)tau_memory_calloc(
+      sizeof(tau_worklet_host), TAU_CACHE_LINE);
+  if (host == NULL) {
+    return NULL;
+  }
+  host->cells = (worklet_slot**)tau_memory_calloc(
+      (size_t)cells * sizeof(worklet_slot*), TAU_CACHE_LINE);
+  host->turns = (volatile int64_t*)tau_memory_alloc(
+      (size_t)cells * sizeof(int64_t), TAU_CACHE_LINE);
+  if (host->cells == NULL || host->turns == NULL ||
+      tau_semaphore_init(&host->ready) != 0) {
+    tau_memory_free(host->cells);
+    tau_memory_free((void*)host->turns);
+    tau_memory_free(host);
+    return NULL;
+  }
+  for (int32_t i = 0; i < cells; i++) {
+    host->turns[i] = i;
+  }
+  host->capacity = cells;
+  host->mask = cells - 1;
+  host->references = 1;
+  return host;
+}
+
+FFI_PLUGIN_EXPORT tau_worklet_block* tau_worklet_host_wait(
+    tau_worklet_host* host, int32_t timeout_ms) {
+  int64_t deadline =
+      timeout_ms < 0 ? 0 : tau_now_ns() + (int64_t)timeout_ms * 1000000;
+  for (;;) {
+    if (tau_atomic_load_i32(&host->closing)) {
+      return NULL;
+    }
+    worklet_slot* slot = host_pop(host);
+    if (slot != NULL) {
+      return &slot->block;
+    }
+    // A push after this posts the semaphore, so look again before sleeping.
+    tau_atomic_exchange_i32(&host->waiting, 1);
+    slot = host_pop(host);
+    if (slot != NULL) {
+      return &slot->block;
+    }
+    int32_t left_ms = -1;
+    if (timeout_ms >= 0) {
+      int64_t left = deadline - tau_now_ns();
+      if (left <= 0) {
+        return NULL;
+      }
+      left_ms = (int32_t)((left + 999999) / 1000000);
+    }
+    // Posts left over from earlier pushes only make the loop go round.
+    tau_semaphore_wait(&host->ready, left_ms);
+  }
+}
+
+FFI_PLUGIN_EXPORT void tau_worklet_host_complete(tau_worklet_host* host,
+                                                 tau_worklet_block* block) {
+  (void)host;
+  worklet_slot* slot = (worklet_slot*)block;
+  worklet* self = slot->self;
+  int32_t state = SLOT_QUEUED;
+  if (!tau_atomic_cas_i32(&slot->state, &state, SLOT_DONE)) {
+    // Abandoned by the rendering thread, which is done with it.
+    tau_atomic_store_i32(&slot->state, SLOT_FREE);
+  }
+  if (tau_atomic_exchange_i32(&self->waiting, 0)) {
+    tau_semaphore_post(&self->done);
+  }
+  worklet_unref(self);
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_worklet_host_closed(tau_worklet_host* host) {
+  return tau_atomic_load_i32(&host->closing);
+}
+
+FFI_PLUGIN_EXPORT void tau_worklet_host_close(tau_worklet_host* host) {
+  if (host != NULL) {
+    tau_atomic_exchange_i32(&host->closing, 1);
+    tau_semaphore_post(&host->ready);
+  }
+}
+
+FFI_PLUGIN_EXPORT void tau_worklet_host_release(tau_worklet_host* host) {
+  if (host == NULL) {
+    return;
+  }
+  tau_atomic_exchange_i32(&host->closing, 1);
+  // A push that started before the close may still land in the queue.
+  while (tau_atomic_load_i32(&host->pushing) != 0) {
+    tau_thread_yield();
+  }
+  worklet_slot* slot;
+  while ((slot = host_pop(host)) != NULL) {
+    memset(slot->block.output, 0,
+           (size_t)slot->block.output_channels * TAU_QUANTUM * sizeof(float));
+    tau_worklet_host_complete(host, &slot->block);
+  }
+  host_unref(host);
+}
+
+FFI_PLUGIN_EXPORT int32_t tau_worklet_create(tau_context* context,
+                                             tau_worklet_host* host,
+                                             int64_t key,
+                                             int32_t input_channels,
+                                             int32_t output_channels,
+                                             int32_t latency,
+                                             int32_t blocking) {
+  if (context == NULL || host == NULL || input_channels < 1 ||
+      input_channels > TAU_MAX_CHANNELS || output_channels < 1 ||
+      output_channels > TAU_MAX_CHANNELS || latency < 1 ||
+      latency > TAU_WORKLET_MAX_LATENCY) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  int32_t slot_count = latency + 2;
+  if (tau_atomic_load_i32(&host->closing)) {
+    return TAU_ERROR_INVALID_STATE;
+  }
+  if (tau_atomic_fetch_add_i32(&host->reserved, slot_count) + slot_count >
+      host->capacity) {
+    tau_atomic_fetch_add_i32(&host->reserved, -slot_count);
+    return TAU_ERROR_INVALID_STATE;
+  }
+  worklet* self =
+      worklet_new(host, key, input_channels, output_channels, slot_count);
+  if (self == NULL) {
+    tau_atomic_fetch_add_i32(&host->reserved, -slot_count);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  self->latency = latency;
+  self->blocking = blocking != 0;
+  tau_node* node = tau_node_create(context, &worklet_ops,
+                                   sizeof(worklet_state), output_channels);
+  if (node == NULL) {
+    worklet_unref(self);
+    return TAU_ERROR_OUT_OF_MEMORY;
+  }
+  ((worklet_state*)node->state)->self = self;
+  int32_t status =
+      tau_node_set_channels(context, node, input_channels,
+                            TAU_CHANNELS_EXPLICIT, TAU_INTERPRETATION_SPEAKERS);
+  if (status != TAU_OK) {
+    tau_node_release(context, node->id);
+    return status;
+  }
+  return node->id;
+}
+
+FFI_PLUGIN_EXPORT int64_t tau_worklet_underruns(tau_context* context,
+                                                int32_t node) {
+  if (context == NULL) {
+    return TAU_ERROR_INVALID_ARGUMENT;
+  }
+  int64_t underruns = TAU_ERROR_INVALID_ARGUMENT;
+  tau_control_lock(context);
+  worklet* self = find_worklet(context, node);
+  if (self != NULL) {
+    underruns = tau_atomic_load_i64(&self->underruns);
+  }
+  tau_control_unlock(context);
+  return underruns;
+}